@@ -46,6 +46,7 @@ date         init     comment
 #include "agt_commit_complete.h"
 #include "agt_cli.h"
 #include "agt_connect.h"
+#include "agt_gcommit.h"
 #include "agt_hello.h"
 #include "agt_ietf_notif.h"
 #include "agt_if.h"
@@ -53,12 +54,15 @@ date         init     comment
 #include "agt_not.h"
 #include "agt_plock.h"
 #include "agt_proc.h"
+#include "agt_refidx.h"
 
 #ifdef WITH_YANGAPI
 #include "agt_yangapi.h"
 #endif
 
 #include "agt_rpc.h"
+#include "agt_rpcstat.h"
+#include "agt_sample.h"
 #include "agt_ses.h"
 #include "agt_signal.h"
 #include "agt_state.h"
@@ -73,6 +77,7 @@ date         init     comment
 #include "log_vendor_extern.h"
 #include "ncx.h"
 #include "ncx_str.h"
+#include "ncx_trace.h"
 #include "ncxconst.h"
 #include "ncxmod.h"
 #include "status.h"
@@ -199,6 +204,15 @@ static void
     /* set the maximum number of notifications to send at once */
     agt_profile.agt_maxburst = 10;
 
+    /* set the max age of a shared /proc file sample */
+    agt_profile.agt_sample_interval = AGT_SAMPLE_DEF_INTERVAL;
+
+    /* set the number of events kept in each trace buffer */
+    agt_profile.agt_trace_size = NCX_TRACE_DEF_SIZE;
+
+    /* group commit of edits to running is disabled by default */
+    agt_profile.agt_gcommit_window = 0;
+
     /* set the max time limit after a NETCONF session starts
      * for the <hello> to be received by the client
      */
@@ -1034,6 +1048,21 @@ status_t
 
     /* initialize the server timer service */
     agt_timer_init();
+
+    /* initialize the shared system file samplers */
+    agt_sample_init();
+
+    /* initialize the per-phase RPC statistics */
+    agt_rpcstat_init();
+
+    /* initialize the group commit of edits to running */
+    agt_gcommit_init();
+
+    /* initialize the leafref index for the running config */
+    agt_refidx_init();
+
+    /* initialize the hot-path trace buffer */
+    ncx_trace_init(agt_profile.agt_trace_size);
     
     /* initialize the RPC server callback structures */
     res = agt_rpc_init();
@@ -1671,6 +1700,11 @@ void
         agt_proc_cleanup();
         y_ietf_netconf_partial_lock_cleanup();
         agt_if_cleanup();
+        agt_sample_cleanup();
+        agt_rpcstat_cleanup();
+        agt_gcommit_cleanup();
+        agt_refidx_cleanup();
+        ncx_trace_cleanup();
         y_yuma_time_filter_cleanup();
         y_yuma_arp_cleanup();
         agt_ses_cleanup();
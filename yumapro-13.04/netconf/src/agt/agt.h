@@ -291,6 +291,9 @@ typedef struct agt_profile_t_ {
 
     uint32              agt_eventlog_size;
     uint32              agt_maxburst;
+    uint32              agt_sample_interval;   /* msecs */
+    uint32              agt_trace_size;        /* events per thread */
+    uint32              agt_gcommit_window;    /* msecs */
     uint32              agt_hello_timeout;
     uint32              agt_idle_timeout;
     uint32              agt_linesize;
@@ -75,6 +75,7 @@ typedef struct agt_cb_set_t_ {
     const xmlChar     *defpath;
     const xmlChar     *version;
     agt_cb_fnset_t     cbset;
+    getcb_iter_fn_t    iterfn;
     agt_cb_status_t    loadstatus;
     status_t           status;
 } agt_cb_set_t;
@@ -402,9 +403,17 @@ static status_t
 
     /* find the object template for this callback */
     res = xpath_find_schema_target_int(callback->defpath, &obj);
+    if (res == NO_ERR && callback->iterfn &&
+        obj->objtype != OBJ_TYP_LIST) {
+        res = ERR_NCX_WRONG_NODETYP;
+    }
     if (res == NO_ERR) {
         /* set the callbacks in the object */
-        obj->cbset = &callback->cbset;
+        if (callback->iterfn) {
+            obj->itercb = (void *)callback->iterfn;
+        } else {
+            obj->cbset = &callback->cbset;
+        }
         callback->loadstatus = AGTCB_STAT_LOADED;
         callback->status = NO_ERR;
 
@@ -686,6 +695,155 @@ status_t
 }  /* agt_cb_register_callbacks */
 
 
+/********************************************************************
+* FUNCTION agt_cb_register_iter_callback
+* 
+* Register a list iterator callback function for a
+* virtual state data list
+*
+* INPUTS:
+*   modname == module that defines the target list for
+*              this callback function
+*   defpath == Xpath with default (or no) prefixes
+*              defining the list that will get the callbacks
+*   version == exact module revision date expected
+*              if condition not met then an error will
+*              be logged  (TBD: force unload of module!)
+*           == NULL means use any version of the module
+*   iterfn  == address of list iterator function to use
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t 
+    agt_cb_register_iter_callback (const xmlChar *modname,
+                                   const xmlChar *defpath,
+                                   const xmlChar *version,
+                                   getcb_iter_fn_t iterfn)
+{
+    agt_cb_modhdr_t    *modhdr;
+    agt_cb_set_t       *callback;
+    ncx_module_t       *mod;
+    status_t            res;
+    agt_cb_fnset_t      cbset;
+
+#ifdef DEBUG
+    if (!modname || !defpath || !iterfn) {
+        return SET_ERROR(ERR_INTERNAL_PTR);
+    }
+#endif
+
+    modhdr = find_modhdr(modname);
+    if (!modhdr) {
+        modhdr = new_modhdr(modname);
+        if (!modhdr) {
+            return ERR_INTERNAL_MEM;
+        }
+        res = add_modhdr(modhdr);
+        if (res != NO_ERR) {
+            free_modhdr(modhdr);
+            return res;
+        }
+    }
+
+    callback = find_callback(modhdr, defpath);
+    if (callback) {
+        return SET_ERROR(ERR_NCX_DUP_ENTRY);
+    }
+
+    /* no edit callbacks for a state data list */
+    memset(&cbset, 0x0, sizeof(agt_cb_fnset_t));
+
+    callback = new_callback(modhdr, 
+                            defpath, 
+                            version, 
+                            &cbset);
+    if (!callback) {
+        return ERR_INTERNAL_MEM;
+    }
+    callback->iterfn = iterfn;
+
+    res = add_callback(modhdr, callback);
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    /* data structures in place, now check if the module
+     * is loaded yet
+     */
+    mod = ncx_find_module(modname, version);
+    if (!mod) {
+        /* module not present yet */
+        return NO_ERR;
+    }
+
+    res = load_callbacks(mod, modhdr, callback);
+        
+    return res;
+
+}  /* agt_cb_register_iter_callback */
+
+
+/********************************************************************
+* FUNCTION agt_cb_set_cache_timeout
+* 
+* Set the virtual value cache policy for a state data object
+* Overrides the ncx:cache-timeout and ncx:async-cache-refresh
+* extensions in the module and the --virtual-timeout default
+*
+* The module must already be loaded, so this is usually
+* called from the SIL init1 or init2 function
+*
+* INPUTS:
+*   modname == module that defines the target object
+*   defpath == Xpath with default (or no) prefixes
+*              defining the object to set
+*   timeout == number of seconds a cached value is fresh;
+*              0 to call the get callback for every retrieval
+*   async_refresh == TRUE to return a stale value and invoke
+*              the get callback after the reply is sent
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t 
+    agt_cb_set_cache_timeout (const xmlChar *modname,
+                              const xmlChar *defpath,
+                              uint32 timeout,
+                              boolean async_refresh)
+{
+    obj_template_t     *obj;
+    status_t            res;
+
+#ifdef DEBUG
+    if (!modname || !defpath) {
+        return SET_ERROR(ERR_INTERNAL_PTR);
+    }
+#endif
+
+    if (!ncx_find_module(modname, NULL)) {
+        return ERR_NCX_MOD_NOT_FOUND;
+    }
+
+    res = xpath_find_schema_target_int(defpath, &obj);
+    if (res != NO_ERR) {
+        log_error("\nError: set cache timeout failed for module '%s'"
+                  "\n  '%s' for defpath '%s'",
+                  modname, 
+                  get_error_string(res), 
+                  defpath);
+        return res;
+    }
+
+    if (obj_is_config(obj)) {
+        return ERR_NCX_WRONG_NODETYP;
+    }
+
+    return obj_set_cache_timeout(obj, timeout, async_refresh);
+
+}  /* agt_cb_set_cache_timeout */
+
+
 /********************************************************************
 * FUNCTION agt_cb_unregister_callback
 * 
@@ -737,6 +895,7 @@ void
     res = xpath_find_schema_target_int(defpath, &obj);
     if (res == NO_ERR) {
         obj->cbset = NULL;
+        obj->itercb = NULL;
     }
 
 }  /* agt_cb_unregister_callbacks */
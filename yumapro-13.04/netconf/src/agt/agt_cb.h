@@ -34,6 +34,7 @@ date	     init     comment
 */
 
 #include "agt.h"
+#include "getcb.h"
 #include "op.h"
 #include "rpc.h"
 #include "ses.h"
@@ -180,6 +181,68 @@ extern status_t
 			       const agt_cb_fnset_t *cbfnset);
 
 
+/********************************************************************
+* FUNCTION agt_cb_register_iter_callback
+* 
+* Register a list iterator callback function for a
+* virtual state data list
+*
+* The list entries are not stored in the database.
+* The SIL code adds a place-holder node for the list,
+* created with val_init_virtual_list, and the iterator
+* is called to get the entries in batches when the
+* list is retrieved
+*
+* INPUTS:
+*   modname == module that defines the target list for
+*              this callback function
+*   defpath == Xpath with default (or no) prefixes
+*              defining the list that will get the callbacks
+*   version == exact module revision date expected
+*              if condition not met then an error will
+*              be logged  (TBD: force unload of module!)
+*           == NULL means use any version of the module
+*   iterfn  == address of list iterator function to use
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t 
+    agt_cb_register_iter_callback (const xmlChar *modname,
+				   const xmlChar *defpath,
+				   const xmlChar *version,
+				   getcb_iter_fn_t iterfn);
+
+
+/********************************************************************
+* FUNCTION agt_cb_set_cache_timeout
+* 
+* Set the virtual value cache policy for a state data object
+* Overrides the ncx:cache-timeout and ncx:async-cache-refresh
+* extensions in the module and the --virtual-timeout default
+*
+* The module must already be loaded, so this is usually
+* called from the SIL init1 or init2 function
+*
+* INPUTS:
+*   modname == module that defines the target object
+*   defpath == Xpath with default (or no) prefixes
+*              defining the object to set
+*   timeout == number of seconds a cached value is fresh;
+*              0 to call the get callback for every retrieval
+*   async_refresh == TRUE to return a stale value and invoke
+*              the get callback after the reply is sent
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t 
+    agt_cb_set_cache_timeout (const xmlChar *modname,
+                              const xmlChar *defpath,
+                              uint32 timeout,
+                              boolean async_refresh);
+
+
 /********************************************************************
 * FUNCTION agt_cb_unregister_callback
 * 
@@ -259,6 +259,24 @@ static void
 #endif
     }
 
+    /* sample-interval param */
+    val = val_find_child(valset, AGT_CLI_MODULE, AGT_CLI_SAMPLE_INTERVAL);
+    if (val && val->res == NO_ERR) {
+        agt_profile->agt_sample_interval = VAL_UINT(val);
+    }
+
+    /* trace-buffer-size param */
+    val = val_find_child(valset, AGT_CLI_MODULE, AGT_CLI_TRACE_BUFFER_SIZE);
+    if (val && val->res == NO_ERR) {
+        agt_profile->agt_trace_size = VAL_UINT(val);
+    }
+
+    /* group-commit-window param */
+    val = val_find_child(valset, AGT_CLI_MODULE, AGT_CLI_GROUP_COMMIT_WINDOW);
+    if (val && val->res == NO_ERR) {
+        agt_profile->agt_gcommit_window = VAL_UINT(val);
+    }
+
     /* running-error param */
     val = val_find_child(valset, AGT_CLI_MODULE, AGT_CLI_RUNNING_ERROR);
     if (val && val->res == NO_ERR) {
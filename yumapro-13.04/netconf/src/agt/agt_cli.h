@@ -79,6 +79,12 @@ extern "C" {
 
 #define AGT_CLI_MAX_SESSIONS (const xmlChar *)"max-sessions"
 
+#define AGT_CLI_SAMPLE_INTERVAL (const xmlChar *)"sample-interval"
+
+#define AGT_CLI_TRACE_BUFFER_SIZE (const xmlChar *)"trace-buffer-size"
+
+#define AGT_CLI_GROUP_COMMIT_WINDOW (const xmlChar *)"group-commit-window"
+
 /********************************************************************
 *								    *
 *			F U N C T I O N S			    *
@@ -0,0 +1,1041 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: agt_gcommit.c
+
+   Group commit of <edit-config> requests on the running datastore
+
+   Each <edit-config> on running normally runs its own apply,
+   root check, SIL commit callbacks and NV-storage save.
+   When many sessions push small changes at the same time,
+   most of that work is repeated for every edit.
+
+   If --group-commit-window is not zero, an edit on running
+   is validated as usual, but its <config> is merged into
+   a pending group instead of being applied, and the reply
+   is held.  The group is committed as one transaction when
+   the window expires, the group is full, or any request
+   arrives that cannot join the group.  If the combined
+   transaction fails, the edits are applied one at a time,
+   so each client gets the same result it would have gotten
+   without grouping.
+
+   An edit can join the group if:
+     - the target is running and the <config> parameter is used
+     - the test-option is not test-only
+     - the default-operation is the same for all edits,
+       and is merge or none
+     - the session user is the same for all edits, so the
+       access control and audit records are correct
+     - no node in the edit is also edited by the group,
+       except containers and list entries that are merged
+       in both edits
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <sys/time.h>
+
+#include "procdefs.h"
+#include "agt.h"
+#include "agt_acm.h"
+#include "agt_cfg.h"
+#include "agt_gcommit.h"
+#include "agt_ncx.h"
+#include "agt_rpc.h"
+#include "agt_ses.h"
+#include "agt_sys.h"
+#include "agt_util.h"
+#include "agt_val.h"
+#include "cfg.h"
+#include "dlq.h"
+#include "log.h"
+#include "ncxconst.h"
+#include "obj.h"
+#include "op.h"
+#include "rpc.h"
+#include "rpc_err.h"
+#include "ses.h"
+#include "status.h"
+#include "val.h"
+#include "xml_util.h"
+#include "xmlns.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+*                                                                   *
+*                           T Y P E S                               *
+*                                                                   *
+*********************************************************************/
+
+/* one <edit-config> held in the pending group */
+typedef struct gcommit_edit_t_ {
+    dlq_hdr_t       qhdr;
+    ses_id_t        sid;
+    rpc_msg_t      *msg;        /* held message */
+    val_value_t    *srcval;     /* back-ptr to <config> in msg */
+    val_value_t    *config;     /* malloced clone of <config> */
+    xml_attrs_t     attrs;      /* copy of the <rpc> attributes */
+    dlq_hdr_t       auditQ;     /* Q of agt_cfg_audit_rec_t */
+} gcommit_edit_t;
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static boolean              agt_gcommit_init_done = FALSE;
+
+/* Q of gcommit_edit_t; edits added to the pending group */
+static dlq_hdr_t            editQ;
+
+/* number of entries in editQ */
+static uint32               editcount;
+
+/* edit checked by agt_gcommit_prepare but not added yet */
+static gcommit_edit_t      *curedit;
+
+/* combined <config> for the pending group */
+static val_value_t         *groupconfig;
+
+/* default-operation and user for all the edits in the group */
+static op_editop_t          groupdefop;
+static xmlChar             *groupuser;
+
+/* time the pending group must be committed */
+static struct timeval       deadline;
+
+
+/********************************************************************
+* FUNCTION free_edit
+*
+* Clean and free a group edit entry
+* The held message is not freed
+*
+* INPUTS:
+*   edit == gcommit_edit_t struct to free
+*********************************************************************/
+static void
+    free_edit (gcommit_edit_t *edit)
+{
+    if (edit->config) {
+        val_free_value(edit->config);
+    }
+    xml_clean_attrs(&edit->attrs);
+    while (!dlq_empty(&edit->auditQ)) {
+        agt_cfg_audit_rec_t *auditrec = (agt_cfg_audit_rec_t *)
+            dlq_deque(&edit->auditQ);
+        agt_cfg_free_auditrec(auditrec);
+    }
+    m__free(edit);
+
+}  /* free_edit */
+
+
+/********************************************************************
+* FUNCTION new_edit
+*
+* Malloc a group edit entry for a message
+* The <rpc> attributes and the <config> parameter are copied
+*
+* INPUTS:
+*   scb == session control block
+*   msg == rpc_msg_t in progress
+*   top == <rpc> element node
+*   srcval == <config> parameter in the message
+*
+* RETURNS:
+*   malloced edit entry; NULL if a malloc failed
+*********************************************************************/
+static gcommit_edit_t *
+    new_edit (ses_cb_t *scb,
+              rpc_msg_t *msg,
+              xml_node_t *top,
+              val_value_t *srcval)
+{
+    gcommit_edit_t *edit = m__getObj(gcommit_edit_t);
+    if (edit == NULL) {
+        return NULL;
+    }
+    memset(edit, 0x0, sizeof(gcommit_edit_t));
+    xml_init_attrs(&edit->attrs);
+    dlq_createSQue(&edit->auditQ);
+    edit->sid = scb->sid;
+    edit->msg = msg;
+    edit->srcval = srcval;
+
+    /* the top node is freed when agt_rpc_dispatch returns,
+     * so the attributes echoed in the <rpc-reply> are copied
+     */
+    status_t res = NO_ERR;
+    xml_attr_t *attr = xml_get_first_attr(top);
+    for (; attr != NULL && res == NO_ERR; attr = xml_next_attr(attr)) {
+        if (attr->attr_qname == NULL || attr->attr_val == NULL) {
+            res = ERR_NCX_INVALID_VALUE;
+            continue;
+        }
+        uint32 plen = (uint32)(attr->attr_name - attr->attr_qname);
+        xml_attr_t *newattr =
+            xml_add_qattr(&edit->attrs, attr->attr_ns, attr->attr_qname,
+                          plen, attr->attr_val, &res);
+        if (newattr != NULL) {
+            newattr->attr_xmlns_ns = attr->attr_xmlns_ns;
+        }
+    }
+
+    /* save the <config> before the validate phase
+     * sets the edit operations on it
+     */
+    if (res == NO_ERR) {
+        edit->config = val_clone(srcval);
+        if (edit->config == NULL) {
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
+    if (res != NO_ERR) {
+        free_edit(edit);
+        return NULL;
+    }
+    return edit;
+
+}  /* new_edit */
+
+
+/********************************************************************
+* FUNCTION find_child_match
+*
+* Find the child node that edits the same instance as newchild
+*
+* INPUTS:
+*   parent == parent node in the group config
+*   newchild == child node from the new edit
+*
+* RETURNS:
+*   pointer to the matching child; NULL if none
+*********************************************************************/
+static val_value_t *
+    find_child_match (val_value_t *parent,
+                      val_value_t *newchild)
+{
+    val_value_t *chval = val_get_first_child(parent);
+    for (; chval != NULL; chval = val_get_next_child(chval)) {
+        if (chval->obj != newchild->obj) {
+            continue;
+        }
+        if (chval->btyp == NCX_BT_LIST) {
+            if (val_index_match(chval, newchild)) {
+                return chval;
+            }
+        } else if (obj_is_leaf_list(chval->obj)) {
+            if (val_compare(chval, newchild) == 0) {
+                return chval;
+            }
+        } else {
+            return chval;
+        }
+    }
+    return NULL;
+
+}  /* find_child_match */
+
+
+/********************************************************************
+* FUNCTION is_mergeable
+*
+* Check if the edits of 2 matching nodes can be combined
+* Only containers and list entries that are merged in both
+* edits are shared; all other matches are an overlap
+*
+* INPUTS:
+*   val == node to check
+*
+* RETURNS:
+*   TRUE if the node can be shared by 2 edits
+*********************************************************************/
+static boolean
+    is_mergeable (const val_value_t *val)
+{
+    if (!(val->btyp == NCX_BT_CONTAINER || val->btyp == NCX_BT_LIST)) {
+        return FALSE;
+    }
+    if (!(val->editop == OP_EDITOP_NONE || val->editop == OP_EDITOP_MERGE)) {
+        return FALSE;
+    }
+    if (val->editvars && val->editvars->insertop != OP_INSOP_NONE) {
+        return FALSE;
+    }
+    return TRUE;
+
+}  /* is_mergeable */
+
+
+/********************************************************************
+* FUNCTION edits_overlap
+*
+* Check if a new edit touches any node edited by the group
+*
+* INPUTS:
+*   curparent == node in the group config
+*   newparent == matching node in the new edit
+*
+* RETURNS:
+*   TRUE if the edits overlap
+*********************************************************************/
+static boolean
+    edits_overlap (val_value_t *curparent,
+                   val_value_t *newparent)
+{
+    val_value_t *newchild = val_get_first_child(newparent);
+    for (; newchild != NULL; newchild = val_get_next_child(newchild)) {
+        if (newparent->btyp == NCX_BT_LIST && obj_is_key(newchild->obj)) {
+            /* key leafs already matched */
+            continue;
+        }
+        val_value_t *curchild = find_child_match(curparent, newchild);
+        if (curchild == NULL) {
+            continue;
+        }
+        if (!is_mergeable(curchild) || !is_mergeable(newchild)) {
+            return TRUE;
+        }
+        if (edits_overlap(curchild, newchild)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+
+}  /* edits_overlap */
+
+
+/********************************************************************
+* FUNCTION merge_edit
+*
+* Move the nodes of a new edit into the group config
+* edits_overlap must have returned FALSE for these nodes
+*
+* INPUTS:
+*   curparent == node in the group config
+*   newparent == matching node in the new edit
+*
+* OUTPUTS:
+*   child nodes not already in curparent are moved from newparent
+*********************************************************************/
+static void
+    merge_edit (val_value_t *curparent,
+                val_value_t *newparent)
+{
+    val_value_t *newchild = val_get_first_child(newparent);
+    val_value_t *nextchild = NULL;
+    for (; newchild != NULL; newchild = nextchild) {
+        nextchild = val_get_next_child(newchild);
+        if (newparent->btyp == NCX_BT_LIST && obj_is_key(newchild->obj)) {
+            continue;
+        }
+        val_value_t *curchild = find_child_match(curparent, newchild);
+        if (curchild) {
+            merge_edit(curchild, newchild);
+        } else {
+            val_remove_child(newchild);
+            val_add_child(newchild, curparent);
+        }
+    }
+
+}  /* merge_edit */
+
+
+/********************************************************************
+* FUNCTION get_edit_config
+*
+* Get the <config> parameter from an <edit-config> that
+* could join a group; checks the request parameters only
+*
+* INPUTS:
+*   msg == rpc_msg_t in progress
+*   defop == address of return default-operation
+*
+* OUTPUTS:
+*   *defop == default-operation value
+*
+* RETURNS:
+*   pointer to the <config> parameter; NULL if this
+*   request cannot be grouped
+*********************************************************************/
+static val_value_t *
+    get_edit_config (rpc_msg_t *msg,
+                     op_editop_t *defop)
+{
+    obj_template_t *rpcobj = msg->rpc_method;
+    if (rpcobj == NULL || msg->rpc_input == NULL ||
+        obj_get_nsid(rpcobj) != xmlns_nc_id() ||
+        xml_strcmp(obj_get_name(rpcobj), NCX_EL_EDIT_CONFIG)) {
+        return NULL;
+    }
+
+    /* a post-reply callback would need the method node */
+    agt_rpc_cbset_t *cbset = (agt_rpc_cbset_t *)rpcobj->cbset;
+    if (cbset == NULL || cbset->acb[AGT_RPC_PH_POST_REPLY]) {
+        return NULL;
+    }
+
+    /* target must be <running/> */
+    val_value_t *val =
+        val_find_child(msg->rpc_input, NC_MODULE, NCX_EL_TARGET);
+    if (val == NULL || val->res != NO_ERR) {
+        return NULL;
+    }
+    val = val_get_first_child(val);
+    if (val == NULL || xml_strcmp(val->name, NCX_EL_RUNNING)) {
+        return NULL;
+    }
+
+    /* test-only requests do not change running */
+    val = val_find_child(msg->rpc_input, NC_MODULE, NCX_EL_TEST_OPTION);
+    if (val != NULL && (val->res != NO_ERR ||
+        op_testop_enum(VAL_ENUM_NAME(val)) == OP_TESTOP_TESTONLY)) {
+        return NULL;
+    }
+
+    /* replace would remove the nodes added by other edits */
+    *defop = OP_EDITOP_MERGE;
+    val = val_find_child(msg->rpc_input, NC_MODULE,
+                         NCX_EL_DEFAULT_OPERATION);
+    if (val != NULL) {
+        if (val->res != NO_ERR) {
+            return NULL;
+        }
+        *defop = op_defop_id(VAL_ENUM_NAME(val));
+    }
+    if (!(*defop == OP_EDITOP_MERGE || *defop == OP_EDITOP_NONE)) {
+        return NULL;
+    }
+
+    /* the <url> parameter is not grouped */
+    val = val_find_child(msg->rpc_input, NC_MODULE, NCX_EL_CONFIG);
+    if (val == NULL || val->res != NO_ERR) {
+        return NULL;
+    }
+    return val;
+
+}  /* get_edit_config */
+
+
+/********************************************************************
+* FUNCTION record_edit_error
+*
+* Make sure an error is recorded for a failed edit
+*
+* INPUTS:
+*   scb == session control block
+*   msg == held message
+*   res == error status
+*********************************************************************/
+static void
+    record_edit_error (ses_cb_t *scb,
+                       rpc_msg_t *msg,
+                       status_t res)
+{
+    if (rpc_err_any_errors(msg)) {
+        return;
+    }
+    agt_record_error(scb,
+                     &msg->mhdr,
+                     NCX_LAYER_OPERATION,
+                     res,
+                     NULL,
+                     NCX_NT_NONE,
+                     NULL,
+                     NCX_NT_NONE,
+                     NULL);
+
+}  /* record_edit_error */
+
+
+/********************************************************************
+* FUNCTION apply_group
+*
+* Validate and apply the combined <config> in one transaction
+*
+* INPUTS:
+*   scb == session used for access control and audit records
+*   target == running config
+*   auditQ == Q to get the audit records
+*
+* OUTPUTS:
+*   audit records for the edits are moved to auditQ
+*
+* RETURNS:
+*   status; if not NO_ERR running was not changed
+*********************************************************************/
+static status_t
+    apply_group (ses_cb_t *scb,
+                 cfg_template_t *target,
+                 dlq_hdr_t *auditQ)
+{
+    /* errors for the combined edit are not reported to
+     * any client; each edit is tried again if this fails
+     */
+    rpc_msg_t *msg = rpc_new_msg();
+    if (msg == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    status_t res = agt_acm_init_msg_cache(scb, &msg->mhdr);
+    if (res == NO_ERR) {
+        msg->rpc_txcb =
+            agt_cfg_new_transaction(NCX_CFGID_RUNNING,
+                                    AGT_CFG_EDIT_TYPE_PARTIAL,
+                                    TRUE,  /* rootcheck */
+                                    FALSE, /* is_validate */
+                                    FALSE, /* is_rollback */
+                                    &res);
+    }
+
+    if (res == NO_ERR) {
+        val_set_canonical_order(groupconfig);
+        res = agt_val_validate_write(scb, msg, target, groupconfig,
+                                     groupdefop);
+    }
+    if (res == NO_ERR) {
+        res = agt_val_apply_write(scb, msg, target, groupconfig,
+                                  groupdefop);
+    }
+    if (res == NO_ERR) {
+        dlq_block_enque(&msg->rpc_txcb->auditQ, auditQ);
+    }
+
+    agt_acm_clear_msg_cache(&msg->mhdr);
+    agt_cfg_free_transaction(msg->rpc_txcb);
+    msg->rpc_txcb = NULL;
+    rpc_free_msg(msg);
+    return res;
+
+}  /* apply_group */
+
+
+/********************************************************************
+* FUNCTION apply_one_edit
+*
+* Validate and apply one held edit in its own transaction
+* Errors are recorded in the held message
+*
+* INPUTS:
+*   scb == session control block for the edit
+*   edit == held edit to apply
+*   target == running config
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    apply_one_edit (ses_cb_t *scb,
+                    gcommit_edit_t *edit,
+                    cfg_template_t *target)
+{
+    rpc_msg_t *msg = edit->msg;
+    status_t res = NO_ERR;
+
+    msg->rpc_txcb =
+        agt_cfg_new_transaction(NCX_CFGID_RUNNING,
+                                AGT_CFG_EDIT_TYPE_PARTIAL,
+                                TRUE,  /* rootcheck */
+                                FALSE, /* is_validate */
+                                FALSE, /* is_rollback */
+                                &res);
+    if (res == NO_ERR) {
+        res = agt_val_validate_write(scb, msg, target, edit->srcval,
+                                     groupdefop);
+    }
+    if (res == NO_ERR) {
+        res = agt_val_apply_write(scb, msg, target, edit->srcval,
+                                  groupdefop);
+    }
+
+    if (res == NO_ERR) {
+        dlq_block_enque(&msg->rpc_txcb->auditQ, &edit->auditQ);
+    } else {
+        record_edit_error(scb, msg, res);
+    }
+
+    agt_cfg_free_transaction(msg->rpc_txcb);
+    msg->rpc_txcb = NULL;
+    return res;
+
+}  /* apply_one_edit */
+
+
+/********************************************************************
+* FUNCTION clear_group
+*
+* Free the group state after a commit
+*
+*********************************************************************/
+static void
+    clear_group (void)
+{
+    while (!dlq_empty(&editQ)) {
+        gcommit_edit_t *edit = (gcommit_edit_t *)dlq_deque(&editQ);
+        if (edit->msg) {
+            agt_acm_clear_msg_cache(&edit->msg->mhdr);
+            agt_cfg_free_transaction(edit->msg->rpc_txcb);
+            edit->msg->rpc_txcb = NULL;
+            rpc_free_msg(edit->msg);
+        }
+        free_edit(edit);
+    }
+    editcount = 0;
+
+    if (groupconfig) {
+        val_free_value(groupconfig);
+        groupconfig = NULL;
+    }
+    if (groupuser) {
+        m__free(groupuser);
+        groupuser = NULL;
+    }
+
+}  /* clear_group */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_init
+*
+* Initialize the group commit module data structures
+*
+*********************************************************************/
+void
+    agt_gcommit_init (void)
+{
+    if (agt_gcommit_init_done) {
+        return;
+    }
+
+    dlq_createSQue(&editQ);
+    editcount = 0;
+    curedit = NULL;
+    groupconfig = NULL;
+    groupdefop = OP_EDITOP_MERGE;
+    groupuser = NULL;
+    memset(&deadline, 0x0, sizeof(deadline));
+    agt_gcommit_init_done = TRUE;
+
+}  /* agt_gcommit_init */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_cleanup
+*
+* Cleanup the group commit module data structures
+* Any held requests are freed without a reply
+*
+*********************************************************************/
+void
+    agt_gcommit_cleanup (void)
+{
+    if (!agt_gcommit_init_done) {
+        return;
+    }
+
+    if (curedit) {
+        free_edit(curedit);
+        curedit = NULL;
+    }
+    clear_group();
+    agt_gcommit_init_done = FALSE;
+
+}  /* agt_gcommit_cleanup */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_prepare
+*
+* Check if an incoming RPC can join the pending group
+* Called by agt_rpc_dispatch after the input is parsed,
+* before the RPC validate callback
+*
+* If the message cannot join the group, the pending group
+* is committed first, so all the edits are done in order
+*
+* INPUTS:
+*   scb == session control block
+*   msg == rpc_msg_t in progress
+*   top == <rpc> element node with the attributes to save
+*          for the deferred <rpc-reply>
+*********************************************************************/
+void
+    agt_gcommit_prepare (ses_cb_t *scb,
+                         rpc_msg_t *msg,
+                         xml_node_t *top)
+{
+    if (!agt_gcommit_init_done) {
+        return;
+    }
+
+    if (curedit) {
+        SET_ERROR(ERR_INTERNAL_INIT_SEQ);
+        free_edit(curedit);
+        curedit = NULL;
+    }
+
+    const agt_profile_t *profile = agt_get_profile();
+    if (profile->agt_gcommit_window == 0) {
+        return;
+    }
+
+    op_editop_t defop = OP_EDITOP_MERGE;
+    val_value_t *srcval = NULL;
+    if (scb->type != SES_TYP_DUMMY && scb->username != NULL) {
+        srcval = get_edit_config(msg, &defop);
+    }
+
+    boolean canjoin = (srcval != NULL);
+    if (canjoin && editcount > 0) {
+        if (editcount >= AGT_GCOMMIT_MAX_EDITS ||
+            defop != groupdefop ||
+            xml_strcmp(scb->username, groupuser) ||
+            edits_overlap(groupconfig, srcval)) {
+            canjoin = FALSE;
+        }
+    }
+
+    if (!canjoin) {
+        agt_gcommit_flush();
+        if (srcval == NULL) {
+            return;
+        }
+    }
+
+    /* a new group may be started after the flush */
+    curedit = new_edit(scb, msg, top, srcval);
+    if (curedit && editcount == 0) {
+        groupdefop = defop;
+    }
+
+}  /* agt_gcommit_prepare */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_add
+*
+* Add a validated <edit-config> to the pending group
+* Called by the edit-config invoke callback instead of
+* agt_val_apply_write
+*
+* The transaction in msg->rpc_txcb is released so the next
+* edit can be validated
+*
+* INPUTS:
+*   msg == rpc_msg_t in progress
+*
+* RETURNS:
+*   TRUE if the edit was added to the group;
+*   FALSE if the caller must apply the edit now
+*********************************************************************/
+boolean
+    agt_gcommit_add (rpc_msg_t *msg)
+{
+    if (curedit == NULL || curedit->msg != msg) {
+        return FALSE;
+    }
+
+    ses_cb_t *scb = agt_ses_get_session_for_id(curedit->sid);
+    if (scb == NULL || scb->username == NULL) {
+        return FALSE;
+    }
+
+    if (editcount == 0) {
+        groupuser = xml_strdup(scb->username);
+        if (groupuser == NULL) {
+            return FALSE;
+        }
+        groupconfig = curedit->config;
+        curedit->config = NULL;
+
+        const agt_profile_t *profile = agt_get_profile();
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        uint64 usecs = (uint64)now.tv_usec +
+            ((uint64)profile->agt_gcommit_window * 1000);
+        deadline.tv_sec = now.tv_sec + (time_t)(usecs / 1000000);
+        deadline.tv_usec = (suseconds_t)(usecs % 1000000);
+    } else {
+        merge_edit(groupconfig, curedit->config);
+        val_free_value(curedit->config);
+        curedit->config = NULL;
+    }
+
+    /* the group edit runs in its own transaction at flush time */
+    agt_cfg_free_transaction(msg->rpc_txcb);
+    msg->rpc_txcb = NULL;
+
+    dlq_enque(curedit, &editQ);
+    editcount++;
+    curedit = NULL;
+
+    if (LOGDEBUG2) {
+        log_debug2("\nagt_gcommit: edit for session %u added to group (%u)",
+                   scb->sid, editcount);
+    }
+    return TRUE;
+
+}  /* agt_gcommit_add */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_hold
+*
+* Check if the <rpc-reply> for a message is deferred
+* Called by agt_rpc_dispatch after the invoke callback
+*
+* INPUTS:
+*   msg == rpc_msg_t in progress
+*
+* RETURNS:
+*   TRUE if the message is now owned by the group;
+*     the caller must not send the reply or free the message
+*   FALSE if the caller must finish the message as usual
+*********************************************************************/
+boolean
+    agt_gcommit_hold (rpc_msg_t *msg)
+{
+    if (curedit && curedit->msg == msg) {
+        /* not added: validate failed or test-only */
+        free_edit(curedit);
+        curedit = NULL;
+        return FALSE;
+    }
+
+    gcommit_edit_t *edit = (gcommit_edit_t *)dlq_lastEntry(&editQ);
+    if (edit == NULL || edit->msg != msg) {
+        return FALSE;
+    }
+
+    msg->rpc_in_attrs = &edit->attrs;
+    return TRUE;
+
+}  /* agt_gcommit_hold */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_ses_held
+*
+* Check if a session has a request waiting in the pending group
+*
+* INPUTS:
+*   sid == session ID to check
+*
+* RETURNS:
+*   TRUE if a reply for the session is held
+*********************************************************************/
+boolean
+    agt_gcommit_ses_held (ses_id_t sid)
+{
+    if (!agt_gcommit_init_done) {
+        return FALSE;
+    }
+
+    gcommit_edit_t *edit = (gcommit_edit_t *)dlq_firstEntry(&editQ);
+    for (; edit != NULL; edit = (gcommit_edit_t *)dlq_nextEntry(edit)) {
+        if (edit->sid == sid) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+
+}  /* agt_gcommit_ses_held */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_flush
+*
+* Commit the pending group now and send all the held replies
+* Does nothing if no edits are pending
+*
+*********************************************************************/
+void
+    agt_gcommit_flush (void)
+{
+    if (!agt_gcommit_init_done || editcount == 0) {
+        return;
+    }
+
+    cfg_template_t *target = cfg_get_config_id(NCX_CFGID_RUNNING);
+    const agt_profile_t *profile = agt_get_profile();
+    gcommit_edit_t *edit = NULL;
+    ses_cb_t *scb = NULL;
+    ses_cb_t *firstscb = NULL;
+    gcommit_edit_t *firstedit = NULL;
+    status_t res = NO_ERR;
+
+    /* the combined edit is done for the first live session */
+    for (edit = (gcommit_edit_t *)dlq_firstEntry(&editQ);
+         edit != NULL && firstscb == NULL;
+         edit = (gcommit_edit_t *)dlq_nextEntry(edit)) {
+        firstscb = agt_ses_get_session_for_id(edit->sid);
+        firstedit = edit;
+    }
+
+    if (firstscb == NULL || target == NULL) {
+        clear_group();
+        return;
+    }
+
+    if (LOGDEBUG) {
+        log_debug("\nagt_gcommit: committing %u edits", editcount);
+    }
+
+    /* a session that was closed gets no reply, but if the group
+     * is committed its edit is included
+     */
+    boolean anyok = FALSE;
+    res = apply_group(firstscb, target, &firstedit->auditQ);
+    if (res == NO_ERR) {
+        anyok = TRUE;
+    } else {
+        if (LOGINFO) {
+            log_info("\nagt_gcommit: group of %u edits failed (%s), "
+                     "applying each edit",
+                     editcount, get_error_string(res));
+        }
+
+        for (edit = (gcommit_edit_t *)dlq_firstEntry(&editQ);
+             edit != NULL;
+             edit = (gcommit_edit_t *)dlq_nextEntry(edit)) {
+            scb = agt_ses_get_session_for_id(edit->sid);
+            if (scb == NULL) {
+                continue;
+            }
+            if (apply_one_edit(scb, edit, target) == NO_ERR) {
+                anyok = TRUE;
+            }
+        }
+    }
+
+    /* check if the NV-storage needs to be updated; this is done
+     * once for the group instead of after each edit-config
+     */
+    res = NO_ERR;
+    if (anyok &&
+        profile->agt_targ == NCX_AGT_TARG_RUNNING &&
+        profile->agt_has_startup == FALSE) {
+
+        res = agt_ncx_cfg_save(target, FALSE);
+        if (res != NO_ERR) {
+            log_error("\nError: Save <running> to NV-storage failed (%s)",
+                      get_error_string(res));
+        }
+    }
+
+    /* send all the replies, then the sysConfigChange events */
+    for (edit = (gcommit_edit_t *)dlq_firstEntry(&editQ);
+         edit != NULL;
+         edit = (gcommit_edit_t *)dlq_nextEntry(edit)) {
+        scb = agt_ses_get_session_for_id(edit->sid);
+        if (scb && res != NO_ERR && !rpc_err_any_errors(edit->msg)) {
+            record_edit_error(scb, edit->msg, res);
+        }
+        agt_rpc_send_deferred_reply(scb, edit->msg);
+        edit->msg = NULL;
+    }
+
+    for (edit = (gcommit_edit_t *)dlq_firstEntry(&editQ);
+         edit != NULL;
+         edit = (gcommit_edit_t *)dlq_nextEntry(edit)) {
+        if (dlq_empty(&edit->auditQ)) {
+            continue;
+        }
+        scb = agt_ses_get_session_for_id(edit->sid);
+        agt_sys_send_sysConfigChange((scb) ? scb : firstscb,
+                                     &edit->auditQ);
+    }
+
+    clear_group();
+
+}  /* agt_gcommit_flush */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_check_window
+*
+* Commit the pending group if the window has expired
+* or the group is full
+*
+*********************************************************************/
+void
+    agt_gcommit_check_window (void)
+{
+    if (!agt_gcommit_init_done || editcount == 0) {
+        return;
+    }
+
+    if (editcount < AGT_GCOMMIT_MAX_EDITS) {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        if (timercmp(&now, &deadline, <)) {
+            return;
+        }
+    }
+
+    agt_gcommit_flush();
+
+}  /* agt_gcommit_check_window */
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_get_timeout
+*
+* Shorten a select timeout to the time left in the
+* group commit window, if a group is pending
+*
+* INPUTS:
+*   timeout == select timeout to check
+*
+* OUTPUTS:
+*   *timeout may be reduced
+*********************************************************************/
+void
+    agt_gcommit_get_timeout (struct timeval *timeout)
+{
+    if (!agt_gcommit_init_done || editcount == 0) {
+        return;
+    }
+
+    struct timeval now, left;
+    gettimeofday(&now, NULL);
+    if (timercmp(&now, &deadline, <)) {
+        timersub(&deadline, &now, &left);
+    } else {
+        timerclear(&left);
+    }
+
+    if (timercmp(&left, timeout, <)) {
+        *timeout = left;
+    }
+
+}  /* agt_gcommit_get_timeout */
+
+
+/* END file agt_gcommit.c */
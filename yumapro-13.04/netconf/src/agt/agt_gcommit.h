@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_agt_gcommit
+#define _H_agt_gcommit
+/*  FILE: agt_gcommit.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+   Group commit of <edit-config> requests on the running datastore
+
+   If --group-commit-window is set, compatible edits from
+   different sessions are held for up to the window time and
+   then applied in one transaction.  The <rpc-reply> for each
+   held request is sent when the group is committed.
+
+*/
+
+#include <sys/time.h>
+
+#ifndef _H_rpc
+#include "rpc.h"
+#endif
+
+#ifndef _H_ses
+#include "ses.h"
+#endif
+
+#ifndef _H_status
+#include "status.h"
+#endif
+
+#ifndef _H_val
+#include "val.h"
+#endif
+
+#ifndef _H_xml_util
+#include "xml_util.h"
+#endif
+
+/********************************************************************
+*                                                                   *
+*                         C O N S T A N T S                         *
+*                                                                   *
+*********************************************************************/
+
+/* max number of edits committed in one group */
+#define AGT_GCOMMIT_MAX_EDITS    64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+*                                                                   *
+*                        F U N C T I O N S                          *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_init
+*
+* Initialize the group commit module data structures
+*
+*********************************************************************/
+extern void
+    agt_gcommit_init (void);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_cleanup
+*
+* Cleanup the group commit module data structures
+* Any held requests are freed without a reply
+*
+*********************************************************************/
+extern void
+    agt_gcommit_cleanup (void);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_prepare
+*
+* Check if an incoming RPC can join the pending group
+* Called by agt_rpc_dispatch after the input is parsed,
+* before the RPC validate callback
+*
+* If the message cannot join the group, the pending group
+* is committed first, so all the edits are done in order
+*
+* INPUTS:
+*   scb == session control block
+*   msg == rpc_msg_t in progress
+*   top == <rpc> element node with the attributes to save
+*          for the deferred <rpc-reply>
+*********************************************************************/
+extern void
+    agt_gcommit_prepare (ses_cb_t *scb,
+                         rpc_msg_t *msg,
+                         xml_node_t *top);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_add
+*
+* Add a validated <edit-config> to the pending group
+* Called by the edit-config invoke callback instead of
+* agt_val_apply_write
+*
+* The transaction in msg->rpc_txcb is released so the next
+* edit can be validated
+*
+* INPUTS:
+*   msg == rpc_msg_t in progress
+*
+* RETURNS:
+*   TRUE if the edit was added to the group;
+*   FALSE if the caller must apply the edit now
+*********************************************************************/
+extern boolean
+    agt_gcommit_add (rpc_msg_t *msg);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_hold
+*
+* Check if the <rpc-reply> for a message is deferred
+* Called by agt_rpc_dispatch after the invoke callback
+*
+* INPUTS:
+*   msg == rpc_msg_t in progress
+*
+* RETURNS:
+*   TRUE if the message is now owned by the group;
+*     the caller must not send the reply or free the message
+*   FALSE if the caller must finish the message as usual
+*********************************************************************/
+extern boolean
+    agt_gcommit_hold (rpc_msg_t *msg);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_ses_held
+*
+* Check if a session has a request waiting in the pending group
+*
+* INPUTS:
+*   sid == session ID to check
+*
+* RETURNS:
+*   TRUE if a reply for the session is held
+*********************************************************************/
+extern boolean
+    agt_gcommit_ses_held (ses_id_t sid);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_flush
+*
+* Commit the pending group now and send all the held replies
+* Does nothing if no edits are pending
+*
+*********************************************************************/
+extern void
+    agt_gcommit_flush (void);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_check_window
+*
+* Commit the pending group if the window has expired
+* or the group is full
+*
+*********************************************************************/
+extern void
+    agt_gcommit_check_window (void);
+
+
+/********************************************************************
+* FUNCTION agt_gcommit_get_timeout
+*
+* Shorten a select timeout to the time left in the
+* group commit window, if a group is pending
+*
+* INPUTS:
+*   timeout == select timeout to check
+*
+* OUTPUTS:
+*   *timeout may be reduced
+*********************************************************************/
+extern void
+    agt_gcommit_get_timeout (struct timeval *timeout);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif            /* _H_agt_gcommit */
@@ -43,8 +43,10 @@ date         init     comment
 #include "agt_cb.h"
 #include "agt_if.h"
 #include "agt_rpc.h"
+#include "agt_sample.h"
 #include "agt_util.h"
 #include "cfg.h"
+#include "dlq.h"
 #include "getcb.h"
 #include "log.h"
 #include "ncxmod.h"
@@ -77,15 +79,42 @@ date         init     comment
 
 #define interfaces_N_counters        (const xmlChar *)"counters"
 
+#define interfaces_N_inBytesRate     (const xmlChar *)"inBytesRate"
+
+#define interfaces_N_outBytesRate    (const xmlChar *)"outBytesRate"
+
 #define interfaces_OID_counters (const xmlChar *)\
     "/interfaces/interface/counters"
 
+#define IF_PROC_FILE       "/proc/net/dev"
+
+/* max interface name length in /proc/net/dev, incl. EOS */
+#define IF_MAX_NAMELEN     32
+
+/* 8 receive and 8 transmit counters in /proc/net/dev */
+#define IF_NUM_COUNTERS    16
+
+/* index of the byte counters in if_stats_t counters */
+#define IF_IN_BYTES        0
+#define IF_OUT_BYTES       8
+
 /********************************************************************
 *                                                                   *
 *                           T Y P E S                               *
 *                                                                   *
 *********************************************************************/
 
+/* one interface line in a /proc/net/dev sample */
+typedef struct if_stats_t_ {
+    dlq_hdr_t     qhdr;
+    xmlChar       name[IF_MAX_NAMELEN];
+    uint64        counters[IF_NUM_COUNTERS];
+    uint32        numcounters;
+    boolean       ratevalid;
+    uint64        inBytesRate;     /* bytes per second */
+    uint64        outBytesRate;    /* bytes per second */
+} if_stats_t;
+
 
 /********************************************************************
 *                                                                   *
@@ -99,6 +128,9 @@ static boolean              agt_if_not_supported;
 
 static ncx_module_t         *ifmod;
 
+/* shared sampler for the /proc/net/dev file */
+static agt_sample_t         *ifsample;
+
 
 /********************************************************************
 * FUNCTION is_interfaces_supported
@@ -116,7 +148,7 @@ static boolean
     int              ret;
 
     memset(&statbuf, 0x0, sizeof(statbuf));
-    ret = stat("/proc/net/dev", &statbuf);
+    ret = stat(IF_PROC_FILE, &statbuf);
     if (ret == 0 && S_ISREG(statbuf.st_mode)) {
         return TRUE;
     }
@@ -292,84 +324,137 @@ static val_value_t *
 
 
 /********************************************************************
-* FUNCTION fill_if_counters
+* FUNCTION free_if_stats
 *
-* <get> operation handler for the interfaces/interface/counters node
+* Free a /proc/net/dev sample
+* Matches the agt_sample_free_fn_t template
 *
 * INPUTS:
-*   countersobj == object template with all the child node to use
-*   nameval == value node for the <name> key that is desired
-*   buffer == line from the /proc/net/dev file to read
-*   dstval == destination value to fill in
+*   data == Q of if_stats_t to free
+*********************************************************************/
+static void
+    free_if_stats (void *data)
+{
+    dlq_hdr_t    *statsQ;
+    if_stats_t   *stats;
+
+    statsQ = (dlq_hdr_t *)data;
+    while (!dlq_empty(statsQ)) {
+        stats = (if_stats_t *)dlq_deque(statsQ);
+        m__free(stats);
+    }
+    dlq_destroyQue(statsQ);
+
+}  /* free_if_stats */
+
+
+/********************************************************************
+* FUNCTION find_if_stats
 *
-* OUTPUTS:
-*   child nodes added to dstval->v.childQ if NO_ERR returned
+* Find the counters for an interface in a /proc/net/dev sample
+*
+* INPUTS:
+*   statsQ == Q of if_stats_t to check
+*   name == interface name to find
 *
 * RETURNS:
-*    status
-*    NO_ERR if this is the right line for the <name> key
-*      and everything filled in OK
-*    ERR_NCX_SKIPPED if this is the wrong line for this <name>
-*    some other error like ERR_INTERNAL_MEM
+*   pointer to the found entry or NULL if not found
 *********************************************************************/
-static status_t 
-    fill_if_counters (obj_template_t *countersobj,
-                      val_value_t *nameval,
-                      xmlChar *buffer,
-                      val_value_t  *dstval)
+static if_stats_t *
+    find_if_stats (dlq_hdr_t *statsQ,
+                   const xmlChar *name)
 {
-    obj_template_t        *childobj;
-    val_value_t           *childval;
-    xmlChar               *str, *name;
-    char                  *endptr;
-    status_t               res;
-    uint32                 leafcount;
-    uint64                 counter;
-    boolean                done;
+    if_stats_t   *stats;
 
-    res = NO_ERR;
-    leafcount = 0;
-    counter = 0;
-
-    /* get the start of the interface name */
-    str = buffer;
-    while (*str && isspace(*str)) {
-        str++;
+    for (stats = (if_stats_t *)dlq_firstEntry(statsQ);
+         stats != NULL;
+         stats = (if_stats_t *)dlq_nextEntry(stats)) {
+        if (!xml_strcmp(stats->name, name)) {
+            return stats;
+        }
     }
-    if (*str == '\0') {
-        /* not expecting a line with just whitespace on it */
-        return ERR_NCX_SKIPPED;
-    } else {
-        name = str++;
+    return NULL;
+
+}  /* find_if_stats */
+
+
+/********************************************************************
+* FUNCTION get_byte_rate
+*
+* Get the bytes per second between 2 samples of a byte counter
+*
+* INPUTS:
+*   newcount == counter in the new sample
+*   oldcount == counter in the previous sample
+*   msecs == milli-seconds between the samples
+*
+* RETURNS:
+*   bytes per second; 0 if the counter was reset
+*********************************************************************/
+static uint64
+    get_byte_rate (uint64 newcount,
+                   uint64 oldcount,
+                   uint32 msecs)
+{
+    if (newcount < oldcount || msecs == 0) {
+        return 0;
     }
+    return ((newcount - oldcount) * 1000) / msecs;
 
-    /* get the end of the interface name */
-    while (*str && *str != ':') {
-        str++;
+}  /* get_byte_rate */
+
+
+/********************************************************************
+* FUNCTION parse_if_line
+*
+* Parse one interface line from the /proc/net/dev file
+*
+* INPUTS:
+*   buffer == line from the /proc/net/dev file to parse
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == return status; ERR_NCX_SKIPPED if not an interface line
+*
+* RETURNS:
+*   malloced interface counters or NULL if some error
+*********************************************************************/
+static if_stats_t *
+    parse_if_line (xmlChar *buffer,
+                   status_t *res)
+{
+    if_stats_t    *stats;
+    xmlChar       *name, *str;
+    char          *endptr;
+    uint64         counter;
+    int            namelen;
+    boolean        done;
+
+    name = NULL;
+    namelen = 0;
+    *res = get_ifname_string(buffer, &name, &namelen);
+    if (*res != NO_ERR) {
+        return NULL;
     }
-    if (*str == '\0') {
-        /* not expecting a line with just foo on it */
-        return ERR_NCX_SKIPPED;
+
+    if (namelen >= IF_MAX_NAMELEN) {
+        log_error("\nError: /proc/net/dev interface name too long");
+        *res = ERR_NCX_SKIPPED;
+        return NULL;
     }
 
-    /* is this the requested interface line? */
-    if (xml_strncmp((const xmlChar *)name,
-                    VAL_STR(nameval),
-                    (uint32)(str - name))) {
-        /* not the right interface name */
-        return ERR_NCX_SKIPPED;
+    stats = m__getObj(if_stats_t);
+    if (stats == NULL) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
     }
+    memset(stats, 0x0, sizeof(if_stats_t));
+    xml_strncpy(stats->name, name, (uint32)namelen);
 
     /* get the str pointed at the first byte of the
      * 16 ordered counter values
      */
-    str++;
-
-    /* get the first counter object ready */
-    childobj = obj_first_child(countersobj);
-    if (childobj == NULL) {
-        return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
-    }
+    str = &name[namelen + 1];
 
     /* keep getting counters until the line runs out */
     done = FALSE;
@@ -379,34 +464,207 @@ static status_t
         if (counter == 0 && str == (xmlChar *)endptr) {
             /* number conversion failed */
             log_error("\nError: /proc/net/dev number conversion failed");
-            return ERR_NCX_OPERATION_FAILED;
-        }
-
-        childval = val_new_value();
-        if (childval == NULL) {
-            return ERR_INTERNAL_MEM;
+            m__free(stats);
+            *res = ERR_NCX_OPERATION_FAILED;
+            return NULL;
         }
-        val_init_from_template(childval, childobj);
-        VAL_ULONG(childval) = counter;
-        val_add_child(childval, dstval);
 
-        leafcount++;
+        stats->counters[stats->numcounters++] = counter;
 
         str = (xmlChar *)endptr;
-        if (*str == '\0' || *str == '\n') {
+        if (*str == '\0' || *str == '\n' ||
+            stats->numcounters == IF_NUM_COUNTERS) {
             done = TRUE;
-        } else {
-            childobj = obj_next_child(childobj);
-            if (childobj == NULL) {
-                done = TRUE;
+        }
+    }
+
+    return stats;
+
+}  /* parse_if_line */
+
+
+/********************************************************************
+* FUNCTION parse_if_sample
+*
+* Parse one sample of the /proc/net/dev file
+* Matches the agt_sample_parse_fn_t template
+*
+* The byte rates are computed from the previous sample,
+* which is still in sample->data
+*
+* INPUTS:
+*    see agt/agt_sample.h agt_sample_parse_fn_t for details
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    parse_if_sample (agt_sample_t *sample,
+                     FILE *fp,
+                     void **retdata)
+{
+    dlq_hdr_t             *statsQ;
+    if_stats_t            *stats, *oldstats;
+    xmlChar               *buffer;
+    status_t               res;
+    uint32                 linecount, msecs;
+
+    /* get a file read line buffer */
+    buffer = m__getMem(NCX_MAX_LINELEN);
+    if (buffer == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    statsQ = dlq_createQue();
+    if (statsQ == NULL) {
+        m__free(buffer);
+        return ERR_INTERNAL_MEM;
+    }
+    *retdata = statsQ;
+
+    msecs = agt_sample_get_age(sample);
+    res = NO_ERR;
+    linecount = 0;
+
+    /* loop through the file until done */
+    while (res == NO_ERR &&
+           fgets((char *)buffer, NCX_MAX_LINELEN, fp) != NULL) {
+
+        if (++linecount < 3) {
+            /* skip the header junk on the first 2 lines */
+            continue;
+        } 
+
+        stats = parse_if_line(buffer, &res);
+        if (stats == NULL) {
+            if (res == ERR_NCX_SKIPPED) {
+                res = NO_ERR;
             }
+            continue;
+        }
+
+        if (sample->data) {
+            oldstats = find_if_stats((dlq_hdr_t *)sample->data,
+                                     stats->name);
+            if (oldstats && msecs) {
+                stats->inBytesRate =
+                    get_byte_rate(stats->counters[IF_IN_BYTES],
+                                  oldstats->counters[IF_IN_BYTES],
+                                  msecs);
+                stats->outBytesRate =
+                    get_byte_rate(stats->counters[IF_OUT_BYTES],
+                                  oldstats->counters[IF_OUT_BYTES],
+                                  msecs);
+                stats->ratevalid = TRUE;
+            }
+        }
+
+        dlq_enque(stats, statsQ);
+    }
+
+    m__free(buffer);
+
+    return res;
+
+}  /* parse_if_sample */
+
+
+/********************************************************************
+* FUNCTION add_counter_leaf
+*
+* Add one counter leaf to the counters container
+*
+* INPUTS:
+*   childobj == object template for the counter leaf
+*   counter == counter value
+*   dstval == counters container to fill in
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    add_counter_leaf (obj_template_t *childobj,
+                      uint64 counter,
+                      val_value_t *dstval)
+{
+    val_value_t   *childval;
+
+    childval = val_new_value();
+    if (childval == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    val_init_from_template(childval, childobj);
+    VAL_ULONG(childval) = counter;
+    val_add_child(childval, dstval);
+    return NO_ERR;
+
+}  /* add_counter_leaf */
+
+
+/********************************************************************
+* FUNCTION fill_if_counters
+*
+* Fill in the counters container from a /proc/net/dev sample
+*
+* INPUTS:
+*   countersobj == object template with all the child node to use
+*   stats == sampled counters for the interface
+*   dstval == destination value to fill in
+*
+* OUTPUTS:
+*   child nodes added to dstval->v.childQ if NO_ERR returned
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t 
+    fill_if_counters (obj_template_t *countersobj,
+                      const if_stats_t *stats,
+                      val_value_t  *dstval)
+{
+    obj_template_t        *childobj;
+    status_t               res;
+    uint32                 leafcount;
+
+    res = NO_ERR;
+
+    /* the counter leafs are in the same order as the file */
+    childobj = obj_first_child(countersobj);
+    if (childobj == NULL) {
+        return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+    }
+
+    for (leafcount = 0;
+         leafcount < stats->numcounters && childobj != NULL && res == NO_ERR;
+         leafcount++) {
+        res = add_counter_leaf(childobj, 
+                               stats->counters[leafcount],
+                               dstval);
+        childobj = obj_next_child(childobj);
+    }
+
+    if (res == NO_ERR && stats->ratevalid) {
+        childobj = obj_find_child(countersobj,
+                                  interfaces_MOD,
+                                  interfaces_N_inBytesRate);
+        if (childobj) {
+            res = add_counter_leaf(childobj, stats->inBytesRate, dstval);
+        }
+    }
+
+    if (res == NO_ERR && stats->ratevalid) {
+        childobj = obj_find_child(countersobj,
+                                  interfaces_MOD,
+                                  interfaces_N_outBytesRate);
+        if (childobj) {
+            res = add_counter_leaf(childobj, stats->outBytesRate, dstval);
         }
     }
 
     if (LOGDEBUG2) {
         log_debug2("\nagt_if: filled %u of 16 counters for '%s'",
                    leafcount,
-                   VAL_STR(nameval));
+                   stats->name);
     }
 
     return res;
@@ -431,13 +689,10 @@ static status_t
                      val_value_t *virval,
                      val_value_t  *dstval)
 {
-    FILE                  *countersfile;
-    obj_template_t        *countersobj;
     val_value_t           *parentval, *nameval;
-    xmlChar               *buffer, *readtest;
-    boolean                done;
+    dlq_hdr_t             *statsQ;
+    const if_stats_t      *stats;
     status_t               res;
-    uint32                 linecount;
 
     (void)scb;
     res = NO_ERR;
@@ -446,8 +701,6 @@ static status_t
         return ERR_NCX_OPERATION_NOT_SUPPORTED;
     }
 
-    countersobj = virval->obj;
-
     /* get the interface parent entry for this counters entry */
     parentval = virval->parent;
     if (parentval == NULL) {
@@ -464,54 +717,19 @@ static status_t
         return SET_ERROR(ERR_INTERNAL_VAL);
     }        
 
-    /* open the /proc/net/dev file for reading */
-    countersfile = fopen("/proc/net/dev", "r");
-    if (countersfile == NULL) {
-        return errno_to_status();
-    }
-
-    /* get a file read line buffer */
-    buffer = m__getMem(NCX_MAX_LINELEN);
-    if (buffer == NULL) {
-        fclose(countersfile);
-        return ERR_INTERNAL_MEM;
+    /* get the shared /proc/net/dev sample */
+    statsQ = (dlq_hdr_t *)agt_sample_get_data(ifsample, &res);
+    if (statsQ == NULL) {
+        return res;
     }
 
-    /* loop through the file until done */
-    res = NO_ERR;
-    done = FALSE;
-    linecount = 0;
-
-    while (!done) {
-      readtest = (xmlChar *)
-	fgets((char *)buffer, NCX_MAX_LINELEN, countersfile);
-        if (readtest == NULL) {
-            done = TRUE;
-            continue;
-        } else {
-            linecount++;
-        }
-
-        if (linecount < 3) {
-            /* skip the header junk on the first 2 lines */
-            continue;
-        } 
-
-        res = fill_if_counters(countersobj,
-                               nameval, 
-                               buffer, 
-                               dstval);
-        if (res == ERR_NCX_SKIPPED) {
-            res = NO_ERR;
-        } else {
-            done = TRUE;
-        }
+    stats = find_if_stats(statsQ, VAL_STR(nameval));
+    if (stats == NULL) {
+        /* interface is gone; leave the counters empty */
+        return NO_ERR;
     }
 
-    fclose(countersfile);
-    m__free(buffer);
-
-    return res;
+    return fill_if_counters(virval->obj, stats, dstval);
 
 } /* get_if_counters */
 
@@ -533,15 +751,11 @@ INPUTS:
 static status_t
     add_interface_entries (val_value_t *interfacesval)
 {
-
-    FILE                  *countersfile;
     obj_template_t        *interfaceobj, *countersobj;
     val_value_t           *interfaceval, *countersval;
-    xmlChar               *buffer, *readtest, *ifname;
-    boolean                done;
+    dlq_hdr_t             *statsQ;
+    if_stats_t            *stats;
     status_t               res;
-    uint32                 linecount;
-    int                    ifnamelen;
 
     res = NO_ERR;
 
@@ -559,83 +773,43 @@ static status_t
         return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
     }
 
-    /* open the /proc/net/dev file for reading */
-    countersfile = fopen("/proc/net/dev", "r");
-    if (countersfile == NULL) {
-        return errno_to_status();
+    /* get the shared /proc/net/dev sample */
+    statsQ = (dlq_hdr_t *)agt_sample_get_data(ifsample, &res);
+    if (statsQ == NULL) {
+        return res;
     }
 
-    /* get a file read line buffer */
-    buffer = m__getMem(NCX_MAX_LINELEN);
-    if (buffer == NULL) {
-        fclose(countersfile);
-        return ERR_INTERNAL_MEM;
-    }
-
-    /* loop through the file until done */
-    res = NO_ERR;
-    done = FALSE;
-    linecount = 0;
-
-    while (!done) {
-      readtest = (xmlChar *)
-	fgets((char *)buffer, NCX_MAX_LINELEN, countersfile);
-        if (readtest == NULL) {
-            done = TRUE;
-            continue;
-        } else {
-            linecount++;
-        }
+    for (stats = (if_stats_t *)dlq_firstEntry(statsQ);
+         stats != NULL && res == NO_ERR;
+         stats = (if_stats_t *)dlq_nextEntry(stats)) {
 
-        if (linecount < 3) {
-            /* skip the header junk on the first 2 lines */
-            continue;
-        } 
-
-        ifname = NULL;
-        ifnamelen = 0;
-        res = get_ifname_string(buffer, &ifname, &ifnamelen);
-        if (res != NO_ERR) {
-            done = TRUE;
-        } else {
-            /* got the name string
-             * see if this entry is already present
-             */
-            interfaceval = find_interface_entry(interfacesval,
-                                                ifname,
-                                                ifnamelen);
+        /* see if this entry is already present */
+        interfaceval = find_interface_entry(interfacesval,
+                                            stats->name,
+                                            (int)xml_strlen(stats->name));
+        if (interfaceval == NULL) {
+            /* create a new entry */
+            interfaceval = make_interface_entry(interfaceobj,
+                                                stats->name,
+                                                &res);
             if (interfaceval == NULL) {
-                /* create a new entry */
-                res = NO_ERR;
-                ifname[ifnamelen] = 0;
-                interfaceval = make_interface_entry(interfaceobj,
-                                                    ifname,
-                                                    &res);
-                if (interfaceval == NULL) {
-                    done = TRUE;
-                    continue;
-                } else {
-                    val_add_child(interfaceval, interfacesval);
-                }
-            }
-
-            /* add the counters virtual node to the entry */
-            countersval = val_new_value();
-            if (countersval == NULL) {
-                res = ERR_INTERNAL_MEM;
-                done = TRUE;
                 continue;
             } else {
-                val_init_virtual(countersval,
-                                 get_if_counters,
-                                 countersobj);
-                val_add_child(countersval, interfaceval);
+                val_add_child(interfaceval, interfacesval);
             }
         }
-    }
 
-    fclose(countersfile);
-    m__free(buffer);
+        /* add the counters virtual node to the entry */
+        countersval = val_new_value();
+        if (countersval == NULL) {
+            res = ERR_INTERNAL_MEM;
+        } else {
+            val_init_virtual(countersval,
+                             get_if_counters,
+                             countersobj);
+            val_add_child(countersval, interfaceval);
+        }
+    }
 
     return res;
 
@@ -670,6 +844,7 @@ status_t
     log_debug2("\nagt: Loading interfaces module");
 
     ifmod = NULL;
+    ifsample = NULL;
     agt_if_not_supported = FALSE;
     agt_if_init_done = TRUE;
     agt_profile = agt_get_profile();
@@ -686,6 +861,14 @@ status_t
             log_debug("\nagt_interfaces: no /interfaces support found");
         }
         agt_if_not_supported = TRUE;
+    } else {
+        ifsample = agt_sample_register(IF_PROC_FILE,
+                                       parse_if_sample,
+                                       free_if_stats,
+                                       NULL);
+        if (ifsample == NULL && res == NO_ERR) {
+            res = ERR_INTERNAL_MEM;
+        }
     }
 
     return res;
@@ -770,6 +953,8 @@ void
     agt_if_cleanup (void)
 {
     if (agt_if_init_done) {
+        agt_sample_unregister(ifsample);
+        ifsample = NULL;
         ifmod = NULL;
         agt_if_init_done = FALSE;
     }
@@ -39,9 +39,12 @@ date         init     comment
 #include "agt_cb.h"
 #include "agt_cfg.h"
 #include "agt_cli.h"
+#include "agt_gcommit.h"
 #include "agt_ncx.h"
+#include "agt_refidx.h"
 #include "agt_rpc.h"
 #include "agt_rpcerr.h"
+#include "agt_rpcstat.h"
 #include "agt_ses.h"
 #include "agt_sys.h"
 #include "agt_state.h"
@@ -50,6 +53,7 @@ date         init     comment
 #include "agt_val.h"
 #include "cap.h"
 #include "cfg.h"
+#include "ncx_trace.h"
 #include "ncxmod.h"
 #include "obj.h"
 #include "op.h"
@@ -60,6 +64,8 @@ date         init     comment
 #include  "tstamp.h"
 #include  "val.h"
 #include  "xml_wr.h"
+#include  "xpath.h"
+#include  "xpath1.h"
 #include  "yangconst.h"
 
 /********************************************************************
@@ -734,6 +740,14 @@ static status_t
         return NO_ERR;
     }
 
+    /* check if the edit is held for a group commit;
+     * the group is applied and saved by agt_gcommit_flush
+     */
+    if (agt_gcommit_add(msg)) {
+        m__free(editparms);
+        return NO_ERR;
+    }
+
     /* apply the <config> into the target config */
     status_t res = agt_val_apply_write(scb, msg, target, srcval, defop);
 
@@ -2965,6 +2979,11 @@ static status_t
         res = agt_val_add_module_commit_tests(mod);
     }
 
+    if (res == NO_ERR && mod && module_added) {
+        /* the leafref index object table is built from all modules */
+        agt_refidx_invalidate();
+    }
+
     if (res == NO_ERR && mod && module_added) {
         /* add the <schema> node in netconf-state module */
         res = agt_state_add_module_schema(mod);
@@ -3393,6 +3412,400 @@ static status_t
 } /* restore_invoke */
 
 
+/********************************************************************
+* FUNCTION reset_rpc_statistics_invoke
+*
+* reset-rpc-statistics : invoke callback
+* 
+* INPUTS:
+*    see agt/agt_rpc.h
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t 
+    reset_rpc_statistics_invoke (ses_cb_t *scb,
+                                 rpc_msg_t *msg,
+                                 xml_node_t *methnode)
+{
+    (void)msg;
+    (void)methnode;
+
+    agt_rpcstat_reset();
+
+    if (LOGINFO) {
+        log_info("\nRPC statistics reset by session %u", SES_MY_SID(scb));
+    }
+
+    return NO_ERR;
+
+} /* reset_rpc_statistics_invoke */
+
+
+/********************************************************************
+* FUNCTION dump_trace_invoke
+*
+* dump-trace : invoke callback
+* 
+* INPUTS:
+*    see agt/agt_rpc.h
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t 
+    dump_trace_invoke (ses_cb_t *scb,
+                       rpc_msg_t *msg,
+                       xml_node_t *methnode)
+{
+    status_t        res = NO_ERR;
+    const xmlChar  *filename = NULL;
+    xmlChar        *filespec = NULL;
+    val_value_t    *testval, *newval = NULL;
+
+    testval = val_find_child(msg->rpc_input, AGT_YWSYS_MODULE,
+                             NCX_EL_FILENAME);
+    if (testval != NULL && testval->res == NO_ERR) {
+        filename = VAL_STR(testval);
+    }
+
+    if (!ncx_trace_enabled()) {
+        res = ERR_NCX_OPERATION_NOT_SUPPORTED;
+    } else {
+        filespec = ncx_trace_make_filespec(filename, &res);
+    }
+
+    if (filespec != NULL && res == NO_ERR) {
+        res = ncx_trace_dump(filespec);
+    }
+
+    if (res == NO_ERR) {
+        newval = val_make_string(val_get_nsid(msg->rpc_input),
+                                 NCX_EL_FILESPEC, filespec);
+        if (newval == NULL) {
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
+    if (res != NO_ERR) {
+        agt_record_error(scb, &msg->mhdr, NCX_LAYER_OPERATION, res, methnode,
+                         NCX_NT_NONE, NULL, NCX_NT_NONE, NULL);
+    } else {
+        if (LOGINFO) {
+            log_info("\nTrace buffer dumped to '%s' by session %u",
+                     filespec, SES_MY_SID(scb));
+        }
+        msg->rpc_data_type = RPC_DATA_YANG;
+        dlq_enque(newval, &msg->rpc_dataQ);
+    }
+
+    m__free(filespec);
+    return res;
+
+} /* dump_trace_invoke */
+
+
+/********************************************************************
+* FUNCTION read_path_allowed
+*
+* Check if the session user is allowed to read a value node
+* and all of its ancestors, so an RPC that returns the path
+* of a datastore node does not report a node that would be
+* left out of the <get-config> reply
+* 
+* INPUTS:
+*    scb == session control block making the request
+*    msg == XML header of the request in progress
+*    val == value node to check
+*
+* RETURNS:
+*    TRUE if the user can read the node
+*    FALSE if the node or an ancestor is not readable
+*********************************************************************/
+static boolean
+    read_path_allowed (ses_cb_t *scb,
+                       xml_msg_hdr_t *msg,
+                       val_value_t *val)
+{
+    for (; val != NULL; val = val->parent) {
+        if (val->obj != NULL && obj_is_root(val->obj)) {
+            break;
+        }
+        if (!agt_acm_val_read_allowed(msg, scb->username, val)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+
+} /* read_path_allowed */
+
+
+/********************************************************************
+* FUNCTION get_references_invoke
+*
+* get-references : invoke callback
+* 
+* INPUTS:
+*    see agt/agt_rpc.h
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t 
+    get_references_invoke (ses_cb_t *scb,
+                           rpc_msg_t *msg,
+                           xml_node_t *methnode)
+{
+    status_t         res = NO_ERR;
+    xpath_result_t  *result = NULL;
+    dlq_hdr_t        refQ;
+
+    dlq_createSQue(&refQ);
+
+    cfg_template_t *running = cfg_get_config_id(NCX_CFGID_RUNNING);
+    val_value_t *testval = val_find_child(msg->rpc_input, AGT_YWSYS_MODULE,
+                                          NCX_EL_TARGET);
+    if (testval == NULL || testval->res != NO_ERR ||
+        testval->xpathpcb == NULL) {
+        res = ERR_NCX_MISSING_PARM;
+    } else if (running == NULL || running->root == NULL) {
+        res = ERR_NCX_OPERATION_FAILED;
+    } else {
+        result = xpath1_eval_xmlexpr(scb->reader, testval->xpathpcb,
+                                     running->root, running->root,
+                                     FALSE, TRUE, &res);
+        if (result && res == NO_ERR && result->restype != XP_RT_NODESET) {
+            res = ERR_NCX_XPATH_NOT_NODESET;
+        }
+    }
+
+    if (res != NO_ERR) {
+        agt_record_error(scb, &msg->mhdr, NCX_LAYER_OPERATION, res, methnode,
+                         (testval) ? NCX_NT_STRING : NCX_NT_NONE,
+                         (testval) ? VAL_STRING(testval) : NULL,
+                         (testval) ? NCX_NT_VAL : NCX_NT_NONE, testval);
+        xpath_free_result(result);
+        return res;
+    }
+
+    xpath_resnode_t *resnode = xpath_get_first_resnode(result);
+    for (; resnode != NULL && res == NO_ERR;
+         resnode = xpath_get_next_resnode(resnode)) {
+        val_value_t *targetval = xpath_get_resnode_valptr(resnode);
+        if (read_path_allowed(scb, &msg->mhdr, targetval)) {
+            res = agt_refidx_get_references(targetval, &refQ);
+        }
+    }
+    xpath_free_result(result);
+
+    /* a leafref that points at more than 1 selected node
+     * is only added to refQ once
+     */
+    dlq_hdr_t resultQ;
+    dlq_createSQue(&resultQ);
+
+    ncx_backptr_t *backptr = ncx_first_backptr(&refQ);
+    for (; backptr != NULL && res == NO_ERR;
+         backptr = ncx_next_backptr(backptr)) {
+        val_value_t *refval = (val_value_t *)ncx_get_backptr_node(backptr);
+        if (!read_path_allowed(scb, &msg->mhdr, refval)) {
+            continue;
+        }
+
+        xmlChar *buff = NULL;
+        res = val_gen_instance_id(NULL, refval, NCX_IFMT_XPATH1, &buff);
+        if (res == NO_ERR) {
+            val_value_t *newval =
+                val_make_string(val_get_nsid(msg->rpc_input),
+                                NCX_EL_REFERENCE, buff);
+            if (newval == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else {
+                dlq_enque(newval, &resultQ);
+            }
+        }
+        if (buff) {
+            m__free(buff);
+        }
+    }
+    ncx_clean_backptrQ(&refQ);
+
+    if (res != NO_ERR) {
+        while (!dlq_empty(&resultQ)) {
+            val_free_value((val_value_t *)dlq_deque(&resultQ));
+        }
+        agt_record_error(scb, &msg->mhdr, NCX_LAYER_OPERATION, res, methnode,
+                         NCX_NT_NONE, NULL, NCX_NT_NONE, NULL);
+    } else {
+        msg->rpc_data_type = RPC_DATA_YANG;
+        dlq_block_enque(&resultQ, &msg->rpc_dataQ);
+    }
+
+    return res;
+
+} /* get_references_invoke */
+
+
+/* context for the compare-datastores diff callback */
+typedef struct compare_cb_t_ {
+    ses_cb_t        *scb;
+    xml_msg_hdr_t   *mhdr;
+    obj_template_t  *listobj;
+    obj_template_t  *pathobj;
+    obj_template_t  *opobj;
+    dlq_hdr_t        resultQ;   /* Q of val_value_t */
+} compare_cb_t;
+
+
+/********************************************************************
+* FUNCTION compare_diff_cb
+*
+* compare-datastores : add a difference entry to the output
+* 
+* INPUTS:
+*    see val_diff_fn_t in ncx/val.h
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t 
+    compare_diff_cb (val_value_t *val1,
+                     val_value_t *val2,
+                     op_editop_t editop,
+                     void *cookie)
+{
+    compare_cb_t *cmp = (compare_cb_t *)cookie;
+    val_value_t  *diffval = (val1) ? val1 : val2;
+    xmlChar      *buff = NULL;
+    status_t      res;
+
+    /* leave out differences the user could not see with <get-config> */
+    if (!read_path_allowed(cmp->scb, cmp->mhdr, diffval) ||
+        (val1 && val2 && !read_path_allowed(cmp->scb, cmp->mhdr, val2))) {
+        return NO_ERR;
+    }
+
+    res = val_gen_instance_id(NULL, diffval, NCX_IFMT_XPATH1, &buff);
+    if (res != NO_ERR) {
+        if (buff) {
+            m__free(buff);
+        }
+        return res;
+    }
+
+    val_value_t *listval = val_new_value();
+    if (listval == NULL) {
+        m__free(buff);
+        return ERR_INTERNAL_MEM;
+    }
+    val_init_from_template(listval, cmp->listobj);
+    dlq_enque(listval, &cmp->resultQ);
+
+    val_value_t *leafval = val_make_simval_obj(cmp->pathobj, buff, &res);
+    m__free(buff);
+    if (leafval == NULL) {
+        return res;
+    }
+    val_add_child(leafval, listval);
+
+    leafval = val_make_simval_obj(cmp->opobj, op_editop_name(editop), &res);
+    if (leafval == NULL) {
+        return res;
+    }
+    val_add_child(leafval, listval);
+
+    return NO_ERR;
+
+} /* compare_diff_cb */
+
+
+/********************************************************************
+* FUNCTION compare_datastores_invoke
+*
+* compare-datastores : invoke callback
+* 
+* INPUTS:
+*    see agt/agt_rpc.h
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t 
+    compare_datastores_invoke (ses_cb_t *scb,
+                               rpc_msg_t *msg,
+                               xml_node_t *methnode)
+{
+    status_t         res = NO_ERR;
+    cfg_template_t  *srccfg = NULL, *targcfg = NULL;
+    compare_cb_t     cmp;
+
+    memset(&cmp, 0x0, sizeof(compare_cb_t));
+    dlq_createSQue(&cmp.resultQ);
+    cmp.scb = scb;
+    cmp.mhdr = &msg->mhdr;
+
+    val_value_t *srcval = val_find_child(msg->rpc_input, AGT_YWSYS_MODULE,
+                                         NCX_EL_SOURCE);
+    val_value_t *targval = val_find_child(msg->rpc_input, AGT_YWSYS_MODULE,
+                                          NCX_EL_TARGET);
+    if (srcval == NULL || srcval->res != NO_ERR ||
+        targval == NULL || targval->res != NO_ERR) {
+        res = ERR_NCX_MISSING_PARM;
+    } else {
+        srccfg = cfg_get_config(VAL_ENUM_NAME(srcval));
+        targcfg = cfg_get_config(VAL_ENUM_NAME(targval));
+        if (srccfg == NULL || srccfg->root == NULL ||
+            targcfg == NULL || targcfg->root == NULL) {
+            res = ERR_NCX_CFG_NOT_FOUND;
+        }
+    }
+
+    if (res == NO_ERR) {
+        obj_template_t *outobj =
+            obj_find_child(msg->rpc_method, AGT_YWSYS_MODULE, YANG_K_OUTPUT);
+        if (outobj) {
+            cmp.listobj = obj_find_child(outobj, AGT_YWSYS_MODULE,
+                                         NCX_EL_DIFFERENCE);
+        }
+        if (cmp.listobj) {
+            cmp.pathobj = obj_find_child(cmp.listobj, AGT_YWSYS_MODULE,
+                                         NCX_EL_PATH);
+            cmp.opobj = obj_find_child(cmp.listobj, AGT_YWSYS_MODULE,
+                                       NCX_EL_OPERATION);
+        }
+        if (cmp.pathobj == NULL || cmp.opobj == NULL) {
+            res = SET_ERROR(ERR_INTERNAL_VAL);
+        }
+    }
+
+    if (res == NO_ERR) {
+        res = val_diff_digest(srccfg->root, targcfg->root,
+                              compare_diff_cb, &cmp);
+    }
+
+    val_value_t *newval = NULL;
+    if (res == NO_ERR) {
+        newval = val_make_string(val_get_nsid(msg->rpc_input),
+                                 NCX_EL_IDENTICAL,
+                                 (dlq_empty(&cmp.resultQ)) ? 
+                                 NCX_EL_TRUE : NCX_EL_FALSE);
+        if (newval == NULL) {
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
+    if (res != NO_ERR) {
+        while (!dlq_empty(&cmp.resultQ)) {
+            val_free_value((val_value_t *)dlq_deque(&cmp.resultQ));
+        }
+        agt_record_error(scb, &msg->mhdr, NCX_LAYER_OPERATION, res, methnode,
+                         NCX_NT_NONE, NULL, NCX_NT_NONE, NULL);
+    } else {
+        msg->rpc_data_type = RPC_DATA_YANG;
+        dlq_enque(newval, &msg->rpc_dataQ);
+        dlq_block_enque(&cmp.resultQ, &msg->rpc_dataQ);
+    }
+
+    return res;
+
+} /* compare_datastores_invoke */
+
+
 /********************************************************************
 * FUNCTION register_nc_callbacks
 *
@@ -3697,6 +4110,42 @@ static status_t
         if (res != NO_ERR) {
             return SET_ERROR(res);
         }
+
+        /* reset-rpc-statistics extension */
+        res = agt_rpc_register_method(AGT_YWSYS_MODULE, 
+                                      NCX_EL_RESET_RPC_STATISTICS,
+                                      AGT_RPC_PH_INVOKE,  
+                                      reset_rpc_statistics_invoke);
+        if (res != NO_ERR) {
+            return SET_ERROR(res);
+        }
+
+        /* dump-trace extension */
+        res = agt_rpc_register_method(AGT_YWSYS_MODULE, 
+                                      NCX_EL_DUMP_TRACE,
+                                      AGT_RPC_PH_INVOKE,  
+                                      dump_trace_invoke);
+        if (res != NO_ERR) {
+            return SET_ERROR(res);
+        }
+
+        /* get-references extension */
+        res = agt_rpc_register_method(AGT_YWSYS_MODULE, 
+                                      NCX_EL_GET_REFERENCES,
+                                      AGT_RPC_PH_INVOKE,  
+                                      get_references_invoke);
+        if (res != NO_ERR) {
+            return SET_ERROR(res);
+        }
+
+        /* compare-datastores extension */
+        res = agt_rpc_register_method(AGT_YWSYS_MODULE, 
+                                      NCX_EL_COMPARE_DATASTORES,
+                                      AGT_RPC_PH_INVOKE,  
+                                      compare_datastores_invoke);
+        if (res != NO_ERR) {
+            return SET_ERROR(res);
+        }
     }
         
 
@@ -3790,6 +4239,20 @@ static void
 
         /* restore extension */
         agt_rpc_unregister_method(AGT_YWSYS_MODULE, NCX_EL_RESTORE);
+
+        /* reset-rpc-statistics extension */
+        agt_rpc_unregister_method(AGT_YWSYS_MODULE, 
+                                  NCX_EL_RESET_RPC_STATISTICS);
+
+        /* dump-trace extension */
+        agt_rpc_unregister_method(AGT_YWSYS_MODULE, NCX_EL_DUMP_TRACE);
+
+        /* get-references extension */
+        agt_rpc_unregister_method(AGT_YWSYS_MODULE, NCX_EL_GET_REFERENCES);
+
+        /* compare-datastores extension */
+        agt_rpc_unregister_method(AGT_YWSYS_MODULE, 
+                                  NCX_EL_COMPARE_DATASTORES);
     }
 
 } /* unregister_nc_callbacks */
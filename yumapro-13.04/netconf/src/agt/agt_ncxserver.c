@@ -46,6 +46,7 @@ date         init     comment
 
 #include "procdefs.h"
 #include "agt.h"
+#include "agt_gcommit.h"
 #include "agt_ncxserver.h"
 #include "agt_not.h"
 #include "agt_rpc.h"
@@ -54,10 +55,12 @@ date         init     comment
 #include "def_reg.h"
 #include "log.h"
 #include "ncx.h"
+#include "ncx_trace.h"
 #include "ncxconst.h"
 #include "ses.h"
 #include "ses_msg.h"
 #include "status.h"
+#include "val.h"
 #include "xmlns.h"
 
 
@@ -73,10 +76,16 @@ date         init     comment
 /* number of notifications to send out in 1 timeout interval */
 #define MAX_NOTIFICATION_BURST  10
 
+/* number of async virtual value refreshes to do while
+ * the server is idle before checking for input again
+ */
+#define MAX_VIRTUAL_REFRESH  8
+
 
 static fd_set active_fd_set;
 static fd_set read_fd_set;
 static fd_set write_fd_set;
+static fd_set wait_fd_set;
 
 
 /********************************************************************
@@ -134,6 +143,31 @@ static status_t
 } /* make_named_socket */
 
 
+/********************************************************************
+ * FUNCTION dump_trace_buffer
+ * 
+ * Write the trace buffer to the default trace dump file
+ * after a SIGUSR1 signal
+ *
+ *********************************************************************/
+static void
+    dump_trace_buffer (void)
+{
+    status_t  res = NO_ERR;
+
+    xmlChar *filespec = ncx_trace_make_filespec(NULL, &res);
+    if (filespec != NULL && res == NO_ERR) {
+        res = ncx_trace_dump(filespec);
+    }
+    if (res != NO_ERR) {
+        log_error("\nError: trace dump failed (%s)",
+                  get_error_string(res));
+    }
+    m__free(filespec);
+
+} /* dump_trace_buffer */
+
+
 /********************************************************************
  * FUNCTION send_some_notifications
  * 
@@ -184,6 +218,45 @@ static void
 
 
 
+/********************************************************************
+ * FUNCTION requeue_output_wait
+ * 
+ * Put the sessions that were waiting for output but are not
+ * ready yet back on the outreadyQ.  The agt_ses_fill_writeset
+ * function drains the outreadyQ, so a session with output
+ * left in its outQ would be dropped from the write_fd_set
+ * if select returns before its socket is ready for output
+ * 
+ * INPUTS:
+ *    waitset == write_fd_set passed to select
+ *    readyset == write_fd_set returned by select
+ *                NULL if select failed
+ *    maxfdnum == highest fd in waitset
+ *********************************************************************/
+static void
+    requeue_output_wait (fd_set *waitset,
+                         fd_set *readyset,
+                         int maxfdnum)
+{
+    int i;
+
+    for (i = 0; i <= maxfdnum; i++) {
+        if (!FD_ISSET(i, waitset)) {
+            continue;
+        }
+        if (readyset && FD_ISSET(i, readyset)) {
+            /* the service loop will send some buffers */
+            continue;
+        }
+        ses_cb_t *scb = def_reg_find_scb(i);
+        if (scb && !dlq_empty(&scb->outQ)) {
+            ses_msg_make_outready(scb);
+        }
+    }
+
+} /* requeue_output_wait */
+
+
 /***********     E X P O R T E D   F U N C T I O N S   *************/
 
 
@@ -206,7 +279,7 @@ status_t
     struct timeval         timeout;
     socklen_t              size;
     status_t               res;
-    boolean                done, done2, stream_output;
+    boolean                done, done2, refresh;
 
     /* Create the socket and set it up to accept connections. */
     res = make_named_socket(NCXSERVER_SOCKNAME, &ncxsock);
@@ -222,8 +295,6 @@ status_t
         return SET_ERROR(ERR_INTERNAL_VAL);
     }
 
-    stream_output = profile->agt_stream_output;
-
     if (listen(ncxsock, 1) < 0) {
         log_error("\nError: listen failed");
         return ERR_NCX_OPERATION_FAILED;
@@ -248,10 +319,18 @@ status_t
         ret = 0;
         done2 = FALSE;
         while (!done2) {
+            /* check for a trace dump requested by SIGUSR1 */
+            if (ncx_trace_dump_requested()) {
+                dump_trace_buffer();
+            }
+
             read_fd_set = active_fd_set;
             agt_ses_fill_writeset(&write_fd_set, &maxwrnum);
-            timeout.tv_sec = AGT_NCXSERVER_TIMEOUT;
+            wait_fd_set = write_fd_set;
+            refresh = val_virtual_refresh_pending();
+            timeout.tv_sec = (refresh) ? 0 : AGT_NCXSERVER_TIMEOUT;
             timeout.tv_usec = 0;
+            agt_gcommit_get_timeout(&timeout);
 
             /* Block until input arrives on one or more active sockets. 
              * or the timer expires
@@ -261,6 +340,9 @@ status_t
                          &write_fd_set, 
                          NULL, 
                          &timeout);
+            requeue_output_wait(&wait_fd_set, 
+                                (ret < 0) ? NULL : &write_fd_set,
+                                maxwrnum);
             if (ret > 0) {
                 done2 = TRUE;
             } else if (ret < 0) {
@@ -268,10 +350,20 @@ status_t
                     done2 = TRUE;
                 }
             } else if (ret == 0) {
-                /* should only happen if a timeout occurred */
+                /* should only happen if a timeout occurred
+                 * commit the held edits if the group window expired
+                 */
+                agt_gcommit_check_window();
                 if (agt_shutdown_requested()) {
                     done2 = TRUE; 
                 } else {
+                    if (refresh) {
+                        /* nothing to read or write; refresh the stale
+                         * ncx:async-cache-refresh values now
+                         */
+                        (void)val_refresh_virtual_values(MAX_VIRTUAL_REFRESH);
+                    }
+
                     /* !! put all polling callbacks here for now !! */
                     agt_ses_check_timeouts();
                     agt_timer_handler();
@@ -303,8 +395,11 @@ status_t
         done2 = FALSE;
         for (i = 0; i < max(maxrdnum+1, maxwrnum+1) && !done2; i++) {
 
-            /* check write output to client sessions */
-            if (!stream_output && FD_ISSET(i, &write_fd_set)) {
+            /* check write output to client sessions
+             * in stream output mode the outQ only has the output
+             * the socket was not ready for when it was generated
+             */
+            if (FD_ISSET(i, &write_fd_set)) {
                 /* try to send 1 packet worth of buffers for a session */
                 scb = def_reg_find_scb(i);
                 if (scb) {
@@ -323,7 +418,8 @@ status_t
                                                  scb->sid,
                                                  SES_TR_OTHER);
                             scb = NULL;
-                        } else if (scb->state == SES_ST_SHUTDOWN_REQ) {
+                        } else if (scb->state == SES_ST_SHUTDOWN_REQ &&
+                                   dlq_empty(&scb->outQ)) {
                             /* close-session reply sent, now kill ses */
                             agt_ses_kill_session(scb, 
                                                  scb->killedbysid,
@@ -366,7 +462,7 @@ status_t
                         }
                     } else {
                         /* set non-blocking IO */
-                        if (fcntl(new, F_SETFD, O_NONBLOCK)) {
+                        if (fcntl(new, F_SETFL, O_NONBLOCK)) {
                             if (LOGINFO) {
                                 log_info("\nfnctl failed");
                             }
@@ -425,9 +521,13 @@ status_t
                     send_some_notifications();
                 }
             }
+            agt_gcommit_check_window();
         }
     }  /* end select loop */
 
+    /* commit any held edits before the sessions are closed */
+    agt_gcommit_flush();
+
     log_flush(); /* Clear out any pending (buffered) log output */
 
     /* all open client sockets will be closed as the sessions are
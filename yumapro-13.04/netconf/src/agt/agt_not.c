@@ -62,6 +62,7 @@ date         init     comment
 #include "cfg.h"
 #include "getcb.h"
 #include "log.h"
+#include "ncx_trace.h"
 #include "ncxmod.h"
 #include "ncxtypes.h"
 #include "rpc.h"
@@ -909,9 +910,12 @@ static status_t
 
     if (filterpassed) {
         /* send the notification */
+        NCX_TRACE_BEGIN(NCX_TRACE_NOTIF_SEND, sub->scb->sid,
+                        obj_get_name(notif->notobj));
         res = ses_start_msg(sub->scb);
         if (res != NO_ERR) {
             log_error("\nError: cannot start notification");
+            NCX_TRACE_END(NCX_TRACE_NOTIF_SEND, obj_get_name(notif->notobj));
             xml_msg_clean_hdr(&msghdr);
             return res;
         }
@@ -920,6 +924,7 @@ static status_t
                         ses_message_indent_count(sub->scb));
         ses_finish_msg(sub->scb);
         ses_stop_msg_mode(sub->scb);
+        NCX_TRACE_END(NCX_TRACE_NOTIF_SEND, obj_get_name(notif->notobj));
 
         sub->scb->stats.outNotifications++;
         totalstats->stats.outNotifications++;
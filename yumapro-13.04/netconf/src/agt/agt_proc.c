@@ -43,8 +43,10 @@ date         init     comment
 #include "agt_cb.h"
 #include "agt_proc.h"
 #include "agt_rpc.h"
+#include "agt_sample.h"
 #include "agt_util.h"
 #include "cfg.h"
+#include "dlq.h"
 #include "getcb.h"
 #include "log.h"
 #include "ncxmod.h"
@@ -77,6 +79,12 @@ date         init     comment
 
 #define proc_N_meminfo   (const xmlChar *)"meminfo"
 
+#define proc_OID_cpu     (const xmlChar *)"/proc/cpuinfo/cpu"
+
+#define PROC_CPUINFO_FILE   "/proc/cpuinfo"
+
+#define PROC_MEMINFO_FILE   "/proc/meminfo"
+
 /********************************************************************
 *                                                                   *
 *                           T Y P E S                               *
@@ -98,6 +106,11 @@ static val_value_t          *myprocval;
 
 static obj_template_t       *myprocobj;
 
+/* shared samplers for the /proc files */
+static agt_sample_t         *cpusample;
+
+static agt_sample_t         *meminfosample;
+
 
 /********************************************************************
 * FUNCTION is_proc_supported
@@ -115,11 +128,11 @@ static boolean
     int              ret;
 
     memset(&statbuf, 0x0, sizeof(statbuf));
-    ret = stat("/proc/meminfo", &statbuf);
+    ret = stat(PROC_MEMINFO_FILE, &statbuf);
     if (ret == 0 && S_ISREG(statbuf.st_mode)) {
         memset(&statbuf, 0x0, sizeof(statbuf));
 
-        ret = stat("/proc/cpuinfo", &statbuf);
+        ret = stat(PROC_CPUINFO_FILE, &statbuf);
         if (ret == 0 && S_ISREG(statbuf.st_mode)) {
             return TRUE;
         }
@@ -310,178 +323,371 @@ static val_value_t *
 
 
 /********************************************************************
-* FUNCTION add_cpuinfo
+* FUNCTION free_cpu_sample
 *
-* make a val_value_t struct for the /proc/cpuinfo file
-* and add it as a child to the specified container value
+* Free a /proc/cpuinfo sample
+* Matches the agt_sample_free_fn_t template
 *
-INPUTS:
-*   procval == parent value struct to add the cpuinfo as a child
+* INPUTS:
+*   data == Q of cpu list entries to free
+*********************************************************************/
+static void
+    free_cpu_sample (void *data)
+{
+    dlq_hdr_t      *cpuQ;
+    val_value_t    *cpuval;
+
+    cpuQ = (dlq_hdr_t *)data;
+    while (!dlq_empty(cpuQ)) {
+        cpuval = (val_value_t *)dlq_deque(cpuQ);
+        val_free_value(cpuval);
+    }
+    dlq_destroyQue(cpuQ);
+
+}  /* free_cpu_sample */
+
+
+/********************************************************************
+* FUNCTION add_cpu_entry
+*
+* Finish a cpu list entry read from /proc/cpuinfo and
+* add it to the sample
+*
+* INPUTS:
+*   cpuobj == cpu list object template
+*   cpuval == cpu entry to finish; memory is handed off here
+*   cpuQ == Q of cpu entries to add the entry to
 *
 * RETURNS:
 *   status
 *********************************************************************/
 static status_t
-    add_cpuinfo (val_value_t *procval)
+    add_cpu_entry (obj_template_t *cpuobj,
+                   val_value_t *cpuval,
+                   dlq_hdr_t *cpuQ)
 {
-    FILE                  *cpuinfofile;
-    obj_template_t        *cpuinfoobj, *cpuobj;
-    val_value_t           *cpuinfoval, *cpuval, *parmval;
-    char                  *buffer, *readtest;
-    boolean                done;
     status_t               res;
 
-    /* find the cpuinfo object */
-    cpuinfoobj = obj_find_child(myprocobj,
-                                proc_MOD,
-                                proc_N_cpuinfo);
-    if (cpuinfoobj == NULL) {
-        return ERR_NCX_DEF_NOT_FOUND;
+    res = val_gen_index_chain(cpuobj, cpuval);
+    if (res != NO_ERR) {
+        /* empty line in cpu entry, e.g. arm */
+        log_error("\nError:val_gen_index failed (%s)",
+                  get_error_string(res));
+        val_free_value(cpuval);
+    } else {
+        dlq_enque(cpuval, cpuQ);
     }
 
-    /* find the cpu object */
-    cpuobj = obj_find_child(cpuinfoobj,
-                            proc_MOD,
-                            proc_N_cpu);
-    if (cpuobj == NULL) {
-        return ERR_NCX_DEF_NOT_FOUND;
-    }
+    return NO_ERR;
 
-    /* open the /proc/cpuinfo file for reading */
-    cpuinfofile = fopen("/proc/cpuinfo", "r");
-    if (cpuinfofile == NULL) {
-        return errno_to_status();
-    }
+}  /* add_cpu_entry */
+
+
+/********************************************************************
+* FUNCTION parse_cpu_sample
+*
+* Parse one sample of the /proc/cpuinfo file
+* Matches the agt_sample_parse_fn_t template
+*
+* INPUTS:
+*    see agt/agt_sample.h agt_sample_parse_fn_t for details
+*    sample->cookie == cpu list object template
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    parse_cpu_sample (agt_sample_t *sample,
+                      FILE *fp,
+                      void **retdata)
+{
+    obj_template_t        *cpuobj;
+    dlq_hdr_t             *cpuQ;
+    val_value_t           *cpuval, *parmval;
+    char                  *buffer, *readtest;
+    boolean                done;
+    status_t               res;
+
+    cpuobj = (obj_template_t *)sample->cookie;
 
     /* get a file read line buffer */
     buffer = m__getMem(NCX_MAX_LINELEN);
     if (buffer == NULL) {
-        fclose(cpuinfofile);
         return ERR_INTERNAL_MEM;
     }
 
-    /* create cpuinfo container */
-    cpuinfoval = val_new_value();
-    if (cpuinfoval == NULL) {
+    cpuQ = dlq_createQue();
+    if (cpuQ == NULL) {
         m__free(buffer);
-        fclose(cpuinfofile);
         return ERR_INTERNAL_MEM;
     }
-    val_init_from_template(cpuinfoval, cpuinfoobj);
-
-    /* hand off cpuinfoval memory here */
-    val_add_child(cpuinfoval, procval);
+    *retdata = cpuQ;
 
     /* loop through the file until done */
     res = NO_ERR;
     cpuval = NULL;
     done = FALSE;
     while (!done) {
-        readtest = fgets(buffer, NCX_MAX_LINELEN, cpuinfofile);
+        readtest = fgets(buffer, NCX_MAX_LINELEN, fp);
         if (readtest == NULL) {
             done = TRUE;
             continue;
         }
 
+        if (strlen(buffer) == 1 && *buffer == '\n') {
+            /* end of the current CPU entry */
+            if (cpuval) {
+                res = add_cpu_entry(cpuobj, cpuval, cpuQ);
+                cpuval = NULL;
+            }
+            continue;
+        }
+
         if (cpuval == NULL) {
             cpuval = val_new_value();
             if (cpuval == NULL) {
                 res = ERR_INTERNAL_MEM;
                 done = TRUE;
                 continue;
-            } else {
-                val_init_from_template(cpuval, cpuobj);
-                /* hand off cpuval memory here */
-                val_add_child(cpuval, cpuinfoval);
             }
+            val_init_from_template(cpuval, cpuobj);
         } /* else already have an active 'cpu' entry */
 
-        if (strlen(buffer) == 1 && *buffer == '\n') {
-            /* force a new CPU entry */
-            if (cpuval) {
-                res = val_gen_index_chain(cpuobj, cpuval);
-                if (res == NO_ERR) {
-                    cpuval = NULL;
-                } else {
-                    log_error("\nError:val_gen_index failed (%s)",
-                              get_error_string(res));
-                }
-                /* else empty line in cpu entry, e.g. arm */
-            }
-        } else {
-            res = NO_ERR;
-            parmval = make_proc_leaf(buffer, cpuobj, &res);
-            if (parmval) {
-                val_add_child(parmval, cpuval);
-            }
+        parmval = make_proc_leaf(buffer, cpuobj, &res);
+        if (parmval) {
+            val_add_child(parmval, cpuval);
         }
+        res = NO_ERR;
     }
 
-    if (res == NO_ERR && cpuval) {
-        if (val_get_first_index(cpuval) == NULL) {
-            val_gen_index_chain(cpuobj, cpuval);
+    if (cpuval) {
+        if (res == NO_ERR) {
+            res = add_cpu_entry(cpuobj, cpuval, cpuQ);
+        } else {
+            val_free_value(cpuval);
         }
     }
-            
-    fclose(cpuinfofile);
+
     m__free(buffer);
 
     return res;
 
-}  /* add_cpuinfo */
+}  /* parse_cpu_sample */
 
 
 /********************************************************************
-* FUNCTION get_meminfo
+* FUNCTION get_cpu_entries
 *
-* <get> operation handler for the meminfo NP container
+* <get> operation list iterator for the cpu list
+* The entries are copied from the shared /proc/cpuinfo sample;
+* processor numbers are in ascending order
 *
 * INPUTS:
-*    see ncx/getcb.h getcb_fn_t for details
+*    see ncx/getcb.h getcb_iter_fn_t for details
 *
 * RETURNS:
 *    status
 *********************************************************************/
 static status_t 
-    get_meminfo (ses_cb_t *scb,
-                 getcb_mode_t cbmode,
-                 val_value_t *virval,
-                 val_value_t  *dstval)
+    get_cpu_entries (ses_cb_t *scb,
+                     getcb_iter_t *iter)
 {
-    FILE                  *meminfofile;
-    obj_template_t        *meminfoobj;
-    val_value_t           *parmval;
-    char                  *buffer, *readtest;
-    boolean                done;
+    dlq_hdr_t             *cpuQ;
+    val_value_t           *cpuval, *keyval, *copyval;
+    const val_index_t     *valindex;
     status_t               res;
+    uint32                 startnum, matchnum, processor;
+    const uint32          *startproc, *matchproc;
 
     (void)scb;
+
+    /* resume after the last processor in the previous batch */
+    startproc = NULL;
+    keyval = (val_value_t *)dlq_firstEntry(&iter->startkeyQ);
+    if (keyval) {
+        startnum = VAL_UINT(keyval);
+        startproc = &startnum;
+    }
+
+    /* check if the filter is looking for 1 processor */
+    matchproc = NULL;
+    for (keyval = (val_value_t *)dlq_firstEntry(&iter->matchQ);
+         keyval != NULL;
+         keyval = (val_value_t *)dlq_nextEntry(keyval)) {
+        if (obj_is_key(keyval->obj)) {
+            matchnum = VAL_UINT(keyval);
+            matchproc = &matchnum;
+        }
+    }
+
+    /* get the shared /proc/cpuinfo sample */
     res = NO_ERR;
+    cpuQ = (dlq_hdr_t *)agt_sample_get_data(cpusample, &res);
+    if (cpuQ == NULL) {
+        return res;
+    }
 
-    if (cbmode != GETCB_GET_VALUE) {
-        return ERR_NCX_OPERATION_NOT_SUPPORTED;
+    /* copy the requested entries until done or the batch is full */
+    for (cpuval = (val_value_t *)dlq_firstEntry(cpuQ);
+         cpuval != NULL;
+         cpuval = (val_value_t *)dlq_nextEntry(cpuval)) {
+
+        if (iter->maxentries &&
+            dlq_count(&iter->entryQ) >= iter->maxentries) {
+            return NO_ERR;
+        }
+
+        valindex = val_get_first_index(cpuval);
+        processor = VAL_UINT(valindex->val);
+        if ((startproc && processor <= *startproc) ||
+            (matchproc && processor != *matchproc)) {
+            continue;
+        }
+
+        copyval = val_clone(cpuval);
+        if (copyval == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        dlq_enque(copyval, &iter->entryQ);
+    }
+
+    iter->done = TRUE;
+    return NO_ERR;
+
+}  /* get_cpu_entries */
+
+
+/********************************************************************
+* FUNCTION add_cpuinfo
+*
+* make a val_value_t struct for the /proc/cpuinfo file
+* and add it as a child to the specified container value
+* The cpu list entries are retrieved with get_cpu_entries
+*
+INPUTS:
+*   procval == parent value struct to add the cpuinfo as a child
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_cpuinfo (val_value_t *procval)
+{
+    obj_template_t        *cpuinfoobj, *cpuobj;
+    val_value_t           *cpuinfoval, *cpuval;
+
+    /* find the cpuinfo object */
+    cpuinfoobj = obj_find_child(myprocobj,
+                                proc_MOD,
+                                proc_N_cpuinfo);
+    if (cpuinfoobj == NULL) {
+        return ERR_NCX_DEF_NOT_FOUND;
     }
 
-    meminfoobj = virval->obj;
+    /* find the cpu object */
+    cpuobj = obj_find_child(cpuinfoobj,
+                            proc_MOD,
+                            proc_N_cpu);
+    if (cpuobj == NULL) {
+        return ERR_NCX_DEF_NOT_FOUND;
+    }
 
-    /* open the /proc/meminfo file for reading */
-    meminfofile = fopen("/proc/meminfo", "r");
-    if (meminfofile == NULL) {
-        return errno_to_status();
+    /* read /proc/cpuinfo through a shared sample */
+    cpusample = agt_sample_register(PROC_CPUINFO_FILE,
+                                    parse_cpu_sample,
+                                    free_cpu_sample,
+                                    cpuobj);
+    if (cpusample == NULL) {
+        return ERR_INTERNAL_MEM;
     }
 
+    /* create cpuinfo container */
+    cpuinfoval = val_new_value();
+    if (cpuinfoval == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    val_init_from_template(cpuinfoval, cpuinfoobj);
+
+    /* hand off cpuinfoval memory here */
+    val_add_child(cpuinfoval, procval);
+
+    /* create the cpu virtual list place-holder */
+    cpuval = val_new_value();
+    if (cpuval == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    val_init_virtual_list(cpuval, cpuobj);
+
+    /* hand off cpuval memory here */
+    val_add_child(cpuval, cpuinfoval);
+
+    return NO_ERR;
+
+}  /* add_cpuinfo */
+
+
+/********************************************************************
+* FUNCTION free_meminfo_sample
+*
+* Free a /proc/meminfo sample
+* Matches the agt_sample_free_fn_t template
+*
+* INPUTS:
+*   data == meminfo container to free
+*********************************************************************/
+static void
+    free_meminfo_sample (void *data)
+{
+    val_free_value((val_value_t *)data);
+
+}  /* free_meminfo_sample */
+
+
+/********************************************************************
+* FUNCTION parse_meminfo_sample
+*
+* Parse one sample of the /proc/meminfo file
+* Matches the agt_sample_parse_fn_t template
+*
+* INPUTS:
+*    see agt/agt_sample.h agt_sample_parse_fn_t for details
+*    sample->cookie == meminfo object template
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    parse_meminfo_sample (agt_sample_t *sample,
+                          FILE *fp,
+                          void **retdata)
+{
+    obj_template_t        *meminfoobj;
+    val_value_t           *meminfoval, *parmval;
+    char                  *buffer, *readtest;
+    boolean                done;
+    status_t               res;
+
+    meminfoobj = (obj_template_t *)sample->cookie;
+
     /* get a file read line buffer */
     buffer = m__getMem(NCX_MAX_LINELEN);
     if (buffer == NULL) {
-        fclose(meminfofile);
         return ERR_INTERNAL_MEM;
     }
 
+    meminfoval = val_new_value();
+    if (meminfoval == NULL) {
+        m__free(buffer);
+        return ERR_INTERNAL_MEM;
+    }
+    val_init_from_template(meminfoval, meminfoobj);
+    *retdata = meminfoval;
+
     /* loop through the file until done */
     res = NO_ERR;
     done = FALSE;
     while (!done) {
-        readtest = fgets(buffer, NCX_MAX_LINELEN, meminfofile);
+        readtest = fgets(buffer, NCX_MAX_LINELEN, fp);
         if (readtest == NULL) {
             done = TRUE;
             continue;
@@ -493,16 +699,64 @@ static status_t
             res = NO_ERR;
             parmval = make_proc_leaf(buffer, meminfoobj, &res);
             if (parmval) {
-                val_add_child(parmval, dstval);
+                val_add_child(parmval, meminfoval);
             }
         }
     }
 
-    fclose(meminfofile);
     m__free(buffer);
 
     return res;
 
+}  /* parse_meminfo_sample */
+
+
+/********************************************************************
+* FUNCTION get_meminfo
+*
+* <get> operation handler for the meminfo NP container
+*
+* INPUTS:
+*    see ncx/getcb.h getcb_fn_t for details
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t 
+    get_meminfo (ses_cb_t *scb,
+                 getcb_mode_t cbmode,
+                 val_value_t *virval,
+                 val_value_t  *dstval)
+{
+    val_value_t           *meminfoval, *parmval, *copyval;
+    status_t               res;
+
+    (void)scb;
+    (void)virval;
+    res = NO_ERR;
+
+    if (cbmode != GETCB_GET_VALUE) {
+        return ERR_NCX_OPERATION_NOT_SUPPORTED;
+    }
+
+    /* get the shared /proc/meminfo sample */
+    meminfoval = (val_value_t *)agt_sample_get_data(meminfosample, &res);
+    if (meminfoval == NULL) {
+        return res;
+    }
+
+    for (parmval = val_get_first_child(meminfoval);
+         parmval != NULL;
+         parmval = val_get_next_child(parmval)) {
+        copyval = val_clone(parmval);
+        if (copyval == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        val_add_child(copyval, dstval);
+    }
+
+    return NO_ERR;
+
 } /* get_meminfo */
 
 
@@ -532,6 +786,15 @@ static status_t
         return ERR_NCX_DEF_NOT_FOUND;
     }
 
+    /* read /proc/meminfo through a shared sample */
+    meminfosample = agt_sample_register(PROC_MEMINFO_FILE,
+                                        parse_meminfo_sample,
+                                        free_meminfo_sample,
+                                        meminfoobj);
+    if (meminfosample == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
     /* create meminfo virtual NP container */
     meminfoval = val_new_value();
     if (meminfoval == NULL) {
@@ -577,6 +840,8 @@ status_t
     procmod = NULL;
     myprocval = NULL;
     myprocobj = NULL;
+    cpusample = NULL;
+    meminfosample = NULL;
     agt_proc_init_done = TRUE;
 
     /* load the netconf-state module */
@@ -584,6 +849,14 @@ status_t
                              proc_MOD_REV,
                              &agt_profile->agt_savedevQ,
                              &procmod);
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    res = agt_cb_register_iter_callback(proc_MOD,
+                                        proc_OID_cpu,
+                                        proc_MOD_REV,
+                                        get_cpu_entries);
 
     return res;
 
@@ -670,6 +943,11 @@ void
     agt_proc_cleanup (void)
 {
     if (agt_proc_init_done) {
+        agt_cb_unregister_callbacks(proc_MOD, proc_OID_cpu);
+        agt_sample_unregister(cpusample);
+        cpusample = NULL;
+        agt_sample_unregister(meminfosample);
+        meminfosample = NULL;
         procmod = NULL;
         myprocval = NULL;
         myprocval = NULL;
@@ -0,0 +1,1623 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: agt_refidx.c
+
+   Reverse reference index for leafref nodes in the running config
+
+   Without the index, the require-instance test evaluates the
+   leafref path for every leafref instance in the datastore,
+   and deleting a target node does not tell the root check
+   which leafref nodes need to be checked again.
+
+   The index has 3 hash tables:
+     - objects: each config leafref object, each leafref target
+       object, and all their ancestors (so the data tree walk
+       can skip unrelated subtrees)
+     - keys: one entry for each (target object, value) pair,
+       with a Q of the target instances that have this value
+       and a Q of the leafref instances that use this value
+     - nodes: maps a val_value_t pointer to its entry in a
+       key Q, so a node can be removed without its old value
+
+   The index is built from the running config the first time
+   it is needed.  After that, each node is removed from the index
+   when an undo record is created for it, and the nodes that are
+   still in the tree are added again before the root check.
+   The index is dropped if the running config was changed by
+   a transaction that was not tracked (last_txid mismatch)
+   or if a transaction that changed the index is rolled back.
+
+   Leafref paths are only skipped entirely if the path is an
+   absolute path with no predicates, because that path selects
+   every instance of the target object.  For other paths the
+   index can only prove that no target exists; if one exists
+   the path is still evaluated.  Targets with a type that
+   has no simple canonical string form are not indexed.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+
+#include "procdefs.h"
+#include "agt_cfg.h"
+#include "agt_refidx.h"
+#include "bobhash.h"
+#include "cfg.h"
+#include "dlq.h"
+#include "log.h"
+#include "ncx.h"
+#include "ncxconst.h"
+#include "obj.h"
+#include "status.h"
+#include "typ.h"
+#include "val.h"
+#include "xml_util.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+#define REFIDX_HASH_INIT      0x5bd1e995
+
+#define REFIDX_MIN_BUCKETS    64
+
+/* refidx_obj_t flags */
+#define REFIDX_FL_REF         bit0   /* config leafref object */
+#define REFIDX_FL_TARGET      bit1   /* leafref target object */
+#define REFIDX_FL_PATH        bit2   /* ancestor of a REF or TARGET */
+#define REFIDX_FL_SIMPLE      bit3   /* path selects all targobj nodes */
+#define REFIDX_FL_PARTIAL     bit4   /* some target nodes not indexed */
+
+/* get the refidx_node_t for a nodetab entry */
+#define REFIDX_NODE(H) \
+    ((refidx_node_t *)((char *)(H) - offsetof(refidx_node_t, hent)))
+
+
+/********************************************************************
+*                                                                   *
+*                           T Y P E S                               *
+*                                                                   *
+*********************************************************************/
+
+/* hash table entry header; first field in refidx_obj_t and
+ * refidx_key_t; refidx_node_t needs qhdr first for the key Qs */
+typedef struct refidx_hent_t_ {
+    struct refidx_hent_t_ *hnext;
+    uint32                 hash;
+} refidx_hent_t;
+
+/* chained hash table */
+typedef struct refidx_table_t_ {
+    refidx_hent_t  **buckets;
+    uint32           size;      /* power of 2 */
+    uint32           count;
+} refidx_table_t;
+
+/* one object used by the index */
+typedef struct refidx_obj_t_ {
+    refidx_hent_t    hent;
+    obj_template_t  *obj;
+    obj_template_t  *targobj;   /* set for REFIDX_FL_REF */
+    uint32           flags;
+} refidx_obj_t;
+
+/* one (target object, value) pair */
+typedef struct refidx_key_t_ {
+    refidx_hent_t    hent;
+    obj_template_t  *targobj;
+    xmlChar         *value;
+    boolean          impacted;
+    dlq_hdr_t        targQ;     /* Q of refidx_node_t */
+    dlq_hdr_t        refQ;      /* Q of refidx_node_t */
+} refidx_key_t;
+
+/* one target or leafref instance */
+typedef struct refidx_node_t_ {
+    dlq_hdr_t        qhdr;
+    refidx_hent_t    hent;
+    val_value_t     *val;
+    refidx_key_t    *key;
+    boolean          isref;
+    uint32           ref_gen;   /* last get_references pass */
+} refidx_node_t;
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static boolean              agt_refidx_init_done = FALSE;
+
+/* TRUE if the tables match the running config */
+static boolean              refidx_valid;
+
+/* TRUE while a root check is using the index */
+static boolean              refidx_active;
+
+/* running config root and last_txid the index was built for */
+static val_value_t         *refidx_root;
+static ncx_transaction_id_t refidx_txid;
+
+static refidx_table_t       objtab;
+static refidx_table_t       keytab;
+static refidx_table_t       nodetab;
+
+/* pass number used to skip leafref nodes that are already
+ * in the get_references output Q */
+static uint32               refidx_ref_gen;
+
+/* Q of ncx_backptr_t to refidx_key_t; keys that lost a target */
+static dlq_hdr_t            impactQ;
+
+/* txid of the last transaction that changed the index */
+static ncx_transaction_id_t refidx_edit_txid;
+
+/* txid of the last transaction that updated the index
+ * for a root check */
+static ncx_transaction_id_t refidx_check_txid;
+
+
+/********************************************************************
+* FUNCTION hash_ptr
+*
+* Get the hash value for a pointer
+*
+* INPUTS:
+*   ptr == pointer to hash
+*
+* RETURNS:
+*   hash value
+*********************************************************************/
+static uint32
+    hash_ptr (const void *ptr)
+{
+    return bobhash((const uint8 *)&ptr, sizeof(ptr), REFIDX_HASH_INIT);
+
+}  /* hash_ptr */
+
+
+/********************************************************************
+* FUNCTION hash_key
+*
+* Get the hash value for a (target object, value) pair
+*
+* INPUTS:
+*   targobj == target object
+*   value == value string
+*
+* RETURNS:
+*   hash value
+*********************************************************************/
+static uint32
+    hash_key (const obj_template_t *targobj,
+              const xmlChar *value)
+{
+    return bobhash((const uint8 *)value, xml_strlen(value),
+                   hash_ptr(targobj));
+
+}  /* hash_key */
+
+
+/********************************************************************
+* FUNCTION table_clean
+*
+* Free the bucket array of a hash table
+* The entries must be freed by the caller
+*
+* INPUTS:
+*   tab == table to clean
+*********************************************************************/
+static void
+    table_clean (refidx_table_t *tab)
+{
+    if (tab->buckets) {
+        m__free(tab->buckets);
+    }
+    memset(tab, 0x0, sizeof(refidx_table_t));
+
+}  /* table_clean */
+
+
+/********************************************************************
+* FUNCTION table_add
+*
+* Add an entry to a hash table; grow the table if needed
+* The hent->hash field must be set
+*
+* INPUTS:
+*   tab == table to use
+*   hent == entry to add
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    table_add (refidx_table_t *tab,
+               refidx_hent_t *hent)
+{
+    if (tab->count >= tab->size) {
+        uint32 newsize = (tab->size) ? tab->size * 2 : REFIDX_MIN_BUCKETS;
+        refidx_hent_t **newbuckets = (refidx_hent_t **)
+            m__getMem(newsize * sizeof(refidx_hent_t *));
+        if (newbuckets == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        memset(newbuckets, 0x0, newsize * sizeof(refidx_hent_t *));
+
+        uint32 i = 0;
+        for (; i < tab->size; i++) {
+            refidx_hent_t *h = tab->buckets[i];
+            while (h) {
+                refidx_hent_t *nexth = h->hnext;
+                uint32 b = h->hash & (newsize - 1);
+                h->hnext = newbuckets[b];
+                newbuckets[b] = h;
+                h = nexth;
+            }
+        }
+        if (tab->buckets) {
+            m__free(tab->buckets);
+        }
+        tab->buckets = newbuckets;
+        tab->size = newsize;
+    }
+
+    uint32 b = hent->hash & (tab->size - 1);
+    hent->hnext = tab->buckets[b];
+    tab->buckets[b] = hent;
+    tab->count++;
+    return NO_ERR;
+
+}  /* table_add */
+
+
+/********************************************************************
+* FUNCTION table_remove
+*
+* Remove an entry from a hash table
+*
+* INPUTS:
+*   tab == table to use
+*   hent == entry to remove
+*********************************************************************/
+static void
+    table_remove (refidx_table_t *tab,
+                  refidx_hent_t *hent)
+{
+    if (tab->size == 0) {
+        return;
+    }
+
+    refidx_hent_t **prev = &tab->buckets[hent->hash & (tab->size - 1)];
+    for (; *prev != NULL; prev = &(*prev)->hnext) {
+        if (*prev == hent) {
+            *prev = hent->hnext;
+            hent->hnext = NULL;
+            tab->count--;
+            return;
+        }
+    }
+
+}  /* table_remove */
+
+
+/********************************************************************
+* FUNCTION table_first
+*
+* Get the first entry in a hash chain
+*
+* INPUTS:
+*   tab == table to use
+*   hash == hash value to find
+*
+* RETURNS:
+*   first entry in the chain for this hash (may not match)
+*********************************************************************/
+static refidx_hent_t *
+    table_first (refidx_table_t *tab,
+                 uint32 hash)
+{
+    if (tab->size == 0) {
+        return NULL;
+    }
+    return tab->buckets[hash & (tab->size - 1)];
+
+}  /* table_first */
+
+
+/********************************************************************
+* FUNCTION get_value_string
+*
+* Get the string form of a leafref or target value
+*
+* INPUTS:
+*   val == value node to use
+*   buff == address of return malloced buffer
+*
+* OUTPUTS:
+*   *buff is set if the string was malloced; the caller
+*   must free it
+*
+* RETURNS:
+*   value string or NULL if this value type is not indexed
+*********************************************************************/
+static const xmlChar *
+    get_value_string (val_value_t *val,
+                      xmlChar **buff)
+{
+    *buff = NULL;
+
+    switch (val->btyp) {
+    case NCX_BT_STRING:
+    case NCX_BT_LEAFREF:
+        return (VAL_STR(val)) ? VAL_STR(val) : EMPTY_STRING;
+    case NCX_BT_ENUM:
+        return VAL_ENUM_NAME(val);
+    case NCX_BT_BOOLEAN:
+    case NCX_BT_INT8:
+    case NCX_BT_INT16:
+    case NCX_BT_INT32:
+    case NCX_BT_INT64:
+    case NCX_BT_UINT8:
+    case NCX_BT_UINT16:
+    case NCX_BT_UINT32:
+    case NCX_BT_UINT64:
+        *buff = val_make_sprintf_string(val);
+        return *buff;
+    default:
+        return NULL;
+    }
+
+}  /* get_value_string */
+
+
+/********************************************************************
+* FUNCTION type_is_indexed
+*
+* Check if a target object type can be indexed
+*
+* INPUTS:
+*   btyp == base type of the target object
+*
+* RETURNS:
+*   TRUE if get_value_string supports this type
+*********************************************************************/
+static boolean
+    type_is_indexed (ncx_btype_t btyp)
+{
+    switch (btyp) {
+    case NCX_BT_STRING:
+    case NCX_BT_LEAFREF:
+    case NCX_BT_ENUM:
+    case NCX_BT_BOOLEAN:
+    case NCX_BT_INT8:
+    case NCX_BT_INT16:
+    case NCX_BT_INT32:
+    case NCX_BT_INT64:
+    case NCX_BT_UINT8:
+    case NCX_BT_UINT16:
+    case NCX_BT_UINT32:
+    case NCX_BT_UINT64:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+
+}  /* type_is_indexed */
+
+
+/********************************************************************
+* FUNCTION find_obj
+*
+* Find the index record for an object
+*
+* INPUTS:
+*   obj == object to find
+*
+* RETURNS:
+*   pointer to record or NULL if the object is not used
+*********************************************************************/
+static refidx_obj_t *
+    find_obj (const obj_template_t *obj)
+{
+    uint32 hash = hash_ptr(obj);
+    refidx_hent_t *h = table_first(&objtab, hash);
+    for (; h != NULL; h = h->hnext) {
+        if (h->hash == hash && ((refidx_obj_t *)h)->obj == obj) {
+            return (refidx_obj_t *)h;
+        }
+    }
+    return NULL;
+
+}  /* find_obj */
+
+
+/********************************************************************
+* FUNCTION add_obj
+*
+* Add flags to the index record for an object and mark
+* all its ancestors; create the records if needed
+*
+* INPUTS:
+*   obj == object to add
+*   flags == flags to set
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == status
+*
+* RETURNS:
+*   pointer to record or NULL if malloc error
+*********************************************************************/
+static refidx_obj_t *
+    add_obj (obj_template_t *obj,
+             uint32 flags,
+             status_t *res)
+{
+    refidx_obj_t *rec = NULL;
+
+    *res = NO_ERR;
+    while (obj && !obj_is_root(obj)) {
+        refidx_obj_t *testrec = find_obj(obj);
+        if (testrec == NULL) {
+            testrec = m__getObj(refidx_obj_t);
+            if (testrec == NULL) {
+                *res = ERR_INTERNAL_MEM;
+                return NULL;
+            }
+            memset(testrec, 0x0, sizeof(refidx_obj_t));
+            testrec->obj = obj;
+            testrec->hent.hash = hash_ptr(obj);
+            *res = table_add(&objtab, &testrec->hent);
+            if (*res != NO_ERR) {
+                m__free(testrec);
+                return NULL;
+            }
+        } else if (rec && (testrec->flags & REFIDX_FL_PATH)) {
+            /* ancestors already marked */
+            return rec;
+        }
+
+        testrec->flags |= flags;
+        if (rec == NULL) {
+            rec = testrec;
+        }
+        flags = REFIDX_FL_PATH;
+        obj = obj->parent;
+    }
+    return rec;
+
+}  /* add_obj */
+
+
+/********************************************************************
+* FUNCTION add_object_tree
+*
+* Add the leafref objects in a config object subtree
+*
+* INPUTS:
+*   obj == object to check
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_object_tree (obj_template_t *obj)
+{
+    status_t res = NO_ERR;
+
+    if (obj_is_leafy(obj)) {
+        if (obj_get_basetype(obj) != NCX_BT_LEAFREF) {
+            return NO_ERR;
+        }
+
+        obj_template_t *targobj = obj_get_leafref_targobj(obj);
+        if (targobj == NULL ||
+            !type_is_indexed(obj_get_basetype(targobj))) {
+            return NO_ERR;
+        }
+
+        (void)add_obj(targobj, REFIDX_FL_TARGET, &res);
+        if (res != NO_ERR) {
+            return res;
+        }
+
+        uint32 flags = REFIDX_FL_REF;
+        const xmlChar *path = typ_get_leafref_path(obj_get_typdef(obj));
+        if (path && *path == '/' && !strchr((const char *)path, '[')) {
+            flags |= REFIDX_FL_SIMPLE;
+        }
+
+        refidx_obj_t *rec = add_obj(obj, flags, &res);
+        if (rec) {
+            rec->targobj = targobj;
+        }
+        return res;
+    }
+
+    obj_template_t *chobj = obj_first_child(obj);
+    for (; chobj != NULL && res == NO_ERR; chobj = obj_next_child(chobj)) {
+        if (obj_is_config(chobj)) {
+            res = add_object_tree(chobj);
+        }
+    }
+    return res;
+
+}  /* add_object_tree */
+
+
+/********************************************************************
+* FUNCTION find_key
+*
+* Find a key record
+*
+* INPUTS:
+*   targobj == target object
+*   value == value string
+*   hash == hash_key(targobj, value)
+*
+* RETURNS:
+*   pointer to record or NULL if not found
+*********************************************************************/
+static refidx_key_t *
+    find_key (const obj_template_t *targobj,
+              const xmlChar *value,
+              uint32 hash)
+{
+    refidx_hent_t *h = table_first(&keytab, hash);
+    for (; h != NULL; h = h->hnext) {
+        refidx_key_t *key = (refidx_key_t *)h;
+        if (h->hash == hash && key->targobj == targobj &&
+            !xml_strcmp(key->value, value)) {
+            return key;
+        }
+    }
+    return NULL;
+
+}  /* find_key */
+
+
+/********************************************************************
+* FUNCTION free_key
+*
+* Remove a key record from the table and free it
+*
+* INPUTS:
+*   key == key record to free
+*********************************************************************/
+static void
+    free_key (refidx_key_t *key)
+{
+    table_remove(&keytab, &key->hent);
+    if (key->value) {
+        m__free(key->value);
+    }
+    m__free(key);
+
+}  /* free_key */
+
+
+/********************************************************************
+* FUNCTION find_node
+*
+* Find a node record
+*
+* INPUTS:
+*   val == value node to find
+*   isref == TRUE to find the leafref record;
+*            FALSE to find the target record
+*
+* RETURNS:
+*   pointer to record or NULL if not found
+*********************************************************************/
+static refidx_node_t *
+    find_node (const val_value_t *val,
+               boolean isref)
+{
+    uint32 hash = hash_ptr(val);
+    refidx_hent_t *h = table_first(&nodetab, hash);
+    for (; h != NULL; h = h->hnext) {
+        refidx_node_t *node = REFIDX_NODE(h);
+        if (h->hash == hash && node->val == val && node->isref == isref) {
+            return node;
+        }
+    }
+    return NULL;
+
+}  /* find_node */
+
+
+/********************************************************************
+* FUNCTION add_impact
+*
+* Record that a key lost a target instance during a root check
+*
+* INPUTS:
+*   key == key record to add
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_impact (refidx_key_t *key)
+{
+    if (key->impacted) {
+        return NO_ERR;
+    }
+
+    ncx_backptr_t *backptr = ncx_new_backptr(key);
+    if (backptr == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    key->impacted = TRUE;
+    dlq_enque(backptr, &impactQ);
+    return NO_ERR;
+
+}  /* add_impact */
+
+
+/********************************************************************
+* FUNCTION clear_impacts
+*
+* Clear the impactQ and free any keys that are now empty
+*
+*********************************************************************/
+static void
+    clear_impacts (void)
+{
+    while (!dlq_empty(&impactQ)) {
+        ncx_backptr_t *backptr = (ncx_backptr_t *)dlq_deque(&impactQ);
+        refidx_key_t *key = (refidx_key_t *)ncx_get_backptr_node(backptr);
+        key->impacted = FALSE;
+        if (dlq_empty(&key->targQ) && dlq_empty(&key->refQ)) {
+            free_key(key);
+        }
+        ncx_free_backptr(backptr);
+    }
+
+}  /* clear_impacts */
+
+
+/********************************************************************
+* FUNCTION remove_node
+*
+* Remove a node record from its key and free it
+*
+* INPUTS:
+*   node == node record to remove
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    remove_node (refidx_node_t *node)
+{
+    status_t res = NO_ERR;
+    refidx_key_t *key = node->key;
+
+    dlq_remove(node);
+    table_remove(&nodetab, &node->hent);
+    if (!node->isref && !dlq_empty(&key->refQ)) {
+        res = add_impact(key);
+    }
+    m__free(node);
+
+    if (!key->impacted && dlq_empty(&key->targQ) && dlq_empty(&key->refQ)) {
+        free_key(key);
+    }
+    return res;
+
+}  /* remove_node */
+
+
+/********************************************************************
+* FUNCTION add_node
+*
+* Add a node record for a leafref or target instance
+*
+* INPUTS:
+*   val == value node to add
+*   targobj == target object for the key
+*   isref == TRUE for a leafref instance; FALSE for a target
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_node (val_value_t *val,
+              obj_template_t *targobj,
+              boolean isref)
+{
+    xmlChar *buff = NULL;
+    const xmlChar *value = get_value_string(val, &buff);
+    if (value == NULL) {
+        return NO_ERR;
+    }
+
+    status_t res = NO_ERR;
+    uint32 hash = hash_key(targobj, value);
+    refidx_key_t *key = find_key(targobj, value, hash);
+    if (key == NULL) {
+        key = m__getObj(refidx_key_t);
+        if (key == NULL) {
+            res = ERR_INTERNAL_MEM;
+        } else {
+            memset(key, 0x0, sizeof(refidx_key_t));
+            dlq_createSQue(&key->targQ);
+            dlq_createSQue(&key->refQ);
+            key->targobj = targobj;
+            key->hent.hash = hash;
+            key->value = xml_strdup(value);
+            if (key->value == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else {
+                res = table_add(&keytab, &key->hent);
+            }
+            if (res != NO_ERR) {
+                if (key->value) {
+                    m__free(key->value);
+                }
+                m__free(key);
+                key = NULL;
+            }
+        }
+    }
+
+    if (buff) {
+        m__free(buff);
+    }
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    refidx_node_t *node = m__getObj(refidx_node_t);
+    if (node == NULL) {
+        res = ERR_INTERNAL_MEM;
+    } else {
+        memset(node, 0x0, sizeof(refidx_node_t));
+        node->val = val;
+        node->key = key;
+        node->isref = isref;
+        node->hent.hash = hash_ptr(val);
+        res = table_add(&nodetab, &node->hent);
+        if (res == NO_ERR) {
+            dlq_enque(node, (isref) ? &key->refQ : &key->targQ);
+        } else {
+            m__free(node);
+        }
+    }
+
+    if (res != NO_ERR && !key->impacted &&
+        dlq_empty(&key->targQ) && dlq_empty(&key->refQ)) {
+        free_key(key);
+    }
+    return res;
+
+}  /* add_node */
+
+
+/********************************************************************
+* FUNCTION unindex_leaf
+*
+* Remove the leafref and target records for a leaf node
+*
+* INPUTS:
+*   val == leaf or leaf-list node
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    unindex_leaf (val_value_t *val)
+{
+    status_t res = NO_ERR;
+
+    refidx_node_t *node = find_node(val, TRUE);
+    if (node) {
+        res = remove_node(node);
+    }
+    node = find_node(val, FALSE);
+    if (node && res == NO_ERR) {
+        res = remove_node(node);
+    }
+    return res;
+
+}  /* unindex_leaf */
+
+
+/********************************************************************
+* FUNCTION unindex_subtree
+*
+* Remove all the records for a subtree, including
+* descendant nodes that are marked as deleted
+*
+* INPUTS:
+*   val == top of subtree
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    unindex_subtree (val_value_t *val)
+{
+    if (val == NULL || val->obj == NULL) {
+        return NO_ERR;
+    }
+
+    status_t res = NO_ERR;
+
+    if (obj_is_root(val->obj)) {
+        ;
+    } else {
+        refidx_obj_t *rec = find_obj(val->obj);
+        if (rec == NULL) {
+            return NO_ERR;
+        }
+        if (obj_is_leafy(val->obj)) {
+            return unindex_leaf(val);
+        }
+        if (!(rec->flags & REFIDX_FL_PATH)) {
+            return NO_ERR;
+        }
+    }
+
+    if (!typ_has_children(val->btyp)) {
+        return NO_ERR;
+    }
+
+    val_value_t *chval = (val_value_t *)dlq_firstEntry(&val->v.childQ);
+    for (; chval != NULL && res == NO_ERR;
+         chval = (val_value_t *)dlq_nextEntry(chval)) {
+        res = unindex_subtree(chval);
+    }
+    return res;
+
+}  /* unindex_subtree */
+
+
+/********************************************************************
+* FUNCTION index_subtree
+*
+* Add records for all the leafref and target nodes in a subtree
+* Nodes marked as deleted are skipped
+*
+* INPUTS:
+*   val == top of subtree
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    index_subtree (val_value_t *val)
+{
+    if (val->obj == NULL) {
+        return NO_ERR;
+    }
+
+    status_t res = NO_ERR;
+
+    if (obj_is_root(val->obj)) {
+        ;
+    } else {
+        refidx_obj_t *rec = find_obj(val->obj);
+        if (rec == NULL) {
+            return NO_ERR;
+        }
+
+        if (obj_is_leafy(val->obj)) {
+            /* the value may have changed, so always start over */
+            res = unindex_leaf(val);
+            if (res != NO_ERR) {
+                return res;
+            }
+
+            if (val_is_virtual(val)) {
+                if (rec->flags & REFIDX_FL_TARGET) {
+                    rec->flags |= REFIDX_FL_PARTIAL;
+                }
+                return NO_ERR;
+            }
+
+            if (rec->flags & REFIDX_FL_REF) {
+                res = add_node(val, rec->targobj, TRUE);
+            }
+            if (res == NO_ERR && (rec->flags & REFIDX_FL_TARGET)) {
+                res = add_node(val, val->obj, FALSE);
+            }
+            return res;
+        }
+
+        if (!(rec->flags & REFIDX_FL_PATH)) {
+            return NO_ERR;
+        }
+    }
+
+    val_value_t *chval = val_get_first_child(val);
+    for (; chval != NULL && res == NO_ERR; chval = val_get_next_child(chval)) {
+        res = index_subtree(chval);
+    }
+    return res;
+
+}  /* index_subtree */
+
+
+/********************************************************************
+* FUNCTION is_live
+*
+* Check if a node is in the indexed running config
+*
+* INPUTS:
+*   val == value node to check
+*
+* RETURNS:
+*   TRUE if the node and its ancestors are not deleted
+*   and the top ancestor is the indexed config root
+*********************************************************************/
+static boolean
+    is_live (const val_value_t *val)
+{
+    for (; val != NULL; val = val->parent) {
+        if (VAL_IS_DELETED(val)) {
+            return FALSE;
+        }
+        if (val == refidx_root) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+
+}  /* is_live */
+
+
+/********************************************************************
+* FUNCTION clear_index
+*
+* Free all the index records and mark the index not valid
+*
+*********************************************************************/
+static void
+    clear_index (void)
+{
+    uint32 i;
+
+    ncx_clean_backptrQ(&impactQ);
+
+    for (i = 0; i < nodetab.size; i++) {
+        refidx_hent_t *h = nodetab.buckets[i];
+        while (h) {
+            refidx_hent_t *nexth = h->hnext;
+            m__free(REFIDX_NODE(h));
+            h = nexth;
+        }
+    }
+    table_clean(&nodetab);
+
+    for (i = 0; i < keytab.size; i++) {
+        refidx_hent_t *h = keytab.buckets[i];
+        while (h) {
+            refidx_hent_t *nexth = h->hnext;
+            refidx_key_t *key = (refidx_key_t *)h;
+            if (key->value) {
+                m__free(key->value);
+            }
+            m__free(key);
+            h = nexth;
+        }
+    }
+    table_clean(&keytab);
+
+    for (i = 0; i < objtab.size; i++) {
+        refidx_hent_t *h = objtab.buckets[i];
+        while (h) {
+            refidx_hent_t *nexth = h->hnext;
+            m__free(h);
+            h = nexth;
+        }
+    }
+    table_clean(&objtab);
+
+    refidx_valid = FALSE;
+    refidx_active = FALSE;
+    refidx_root = NULL;
+    refidx_txid = 0;
+
+}  /* clear_index */
+
+
+/********************************************************************
+* FUNCTION rebuild_index
+*
+* Build the index from the current running config
+*
+* INPUTS:
+*   running == running config to use
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    rebuild_index (cfg_template_t *running)
+{
+    status_t res = NO_ERR;
+
+    clear_index();
+
+    if (running == NULL || running->root == NULL) {
+        return ERR_NCX_OPERATION_FAILED;
+    }
+
+    ncx_module_t *mod = ncx_get_first_module();
+    for (; mod != NULL && res == NO_ERR; mod = ncx_get_next_module(mod)) {
+        obj_template_t *obj = ncx_get_first_data_object_pick(mod, TRUE);
+        for (; obj != NULL && res == NO_ERR;
+             obj = ncx_get_next_data_object_same(mod, obj)) {
+            res = add_object_tree(obj);
+        }
+    }
+
+    refidx_root = running->root;
+    if (res == NO_ERR && objtab.count) {
+        res = index_subtree(running->root);
+    }
+
+    if (res != NO_ERR) {
+        log_error("\nError: build leafref index failed (%s)",
+                  get_error_string(res));
+        clear_index();
+        return res;
+    }
+
+    refidx_valid = TRUE;
+    refidx_txid = running->last_txid;
+
+    if (LOGDEBUG2) {
+        log_debug2("\nBuilt leafref index: %u objects, %u values, "
+                   "%u nodes", objtab.count, keytab.count, nodetab.count);
+    }
+    return NO_ERR;
+
+}  /* rebuild_index */
+
+
+/********************************************************************
+* FUNCTION check_sync
+*
+* Check if the index matches the running config
+*
+* INPUTS:
+*   running == running config to check
+*
+* RETURNS:
+*   TRUE if the index is valid for this running config
+*********************************************************************/
+static boolean
+    check_sync (cfg_template_t *running)
+{
+    return (refidx_valid && running && running->root == refidx_root &&
+            running->last_txid == refidx_txid) ? TRUE : FALSE;
+
+}  /* check_sync */
+
+
+/********************************************************************
+* FUNCTION add_subtree_refs
+*
+* Add a backptr for each leafref that points at a target
+* node in a subtree
+*
+* INPUTS:
+*   val == top of subtree
+*   refQ == Q of ncx_backptr_t to fill
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_subtree_refs (val_value_t *val,
+                      dlq_hdr_t *refQ)
+{
+    if (val->obj == NULL) {
+        return NO_ERR;
+    }
+
+    status_t res = NO_ERR;
+
+    if (obj_is_leafy(val->obj)) {
+        refidx_node_t *node = find_node(val, FALSE);
+        if (node == NULL) {
+            return NO_ERR;
+        }
+        refidx_node_t *refnode = (refidx_node_t *)
+            dlq_firstEntry(&node->key->refQ);
+        for (; refnode != NULL && res == NO_ERR;
+             refnode = (refidx_node_t *)dlq_nextEntry(refnode)) {
+            if (refnode->ref_gen == refidx_ref_gen) {
+                /* already added for another target */
+                continue;
+            }
+            refnode->ref_gen = refidx_ref_gen;
+            ncx_backptr_t *backptr = ncx_new_backptr(refnode->val);
+            if (backptr == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else {
+                dlq_enque(backptr, refQ);
+            }
+        }
+        return res;
+    }
+
+    if (!obj_is_root(val->obj)) {
+        refidx_obj_t *rec = find_obj(val->obj);
+        if (rec == NULL || !(rec->flags & REFIDX_FL_PATH)) {
+            return NO_ERR;
+        }
+    }
+
+    val_value_t *chval = val_get_first_child(val);
+    for (; chval != NULL && res == NO_ERR; chval = val_get_next_child(chval)) {
+        res = add_subtree_refs(chval, refQ);
+    }
+    return res;
+
+}  /* add_subtree_refs */
+
+
+/************   E X T E R N A L    F U N C T I O N S   **************/
+
+
+/********************************************************************
+* FUNCTION agt_refidx_init
+*
+* Initialize the reverse reference index module
+*
+*********************************************************************/
+void
+    agt_refidx_init (void)
+{
+    if (!agt_refidx_init_done) {
+        refidx_valid = FALSE;
+        refidx_active = FALSE;
+        refidx_root = NULL;
+        refidx_txid = 0;
+        refidx_edit_txid = 0;
+        refidx_check_txid = 0;
+        memset(&objtab, 0x0, sizeof(refidx_table_t));
+        memset(&keytab, 0x0, sizeof(refidx_table_t));
+        memset(&nodetab, 0x0, sizeof(refidx_table_t));
+        dlq_createSQue(&impactQ);
+        agt_refidx_init_done = TRUE;
+    }
+
+}  /* agt_refidx_init */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_cleanup
+*
+* Cleanup the reverse reference index module
+*
+*********************************************************************/
+void
+    agt_refidx_cleanup (void)
+{
+    if (agt_refidx_init_done) {
+        clear_index();
+        refidx_active = FALSE;
+        agt_refidx_init_done = FALSE;
+    }
+
+}  /* agt_refidx_cleanup */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_invalidate
+*
+* Drop the index contents; it is rebuilt from the running
+* config the next time it is needed
+* Must be called if the object tree or the running config
+* is changed outside a transaction
+*
+*********************************************************************/
+void
+    agt_refidx_invalidate (void)
+{
+    if (agt_refidx_init_done && refidx_valid) {
+        log_debug2("\nDropping leafref index");
+        clear_index();
+    }
+
+}  /* agt_refidx_invalidate */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_edit_node
+*
+* Remove a node in the running config from the index before
+* an edit changes or deletes it
+* Called for each undo record with a current node, so the
+* old values are removed while all the descendant nodes
+* still exist
+*
+* INPUTS:
+*   txcb == transaction control block in progress
+*   curnode == node from the running config about to be edited
+*********************************************************************/
+void
+    agt_refidx_edit_node (agt_cfg_transaction_t *txcb,
+                          val_value_t *curnode)
+{
+    if (!agt_refidx_init_done || !refidx_valid || curnode == NULL ||
+        txcb->cfg_id != NCX_CFGID_RUNNING) {
+        return;
+    }
+
+    if (!check_sync(cfg_get_config_id(NCX_CFGID_RUNNING)) ||
+        !is_live(curnode)) {
+        clear_index();
+        return;
+    }
+
+    refidx_edit_txid = txcb->txid;
+
+    status_t res = unindex_subtree(curnode);
+    if (res != NO_ERR) {
+        log_error("\nError: update leafref index failed (%s)",
+                  get_error_string(res));
+        clear_index();
+    }
+
+}  /* agt_refidx_edit_node */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_start_check
+*
+* Bring the index up to date with the edits in a transaction
+* before the root check is run on the running config
+* The index is rebuilt first if it is not valid
+*
+* INPUTS:
+*   txcb == transaction control block in progress
+*   root == config root being checked
+*
+* RETURNS:
+*   TRUE if the index can be used for this root check
+*   FALSE if not (not the running config or malloc error)
+*********************************************************************/
+boolean
+    agt_refidx_start_check (agt_cfg_transaction_t *txcb,
+                            val_value_t *root)
+{
+    if (!agt_refidx_init_done || txcb->cfg_id != NCX_CFGID_RUNNING) {
+        return FALSE;
+    }
+
+    cfg_template_t *running = cfg_get_config_id(NCX_CFGID_RUNNING);
+    if (running == NULL || running->root != root) {
+        return FALSE;
+    }
+
+    status_t res = NO_ERR;
+    boolean rebuild = !check_sync(running);
+
+    agt_cfg_undo_rec_t *undo = (agt_cfg_undo_rec_t *)
+        dlq_firstEntry(&txcb->undoQ);
+    for (; undo != NULL && !rebuild && res == NO_ERR;
+         undo = (agt_cfg_undo_rec_t *)dlq_nextEntry(undo)) {
+
+        if (undo->editop == OP_EDITOP_LOAD) {
+            rebuild = TRUE;
+            break;
+        }
+
+        /* the extra deletes are still in the tree, marked deleted */
+        agt_cfg_nodeptr_t *nodeptr = (agt_cfg_nodeptr_t *)
+            dlq_firstEntry(&undo->extra_deleteQ);
+        for (; nodeptr != NULL && res == NO_ERR;
+             nodeptr = (agt_cfg_nodeptr_t *)dlq_nextEntry(nodeptr)) {
+            res = unindex_subtree(nodeptr->node);
+        }
+
+        val_value_t *useval[3];
+        useval[0] = undo->newnode;
+        useval[1] = undo->curnode;
+        useval[2] = undo->curnode_clone;
+
+        uint32 i = 0;
+        for (; i < 3 && res == NO_ERR; i++) {
+            if (useval[i] && is_live(useval[i])) {
+                res = index_subtree(useval[i]);
+            }
+        }
+    }
+
+    /* false when-stmt nodes are still in the tree, marked deleted */
+    agt_cfg_nodeptr_t *nodeptr = (agt_cfg_nodeptr_t *)
+        dlq_firstEntry(&txcb->deadnodeQ);
+    for (; nodeptr != NULL && !rebuild && res == NO_ERR;
+         nodeptr = (agt_cfg_nodeptr_t *)dlq_nextEntry(nodeptr)) {
+        res = unindex_subtree(nodeptr->node);
+    }
+
+    if (res != NO_ERR) {
+        log_error("\nError: update leafref index failed (%s)",
+                  get_error_string(res));
+        rebuild = TRUE;
+    }
+
+    if (rebuild) {
+        /* the edits are already in the tree, so the deleted
+         * targets are not known; check every leafref value */
+        res = rebuild_index(running);
+        uint32 i = 0;
+        for (; i < keytab.size && res == NO_ERR; i++) {
+            refidx_hent_t *h = keytab.buckets[i];
+            for (; h != NULL && res == NO_ERR; h = h->hnext) {
+                refidx_key_t *key = (refidx_key_t *)h;
+                if (!dlq_empty(&key->refQ)) {
+                    res = add_impact(key);
+                }
+            }
+        }
+        if (res != NO_ERR) {
+            clear_index();
+        }
+    }
+
+    if (refidx_valid) {
+        refidx_active = TRUE;
+        refidx_check_txid = txcb->txid;
+    } else {
+        refidx_active = FALSE;
+    }
+    return refidx_active;
+
+}  /* agt_refidx_start_check */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_finish_check
+*
+* Stop using the index for the root check in progress
+* Any pending delete-impact records are cleared
+*
+*********************************************************************/
+void
+    agt_refidx_finish_check (void)
+{
+    if (agt_refidx_init_done) {
+        refidx_active = FALSE;
+        clear_impacts();
+    }
+
+}  /* agt_refidx_finish_check */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_check_leafref
+*
+* Check the require-instance test for a leafref node
+* with the index
+*
+* INPUTS:
+*   val == leafref node to check
+*   root == config root being checked
+*
+* RETURNS:
+*   NO_ERR if a target instance was found
+*   ERR_NCX_MISSING_VAL_INST if no target instance exists
+*   ERR_NCX_SKIPPED if the index cannot decide and the
+*     leafref path must be evaluated
+*********************************************************************/
+status_t
+    agt_refidx_check_leafref (val_value_t *val,
+                              val_value_t *root)
+{
+    if (!refidx_active || root != refidx_root || val->obj == NULL) {
+        return ERR_NCX_SKIPPED;
+    }
+
+    refidx_obj_t *rec = find_obj(val->obj);
+    if (rec == NULL || !(rec->flags & REFIDX_FL_REF)) {
+        return ERR_NCX_SKIPPED;
+    }
+
+    refidx_obj_t *targrec = find_obj(rec->targobj);
+    if (targrec == NULL || (targrec->flags & REFIDX_FL_PARTIAL)) {
+        return ERR_NCX_SKIPPED;
+    }
+
+    xmlChar *buff = NULL;
+    const xmlChar *value = get_value_string(val, &buff);
+    if (value == NULL) {
+        return ERR_NCX_SKIPPED;
+    }
+
+    refidx_key_t *key = find_key(rec->targobj, value,
+                                 hash_key(rec->targobj, value));
+    if (buff) {
+        m__free(buff);
+    }
+
+    if (key == NULL || dlq_empty(&key->targQ)) {
+        return ERR_NCX_MISSING_VAL_INST;
+    }
+
+    return (rec->flags & REFIDX_FL_SIMPLE) ? NO_ERR : ERR_NCX_SKIPPED;
+
+}  /* agt_refidx_check_leafref */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_get_impacted
+*
+* Get the leafref nodes that pointed at a target instance
+* that was deleted or changed by the transaction in progress
+* The delete-impact records are cleared
+*
+* INPUTS:
+*   refQ == address of Q to fill with ncx_backptr_t entries
+*
+* OUTPUTS:
+*   refQ contains a backptr for each impacted leafref node;
+*   the caller must free these with ncx_clean_backptrQ
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    agt_refidx_get_impacted (dlq_hdr_t *refQ)
+{
+    status_t res = NO_ERR;
+
+    if (!agt_refidx_init_done) {
+        return NO_ERR;
+    }
+
+    ncx_backptr_t *backptr = ncx_first_backptr(&impactQ);
+    for (; backptr != NULL && res == NO_ERR;
+         backptr = ncx_next_backptr(backptr)) {
+        refidx_key_t *key = (refidx_key_t *)ncx_get_backptr_node(backptr);
+        refidx_node_t *node = (refidx_node_t *)dlq_firstEntry(&key->refQ);
+        for (; node != NULL && res == NO_ERR;
+             node = (refidx_node_t *)dlq_nextEntry(node)) {
+            ncx_backptr_t *refptr = ncx_new_backptr(node->val);
+            if (refptr == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else {
+                dlq_enque(refptr, refQ);
+            }
+        }
+    }
+
+    clear_impacts();
+    return res;
+
+}  /* agt_refidx_get_impacted */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_commit_done
+*
+* Record that a transaction was committed on the running config
+* The index is dropped if it was not updated for this transaction
+*
+* INPUTS:
+*   txcb == transaction control block that was committed
+*********************************************************************/
+void
+    agt_refidx_commit_done (agt_cfg_transaction_t *txcb)
+{
+    if (!agt_refidx_init_done || !refidx_valid ||
+        txcb->cfg_id != NCX_CFGID_RUNNING) {
+        return;
+    }
+
+    clear_impacts();
+    if (refidx_check_txid == txcb->txid) {
+        refidx_txid = txcb->txid;
+    } else {
+        clear_index();
+    }
+
+}  /* agt_refidx_commit_done */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_rollback_done
+*
+* Record that a transaction on the running config was rolled back
+* The index is dropped if it was changed for this transaction
+*
+* INPUTS:
+*   txcb == transaction control block that was rolled back
+*********************************************************************/
+void
+    agt_refidx_rollback_done (agt_cfg_transaction_t *txcb)
+{
+    if (!agt_refidx_init_done || !refidx_valid ||
+        txcb->cfg_id != NCX_CFGID_RUNNING) {
+        return;
+    }
+
+    clear_impacts();
+    if (refidx_edit_txid == txcb->txid || refidx_check_txid == txcb->txid) {
+        clear_index();
+    }
+
+}  /* agt_refidx_rollback_done */
+
+
+/********************************************************************
+* FUNCTION agt_refidx_get_references
+*
+* Get the leafref nodes in the running config that point at
+* a node or any of its descendants
+*
+* INPUTS:
+*   target == node in the running config to check
+*   refQ == address of Q to fill with ncx_backptr_t entries;
+*           if not empty, the nodes already added by earlier
+*           calls for other targets are not added again
+*
+* OUTPUTS:
+*   refQ contains 1 backptr for each leafref node found;
+*   the caller must free these with ncx_clean_backptrQ
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    agt_refidx_get_references (val_value_t *target,
+                               dlq_hdr_t *refQ)
+{
+    if (!agt_refidx_init_done) {
+        return ERR_NCX_OPERATION_FAILED;
+    }
+
+    cfg_template_t *running = cfg_get_config_id(NCX_CFGID_RUNNING);
+    if (!check_sync(running)) {
+        status_t res = rebuild_index(running);
+        if (res != NO_ERR) {
+            return res;
+        }
+    }
+
+    if (!is_live(target)) {
+        return NO_ERR;
+    }
+
+    /* start a new pass unless the caller is adding to the
+     * references found for other targets
+     */
+    if (dlq_empty(refQ) && ++refidx_ref_gen == 0) {
+        refidx_ref_gen = 1;
+    }
+
+    return add_subtree_refs(target, refQ);
+
+}  /* agt_refidx_get_references */
+
+
+/* END file agt_refidx.c */
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_agt_refidx
+#define _H_agt_refidx
+/*  FILE: agt_refidx.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+   Reverse reference index for leafref nodes in the running config
+
+   Maps each leafref target value to the target instances that
+   hold it and the leafref instances that point at it, so the
+   require-instance test and the delete-impact test are lookups
+   instead of an XPath evaluation for every leafref instance.
+
+   The index is updated from the undo records of each transaction
+   on the running config.  Code that changes the running config
+   outside a transaction must call agt_refidx_invalidate.
+
+*/
+
+#ifndef _H_agt_cfg
+#include "agt_cfg.h"
+#endif
+
+#ifndef _H_dlq
+#include "dlq.h"
+#endif
+
+#ifndef _H_status
+#include "status.h"
+#endif
+
+#ifndef _H_val
+#include "val.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+*                                                                   *
+*                        F U N C T I O N S                          *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+* FUNCTION agt_refidx_init
+*
+* Initialize the reverse reference index module
+*
+*********************************************************************/
+extern void
+    agt_refidx_init (void);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_cleanup
+*
+* Cleanup the reverse reference index module
+*
+*********************************************************************/
+extern void
+    agt_refidx_cleanup (void);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_invalidate
+*
+* Drop the index contents; it is rebuilt from the running
+* config the next time it is needed
+* Must be called if the object tree or the running config
+* is changed outside a transaction
+*
+*********************************************************************/
+extern void
+    agt_refidx_invalidate (void);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_edit_node
+*
+* Remove a node in the running config from the index before
+* an edit changes or deletes it
+* Called for each undo record with a current node, so the
+* old values are removed while all the descendant nodes
+* still exist
+*
+* INPUTS:
+*   txcb == transaction control block in progress
+*   curnode == node from the running config about to be edited
+*********************************************************************/
+extern void
+    agt_refidx_edit_node (agt_cfg_transaction_t *txcb,
+                          val_value_t *curnode);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_start_check
+*
+* Bring the index up to date with the edits in a transaction
+* before the root check is run on the running config
+* The index is rebuilt first if it is not valid
+*
+* INPUTS:
+*   txcb == transaction control block in progress
+*   root == config root being checked
+*
+* RETURNS:
+*   TRUE if the index can be used for this root check
+*   FALSE if not (not the running config or malloc error)
+*********************************************************************/
+extern boolean
+    agt_refidx_start_check (agt_cfg_transaction_t *txcb,
+                            val_value_t *root);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_finish_check
+*
+* Stop using the index for the root check in progress
+* Any pending delete-impact records are cleared
+*
+*********************************************************************/
+extern void
+    agt_refidx_finish_check (void);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_check_leafref
+*
+* Check the require-instance test for a leafref node
+* with the index
+*
+* INPUTS:
+*   val == leafref node to check
+*   root == config root being checked
+*
+* RETURNS:
+*   NO_ERR if a target instance was found
+*   ERR_NCX_MISSING_VAL_INST if no target instance exists
+*   ERR_NCX_SKIPPED if the index cannot decide and the
+*     leafref path must be evaluated
+*********************************************************************/
+extern status_t
+    agt_refidx_check_leafref (val_value_t *val,
+                              val_value_t *root);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_get_impacted
+*
+* Get the leafref nodes that pointed at a target instance
+* that was deleted or changed by the transaction in progress
+* The delete-impact records are cleared
+*
+* INPUTS:
+*   refQ == address of Q to fill with ncx_backptr_t entries
+*
+* OUTPUTS:
+*   refQ contains a backptr for each impacted leafref node;
+*   the caller must free these with ncx_clean_backptrQ
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    agt_refidx_get_impacted (dlq_hdr_t *refQ);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_commit_done
+*
+* Record that a transaction was committed on the running config
+* The index is dropped if it was not updated for this transaction
+*
+* INPUTS:
+*   txcb == transaction control block that was committed
+*********************************************************************/
+extern void
+    agt_refidx_commit_done (agt_cfg_transaction_t *txcb);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_rollback_done
+*
+* Record that a transaction on the running config was rolled back
+* The index is dropped if it was changed for this transaction
+*
+* INPUTS:
+*   txcb == transaction control block that was rolled back
+*********************************************************************/
+extern void
+    agt_refidx_rollback_done (agt_cfg_transaction_t *txcb);
+
+
+/********************************************************************
+* FUNCTION agt_refidx_get_references
+*
+* Get the leafref nodes in the running config that point at
+* a node or any of its descendants
+*
+* INPUTS:
+*   target == node in the running config to check
+*   refQ == address of Q to fill with ncx_backptr_t entries;
+*           if not empty, the nodes already added by earlier
+*           calls for other targets are not added again
+*
+* OUTPUTS:
+*   refQ contains 1 backptr for each leafref node found;
+*   the caller must free these with ncx_clean_backptrQ
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    agt_refidx_get_references (val_value_t *target,
+                               dlq_hdr_t *refQ);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif            /* _H_agt_refidx */
@@ -39,8 +39,10 @@ date         init     comment
 #include "agt_acm.h"
 #include "agt_cfg.h"
 #include "agt_cli.h"
+#include "agt_gcommit.h"
 #include "agt_rpc.h"
 #include "agt_rpcerr.h"
+#include "agt_rpcstat.h"
 #include "agt_ses.h"
 #include "agt_sys.h"
 #include "agt_util.h"
@@ -57,6 +59,7 @@ date         init     comment
 #include "log.h"
 #include "ncx.h"
 #include "ncx_num.h"
+#include "ncx_trace.h"
 #include "ncxconst.h"
 #include "obj.h"
 #include "rpc.h"
@@ -1473,6 +1476,13 @@ void
     obj_template_t *rpcobj = NULL;
     ses_total_stats_t *agttotals = ses_get_total_stats();
 
+    /* a session with a reply held for group commit is still
+     * in the SES_ST_IN_MSG state; commit the group first
+     */
+    if (agt_gcommit_ses_held(scb->sid)) {
+        agt_gcommit_flush();
+    }
+
     /* make sure any real session has been properly established */
     if (scb->type != SES_TYP_DUMMY && scb->state != SES_ST_IDLE) {
         res = ERR_NCX_ACCESS_DENIED;
@@ -1489,6 +1499,10 @@ void
         return;
     }
 
+    /* start the per-phase timer for the rpc-statistics */
+    agt_rpcstat_start();
+    NCX_TRACE_BEGIN(NCX_TRACE_RPC_DISPATCH, scb->sid, NULL);
+
     /* the current node is 'rpc' in the netconf namespace
      * First get a new RPC message struct
      */
@@ -1501,6 +1515,8 @@ void
                      scb->sid, res, get_error_string(res));
         }
         agt_ses_request_close(scb, scb->sid, SES_TR_DROPPED);
+        agt_rpcstat_finish(NULL);
+        NCX_TRACE_END(NCX_TRACE_RPC_DISPATCH, NULL);
         return;
     }
 
@@ -1517,6 +1533,8 @@ void
                      get_error_string(res));
         }
         agt_ses_request_close(scb, scb->sid, SES_TR_OTHER);
+        agt_rpcstat_finish(NULL);
+        NCX_TRACE_END(NCX_TRACE_RPC_DISPATCH, NULL);
         free_msg(msg);
         return;
     }
@@ -1584,7 +1602,10 @@ void
 
     /* check any errors in the <rpc> node */
     if (res != NO_ERR || res2 != NO_ERR) {
+        (void)agt_rpcstat_enter(AGT_RPCSTAT_PH_REPLY);
         send_rpc_reply(scb, msg);
+        agt_rpcstat_finish(msg);
+        NCX_TRACE_END(NCX_TRACE_RPC_DISPATCH, NULL);
         agt_acm_clear_msg_cache(&msg->mhdr);
         free_msg(msg);
         return;
@@ -1687,7 +1708,10 @@ void
         if (buff) {
             m__free(buff);
         }
+        (void)agt_rpcstat_enter(AGT_RPCSTAT_PH_REPLY);
         send_rpc_reply(scb, msg);
+        agt_rpcstat_finish(msg);
+        NCX_TRACE_END(NCX_TRACE_RPC_DISPATCH, NULL);
         agt_acm_clear_msg_cache(&msg->mhdr);
         free_msg(msg);
         xml_clean_node(&method);
@@ -1698,6 +1722,7 @@ void
     scb->state = SES_ST_IN_MSG;
 
     /* parameter set parse state */
+    (void)agt_rpcstat_enter(AGT_RPCSTAT_PH_INPUT_PARSE);
     if (res == NO_ERR) {
         res = agt_rpc_parse_rpc_input(scb, msg, rpcobj, &method);
     }
@@ -1756,11 +1781,27 @@ void
         res = agt_rpc_post_psd_state(scb, msg, res);
     }
 
+    /* check if this is an edit that can be group committed;
+     * any other request commits the pending group first
+     */
+    if (res == NO_ERR) {
+        agt_gcommit_prepare(scb, msg, top);
+    }
+
     /* execute the validate and invoke callbacks */
     if (res == NO_ERR) {
         res = agt_rpc_invoke_rpc(scb, msg, &method);
     }
 
+    /* check if the reply is held until the group is committed */
+    if (agt_gcommit_hold(msg)) {
+        agt_rpcstat_finish(msg);
+        NCX_TRACE_END(NCX_TRACE_RPC_DISPATCH, NULL);
+        xml_clean_node(&method);
+        agt_gcommit_check_window();
+        return;
+    }
+
     /* make sure the prefix map is correct for report-all-tagged mode
      * OK to skip this if there was an error exit */
     if (res == NO_ERR) {
@@ -1769,6 +1810,7 @@ void
 
     /* always send an <rpc-reply> element in response to an <rpc> */
     msg->rpc_agt_state = AGT_RPC_PH_REPLY;
+    (void)agt_rpcstat_enter(AGT_RPCSTAT_PH_REPLY);
     send_rpc_reply(scb, msg);
 
     /* check if there is a post-reply callback;
@@ -1793,6 +1835,9 @@ void
         scb->state = SES_ST_IDLE;
     }
 
+    agt_rpcstat_finish(msg);
+    NCX_TRACE_END(NCX_TRACE_RPC_DISPATCH, NULL);
+
     /* cleanup and exit */
     xml_clean_node(&method);
     agt_acm_clear_msg_cache(&msg->mhdr);
@@ -2116,6 +2161,49 @@ void
 }  /* agt_rpc_send_error_reply */
 
 
+/********************************************************************
+* FUNCTION agt_rpc_send_deferred_reply
+*
+* Send the <rpc-reply> for a message that was held by
+* agt_gcommit, and finish the message the same way
+* agt_rpc_dispatch does
+*
+* INPUTS:
+*   scb == session control block
+*       == NULL if the session is gone; the message is just freed
+*   msg == held rpc_msg_t; freed by this function
+*
+*********************************************************************/
+void
+    agt_rpc_send_deferred_reply (ses_cb_t *scb,
+                                 rpc_msg_t *msg)
+{
+    assert( msg && "msg is NULL!" );
+
+    if (scb) {
+        /* make sure the prefix map is correct for report-all-tagged
+         * mode; OK to skip this if there was an error exit */
+        if (!rpc_err_any_errors(msg)) {
+            (void)xml_msg_finish_prefix_map(&msg->mhdr, msg->rpc_in_attrs);
+        }
+
+        msg->rpc_agt_state = AGT_RPC_PH_REPLY;
+        send_rpc_reply(scb, msg);
+
+        /* only reset the session state to idle if was not changed
+         * to SES_ST_SHUTDOWN_REQ while the reply was held
+         */
+        if (scb->state == SES_ST_IN_MSG) {
+            scb->state = SES_ST_IDLE;
+        }
+    }
+
+    agt_acm_clear_msg_cache(&msg->mhdr);
+    free_msg(msg);
+
+}  /* agt_rpc_send_deferred_reply */
+
+
 /********************************************************************
 * FUNCTION agt_rpc_send_rpc_error
 *
@@ -2398,6 +2486,7 @@ status_t
     }
         
     status_t res = NO_ERR;
+    agt_rpcstat_phase_t lastphase = AGT_RPCSTAT_PH_NONE;
 
     /* validate state */
     if (cbset->acb[AGT_RPC_PH_VALIDATE]) {
@@ -2409,6 +2498,7 @@ status_t
          * validataion in this VALIDATE callback, as needed
          */
         msg->rpc_agt_state = AGT_RPC_PH_VALIDATE;
+        lastphase = agt_rpcstat_enter(AGT_RPCSTAT_PH_VALIDATE);
         res = (*cbset->acb[AGT_RPC_PH_VALIDATE])(scb, msg, method_node);
         if (res != NO_ERR) {
             /* make sure there is an error recorded in case
@@ -2434,6 +2524,10 @@ status_t
      */
     if ((res==NO_ERR) && cbset->acb[AGT_RPC_PH_INVOKE]) {
         msg->rpc_agt_state = AGT_RPC_PH_INVOKE;
+        agt_rpcstat_phase_t phase = agt_rpcstat_enter(AGT_RPCSTAT_PH_INVOKE);
+        if (lastphase == AGT_RPCSTAT_PH_NONE) {
+            lastphase = phase;
+        }
         res = (*cbset->acb[AGT_RPC_PH_INVOKE])(scb, msg, method_node);
         if (res != NO_ERR) {
             /* make sure there is an error recorded in case
@@ -2453,6 +2547,11 @@ status_t
         }
     }
 
+    /* charge the rest of the RPC to the caller phase */
+    if (lastphase != AGT_RPCSTAT_PH_NONE) {
+        (void)agt_rpcstat_enter(lastphase);
+    }
+
     if (clean_node) {
         xml_clean_node(&mynode);
     }
@@ -362,6 +362,24 @@ extern void
                               status_t retres);
 
 
+/********************************************************************
+* FUNCTION agt_rpc_send_deferred_reply
+*
+* Send the <rpc-reply> for a message that was held by
+* agt_gcommit, and finish the message the same way
+* agt_rpc_dispatch does
+*
+* INPUTS:
+*   scb == session control block
+*       == NULL if the session is gone; the message is just freed
+*   msg == held rpc_msg_t; freed by this function
+*
+*********************************************************************/
+extern void
+    agt_rpc_send_deferred_reply (ses_cb_t *scb,
+                                 rpc_msg_t *msg);
+
+
 /********************************************************************
 * FUNCTION agt_rpc_send_rpc_error
 *
@@ -0,0 +1,517 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: agt_rpcstat.c
+
+   Per-phase RPC latency statistics
+
+   agt_rpc_dispatch starts the timer when an <rpc> is read and
+   switches it to a new phase as the request moves through
+   parsing, validation, invocation, commit checks, SIL apply
+   and reply generation.  Each switch charges the time since
+   the last switch to the phase being left, so nested phases
+   such as the commit checks inside an <edit-config> invoke
+   are not counted twice.
+
+   When the reply has been sent the phase times are added to
+   log2 histograms kept for each RPC method and datastore.
+   They are reported in /netconf-state/rpc-statistics.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "procdefs.h"
+#include "agt_cfg.h"
+#include "agt_rpcstat.h"
+#include "cfg.h"
+#include "dlq.h"
+#include "log.h"
+#include "ncxconst.h"
+#include "obj.h"
+#include "rpc.h"
+#include "status.h"
+#include "val.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static boolean              agt_rpcstat_init_done = FALSE;
+
+/* Q of agt_rpcstat_t */
+static dlq_hdr_t            rpcstatQ;
+
+/* phase timer for the RPC in progress */
+static agt_rpcstat_phase_t  curphase;
+static uint64               phasestart;
+static uint64               phasetime[AGT_RPCSTAT_NUM_PHASES];
+static boolean              phaseused[AGT_RPCSTAT_NUM_PHASES];
+
+/* YANG enum names for agt_rpcstat_phase_t */
+static const xmlChar *phasenames[AGT_RPCSTAT_NUM_PHASES] = {
+    NCX_EL_NONE,
+    (const xmlChar *)"xml-parse",
+    (const xmlChar *)"input-parse",
+    (const xmlChar *)"validate",
+    (const xmlChar *)"invoke",
+    (const xmlChar *)"commit-check",
+    (const xmlChar *)"apply",
+    (const xmlChar *)"reply"
+};
+
+
+/********************************************************************
+* FUNCTION get_usecs
+*
+* Get the current monotonic time
+*
+* RETURNS:
+*   micro-seconds since some fixed point
+*********************************************************************/
+static uint64
+    get_usecs (void)
+{
+    struct timeval   tv;
+#ifdef CLOCK_MONOTONIC
+    struct timespec  ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return ((uint64)ts.tv_sec * 1000000) +
+            (uint64)(ts.tv_nsec / 1000);
+    }
+#endif
+
+    (void)gettimeofday(&tv, NULL);
+    return ((uint64)tv.tv_sec * 1000000) + (uint64)tv.tv_usec;
+
+}  /* get_usecs */
+
+
+/********************************************************************
+* FUNCTION get_bucket
+*
+* Get the histogram bucket for a time value
+*
+* INPUTS:
+*   usecs == time in micro-seconds
+*
+* RETURNS:
+*   bucket index
+*********************************************************************/
+static uint32
+    get_bucket (uint64 usecs)
+{
+    uint32  bucket;
+
+    bucket = 0;
+    while (usecs && bucket < AGT_RPCSTAT_NUM_BUCKETS - 1) {
+        usecs >>= 1;
+        bucket++;
+    }
+    return bucket;
+
+}  /* get_bucket */
+
+
+/********************************************************************
+* FUNCTION get_datastore
+*
+* Get the datastore name to use for an RPC
+*
+* INPUTS:
+*   msg == RPC message to check
+*
+* RETURNS:
+*   const pointer to the datastore name
+*********************************************************************/
+static const xmlChar *
+    get_datastore (const rpc_msg_t *msg)
+{
+    val_value_t     *parmval, *chval;
+    cfg_template_t  *cfg;
+
+    /* <target> or <source> parameter choice name */
+    if (msg->rpc_input) {
+        parmval = val_find_child(msg->rpc_input, NULL, NCX_EL_TARGET);
+        if (parmval == NULL) {
+            parmval = val_find_child(msg->rpc_input, NULL, NCX_EL_SOURCE);
+        }
+        if (parmval) {
+            chval = val_get_first_child(parmval);
+            if (chval && chval->obj) {
+                return obj_get_name(chval->obj);
+            }
+        }
+    }
+
+    /* edit transaction such as <commit> */
+    if (msg->rpc_txcb) {
+        cfg = cfg_get_config_id(msg->rpc_txcb->cfg_id);
+        if (cfg) {
+            return cfg->name;
+        }
+    }
+
+    return NCX_EL_NONE;
+
+}  /* get_datastore */
+
+
+/********************************************************************
+* FUNCTION find_rpcstat
+*
+* Find or create the statistics entry for an RPC and datastore
+*
+* INPUTS:
+*   rpcobj == RPC method template
+*   datastore == datastore name
+*
+* RETURNS:
+*   pointer to the entry; NULL if malloc failed
+*********************************************************************/
+static agt_rpcstat_t *
+    find_rpcstat (obj_template_t *rpcobj,
+                  const xmlChar *datastore)
+{
+    agt_rpcstat_t  *rpcstat;
+
+    for (rpcstat = (agt_rpcstat_t *)dlq_firstEntry(&rpcstatQ);
+         rpcstat != NULL;
+         rpcstat = (agt_rpcstat_t *)dlq_nextEntry(rpcstat)) {
+        if (rpcstat->rpcobj == rpcobj &&
+            (rpcstat->datastore == datastore ||
+             !xml_strcmp(rpcstat->datastore, datastore))) {
+            return rpcstat;
+        }
+    }
+
+    rpcstat = m__getObj(agt_rpcstat_t);
+    if (!rpcstat) {
+        return NULL;
+    }
+    memset(rpcstat, 0x0, sizeof(agt_rpcstat_t));
+    rpcstat->rpcobj = rpcobj;
+    rpcstat->datastore = datastore;
+    dlq_enque(rpcstat, &rpcstatQ);
+    return rpcstat;
+
+}  /* find_rpcstat */
+
+
+/************* E X T E R N A L    F U N C T I O N S ***************/
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_init
+*
+* Initialize the RPC statistics module data structures
+*
+*********************************************************************/
+void
+    agt_rpcstat_init (void)
+{
+    if (!agt_rpcstat_init_done) {
+        dlq_createSQue(&rpcstatQ);
+        curphase = AGT_RPCSTAT_PH_NONE;
+        agt_rpcstat_init_done = TRUE;
+    }
+
+}  /* agt_rpcstat_init */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_cleanup
+*
+* Cleanup the RPC statistics module data structures
+*
+*********************************************************************/
+void
+    agt_rpcstat_cleanup (void)
+{
+    if (agt_rpcstat_init_done) {
+        agt_rpcstat_reset();
+        curphase = AGT_RPCSTAT_PH_NONE;
+        agt_rpcstat_init_done = FALSE;
+    }
+
+}  /* agt_rpcstat_cleanup */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_start
+*
+* Start timing an incoming <rpc>
+* The current phase is set to AGT_RPCSTAT_PH_XML_PARSE
+*
+*********************************************************************/
+void
+    agt_rpcstat_start (void)
+{
+    if (!agt_rpcstat_init_done) {
+        return;
+    }
+
+    memset(phasetime, 0x0, sizeof(phasetime));
+    memset(phaseused, 0x0, sizeof(phaseused));
+    curphase = AGT_RPCSTAT_PH_XML_PARSE;
+    phaseused[curphase] = TRUE;
+    phasestart = get_usecs();
+
+}  /* agt_rpcstat_start */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_enter
+*
+* Switch the RPC timer to a new phase
+* The time since the last switch is charged to the current phase
+* Does nothing if no RPC is being timed
+*
+* INPUTS:
+*   phase == phase to enter
+*
+* RETURNS:
+*   the phase that was left; the caller passes this to
+*   agt_rpcstat_enter to return to it after a nested phase
+*********************************************************************/
+agt_rpcstat_phase_t
+    agt_rpcstat_enter (agt_rpcstat_phase_t phase)
+{
+    agt_rpcstat_phase_t  lastphase;
+    uint64               now;
+
+    lastphase = curphase;
+    if (lastphase == AGT_RPCSTAT_PH_NONE ||
+        phase == AGT_RPCSTAT_PH_NONE ||
+        phase >= AGT_RPCSTAT_NUM_PHASES) {
+        return lastphase;
+    }
+
+    now = get_usecs();
+    if (now > phasestart) {
+        phasetime[lastphase] += now - phasestart;
+    }
+    phasestart = now;
+    curphase = phase;
+    phaseused[phase] = TRUE;
+    return lastphase;
+
+}  /* agt_rpcstat_enter */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_finish
+*
+* Stop timing the current <rpc> and add the phase times
+* to the statistics for the RPC method and datastore
+*
+* INPUTS:
+*   msg == RPC message that was processed
+*          if msg->rpc_method is NULL the times are discarded
+*********************************************************************/
+void
+    agt_rpcstat_finish (const rpc_msg_t *msg)
+{
+    agt_rpcstat_t        *rpcstat;
+    agt_rpcstat_histo_t  *histo;
+    uint64                usecs;
+    uint32                phase;
+
+    if (curphase == AGT_RPCSTAT_PH_NONE) {
+        return;
+    }
+
+    /* charge the time to the last phase */
+    (void)agt_rpcstat_enter(curphase);
+    curphase = AGT_RPCSTAT_PH_NONE;
+
+    if (msg == NULL || msg->rpc_method == NULL) {
+        return;
+    }
+
+    rpcstat = find_rpcstat(msg->rpc_method, get_datastore(msg));
+    if (rpcstat == NULL) {
+        return;
+    }
+
+    rpcstat->count++;
+    if (!dlq_empty(&msg->mhdr.errQ)) {
+        rpcstat->errors++;
+    }
+
+    for (phase = AGT_RPCSTAT_PH_XML_PARSE;
+         phase < AGT_RPCSTAT_NUM_PHASES;
+         phase++) {
+        if (!phaseused[phase]) {
+            continue;
+        }
+        histo = &rpcstat->phase[phase];
+        usecs = phasetime[phase];
+        histo->count++;
+        histo->totaltime += usecs;
+        if (usecs > histo->maxtime) {
+            histo->maxtime = (usecs > NCX_MAX_UINT) ?
+                NCX_MAX_UINT : (uint32)usecs;
+        }
+        histo->buckets[get_bucket(usecs)]++;
+    }
+
+    if (LOGDEBUG3) {
+        log_debug3("\nagt_rpcstat: <%s> on %s took %llu usec",
+                   obj_get_name(msg->rpc_method),
+                   rpcstat->datastore,
+                   (unsigned long long)
+                   (phasetime[AGT_RPCSTAT_PH_XML_PARSE] +
+                    phasetime[AGT_RPCSTAT_PH_INPUT_PARSE] +
+                    phasetime[AGT_RPCSTAT_PH_VALIDATE] +
+                    phasetime[AGT_RPCSTAT_PH_INVOKE] +
+                    phasetime[AGT_RPCSTAT_PH_COMMIT_CHECK] +
+                    phasetime[AGT_RPCSTAT_PH_APPLY] +
+                    phasetime[AGT_RPCSTAT_PH_REPLY]));
+    }
+
+}  /* agt_rpcstat_finish */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_reset
+*
+* Clear all the RPC statistics
+*
+*********************************************************************/
+void
+    agt_rpcstat_reset (void)
+{
+    agt_rpcstat_t  *rpcstat;
+
+    if (!agt_rpcstat_init_done) {
+        return;
+    }
+
+    while (!dlq_empty(&rpcstatQ)) {
+        rpcstat = (agt_rpcstat_t *)dlq_deque(&rpcstatQ);
+        m__free(rpcstat);
+    }
+
+}  /* agt_rpcstat_reset */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_phase_name
+*
+* Get the YANG enum name for a phase
+*
+* INPUTS:
+*   phase == phase enum
+*
+* RETURNS:
+*   const pointer to the phase name
+*********************************************************************/
+const xmlChar *
+    agt_rpcstat_get_phase_name (agt_rpcstat_phase_t phase)
+{
+    if (phase >= AGT_RPCSTAT_NUM_PHASES) {
+        SET_ERROR(ERR_INTERNAL_VAL);
+        return NCX_EL_NONE;
+    }
+    return phasenames[phase];
+
+}  /* agt_rpcstat_get_phase_name */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_bucket_bound
+*
+* Get the largest time in a histogram bucket
+*
+* INPUTS:
+*   bucket == bucket index
+*
+* RETURNS:
+*   upper bound in micro-seconds;
+*   NCX_MAX_UINT for the last (unbounded) bucket
+*********************************************************************/
+uint32
+    agt_rpcstat_get_bucket_bound (uint32 bucket)
+{
+    if (bucket >= AGT_RPCSTAT_NUM_BUCKETS - 1) {
+        return NCX_MAX_UINT;
+    }
+    return (1U << bucket) - 1;
+
+}  /* agt_rpcstat_get_bucket_bound */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_first
+*
+* Get the first RPC statistics entry
+*
+* RETURNS:
+*   pointer to the first entry; NULL if none
+*********************************************************************/
+agt_rpcstat_t *
+    agt_rpcstat_get_first (void)
+{
+    if (!agt_rpcstat_init_done) {
+        return NULL;
+    }
+    return (agt_rpcstat_t *)dlq_firstEntry(&rpcstatQ);
+
+}  /* agt_rpcstat_get_first */
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_next
+*
+* Get the next RPC statistics entry
+*
+* INPUTS:
+*   rpcstat == current entry
+*
+* RETURNS:
+*   pointer to the next entry; NULL if none
+*********************************************************************/
+agt_rpcstat_t *
+    agt_rpcstat_get_next (agt_rpcstat_t *rpcstat)
+{
+#ifdef DEBUG
+    if (!rpcstat) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return NULL;
+    }
+#endif
+
+    return (agt_rpcstat_t *)dlq_nextEntry(rpcstat);
+
+}  /* agt_rpcstat_get_next */
+
+
+/* END file agt_rpcstat.c */
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_agt_rpcstat
+#define _H_agt_rpcstat
+/*  FILE: agt_rpcstat.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+   Per-phase RPC latency statistics
+
+   The time spent in each processing phase of an incoming <rpc>
+   is kept in a log2 histogram for each RPC method and datastore.
+   Only one RPC is processed at a time, so the phase timer is
+   a single global state machine driven by agt_rpc_dispatch.
+
+*/
+
+#ifndef _H_dlq
+#include "dlq.h"
+#endif
+
+#ifndef _H_obj
+#include "obj.h"
+#endif
+
+#ifndef _H_rpc
+#include "rpc.h"
+#endif
+
+#ifndef _H_status
+#include "status.h"
+#endif
+
+/********************************************************************
+*                                                                   *
+*                         C O N S T A N T S                         *
+*                                                                   *
+*********************************************************************/
+
+/* number of histogram buckets per phase
+ * bucket 0 is for 0 usec
+ * bucket N is for 2^(N-1) .. (2^N)-1 usec
+ * the last bucket also holds all the larger values (>= 4 sec)
+ */
+#define AGT_RPCSTAT_NUM_BUCKETS    24
+
+/********************************************************************
+*                                                                   *
+*                             T Y P E S                             *
+*                                                                   *
+*********************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* RPC processing phases that are timed */
+typedef enum agt_rpcstat_phase_t_ {
+    AGT_RPCSTAT_PH_NONE,
+    AGT_RPCSTAT_PH_XML_PARSE,     /* <rpc> and method element */
+    AGT_RPCSTAT_PH_INPUT_PARSE,   /* agt_rpc_parse_rpc_input */
+    AGT_RPCSTAT_PH_VALIDATE,      /* RPC validate callback */
+    AGT_RPCSTAT_PH_INVOKE,        /* RPC invoke callback */
+    AGT_RPCSTAT_PH_COMMIT_CHECK,  /* agt_val_root_check */
+    AGT_RPCSTAT_PH_APPLY,         /* SIL apply/commit/rollback */
+    AGT_RPCSTAT_PH_REPLY,         /* <rpc-reply> generation */
+    AGT_RPCSTAT_NUM_PHASES
+} agt_rpcstat_phase_t;
+
+
+/* timing histogram for one phase */
+typedef struct agt_rpcstat_histo_t_ {
+    uint32                  count;     /* times phase was entered */
+    uint32                  maxtime;   /* usec for slowest */
+    uint64                  totaltime;  /* usec for all */
+    uint32                  buckets[AGT_RPCSTAT_NUM_BUCKETS];
+} agt_rpcstat_histo_t;
+
+
+/* statistics for one RPC method and datastore */
+typedef struct agt_rpcstat_t_ {
+    dlq_hdr_t               qhdr;
+    obj_template_t         *rpcobj;
+    const xmlChar          *datastore;   /* back-ptr to static name */
+    uint32                  count;
+    uint32                  errors;      /* replies with rpc-error */
+    agt_rpcstat_histo_t     phase[AGT_RPCSTAT_NUM_PHASES];
+} agt_rpcstat_t;
+
+
+/********************************************************************
+*                                                                   *
+*                        F U N C T I O N S                          *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_init
+*
+* Initialize the RPC statistics module data structures
+*
+*********************************************************************/
+extern void
+    agt_rpcstat_init (void);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_cleanup
+*
+* Cleanup the RPC statistics module data structures
+*
+*********************************************************************/
+extern void
+    agt_rpcstat_cleanup (void);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_start
+*
+* Start timing an incoming <rpc>
+* The current phase is set to AGT_RPCSTAT_PH_XML_PARSE
+*
+*********************************************************************/
+extern void
+    agt_rpcstat_start (void);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_enter
+*
+* Switch the RPC timer to a new phase
+* The time since the last switch is charged to the current phase
+* Does nothing if no RPC is being timed
+*
+* INPUTS:
+*   phase == phase to enter
+*
+* RETURNS:
+*   the phase that was left; the caller passes this to
+*   agt_rpcstat_enter to return to it after a nested phase
+*********************************************************************/
+extern agt_rpcstat_phase_t
+    agt_rpcstat_enter (agt_rpcstat_phase_t phase);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_finish
+*
+* Stop timing the current <rpc> and add the phase times
+* to the statistics for the RPC method and datastore
+*
+* INPUTS:
+*   msg == RPC message that was processed
+*          if msg->rpc_method is NULL the times are discarded
+*********************************************************************/
+extern void
+    agt_rpcstat_finish (const rpc_msg_t *msg);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_reset
+*
+* Clear all the RPC statistics
+*
+*********************************************************************/
+extern void
+    agt_rpcstat_reset (void);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_phase_name
+*
+* Get the YANG enum name for a phase
+*
+* INPUTS:
+*   phase == phase enum
+*
+* RETURNS:
+*   const pointer to the phase name
+*********************************************************************/
+extern const xmlChar *
+    agt_rpcstat_get_phase_name (agt_rpcstat_phase_t phase);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_bucket_bound
+*
+* Get the largest time in a histogram bucket
+*
+* INPUTS:
+*   bucket == bucket index
+*
+* RETURNS:
+*   upper bound in micro-seconds;
+*   NCX_MAX_UINT for the last (unbounded) bucket
+*********************************************************************/
+extern uint32
+    agt_rpcstat_get_bucket_bound (uint32 bucket);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_first
+*
+* Get the first RPC statistics entry
+*
+* RETURNS:
+*   pointer to the first entry; NULL if none
+*********************************************************************/
+extern agt_rpcstat_t *
+    agt_rpcstat_get_first (void);
+
+
+/********************************************************************
+* FUNCTION agt_rpcstat_get_next
+*
+* Get the next RPC statistics entry
+*
+* INPUTS:
+*   rpcstat == current entry
+*
+* RETURNS:
+*   pointer to the next entry; NULL if none
+*********************************************************************/
+extern agt_rpcstat_t *
+    agt_rpcstat_get_next (agt_rpcstat_t *rpcstat);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif            /* _H_agt_rpcstat */
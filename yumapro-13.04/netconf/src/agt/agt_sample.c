@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: agt_sample.c
+
+   Shared samples of system state files
+
+   Monitoring applications tend to poll the same state data
+   from many sessions every few seconds.  Instead of each
+   get callback opening and parsing the /proc file again,
+   the file is read and parsed at most once per --sample-interval
+   and the parsed snapshot is shared by all the callbacks.
+
+   The sample count, snapshot age and the time spent reading
+   and parsing each source are kept for the
+   /netconf-state/samplers monitoring data.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <sys/time.h>
+
+#include "procdefs.h"
+#include "agt.h"
+#include "agt_sample.h"
+#include "dlq.h"
+#include "log.h"
+#include "ncxconst.h"
+#include "status.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+*                                                                   *
+*                           T Y P E S                               *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static boolean              agt_sample_init_done = FALSE;
+
+/* Q of agt_sample_t */
+static dlq_hdr_t            sampleQ;
+
+
+/********************************************************************
+* FUNCTION elapsed_usecs
+*
+* Get the number of micro-seconds between 2 timestamps
+*
+* INPUTS:
+*   start == start time
+*   end == end time
+*
+* RETURNS:
+*   number of micro-seconds; 0 if end is before start
+*********************************************************************/
+static uint64
+    elapsed_usecs (const struct timeval *start,
+                   const struct timeval *end)
+{
+    int64   usecs;
+
+    usecs = ((int64)(end->tv_sec - start->tv_sec) * 1000000) +
+        (int64)(end->tv_usec - start->tv_usec);
+
+    return (usecs > 0) ? (uint64)usecs : 0;
+
+}  /* elapsed_usecs */
+
+
+/********************************************************************
+* FUNCTION free_sample
+*
+* Clean and free a sampler
+*
+* INPUTS:
+*   sample == agt_sample_t struct to free
+*********************************************************************/
+static void
+    free_sample (agt_sample_t *sample)
+{
+    if (sample->data && sample->freefn) {
+        (*sample->freefn)(sample->data);
+    }
+    m__free(sample);
+
+}  /* free_sample */
+
+
+/************* E X T E R N A L    F U N C T I O N S ***************/
+
+
+/********************************************************************
+* FUNCTION agt_sample_init
+*
+* Initialize the sampler module data structures
+*
+*********************************************************************/
+void
+    agt_sample_init (void)
+{
+    if (!agt_sample_init_done) {
+        dlq_createSQue(&sampleQ);
+        agt_sample_init_done = TRUE;
+    }
+
+}  /* agt_sample_init */
+
+
+/********************************************************************
+* FUNCTION agt_sample_cleanup
+*
+* Cleanup the sampler module data structures
+* All registered samplers are freed
+*
+*********************************************************************/
+void
+    agt_sample_cleanup (void)
+{
+    agt_sample_t  *sample;
+
+    if (agt_sample_init_done) {
+        while (!dlq_empty(&sampleQ)) {
+            sample = (agt_sample_t *)dlq_deque(&sampleQ);
+            free_sample(sample);
+        }
+        agt_sample_init_done = FALSE;
+    }
+
+}  /* agt_sample_cleanup */
+
+
+/********************************************************************
+* FUNCTION agt_sample_register
+*
+* Register a shared sampler for a system state file
+*
+* INPUTS:
+*   source == name of the file to read (must be a static string)
+*   parsefn == function to parse the file into a snapshot
+*   freefn == function to free a snapshot
+*   cookie == pointer to save for the parsefn
+*
+* RETURNS:
+*   pointer to the new sampler; NULL if malloc failed
+*********************************************************************/
+agt_sample_t *
+    agt_sample_register (const char *source,
+                         agt_sample_parse_fn_t parsefn,
+                         agt_sample_free_fn_t freefn,
+                         void *cookie)
+{
+    agt_sample_t  *sample;
+
+#ifdef DEBUG
+    if (!source || !parsefn || !freefn) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return NULL;
+    }
+#endif
+
+    if (!agt_sample_init_done) {
+        SET_ERROR(ERR_INTERNAL_INIT_SEQ);
+        return NULL;
+    }
+
+    sample = m__getObj(agt_sample_t);
+    if (!sample) {
+        return NULL;
+    }
+    memset(sample, 0x0, sizeof(agt_sample_t));
+
+    sample->source = source;
+    sample->parsefn = parsefn;
+    sample->freefn = freefn;
+    sample->cookie = cookie;
+
+    dlq_enque(sample, &sampleQ);
+    return sample;
+
+}  /* agt_sample_register */
+
+
+/********************************************************************
+* FUNCTION agt_sample_unregister
+*
+* Unregister and free a sampler
+*
+* INPUTS:
+*   sample == sampler to free
+*********************************************************************/
+void
+    agt_sample_unregister (agt_sample_t *sample)
+{
+    if (!sample) {
+        return;
+    }
+
+    dlq_remove(sample);
+    free_sample(sample);
+
+}  /* agt_sample_unregister */
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_data
+*
+* Get the current snapshot for a sampler
+* The source file is read again if the snapshot is older
+* than the --sample-interval
+*
+*  !!! DO NOT SAVE THE RETURN VALUE; IT IS FREED
+*  !!! WHEN THE NEXT SAMPLE IS TAKEN
+*
+* INPUTS:
+*   sample == sampler to use
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == return status
+*
+* RETURNS:
+*   pointer to the snapshot; NULL if none
+*********************************************************************/
+void *
+    agt_sample_get_data (agt_sample_t *sample,
+                         status_t *res)
+{
+    FILE           *fp;
+    void           *newdata;
+    struct timeval  starttime, endtime;
+    uint64          cost;
+
+#ifdef DEBUG
+    if (!sample || !res) {
+        if (res) {
+            *res = SET_ERROR(ERR_INTERNAL_PTR);
+        }
+        return NULL;
+    }
+#endif
+
+    *res = NO_ERR;
+
+    /* reuse the snapshot if it is fresh enough */
+    if (sample->data &&
+        agt_sample_get_age(sample) < agt_sample_get_interval()) {
+        sample->hits++;
+        return sample->data;
+    }
+
+    (void)gettimeofday(&starttime, NULL);
+
+    fp = fopen(sample->source, "r");
+    if (fp == NULL) {
+        *res = errno_to_status();
+        sample->errors++;
+        return NULL;
+    }
+
+    newdata = NULL;
+    *res = (*sample->parsefn)(sample, fp, &newdata);
+    fclose(fp);
+
+    (void)gettimeofday(&endtime, NULL);
+    cost = elapsed_usecs(&starttime, &endtime);
+
+    if (*res != NO_ERR) {
+        if (newdata) {
+            (*sample->freefn)(newdata);
+        }
+        sample->errors++;
+        log_error("\nError: sample of '%s' failed (%s)",
+                  sample->source, get_error_string(*res));
+        return NULL;
+    }
+
+    if (sample->data) {
+        (*sample->freefn)(sample->data);
+    }
+    sample->data = newdata;
+    sample->sampletime = starttime;
+    sample->samples++;
+    sample->lastcost = (cost > NCX_MAX_UINT) ? NCX_MAX_UINT : (uint32)cost;
+    sample->totalcost += cost;
+
+    if (LOGDEBUG3) {
+        log_debug3("\nagt_sample: read '%s' in %u usec",
+                   sample->source, sample->lastcost);
+    }
+
+    return newdata;
+
+}  /* agt_sample_get_data */
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_age
+*
+* Get the age of the current snapshot for a sampler
+*
+* INPUTS:
+*   sample == sampler to check
+*
+* RETURNS:
+*   milli-seconds since the snapshot was taken; 0 if none
+*********************************************************************/
+uint32
+    agt_sample_get_age (const agt_sample_t *sample)
+{
+    struct timeval  timenow;
+    uint64          msecs;
+
+#ifdef DEBUG
+    if (!sample) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return 0;
+    }
+#endif
+
+    if (sample->samples == 0) {
+        return 0;
+    }
+
+    (void)gettimeofday(&timenow, NULL);
+
+    /* a clock set back to before the sample makes it stale */
+    if (timenow.tv_sec < sample->sampletime.tv_sec) {
+        return NCX_MAX_UINT;
+    }
+
+    msecs = elapsed_usecs(&sample->sampletime, &timenow) / 1000;
+    return (msecs > NCX_MAX_UINT) ? NCX_MAX_UINT : (uint32)msecs;
+
+}  /* agt_sample_get_age */
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_interval
+*
+* Get the --sample-interval value
+*
+* RETURNS:
+*   max age in milli-seconds for a snapshot to be reused
+*********************************************************************/
+uint32
+    agt_sample_get_interval (void)
+{
+    const agt_profile_t  *profile;
+
+    profile = agt_get_profile();
+    return profile->agt_sample_interval;
+
+}  /* agt_sample_get_interval */
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_first
+*
+* Get the first registered sampler
+*
+* RETURNS:
+*   pointer to the first sampler; NULL if none
+*********************************************************************/
+agt_sample_t *
+    agt_sample_get_first (void)
+{
+    if (!agt_sample_init_done) {
+        return NULL;
+    }
+    return (agt_sample_t *)dlq_firstEntry(&sampleQ);
+
+}  /* agt_sample_get_first */
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_next
+*
+* Get the next registered sampler
+*
+* INPUTS:
+*   sample == current sampler
+*
+* RETURNS:
+*   pointer to the next sampler; NULL if none
+*********************************************************************/
+agt_sample_t *
+    agt_sample_get_next (agt_sample_t *sample)
+{
+#ifdef DEBUG
+    if (!sample) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return NULL;
+    }
+#endif
+
+    return (agt_sample_t *)dlq_nextEntry(sample);
+
+}  /* agt_sample_get_next */
+
+
+/* END file agt_sample.c */
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_agt_sample
+#define _H_agt_sample
+/*  FILE: agt_sample.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+   Shared samples of system state files such as /proc/net/dev
+
+   Each sampler reads and parses its source file at most once
+   per --sample-interval.  All the get callbacks for the state
+   data use the same parsed snapshot until it is stale.
+
+*/
+
+#include <stdio.h>
+#include <sys/time.h>
+
+#ifndef _H_dlq
+#include "dlq.h"
+#endif
+
+#ifndef _H_status
+#include "status.h"
+#endif
+
+/********************************************************************
+*                                                                   *
+*                         C O N S T A N T S                         *
+*                                                                   *
+*********************************************************************/
+
+/* default --sample-interval value in milli-seconds */
+#define AGT_SAMPLE_DEF_INTERVAL  1000
+
+/********************************************************************
+*                                                                   *
+*                             T Y P E S                             *
+*                                                                   *
+*********************************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct agt_sample_t_;
+
+/* agt_sample_parse_fn_t
+ *
+ * Parse one sample of the source file
+ *
+ * The previous snapshot is still in sample->data during
+ * this call, and agt_sample_get_age returns the time since
+ * it was taken, so delta and rate values can be computed
+ *
+ * INPUTS:
+ *   sample == sampler being refreshed
+ *   fp == source file open for reading
+ *   retdata == address of return parsed snapshot
+ *
+ * OUTPUTS:
+ *   *retdata == malloced snapshot, freed with the sampler freefn
+ *
+ * RETURNS:
+ *    status
+ */
+typedef status_t
+    (*agt_sample_parse_fn_t) (struct agt_sample_t_ *sample,
+                              FILE *fp,
+                              void **retdata);
+
+/* agt_sample_free_fn_t
+ *
+ * Free a snapshot made by the agt_sample_parse_fn_t
+ *
+ * INPUTS:
+ *   data == snapshot to free
+ */
+typedef void
+    (*agt_sample_free_fn_t) (void *data);
+
+
+/* one shared sampler for a system state file */
+typedef struct agt_sample_t_ {
+    dlq_hdr_t               qhdr;
+    const char             *source;    /* file to read */
+    agt_sample_parse_fn_t   parsefn;
+    agt_sample_free_fn_t    freefn;
+    void                   *cookie;    /* for the parsefn */
+    void                   *data;      /* current snapshot */
+    struct timeval          sampletime;  /* time data was read */
+    uint32                  samples;   /* number of times read */
+    uint32                  hits;      /* gets using the snapshot */
+    uint32                  errors;    /* read or parse failures */
+    uint32                  lastcost;  /* usec for last sample */
+    uint64                  totalcost;  /* usec for all samples */
+} agt_sample_t;
+
+
+/********************************************************************
+*                                                                   *
+*                        F U N C T I O N S                          *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+* FUNCTION agt_sample_init
+*
+* Initialize the sampler module data structures
+*
+*********************************************************************/
+extern void
+    agt_sample_init (void);
+
+
+/********************************************************************
+* FUNCTION agt_sample_cleanup
+*
+* Cleanup the sampler module data structures
+* All registered samplers are freed
+*
+*********************************************************************/
+extern void
+    agt_sample_cleanup (void);
+
+
+/********************************************************************
+* FUNCTION agt_sample_register
+*
+* Register a shared sampler for a system state file
+*
+* INPUTS:
+*   source == name of the file to read (must be a static string)
+*   parsefn == function to parse the file into a snapshot
+*   freefn == function to free a snapshot
+*   cookie == pointer to save for the parsefn
+*
+* RETURNS:
+*   pointer to the new sampler; NULL if malloc failed
+*********************************************************************/
+extern agt_sample_t *
+    agt_sample_register (const char *source,
+                         agt_sample_parse_fn_t parsefn,
+                         agt_sample_free_fn_t freefn,
+                         void *cookie);
+
+
+/********************************************************************
+* FUNCTION agt_sample_unregister
+*
+* Unregister and free a sampler
+*
+* INPUTS:
+*   sample == sampler to free
+*********************************************************************/
+extern void
+    agt_sample_unregister (agt_sample_t *sample);
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_data
+*
+* Get the current snapshot for a sampler
+* The source file is read again if the snapshot is older
+* than the --sample-interval
+*
+*  !!! DO NOT SAVE THE RETURN VALUE; IT IS FREED
+*  !!! WHEN THE NEXT SAMPLE IS TAKEN
+*
+* INPUTS:
+*   sample == sampler to use
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == return status
+*
+* RETURNS:
+*   pointer to the snapshot; NULL if none
+*********************************************************************/
+extern void *
+    agt_sample_get_data (agt_sample_t *sample,
+                         status_t *res);
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_age
+*
+* Get the age of the current snapshot for a sampler
+*
+* INPUTS:
+*   sample == sampler to check
+*
+* RETURNS:
+*   milli-seconds since the snapshot was taken; 0 if none
+*********************************************************************/
+extern uint32
+    agt_sample_get_age (const agt_sample_t *sample);
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_interval
+*
+* Get the --sample-interval value
+*
+* RETURNS:
+*   max age in milli-seconds for a snapshot to be reused
+*********************************************************************/
+extern uint32
+    agt_sample_get_interval (void);
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_first
+*
+* Get the first registered sampler
+*
+* RETURNS:
+*   pointer to the first sampler; NULL if none
+*********************************************************************/
+extern agt_sample_t *
+    agt_sample_get_first (void);
+
+
+/********************************************************************
+* FUNCTION agt_sample_get_next
+*
+* Get the next registered sampler
+*
+* INPUTS:
+*   sample == current sampler
+*
+* RETURNS:
+*   pointer to the next sampler; NULL if none
+*********************************************************************/
+extern agt_sample_t *
+    agt_sample_get_next (agt_sample_t *sample);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif            /* _H_agt_sample */
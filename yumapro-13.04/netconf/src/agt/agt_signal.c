@@ -38,6 +38,7 @@ date         init     comment
 #include "agt.h"
 #include "agt_signal.h"
 #include "ncx.h"
+#include "ncx_trace.h"
 #include "status.h"
 
 
@@ -57,7 +58,7 @@ typedef void (*sighandler_t)(int signum);
 *********************************************************************/
 
 static boolean agt_signal_init_done = FALSE;
-static sighandler_t sh_int, sh_hup, sh_term, sh_pipe, sh_alarm;
+static sighandler_t sh_int, sh_hup, sh_term, sh_pipe, sh_alarm, sh_usr1;
 
 /********************************************************************
 * FUNCTION agt_signal_init
@@ -79,6 +80,7 @@ void
         sh_term = signal(SIGTERM, agt_signal_handler);
         sh_pipe = signal(SIGPIPE, agt_signal_handler);
         sh_alarm = signal(SIGALRM, agt_signal_handler);
+        sh_usr1 = signal(SIGUSR1, agt_signal_handler);
         agt_signal_init_done = TRUE;
     }
 
@@ -101,6 +103,7 @@ void
         signal(SIGTERM, sh_term);
         signal(SIGPIPE, sh_pipe);
         signal(SIGALRM, sh_alarm);
+        signal(SIGUSR1, sh_usr1);
         agt_signal_init_done = FALSE;
     }
 
@@ -138,6 +141,10 @@ void
         break;
     case SIGALRM:
         break;
+    case SIGUSR1:
+        /* dump the trace buffer; kill -USR1 */
+        ncx_trace_request_dump();
+        break;
     default:
         /* ignore */;
     }
@@ -108,6 +108,8 @@ date         init     comment
 #include "agt_cap.h"
 #include "agt_cb.h"
 #include "agt_rpc.h"
+#include "agt_rpcstat.h"
+#include "agt_sample.h"
 #include "agt_ses.h"
 #include "agt_state.h"
 #include "agt_sys.h"
@@ -195,6 +197,36 @@ date         init     comment
 #define AGT_STATE_OBJ_BACKUP_TIME     (const xmlChar *)"backup-time"
 #define AGT_STATE_OBJ_BACKUP_FILES    (const xmlChar *)"backup-files"
 #define AGT_STATE_OBJ_CONFORMANCE     (const xmlChar *)"conformance"
+#define AGT_STATE_OBJ_SAMPLERS        (const xmlChar *)"samplers"
+#define AGT_STATE_OBJ_SAMPLER         (const xmlChar *)"sampler"
+#define AGT_STATE_OBJ_SAMPLE_INTERVAL (const xmlChar *)"sample-interval"
+#define AGT_STATE_OBJ_SOURCE          (const xmlChar *)"source"
+#define AGT_STATE_OBJ_SAMPLE_AGE      (const xmlChar *)"sample-age"
+#define AGT_STATE_OBJ_SAMPLES         (const xmlChar *)"samples"
+#define AGT_STATE_OBJ_CACHE_HITS      (const xmlChar *)"cache-hits"
+#define AGT_STATE_OBJ_ERRORS          (const xmlChar *)"errors"
+#define AGT_STATE_OBJ_LAST_COST       (const xmlChar *)"last-sample-cost"
+#define AGT_STATE_OBJ_TOTAL_COST      (const xmlChar *)"total-sample-cost"
+#define AGT_STATE_OBJ_VIRTUAL_CACHES  (const xmlChar *)"virtual-caches"
+#define AGT_STATE_OBJ_VIRTUAL_CACHE   (const xmlChar *)"virtual-cache"
+#define AGT_STATE_OBJ_OBJECT          (const xmlChar *)"object"
+#define AGT_STATE_OBJ_CACHE_TIMEOUT   (const xmlChar *)"cache-timeout"
+#define AGT_STATE_OBJ_ASYNC_REFRESH   (const xmlChar *)"async-refresh"
+#define AGT_STATE_OBJ_HITS            (const xmlChar *)"hits"
+#define AGT_STATE_OBJ_MISSES          (const xmlChar *)"misses"
+#define AGT_STATE_OBJ_STALE_HITS      (const xmlChar *)"stale-hits"
+#define AGT_STATE_OBJ_LAST_GET_TIME   (const xmlChar *)"last-get-time"
+#define AGT_STATE_OBJ_MAX_GET_TIME    (const xmlChar *)"max-get-time"
+#define AGT_STATE_OBJ_TOTAL_GET_TIME  (const xmlChar *)"total-get-time"
+#define AGT_STATE_OBJ_RPC_STATISTICS  (const xmlChar *)"rpc-statistics"
+#define AGT_STATE_OBJ_RPC_STATISTIC   (const xmlChar *)"rpc-statistic"
+#define AGT_STATE_OBJ_MODULE          (const xmlChar *)"module"
+#define AGT_STATE_OBJ_COUNT           (const xmlChar *)"count"
+#define AGT_STATE_OBJ_PHASE           (const xmlChar *)"phase"
+#define AGT_STATE_OBJ_MAX_TIME        (const xmlChar *)"max-time"
+#define AGT_STATE_OBJ_TOTAL_TIME      (const xmlChar *)"total-time"
+#define AGT_STATE_OBJ_BUCKET          (const xmlChar *)"bucket"
+#define AGT_STATE_OBJ_UPPER_BOUND     (const xmlChar *)"upper-bound"
 
 
 
@@ -1474,6 +1506,525 @@ static status_t
 }  /* backup_file_cbfn */
 
 
+/**
+ * \fn add_sampler_uint_leaf
+ * \brief Add a uint32 leaf to a sampler list entry
+ * \param listval sampler list entry to add the leaf to
+ * \param leafname name of the leaf to add
+ * \param leafval value of the leaf
+ * \return status
+ */
+static status_t
+    add_sampler_uint_leaf (val_value_t *listval,
+                           const xmlChar *leafname,
+                           uint32 leafval)
+{
+    status_t res = NO_ERR;
+    val_value_t *leafv =
+        agt_make_uint_leaf(listval->obj, leafname, leafval, &res);
+    if (leafv) {
+        val_add_child(leafv, listval);
+    }
+    return res;
+
+}  /* add_sampler_uint_leaf */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn make_sampler_entry
+ * \brief Make a sampler list entry for one shared sampler
+ * \param sample shared sampler to report
+ * \param listobj object template to use for the list entry
+ * \param res address of return status
+ * \return pointer to malloced list entry; NULL if some error
+ */
+static val_value_t *
+    make_sampler_entry (const agt_sample_t *sample,
+                        obj_template_t *listobj,
+                        status_t *res)
+{
+    val_value_t *listval = val_new_value();
+    if (listval == NULL) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    val_init_from_template(listval, listobj);
+
+    /* add the sampler/source key leaf */
+    val_value_t *leafval =
+        agt_make_leaf(listobj, AGT_STATE_OBJ_SOURCE,
+                      (const xmlChar *)sample->source, res);
+    if (leafval == NULL) {
+        val_free_value(listval);
+        return NULL;
+    }
+    val_add_child(leafval, listval);
+
+    *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_SAMPLE_AGE,
+                                 agt_sample_get_age(sample));
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_SAMPLES,
+                                     sample->samples);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_CACHE_HITS,
+                                     sample->hits);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_ERRORS,
+                                     sample->errors);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_LAST_COST,
+                                     sample->lastcost);
+    }
+    if (*res == NO_ERR) {
+        leafval = agt_make_uint64_leaf(listobj, AGT_STATE_OBJ_TOTAL_COST,
+                                       sample->totalcost, res);
+        if (leafval) {
+            val_add_child(leafval, listval);
+        }
+    }
+    if (*res == NO_ERR) {
+        *res = val_gen_index_chain(listobj, listval);
+    }
+    if (*res != NO_ERR) {
+        val_free_value(listval);
+        return NULL;
+    }
+    return listval;
+
+}  /* make_sampler_entry */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn get_samplers
+ * \brief <get> operation for the samplers NP container
+ * \param scb session that issued the get (may be NULL)
+ * \param cbmode reason for the callback
+ * \param virval place-holder node in data model for this virtual
+ * value node
+ * \param dstval pointer to value output struct
+ * \return status
+ */
+static status_t 
+    get_samplers (ses_cb_t *scb,
+                  getcb_mode_t cbmode,
+                  val_value_t *virval,
+                  val_value_t  *dstval)
+{
+    (void)scb;
+
+    if (cbmode != GETCB_GET_VALUE) {
+        return ERR_NCX_OPERATION_NOT_SUPPORTED;
+    }
+
+    obj_template_t *listobj =
+        obj_find_child(virval->obj, AGT_YWSYS_MODULE,
+                       AGT_STATE_OBJ_SAMPLER);
+    if (listobj == NULL) {
+        return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+    }
+
+    status_t res = NO_ERR;
+    val_value_t *leafval =
+        agt_make_uint_leaf(virval->obj, AGT_STATE_OBJ_SAMPLE_INTERVAL,
+                           agt_sample_get_interval(), &res);
+    if (leafval == NULL) {
+        return res;
+    }
+    val_add_child(leafval, dstval);
+
+    agt_sample_t *sample;
+    for (sample = agt_sample_get_first();
+         sample != NULL && res == NO_ERR;
+         sample = agt_sample_get_next(sample)) {
+        val_value_t *listval = make_sampler_entry(sample, listobj, &res);
+        if (listval) {
+            val_add_child(listval, dstval);
+        }
+    }
+
+    return res;
+
+}  /* get_samplers */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn make_vcache_entry
+ * \brief Make a virtual-cache list entry for one object
+ * \param vcache object virtual cache stats to report
+ * \param listobj object template to use for the list entry
+ * \param res address of return status
+ * \return pointer to malloced list entry; NULL if some error
+ */
+static val_value_t *
+    make_vcache_entry (const obj_vcache_t *vcache,
+                       obj_template_t *listobj,
+                       status_t *res)
+{
+    xmlChar *objid = NULL;
+    *res = obj_gen_object_id(vcache->obj, &objid);
+    if (*res != NO_ERR) {
+        return NULL;
+    }
+
+    val_value_t *listval = val_new_value();
+    if (listval == NULL) {
+        m__free(objid);
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    val_init_from_template(listval, listobj);
+
+    /* add the virtual-cache/object key leaf */
+    val_value_t *leafval =
+        agt_make_leaf(listobj, AGT_STATE_OBJ_OBJECT, objid, res);
+    m__free(objid);
+    if (leafval == NULL) {
+        val_free_value(listval);
+        return NULL;
+    }
+    val_add_child(leafval, listval);
+
+    if (vcache->timeout_set) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_CACHE_TIMEOUT,
+                                     vcache->timeout);
+    }
+    if (*res == NO_ERR) {
+        leafval = agt_make_leaf(listobj, AGT_STATE_OBJ_ASYNC_REFRESH,
+                                (vcache->async_refresh) ? 
+                                NCX_EL_TRUE : NCX_EL_FALSE, res);
+        if (leafval) {
+            val_add_child(leafval, listval);
+        }
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_HITS,
+                                     vcache->hits);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_MISSES,
+                                     vcache->misses);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_STALE_HITS,
+                                     vcache->stale_hits);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_ERRORS,
+                                     vcache->errors);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_LAST_GET_TIME,
+                                     vcache->lastcost);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_MAX_GET_TIME,
+                                     vcache->maxcost);
+    }
+    if (*res == NO_ERR) {
+        leafval = agt_make_uint64_leaf(listobj, AGT_STATE_OBJ_TOTAL_GET_TIME,
+                                       vcache->totalcost, res);
+        if (leafval) {
+            val_add_child(leafval, listval);
+        }
+    }
+    if (*res == NO_ERR) {
+        *res = val_gen_index_chain(listobj, listval);
+    }
+    if (*res != NO_ERR) {
+        val_free_value(listval);
+        return NULL;
+    }
+    return listval;
+
+}  /* make_vcache_entry */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn get_virtual_caches
+ * \brief <get> operation for the virtual-caches NP container
+ * \param scb session that issued the get (may be NULL)
+ * \param cbmode reason for the callback
+ * \param virval place-holder node in data model for this virtual
+ * value node
+ * \param dstval pointer to value output struct
+ * \return status
+ */
+static status_t 
+    get_virtual_caches (ses_cb_t *scb,
+                        getcb_mode_t cbmode,
+                        val_value_t *virval,
+                        val_value_t  *dstval)
+{
+    (void)scb;
+
+    if (cbmode != GETCB_GET_VALUE) {
+        return ERR_NCX_OPERATION_NOT_SUPPORTED;
+    }
+
+    obj_template_t *listobj =
+        obj_find_child(virval->obj, AGT_YWSYS_MODULE,
+                       AGT_STATE_OBJ_VIRTUAL_CACHE);
+    if (listobj == NULL) {
+        return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+    }
+
+    status_t res = NO_ERR;
+    obj_vcache_t *vcache;
+    for (vcache = obj_get_first_vcache();
+         vcache != NULL && res == NO_ERR;
+         vcache = obj_get_next_vcache(vcache)) {
+        val_value_t *listval = make_vcache_entry(vcache, listobj, &res);
+        if (listval) {
+            val_add_child(listval, dstval);
+        }
+    }
+
+    return res;
+
+}  /* get_virtual_caches */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn add_rpcstat_key_leaf
+ * \brief Add a string key leaf to a list entry
+ * \param listval list entry to add the leaf to
+ * \param leafname name of the leaf to add
+ * \param leafstr value of the leaf
+ * \return status
+ */
+static status_t
+    add_rpcstat_key_leaf (val_value_t *listval,
+                          const xmlChar *leafname,
+                          const xmlChar *leafstr)
+{
+    status_t res = NO_ERR;
+    val_value_t *leafv =
+        agt_make_leaf(listval->obj, leafname, leafstr, &res);
+    if (leafv) {
+        val_add_child(leafv, listval);
+    }
+    return res;
+
+}  /* add_rpcstat_key_leaf */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn make_phase_entry
+ * \brief Make a phase list entry for one RPC processing phase
+ * \param histo timing histogram to report
+ * \param phase phase to report
+ * \param listobj object template to use for the list entry
+ * \param res address of return status
+ * \return pointer to malloced list entry; NULL if some error
+ */
+static val_value_t *
+    make_phase_entry (const agt_rpcstat_histo_t *histo,
+                      agt_rpcstat_phase_t phase,
+                      obj_template_t *listobj,
+                      status_t *res)
+{
+    obj_template_t *bucketobj =
+        obj_find_child(listobj, AGT_YWSYS_MODULE, AGT_STATE_OBJ_BUCKET);
+    if (bucketobj == NULL) {
+        *res = SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+        return NULL;
+    }
+
+    val_value_t *listval = val_new_value();
+    if (listval == NULL) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    val_init_from_template(listval, listobj);
+
+    *res = add_rpcstat_key_leaf(listval, AGT_STATE_OBJ_NAME,
+                                agt_rpcstat_get_phase_name(phase));
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_COUNT,
+                                     histo->count);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_MAX_TIME,
+                                     histo->maxtime);
+    }
+    if (*res == NO_ERR) {
+        val_value_t *leafval =
+            agt_make_uint64_leaf(listobj, AGT_STATE_OBJ_TOTAL_TIME,
+                                 histo->totaltime, res);
+        if (leafval) {
+            val_add_child(leafval, listval);
+        }
+    }
+    if (*res == NO_ERR) {
+        *res = val_gen_index_chain(listobj, listval);
+    }
+
+    uint32 bucket;
+    for (bucket = 0;
+         bucket < AGT_RPCSTAT_NUM_BUCKETS && *res == NO_ERR;
+         bucket++) {
+        if (histo->buckets[bucket] == 0) {
+            continue;
+        }
+
+        val_value_t *bucketval = val_new_value();
+        if (bucketval == NULL) {
+            *res = ERR_INTERNAL_MEM;
+            continue;
+        }
+        val_init_from_template(bucketval, bucketobj);
+        val_add_child(bucketval, listval);
+
+        *res = add_sampler_uint_leaf(bucketval, AGT_STATE_OBJ_UPPER_BOUND,
+                                     agt_rpcstat_get_bucket_bound(bucket));
+        if (*res == NO_ERR) {
+            *res = add_sampler_uint_leaf(bucketval, AGT_STATE_OBJ_COUNT,
+                                         histo->buckets[bucket]);
+        }
+        if (*res == NO_ERR) {
+            *res = val_gen_index_chain(bucketobj, bucketval);
+        }
+    }
+
+    if (*res != NO_ERR) {
+        val_free_value(listval);
+        return NULL;
+    }
+    return listval;
+
+}  /* make_phase_entry */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn make_rpcstat_entry
+ * \brief Make an rpc-statistic list entry for one RPC and datastore
+ * \param rpcstat RPC statistics to report
+ * \param listobj object template to use for the list entry
+ * \param res address of return status
+ * \return pointer to malloced list entry; NULL if some error
+ */
+static val_value_t *
+    make_rpcstat_entry (const agt_rpcstat_t *rpcstat,
+                        obj_template_t *listobj,
+                        status_t *res)
+{
+    obj_template_t *phaseobj =
+        obj_find_child(listobj, AGT_YWSYS_MODULE, AGT_STATE_OBJ_PHASE);
+    if (phaseobj == NULL) {
+        *res = SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+        return NULL;
+    }
+
+    val_value_t *listval = val_new_value();
+    if (listval == NULL) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    val_init_from_template(listval, listobj);
+
+    /* add the module, name and datastore key leafs */
+    *res = add_rpcstat_key_leaf(listval, AGT_STATE_OBJ_MODULE,
+                                obj_get_mod_name(rpcstat->rpcobj));
+    if (*res == NO_ERR) {
+        *res = add_rpcstat_key_leaf(listval, AGT_STATE_OBJ_NAME,
+                                    obj_get_name(rpcstat->rpcobj));
+    }
+    if (*res == NO_ERR) {
+        *res = add_rpcstat_key_leaf(listval, AGT_STATE_OBJ_DATASTORE,
+                                    rpcstat->datastore);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_COUNT,
+                                     rpcstat->count);
+    }
+    if (*res == NO_ERR) {
+        *res = add_sampler_uint_leaf(listval, AGT_STATE_OBJ_ERRORS,
+                                     rpcstat->errors);
+    }
+    if (*res == NO_ERR) {
+        *res = val_gen_index_chain(listobj, listval);
+    }
+
+    uint32 phase;
+    for (phase = AGT_RPCSTAT_PH_XML_PARSE;
+         phase < AGT_RPCSTAT_NUM_PHASES && *res == NO_ERR;
+         phase++) {
+        if (rpcstat->phase[phase].count == 0) {
+            continue;
+        }
+        val_value_t *phaseval = 
+            make_phase_entry(&rpcstat->phase[phase], 
+                             (agt_rpcstat_phase_t)phase, phaseobj, res);
+        if (phaseval) {
+            val_add_child(phaseval, listval);
+        }
+    }
+
+    if (*res != NO_ERR) {
+        val_free_value(listval);
+        return NULL;
+    }
+    return listval;
+
+}  /* make_rpcstat_entry */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn get_rpc_statistics
+ * \brief <get> operation for the rpc-statistics NP container
+ * \param scb session that issued the get (may be NULL)
+ * \param cbmode reason for the callback
+ * \param virval place-holder node in data model for this virtual
+ * value node
+ * \param dstval pointer to value output struct
+ * \return status
+ */
+static status_t 
+    get_rpc_statistics (ses_cb_t *scb,
+                        getcb_mode_t cbmode,
+                        val_value_t *virval,
+                        val_value_t  *dstval)
+{
+    (void)scb;
+
+    if (cbmode != GETCB_GET_VALUE) {
+        return ERR_NCX_OPERATION_NOT_SUPPORTED;
+    }
+
+    obj_template_t *listobj =
+        obj_find_child(virval->obj, AGT_YWSYS_MODULE,
+                       AGT_STATE_OBJ_RPC_STATISTIC);
+    if (listobj == NULL) {
+        return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+    }
+
+    status_t res = NO_ERR;
+    agt_rpcstat_t *rpcstat;
+    for (rpcstat = agt_rpcstat_get_first();
+         rpcstat != NULL && res == NO_ERR;
+         rpcstat = agt_rpcstat_get_next(rpcstat)) {
+        val_value_t *listval = make_rpcstat_entry(rpcstat, listobj, &res);
+        if (listval) {
+            val_add_child(listval, dstval);
+        }
+    }
+
+    return res;
+
+}  /* get_rpc_statistics */
+
+
 /************* E X T E R N A L    F U N C T I O N S ***************/
 
 /**
@@ -1633,6 +2184,27 @@ status_t
         }
     }
 
+    obj_template_t *samplersobj = NULL;
+    obj_template_t *vcachesobj = NULL;
+    obj_template_t *rpcstatsobj = NULL;
+    if (agt_get_profile()->agt_yumaworks_system) {
+        samplersobj = obj_find_child(topobj, AGT_YWSYS_MODULE,
+                                     AGT_STATE_OBJ_SAMPLERS);
+        if (!samplersobj) {
+            return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+        }
+        vcachesobj = obj_find_child(topobj, AGT_YWSYS_MODULE,
+                                    AGT_STATE_OBJ_VIRTUAL_CACHES);
+        if (!vcachesobj) {
+            return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+        }
+        rpcstatsobj = obj_find_child(topobj, AGT_YWSYS_MODULE,
+                                     AGT_STATE_OBJ_RPC_STATISTICS);
+        if (!rpcstatsobj) {
+            return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+        }
+    }
+
     /* add /ietf-netconf-state */
     val_value_t *topval = val_new_value();
     if (!topval) {
@@ -1733,6 +2305,39 @@ status_t
         res = ncxmod_get_backup_files(backup_file_cbfn, bkupval);
     }
 
+    if (res == NO_ERR && samplersobj) {
+        /* add yumaworks-system extension:
+         * /ietf-netconf-state/samplers virtual node */
+        val_value_t *samplersval = val_new_value();
+        if (!samplersval) {
+            return ERR_INTERNAL_MEM;
+        }
+        val_init_virtual(samplersval, get_samplers, samplersobj);
+        val_add_child(samplersval, topval);
+    }
+
+    if (res == NO_ERR && vcachesobj) {
+        /* add yumaworks-system extension:
+         * /ietf-netconf-state/virtual-caches virtual node */
+        val_value_t *vcachesval = val_new_value();
+        if (!vcachesval) {
+            return ERR_INTERNAL_MEM;
+        }
+        val_init_virtual(vcachesval, get_virtual_caches, vcachesobj);
+        val_add_child(vcachesval, topval);
+    }
+
+    if (res == NO_ERR && rpcstatsobj) {
+        /* add yumaworks-system extension:
+         * /ietf-netconf-state/rpc-statistics virtual node */
+        val_value_t *rpcstatsval = val_new_value();
+        if (!rpcstatsval) {
+            return ERR_INTERNAL_MEM;
+        }
+        val_init_virtual(rpcstatsval, get_rpc_statistics, rpcstatsobj);
+        val_add_child(rpcstatsval, topval);
+    }
+
     return res;
 
 }  /* agt_state_init2 */
@@ -57,6 +57,7 @@ date         init     comment
 #include "log.h"
 #include "ncxconst.h"
 #include "ncx.h"
+#include "ncx_trace.h"
 #include "status.h"
 #include "top.h"
 #include "xmlns.h"
@@ -107,9 +108,12 @@ void
     ses_cb_t *scb = *ppscb;
     assert(scb);
 
+    NCX_TRACE_BEGIN(NCX_TRACE_TOP_DISPATCH, scb->sid, NULL);
+
 #ifdef WITH_YANGAPI
     if (scb->protocol == NCX_PROTO_YUMA_YANGAPI) {
         agt_yangapi_dispatch(scb);
+        NCX_TRACE_END(NCX_TRACE_TOP_DISPATCH, NULL);
         return;
     }
 #endif
@@ -139,6 +143,7 @@ void
         /* set the supplied ptr to ptr to scb to NULL so that the 
          * caller of this function knows that it was deallotcated */
         *ppscb=NULL;
+        NCX_TRACE_END(NCX_TRACE_TOP_DISPATCH, NULL);
         return;
     }
 
@@ -179,8 +184,12 @@ void
         *ppscb=NULL;
 
     } else if (profile->agt_stream_output &&
-               scb->state == SES_ST_SHUTDOWN_REQ) {
-        /* session was closed */
+               scb->state == SES_ST_SHUTDOWN_REQ &&
+               dlq_empty(&scb->outQ)) {
+        /* session was closed; if the reply is still in the outQ
+         * then the session is killed by the main loop after
+         * the reply has been sent
+         */
         agt_ses_kill_session(scb, scb->killedbysid, scb->termreason);
         /* set the supplied ptr to ptr to scb to NULL so that the 
          * caller of this function knows that it was deallotcated */
@@ -188,6 +197,7 @@ void
     }
 
     xml_clean_node(&top);
+    NCX_TRACE_END(NCX_TRACE_TOP_DISPATCH, NULL);
 
 } /* agt_top_dispatch_msg */
 
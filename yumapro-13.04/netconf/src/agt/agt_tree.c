@@ -59,6 +59,29 @@
            instances from the target, if the node is not
            marked as deleted
            
+   Streaming Mode) agt_tree_stream_filter combines steps 2 and 3
+           into 1 pass.  The filter is tested against the target
+           and each matching node is written to the session as
+           soon as it is found.  No ncx_filptr_t tree is built.
+
+       - The start tag for a container or list is deferred
+         until the first descendant node is written, since an
+         empty match must not produce any output.  The pending
+         ancestor start tags are kept in a chain of stream_frame_t
+         structs on the stack.
+
+       - The list keys are written right after the list start tag
+         and are not written again if they are also selected.
+
+       - Virtual containers are retrieved with val_make_virtual_value
+         and freed as soon as the subtree has been written, so they
+         are not held in the val->virtualval cache.
+
+       - Virtual lists are walked with the list iterator callback
+         in batches.  The key content match nodes and the selected
+         child nodes from the filter are passed to the callback,
+         and each batch is freed after it has been tested.
+
    
 *********************************************************************
 *                                                                   *
@@ -92,6 +115,7 @@ date         init     comment
 #include "cfg.h"
 #include "def_reg.h"
 #include "dlq.h"
+#include "getcb.h"
 #include "log.h"
 #include "ncx.h"
 #include "ncx_num.h"
@@ -117,6 +141,25 @@ date         init     comment
 *********************************************************************/
 
 
+/********************************************************************
+*                                                                   *
+*                             T Y P E S                             *
+*                                                                   *
+*********************************************************************/
+
+/* one pending or started complex node for agt_tree_stream_filter
+ * The frames are linked from child to parent on the C stack
+ */
+typedef struct stream_frame_t_ {
+    struct stream_frame_t_ *parent;     /* parent frame or NULL */
+    val_value_t  *val;         /* node to write the tags for */
+    val_value_t  *useval;     /* val or virtual value of val */
+    int32         indent;            /* start tag indent amount */
+    int32         childindent;         /* child indent amount */
+    boolean       started;       /* T: start tag already sent */
+} stream_frame_t;
+
+
 /********************************************************************
 *                                                                   *
 *                       V A R I A B L E S                            *
@@ -124,6 +167,16 @@ date         init     comment
 *********************************************************************/
 
 
+/* stream_container and stream_val call each other */
+static status_t
+    stream_val (ses_cb_t *scb,
+                rpc_msg_t *msg,
+                boolean getop,
+                val_value_t *filval,
+                stream_frame_t *frame,
+                boolean *keepempty);
+
+
 /********************************************************************
 * FUNCTION save_filptr
 *
@@ -853,6 +906,547 @@ static void
 }  /* dump_filptr_node */
 
 
+/********************************************************************
+* FUNCTION stream_start_frame
+*
+* Write the start tag for a pending frame, after making sure
+* all the ancestor start tags have been written first.
+* If the node is a list then the keys are written as well.
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    frame == frame to start
+*    getop == TRUE if <get>, FALSE if <get-config>
+*
+*********************************************************************/
+static void
+    stream_start_frame (ses_cb_t *scb,
+                        rpc_msg_t *msg,
+                        stream_frame_t *frame,
+                        boolean getop)
+{
+    if (frame->started) {
+        return;
+    }
+
+    if (frame->parent) {
+        stream_start_frame(scb, msg, frame->parent, getop);
+    }
+
+    val_value_t *val = frame->val;
+    xmlns_id_t valnsid = obj_get_nsid(val->obj);
+    xmlns_id_t parentnsid = 0;
+    if (val->parent) {
+        parentnsid = obj_get_nsid(val->parent->obj);
+    }
+
+    xml_wr_begin_elem_ex(scb, &msg->mhdr, parentnsid, valnsid, 
+                         val->name, &val->metaQ, FALSE, 
+                         frame->indent, FALSE);
+    frame->started = TRUE;
+
+    if (val->btyp != NCX_BT_LIST) {
+        return;
+    }
+
+    /* make sure all the list keys (if any) are present,
+     * since specific nodes are requested, and the keys
+     * could get filtered out
+     */
+    val_index_t *valindex = val_get_first_index(frame->useval);
+    for (; valindex != NULL; valindex = val_get_next_index(valindex)) {
+        xml_wr_full_check_val(scb, &msg->mhdr, valindex->val, 
+                              frame->childindent, 
+                              (getop) ? agt_check_default : 
+                              agt_check_config);
+    }
+
+}  /* stream_start_frame */
+
+
+/********************************************************************
+* FUNCTION stream_end_frame
+*
+* Write the end tag for a frame if the start tag was written
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    frame == frame to end
+*
+*********************************************************************/
+static void
+    stream_end_frame (ses_cb_t *scb,
+                      rpc_msg_t *msg,
+                      stream_frame_t *frame)
+{
+    if (frame->started) {
+        xml_wr_end_elem(scb, &msg->mhdr, obj_get_nsid(frame->val->obj),
+                        frame->val->name, frame->indent);
+    }
+
+}  /* stream_end_frame */
+
+
+/********************************************************************
+* FUNCTION stream_node
+*
+* Write one entire matching node within a frame
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    frame == parent frame of the node
+*    val == node to write
+*    getop == TRUE if <get>, FALSE if <get-config>
+*
+*********************************************************************/
+static void
+    stream_node (ses_cb_t *scb,
+                 rpc_msg_t *msg,
+                 stream_frame_t *frame,
+                 val_value_t *val,
+                 boolean getop)
+{
+    stream_start_frame(scb, msg, frame, getop);
+
+    if (frame->val->btyp == NCX_BT_LIST && obj_is_key(val->obj)) {
+        /* skip the key if it was written with the list start tag */
+        val_index_t *valindex = val_get_first_index(frame->useval);
+        for (; valindex != NULL; valindex = val_get_next_index(valindex)) {
+            if (valindex->val == val) {
+                return;
+            }
+        }
+    }
+
+    xml_wr_full_check_val(scb, &msg->mhdr, val, frame->childindent, 
+                          (getop) ? agt_check_default : agt_check_config);
+
+}  /* stream_node */
+
+
+/********************************************************************
+* FUNCTION stream_container
+*
+* Evaluate a container filter node against one complex
+* database node and write the matching descendants
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    getop  == TRUE if this is a <get> and not a <get-config>
+*    filchild == container filter node
+*    frame == frame for the parent of curchild
+*    curchild == complex database node matched to filchild
+*
+* OUTPUTS:
+*    matching nodes are written to the session
+*
+* RETURNS:
+*     status, NO_ERR or malloc error
+*********************************************************************/
+static status_t
+    stream_container (ses_cb_t *scb,
+                      rpc_msg_t *msg,
+                      boolean getop,
+                      val_value_t *filchild,
+                      stream_frame_t *frame,
+                      val_value_t *curchild)
+{
+    status_t res = NO_ERR;
+
+    stream_frame_t childframe;
+    memset(&childframe, 0x0, sizeof(stream_frame_t));
+    childframe.parent = frame;
+    childframe.val = curchild;
+    childframe.useval = curchild;
+    childframe.indent = frame->childindent;
+    childframe.childindent = frame->childindent;
+    if (childframe.childindent >= 0) {
+        childframe.childindent += ses_indent_count(scb);
+    }
+
+    val_value_t *virtualval = NULL;
+    if (val_is_virtual(curchild)) {
+        virtualval = val_make_virtual_value(scb, curchild, &res);
+        if (virtualval == NULL) {
+            if (res == ERR_NCX_SKIPPED) {
+                res = NO_ERR;
+            }
+            return res;
+        }
+        childframe.useval = virtualval;
+    }
+
+    boolean mykeepempty = FALSE;
+    res = stream_val(scb, msg, getop, filchild, &childframe, &mykeepempty);
+    if (res == NO_ERR && mykeepempty) {
+        stream_node(scb, msg, frame, childframe.useval, getop);
+    } else {
+        stream_end_frame(scb, msg, &childframe);
+    }
+
+    if (virtualval) {
+        val_free_value(virtualval);
+    }
+
+    return res;
+
+} /* stream_container */
+
+
+/********************************************************************
+* FUNCTION push_down_filter
+*
+* Pass the content match and selection nodes from
+* a list filter node to a virtual list iterator
+*
+* INPUTS:
+*    filval == container filter node for the list
+*    iter == iterator control block to fill in
+*
+* OUTPUTS:
+*    iter->matchQ and iter->selectQ are filled in
+*
+* RETURNS:
+*     status, NO_ERR or malloc error
+*********************************************************************/
+static status_t
+    push_down_filter (val_value_t *filval,
+                      getcb_iter_t *iter)
+{
+    status_t res = NO_ERR;
+    boolean anysel = FALSE;
+
+    val_value_t *filchild = val_get_first_child(filval);
+    for (; filchild != NULL && res == NO_ERR;
+         filchild = val_get_next_child(filchild)) {
+
+        const xmlChar *modname = NULL;
+        if (filchild->nsid) {
+            modname = xmlns_get_module(filchild->nsid);
+        }
+
+        obj_template_t *chobj = 
+            obj_find_child(iter->listobj, modname, filchild->name);
+        if (chobj == NULL) {
+            continue;
+        }
+
+        if (filchild->btyp == NCX_BT_STRING) {
+            if (!obj_is_leaf(chobj) || obj_is_password(chobj)) {
+                continue;
+            }
+
+            /* a value that does not parse for the leaf is not 
+             * passed down; no entry can match it anyway
+             */
+            status_t valres = NO_ERR;
+            val_value_t *matchval = 
+                val_make_simval_obj(chobj, VAL_STR(filchild), &valres);
+            if (matchval) {
+                dlq_enque(matchval, &iter->matchQ);
+            }
+        } else {
+            anysel = TRUE;
+        }
+
+        ncx_backptr_t *backptr = ncx_new_backptr(chobj);
+        if (backptr == NULL) {
+            res = ERR_INTERNAL_MEM;
+        } else {
+            dlq_enque(backptr, &iter->selectQ);
+        }
+    }
+
+    /* only content match nodes means the entire entry is selected */
+    if (!anysel) {
+        ncx_clean_backptrQ(&iter->selectQ);
+    }
+
+    return res;
+
+} /* push_down_filter */
+
+
+/********************************************************************
+* FUNCTION stream_virtual_list
+*
+* Evaluate a filter node against all the entries of a 
+* virtual list and write the matching entries
+* The entries are requested in batches from the list iterator
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    getop  == TRUE if this is a <get> and not a <get-config>
+*    filchild == filter node matched to the list
+*    frame == frame for the parent of the list
+*    listval == virtual list place-holder node
+*
+* OUTPUTS:
+*    matching nodes are written to the session
+*
+* RETURNS:
+*     status, NO_ERR or malloc error
+*********************************************************************/
+static status_t
+    stream_virtual_list (ses_cb_t *scb,
+                         rpc_msg_t *msg,
+                         boolean getop,
+                         val_value_t *filchild,
+                         stream_frame_t *frame,
+                         val_value_t *listval)
+{
+    status_t res = NO_ERR;
+    getcb_iter_t iter;
+
+    /* content match test on a list is always false */
+    if (filchild->btyp == NCX_BT_STRING) {
+        return NO_ERR;
+    }
+
+    if (!agt_acm_val_read_allowed(&msg->mhdr, scb->username, listval)) {
+        return NO_ERR;
+    }
+
+    val_init_list_iter(&iter, listval, VAL_VIRTUAL_LIST_BATCH);
+
+    if (filchild->btyp == NCX_BT_CONTAINER) {
+        res = push_down_filter(filchild, &iter);
+    }
+
+    while (res == NO_ERR && !iter.done) {
+        res = val_get_list_batch(scb, &iter);
+
+        val_value_t *entry = (val_value_t *)dlq_firstEntry(&iter.entryQ);
+        for (; entry != NULL && res == NO_ERR;
+             entry = (val_value_t *)dlq_nextEntry(entry)) {
+
+            if (SES_KILLREQ_SET(scb)) {
+                res = ERR_NCX_SESSION_CLOSED;
+            } else if (filchild->btyp == NCX_BT_EMPTY) {
+                stream_node(scb, msg, frame, entry, getop);
+            } else {
+                res = stream_container(scb, msg, getop, filchild,
+                                       frame, entry);
+            }
+        }
+    }
+
+    val_clean_list_iter(&iter);
+
+    return res;
+
+} /* stream_virtual_list */
+
+
+/********************************************************************
+* FUNCTION stream_val
+*
+* Evaluate the subtree filter and write the matching nodes
+* to the session in the same pass.
+*
+* The filval is a NCX_BT_CONTAINER, and already matched 
+* to the frame->val node.  This function evaluates the child nodes
+* recursively as more container nodes are matched to the target
+* Same filter rules as process_val, except no access control
+* for notifications, since this is only used for <get*>
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    getop  == TRUE if this is a <get> and not a <get-config>
+*    filval == filter node
+*    frame == frame for the current database node
+*    keepempty == address of return keepempty flag
+*
+* OUTPUTS:
+*    matching nodes are written to the session
+*    *keepempty is set to TRUE if a select node is tested
+*      and the entire node needs to be written because all
+*      descendants are selected; nothing has been written
+*      for the node in this case
+*
+* RETURNS:
+*     status, NO_ERR or malloc error
+*********************************************************************/
+static status_t
+    stream_val (ses_cb_t *scb,
+                rpc_msg_t *msg,
+                boolean getop,
+                val_value_t *filval,
+                stream_frame_t *frame,
+                boolean *keepempty)
+{
+    *keepempty = FALSE;
+    status_t res = NO_ERR;
+
+    xmlns_id_t ncid = xmlns_nc_id();
+    xmlns_id_t wildid = xmlns_wildcard_id();
+    val_value_t *useval = frame->useval;
+
+    boolean anycon = FALSE;
+    boolean anysel = FALSE;
+    boolean test = FALSE;
+
+    /* check any content match nodes first
+     * they must all be true or this entire sibling
+     * set is rejected; nothing has been written yet
+     */
+    val_value_t *filchild = val_get_first_child(filval);
+    val_value_t *curchild = NULL;
+    for (; filchild != NULL; filchild = val_get_next_child(filchild)) {
+
+        /* same namespace hacks as process_val */
+        if (filchild->nsid == ncid) {
+            filchild->nsid = 0;
+        }
+
+        if (filchild->nsid == wildid) {
+            if (ses_get_protocol(scb) == NCX_PROTO_NETCONF11) {
+                filchild->nsid = 0;
+            } else {
+                return ERR_NCX_PROTO11_NOT_ENABLED;
+            }
+        }
+
+        switch (filchild->btyp) {
+        case NCX_BT_STRING:
+            break;
+        case NCX_BT_EMPTY:
+            anysel = TRUE;
+            continue;
+        case NCX_BT_CONTAINER:
+            anycon = TRUE;
+            continue;
+        default:
+            return SET_ERROR(ERR_INTERNAL_VAL);
+        }
+
+        if (val_all_whitespace(VAL_STR(filchild))) {
+            return SET_ERROR(ERR_INTERNAL_VAL);
+        }
+
+        test = FALSE;
+        for (curchild = val_first_child_qname(useval, filchild->nsid,
+                                              filchild->name);
+             curchild != NULL && !test;
+             curchild = val_next_child_qname(useval, filchild->nsid,
+                                             filchild->name, curchild)) {
+            test = content_match_test(scb, VAL_STR(filchild), curchild);
+        }
+
+        if (!test) {
+            log_debug2("\nagt_tree_stream_val: %s "
+                       "sibling set pruned; CM not found for '%s'", 
+                       filval->name, filchild->name);
+            return NO_ERR;
+        }
+    }
+
+    if (!anycon && !anysel) {
+        *keepempty = TRUE;
+        return NO_ERR;
+    }
+
+    /* Go through the filval child nodes again and this
+     * time write the selected nodes
+     */
+    for (filchild = val_get_first_child(filval);
+         filchild != NULL && res == NO_ERR;
+         filchild = val_get_next_child(filchild)) {
+
+        if (!getop && !agt_check_config(&msg->mhdr, ses_withdef(scb), 
+                                        TRUE, filchild)) {
+            continue;
+        }
+
+        /* skip duplicate selection nodes */
+        if (filchild->btyp == NCX_BT_EMPTY) {
+            val_value_t *testval = val_get_first_child(filval);
+            boolean skip = FALSE;
+            for (; !skip && testval && (testval != filchild); 
+                 testval = val_get_next_child(testval)) {
+
+                if (testval->btyp != NCX_BT_EMPTY ||
+                    xml_strcmp(testval->name, filchild->name)) {
+                    continue;
+                }
+
+                if (testval->nsid == 0) {
+                    filchild->nsid = 0;
+                    skip = TRUE;
+                } else if (filchild->nsid == 0) {
+                    skip = TRUE;
+                } else if (testval->nsid == filchild->nsid) {
+                    skip = TRUE;
+                }
+            }
+
+            if (skip) {
+                log_debug2("\nagt_tree: Skipping duplicate selection "
+                           "node '%s'", filchild->name);
+                continue;
+            }
+        }
+
+        for (curchild = val_first_child_qname(useval, filchild->nsid,
+                                              filchild->name);
+             curchild != NULL && res == NO_ERR;
+             curchild = val_next_child_qname(useval, filchild->nsid,
+                                             filchild->name, curchild)) {
+
+            /* stop walking the database if the session is going away */
+            if (SES_KILLREQ_SET(scb)) {
+                return ERR_NCX_SESSION_CLOSED;
+            }
+
+            if (!attr_test(filchild, curchild)) {
+                continue;
+            }
+
+            if (val_is_virtual_list(curchild)) {
+                res = stream_virtual_list(scb, msg, getop, filchild,
+                                          frame, curchild);
+                continue;
+            }
+
+            switch (filchild->btyp) {
+            case NCX_BT_STRING:
+                if (content_match_test(scb, VAL_STR(filchild), curchild)) {
+                    stream_node(scb, msg, frame, curchild, getop);
+                }
+                break;
+            case NCX_BT_EMPTY:
+                stream_node(scb, msg, frame, curchild, getop);
+                break;
+            case NCX_BT_CONTAINER:
+                if (!typ_has_children(curchild->btyp)) {
+                    break;
+                }
+
+                if (!agt_acm_val_read_allowed(&msg->mhdr, scb->username, 
+                                              curchild)) {
+                    break;
+                }
+
+                res = stream_container(scb, msg, getop, filchild,
+                                       frame, curchild);
+                break;
+            default:
+                res = SET_ERROR(ERR_INTERNAL_VAL);
+            }
+        }
+    }
+
+    return res;
+
+} /* stream_val */
+
+
 /************  E X T E R N A L    F U N C T I O N S    **************/
 
 
@@ -1008,6 +1602,87 @@ void
 } /* agt_tree_output_filter */
 
 
+/********************************************************************
+* FUNCTION agt_tree_stream_filter
+*
+* get and get-config steps 1 and 2 in one pass
+* Evaluate the subtree filter and write each matching node
+* to the specified session as soon as it is found.
+* No ncx_filptr_t tree is built and virtual containers are
+* not cached, so memory use does not grow with the result size.
+*
+* The session output buffers are sent as they fill up,
+* so the first bytes of a large reply are sent right away
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    cfg == config target to check against
+*    indent == start indent amount
+*    getop  == TRUE if this is a <get> and not a <get-config>
+*              The target is expected to be the <running> 
+*              config, and all state data will be available for the
+*              filter output.
+*              FALSE if this is a <get-config> and only the 
+*              specified target in available for filter output
+*
+* RETURNS:
+*    status; output is always well-formed even if an error
+*    is returned, but it may be incomplete
+*********************************************************************/
+status_t
+    agt_tree_stream_filter (ses_cb_t *scb,
+                            rpc_msg_t *msg,
+                            const cfg_template_t *cfg,
+                            int32 indent,
+                            boolean getop)
+{
+#ifdef DEBUG
+    if (!scb || !msg || !cfg || !msg->rpc_filter.op_filter) {
+        return SET_ERROR(ERR_INTERNAL_PTR);
+    }
+#endif
+
+    /* make sure the config has some data in it */
+    if (!cfg->root) {
+        return NO_ERR;
+    }
+
+    val_value_t *filter = msg->rpc_filter.op_filter;
+    status_t res = NO_ERR;
+
+    switch (filter->btyp) {
+    case NCX_BT_EMPTY:
+    case NCX_BT_STRING:
+        /* empty filter or mixed mode filter; the result is
+         * the empty set; see agt_tree_prune_filter
+         */
+        break;
+    case NCX_BT_CONTAINER:
+        {
+            /* the root is never written so it starts out as started */
+            stream_frame_t topframe;
+            memset(&topframe, 0x0, sizeof(stream_frame_t));
+            topframe.val = cfg->root;
+            topframe.useval = cfg->root;
+            topframe.indent = indent;
+            topframe.childindent = indent;
+            topframe.started = TRUE;
+
+            boolean keepempty = FALSE;
+            res = stream_val(scb, msg, getop, filter, &topframe, 
+                             &keepempty);
+        }
+        break;
+    default:
+        res = SET_ERROR(ERR_INTERNAL_VAL);
+    }
+
+    return res;
+
+} /* agt_tree_stream_filter */
+
+
 /********************************************************************
 * FUNCTION agt_tree_test_filter
 *
@@ -132,6 +132,42 @@ extern void
 			    boolean getop);
 
 
+/********************************************************************
+* FUNCTION agt_tree_stream_filter
+*
+* get and get-config steps 1 and 2 in one pass
+* Evaluate the subtree filter and write each matching node
+* to the specified session as soon as it is found.
+* No ncx_filptr_t tree is built and virtual containers are
+* not cached, so memory use does not grow with the result size.
+*
+* The session output buffers are sent as they fill up,
+* so the first bytes of a large reply are sent right away
+*
+* INPUTS:
+*    scb == session control block
+*    msg == rpc_msg_t in progress
+*    cfg == config target to check against
+*    indent == start indent amount
+*    getop  == TRUE if this is a <get> and not a <get-config>
+*              The target is expected to be the <running> 
+*              config, and all state data will be available for the
+*              filter output.
+*              FALSE if this is a <get-config> and only the 
+*              specified target in available for filter output
+*
+* RETURNS:
+*    status; output is always well-formed even if an error
+*    is returned, but it may be incomplete
+*********************************************************************/
+extern status_t
+    agt_tree_stream_filter (ses_cb_t *scb,
+                            rpc_msg_t *msg,
+                            const cfg_template_t *cfg,
+                            int32 indent,
+                            boolean getop);
+
+
 /********************************************************************
 * FUNCTION agt_tree_test_filter
 *
@@ -1567,13 +1567,8 @@ status_t
         break;
     case OP_FILTER_SUBTREE:
         if (source->root) {
-            ncx_filptr_t *top =
-                agt_tree_prune_filter(scb, msg, source, getop);
-            if (top) {
-                agt_tree_output_filter(scb, msg, top, indent, getop);
-                ncx_free_filptr(top);
-                break;
-            }
+            /* test the filter and write the result in one pass */
+            res = agt_tree_stream_filter(scb, msg, source, indent, getop);
         }
         break;
     case OP_FILTER_XPATH:
@@ -43,14 +43,18 @@ date         init     comment
 #include "agt_cfg.h"
 #include "agt_commit_complete.h"
 #include "agt_ncx.h"
+#include "agt_refidx.h"
+#include "agt_rpcstat.h"
 #include "agt_util.h"
 #include "agt_val.h"
 #include "agt_val_parse.h"
+#include "bobhash.h"
 #include "cap.h"
 #include "cfg.h"
 #include "dlq.h"
 #include "log.h"
 #include "ncx.h"
+#include "ncx_trace.h"
 #include "ncxconst.h"
 #include "obj.h"
 #include "op.h"
@@ -75,6 +79,9 @@ date         init     comment
 *                                                                   *
 *********************************************************************/
 
+/* initial value for the unique-stmt tuple hash */
+#define UNIQUE_HASH_INIT  0x7e3d9a51
+
 /* recursive callback function foward decls */
 static status_t
     invoke_btype_cb (agt_cbtyp_t cbtyp,
@@ -115,6 +122,8 @@ typedef struct unique_set_t_ {
     dlq_hdr_t  qhdr;
     dlq_hdr_t  uniqueQ;   /* Q of val_unique_t */
     val_value_t *valnode;  /* value tree back-ptr */
+    uint32     hash;      /* hash of the tuple values */
+    struct unique_set_t_ *next;  /* hash bucket chain */
 } unique_set_t;
 
 
@@ -709,8 +718,11 @@ static status_t
 
             editop = cvt_editop(editop, newnode, curnode);
 
+            NCX_TRACE_BEGIN(NCX_TRACE_SIL_CALLBACK, SES_MY_SID(scb),
+                            obj_get_name(val->obj));
             res = (*cbset->cbfn[cbtyp])(scb, msg, cbtyp, editop, 
                                         newnode, curnode);
+            NCX_TRACE_END(NCX_TRACE_SIL_CALLBACK, obj_get_name(val->obj));
             if (val->res == NO_ERR) {
                 val->res = res;
             }
@@ -809,6 +821,10 @@ static agt_cfg_undo_rec_t *
         newnode->parent = parentnode;
     }
 
+    if (curnode && editop != OP_EDITOP_LOAD) {
+        agt_refidx_edit_node(msg->rpc_txcb, curnode);
+    }
+
     undo->editop = cvt_editop_ex(editop, newnode, curnode);
     undo->newnode = newnode;
     undo->newnode_marker = newnode_marker;
@@ -3310,6 +3326,7 @@ static status_t
     cfg_update_last_ch_time(target, &txcb->timestamp);
     cfg_update_last_txid(target, txcb->txid);
     cfg_set_dirty_flag(target);
+    agt_refidx_commit_done(txcb);
 
     agt_profile_t *profile = agt_get_profile();
     profile->agt_config_state = AGT_CFG_STATE_OK;
@@ -3398,6 +3415,8 @@ static status_t
         }
     }
 
+    agt_refidx_rollback_done(txcb);
+
     return res;
 
 }  /* attempt_rollback */
@@ -3475,6 +3494,9 @@ static status_t
     }
 
     /* this is a config node so check the operation further */
+    NCX_TRACE_BEGIN(NCX_TRACE_EDIT_PHASE, (scb) ? SES_MY_SID(scb) : 0,
+                    agt_cbtype_name(cbtyp));
+
     switch (cbtyp) {
     case AGT_CB_VALIDATE:
     case AGT_CB_APPLY:
@@ -3510,6 +3532,7 @@ static status_t
         res = SET_ERROR(ERR_INTERNAL_VAL);
     }
 
+    NCX_TRACE_END(NCX_TRACE_EDIT_PHASE, agt_cbtype_name(cbtyp));
     return res;
 
 }  /* handle_callback */
@@ -3651,6 +3674,56 @@ static boolean
 } /* compare_unique_testsets */
 
 
+/********************************************************************
+* FUNCTION hash_unique_testset
+* 
+* Hash the values in a Q of val_unique_t structs
+* Test sets that compare equal get the same hash value,
+* so only the sets in the same hash chain need to be compared
+*
+* INPUTS:
+*   uniQ == Q of val_unique_t structs to hash
+*
+* RETURNS:
+*   hash value
+*********************************************************************/
+static uint32
+    hash_unique_testset (dlq_hdr_t *uniQ)
+{
+    uint32 hash = UNIQUE_HASH_INIT;
+
+    val_unique_t *unival = (val_unique_t *)dlq_firstEntry(uniQ);
+    for (; unival; unival = (val_unique_t *)dlq_nextEntry(unival)) {
+        /* a unique component is a leaf, so there is 1 node;
+         * any other node-set is left out of the hash and
+         * is still checked by compare_unique_testsets
+         */
+        xpath_resnode_t *resnode =
+            xpath_get_first_resnode(unival->pcb->result);
+        if (resnode == NULL || xpath_get_next_resnode(resnode) != NULL) {
+            continue;
+        }
+
+        val_value_t *val = xpath_get_resnode_valptr(resnode);
+        if (val == NULL || !typ_is_simple(val->btyp)) {
+            continue;
+        }
+
+        if (typ_is_string(val->btyp) && VAL_STR(val)) {
+            hash = bobhash(VAL_STR(val), xml_strlen(VAL_STR(val)), hash);
+        } else {
+            xmlChar *buff = val_make_sprintf_string(val);
+            if (buff) {
+                hash = bobhash(buff, xml_strlen(buff), hash);
+                m__free(buff);
+            }
+        }
+    }
+    return hash;
+
+}  /* hash_unique_testset */
+
+
 /********************************************************************
  * FUNCTION new_unique_set
  * Malloc and init a new unique test set
@@ -3881,39 +3954,67 @@ static status_t
         val_free_unique(unival);
     }
 
-    if (retres == NO_ERR) {
-        /* go through all the test sets and compare them to each other
-         * this is a brute force compare N to N+1 .. last moving N
-         * through the list until all entries have been compared to
-         * each other and all unique violations recorded;
-         * As compare is done, delete old set1 since no longer needed */
-        while (!dlq_empty(&usetQ)) {
-            unique_set_t *set1 = (unique_set_t *)dlq_deque(&usetQ);
-            if (set1 && set1->valnode->res != ERR_NCX_UNIQUE_TEST_FAILED) {
-                unique_set_t *set2 = (unique_set_t *)dlq_firstEntry(&usetQ);
-                for (; set2; set2 = (unique_set_t *)dlq_nextEntry(set2)) {
-                    if (set2->valnode->res == ERR_NCX_UNIQUE_TEST_FAILED) {
-                        // already compared this to rest of list instances
-                        // if it is flagged with a unique-test failed error
-                        continue;
-                    }
-                    if (compare_unique_testsets(&set1->uniqueQ, 
-                                                &set2->uniqueQ)) {
-                        /* 2 lists have the same values so generate an error */
-                        agt_record_unique_error(scb, msg, set1->valnode,
-                                                &set1->uniqueQ);
-                        set1->valnode->res = ERR_NCX_UNIQUE_TEST_FAILED;
-                        retres = ERR_NCX_UNIQUE_TEST_FAILED;
-                    }
+    /* put the test sets in a hash table so each set is only
+     * compared to the earlier sets with the same hash value,
+     * instead of to every other list instance      */
+    unique_set_t **buckets = NULL;
+    uint32 numbuckets = 1;
+    if (retres == NO_ERR && !dlq_empty(&usetQ)) {
+        uint32 count = dlq_count(&usetQ);
+        while (numbuckets < count) {
+            numbuckets <<= 1;
+        }
+        buckets = (unique_set_t **)
+            m__getMem(numbuckets * sizeof(unique_set_t *));
+        if (buckets == NULL) {
+            retres = ERR_INTERNAL_MEM;
+        } else {
+            memset(buckets, 0x0, numbuckets * sizeof(unique_set_t *));
+        }
+    }
+
+    if (retres == NO_ERR && buckets) {
+        /* add the sets to the chains in reverse so each chain
+         * is in list order; sets already flagged with a
+         * unique-test failed error are left out and have
+         * no later sets to compare     */
+        unique_set_t *uset = (unique_set_t *)dlq_lastEntry(&usetQ);
+        for (; uset; uset = (unique_set_t *)dlq_prevEntry(uset)) {
+            if (uset->valnode->res == ERR_NCX_UNIQUE_TEST_FAILED) {
+                continue;
+            }
+            uset->hash = hash_unique_testset(&uset->uniqueQ);
+            uset->next = buckets[uset->hash & (numbuckets - 1)];
+            buckets[uset->hash & (numbuckets - 1)] = uset;
+        }
+
+        /* compare each set to the later sets in its chain; an error
+         * is recorded for the earlier list instance once for every
+         * later instance with the same values, the same errors as
+         * comparing every pair of list instances     */
+        unique_set_t *set1 = (unique_set_t *)dlq_firstEntry(&usetQ);
+        for (; set1; set1 = (unique_set_t *)dlq_nextEntry(set1)) {
+            unique_set_t *set2 = set1->next;
+            for (; set2; set2 = set2->next) {
+                if (set1->hash == set2->hash &&
+                    compare_unique_testsets(&set1->uniqueQ, 
+                                            &set2->uniqueQ)) {
+                    /* 2 lists have the same values so generate an error */
+                    agt_record_unique_error(scb, msg, set1->valnode,
+                                            &set1->uniqueQ);
+                    set1->valnode->res = ERR_NCX_UNIQUE_TEST_FAILED;
+                    retres = ERR_NCX_UNIQUE_TEST_FAILED;
                 }
             }
-            free_unique_set(set1);
         }
     }
 
+    if (buckets) {
+        m__free(buckets);
+    }
+
     while (!dlq_empty(&usetQ)) {
         unique_set_t *uset = (unique_set_t *)dlq_deque(&usetQ);
-        uset = (unique_set_t *)dlq_deque(&usetQ);
         free_unique_set(uset);
     }
 
@@ -4022,35 +4123,41 @@ static status_t
          * instance that matched; this is always constrained
          * to 1 of the instances that exists at commit-time
          */
-        xpcb = typ_get_leafref_pcb(typdef);
-        if (!val->xpathpcb) {
-            val->xpathpcb = xpath_clone_pcb(xpcb);
+        /* try the running config leafref index first */
+        res = agt_refidx_check_leafref(val, root);
+        if (res == ERR_NCX_SKIPPED) {
+            res = NO_ERR;
+            xpcb = typ_get_leafref_pcb(typdef);
             if (!val->xpathpcb) {
-                res = ERR_INTERNAL_MEM;
+                val->xpathpcb = xpath_clone_pcb(xpcb);
+                if (!val->xpathpcb) {
+                    res = ERR_INTERNAL_MEM;
+                }
             }
-        }
-
-        if (res == NO_ERR) {
-            assert( scb && "scb is NULL!" );
-            result = xpath1_eval_xmlexpr(scb->reader, val->xpathpcb, 
-                                         val, root, FALSE, TRUE, &res);
-            if (result && res == NO_ERR) {
-                /* check result: the string value in 'val'
-                 * must match one of the values in the
-                 * result set
-                 */
-                fnresult = 
-                    xpath1_compare_result_to_string(val->xpathpcb, result, 
-                                                    VAL_STR(val), &res);
 
-                if (res == NO_ERR && !fnresult) {
-                    /* did not match any of the 
-                     * current instances  (13.5)
+            if (res == NO_ERR) {
+                assert( scb && "scb is NULL!" );
+                result = xpath1_eval_xmlexpr(scb->reader, val->xpathpcb, 
+                                             val, root, FALSE, TRUE, &res);
+                if (result && res == NO_ERR) {
+                    /* check result: the string value in 'val'
+                     * must match one of the values in the
+                     * result set
                      */
-                    res = ERR_NCX_MISSING_VAL_INST;
+                    fnresult = 
+                        xpath1_compare_result_to_string(val->xpathpcb,
+                                                        result, 
+                                                        VAL_STR(val), &res);
+
+                    if (res == NO_ERR && !fnresult) {
+                        /* did not match any of the 
+                         * current instances  (13.5)
+                         */
+                        res = ERR_NCX_MISSING_VAL_INST;
+                    }
                 }
+                xpath_free_result(result);
             }
-            xpath_free_result(result);
         }
 
         if (res != NO_ERR) {
@@ -5921,6 +6028,14 @@ status_t
 
     agt_profile_t *profile = agt_get_profile();
     status_t res = NO_ERR, retres = NO_ERR;
+    agt_rpcstat_phase_t lastphase = 
+        agt_rpcstat_enter(AGT_RPCSTAT_PH_COMMIT_CHECK);
+    NCX_TRACE_BEGIN(NCX_TRACE_ROOT_CHECK, (scb) ? SES_MY_SID(scb) : 0, NULL);
+
+    /* Q of ncx_backptr_t to objects that had the leafref tests run */
+    dlq_hdr_t checkedQ;
+    dlq_createSQue(&checkedQ);
+    boolean useidx = agt_refidx_start_check(txcb, root);
 
     /* the commit check is always run on the root because there
      * are operations such as <validate> and <copy-config> that
@@ -5966,6 +6081,18 @@ status_t
             continue;
         }
 
+        if (useidx && (tests & AGT_TEST_FL_XPATH_TYPE)) {
+            ncx_backptr_t *backptr = ncx_new_backptr(ct->obj);
+            if (backptr == NULL) {
+                res = ERR_INTERNAL_MEM;
+                agt_record_error(scb, msghdr, NCX_LAYER_OPERATION, res, NULL,
+                                 NCX_NT_NONE, NULL, NCX_NT_NONE, NULL);
+                CHK_EXIT(res, retres);
+                continue;
+            }
+            dlq_enque(backptr, &checkedQ);
+        }
+
         /* run all relevant tests on each node in the result set */
         xpath_resnode_t *resnode = xpath_get_first_resnode(ct->result);
         for (; resnode != NULL; resnode = xpath_get_next_resnode(resnode)) {
@@ -5990,8 +6117,47 @@ status_t
         }
     }
 
+    /* check the leafrefs that pointed at a target value that was
+     * deleted or changed in this transaction, if their commit
+     * test was pruned above   */
+    if (useidx && profile->agt_config_state == AGT_CFG_STATE_OK) {
+        dlq_hdr_t refQ;
+        dlq_createSQue(&refQ);
+
+        res = agt_refidx_get_impacted(&refQ);
+        if (res != NO_ERR) {
+            agt_record_error(scb, msghdr, NCX_LAYER_CONTENT, res, NULL,
+                             NCX_NT_NONE, NULL, NCX_NT_NONE, NULL);
+            CHK_EXIT(res, retres);
+        }
+
+        ncx_backptr_t *backptr = ncx_first_backptr(&refQ);
+        for (; backptr != NULL; backptr = ncx_next_backptr(backptr)) {
+            val_value_t *refval = (val_value_t *)
+                ncx_get_backptr_node(backptr);
+            if (ncx_find_backptr(&checkedQ, refval->obj)) {
+                continue;
+            }
+
+            res = instance_xpath_check(scb, msghdr, refval, root,
+                                       NCX_LAYER_CONTENT);
+            if (res != NO_ERR) {
+                profile->agt_load_rootcheck_errors = TRUE;
+                CHK_EXIT(res, retres);
+            }
+        }
+        ncx_clean_backptrQ(&refQ);
+    }
+
+    ncx_clean_backptrQ(&checkedQ);
+    if (useidx) {
+        agt_refidx_finish_check();
+    }
+
     log_debug3("\nagt_val_root_check: end");
 
+    NCX_TRACE_END(NCX_TRACE_ROOT_CHECK, NULL);
+    (void)agt_rpcstat_enter(lastphase);
     return retres;
 
 }  /* agt_val_root_check */
@@ -6115,6 +6281,8 @@ status_t
     assert( pducfg && "pducfg is NULL!" );
     assert( obj_is_root(pducfg->obj) && "pducfg root is NULL!" );
 
+    agt_rpcstat_phase_t lastphase = agt_rpcstat_enter(AGT_RPCSTAT_PH_APPLY);
+
     /* start with the config root, which is a val_value_t node */
     status_t res = handle_callback(AGT_CB_APPLY, editop, scb, msg, target, 
                                    pducfg, target->root, target->root);
@@ -6154,6 +6322,7 @@ status_t
         }
     }
 
+    (void)agt_rpcstat_enter(lastphase);
     return res;
 
 }  /* agt_val_apply_write */
@@ -6249,6 +6418,8 @@ status_t
     }
 #endif
 
+    agt_rpcstat_phase_t lastphase = agt_rpcstat_enter(AGT_RPCSTAT_PH_APPLY);
+
     /* check any top-level deletes */
     //res = apply_commit_deletes(scb, msg, target, source->root, target->root);
     if (res == NO_ERR) {
@@ -6295,6 +6466,7 @@ status_t
         }
     }
 
+    (void)agt_rpcstat_enter(lastphase);
     return res;
 
 }  /* agt_val_apply_commit */
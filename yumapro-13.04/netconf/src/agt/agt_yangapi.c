@@ -114,6 +114,7 @@ date         init     comment
 #include "agt_acm.h"
 #include "agt_cap.h"
 #include "agt_cfg.h"
+#include "agt_gcommit.h"
 #include "agt_ncx.h"
 #include "agt_rpc.h"
 #include "agt_rpcerr.h"
@@ -3139,6 +3140,9 @@ void
      * transport was HTTP/S; only supported transports for YANG-API  */
     scb->transport = SES_TRANSPORT_HTTP;
 
+    /* held <edit-config> requests are committed before this request */
+    agt_gcommit_flush();
+
     /* the current node is 'rpc' in the netconf namespace
      * First get a new RPC message struct              */
     rpc_msg_t *msg = rpc_new_msg();
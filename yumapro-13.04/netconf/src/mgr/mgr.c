@@ -44,6 +44,10 @@ date         init     comment
 #include "log.h"
 #endif
 
+#ifndef _H_ncx
+#include "ncx.h"
+#endif
+
 #ifndef _H_ncxmod
 #include "ncxmod.h"
 #endif
@@ -100,6 +104,10 @@ date         init     comment
 #include  "var.h"
 #endif
 
+#ifndef _H_xml_util
+#include  "xml_util.h"
+#endif
+
 
 /********************************************************************
 *                                                                   *
@@ -120,6 +128,101 @@ static boolean mgr_init_done = FALSE;
 
 static boolean mgr_shutdown;
 
+/* Q of mgr_modset_t, most recently used first */
+static dlq_hdr_t modsetQ;
+
+
+/********************************************************************
+* FUNCTION free_modset
+* 
+* Free a shared module set
+* 
+* INPUTS:
+*   modset == module set to free; must be removed from modsetQ
+*********************************************************************/
+static void
+    free_modset (mgr_modset_t *modset)
+{
+    /* do not leave the module search pointing at a freed Q */
+    if (ncx_get_temp_modQ() == &modset->modQ) {
+        ncx_clear_temp_modQ();
+    }
+    if (ncx_get_session_modQ() == &modset->modQ) {
+        ncx_clear_session_modQ();
+    }
+
+    while (!dlq_empty(&modset->modQ)) {
+        ncx_module_t *mod = (ncx_module_t *)dlq_deque(&modset->modQ);
+        ncx_free_module(mod);
+    }
+    m__free(modset->key);
+    m__free(modset);
+
+}  /* free_modset */
+
+
+/********************************************************************
+* FUNCTION enque_modset_first
+* 
+* Put a module set at the front of the MRU list
+* 
+* INPUTS:
+*   modset == module set to add; must not be in modsetQ
+*********************************************************************/
+static void
+    enque_modset_first (mgr_modset_t *modset)
+{
+    mgr_modset_t *first = (mgr_modset_t *)dlq_firstEntry(&modsetQ);
+    if (first) {
+        dlq_insertAhead(modset, first);
+    } else {
+        dlq_enque(modset, &modsetQ);
+    }
+
+}  /* enque_modset_first */
+
+
+/********************************************************************
+* FUNCTION release_modset
+* 
+* Stop using the shared module set for a session
+* Sets with no sessions are kept for the next session to
+* a server with the same capabilities, up to
+* MGR_MAX_IDLE_MODSETS sets
+* 
+* INPUTS:
+*   mscb == manager session control block to use
+*********************************************************************/
+static void
+    release_modset (mgr_scb_t *mscb)
+{
+    mgr_modset_t *modset = mscb->modset;
+    mscb->modset = NULL;
+
+    if (modset->refcount) {
+        modset->refcount--;
+    }
+    if (modset->refcount) {
+        return;
+    }
+
+    /* the Q is in MRU order so free the oldest idle sets */
+    uint32 idlecount = 0;
+    mgr_modset_t *testset = (mgr_modset_t *)dlq_firstEntry(&modsetQ);
+    while (testset) {
+        mgr_modset_t *nextset = (mgr_modset_t *)dlq_nextEntry(testset);
+        if (testset->refcount == 0 && ++idlecount > MGR_MAX_IDLE_MODSETS) {
+            if (LOGDEBUG2) {
+                log_debug2("\nmgr: free idle module set");
+            }
+            dlq_remove(testset);
+            free_modset(testset);
+        }
+        testset = nextset;
+    }
+
+}  /* release_modset */
+
 
 /**************    E X T E R N A L   F U N C T I O N S **********/
 
@@ -147,6 +250,7 @@ status_t
 #endif
 
     mgr_shutdown = FALSE;
+    dlq_createSQue(&modsetQ);
 
     res = mgr_cap_set_caps();
     if (res != NO_ERR) {
@@ -198,6 +302,9 @@ void
         mgr_rpc_cleanup();
         mgr_not_cleanup();
         mgr_ses_cleanup();
+        while (!dlq_empty(&modsetQ)) {
+            free_modset((mgr_modset_t *)dlq_deque(&modsetQ));
+        }
         mgr_hello_cleanup();
         mgr_signal_cleanup();
         mgr_shutdown = FALSE;
@@ -347,6 +454,10 @@ void
         mscb->session = NULL;
     }
 
+    if (mscb->modset) {
+        release_modset(mscb);
+    }
+
     while (!dlq_empty(&mscb->temp_modQ)) {
         mod = (ncx_module_t *)dlq_deque(&mscb->temp_modQ);
         ncx_free_module(mod);
@@ -354,9 +465,166 @@ void
 
     mgr_rpc_clean_requestQ(&mscb->reqQ);
 
+    if (mscb->req_hash) {
+        m__free(mscb->req_hash);
+        mscb->req_hash = NULL;
+    }
+    mscb->req_hash_size = 0;
+    mscb->req_count = 0;
+
+    if (mscb->req_heap) {
+        m__free(mscb->req_heap);
+        mscb->req_heap = NULL;
+    }
+    mscb->req_heap_size = 0;
+    mscb->req_heap_count = 0;
+
 }  /* mgr_clean_scb */
 
 
+/********************************************************************
+* FUNCTION mgr_get_modQ
+* 
+* Get the Q of modules compiled for a manager session
+* This is the shared module set if the session is using one,
+* or else the session temp_modQ
+* 
+* INPUTS:
+*   mscb == manager session control block to use
+*
+* RETURNS:
+*   pointer to the Q of ncx_module_t for the session
+*********************************************************************/
+dlq_hdr_t *
+    mgr_get_modQ (mgr_scb_t *mscb)
+{
+    return (mscb->modset) ? &mscb->modset->modQ : &mscb->temp_modQ;
+
+}  /* mgr_get_modQ */
+
+
+/********************************************************************
+* FUNCTION mgr_attach_modset
+* 
+* Use the shared module set for the capability key, if any
+* The session temp_modQ must be empty
+* 
+* INPUTS:
+*   mscb == manager session control block to use
+*   key == capability key for the session
+*
+* RETURNS:
+*   TRUE if the session is now using a shared module set
+*   FALSE if there is no module set for this key
+*********************************************************************/
+boolean
+    mgr_attach_modset (mgr_scb_t *mscb,
+                       const xmlChar *key)
+{
+#ifdef DEBUG
+    if (!mscb || !key) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return FALSE;
+    }
+#endif
+
+    if (mscb->modset || !dlq_empty(&mscb->temp_modQ)) {
+        return FALSE;
+    }
+
+    mgr_modset_t *modset = (mgr_modset_t *)dlq_firstEntry(&modsetQ);
+    for (; modset != NULL; 
+         modset = (mgr_modset_t *)dlq_nextEntry(modset)) {
+        if (!xml_strcmp(modset->key, key)) {
+            break;
+        }
+    }
+    if (modset == NULL) {
+        return FALSE;
+    }
+
+    /* move to the front of the MRU list */
+    dlq_remove(modset);
+    enque_modset_first(modset);
+
+    modset->refcount++;
+    mscb->modset = modset;
+    return TRUE;
+
+}  /* mgr_attach_modset */
+
+
+/********************************************************************
+* FUNCTION mgr_share_modQ
+* 
+* Move the modules in the session temp_modQ to a new shared
+* module set for the capability key, so other sessions
+* to servers with the same capabilities can use them
+* Nothing is done if a set for the key already exists
+* 
+* INPUTS:
+*   mscb == manager session control block to use
+*   key == capability key for the session
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    mgr_share_modQ (mgr_scb_t *mscb,
+                    const xmlChar *key)
+{
+#ifdef DEBUG
+    if (!mscb || !key) {
+        return SET_ERROR(ERR_INTERNAL_PTR);
+    }
+#endif
+
+    if (mscb->modset || dlq_empty(&mscb->temp_modQ)) {
+        return NO_ERR;
+    }
+
+    /* another session may have compiled the same set meanwhile */
+    mgr_modset_t *modset = (mgr_modset_t *)dlq_firstEntry(&modsetQ);
+    for (; modset != NULL; 
+         modset = (mgr_modset_t *)dlq_nextEntry(modset)) {
+        if (!xml_strcmp(modset->key, key)) {
+            return NO_ERR;
+        }
+    }
+
+    modset = m__getObj(mgr_modset_t);
+    if (modset == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    memset(modset, 0x0, sizeof(mgr_modset_t));
+    dlq_createSQue(&modset->modQ);
+
+    modset->key = xml_strdup(key);
+    if (modset->key == NULL) {
+        m__free(modset);
+        return ERR_INTERNAL_MEM;
+    }
+
+    /* keep the module search pointing at the same modules */
+    boolean istemp = (ncx_get_temp_modQ() == &mscb->temp_modQ);
+    boolean issession = (ncx_get_session_modQ() == &mscb->temp_modQ);
+
+    dlq_block_enque(&mscb->temp_modQ, &modset->modQ);
+    modset->refcount = 1;
+    mscb->modset = modset;
+    enque_modset_first(modset);
+
+    if (istemp) {
+        ncx_set_temp_modQ(&modset->modQ);
+    }
+    if (issession) {
+        ncx_set_session_modQ(&modset->modQ);
+    }
+    return NO_ERR;
+
+}  /* mgr_share_modQ */
+
+
 /********************************************************************
 * FUNCTION mgr_request_shutdown
 * 
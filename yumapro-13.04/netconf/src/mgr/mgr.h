@@ -72,6 +72,9 @@ extern "C" {
 
 #define MGR_MAX_REQUEST_ID 0xfffffffe
 
+/* max number of shared module sets kept with no sessions */
+#define MGR_MAX_IDLE_MODSETS  2
+
 /********************************************************************
 *								    *
 *			     T Y P E S				    *
@@ -79,6 +82,17 @@ extern "C" {
 *********************************************************************/
 
 
+/* compiled module set shared by the sessions to servers
+ * that advertise the same capabilities
+ */
+typedef struct mgr_modset_t_ {
+    dlq_hdr_t       qhdr;
+    xmlChar        *key;        /* capability key, malloced */
+    dlq_hdr_t       modQ;       /* Q of ncx_module_t */
+    uint32          refcount;   /* sessions using this set */
+} mgr_modset_t;
+
+
 /* extension to the ses_cb_t for a manager session */
 typedef struct mgr_scb_t_ {
 
@@ -95,6 +109,9 @@ typedef struct mgr_scb_t_ {
     dlq_hdr_t             temp_modQ;   /* Q of ncx_module_t */
     ncx_list_t            temp_ync_features;  
 
+    /* shared module set used instead of temp_modQ, or NULL */
+    mgr_modset_t         *modset;
+
     /* running config cached info */
     val_value_t    *root;
     xmlChar        *chtime;
@@ -109,7 +126,17 @@ typedef struct mgr_scb_t_ {
 
     /* RPC request info */
     uint32           next_id;
-    dlq_hdr_t        reqQ;
+    dlq_hdr_t        reqQ;      /* Q of mgr_rpc_req_t in send order */
+
+    /* index of reqQ: ring of hash chains by message-id number,
+     * and a min-heap of the requests that have a timeout
+     */
+    struct mgr_rpc_req_t_ **req_hash;   /* malloced */
+    uint32           req_hash_size;     /* power of 2 */
+    uint32           req_count;
+    struct mgr_rpc_req_t_ **req_heap;   /* malloced */
+    uint32           req_heap_size;
+    uint32           req_heap_count;
 
     /* XPath variable binding callback function */
     xpath_getvar_fn_t   getvar_fn;
@@ -197,6 +224,62 @@ extern void
     mgr_clean_scb (mgr_scb_t *mscb);
 
 
+/********************************************************************
+* FUNCTION mgr_get_modQ
+* 
+* Get the Q of modules compiled for a manager session
+* This is the shared module set if the session is using one,
+* or else the session temp_modQ
+* 
+* INPUTS:
+*   mscb == manager session control block to use
+*
+* RETURNS:
+*   pointer to the Q of ncx_module_t for the session
+*********************************************************************/
+extern dlq_hdr_t *
+    mgr_get_modQ (mgr_scb_t *mscb);
+
+
+/********************************************************************
+* FUNCTION mgr_attach_modset
+* 
+* Use the shared module set for the capability key, if any
+* The session temp_modQ must be empty
+* 
+* INPUTS:
+*   mscb == manager session control block to use
+*   key == capability key for the session
+*
+* RETURNS:
+*   TRUE if the session is now using a shared module set
+*   FALSE if there is no module set for this key
+*********************************************************************/
+extern boolean
+    mgr_attach_modset (mgr_scb_t *mscb,
+                       const xmlChar *key);
+
+
+/********************************************************************
+* FUNCTION mgr_share_modQ
+* 
+* Move the modules in the session temp_modQ to a new shared
+* module set for the capability key, so other sessions
+* to servers with the same capabilities can use them
+* Nothing is done if a set for the key already exists
+* 
+* INPUTS:
+*   mscb == manager session control block to use
+*   key == capability key for the session
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    mgr_share_modQ (mgr_scb_t *mscb,
+                    const xmlChar *key);
+
+
 /********************************************************************
 * FUNCTION mgr_request_shutdown
 * 
@@ -25,6 +25,14 @@
      Step 2 or 3 can occur N times, and be changed while
      mgr_io_run is active (i.e., via stdin_handler)
 
+     The session sockets are kept in an epoll set, so each pass
+     only services the sockets with input pending.  The loop
+     blocks in epoll_wait after each call to the STDIN handler,
+     until a server sends something or MGR_IO_MAX_WAIT_MSEC
+     has passed, so the request timeouts checked by the handler
+     still run.  A handler with a deadline sooner than that, or
+     more work to do right away, calls mgr_io_set_wakeup.
+
 *********************************************************************
 *                                                                   *
 *                  C H A N G E   H I S T O R Y                      *
@@ -47,6 +55,7 @@ date         init     comment
 #include <string.h>
 #include <dirent.h>
 #include <errno.h>
+#include <sys/epoll.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -78,6 +87,14 @@ date         init     comment
 //#define MGR_IO_DEBUG 1
 #endif
 
+/* max events returned by one epoll_wait call */
+#define MGR_IO_MAX_EVENTS      64
+
+/* max milliseconds to block while waiting for a server;
+ * request timeouts are checked with 1 second granularity
+ */
+#define MGR_IO_MAX_WAIT_MSEC   1000
+
 /********************************************************************
  *                                                                  *
  *                       V A R I A B L E S                          *
@@ -87,38 +104,41 @@ date         init     comment
 static mgr_io_stdin_fn_t  stdin_handler;
 static mgr_ses_closed_fn_t session_closed_handler;
 
-static fd_set active_fd_set, read_fd_set, write_fd_set;
+/* epoll set for all the active session sockets */
+static int epoll_fd = -1;
 
-static int maxwrnum;
-static int maxrdnum;
+/* number of sockets in the epoll set */
+static uint32 active_count;
+
+/* max milliseconds for the next epoll_wait; -1 if not set */
+static int wakeup_msec = -1;
 
 
 /********************************************************************
- * FUNCTION any_fd_set
+ * FUNCTION wait_events
  * 
- * Check if any bits are set in the fd_set
+ * Wait for input on the active session sockets
+ *
  * INPUTS:
- *   fs == fs_set to check
- *   maxfd == max FD number possibly in use
+ *   events == array of MGR_IO_MAX_EVENTS to fill in
+ *   timeout == milliseconds to block; 0 to poll
  *
  * RETURNS:
- *   TRUE if any bits set
- *   FALSE if no bits set
+ *   number of events filled in
+ *   0 if timeout or interrupted
+ *   -1 if a non-recoverable error occurred (errno is set)
  *********************************************************************/
-static boolean
-    any_fd_set (fd_set *fd,
-                int maxfd)
+static int
+    wait_events (struct epoll_event *events,
+                 int timeout)
 {
-    int  i;
-
-    for (i=0; i<=maxfd; i++) {
-        if (FD_ISSET(i, fd)) {
-            return TRUE;
-        }
+    int ret = epoll_wait(epoll_fd, events, MGR_IO_MAX_EVENTS, timeout);
+    if (ret < 0 && (errno == EINTR || errno == EAGAIN)) {
+        ret = 0;
     }
-    return FALSE;
+    return ret;
 
-} /* any_fd_set */
+} /* wait_events */
 
 
 /********************************************************************
@@ -223,10 +243,6 @@ static boolean
                     (*session_closed_handler)(sid);
                 }
 
-                FD_CLR(fd, &active_fd_set);
-                if (fd >= maxrdnum) {
-                    maxrdnum = fd-1;
-                }
             }
         }
     } else {
@@ -252,11 +268,15 @@ void
     mgr_io_init (void)
 {
     stdin_handler = NULL;
-    FD_ZERO(&write_fd_set);
-    FD_ZERO(&read_fd_set);
-    FD_ZERO(&active_fd_set);
-    maxwrnum = 0;
-    maxrdnum = 0;
+    active_count = 0;
+
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+    }
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        log_error("\nmgr_io epoll_create1 failed (%s)", strerror(errno));
+    }
 
 } /* mgr_io_init */
 
@@ -292,6 +312,29 @@ void
 
  } /* mgr_session_closed_handler */
 
+
+/********************************************************************
+ * FUNCTION mgr_io_set_wakeup
+ *
+ * Limit the time the next wait for server input can block,
+ * so the STDIN handler is called again by then even if
+ * no server sends anything
+ *
+ * INPUTS:
+ *   msec == max milliseconds to wait; 0 if the handler has
+ *           more work to do right away
+ *********************************************************************/
+void
+    mgr_io_set_wakeup (uint32 msec)
+{
+    int limit = (msec < MGR_IO_MAX_WAIT_MSEC) ? 
+        (int)msec : MGR_IO_MAX_WAIT_MSEC;
+    if (wakeup_msec < 0 || limit < wakeup_msec) {
+        wakeup_msec = limit;
+    }
+
+} /* mgr_io_set_wakeup */
+
 /********************************************************************
  * FUNCTION mgr_io_activate_session
  * 
@@ -303,16 +346,16 @@ void
 void
     mgr_io_activate_session (int fd)
 {
-    FD_SET(fd, &active_fd_set);
+    struct epoll_event ev;
 
-    /*
-    if (fd+1 > maxwrnum) {
-        maxwrnum = fd+1;
-    }
-    */
+    memset(&ev, 0x0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
 
-    if (fd+1 > maxrdnum) {
-        maxrdnum = fd+1;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+        active_count++;
+    } else if (errno != EEXIST) {
+        log_error("\nmgr_io add FD %d failed (%s)", fd, strerror(errno));
     }
 
 } /* mgr_io_activate_session */
@@ -329,16 +372,16 @@ void
 void
     mgr_io_deactivate_session (int fd)
 {
-    FD_CLR(fd, &active_fd_set);
+    struct epoll_event ev;
 
-    /*
-    if (fd+1 == maxwrnum) {
-        maxwrnum--;
-    }
-    */
-
-    if (fd+1 == maxrdnum) {
-        maxrdnum--;
+    /* the event arg is ignored but must be non-NULL
+     * for kernels before 2.6.9
+     */
+    memset(&ev, 0x0, sizeof(ev));
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev) == 0) {
+        if (active_count) {
+            active_count--;
+        }
     }
 
 } /* mgr_io_deactivate_session */
@@ -367,6 +410,7 @@ status_t
             continue;
         }
 
+        struct epoll_event events[MGR_IO_MAX_EVENTS];
         int ret = 0;
         boolean done2 = FALSE;
         while (!done2) {
@@ -392,53 +436,46 @@ status_t
 
             write_sessions();
 
-            /* setup select parameters */
-            struct timeval timeout;
-            read_fd_set = active_fd_set;
-            timeout.tv_sec = 0;
-            timeout.tv_usec = 100;
-
             /* check if there are no sessions active to wait for,
              * so just go back to the STDIN handler
              */
-            if (!any_fd_set(&read_fd_set, maxrdnum)) {
+            if (active_count == 0) {
                 continue;
             }
 
+            /* nothing to do until a server sends something, or
+             * the handler asked to be called again by some time
+             */
+            int timeout = MGR_IO_MAX_WAIT_MSEC;
+            if (wakeup_msec >= 0) {
+                timeout = wakeup_msec;
+            }
+            wakeup_msec = -1;
+
 #ifdef MGR_IO_DEBUG
             if (LOGDEBUG4) {
-                log_debug4("\nmgr_io: enter select (%u:%u)",
-                           (unsigned int)timeout.tv_sec,
-                           (unsigned int)timeout.tv_usec);
+                log_debug4("\nmgr_io: enter epoll_wait (%d msec)", timeout);
             }
 #endif
 
-            /* Block until input arrives on one or more active sockets. 
-             * or the timer expires
+            /* Block until input arrives on one or more active sockets
+             * or the timer expires; only poll if the STDIN handler
+             * set a wakeup of 0 because it has more work to do
              */
-            ret = select(maxrdnum+1, &read_fd_set, &write_fd_set, 
-                             NULL, &timeout);
+            ret = wait_events(events, timeout);
 
 #ifdef MGR_IO_DEBUG
             if (LOGDEBUG4) {
-                log_debug4("\nmgr_io: exit select (%u:%u)",
-                           (unsigned int)timeout.tv_sec,
-                           (unsigned int)timeout.tv_usec);
+                log_debug4("\nmgr_io: exit epoll_wait (%d)", ret);
             }
 #endif
 
-            if (ret > 0) {
-                /* normal return with some bytes */
+            if (ret != 0) {
+                /* normal return with some events or fatal error */
+                done2 = TRUE;
+            } else if (mgr_shutdown_requested()) {
+                /* timeout or interrupted */
                 done2 = TRUE;
-            } else if (ret < 0) {
-                if (!(errno == EINTR || errno==EAGAIN)) {
-                    done2 = TRUE;
-                }  /* else go again in the inner loop */
-            } else {
-                /* should only happen if a timeout occurred */
-                if (mgr_shutdown_requested()) {
-                    done2 = TRUE; 
-                }
             }
         }  /* end inner loop */
 
@@ -448,41 +485,24 @@ status_t
             continue;
         }
 
-        /* check select return status for non-recoverable error */
+        /* check epoll_wait return status for non-recoverable error */
         if (ret < 0) {
-            log_error("\nmgr_io select failed (%s)", strerror(errno));
+            log_error("\nmgr_io epoll_wait failed (%s)", strerror(errno));
             mgr_request_shutdown();
             done = TRUE;
             continue;
         }
      
-        /* 2nd loop: go through the file descriptor numbers and
-         * service all the sockets with input pending 
-         */
+        /* 2nd loop: service only the sockets with input pending */
         int i;
-
+        for (i = 0; i < ret; i++) {
 #ifdef MGR_IO_DEBUG
-        if (LOGDEBUG3) {
-            int maxfd = FD_SETSIZE;
-            for (i = 0; i <= maxfd; i++) {
-                if (FD_ISSET(i, &active_fd_set)) {
-                    log_debug3("\nmgr_io: detect active FD %d", i);
-                }
-            }
-            for (i = 0; i <= maxfd; i++) {
-                if (FD_ISSET(i, &read_fd_set)) {
-                    log_debug3("\nmgr_io: read detected for FD %d", i);
-                }
-            }
-            log_debug3("\nmgr_io: maxrdnum = %d", maxrdnum);
-        }
-#endif // MGR_IO_DEBUG
-
-        for (i = 0; i <= maxrdnum; i++) {
-            /* check read input from agent */
-            if (FD_ISSET(i, &read_fd_set)) {
-                (void)read_session(i, 0);
+            if (LOGDEBUG3) {
+                log_debug3("\nmgr_io: read detected for FD %d",
+                           events[i].data.fd);
             }
+#endif
+            (void)read_session(events[i].data.fd, 0);
         }
 
         /* drain the ready queue before accepting new input */
@@ -549,47 +569,31 @@ boolean
 
     write_sessions();
 
-    /* setup select parameters */
     boolean anyread = FALSE;
+    boolean retval = TRUE;
 
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 100;
-    read_fd_set = active_fd_set;
-
-    if (!any_fd_set(&read_fd_set, maxrdnum)) {
+    if (active_count == 0) {
         return TRUE;
     }
 
-    /* Block until input arrives on one or more active sockets. 
-     * or the short timer expires
+    /* the caller is already blocking for KBD input
+     * so just poll the active sockets
      */
-    int ret = select(maxrdnum+1, &read_fd_set, &write_fd_set, 
-                     NULL, &timeout);
+    struct epoll_event events[MGR_IO_MAX_EVENTS];
+    int ret = wait_events(events, 0);
     if (ret > 0) {
-        /* normal return with some bytes */
+        /* normal return with some events */
         anyread = TRUE;
-    } else if (ret < 0) {
-        /* some error, don't care about EAGAIN here */
-        return TRUE;
     } else {
-        /* == 0: timeout */
+        /* timeout or some error */
         return TRUE;
     }
 
-    boolean retval = TRUE;
-
-    /* loop: go through the file descriptor numbers and
-     * service all the sockets with input pending 
-     */
-    if (anyread) {
-        int i;
-        for (i = 0; i <= maxrdnum; i++) {
-            
-            /* check read input from agent */
-            if (FD_ISSET(i, &read_fd_set)) {
-                retval = read_session(i, cursid);
-            }
+    /* loop: service only the sockets with input pending */
+    int i;
+    for (i = 0; i < ret; i++) {
+        if (!read_session(events[i].data.fd, cursid)) {
+            retval = FALSE;
         }
     }
 
@@ -148,6 +148,21 @@ extern void
     mgr_set_ses_closed_handler (mgr_ses_closed_fn_t handler);
 
 
+/********************************************************************
+ * FUNCTION mgr_io_set_wakeup
+ *
+ * Limit the time the next wait for server input can block,
+ * so the STDIN handler is called again by then even if
+ * no server sends anything
+ *
+ * INPUTS:
+ *   msec == max milliseconds to wait; 0 if the handler has
+ *           more work to do right away
+ *********************************************************************/
+extern void
+    mgr_io_set_wakeup (uint32 msec);
+
+
 
 /********************************************************************
  * FUNCTION mgr_io_activate_session
@@ -71,6 +71,11 @@ date         init     comment
 #define MGR_RPC_DEBUG 1
 #endif
 
+/* initial number of slots in the request hash ring and
+ * deadline heap; both are doubled as needed
+ */
+#define MGR_RPC_INDEX_SIZE  64
+
 
 /********************************************************************
 *                                                                   *
@@ -119,10 +124,310 @@ static mgr_rpc_rpy_t *
 } /* new_reply */
 
 
+/********************************************************************
+* FUNCTION hash_slot
+*
+* Get the request hash ring slot for a message-id number
+* The message IDs are allocated in sequence, so the slots
+* are used in order like a ring buffer and the chains stay
+* short while fewer than req_hash_size requests are pending
+*
+* INPUTS:
+*   mscb == manager session control block
+*   msg_num == message-id number
+*
+* RETURNS:
+*   pointer to the head of the chain for msg_num
+*********************************************************************/
+static mgr_rpc_req_t **
+    hash_slot (mgr_scb_t *mscb,
+               uint32 msg_num)
+{
+    return &mscb->req_hash[msg_num & (mscb->req_hash_size - 1)];
+
+}  /* hash_slot */
+
+
+/********************************************************************
+* FUNCTION hash_add
+*
+* Add a request to the end of its hash chain
+* so the oldest duplicate message-id is found first
+*
+* INPUTS:
+*   mscb == manager session control block
+*   req == request to add
+*********************************************************************/
+static void
+    hash_add (mgr_scb_t *mscb,
+              mgr_rpc_req_t *req)
+{
+    mgr_rpc_req_t **link = hash_slot(mscb, req->msg_num);
+    while (*link) {
+        link = &(*link)->hash_next;
+    }
+    req->hash_next = NULL;
+    *link = req;
+
+}  /* hash_add */
+
+
+/********************************************************************
+* FUNCTION hash_remove
+*
+* Remove a request from its hash chain
+*
+* INPUTS:
+*   mscb == manager session control block
+*   req == request to remove
+*********************************************************************/
+static void
+    hash_remove (mgr_scb_t *mscb,
+                 mgr_rpc_req_t *req)
+{
+    mgr_rpc_req_t **link = hash_slot(mscb, req->msg_num);
+    while (*link && *link != req) {
+        link = &(*link)->hash_next;
+    }
+    if (*link) {
+        *link = req->hash_next;
+    } else {
+        SET_ERROR(ERR_INTERNAL_VAL);
+    }
+    req->hash_next = NULL;
+
+}  /* hash_remove */
+
+
+/********************************************************************
+* FUNCTION heap_set
+*
+* Put a request in a deadline heap slot
+*
+* INPUTS:
+*   mscb == manager session control block
+*   slot == heap slot to use
+*   req == request to put in the slot
+*********************************************************************/
+static void
+    heap_set (mgr_scb_t *mscb,
+              uint32 slot,
+              mgr_rpc_req_t *req)
+{
+    mscb->req_heap[slot] = req;
+    req->heap_index = slot + 1;
+
+}  /* heap_set */
+
+
+/********************************************************************
+* FUNCTION heap_sift_up
+*
+* Move a request toward the root of the deadline heap
+*
+* INPUTS:
+*   mscb == manager session control block
+*   slot == heap slot of the request to move
+*********************************************************************/
+static void
+    heap_sift_up (mgr_scb_t *mscb,
+                  uint32 slot)
+{
+    mgr_rpc_req_t *req = mscb->req_heap[slot];
+
+    while (slot > 0) {
+        uint32 parent = (slot - 1) / 2;
+        if (mscb->req_heap[parent]->deadline <= req->deadline) {
+            break;
+        }
+        heap_set(mscb, slot, mscb->req_heap[parent]);
+        slot = parent;
+    }
+    heap_set(mscb, slot, req);
+
+}  /* heap_sift_up */
+
+
+/********************************************************************
+* FUNCTION heap_sift_down
+*
+* Move a request away from the root of the deadline heap
+*
+* INPUTS:
+*   mscb == manager session control block
+*   slot == heap slot of the request to move
+*********************************************************************/
+static void
+    heap_sift_down (mgr_scb_t *mscb,
+                    uint32 slot)
+{
+    mgr_rpc_req_t *req = mscb->req_heap[slot];
+    uint32 count = mscb->req_heap_count;
+
+    for (;;) {
+        uint32 child = slot * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count &&
+            mscb->req_heap[child + 1]->deadline <
+            mscb->req_heap[child]->deadline) {
+            child++;
+        }
+        if (req->deadline <= mscb->req_heap[child]->deadline) {
+            break;
+        }
+        heap_set(mscb, slot, mscb->req_heap[child]);
+        slot = child;
+    }
+    heap_set(mscb, slot, req);
+
+}  /* heap_sift_down */
+
+
+/********************************************************************
+* FUNCTION heap_remove
+*
+* Remove a request from the deadline heap
+*
+* INPUTS:
+*   mscb == manager session control block
+*   req == request to remove
+*********************************************************************/
+static void
+    heap_remove (mgr_scb_t *mscb,
+                 mgr_rpc_req_t *req)
+{
+    uint32 slot = req->heap_index - 1;
+
+    req->heap_index = 0;
+    mscb->req_heap_count--;
+    if (slot == mscb->req_heap_count) {
+        return;
+    }
+
+    /* move the last entry into the hole */
+    heap_set(mscb, slot, mscb->req_heap[mscb->req_heap_count]);
+    if (slot > 0 &&
+        mscb->req_heap[slot]->deadline <
+        mscb->req_heap[(slot - 1) / 2]->deadline) {
+        heap_sift_up(mscb, slot);
+    } else {
+        heap_sift_down(mscb, slot);
+    }
+
+}  /* heap_remove */
+
+
+/********************************************************************
+* FUNCTION reserve_request
+*
+* Make sure the request index has room for one more request
+* Called before the request is sent, so add_request cannot fail
+*
+* INPUTS:
+*   mscb == manager session control block
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    reserve_request (mgr_scb_t *mscb)
+{
+    if (mscb->req_count >= mscb->req_hash_size) {
+        uint32 newsize = (mscb->req_hash_size) ?
+            mscb->req_hash_size * 2 : MGR_RPC_INDEX_SIZE;
+        mgr_rpc_req_t **newhash =
+            m__getMem(newsize * sizeof(mgr_rpc_req_t *));
+        if (newhash == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        memset(newhash, 0x0, newsize * sizeof(mgr_rpc_req_t *));
+
+        if (mscb->req_hash) {
+            m__free(mscb->req_hash);
+        }
+        mscb->req_hash = newhash;
+        mscb->req_hash_size = newsize;
+
+        /* rehash in send order to keep the oldest first */
+        mgr_rpc_req_t *req = (mgr_rpc_req_t *)dlq_firstEntry(&mscb->reqQ);
+        for (; req != NULL; req = (mgr_rpc_req_t *)dlq_nextEntry(req)) {
+            hash_add(mscb, req);
+        }
+    }
+
+    if (mscb->req_heap_count >= mscb->req_heap_size) {
+        uint32 newsize = (mscb->req_heap_size) ?
+            mscb->req_heap_size * 2 : MGR_RPC_INDEX_SIZE;
+        mgr_rpc_req_t **newheap =
+            m__getMem(newsize * sizeof(mgr_rpc_req_t *));
+        if (newheap == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        if (mscb->req_heap) {
+            memcpy(newheap, mscb->req_heap,
+                   mscb->req_heap_count * sizeof(mgr_rpc_req_t *));
+            m__free(mscb->req_heap);
+        }
+        mscb->req_heap = newheap;
+        mscb->req_heap_size = newsize;
+    }
+
+    return NO_ERR;
+
+}  /* reserve_request */
+
+
+/********************************************************************
+* FUNCTION parse_msg_num
+*
+* Convert a message-id string to the number it was made from
+*
+* INPUTS:
+*   msg_id == message-id string to convert
+*   msg_num == address of return number
+*
+* OUTPUTS:
+*   *msg_num == message-id number if TRUE returned
+*
+* RETURNS:
+*   TRUE if msg_id is a number that mgr_rpc_new_request could
+*   have generated; FALSE otherwise
+*********************************************************************/
+static boolean
+    parse_msg_num (const xmlChar *msg_id,
+                   uint32 *msg_num)
+{
+    const xmlChar *str = msg_id;
+    uint32 num = 0;
+
+    if (*str == 0 || (*str == '0' && str[1] != 0)) {
+        return FALSE;
+    }
+
+    for (; *str; str++) {
+        if (*str < '0' || *str > '9') {
+            return FALSE;
+        }
+        uint32 digit = (uint32)(*str - '0');
+        if (num > (NCX_MAX_UINT - digit) / 10) {
+            return FALSE;
+        }
+        num = num * 10 + digit;
+    }
+
+    *msg_num = num;
+    return TRUE;
+
+}  /* parse_msg_num */
+
+
 /********************************************************************
 * FUNCTION add_request
 *
-* Add an RPC request to the Q
+* Add an RPC request to the Q and its index
+* reserve_request must be called first
 * 
 * INPUTS:
 *   scb == session control block
@@ -143,6 +448,15 @@ static void
 
     dlq_enque(req, &mscb->reqQ);
 
+    hash_add(mscb, req);
+    mscb->req_count++;
+
+    if (req->timeout) {
+        req->deadline = req->starttime + (time_t)req->timeout;
+        heap_set(mscb, mscb->req_heap_count++, req);
+        heap_sift_up(mscb, mscb->req_heap_count - 1);
+    }
+
 }  /* add_request */
 
 
@@ -169,13 +483,18 @@ static mgr_rpc_req_t *
 {
     mgr_scb_t *mscb;
     mgr_rpc_req_t *req;
+    uint32 msg_num = 0;
 
     mscb = mgr_ses_get_mscb(scb);
 
-    for (req = (mgr_rpc_req_t *)dlq_firstEntry(&mscb->reqQ);
+    if (mscb->req_count == 0 || !parse_msg_num(msg_id, &msg_num)) {
+        return NULL;
+    }
+
+    for (req = *hash_slot(mscb, msg_num);
          req != NULL;
-         req = (mgr_rpc_req_t *)dlq_nextEntry(req)) {
-        if (!xml_strcmp(msg_id, req->msg_id)) {
+         req = req->hash_next) {
+        if (req->msg_num == msg_num && !xml_strcmp(msg_id, req->msg_id)) {
             return req;
         }
     }
@@ -263,6 +582,7 @@ mgr_rpc_req_t *
     memset(req, 0x0, sizeof(mgr_rpc_req_t));
 
     mscb = mgr_ses_get_mscb(scb);
+    req->msg_num = mscb->next_id;
     sprintf(numbuff, "%u", mscb->next_id);
     if (mscb->next_id >= MGR_MAX_REQUEST_ID) {
         mscb->next_id = 0;
@@ -311,6 +631,7 @@ void
     if (req->data) {
         val_free_value(req->data);
     }
+    mgr_val_free_stream(req->stream);
     m__free(req);
 
 } /* mgr_rpc_free_request */
@@ -352,6 +673,8 @@ void
 * FUNCTION mgr_rpc_clean_requestQ
 *
 * Clean the request Q of mgr_rpc_req_t entries
+* The request index is not updated, so this is only
+* used when the session control block is cleaned up
 *
 * INPUTS:
 *   reqQ == Q of entries to free; the Q itself is not freed
@@ -381,62 +704,90 @@ void
 
 
 /********************************************************************
-* FUNCTION mgr_rpc_timeout_requestQ
+* FUNCTION mgr_rpc_remove_request
 *
-* Clean the request Q of mgr_rpc_req_t entries
-* Only remove the entries that have timed out
+* Remove a request from the request Q and its index
+* The request is not freed
+*
+* INPUTS:
+*   scb == session control block
+*   req == request to remove; must be in the request Q of scb
+*
+*********************************************************************/
+void
+    mgr_rpc_remove_request (ses_cb_t *scb,
+                            mgr_rpc_req_t *req)
+{
+    mgr_scb_t *mscb;
+
+#ifdef DEBUG
+    if (!scb || !req) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    mscb = mgr_ses_get_mscb(scb);
+
+    dlq_remove(req);
+
+    hash_remove(mscb, req);
+    mscb->req_count--;
+
+    if (req->heap_index) {
+        heap_remove(mscb, req);
+    }
+
+}  /* mgr_rpc_remove_request */
+
+
+/********************************************************************
+* FUNCTION mgr_rpc_timeout_requests
 *
-* returning number of msgs timed out
-* need a callback-based cleanup later on
-* to support N concurrent requests per agent
+* Remove and free the requests on a session that have timed out
+* Only the expired requests are visited, in deadline order
 *
 * INPUTS:
-*   reqQ == Q of entries to check
+*   scb == session control block
 *
 * RETURNS:
-*   number of request timed out
+*   number of requests timed out
 *********************************************************************/
 uint32
-    mgr_rpc_timeout_requestQ (dlq_hdr_t *reqQ)
+    mgr_rpc_timeout_requests (ses_cb_t *scb)
 {
-    mgr_rpc_req_t *req, *nextreq;
+    mgr_scb_t     *mscb;
+    mgr_rpc_req_t *req;
     time_t         timenow;
-    double         timediff;
     uint32         deletecount;
 
 #ifdef DEBUG
-    if (!reqQ) {
+    if (!scb) {
         SET_ERROR(ERR_INTERNAL_PTR);
         return 0;
     }
 #endif
 
+    mscb = mgr_ses_get_mscb(scb);
     deletecount = 0;
     (void)time(&timenow);
 
-    for (req = (mgr_rpc_req_t *)dlq_firstEntry(reqQ);
-         req != NULL;
-         req = nextreq) {
-
-        nextreq = (mgr_rpc_req_t *)dlq_nextEntry(req);
-
-        if (!req->timeout) {
-            continue;
+    while (mscb->req_heap_count) {
+        req = mscb->req_heap[0];
+        if (difftime(timenow, req->deadline) < 0) {
+            break;
         }
 
-        timediff = difftime(timenow, req->starttime);
-        if (timediff >= (double)req->timeout) {
-            log_info("\nmgr_rpc: deleting timed out request '%s'",
-                     req->msg_id);
-            deletecount++;
-            dlq_remove(req);
-            mgr_rpc_free_request(req);
-        }
+        log_info("\nmgr_rpc: deleting timed out request '%s'",
+                 req->msg_id);
+        deletecount++;
+        mgr_rpc_remove_request(scb, req);
+        mgr_rpc_free_request(req);
     }
 
     return deletecount;
 
-} /* mgr_rpc_timeout_requestQ */
+} /* mgr_rpc_timeout_requests */
 
 
 /********************************************************************
@@ -470,6 +821,12 @@ status_t
                req->msg_id, scb->sid);
 #endif
 
+    /* make room in the request index before anything is sent */
+    status_t res = reserve_request(mgr_ses_get_mscb(scb));
+    if (res != NO_ERR) {
+        return res;
+    }
+
     xmlns_id_t nc_id = xmlns_nc_id();
 
     xml_msg_hdr_t msg;
@@ -483,7 +840,7 @@ status_t
     }
 
     /* setup the prefix map with the NETCONF (and maybe NCX) namespace */
-    status_t res = 
+    res = 
         xml_msg_build_prefix_map(&msg, &req->attrs, FALSE,
                                  (req->data->nsid == xmlns_ncx_id()));
 
@@ -628,16 +985,23 @@ void
             mgr_rpc_free_reply(rpy);
             return;
         } else {
-            dlq_remove(req);
+            mgr_rpc_remove_request(scb, req);
         }
     }
 
     /* have a request/reply pair, so parse the reply 
      * as a val_value_t tree, stored in rpy->reply
+     * The <data> is written straight to a file instead
+     * if the request asked for it
      */
-    rpy->res = mgr_val_parse_reply(scb, rpyobj,
-                                   req ? req->rpc : ncx_get_gen_anyxml(),
-                                   top, rpy->reply);
+    if (req && req->stream) {
+        rpy->res = mgr_val_parse_reply_stream(scb, rpyobj, req->rpc, top,
+                                              req->stream, rpy->reply);
+    } else {
+        rpy->res = mgr_val_parse_reply(scb, rpyobj,
+                                       req ? req->rpc : ncx_get_gen_anyxml(),
+                                       top, rpy->reply);
+    }
     if (rpy->res != NO_ERR && LOGINFO) {
         log_info("\nmgr_rpc: got invalid reply on session %d (%s)",
                  scb->sid, get_error_string(rpy->res));
@@ -84,6 +84,11 @@ typedef struct mgr_rpc_req_t_ {
     struct timeval perfstarttime; /* tstamp to perf meas */
     uint32         timeout;       /* timeout in seconds */
     void          *replycb;           /* mgr_rpc_cbfn_t */
+    uint32         msg_num;       /* msg_id as a number */
+    time_t         deadline;      /* starttime + timeout */
+    uint32         heap_index;    /* deadline heap slot + 1 or 0 */
+    struct mgr_rpc_req_t_ *hash_next;  /* next in req_hash chain */
+    struct mgr_val_stream_t_ *stream;  /* write <data> to a file */
 
 } mgr_rpc_req_t;
 
@@ -196,6 +201,8 @@ extern void
 * FUNCTION mgr_rpc_clean_requestQ
 *
 * Clean the request Q of mgr_rpc_req_t entries
+* The request index is not updated, so this is only
+* used when the session control block is cleaned up
 *
 * INPUTS:
 *   reqQ == Q of entries to free; the Q itself is not freed
@@ -208,23 +215,35 @@ extern void
 
 
 /********************************************************************
-* FUNCTION mgr_rpc_timeout_requestQ
+* FUNCTION mgr_rpc_remove_request
 *
-* Clean the request Q of mgr_rpc_req_t entries
-* Only remove the entries that have timed out
+* Remove a request from the request Q and its index
+* The request is not freed
 *
-* returning number of msgs timed out
-* need a callback-based cleanup later on
-* to support N concurrent requests per agent
+* INPUTS:
+*   scb == session control block
+*   req == request to remove; must be in the request Q of scb
+*
+*********************************************************************/
+extern void
+    mgr_rpc_remove_request (ses_cb_t *scb,
+                            mgr_rpc_req_t *req);
+
+
+/********************************************************************
+* FUNCTION mgr_rpc_timeout_requests
+*
+* Remove and free the requests on a session that have timed out
+* Only the expired requests are visited, in deadline order
 *
 * INPUTS:
-*   reqQ == Q of entries to check
+*   scb == session control block
 *
 * RETURNS:
-*   number of request timed out
+*   number of requests timed out
 *********************************************************************/
 extern uint32
-    mgr_rpc_timeout_requestQ (dlq_hdr_t *reqQ);
+    mgr_rpc_timeout_requests (ses_cb_t *scb);
 
 
 /********************************************************************
@@ -228,6 +228,40 @@ static status_t
 }  /* direct_connect_to_server */
 
 
+/********************************************************************
+* FUNCTION local_connect_to_server
+*
+* Connect to the NETCONF server over the local ncxserver socket,
+* as if the session was started by netconf-subsystem-pro over SSH
+*
+* INPUTS:
+*   scb == session control block
+*   port == SSH port number to report, or 0 for the default
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    local_connect_to_server (ses_cb_t *scb,
+                             uint16 port)
+{
+    int fd = -1;
+    status_t res =
+        start_subsys_netconf((const char *)scb->username,
+                             (port) ? port : NCX_NCSSH_PORT,
+                             &fd);
+    if (res == NO_ERR) {
+        scb->fd = fd;
+
+        /* activate the socket in the select loop */
+        mgr_io_activate_session(scb->fd);
+    }
+
+    return res;
+
+}  /* local_connect_to_server */
+
+
 /********************************************************************
 * FUNCTION ssh2_setup
 *
@@ -790,7 +824,7 @@ void
 *   privkeyfile == filespec for client private key
 *   target == ASCII IP address or DNS hostname of target
 *   port == NETCONF port number to use, or 0 to use defaults
-*   transport == enum for the transport to use (SSH or TCP)
+*   transport == enum for the transport to use (SSH, TCP or LOCAL)
 *   progcb == temp program instance control block,
 *          == NULL if a session temp files control block is not
 *             needed
@@ -927,6 +961,8 @@ status_t
 
     if (direct_mode) {
         res = direct_connect_to_server(scb);
+    } else if (transport == SES_TRANSPORT_LOCAL) {
+        res = local_connect_to_server(scb, port);
     } else {
         /* get the hostname for the specified target */
         struct hostent *hent = gethostbyname((const char *)target);
@@ -1053,7 +1089,7 @@ void
         mgr_scb_t *mscb = (mgr_scb_t *)scb->mgrcb;
         dlq_hdr_t *tempQ = ncx_get_session_modQ();
         
-        if (tempQ == &mscb->temp_modQ) {
+        if (tempQ == mgr_get_modQ(mscb)) {
             ncx_clear_temp_modQ();
             ncx_clear_session_modQ();
         }
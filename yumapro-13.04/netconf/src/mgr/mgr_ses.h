@@ -126,7 +126,7 @@ extern void
 *   privkeyfile == filespec for client private key
 *   target == ASCII IP address or DNS hostname of target
 *   port == NETCONF port number to use, or 0 to use defaults
-*   transport == enum for the transport to use (SSH or TCP)
+*   transport == enum for the transport to use (SSH, TCP or LOCAL)
 *   progcb == temp program instance control block,
 *          == NULL if a session temp files control block is not
 *             needed
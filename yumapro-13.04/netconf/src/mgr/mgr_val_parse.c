@@ -77,6 +77,42 @@ date         init     comment
 //#define MGR_VAL_PARSE_DEBUG 1
 #endif
 
+/* initial size of the stream level stack; doubled as needed */
+#define MGR_VAL_STREAM_DEPTH     32
+
+/* max number of streamed schema errors to log */
+#define MGR_VAL_STREAM_MAX_WARN  10
+
+
+/********************************************************************
+*                                                                   *
+*                            T Y P E S                              *
+*                                                                   *
+*********************************************************************/
+
+/* one open element while streaming <data> */
+typedef struct stream_level_t_ {
+    obj_template_t  *obj;        /* schema node or NULL if unknown */
+    obj_template_t  *arrayobj;   /* JSON array open for this obj */
+    const xmlChar   *nsuri;      /* namespace URI from the reader */
+    int32            indent;
+    boolean          opentag;    /* XML start tag not closed yet */
+    boolean          anychild;   /* child element written */
+    boolean          anytext;    /* text content written */
+    boolean          pending;    /* JSON value not started yet */
+} stream_level_t;
+
+/* state for streaming one <data> element */
+typedef struct stream_out_t_ {
+    ses_cb_t          *scb;         /* input session */
+    ses_cb_t          *outscb;      /* dummy session for the file */
+    mgr_val_stream_t  *stream;
+    dlq_hdr_t         *force_modQ;
+    stream_level_t    *levels;      /* stack of open elements */
+    uint32             depth;
+    uint32             maxdepth;
+} stream_out_t;
+
 
 /* forward declaration for recursive calls */
 static status_t 
@@ -90,6 +126,7 @@ static status_t
                        obj_template_t *obj,
                        obj_template_t *output,
                        const xml_node_t *startnode,
+                       mgr_val_stream_t *stream,
                        val_value_t  *retval);
 
 
@@ -1324,6 +1361,702 @@ static status_t
 } /* parse_union */
 
 
+/********************************************************************
+ * FUNCTION stream_warn
+ *
+ * Record a schema error found while streaming
+ * Only the first few errors are logged
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   node == XML node with the error
+ *   res == error status
+ *********************************************************************/
+static void
+    stream_warn (stream_out_t *out,
+                 const xml_node_t *node,
+                 status_t res)
+{
+    out->stream->errors++;
+    if (out->stream->errors <= MGR_VAL_STREAM_MAX_WARN) {
+        log_warn("\nWarning: streamed node '%s' at depth %u (%s)",
+                 (node->elname) ? node->elname : NCX_EL_NONE,
+                 out->depth, get_error_string(res));
+    }
+
+}  /* stream_warn */
+
+
+/********************************************************************
+ * FUNCTION stream_push
+ *
+ * Push a new level on the stream level stack
+ *
+ * INPUTS:
+ *   out == stream output state
+ *
+ * RETURNS:
+ *   pointer to the new zeroed level, or NULL if malloc error
+ *********************************************************************/
+static stream_level_t *
+    stream_push (stream_out_t *out)
+{
+    if (out->depth == out->maxdepth) {
+        uint32 newmax = (out->maxdepth) ?
+            out->maxdepth * 2 : MGR_VAL_STREAM_DEPTH;
+        stream_level_t *newlevels =
+            m__getMem(newmax * sizeof(stream_level_t));
+        if (newlevels == NULL) {
+            return NULL;
+        }
+        if (out->levels) {
+            memcpy(newlevels, out->levels,
+                   out->depth * sizeof(stream_level_t));
+            m__free(out->levels);
+        }
+        out->levels = newlevels;
+        out->maxdepth = newmax;
+    }
+
+    stream_level_t *level = &out->levels[out->depth++];
+    memset(level, 0x0, sizeof(stream_level_t));
+    return level;
+
+}  /* stream_push */
+
+
+/********************************************************************
+ * FUNCTION stream_find_obj
+ *
+ * Find the schema node for a streamed element
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   node == XML start or empty node
+ *
+ * RETURNS:
+ *   schema node or NULL if not known
+ *********************************************************************/
+static obj_template_t *
+    stream_find_obj (stream_out_t *out,
+                     xml_node_t *node)
+{
+    stream_level_t  *parent = &out->levels[out->depth - 1];
+    obj_template_t  *obj = NULL;
+    boolean          known = TRUE;
+
+    if (out->depth == 1) {
+        /* top-level node in <data> */
+        ncx_module_t *mod = NULL;
+        if (node->nsid && out->force_modQ) {
+            mod = ncx_find_module_que_nsid(out->force_modQ, node->nsid);
+        }
+        if (mod == NULL && node->nsid) {
+            mod = (ncx_module_t *)xmlns_get_modptr(node->nsid);
+        }
+        if (mod) {
+            obj = ncx_find_object(mod, node->elname);
+            if (obj && !obj_is_data_db(obj)) {
+                obj = NULL;
+            }
+        }
+    } else if (parent->obj &&
+               (obj_is_container(parent->obj) || obj_is_list(parent->obj))) {
+        obj_template_t *curtop = NULL;
+        status_t res = obj_get_child_node(parent->obj, NULL, node, FALSE,
+                                          out->force_modQ, &curtop, &obj);
+        if (res != NO_ERR) {
+            obj = NULL;
+        }
+    } else {
+        /* inside an unknown or anyxml node */
+        known = FALSE;
+    }
+
+    if (obj == NULL && known && out->stream->validate) {
+        stream_warn(out, node, ERR_NCX_UNKNOWN_OBJECT);
+    }
+    return obj;
+
+}  /* stream_find_obj */
+
+
+/********************************************************************
+ * FUNCTION stream_check_value
+ *
+ * Check the value of a streamed leaf or leaf-list
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   node == XML node to use for errors
+ *   level == level of the leaf
+ *   str == value string
+ *********************************************************************/
+static void
+    stream_check_value (stream_out_t *out,
+                        const xml_node_t *node,
+                        const stream_level_t *level,
+                        const xmlChar *str)
+{
+    if (!out->stream->validate || level->obj == NULL ||
+        !obj_is_leafy(level->obj)) {
+        return;
+    }
+
+    switch (obj_get_basetype(level->obj)) {
+    case NCX_BT_IDREF:
+    case NCX_BT_INSTANCE_ID:
+    case NCX_BT_LEAFREF:
+        /* need the XML prefixes or the data tree to check */
+        return;
+    default:
+        break;
+    }
+
+    status_t res = val_simval_ok(obj_get_typdef(level->obj), str);
+    if (res != NO_ERR) {
+        stream_warn(out, node, res);
+    }
+
+}  /* stream_check_value */
+
+
+/********************************************************************
+ * FUNCTION json_is_number
+ *
+ * Check if a string can be written as a JSON number
+ *
+ * INPUTS:
+ *   str == string to check
+ *
+ * RETURNS:
+ *   TRUE if str is a number
+ *********************************************************************/
+static boolean
+    json_is_number (const xmlChar *str)
+{
+    if (*str == '-') {
+        str++;
+    }
+    if (*str < '0' || *str > '9') {
+        return FALSE;
+    }
+    for (; *str; str++) {
+        if ((*str < '0' || *str > '9') && *str != '.') {
+            return FALSE;
+        }
+    }
+    return TRUE;
+
+}  /* json_is_number */
+
+
+/********************************************************************
+ * FUNCTION json_write_value
+ *
+ * Write a JSON leaf or leaf-list value, using the schema type
+ * the same way as json_wr
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   obj == schema node or NULL if unknown
+ *   str == value string
+ *********************************************************************/
+static void
+    json_write_value (stream_out_t *out,
+                      obj_template_t *obj,
+                      const xmlChar *str)
+{
+    ses_cb_t *outscb = out->outscb;
+    ncx_btype_t btyp = (obj && obj_is_leafy(obj)) ?
+        obj_get_basetype(obj) : NCX_BT_STRING;
+
+    if (btyp == NCX_BT_EMPTY) {
+        ses_putchar(outscb, '[');
+        ses_putjstr(outscb, NCX_EL_NULL, -1);
+        ses_putchar(outscb, ']');
+    } else if ((btyp == NCX_BT_BOOLEAN &&
+                (ncx_is_true(str) || ncx_is_false(str))) ||
+               (typ_is_number(btyp) && json_is_number(str))) {
+        ses_putjstr(outscb, str, -1);
+    } else {
+        ses_putchar(outscb, '"');
+        ses_putjstr(outscb, str, -1);
+        ses_putchar(outscb, '"');
+    }
+
+}  /* json_write_value */
+
+
+/********************************************************************
+ * FUNCTION json_open_object
+ *
+ * Start the JSON object for a level if not done yet
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   level == level to check
+ *********************************************************************/
+static void
+    json_open_object (stream_out_t *out,
+                      stream_level_t *level)
+{
+    if (level->pending) {
+        if (out->stream->indent > 0) {
+            ses_putchar(out->outscb, ' ');
+        }
+        ses_putchar(out->outscb, '{');
+        level->pending = FALSE;
+    }
+
+}  /* json_open_object */
+
+
+/********************************************************************
+ * FUNCTION json_close_array
+ *
+ * End the JSON array open in a level, if any
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   level == level to check
+ *********************************************************************/
+static void
+    json_close_array (stream_out_t *out,
+                      stream_level_t *level)
+{
+    if (level->arrayobj) {
+        ses_indent(out->outscb, level->indent + out->stream->indent);
+        ses_putchar(out->outscb, ']');
+        level->arrayobj = NULL;
+    }
+
+}  /* json_close_array */
+
+
+/********************************************************************
+ * FUNCTION stream_start
+ *
+ * Write the start of a streamed element
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   node == XML start or empty node
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    stream_start (stream_out_t *out,
+                  xml_node_t *node)
+{
+    ses_cb_t *outscb = out->outscb;
+    int32 indent_amount = out->stream->indent;
+
+    obj_template_t *obj = stream_find_obj(out, node);
+    stream_level_t *parent = &out->levels[out->depth - 1];
+
+    if (out->stream->mode == NCX_DISPLAY_MODE_JSON) {
+        boolean isarray = (obj && (obj_is_list(obj) || obj_is_leaf_list(obj)));
+
+        json_open_object(out, parent);
+        if (parent->arrayobj != obj) {
+            json_close_array(out, parent);
+        }
+        if (parent->anychild) {
+            ses_putchar(outscb, ',');
+        }
+        parent->anychild = TRUE;
+
+        boolean newarray = (isarray && parent->arrayobj != obj);
+        if (newarray) {
+            ses_indent(outscb, parent->indent + indent_amount);
+            ses_putchar(outscb, '"');
+            ses_putjstr(outscb, node->elname, -1);
+            ses_putstr(outscb, (const xmlChar *)"\":");
+            if (indent_amount > 0) {
+                ses_putchar(outscb, ' ');
+            }
+            ses_putchar(outscb, '[');
+            parent->arrayobj = obj;
+        }
+
+        int32 indent = parent->indent + indent_amount;
+        if (isarray) {
+            indent += indent_amount;
+        }
+
+        stream_level_t *level = stream_push(out);
+        if (level == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        level->obj = obj;
+        level->indent = indent;
+        level->pending = TRUE;
+
+        ses_indent(outscb, indent);
+        if (isarray) {
+            if (obj_is_list(obj)) {
+                ses_putchar(outscb, '{');
+                level->pending = FALSE;
+            }
+        } else {
+            ses_putchar(outscb, '"');
+            ses_putjstr(outscb, node->elname, -1);
+            ses_putstr(outscb, (const xmlChar *)"\":");
+        }
+    } else {
+        if (parent->opentag) {
+            ses_putchar(outscb, '>');
+            parent->opentag = FALSE;
+        }
+        parent->anychild = TRUE;
+
+        stream_level_t *level = stream_push(out);
+        if (level == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        level->obj = obj;
+        level->nsuri = xmlTextReaderConstNamespaceUri(out->scb->reader);
+        level->indent = parent->indent + indent_amount;
+        level->opentag = TRUE;
+
+        ses_indent(outscb, level->indent);
+        ses_putchar(outscb, '<');
+        ses_putstr(outscb, node->elname);
+
+        /* the element is written without a prefix, so declare
+         * the default namespace if it changes; the URI is
+         * compared so this works for unknown modules too
+         */
+        if (level->nsuri == NULL || parent->nsuri == NULL ||
+            xml_strcmp(level->nsuri, parent->nsuri)) {
+            ses_putstr(outscb, (const xmlChar *)" xmlns=\"");
+            if (level->nsuri) {
+                ses_putastr(outscb, level->nsuri, -1);
+            }
+            ses_putchar(outscb, '"');
+        }
+
+        /* copy the attributes as received, including the xmlns
+         * prefix declarations, so any QName content stays valid
+         */
+        xml_attr_t *attr = xml_get_first_attr(node);
+        for (; attr != NULL; attr = xml_next_attr(attr)) {
+            if (!xml_strcmp(attr->attr_qname, XMLNS)) {
+                continue;
+            }
+            ses_putchar(outscb, ' ');
+            ses_putstr(outscb, attr->attr_qname);
+            ses_putstr(outscb, (const xmlChar *)"=\"");
+            ses_putastr(outscb, attr->attr_val, -1);
+            ses_putchar(outscb, '"');
+        }
+    }
+
+    out->stream->nodes++;
+    return NO_ERR;
+
+}  /* stream_start */
+
+
+/********************************************************************
+ * FUNCTION stream_text
+ *
+ * Write the text content of a streamed element
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   node == XML string node
+ *********************************************************************/
+static void
+    stream_text (stream_out_t *out,
+                 const xml_node_t *node)
+{
+    stream_level_t *level = &out->levels[out->depth - 1];
+
+    if (out->stream->mode == NCX_DISPLAY_MODE_JSON) {
+        if (!level->pending) {
+            /* mixed content is not supported in JSON */
+            return;
+        }
+        json_write_value(out, level->obj, node->simval);
+        level->pending = FALSE;
+    } else {
+        if (level->opentag) {
+            ses_putchar(out->outscb, '>');
+            level->opentag = FALSE;
+        }
+        ses_putcstr(out->outscb, node->simval, -1);
+    }
+
+    level->anytext = TRUE;
+    stream_check_value(out, node, level, node->simval);
+
+}  /* stream_text */
+
+
+/********************************************************************
+ * FUNCTION stream_end
+ *
+ * Write the end of a streamed element and pop its level
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   node == XML end or empty node
+ *********************************************************************/
+static void
+    stream_end (stream_out_t *out,
+                const xml_node_t *node)
+{
+    ses_cb_t *outscb = out->outscb;
+    stream_level_t *level = &out->levels[out->depth - 1];
+
+    if (!level->anytext && !level->anychild) {
+        stream_check_value(out, node, level, EMPTY_STRING);
+    }
+
+    if (out->stream->mode == NCX_DISPLAY_MODE_JSON) {
+        if (level->pending) {
+            /* no content */
+            if (level->obj && obj_is_leafy(level->obj)) {
+                json_write_value(out, level->obj, EMPTY_STRING);
+            } else {
+                if (out->stream->indent > 0) {
+                    ses_putchar(outscb, ' ');
+                }
+                ses_putstr(outscb, (const xmlChar *)"{}");
+            }
+        } else if (!level->anytext) {
+            json_close_array(out, level);
+            ses_indent(outscb, level->indent);
+            ses_putchar(outscb, '}');
+        }
+    } else {
+        if (level->opentag) {
+            ses_putstr(outscb, (const xmlChar *)"/>");
+        } else {
+            if (level->anychild) {
+                ses_indent(outscb, level->indent);
+            }
+            ses_putstr(outscb, (const xmlChar *)"</");
+            ses_putstr(outscb, node->elname);
+            ses_putchar(outscb, '>');
+        }
+    }
+
+    out->depth--;
+
+}  /* stream_end */
+
+
+/********************************************************************
+ * FUNCTION stream_open
+ *
+ * Open the stream output file and write the <data> start
+ *
+ * INPUTS:
+ *   out == stream output state
+ *   replynode == <rpc-reply> start node, for the xmlns
+ *                declarations that are in scope for <data>
+ *   datanode == <data> start or empty node
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    stream_open (stream_out_t *out,
+                 const xml_node_t *replynode,
+                 const xml_node_t *datanode)
+{
+    mgr_val_stream_t *stream = out->stream;
+
+    FILE *fp = fopen((const char *)stream->filespec, "w");
+    if (fp == NULL) {
+        log_error("\nError: cannot open output file '%s'",
+                  stream->filespec);
+        return ERR_FIL_OPEN;
+    }
+
+    out->outscb = ses_new_dummy_scb();
+    if (out->outscb == NULL) {
+        fclose(fp);
+        return ERR_INTERNAL_MEM;
+    }
+    out->outscb->fp = fp;
+    out->outscb->indent = stream->indent;
+    stream->started = TRUE;
+
+    stream_level_t *level = stream_push(out);
+    if (level == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    level->nsuri = xmlns_get_ns_name(datanode->nsid);
+
+    ses_cb_t *outscb = out->outscb;
+    if (stream->mode == NCX_DISPLAY_MODE_JSON) {
+        level->indent = stream->indent;
+        level->pending = TRUE;
+        ses_putchar(outscb, '{');
+        ses_indent(outscb, level->indent);
+        ses_putchar(outscb, '"');
+        ses_putjstr(outscb, datanode->elname, -1);
+        ses_putstr(outscb, (const xmlChar *)"\":");
+        return NO_ERR;
+    }
+
+    if (stream->xmlhdr) {
+        ses_putstr(outscb, (const xmlChar *)XML_START_MSG);
+        ses_indent(outscb, 0);
+    }
+    ses_putchar(outscb, '<');
+    ses_putstr(outscb, datanode->elname);
+    ses_putstr(outscb, (const xmlChar *)" xmlns=\"");
+    ses_putastr(outscb, xmlns_get_ns_name(datanode->nsid), -1);
+    ses_putchar(outscb, '"');
+
+    /* copy the prefix declarations from <rpc-reply> and <data> */
+    const xml_node_t *nodes[2] = { replynode, datanode };
+    uint32 i;
+    for (i = 0; i < 2; i++) {
+        xml_attr_t *attr = xml_get_first_attr(nodes[i]);
+        for (; attr != NULL; attr = xml_next_attr(attr)) {
+            if (xml_strncmp(attr->attr_qname, XMLNS, xml_strlen(XMLNS)) ||
+                attr->attr_qname[xml_strlen(XMLNS)] != ':') {
+                continue;
+            }
+            ses_putchar(outscb, ' ');
+            ses_putstr(outscb, attr->attr_qname);
+            ses_putstr(outscb, (const xmlChar *)"=\"");
+            ses_putastr(outscb, attr->attr_val, -1);
+            ses_putchar(outscb, '"');
+        }
+    }
+    level->opentag = TRUE;
+    return NO_ERR;
+
+}  /* stream_open */
+
+
+/********************************************************************
+ * FUNCTION stream_data
+ *
+ * Write the <data> element to the stream output file
+ * as the nodes are read, without building a value tree
+ *
+ * INPUTS:
+ *   scb == session control block
+ *          Input is read from scb->reader.
+ *   replynode == <rpc-reply> start node
+ *   datanode == <data> start or empty node
+ *   force_modQ == Q of temp modules for this session, or NULL
+ *   stream == stream output control block to use
+ *
+ * OUTPUTS:
+ *   stream->started, nodes, errors, res are set
+ *
+ * RETURNS:
+ *   status of the XML input; output errors are in stream->res
+ *********************************************************************/
+static status_t
+    stream_data (ses_cb_t *scb,
+                 const xml_node_t *replynode,
+                 const xml_node_t *datanode,
+                 dlq_hdr_t *force_modQ,
+                 mgr_val_stream_t *stream)
+{
+    stream_out_t  out;
+    xml_node_t    node;
+    status_t      res = NO_ERR;
+
+    memset(&out, 0x0, sizeof(stream_out_t));
+    out.scb = scb;
+    out.stream = stream;
+    out.force_modQ = force_modQ;
+
+    stream->res = stream_open(&out, replynode, datanode);
+    if (stream->res != NO_ERR) {
+        /* keep reading so the rest of the reply can be parsed */
+        res = mgr_xml_skip_subtree(scb->reader, datanode);
+    } else if (datanode->nodetyp == XML_NT_EMPTY) {
+        stream_end(&out, datanode);
+    }
+
+    xml_init_node(&node);
+
+    while (stream->res == NO_ERR && res == NO_ERR && out.depth) {
+        xml_clean_node(&node);
+
+        res = get_xml_node(scb, &node);
+        if (res == ERR_NCX_UNKNOWN_NS && node.elname) {
+            /* namespace is copied from the reader */
+            node.nsid = 0;
+            res = NO_ERR;
+        }
+        if (res != NO_ERR) {
+            continue;
+        }
+
+        switch (node.nodetyp) {
+        case XML_NT_START:
+            stream->res = stream_start(&out, &node);
+            break;
+        case XML_NT_EMPTY:
+            stream->res = stream_start(&out, &node);
+            if (stream->res == NO_ERR) {
+                stream_end(&out, &node);
+            }
+            break;
+        case XML_NT_STRING:
+            stream_text(&out, &node);
+            break;
+        case XML_NT_END:
+            stream_end(&out, &node);
+            break;
+        default:
+            res = ERR_NCX_WRONG_NODETYP;
+        }
+    }
+
+    if (stream->res != NO_ERR && res == NO_ERR && out.depth) {
+        /* output failed; skip the rest of <data> */
+        res = mgr_xml_skip_subtree(scb->reader, datanode);
+    }
+
+    if (out.outscb) {
+        if (out.depth == 0 && stream->mode == NCX_DISPLAY_MODE_JSON) {
+            ses_indent(out.outscb, 0);
+            ses_putchar(out.outscb, '}');
+        }
+        ses_putchar(out.outscb, '\n');
+
+        FILE *fp = out.outscb->fp;
+        out.outscb->fp = NULL;   /* do not close the file */
+        ses_free_scb(out.outscb);
+
+        if ((ferror(fp) || fclose(fp)) && stream->res == NO_ERR) {
+            log_error("\nError: cannot write output file '%s'",
+                      stream->filespec);
+            stream->res = ERR_FIL_WRITE;
+        }
+    }
+
+    if (res == NO_ERR && out.depth) {
+        res = ERR_XML_READER_EOF;
+    }
+    if (res != NO_ERR && stream->res == NO_ERR) {
+        stream->res = res;
+    }
+
+    xml_clean_node(&node);
+    if (out.levels) {
+        m__free(out.levels);
+    }
+    return res;
+
+}  /* stream_data */
+
+
 /********************************************************************
  * FUNCTION parse_complex
  * 
@@ -1354,6 +2087,8 @@ static status_t
  *     startnode == top node of the parameter to be parsed
  *            Parser function will attempt to consume all the
  *            nodes until the matching endnode is reached
+ *     stream == stream output control block if the <data>
+ *            child of output is written to a file, or NULL
  *     retval ==  val_value_t that should get the results of the parsing
  *     
  * OUTPUTS:
@@ -1369,6 +2104,7 @@ static status_t
                    obj_template_t *output,
                    ncx_btype_t btyp,
                    const xml_node_t *startnode,
+                   mgr_val_stream_t *stream,
                    val_value_t  *retval)
 {
     obj_template_t       *chobj, *curchild, *curtop;
@@ -1393,10 +2129,10 @@ static status_t
     chbtyp = NCX_BT_NONE;
     mscb = (mgr_scb_t *)scb->mgrcb;
 
-    if (mscb == NULL || dlq_empty(&mscb->temp_modQ)) {
+    if (mscb == NULL || dlq_empty(mgr_get_modQ(mscb))) {
         force_modQ = NULL;
     } else {
-        force_modQ = &mscb->temp_modQ;
+        force_modQ = mgr_get_modQ(mscb);
     }
 
     val_init_from_template(retval, obj);
@@ -1486,6 +2222,23 @@ static status_t
             res = ERR_NCX_WRONG_NODETYP;
         }
 
+        /* write the <data> node of the reply to the stream
+         * output file instead of parsing it into retval
+         */
+        if (res == NO_ERR && stream && output && !errmode &&
+            chnode.nsid == xmlns_nc_id() &&
+            !xml_strcmp(chnode.elname, NCX_EL_DATA)) {
+            res = stream_data(scb, startnode, &chnode, force_modQ, stream);
+            xml_clean_node(&chnode);
+            if (res != NO_ERR) {
+                retres = res;
+                if (NEED_EXIT(res) || res == ERR_XML_READER_EOF) {
+                    done = TRUE;
+                }
+            }
+            continue;
+        }
+
         /* if we get here, there is a START or EMPTY node
          * that could be a valid child node
          *
@@ -1958,7 +2711,7 @@ static status_t
         break;
     case NCX_BT_CONTAINER:
     case NCX_BT_LIST:
-        res = parse_complex(scb, obj, NULL, btyp, startnode, retval);
+        res = parse_complex(scb, obj, NULL, btyp, startnode, NULL, retval);
         break;
     default:
         return SET_ERROR(ERR_INTERNAL_VAL);
@@ -1999,6 +2752,7 @@ static status_t
 *     startnode == top node of the parameter to be parsed
 *            Parser function will attempt to consume all the
 *            nodes until the matching endnode is reached
+*     stream == stream output control block or NULL if not used
 *     retval ==  val_value_t that should get the results of the parsing
 *     
 * OUTPUTS:
@@ -2013,6 +2767,7 @@ static status_t
                        obj_template_t *obj,
                        obj_template_t *output,
                        const xml_node_t *startnode,
+                       mgr_val_stream_t *stream,
                        val_value_t  *retval)
 {
     ncx_btype_t  btyp;
@@ -2071,7 +2826,8 @@ static status_t
         break;
     case NCX_BT_CONTAINER:
     case NCX_BT_LIST:
-        res = parse_complex(scb, obj, output, btyp, startnode, retval);
+        res = parse_complex(scb, obj, output, btyp, startnode, stream,
+                            retval);
         break;
     default:
         log_error("\nError: got invalid btype '%d'", btyp);
@@ -2248,13 +3004,125 @@ status_t
     output = (rpc) ? obj_find_child(rpc, NULL, NCX_EL_OUTPUT) : NULL;
 
     /* get the element values */
-    res = parse_btype_split(scb, obj, output, startnode, retval);
+    res = parse_btype_split(scb, obj, output, startnode, NULL, retval);
     
     return res;
 
 }  /* mgr_val_parse_reply */
 
 
+/********************************************************************
+* FUNCTION mgr_val_parse_reply_stream
+* 
+* parse an <rpc-reply> element like mgr_val_parse_reply, 
+* except the <data> element is written to the stream
+* output file as it is read, instead of being added to retval
+*
+* Client memory stays bounded by the depth of the data,
+* not its size.  Other reply content, such as <rpc-error>,
+* is still parsed into retval.
+*
+* INPUTS:
+*     scb == session control block
+*     obj == obj_template_t for the top-level reply to parse
+*     rpc == RPC template to use for any data in the output
+*     startnode == top node of the parameter to be parsed
+*     stream == stream output control block to use
+*     retval ==  val_value_t that should get the results of the parsing
+*     
+* OUTPUTS:
+*    *retval will be filled in
+*    stream->started set if a <data> element was written
+*    stream->nodes, errors, res are set
+*
+* RETURNS:
+*    status
+*********************************************************************/
+status_t 
+    mgr_val_parse_reply_stream (ses_cb_t  *scb,
+                                obj_template_t *obj,
+                                obj_template_t *rpc,
+                                const xml_node_t *startnode,
+                                mgr_val_stream_t *stream,
+                                val_value_t  *retval)
+{
+#ifdef DEBUG
+    if (!scb || !obj || !startnode || !stream || !retval) {
+        /* non-recoverable error */
+        return SET_ERROR(ERR_INTERNAL_PTR);
+    }
+#endif
+
+    obj_template_t *output = 
+        (rpc) ? obj_find_child(rpc, NULL, NCX_EL_OUTPUT) : NULL;
+
+    stream->started = FALSE;
+    stream->nodes = 0;
+    stream->errors = 0;
+    stream->res = NO_ERR;
+
+    return parse_btype_split(scb, obj, output, startnode, stream, retval);
+
+}  /* mgr_val_parse_reply_stream */
+
+
+/********************************************************************
+* FUNCTION mgr_val_new_stream
+* 
+* Malloc and init a stream output control block
+*
+* INPUTS:
+*     filespec == output file spec to use
+*     mode == output encoding: NCX_DISPLAY_MODE_XML or 
+*             NCX_DISPLAY_MODE_JSON
+*     
+* RETURNS:
+*    malloced struct or NULL if malloc error
+*********************************************************************/
+mgr_val_stream_t *
+    mgr_val_new_stream (const xmlChar *filespec,
+                        ncx_display_mode_t mode)
+{
+    mgr_val_stream_t *stream = m__getObj(mgr_val_stream_t);
+    if (stream == NULL) {
+        return NULL;
+    }
+    memset(stream, 0x0, sizeof(mgr_val_stream_t));
+
+    stream->filespec = xml_strdup(filespec);
+    if (stream->filespec == NULL) {
+        m__free(stream);
+        return NULL;
+    }
+    stream->mode = mode;
+    stream->indent = NCX_DEF_INDENT;
+    return stream;
+
+}  /* mgr_val_new_stream */
+
+
+/********************************************************************
+* FUNCTION mgr_val_free_stream
+* 
+* Free a stream output control block
+*
+* INPUTS:
+*     stream == stream output control block to free
+*********************************************************************/
+void
+    mgr_val_free_stream (mgr_val_stream_t *stream)
+{
+    if (stream == NULL) {
+        return;
+    }
+    if (stream->filespec) {
+        m__free(stream->filespec);
+    }
+    m__free(stream);
+
+}  /* mgr_val_free_stream */
+
+
 /********************************************************************
 * FUNCTION mgr_val_parse_notification
 * 
@@ -2300,7 +3168,7 @@ status_t
 #endif
 
     /* get the element values */
-    res = parse_btype_split(scb, notobj, NULL, startnode, retval);
+    res = parse_btype_split(scb, notobj, NULL, startnode, NULL, retval);
 
     return res;
 
@@ -33,6 +33,10 @@ date	     init     comment
 
 */
 
+#ifndef _H_ncxtypes
+#include "ncxtypes.h"
+#endif
+
 #ifndef _H_obj
 #include "obj.h"
 #endif
@@ -57,6 +61,31 @@ date	     init     comment
 extern "C" {
 #endif
 
+/********************************************************************
+*								    *
+*			     T Y P E S				    *
+*								    *
+*********************************************************************/
+
+/* output control block for streaming the <data> element
+ * of an <rpc-reply> to a file while it is read, instead
+ * of parsing it into a value tree
+ */
+typedef struct mgr_val_stream_t_ {
+    xmlChar            *filespec;     /* malloced output file */
+    ncx_display_mode_t  mode;         /* XML or JSON */
+    boolean             xmlhdr;       /* write <?xml?> for XML */
+    boolean             validate;     /* check nodes against schema */
+    int32               indent;       /* indent amount */
+
+    /* set while the <data> element is streamed */
+    boolean             started;      /* output file was opened */
+    uint32              nodes;        /* elements written */
+    uint32              errors;       /* schema errors found */
+    status_t            res;          /* first output error */
+} mgr_val_stream_t;
+
+
 /********************************************************************
 *								    *
 *			F U N C T I O N S			    *
@@ -169,6 +198,73 @@ extern status_t
 				const xml_node_t *startnode,
 				val_value_t  *retval);
 
+
+
+/********************************************************************
+* FUNCTION mgr_val_parse_reply_stream
+* 
+* parse an <rpc-reply> element like mgr_val_parse_reply, 
+* except the <data> element is written to the stream
+* output file as it is read, instead of being added to retval
+*
+* Client memory stays bounded by the depth of the data,
+* not its size.  Other reply content, such as <rpc-error>,
+* is still parsed into retval.
+*
+* INPUTS:
+*     scb == session control block
+*     obj == obj_template_t for the top-level reply to parse
+*     rpc == RPC template to use for any data in the output
+*     startnode == top node of the parameter to be parsed
+*     stream == stream output control block to use
+*     retval ==  val_value_t that should get the results of the parsing
+*     
+* OUTPUTS:
+*    *retval will be filled in
+*    stream->started set if a <data> element was written
+*    stream->nodes, errors, res are set
+*
+* RETURNS:
+*    status
+*********************************************************************/
+extern status_t 
+    mgr_val_parse_reply_stream (ses_cb_t  *scb,
+                                obj_template_t *obj,
+                                obj_template_t *rpc,
+                                const xml_node_t *startnode,
+                                mgr_val_stream_t *stream,
+                                val_value_t  *retval);
+
+
+/********************************************************************
+* FUNCTION mgr_val_new_stream
+* 
+* Malloc and init a stream output control block
+*
+* INPUTS:
+*     filespec == output file spec to use
+*     mode == output encoding: NCX_DISPLAY_MODE_XML or 
+*             NCX_DISPLAY_MODE_JSON
+*     
+* RETURNS:
+*    malloced struct or NULL if malloc error
+*********************************************************************/
+extern mgr_val_stream_t *
+    mgr_val_new_stream (const xmlChar *filespec,
+                        ncx_display_mode_t mode);
+
+
+/********************************************************************
+* FUNCTION mgr_val_free_stream
+* 
+* Free a stream output control block
+*
+* INPUTS:
+*     stream == stream output control block to free
+*********************************************************************/
+extern void
+    mgr_val_free_stream (mgr_val_stream_t *stream);
+
 #ifdef __cplusplus
 }  /* end extern 'C' */
 #endif
@@ -40,6 +40,15 @@
 
       Retrieve the simple value contents of a virtual value leaf node
 
+    List Iterator: getcb_iter_fn_t
+
+       Retrieve a batch of list entries for a state data list
+       that is not stored in the database.  The server resumes
+       the walk with the keys of the last entry returned, and
+       passes down key matches and selected child nodes from
+       the retrieval filter, so the instrumentation only needs
+       to build the entries that will actually be sent.
+
 
 *********************************************************************
 *								    *
@@ -53,6 +62,10 @@ date	     init     comment
 
 */
 
+#ifndef _H_dlq
+#include "dlq.h"
+#endif
+
 #ifndef _H_ncxconst
 #include "ncxconst.h"
 #endif
@@ -118,6 +131,69 @@ typedef status_t
 		   const val_value_t *virval,
 		   val_value_t *dstval);
 
+
+/* control block for one walk of a virtual list
+ * The server fills in the input fields and then calls the
+ * getcb_iter_fn_t for the list until the done flag is set
+ * Each call returns the next batch of entries in entryQ
+ */
+typedef struct getcb_iter_t_ {
+    /* inputs set by the server */
+    struct obj_template_t_ *listobj;  /* list object being walked */
+    val_value_t  *listval;     /* place-holder node for the list */
+
+    /* Q of val_value_t: key leafs of the last entry returned
+     * in the previous batch; the callback MUST return only
+     * entries that follow this entry.  Empty for the first batch
+     */
+    dlq_hdr_t     startkeyQ;
+
+    /* Q of val_value_t: child leafs of the list (usually keys)
+     * that must be equal in every entry that will be output.
+     * This is a hint from a subtree filter content match;
+     * the server tests the entries again, so it can be ignored
+     */
+    dlq_hdr_t     matchQ;
+
+    /* Q of ncx_backptr_t, node == obj_template_t of a child
+     * of the list that will be output;  Keys are always needed.
+     * Empty Q means all child nodes are requested
+     */
+    dlq_hdr_t     selectQ;
+
+    uint32        maxentries;  /* max entries in 1 batch; 0 == no max */
+    uint32        batchcount;  /* number of batches requested so far */
+
+    /* outputs set by the callback */
+    dlq_hdr_t     entryQ;      /* Q of val_value_t list entries */
+    boolean       done;        /* TRUE if no entries after entryQ */
+} getcb_iter_t;
+
+
+/* getcb_iter_fn_t
+ *
+ * Callback function for a virtual list iterator
+ *
+ * INPUTS:
+ *   scb    == session that issued the get (may be NULL)
+ *             can be used for access control purposes
+ *   iter   == iterator control block for this walk
+ *
+ * OUTPUTS:
+ *   iter->entryQ should be filled with up to iter->maxentries
+ *     list entries, each malloced with val_new_value and
+ *     initialized with val_init_from_template(iter->listobj)
+ *     and including all key leafs
+ *   iter->done should be set to TRUE if there are no more
+ *     entries after the ones in iter->entryQ
+ *
+ * RETURNS:
+ *    status:
+ */
+typedef status_t
+    (*getcb_iter_fn_t) (ses_cb_t *scb,
+                        getcb_iter_t *iter);
+
 #ifdef __cplusplus
 }  /* end extern 'C' */
 #endif
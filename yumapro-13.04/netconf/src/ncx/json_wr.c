@@ -35,6 +35,8 @@ date         init     comment
 
 #include "procdefs.h"
 #include "dlq.h"
+#include "getcb.h"
+#include "log.h"
 #include "ncx.h"
 #include "ncx_num.h"
 #include "ncxconst.h"
@@ -59,6 +61,21 @@ date         init     comment
 #endif
 
 
+/********************************************************************
+*                                                                   *
+*                       F O R W A R D   D E C L S                   *
+*                                                                   *
+*********************************************************************/
+
+static status_t write_virtual_list (ses_cb_t *scb,
+                                    xml_msg_hdr_t *msg,
+                                    val_value_t *val,
+                                    int32  indent,
+                                    val_nodetest_fn_t testfn,
+                                    boolean isfirstchild,
+                                    boolean *anyout);
+
+
 /********************************************************************
 * FUNCTION write_json_string_value
 * 
@@ -114,8 +131,7 @@ static void
     if (!force_no_name && obj_is_leaf(out->obj)) {
         ses_putchar(scb, '"');
         ses_putjstr(scb, out->name, -1);
-        ses_putchar(scb, '"');
-        ses_putchar(scb, ':');
+        ses_putstr(scb, (const xmlChar *)"\":");
     }
 
     switch (out->btyp) {
@@ -174,6 +190,187 @@ static void
 } /* write_terminal_node */
 
 
+/********************************************************************
+* FUNCTION write_object_val
+* 
+* Write a complex value as a JSON object
+* The value has already been checked with val_get_value
+*
+* INPUTS:
+*   scb == session control block
+*   msg == xml_msg_hdr_t in progress
+*   out == complex value to write
+*   indent == indent amount for the object start
+*   testcb == callback function to use, NULL if not used
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    write_object_val (ses_cb_t *scb,
+                      xml_msg_hdr_t *msg,
+                      val_value_t *out,
+                      int32  indent,
+                      val_nodetest_fn_t testfn)
+{
+    int32 indent_amount = ses_message_indent_count(scb);
+    status_t res = NO_ERR;
+
+    ses_putchar(scb, '{');
+    indent = ses_new_indent_count(TRUE, indent, indent_amount);
+
+    val_value_t *lastch = NULL;
+    val_value_t *nextch = NULL;
+        
+    val_value_t *chval = val_get_first_child(out); 
+    for (; chval != NULL && res == NO_ERR; chval = nextch) {
+
+        boolean firstchild = (lastch == NULL);
+        nextch = val_get_next_child(chval);
+
+        if (val_is_virtual_list(chval)) {
+            /* the whole list is written as 1 array */
+            boolean anyout = FALSE;
+            res = write_virtual_list(scb, msg, chval, indent, testfn,
+                                     firstchild, &anyout);
+            if (anyout) {
+                lastch = chval;
+            }
+            continue;
+        }
+
+        /* JSON ignores XML namespaces, so foo:a and bar:a
+         * are both encoded in the same array
+         */
+        boolean firstsibling = 
+            (!lastch || xml_strcmp(lastch->name, chval->name));
+
+        lastch = chval;
+
+        res = json_wr_max_check_val(scb, msg, val_get_nsid(out),
+                                    chval, indent, testfn,
+                                    FALSE, FALSE, firstchild,
+                                    firstsibling, FALSE, FALSE, FALSE);
+                                       
+        if (res == ERR_NCX_SKIPPED) {
+            res = NO_ERR;
+        }
+    }
+
+    indent = ses_new_indent_count(FALSE, indent, indent_amount);
+    ses_indent(scb, indent);
+    ses_putchar(scb, '}');
+
+    return res;
+
+} /* write_object_val */
+
+
+/********************************************************************
+* FUNCTION write_virtual_list
+* 
+* Write all the entries of a virtual list place-holder as
+* one JSON array.  The entries are requested from the list
+* iterator callback in batches, and each batch is freed
+* after it is written.  Nothing is written if there are
+* no entries to output
+*
+* INPUTS:
+*   scb == session control block
+*   msg == xml_msg_hdr_t in progress
+*   val == virtual list place-holder to write
+*   indent == indent amount for the array name
+*   testcb == callback function to use, NULL if not used
+*   isfirstchild == TRUE if this is the first child of the parent
+*   anyout == address of return output flag
+*
+* OUTPUTS:
+*   *anyout == TRUE if the array was written
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    write_virtual_list (ses_cb_t *scb,
+                        xml_msg_hdr_t *msg,
+                        val_value_t *val,
+                        int32  indent,
+                        val_nodetest_fn_t testfn,
+                        boolean isfirstchild,
+                        boolean *anyout)
+{
+    getcb_iter_t iter;
+    status_t res = NO_ERR;
+    int32 indent_amount = ses_message_indent_count(scb);
+    int32 entry_indent = ses_new_indent_count(TRUE, indent, indent_amount);
+
+    *anyout = FALSE;
+
+    val_init_list_iter(&iter, val, VAL_VIRTUAL_LIST_BATCH);
+
+    while (res == NO_ERR && !iter.done) {
+        res = val_get_list_batch(scb, &iter);
+        if (res != NO_ERR) {
+            log_error("\nError: get virtual list '%s' failed (%s)",
+                      val->name, get_error_string(res));
+        }
+
+        val_value_t *entry = (val_value_t *)dlq_firstEntry(&iter.entryQ);
+        for (; entry != NULL && res == NO_ERR;
+             entry = (val_value_t *)dlq_nextEntry(entry)) {
+
+            boolean malloced = FALSE;
+            val_value_t *out =
+                val_get_value(scb, msg, entry, testfn, TRUE, &malloced, 
+                              &res);
+            if (!out || res != NO_ERR) {
+                if (res == ERR_NCX_SKIPPED) {
+                    res = NO_ERR;
+                }
+                if (malloced) {
+                    val_free_value(out);
+                }
+                continue;
+            }
+
+            if (*anyout) {
+                ses_putchar(scb, ',');
+            } else {
+                /* start the array before the first entry */
+                if (!isfirstchild) {
+                    ses_putchar(scb, ',');
+                }
+                ses_indent(scb, indent);
+                ses_putchar(scb, '"');
+                ses_putjstr(scb, val->name, -1);
+                ses_putstr(scb, (const xmlChar *)"\":");
+                if (indent > 0) {
+                    ses_putchar(scb, ' ');
+                }
+                ses_putchar(scb, '[');
+                *anyout = TRUE;
+            }
+
+            ses_indent(scb, entry_indent);
+            res = write_object_val(scb, msg, out, entry_indent, testfn);
+
+            if (malloced) {
+                val_free_value(out);
+            }
+        }
+    }
+
+    if (*anyout) {
+        ses_indent(scb, indent);
+        ses_putchar(scb, ']');
+    }
+
+    val_clean_list_iter(&iter);
+    return res;
+
+} /* write_virtual_list */
+
+
 /************  E X T E R N A L    F U N C T I O N S    **************/
 
 
@@ -214,8 +411,7 @@ void
         ses_putchar(scb, ':');
     }
     ses_putstr(scb, name);
-    ses_putchar(scb, '"');
-    ses_putchar(scb, ':');
+    ses_putstr(scb, (const xmlChar *)"\":");
     if (indent >= 0) {
         ses_putchar(scb, ' ');
     }
@@ -268,8 +464,7 @@ void
         ses_putchar(scb, ':');
     }
     ses_putstr(scb, name);
-    ses_putchar(scb, '"');
-    ses_putchar(scb, ':');
+    ses_putstr(scb, (const xmlChar *)"\":");
     if (indent >= 0) {
         ses_putchar(scb, ' ');
     }
@@ -401,8 +596,7 @@ void
     if (namestr) {
         ses_putchar(scb, '"');
         ses_putjstr(scb, namestr, -1);
-        ses_putchar(scb, '"');
-        ses_putchar(scb, ':');
+        ses_putstr(scb, (const xmlChar *)"\":");
     }
 
     switch (btyp) {
@@ -537,8 +731,7 @@ status_t
             ses_indent(scb, indent);
             ses_putchar(scb, '"');
             ses_putjstr(scb, out->name, -1);
-            ses_putchar(scb, '"');
-            ses_putchar(scb, ':');
+            ses_putstr(scb, (const xmlChar *)"\":");
             if (indent > 0) {
                 ses_putchar(scb, ' ');
             }
@@ -555,39 +748,7 @@ status_t
         if (is_array_obj && out_is_simple) {
             write_terminal_node(scb, out, force_array_obj);
         } else {
-            ses_putchar(scb, '{');
-            indent = ses_new_indent_count(TRUE, indent, indent_amount);
-
-            val_value_t *lastch = NULL;
-            val_value_t *nextch = NULL;
-        
-            val_value_t *chval = val_get_first_child(out); 
-            for (; chval != NULL && res == NO_ERR; chval = nextch) {
-
-                /* JSON ignores XML namespaces, so foo:a and bar:a
-                 * are both encoded in the same array
-                 */
-
-                boolean firstchild = (lastch == NULL);
-                boolean firstsibling = 
-                    (!lastch || xml_strcmp(lastch->name, chval->name));
-
-                lastch = chval;
-                nextch = val_get_next_child(chval);
-
-                res = json_wr_max_check_val(scb, msg, val_get_nsid(out),
-                                            chval, indent, testfn,
-                                            FALSE, FALSE, firstchild,
-                                            firstsibling, FALSE, FALSE, FALSE);
-                                       
-                if (res == ERR_NCX_SKIPPED) {
-                    res = NO_ERR;
-                }
-            }
-
-            indent = ses_new_indent_count(FALSE, indent, indent_amount);
-            ses_indent(scb, indent);
-            ses_putchar(scb, '}');
+            res = write_object_val(scb, msg, out, indent, testfn);
         }
 
         if (is_array_obj) {
@@ -43,6 +43,7 @@ date         init     comment
      
 #include "procdefs.h"
 #include "log.h"
+#include "log_async.h"
 #include "log_syslog.h"
 #include "log_vendor.h"
 #include "log_vendor_extern.h"
@@ -135,6 +136,7 @@ static boolean cfg_log_stderr=FALSE;            // --log-stderr
 static boolean cfg_log_suppress_ctrl=FALSE;     // --log-suppress-ctrl
 static boolean cfg_log_syslog=FALSE;            // --log-syslog
 static boolean cfg_log_vendor=FALSE;            // --log-vendor
+static boolean cfg_log_async=FALSE;             // --log-async
 
 /* For use by malloc/free checking in ncx_cleanup() */
 static boolean log_syslog_bfr_allocated=FALSE;
@@ -202,6 +204,8 @@ logfn_send_t          logfn_send      = NULL;  /* Send to syslog stream */
 void
     log_cleanup (void)
 {
+    log_async_stop();
+    cfg_log_async = FALSE;
     cfg_log_syslog = FALSE;
     cfg_log_vendor = FALSE;
     log_init_logfn_va(); /* Reset vectors to default */
@@ -363,6 +367,39 @@ log_set_vendor (void)
     }
 }
 
+/* --log-async --log-async-overflow --log-rotate-size */
+status_t
+    log_set_async (boolean block, uint32 rotsize)
+{
+    status_t res;
+
+    res = log_async_start((block) ? LOG_ASYNC_OVERFLOW_BLOCK :
+                          LOG_ASYNC_OVERFLOW_DROP, rotsize);
+    if (res == NO_ERR) {
+        cfg_log_async = TRUE;
+        log_init_logfn_va(); /* Send syslog/vendor output via writer */
+    }
+    return res;
+}
+
+/* --log-async */
+boolean
+    log_get_async (void)
+{
+    return cfg_log_async;
+}
+
+/* Stop --log-async; the writer thread is not copied by fork() */
+void
+    log_clear_async (void)
+{
+    log_async_stop();
+    if (cfg_log_async) {
+        cfg_log_async = FALSE;
+        log_init_logfn_va(); /* Send syslog/vendor output directly */
+    }
+}
+
 /* --log-backtrace-stream="logfile" */
 void
     log_set_backtrace_logfile (void)
@@ -710,6 +747,7 @@ status_t
     if (!logfile) {
         return ERR_FIL_OPEN;
     }
+    log_async_set_logfile(logfile, fname);
 
     use_tstamps = tstamps;
     if (tstamps) {
@@ -748,6 +786,10 @@ void
         return;
     }
 
+    /* write any queued output before the file is closed */
+    log_async_drain();
+    log_async_set_logfile(NULL, NULL);
+
     if (use_tstamps) {
         tstamp_datetime(buff);
         fprintf(logfile, "\n*** log close at %s ***\n", buff);
@@ -838,6 +880,8 @@ void
         return;
     }
 
+    log_async_drain();
+
     if (use_audit_tstamps) {
         tstamp_datetime(buff);
         fprintf(auditlogfile, "\n*** audit log close at %s ***\n", buff);
@@ -943,6 +987,7 @@ void
         return;
     }
 
+    log_async_drain();
     fclose(altlogfile);
     altlogfile = NULL;
 
@@ -965,6 +1010,10 @@ void
 static void 
     log_flush_internal (void)
 {
+    if (log_async_active()) {
+        return;  /* the writer thread flushes after each batch */
+    }
+
     fflush(stdout);
     fflush(stderr);
 
@@ -1026,6 +1075,12 @@ void
 	logfn_send      = log_syslog_send;
     }
 
+    /* Queue syslog/vendor output for the --log-async writer thread */
+    if (cfg_log_async && logfn_send) {
+        log_async_set_sendfn(logfn_send);
+        logfn_send = log_async_send;
+    }
+
 } /* log_init_logfn_va */
 
 /********************************************************************
@@ -1093,6 +1148,54 @@ static FILE *
 }
 
 
+/********************************************************************
+* FUNCTION log_vprintf_out
+*
+*   Write formatted output to a log stream file
+*   The text is queued for the writer thread if --log-async
+*   is in effect; otherwise it is written and flushed now
+*
+* INPUTS:
+*   out == FILE to write to
+*   fstr == format string in printf format
+*   args == arguments for printf format string
+*
+*********************************************************************/
+static void
+    log_vprintf_out (FILE *out, const char *fstr, va_list args)
+{
+    if (log_async_active()) {
+        log_async_vprintf(out, fstr, args);
+    } else {
+        vfprintf(out, fstr, args);
+        fflush(out);
+    }
+}
+
+
+/********************************************************************
+* FUNCTION log_printf_out
+*
+*   Write formatted output to a log stream file
+*   See log_vprintf_out
+*
+* INPUTS:
+*   out == FILE to write to
+*   fstr == format string in printf format
+*   ... == arguments for printf format string
+*
+*********************************************************************/
+static void
+    log_printf_out (FILE *out, const char *fstr, ...)
+{
+    va_list args;
+
+    va_start(args, fstr);
+    log_vprintf_out(out, fstr, args);
+    va_end(args);
+}
+
+
 /********************************************************************
 * FUNCTION log_common_internal
 *
@@ -1140,8 +1243,7 @@ static void
 	 * Note that all backtrace output comes here since it never wants
 	 * a custom header pre-pended.
 	 */
-	vfprintf(out, fstr, args);
-	fflush(out);
+	log_vprintf_out(out, fstr, args);
 
     } else {
 
@@ -1195,12 +1297,11 @@ static void
 	    } else {
 	        tstamp_datetime(tstampbuff);
 	    }
-	    fprintf(out, "\n[%s] [%s] ", tstampbuff,
-		    log_get_debug_level_string(sub_level));
+	    log_printf_out(out, "\n[%s] [%s] ", tstampbuff,
+			   log_get_debug_level_string(sub_level));
 	}
 
-	vfprintf(out, local_fstr, args);
-	fflush(out);
+	log_vprintf_out(out, local_fstr, args);
     }
 
 }  /* log_common_internal */
@@ -1579,8 +1680,7 @@ void
     }
 
     va_start(args, fstr);
-    vprintf(fstr, args);
-    fflush(stdout);
+    log_vprintf_out(stdout, fstr, args);
     va_end(args);
 
 }  /* log_stdout */
@@ -1649,8 +1749,7 @@ void
     va_start(args, fstr);
 
     if (auditlogfile != NULL) {
-        vfprintf(auditlogfile, fstr, args);
-        fflush(auditlogfile);
+        log_vprintf_out(auditlogfile, fstr, args);
     }
 
     va_end(args);
@@ -1676,8 +1775,7 @@ void
     va_start(args, fstr);
 
     if (altlogfile) {
-        vfprintf(altlogfile, fstr, args);
-        fflush(altlogfile);
+        log_vprintf_out(altlogfile, fstr, args);
     }
 
     va_end(args);
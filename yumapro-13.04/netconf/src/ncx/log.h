@@ -341,6 +341,21 @@ extern void
 extern void
     log_set_vendor (void);
 
+/* --log-async --log-async-overflow --log-rotate-size
+ * Start the writer thread; block == TRUE for overflow 'block'
+ * rotsize == logfile rotation size in bytes; 0 for none
+ */
+extern status_t
+    log_set_async (boolean block, uint32 rotsize);
+/* --log-async */
+extern boolean
+    log_get_async (void);
+/* Write the queued records, stop the writer thread and
+ * go back to synchronous logging; needed before fork()
+ */
+extern void
+    log_clear_async (void);
+
 /* --log-backtrace-stream="logfile" */
 extern void
     log_set_backtrace_logfile (void);
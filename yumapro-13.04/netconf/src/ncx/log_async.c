@@ -0,0 +1,875 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: log_async.c
+
+    Asynchronous logging backend (--log-async)
+
+    The thread that generates log output formats the text and
+    copies it into a ring of fixed size records.  A writer thread
+    takes the records off the ring, writes them to the FILE or
+    syslog/vendor send function stored in the record, and flushes
+    the output files only when the ring is empty, so bursts of log
+    output are written in large batches.
+
+    Ring positions are free-running uint32 counters.  The record
+    for position P is ring[P % LOG_ASYNC_NUM_RECS] and its seq
+    field is:
+       P                     : free, may be reserved for position P
+       P + 1                 : filled in, ready for the writer
+       P + LOG_ASYNC_NUM_RECS: written, free for the next lap
+
+    The logfile can be rotated by the writer thread when it
+    has grown by --log-rotate-size bytes.  The current file is
+    renamed to <logfile>.1 and a new file is opened in its place.
+
+    Plain malloc and free are used in this file because the buffers
+    live until log_close, after the ncx_cleanup malloc/free check.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "procdefs.h"
+#include "log.h"
+#include "log_async.h"
+#include "log_util.h"
+#include "status.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+#define LOG_ASYNC_REC_MASK      (LOG_ASYNC_NUM_RECS - 1)
+
+/* max message size */
+#define LOG_ASYNC_MAX_MSG_LEN   (LOG_ASYNC_MAX_MSG_RECS * LOG_ASYNC_TEXT_LEN)
+
+/* size of the stack buffer used to format most messages */
+#define LOG_ASYNC_FMT_BUFF_LEN  1024
+
+/* max time the writer thread sleeps before checking the ring */
+#define LOG_ASYNC_WAIT_NSECS    10000000
+
+/* time to sleep while waiting for the writer thread */
+#define LOG_ASYNC_POLL_USECS    200
+
+/* max distinct FILEs with unflushed output */
+#define LOG_ASYNC_MAX_DIRTY     8
+
+/* record kinds */
+#define LOG_ASYNC_KIND_FILE     1
+#define LOG_ASYNC_KIND_SEND     2
+
+
+/********************************************************************
+*                                                                   *
+*                           T Y P E S                               *
+*                                                                   *
+*********************************************************************/
+
+/* one ring record */
+typedef struct log_async_rec_t_ {
+    uint32        seq;           /* see file header */
+    uint16        len;           /* bytes used in text */
+    uint8         kind;          /* LOG_ASYNC_KIND_xxx */
+    uint8         more;          /* 1 if the msg continues in next rec */
+    uint8         app;           /* log_debug_app_t for KIND_SEND */
+    uint8         level;         /* log_debug_t for KIND_SEND */
+    FILE         *fp;            /* output file for KIND_FILE */
+    char          text[LOG_ASYNC_TEXT_LEN];
+} log_async_rec_t;
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static boolean               async_active = FALSE;
+
+static log_async_overflow_t  overflow_policy = LOG_ASYNC_OVERFLOW_BLOCK;
+
+static log_async_rec_t      *ring = NULL;
+
+/* next position to reserve; updated by the producers */
+static uint32                ring_tail;
+
+/* next position to write; only used by the writer thread */
+static uint32                ring_head;
+
+/* all records before this position are written and flushed */
+static uint32                flushed_pos;
+
+/* number of messages dropped when the ring was full */
+static uint32                dropped_cnt;
+
+/* 1 if the writer thread is sleeping on wake_cond */
+static int                   writer_waiting;
+
+/* 1 when log_async_stop wants the writer thread to exit */
+static int                   stop_request;
+
+static pthread_t             writer_thread;
+static pthread_mutex_t       wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t        wake_cond = PTHREAD_COND_INITIALIZER;
+
+/* syslog or vendor send function for KIND_SEND records */
+static logfn_send_t          real_sendfn = NULL;
+
+/* writer thread buffer to reassemble KIND_SEND messages */
+static char                 *msgbuff = NULL;
+static uint32                msglen;
+
+/* logfile rotation; rot_fname is malloced */
+static uint32                rotate_size;
+static FILE                 *rot_fp = NULL;
+static char                 *rot_fname = NULL;
+static uint32                rot_bytes;
+
+
+/********************************************************************
+* FUNCTION wake_writer
+*
+* Signal the writer thread if it is sleeping
+*
+*********************************************************************/
+static void
+    wake_writer (void)
+{
+    if (__atomic_load_n(&writer_waiting, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&wake_lock);
+        pthread_cond_signal(&wake_cond);
+        pthread_mutex_unlock(&wake_lock);
+    }
+
+}  /* wake_writer */
+
+
+/********************************************************************
+* FUNCTION poll_sleep
+*
+* Sleep a short time while waiting for the writer thread
+*
+*********************************************************************/
+static void
+    poll_sleep (void)
+{
+    struct timespec  ts;
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = LOG_ASYNC_POLL_USECS * 1000;
+    (void)nanosleep(&ts, NULL);
+
+}  /* poll_sleep */
+
+
+/********************************************************************
+* FUNCTION reserve_recs
+*
+* Reserve consecutive ring records for one message
+*
+* The writer frees records in order, so if the last record
+* of the run is free then all the records before it are free too
+*
+* INPUTS:
+*   numrecs == number of records needed
+*   pos == address of return start position
+*
+* OUTPUTS:
+*   *pos == position of the first reserved record
+*
+* RETURNS:
+*   TRUE if the records were reserved
+*   FALSE if the ring is full and the message was dropped
+*********************************************************************/
+static boolean
+    reserve_recs (uint32 numrecs,
+                  uint32 *pos)
+{
+    log_async_rec_t  *last;
+    uint32            tail;
+    int32             diff;
+
+    tail = __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+    for (;;) {
+        last = &ring[(tail + numrecs - 1) & LOG_ASYNC_REC_MASK];
+        diff = (int32)(__atomic_load_n(&last->seq, __ATOMIC_ACQUIRE) -
+                       (tail + numrecs - 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring_tail, &tail,
+                                            tail + numrecs, FALSE,
+                                            __ATOMIC_ACQ_REL,
+                                            __ATOMIC_RELAXED)) {
+                *pos = tail;
+                return TRUE;
+            }
+            /* tail reloaded by the failed CAS */
+        } else if (diff < 0) {
+            /* ring is full */
+            if (overflow_policy == LOG_ASYNC_OVERFLOW_DROP) {
+                __atomic_add_fetch(&dropped_cnt, 1, __ATOMIC_RELAXED);
+                return FALSE;
+            }
+            wake_writer();
+            poll_sleep();
+            tail = __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+        } else {
+            /* another producer reserved this record */
+            tail = __atomic_load_n(&ring_tail, __ATOMIC_RELAXED);
+        }
+    }
+    /*NOTREACHED*/
+
+}  /* reserve_recs */
+
+
+/********************************************************************
+* FUNCTION enqueue_text
+*
+* Copy one message into the ring
+*
+* INPUTS:
+*   kind == LOG_ASYNC_KIND_xxx
+*   fp == output file for KIND_FILE
+*   app == application for KIND_SEND
+*   level == log level for KIND_SEND
+*   text == message text
+*   len == length of text; truncated to LOG_ASYNC_MAX_MSG_LEN
+*
+*********************************************************************/
+static void
+    enqueue_text (uint8 kind,
+                  FILE *fp,
+                  log_debug_app_t app,
+                  log_debug_t level,
+                  const char *text,
+                  uint32 len)
+{
+    log_async_rec_t  *rec;
+    uint32            numrecs, pos, i, chunk;
+
+    if (len == 0) {
+        return;
+    }
+    if (len > LOG_ASYNC_MAX_MSG_LEN) {
+        len = LOG_ASYNC_MAX_MSG_LEN;
+    }
+
+    numrecs = (len + LOG_ASYNC_TEXT_LEN - 1) / LOG_ASYNC_TEXT_LEN;
+    if (!reserve_recs(numrecs, &pos)) {
+        return;
+    }
+
+    for (i = 0; i < numrecs; i++) {
+        rec = &ring[(pos + i) & LOG_ASYNC_REC_MASK];
+        chunk = min(len, LOG_ASYNC_TEXT_LEN);
+        memcpy(rec->text, text, chunk);
+        rec->len = (uint16)chunk;
+        rec->kind = kind;
+        rec->more = (i + 1 < numrecs) ? 1 : 0;
+        rec->app = (uint8)app;
+        rec->level = (uint8)level;
+        rec->fp = fp;
+        text += chunk;
+        len -= chunk;
+        __atomic_store_n(&rec->seq, pos + i + 1, __ATOMIC_RELEASE);
+    }
+
+    wake_writer();
+
+}  /* enqueue_text */
+
+
+/********************************************************************
+* FUNCTION rotate_logfile
+*
+* Rename the logfile to <logfile>.1 and start a new logfile
+* The new file is dup2-ed onto the same fd, so the FILE
+* used by log.c stays valid even if the open fails
+*
+*********************************************************************/
+static void
+    rotate_logfile (void)
+{
+    char    *oldname;
+    size_t   len;
+    int      fd;
+
+    rot_bytes = 0;
+
+    len = strlen(rot_fname);
+    oldname = malloc(len + 3);
+    if (oldname == NULL) {
+        return;
+    }
+    snprintf(oldname, len + 3, "%s.1", rot_fname);
+
+    fflush(rot_fp);
+    if (rename(rot_fname, oldname) == 0) {
+        fd = open(rot_fname, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if (fd >= 0) {
+            (void)dup2(fd, fileno(rot_fp));
+            close(fd);
+        }
+    }
+    free(oldname);
+
+}  /* rotate_logfile */
+
+
+/********************************************************************
+* FUNCTION add_dirty
+*
+* Remember a FILE that needs to be flushed
+*
+* INPUTS:
+*   dirty == array of FILEs with unflushed output
+*   dirtycnt == address of number of entries in dirty
+*   fp == FILE to add
+*
+*********************************************************************/
+static void
+    add_dirty (FILE **dirty,
+               uint32 *dirtycnt,
+               FILE *fp)
+{
+    uint32  i;
+
+    for (i = 0; i < *dirtycnt; i++) {
+        if (dirty[i] == fp) {
+            return;
+        }
+    }
+    if (*dirtycnt < LOG_ASYNC_MAX_DIRTY) {
+        dirty[(*dirtycnt)++] = fp;
+    } else {
+        fflush(fp);
+    }
+
+}  /* add_dirty */
+
+
+/********************************************************************
+* FUNCTION write_rec
+*
+* Write the text in one record
+*
+* INPUTS:
+*   rec == record to write
+*   dirty == array of FILEs with unflushed output
+*   dirtycnt == address of number of entries in dirty
+*
+*********************************************************************/
+static void
+    write_rec (log_async_rec_t *rec,
+               FILE **dirty,
+               uint32 *dirtycnt)
+{
+    if (rec->kind == LOG_ASYNC_KIND_FILE) {
+        fwrite(rec->text, 1, rec->len, rec->fp);
+        add_dirty(dirty, dirtycnt, rec->fp);
+        if (rec->fp == rot_fp && rotate_size) {
+            rot_bytes += rec->len;
+            if (rot_bytes >= rotate_size && !rec->more) {
+                rotate_logfile();
+            }
+        }
+        return;
+    }
+
+    /* KIND_SEND: reassemble the message */
+    memcpy(&msgbuff[msglen], rec->text, rec->len);
+    msglen += rec->len;
+    if (!rec->more) {
+        msgbuff[msglen] = 0;
+        if (real_sendfn) {
+            (*real_sendfn)((log_debug_app_t)rec->app,
+                           (log_debug_t)rec->level, "%s", msgbuff);
+        }
+        msglen = 0;
+    }
+
+}  /* write_rec */
+
+
+/********************************************************************
+* FUNCTION report_dropped
+*
+* Write a note about dropped messages before the next message
+*
+* INPUTS:
+*   rec == first record of the next message
+*   reported == address of the dropped count already reported
+*
+*********************************************************************/
+static void
+    report_dropped (log_async_rec_t *rec,
+                    uint32 *reported)
+{
+    uint32  dropped;
+
+    dropped = __atomic_load_n(&dropped_cnt, __ATOMIC_RELAXED);
+    if (dropped == *reported) {
+        return;
+    }
+
+    if (rec->kind == LOG_ASYNC_KIND_FILE) {
+        fprintf(rec->fp, "\n[log-async: %u messages dropped]",
+                dropped - *reported);
+    } else if (real_sendfn) {
+        (*real_sendfn)((log_debug_app_t)rec->app, LOG_DEBUG_WARN,
+                       "log-async: %u messages dropped",
+                       dropped - *reported);
+    }
+    *reported = dropped;
+
+}  /* report_dropped */
+
+
+/********************************************************************
+* FUNCTION writer_main
+*
+* Writer thread main loop
+*
+* INPUTS:
+*   arg == not used
+*
+* RETURNS:
+*   NULL
+*********************************************************************/
+static void *
+    writer_main (void *arg)
+{
+    log_async_rec_t  *rec;
+    FILE             *dirty[LOG_ASYNC_MAX_DIRTY];
+    uint32            dirtycnt, i, reported;
+    boolean           inmsg;
+    struct timespec   ts;
+    sigset_t          sigmask;
+
+    (void)arg;
+
+    /* all signals are handled by the main thread */
+    sigfillset(&sigmask);
+    pthread_sigmask(SIG_BLOCK, &sigmask, NULL);
+
+    dirtycnt = 0;
+    reported = 0;
+    inmsg = FALSE;
+
+    for (;;) {
+        rec = &ring[ring_head & LOG_ASYNC_REC_MASK];
+        if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) == ring_head + 1) {
+            if (!inmsg) {
+                report_dropped(rec, &reported);
+            }
+            write_rec(rec, dirty, &dirtycnt);
+            inmsg = (rec->more) ? TRUE : FALSE;
+            __atomic_store_n(&rec->seq, ring_head + LOG_ASYNC_NUM_RECS,
+                             __ATOMIC_RELEASE);
+            ring_head++;
+            continue;
+        }
+
+        /* ring is empty; flush the batch */
+        for (i = 0; i < dirtycnt; i++) {
+            fflush(dirty[i]);
+        }
+        dirtycnt = 0;
+        __atomic_store_n(&flushed_pos, ring_head, __ATOMIC_RELEASE);
+
+        if (__atomic_load_n(&stop_request, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) == ring_head) {
+            break;
+        }
+
+        pthread_mutex_lock(&wake_lock);
+        __atomic_store_n(&writer_waiting, 1, __ATOMIC_RELEASE);
+        if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != ring_head + 1 &&
+            !__atomic_load_n(&stop_request, __ATOMIC_ACQUIRE)) {
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += LOG_ASYNC_WAIT_NSECS;
+            if (ts.tv_nsec >= 1000000000) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000;
+            }
+            (void)pthread_cond_timedwait(&wake_cond, &wake_lock, &ts);
+        }
+        __atomic_store_n(&writer_waiting, 0, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&wake_lock);
+    }
+
+    return NULL;
+
+}  /* writer_main */
+
+
+/********************************************************************
+* FUNCTION stop_atexit
+*
+* atexit handler to write the queued records if the
+* program exits without calling log_cleanup
+*
+*********************************************************************/
+static void
+    stop_atexit (void)
+{
+    log_async_stop();
+
+}  /* stop_atexit */
+
+
+/************* E X T E R N A L    F U N C T I O N S ***************/
+
+
+/********************************************************************
+* FUNCTION log_async_start
+*
+*   Create the record ring and start the writer thread
+*   Does nothing if the writer thread is already running
+*
+* INPUTS:
+*   overflow == overflow policy to use when the ring is full
+*   rotsize == rotate the logfile when it has grown by
+*                  this many bytes; 0 to never rotate
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    log_async_start (log_async_overflow_t overflow,
+                     uint32 rotsize)
+{
+    static boolean  atexit_done = FALSE;
+    uint32          i;
+
+    if (async_active) {
+        return NO_ERR;
+    }
+
+    ring = malloc(LOG_ASYNC_NUM_RECS * sizeof(log_async_rec_t));
+    if (ring == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    msgbuff = malloc(LOG_ASYNC_MAX_MSG_LEN + 1);
+    if (msgbuff == NULL) {
+        free(ring);
+        ring = NULL;
+        return ERR_INTERNAL_MEM;
+    }
+
+    memset(ring, 0x0, LOG_ASYNC_NUM_RECS * sizeof(log_async_rec_t));
+    for (i = 0; i < LOG_ASYNC_NUM_RECS; i++) {
+        ring[i].seq = i;
+    }
+    ring_tail = 0;
+    ring_head = 0;
+    flushed_pos = 0;
+    dropped_cnt = 0;
+    msglen = 0;
+    writer_waiting = 0;
+    stop_request = 0;
+    rot_bytes = 0;
+    overflow_policy = (overflow == LOG_ASYNC_OVERFLOW_NONE) ?
+        LOG_ASYNC_OVERFLOW_BLOCK : overflow;
+    rotate_size = rotsize;
+
+    if (pthread_create(&writer_thread, NULL, writer_main, NULL) != 0) {
+        free(msgbuff);
+        msgbuff = NULL;
+        free(ring);
+        ring = NULL;
+        return ERR_NCX_OPERATION_FAILED;
+    }
+
+    async_active = TRUE;
+    if (!atexit_done) {
+        atexit(stop_atexit);
+        atexit_done = TRUE;
+    }
+    return NO_ERR;
+
+}  /* log_async_start */
+
+
+/********************************************************************
+* FUNCTION log_async_stop
+*
+*   Write all queued records, stop the writer thread
+*   and free the record ring
+*   Does nothing if the writer thread is not running
+*
+*********************************************************************/
+void
+    log_async_stop (void)
+{
+    uint32  dropped;
+
+    if (!async_active) {
+        return;
+    }
+
+    __atomic_store_n(&stop_request, 1, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&wake_lock);
+    pthread_cond_signal(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+    pthread_join(writer_thread, NULL);
+
+    async_active = FALSE;
+
+    /* messages dropped after the last record was written */
+    dropped = __atomic_load_n(&dropped_cnt, __ATOMIC_RELAXED);
+    if (dropped && rot_fp) {
+        fprintf(rot_fp, "\n[log-async: %u messages dropped in total]",
+                dropped);
+    }
+
+    free(msgbuff);
+    msgbuff = NULL;
+    free(ring);
+    ring = NULL;
+
+}  /* log_async_stop */
+
+
+/********************************************************************
+* FUNCTION log_async_active
+*
+*   Check if log output is being queued for the writer thread
+*
+* RETURNS:
+*   TRUE if the writer thread is running; FALSE if not
+*********************************************************************/
+boolean
+    log_async_active (void)
+{
+    return async_active;
+
+}  /* log_async_active */
+
+
+/********************************************************************
+* FUNCTION log_async_drain
+*
+*   Wait until the writer thread has written and flushed
+*   all the records queued so far
+*   Must be called before a FILE used in a queued record is closed
+*
+*********************************************************************/
+void
+    log_async_drain (void)
+{
+    uint32  target;
+
+    if (!async_active) {
+        return;
+    }
+
+    target = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+    while ((int32)(__atomic_load_n(&flushed_pos, __ATOMIC_ACQUIRE) -
+                   target) < 0) {
+        pthread_mutex_lock(&wake_lock);
+        pthread_cond_signal(&wake_cond);
+        pthread_mutex_unlock(&wake_lock);
+        poll_sleep();
+    }
+
+}  /* log_async_drain */
+
+
+/********************************************************************
+* FUNCTION log_async_set_logfile
+*
+*   Set the logfile that is checked for rotation
+*   Must be called with fp == NULL after log_async_drain
+*   and before the logfile is closed
+*
+* INPUTS:
+*   fp == open logfile; NULL to clear
+*   fname == filespec of the logfile; NULL to clear
+*
+*********************************************************************/
+void
+    log_async_set_logfile (FILE *fp,
+                           const char *fname)
+{
+    if (rot_fname) {
+        free(rot_fname);
+        rot_fname = NULL;
+    }
+    rot_fp = NULL;
+    rot_bytes = 0;
+
+    if (fp && fname) {
+        rot_fname = malloc(strlen(fname) + 1);
+        if (rot_fname) {
+            strcpy(rot_fname, fname);
+            rot_fp = fp;
+        }
+    }
+
+}  /* log_async_set_logfile */
+
+
+/********************************************************************
+* FUNCTION log_async_vprintf
+*
+*   Queue formatted text to be written to a FILE
+*   Text longer than 1 ring message is queued in several parts
+*
+* INPUTS:
+*   fp == FILE to write the text to
+*   fstr == format string in printf format
+*   args == arguments for the format string
+*
+*********************************************************************/
+void
+    log_async_vprintf (FILE *fp,
+                       const char *fstr,
+                       va_list args)
+{
+    char     buff[LOG_ASYNC_FMT_BUFF_LEN];
+    char    *bigbuff, *str;
+    va_list  args_copy;
+    int      len;
+    uint32   chunk;
+
+    va_copy(args_copy, args);
+    len = vsnprintf(buff, sizeof(buff), fstr, args_copy);
+    va_end(args_copy);
+
+    if (len < 0) {
+        return;
+    }
+
+    if (len < (int)sizeof(buff)) {
+        enqueue_text(LOG_ASYNC_KIND_FILE, fp, LOG_DEBUG_APP_NONE,
+                     LOG_DEBUG_NONE, buff, (uint32)len);
+        return;
+    }
+
+    bigbuff = malloc((uint32)len + 1);
+    if (bigbuff == NULL) {
+        return;
+    }
+    va_copy(args_copy, args);
+    (void)vsnprintf(bigbuff, (size_t)len + 1, fstr, args_copy);
+    va_end(args_copy);
+
+    /* a FILE message is written as a byte stream, so text that
+     * does not fit in 1 ring message is queued in parts
+     */
+    for (str = bigbuff; len > 0; str += chunk, len -= (int)chunk) {
+        chunk = min((uint32)len, LOG_ASYNC_MAX_MSG_LEN);
+        enqueue_text(LOG_ASYNC_KIND_FILE, fp, LOG_DEBUG_APP_NONE,
+                     LOG_DEBUG_NONE, str, chunk);
+    }
+    free(bigbuff);
+
+}  /* log_async_vprintf */
+
+
+/********************************************************************
+* FUNCTION log_async_send
+*
+*   logfn_send_t function used for syslog and vendor output
+*   while --log-async is in effect
+*   The message is queued and passed to the real send function
+*   (saved with log_async_set_sendfn) by the writer thread
+*
+* INPUTS:
+*   app == YumaPro application
+*   level == YumaPro log message level
+*   fstr == format string in printf format
+*   ... == arguments for the format string
+*
+*********************************************************************/
+void
+    log_async_send (log_debug_app_t app,
+                    log_debug_t level,
+                    const char *fstr, ...)
+{
+    char     buff[SYSLOG_BUF_TOTAL_SIZE];
+    va_list  args;
+    int      len;
+
+    /* log_util always sends a single "%s" argument */
+    va_start(args, fstr);
+    len = vsnprintf(buff, sizeof(buff), fstr, args);
+    va_end(args);
+
+    if (len < 0) {
+        return;
+    }
+    if (len >= (int)sizeof(buff)) {
+        len = (int)sizeof(buff) - 1;
+    }
+
+    if (async_active) {
+        enqueue_text(LOG_ASYNC_KIND_SEND, NULL, app, level,
+                     buff, (uint32)len);
+    } else if (real_sendfn) {
+        (*real_sendfn)(app, level, "%s", buff);
+    }
+
+}  /* log_async_send */
+
+
+/********************************************************************
+* FUNCTION log_async_set_sendfn
+*
+*   Set the syslog or vendor send function used by the writer thread
+*
+* INPUTS:
+*   sendfn == real send function; NULL if none
+*
+*********************************************************************/
+void
+    log_async_set_sendfn (logfn_send_t sendfn)
+{
+    log_async_drain();
+    real_sendfn = sendfn;
+
+}  /* log_async_set_sendfn */
+
+
+/********************************************************************
+* FUNCTION log_async_get_dropped
+*
+*   Get the number of messages dropped because the ring was full
+*
+* RETURNS:
+*   dropped message count
+*********************************************************************/
+uint32
+    log_async_get_dropped (void)
+{
+    return __atomic_load_n(&dropped_cnt, __ATOMIC_RELAXED);
+
+}  /* log_async_get_dropped */
+
+
+/* END file log_async.c */
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_log_async
+#define _H_log_async
+/*  FILE: log_async.h
+*********************************************************************
+*								    *
+*			 P U R P O S E				    *
+*								    *
+*********************************************************************
+
+    Asynchronous logging backend (--log-async)
+
+    Formatted log text is queued in a fixed size ring of records
+    and written by a background thread, so the thread producing
+    the log output never blocks on file or syslog I/O.
+
+    The ring is a bounded multi-producer, single-consumer queue.
+    Producers reserve records with an atomic compare-and-swap
+    on the tail position; each record has a sequence number that
+    tells the writer thread when it has been filled in.
+    A message longer than one record uses consecutive records,
+    reserved in one step so other producers cannot split it.
+
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "procdefs.h"
+#include "log.h"
+#include "status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+*								    *
+*			 C O N S T A N T S			    *
+*								    *
+*********************************************************************/
+
+/* number of records in the ring; must be a power of 2 */
+#define LOG_ASYNC_NUM_RECS     4096
+
+/* bytes of text in one record */
+#define LOG_ASYNC_TEXT_LEN     240
+
+/* max records used by one message; longer text is truncated */
+#define LOG_ASYNC_MAX_MSG_RECS 256
+
+/********************************************************************
+*                                                                   *
+*                            T Y P E S                              *
+*                                                                   *
+*********************************************************************/
+
+/* what to do when the ring is full */
+typedef enum log_async_overflow_t_ {
+    LOG_ASYNC_OVERFLOW_NONE,
+    LOG_ASYNC_OVERFLOW_DROP,      /* discard the record and count it */
+    LOG_ASYNC_OVERFLOW_BLOCK      /* wait for the writer thread */
+} log_async_overflow_t;
+
+/********************************************************************
+*								    *
+*			F U N C T I O N S			    *
+*								    *
+*********************************************************************/
+
+
+/********************************************************************
+* FUNCTION log_async_start
+*
+*   Create the record ring and start the writer thread
+*   Does nothing if the writer thread is already running
+*
+* INPUTS:
+*   overflow == overflow policy to use when the ring is full
+*   rotsize == rotate the logfile when it has grown by
+*                  this many bytes; 0 to never rotate
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    log_async_start (log_async_overflow_t overflow,
+                     uint32 rotsize);
+
+
+/********************************************************************
+* FUNCTION log_async_stop
+*
+*   Write all queued records, stop the writer thread
+*   and free the record ring
+*   Does nothing if the writer thread is not running
+*
+*********************************************************************/
+extern void
+    log_async_stop (void);
+
+
+/********************************************************************
+* FUNCTION log_async_active
+*
+*   Check if log output is being queued for the writer thread
+*
+* RETURNS:
+*   TRUE if the writer thread is running; FALSE if not
+*********************************************************************/
+extern boolean
+    log_async_active (void);
+
+
+/********************************************************************
+* FUNCTION log_async_drain
+*
+*   Wait until the writer thread has written and flushed
+*   all the records queued so far
+*   Must be called before a FILE used in a queued record is closed
+*
+*********************************************************************/
+extern void
+    log_async_drain (void);
+
+
+/********************************************************************
+* FUNCTION log_async_set_logfile
+*
+*   Set the logfile that is checked for rotation
+*   Must be called with fp == NULL after log_async_drain
+*   and before the logfile is closed
+*
+* INPUTS:
+*   fp == open logfile; NULL to clear
+*   fname == filespec of the logfile; NULL to clear
+*
+*********************************************************************/
+extern void
+    log_async_set_logfile (FILE *fp,
+                           const char *fname);
+
+
+/********************************************************************
+* FUNCTION log_async_vprintf
+*
+*   Queue formatted text to be written to a FILE
+*   Text longer than 1 ring message is queued in several parts
+*
+* INPUTS:
+*   fp == FILE to write the text to
+*   fstr == format string in printf format
+*   args == arguments for the format string
+*
+*********************************************************************/
+extern void
+    log_async_vprintf (FILE *fp,
+                       const char *fstr,
+                       va_list args);
+
+
+/********************************************************************
+* FUNCTION log_async_send
+*
+*   logfn_send_t function used for syslog and vendor output
+*   while --log-async is in effect
+*   The message is queued and passed to the real send function
+*   (saved with log_async_set_sendfn) by the writer thread
+*
+* INPUTS:
+*   app == YumaPro application
+*   level == YumaPro log message level
+*   fstr == format string in printf format
+*   ... == arguments for the format string
+*
+*********************************************************************/
+extern void
+    log_async_send (log_debug_app_t app,
+                    log_debug_t level,
+                    const char *fstr, ...)
+                    __attribute__ ((format (printf, 3, 4)));
+
+
+/********************************************************************
+* FUNCTION log_async_set_sendfn
+*
+*   Set the syslog or vendor send function used by the writer thread
+*
+* INPUTS:
+*   sendfn == real send function; NULL if none
+*
+*********************************************************************/
+extern void
+    log_async_set_sendfn (logfn_send_t sendfn);
+
+
+/********************************************************************
+* FUNCTION log_async_get_dropped
+*
+*   Get the number of messages dropped because the ring was full
+*
+* RETURNS:
+*   dropped message count
+*********************************************************************/
+extern uint32
+    log_async_get_dropped (void);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif	    /* _H_log_async */
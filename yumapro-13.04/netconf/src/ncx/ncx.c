@@ -223,6 +223,12 @@ static dlq_hdr_t     warnoffQ;
  */
 static dlq_hdr_t   *temp_modQ;
 
+/* generation number for the module object indexes;
+ * changed each time a module is parsed since a deviation
+ * can remove top-level objects from other modules
+ */
+static uint32        objindex_gen;
+
 /* default diplay mode in all programs except yangcli,
  * which uses a more complex schem for diplay-mode
  */
@@ -554,6 +560,10 @@ static void
 
     ncx_clean_list(&mod->devmodlist);
 
+    if (mod->objindex) {
+        m__free(mod->objindex);
+    }
+
     m__free(mod);
 
 }  /* free_module */
@@ -599,12 +609,15 @@ static void
  *   log-level
  *   log
  *   log-append
+ *   log-async
+ *   log-async-overflow
  *   log-backtrace
  *   log-backtrace-detail
  *   log-backtrace-level
  *   log-backtrace-stream
  *   log-header
  *   log-mirroring
+ *   log-rotate-size
  *   log-stderr
  *   log-suppress-ctrl
  *   log-syslog
@@ -626,6 +639,8 @@ static status_t
     char            *logfilename;
     log_debug_t      loglevel;
     boolean          logappend;
+    boolean          logasync_block;
+    uint32           logrotate_size;
     uint             level_mask;
     status_t         res;
     ncx_num_t        testnum;
@@ -688,6 +703,28 @@ static status_t
         }
     }
 
+    /* create bootstrap parm: log-async */
+    if (res == NO_ERR) {
+        parm = cli_new_empty_rawparm(NCX_EL_LOGASYNC);
+        if (parm) {
+            dlq_enque(parm, &parmQ);
+        } else {
+	    log_error("\nError: malloc failed during %s", __FUNCTION__);
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
+    /* create bootstrap parm: log-async-overflow */
+    if (res == NO_ERR) {
+        parm = cli_new_rawparm(NCX_EL_LOGASYNCOVERFLOW, FALSE);
+        if (parm) {
+            dlq_enque(parm, &parmQ);
+        } else {
+	    log_error("\nError: malloc failed during %s", __FUNCTION__);
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
     /* create bootstrap parm: log-backtrace */
     if (res == NO_ERR) {
         parm = cli_new_rawparm(NCX_EL_LOGBACKTRACE, FALSE);
@@ -754,6 +791,17 @@ static status_t
         }
     }
 
+    /* create bootstrap parm: log-rotate-size */
+    if (res == NO_ERR) {
+        parm = cli_new_rawparm(NCX_EL_LOGROTATESIZE, FALSE);
+        if (parm) {
+            dlq_enque(parm, &parmQ);
+        } else {
+	    log_error("\nError: malloc failed during %s", __FUNCTION__);
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
     /* create bootstrap parm: log-stderr */
     if (res == NO_ERR) {
         parm = cli_new_empty_rawparm(NCX_EL_LOGSTDERR);
@@ -1122,6 +1170,72 @@ static status_t
 	}
     }
 
+    /* --log-async-overflow=<block | drop> */
+    logasync_block = TRUE;
+    if (res == NO_ERR) {
+        parm = cli_find_rawparm(NCX_EL_LOGASYNCOVERFLOW, &parmQ);
+        if (parm && parm->count) {
+            if (parm->count > 1) {
+                log_error("\nError: Only one log-async-overflow "
+                          "parameter allowed");
+                res = ERR_NCX_DUP_ENTRY;
+            } else if (parm->value && !strcmp(parm->value, "block")) {
+                logasync_block = TRUE;
+            } else if (parm->value && !strcmp(parm->value, "drop")) {
+                logasync_block = FALSE;
+            } else {
+                log_error("\nError: invalid value for "
+                          "'log-async-overflow' parameter");
+                res = ERR_NCX_INVALID_VALUE;
+            }
+        }
+    }
+
+    /* --log-rotate-size=<kbytes> */
+    logrotate_size = 0;
+    if (res == NO_ERR) {
+        parm = cli_find_rawparm(NCX_EL_LOGROTATESIZE, &parmQ);
+        if (parm && parm->count) {
+            if (parm->count > 1) {
+                log_error("\nError: Only one log-rotate-size "
+                          "parameter allowed");
+                res = ERR_NCX_DUP_ENTRY;
+            } else if (parm->value) {
+                ncx_init_num(&testnum);
+                res = ncx_decode_num((const xmlChar *)parm->value,
+                                     NCX_BT_UINT32, &testnum);
+                if (res == NO_ERR && testnum.u > NCX_MAX_UINT / 1024) {
+                    res = ERR_NCX_NOT_IN_RANGE;
+                }
+                if (res == NO_ERR) {
+                    logrotate_size = testnum.u * 1024;
+                } else {
+                    log_error("\nError: Invalid log-rotate-size");
+                }
+            } else {
+                log_error("\nError: no value entered for "
+                          "'log-rotate-size' parameter");
+                res = ERR_NCX_INVALID_VALUE;
+            }
+        }
+    }
+
+    /* --log-async */
+    if (res == NO_ERR) {
+        parm = cli_find_rawparm(NCX_EL_LOGASYNC, &parmQ);
+        if (parm && parm->value) {
+            log_error("\nError: log-async is empty parameter");
+            res = ERR_NCX_INVALID_VALUE;
+        }
+	if (parm && parm->count) {
+	    res = log_set_async(logasync_block, logrotate_size);
+            if (res != NO_ERR) {
+                log_error("\nError: start log-async writer failed (%s)",
+                          get_error_string(res));
+            }
+	}
+    }
+
     /* --modpath=<pathspeclist> */
     if (res == NO_ERR) {
         parm = cli_find_rawparm(NCX_EL_MODPATH, &parmQ);
@@ -3329,6 +3443,208 @@ obj_template_t *
 
 // ----------------------------------------------------------------------------!
 
+/**
+ * \fn index_object_que
+ * \brief Add the named objects in a datadefQ to a module object index
+ * \param que Q of obj_template_t to add
+ * \param objindex index to fill in; NULL to just count the objects
+ * \param count address of object count to update
+ * \return none
+ */
+static void
+    index_object_que (dlq_hdr_t *que,
+                      obj_template_t **objindex,
+                      uint32 *count)
+{
+    obj_template_t *obj;
+    for (obj = (obj_template_t *)dlq_firstEntry(que);
+         obj != NULL;
+         obj = (obj_template_t *)dlq_nextEntry(obj)) {
+
+        /* the if-feature state can change after the index is
+         * built so obj_is_enabled is checked by the caller
+         */
+        if (!obj_has_name(obj) || obj_is_cli(obj) || obj_is_abstract(obj)) {
+            continue;
+        }
+        if (objindex) {
+            objindex[*count] = obj;
+        }
+        (*count)++;
+    }
+
+}  /* index_object_que */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn index_modules
+ * \brief Add the named objects in a module and its submodules
+ * to a module object index
+ * \param mod module to index
+ * \param objindex index to fill in; NULL to just count the objects
+ * \param count address of object count to update
+ * \return none
+ */
+static void
+    index_modules (ncx_module_t *mod,
+                   obj_template_t **objindex,
+                   uint32 *count)
+{
+    index_object_que(&mod->datadefQ, objindex, count);
+
+    if (!mod->ismod) {
+        return;
+    }
+
+    yang_node_t    *node;
+    for (node = (yang_node_t *)dlq_firstEntry(&mod->allincQ);
+         node != NULL;
+         node = (yang_node_t *)dlq_nextEntry(node)) {
+        if (node->submod) {
+            index_object_que(&node->submod->datadefQ, objindex, count);
+        }
+    }
+
+}  /* index_modules */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn compare_index_objects
+ * \brief qsort compare function for the module object index
+ * \param a pointer to first obj_template_t pointer
+ * \param b pointer to second obj_template_t pointer
+ * \return compare result for the object names
+ */
+static int
+    compare_index_objects (const void *a,
+                           const void *b)
+{
+    const obj_template_t *obja = *(obj_template_t * const *)a;
+    const obj_template_t *objb = *(obj_template_t * const *)b;
+
+    return xml_strcmp(obj_get_name(obja), obj_get_name(objb));
+
+}  /* compare_index_objects */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn ncx_find_object_prefix
+ * \brief Find the top-level objects in a module whose names
+ * start with the specified string
+ * \details Uses an index of the objects sorted by name, so
+ * the cost does not depend on the number of objects.  The index is
+ * built the first time it is needed, and again after any module
+ * is parsed.  The matching objects are returned in name order and
+ * may be disabled; the caller must check obj_is_enabled
+ * \param mod module to search
+ * \param prefix start of the object name to match
+ * \param prefixlen number of bytes of prefix to match; 0 to match all
+ * \param count address of return number of matching objects
+ * \param res address of return status
+ * \return pointer to the first matching entry in the index
+ * or NULL if none found or some error (check *res)
+ */
+obj_template_t **
+    ncx_find_object_prefix (ncx_module_t *mod,
+                            const xmlChar *prefix,
+                            uint32 prefixlen,
+                            uint32 *count,
+                            status_t *res)
+{
+    assert ( mod && " param mod is NULL" );
+    assert ( count && " param count is NULL" );
+    assert ( res && " param res is NULL" );
+
+    *count = 0;
+    *res = NO_ERR;
+
+    if (mod->objindex == NULL || mod->objindex_gen != objindex_gen) {
+        if (mod->objindex) {
+            m__free(mod->objindex);
+            mod->objindex = NULL;
+        }
+        mod->objindex_count = 0;
+
+        uint32 total = 0;
+        index_modules(mod, NULL, &total);
+
+        /* always malloc at least 1 entry so the index is
+         * not rebuilt each time for an empty module
+         */
+        mod->objindex = (obj_template_t **)
+            m__getMem((total + 1) * sizeof(obj_template_t *));
+        if (mod->objindex == NULL) {
+            *res = ERR_INTERNAL_MEM;
+            return NULL;
+        }
+
+        index_modules(mod, mod->objindex, &mod->objindex_count);
+        qsort(mod->objindex, mod->objindex_count,
+              sizeof(obj_template_t *), compare_index_objects);
+        mod->objindex_gen = objindex_gen;
+    }
+
+    obj_template_t **objindex = mod->objindex;
+    uint32 lo = 0;
+    uint32 hi = mod->objindex_count;
+
+    if (prefixlen == 0) {
+        *count = hi;
+        return (hi) ? objindex : NULL;
+    }
+
+    /* find the first name >= prefix */
+    while (lo < hi) {
+        uint32 mid = lo + (hi - lo) / 2;
+        if (xml_strncmp(obj_get_name(objindex[mid]), 
+                        prefix, prefixlen) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    uint32 first = lo;
+
+    /* find the first name past the prefix */
+    hi = mod->objindex_count;
+    while (lo < hi) {
+        uint32 mid = lo + (hi - lo) / 2;
+        if (xml_strncmp(obj_get_name(objindex[mid]), 
+                        prefix, prefixlen) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *count = lo - first;
+    return (*count) ? &objindex[first] : NULL;
+
+}  /* ncx_find_object_prefix */
+
+// ----------------------------------------------------------------------------!
+
+/**
+ * \fn ncx_clear_object_indexes
+ * \brief Mark the object indexes for all modules out of date
+ * \details Called when modules are parsed, since top-level
+ * objects can be added or removed.  Each index is rebuilt
+ * the next time it is used
+ * \return none
+ */
+void
+    ncx_clear_object_indexes (void)
+{
+    objindex_gen++;
+
+}  /* ncx_clear_object_indexes */
+
+// ----------------------------------------------------------------------------!
+
 /**
  * \fn ncx_get_first_data_object
  * \brief Get the first database object in the datadefQs 
@@ -820,6 +820,54 @@ extern obj_template_t *
 			 obj_template_t *curobj);
 
 
+/********************************************************************
+* FUNCTION ncx_find_object_prefix
+* 
+* Find the top-level objects in a module whose names
+* start with the specified string
+*
+* Uses an index of the objects sorted by name, which is
+* built the first time it is needed and again after any
+* module is parsed.  The matching objects are returned
+* in name order and may be disabled; the caller must
+* check obj_is_enabled
+*
+* INPUTS:
+*    mod == module to search
+*    prefix == start of the object name to match
+*    prefixlen == number of bytes of prefix to match; 0 to match all
+*    count == address of return number of matching objects
+*    res == address of return status
+*
+* OUTPUTS:
+*    *count == number of matching entries
+*    *res == return status
+*
+* RETURNS:
+*   pointer to the first matching entry in the index
+*   NULL if none found or some error (check *res)
+*********************************************************************/
+extern obj_template_t **
+    ncx_find_object_prefix (ncx_module_t *mod,
+                            const xmlChar *prefix,
+                            uint32 prefixlen,
+                            uint32 *count,
+                            status_t *res);
+
+
+/********************************************************************
+* FUNCTION ncx_clear_object_indexes
+* 
+* Mark the object indexes for all modules out of date
+* Called when modules are parsed, since top-level objects
+* can be added or removed.  Each index is rebuilt the next
+* time it is used
+*
+*********************************************************************/
+extern void
+    ncx_clear_object_indexes (void);
+
+
 /********************************************************************
 * FUNCTION ncx_get_first_data_object
 * 
@@ -0,0 +1,539 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: ncx_trace.c
+
+    Binary hot-path trace buffer
+
+    Each thread that records a trace event gets its own ring of
+    fixed size event records the first time it records one, so
+    recording an event never takes a lock.  The ring keeps the
+    last N events; older events are overwritten.
+
+    The rings are only read by ncx_trace_dump, which writes
+    them in the Chrome trace event format.  The file can be
+    loaded in chrome://tracing or https://ui.perfetto.dev
+
+    Plain malloc and free are used in this file because the
+    rings can be created by any thread.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "procdefs.h"
+#include "log.h"
+#include "ncx_trace.h"
+#include "ncxmod.h"
+#include "status.h"
+#include "xml_util.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+/* file extension added to a trace dump file name */
+#define NCX_TRACE_FILE_EXT      (const xmlChar *)".json"
+
+
+/********************************************************************
+*                                                                   *
+*                            T Y P E S                              *
+*                                                                   *
+*********************************************************************/
+
+/* one trace event */
+typedef struct ncx_trace_rec_t_ {
+    uint64             nsecs;
+    const xmlChar     *name;
+    uint32             sid;
+    uint16             id;
+    uint16             phase;
+} ncx_trace_rec_t;
+
+
+/* the trace event ring for one thread */
+typedef struct ncx_trace_ring_t_ {
+    struct ncx_trace_ring_t_ *next;
+    uint32             tid;
+    uint64             count;       /* events ever recorded */
+    ncx_trace_rec_t    recs[];      /* ring_size records */
+} ncx_trace_ring_t;
+
+
+/* fixed name and category for a tracepoint */
+typedef struct ncx_trace_idinfo_t_ {
+    const char        *name;
+    const char        *cat;
+} ncx_trace_idinfo_t;
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+/* number of records in each ring; 0 if tracing is disabled */
+static uint32                 ring_size;
+
+/* list of all the rings; protected by ring_lock */
+static ncx_trace_ring_t      *ringlist;
+static uint32                 next_tid = 1;
+static pthread_mutex_t        ring_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* ring for the calling thread */
+static __thread ncx_trace_ring_t *myring;
+
+/* set by the signal handler */
+static volatile sig_atomic_t  dump_requested;
+
+/* names indexed by ncx_trace_id_t */
+static const ncx_trace_idinfo_t trace_ids[NCX_TRACE_NUM_IDS] = {
+    { "none", "ncx" },
+    { "ses-accept-input", "ses" },
+    { "top-dispatch", "agt" },
+    { "rpc-dispatch", "agt" },
+    { "edit-phase", "commit" },
+    { "root-check", "commit" },
+    { "sil-callback", "sil" },
+    { "ses-send-buffs", "ses" },
+    { "notification", "not" }
+};
+
+
+/********************************************************************
+* FUNCTION get_nsecs
+*
+* Get the current monotonic time
+*
+* RETURNS:
+*   nano-seconds since some fixed point
+*********************************************************************/
+static uint64
+    get_nsecs (void)
+{
+    struct timeval   tv;
+#ifdef CLOCK_MONOTONIC
+    struct timespec  ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return ((uint64)ts.tv_sec * 1000000000) + (uint64)ts.tv_nsec;
+    }
+#endif
+
+    (void)gettimeofday(&tv, NULL);
+    return ((uint64)tv.tv_sec * 1000000000) +
+        ((uint64)tv.tv_usec * 1000);
+
+}  /* get_nsecs */
+
+
+/********************************************************************
+* FUNCTION new_ring
+*
+* Create the trace ring for the calling thread
+*
+* RETURNS:
+*   pointer to the new ring; NULL if malloc failed
+*********************************************************************/
+static ncx_trace_ring_t *
+    new_ring (void)
+{
+    ncx_trace_ring_t *ring =
+        malloc(sizeof(ncx_trace_ring_t) +
+               (ring_size * sizeof(ncx_trace_rec_t)));
+    if (ring == NULL) {
+        return NULL;
+    }
+    ring->count = 0;
+
+    pthread_mutex_lock(&ring_lock);
+    ring->tid = next_tid++;
+    ring->next = ringlist;
+    ringlist = ring;
+    pthread_mutex_unlock(&ring_lock);
+
+    return ring;
+
+}  /* new_ring */
+
+
+/********************************************************************
+* FUNCTION dump_ring
+*
+* Write the events in one ring to the dump file
+*
+* INPUTS:
+*   fp == open dump file
+*   ring == ring to dump
+*   pid == process ID to use in the events
+*   first == address of first event flag
+*
+* OUTPUTS:
+*   *first set to FALSE if any event written
+*
+* RETURNS:
+*   number of events written
+*********************************************************************/
+static uint64
+    dump_ring (FILE *fp,
+               const ncx_trace_ring_t *ring,
+               uint32 pid,
+               boolean *first)
+{
+    uint64 count = ring->count;
+    uint64 pos = (count > ring_size) ? count - ring_size : 0;
+    uint64 written = 0;
+    uint32 depth = 0;
+
+    for (; pos < count; pos++) {
+        const ncx_trace_rec_t *rec = &ring->recs[pos & (ring_size - 1)];
+        const char *name;
+
+        if (rec->phase == NCX_TRACE_PH_END) {
+            if (depth == 0) {
+                /* the begin event was overwritten */
+                continue;
+            }
+            depth--;
+        } else {
+            depth++;
+        }
+
+        name = (rec->name) ? (const char *)rec->name :
+            trace_ids[rec->id].name;
+
+        fprintf(fp, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\","
+                "\"ts\":%llu.%03u,\"pid\":%u,\"tid\":%u",
+                (*first) ? "" : ",",
+                name,
+                trace_ids[rec->id].cat,
+                (rec->phase == NCX_TRACE_PH_BEGIN) ? 'B' : 'E',
+                (unsigned long long)(rec->nsecs / 1000),
+                (uint32)(rec->nsecs % 1000),
+                pid,
+                ring->tid);
+
+        /* the args of the begin event are used for the slice */
+        if (rec->phase == NCX_TRACE_PH_BEGIN && rec->sid) {
+            fprintf(fp, ",\"args\":{\"sid\":%u}}", rec->sid);
+        } else {
+            fprintf(fp, "}");
+        }
+        *first = FALSE;
+        written++;
+    }
+
+    return written;
+
+}  /* dump_ring */
+
+
+/**************    E X T E R N A L   F U N C T I O N S **********/
+
+
+/********************************************************************
+* FUNCTION ncx_trace_init
+*
+* Set the size of the trace rings and enable tracing
+* Must be called before any events are recorded
+*
+* INPUTS:
+*   size == number of events kept in each ring, rounded up
+*           to a power of 2; 0 to disable tracing
+*********************************************************************/
+void
+    ncx_trace_init (uint32 size)
+{
+    uint32 newsize = 0;
+
+    if (ringlist) {
+        log_warn("\nWarning: trace buffer size already set");
+        return;
+    }
+
+    if (size > NCX_TRACE_MAX_SIZE) {
+        size = NCX_TRACE_MAX_SIZE;
+    }
+    if (size) {
+        newsize = 1;
+        while (newsize < size) {
+            newsize <<= 1;
+        }
+    }
+    ring_size = newsize;
+
+}  /* ncx_trace_init */
+
+
+/********************************************************************
+* FUNCTION ncx_trace_cleanup
+*
+* Disable tracing and free all the trace rings
+* Must be called after all other threads have stopped tracing
+*********************************************************************/
+void
+    ncx_trace_cleanup (void)
+{
+    ncx_trace_ring_t *ring;
+
+    pthread_mutex_lock(&ring_lock);
+    ring_size = 0;
+    while (ringlist) {
+        ring = ringlist;
+        ringlist = ring->next;
+        free(ring);
+    }
+    myring = NULL;
+    pthread_mutex_unlock(&ring_lock);
+
+}  /* ncx_trace_cleanup */
+
+
+/********************************************************************
+* FUNCTION ncx_trace_event
+*
+* Record one trace event in the ring for the calling thread
+* Use the NCX_TRACE_BEGIN and NCX_TRACE_END macros instead
+* of calling this function directly
+*
+* INPUTS:
+*   id == tracepoint ID
+*   phase == begin or end event
+*   sid == session ID for a begin event; 0 if none
+*   name == event name to use instead of the tracepoint name;
+*           NULL to use the tracepoint name
+*           This string is not copied and must not be freed
+*           while the server is running (e.g., an object name)
+*********************************************************************/
+void
+    ncx_trace_event (ncx_trace_id_t id,
+                     ncx_trace_phase_t phase,
+                     uint32 sid,
+                     const xmlChar *name)
+{
+    ncx_trace_ring_t *ring = myring;
+    ncx_trace_rec_t  *rec;
+
+    if (ring_size == 0) {
+        return;
+    }
+
+    if (ring == NULL) {
+        ring = myring = new_ring();
+        if (ring == NULL) {
+            return;
+        }
+    }
+
+    rec = &ring->recs[ring->count & (ring_size - 1)];
+    rec->nsecs = get_nsecs();
+    rec->name = name;
+    rec->sid = sid;
+    rec->id = (uint16)id;
+    rec->phase = (uint16)phase;
+    ring->count++;
+
+}  /* ncx_trace_event */
+
+
+/********************************************************************
+* FUNCTION ncx_trace_enabled
+*
+* Check if trace events are being recorded
+*
+* RETURNS:
+*   TRUE if tracing is enabled; FALSE if not
+*********************************************************************/
+boolean
+    ncx_trace_enabled (void)
+{
+    return (ring_size) ? TRUE : FALSE;
+
+}  /* ncx_trace_enabled */
+
+
+/********************************************************************
+* FUNCTION ncx_trace_request_dump
+*
+* Request a trace dump from a signal handler
+* The dump is done later by the main loop
+*********************************************************************/
+void
+    ncx_trace_request_dump (void)
+{
+    dump_requested = 1;
+
+}  /* ncx_trace_request_dump */
+
+
+/********************************************************************
+* FUNCTION ncx_trace_dump_requested
+*
+* Check and clear the trace dump request flag
+*
+* RETURNS:
+*   TRUE if ncx_trace_request_dump was called since the last check
+*********************************************************************/
+boolean
+    ncx_trace_dump_requested (void)
+{
+    if (dump_requested) {
+        dump_requested = 0;
+        return TRUE;
+    }
+    return FALSE;
+
+}  /* ncx_trace_dump_requested */
+
+
+/********************************************************************
+* FUNCTION ncx_trace_make_filespec
+*
+* Get the filespec to use for a trace dump file
+*
+* INPUTS:
+*   filename == file name without the .json extension;
+*               NULL to use the default name
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == status
+*
+* RETURNS:
+*   malloced filespec; must be freed by the caller with m__free
+*   NULL if some error
+*********************************************************************/
+xmlChar *
+    ncx_trace_make_filespec (const xmlChar *filename,
+                             status_t *res)
+{
+    xmlChar *fname, *filespec, *p;
+
+#ifdef DEBUG
+    if (res == NULL) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return NULL;
+    }
+#endif
+
+    if (filename == NULL) {
+        filename = NCX_TRACE_DEF_FILENAME;
+    }
+
+    fname = m__getMem(xml_strlen(filename) +
+                      xml_strlen(NCX_TRACE_FILE_EXT) + 1);
+    if (fname == NULL) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    p = fname;
+    p += xml_strcpy(p, filename);
+    xml_strcpy(p, NCX_TRACE_FILE_EXT);
+
+    filespec = ncxmod_make_data_filespec(fname, FALSE, res);
+    m__free(fname);
+    return filespec;
+
+}  /* ncx_trace_make_filespec */
+
+
+/********************************************************************
+* FUNCTION ncx_trace_dump
+*
+* Write the events in all the trace rings to a file
+* in Chrome trace event JSON format
+*
+* INPUTS:
+*   filespec == file to write; an existing file is replaced
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    ncx_trace_dump (const xmlChar *filespec)
+{
+    const ncx_trace_ring_t *ring;
+    FILE      *fp;
+    uint64     written = 0, lost = 0;
+    uint32     pid = (uint32)getpid();
+    boolean    first = TRUE;
+
+#ifdef DEBUG
+    if (filespec == NULL) {
+        return SET_ERROR(ERR_INTERNAL_PTR);
+    }
+#endif
+
+    if (ring_size == 0) {
+        return ERR_NCX_OPERATION_NOT_SUPPORTED;
+    }
+
+    fp = fopen((const char *)filespec, "w");
+    if (fp == NULL) {
+        log_error("\nError: open trace dump file '%s' failed",
+                  filespec);
+        return ERR_FIL_OPEN;
+    }
+
+    fprintf(fp, "{\"traceEvents\":[");
+
+    pthread_mutex_lock(&ring_lock);
+    for (ring = ringlist; ring != NULL; ring = ring->next) {
+        fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+                "\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s-%u\"}}",
+                (first) ? "" : ",",
+                pid,
+                ring->tid,
+                (ring->tid == 1) ? "main" : "thread",
+                ring->tid);
+        first = FALSE;
+
+        written += dump_ring(fp, ring, pid, &first);
+        if (ring->count > ring_size) {
+            lost += ring->count - ring_size;
+        }
+    }
+    pthread_mutex_unlock(&ring_lock);
+
+    fprintf(fp, "\n],\n\"displayTimeUnit\":\"ns\",\n"
+            "\"otherData\":{\"events\":%llu,\"overwritten\":%llu}}\n",
+            (unsigned long long)written,
+            (unsigned long long)lost);
+
+    if (fclose(fp) != 0) {
+        return ERR_FIL_WRITE;
+    }
+
+    if (LOGINFO) {
+        log_info("\nWrote %llu trace events to '%s'",
+                 (unsigned long long)written, filespec);
+    }
+    return NO_ERR;
+
+}  /* ncx_trace_dump */
+
+
+/* END file ncx_trace.c */
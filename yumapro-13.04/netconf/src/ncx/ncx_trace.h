@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_ncx_trace
+#define _H_ncx_trace
+/*  FILE: ncx_trace.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+    Binary hot-path trace buffer
+
+    Tracepoints in the session, RPC and commit code record a
+    begin or end event with a monotonic timestamp in a fixed size
+    ring owned by the calling thread.  Nothing is formatted until
+    the rings are dumped to a Chrome trace (JSON) file, so the
+    tracepoints do not change the timing being measured.
+
+    The NCX_TRACE_BEGIN and NCX_TRACE_END macros are empty unless
+    the code is compiled with WITH_TRACE (the default; build with
+    NOTRACE=1 to remove them).
+
+*/
+
+#include <xmlstring.h>
+
+#ifndef _H_procdefs
+#include "procdefs.h"
+#endif
+
+#ifndef _H_status
+#include "status.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+*                                                                   *
+*                         C O N S T A N T S                         *
+*                                                                   *
+*********************************************************************/
+
+/* default number of events kept in each ring */
+#define NCX_TRACE_DEF_SIZE      16384
+
+/* max number of events kept in each ring */
+#define NCX_TRACE_MAX_SIZE      (1024 * 1024)
+
+/* default file name for a trace dump, without the .json extension */
+#define NCX_TRACE_DEF_FILENAME  (const xmlChar *)"netconfd-pro-trace"
+
+
+#ifdef WITH_TRACE
+#define NCX_TRACE_BEGIN(id, sid, name)                          \
+    ncx_trace_event((id), NCX_TRACE_PH_BEGIN, (sid), (name))
+
+#define NCX_TRACE_END(id, name)                                 \
+    ncx_trace_event((id), NCX_TRACE_PH_END, 0, (name))
+#else
+#define NCX_TRACE_BEGIN(id, sid, name)    do { } while (0)
+#define NCX_TRACE_END(id, name)           do { } while (0)
+#endif
+
+/********************************************************************
+*                                                                   *
+*                            T Y P E S                              *
+*                                                                   *
+*********************************************************************/
+
+/* tracepoint IDs; the event name is in the trace_ids table
+ * in ncx_trace.c unless a name is given in the event
+ */
+typedef enum ncx_trace_id_t_ {
+    NCX_TRACE_NONE,
+    NCX_TRACE_SES_INPUT,          /* ses_accept_input */
+    NCX_TRACE_TOP_DISPATCH,       /* agt_top_dispatch_msg */
+    NCX_TRACE_RPC_DISPATCH,       /* agt_rpc_dispatch */
+    NCX_TRACE_EDIT_PHASE,         /* agt_val callback phase */
+    NCX_TRACE_ROOT_CHECK,         /* agt_val_root_check */
+    NCX_TRACE_SIL_CALLBACK,       /* SIL edit callback */
+    NCX_TRACE_SEND_BUFFS,         /* session output write */
+    NCX_TRACE_NOTIF_SEND,         /* notification delivery */
+    NCX_TRACE_NUM_IDS
+} ncx_trace_id_t;
+
+
+/* Chrome trace event phase */
+typedef enum ncx_trace_phase_t_ {
+    NCX_TRACE_PH_BEGIN,
+    NCX_TRACE_PH_END
+} ncx_trace_phase_t;
+
+
+/********************************************************************
+*                                                                   *
+*                        F U N C T I O N S                          *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+* FUNCTION ncx_trace_init
+*
+* Set the size of the trace rings and enable tracing
+* Must be called before any events are recorded
+*
+* INPUTS:
+*   size == number of events kept in each ring, rounded up
+*           to a power of 2; 0 to disable tracing
+*********************************************************************/
+extern void
+    ncx_trace_init (uint32 size);
+
+
+/********************************************************************
+* FUNCTION ncx_trace_cleanup
+*
+* Disable tracing and free all the trace rings
+* Must be called after all other threads have stopped tracing
+*********************************************************************/
+extern void
+    ncx_trace_cleanup (void);
+
+
+/********************************************************************
+* FUNCTION ncx_trace_event
+*
+* Record one trace event in the ring for the calling thread
+* Use the NCX_TRACE_BEGIN and NCX_TRACE_END macros instead
+* of calling this function directly
+*
+* INPUTS:
+*   id == tracepoint ID
+*   phase == begin or end event
+*   sid == session ID for a begin event; 0 if none
+*   name == event name to use instead of the tracepoint name;
+*           NULL to use the tracepoint name
+*           This string is not copied and must not be freed
+*           while the server is running (e.g., an object name)
+*********************************************************************/
+extern void
+    ncx_trace_event (ncx_trace_id_t id,
+                     ncx_trace_phase_t phase,
+                     uint32 sid,
+                     const xmlChar *name);
+
+
+/********************************************************************
+* FUNCTION ncx_trace_enabled
+*
+* Check if trace events are being recorded
+*
+* RETURNS:
+*   TRUE if tracing is enabled; FALSE if not
+*********************************************************************/
+extern boolean
+    ncx_trace_enabled (void);
+
+
+/********************************************************************
+* FUNCTION ncx_trace_request_dump
+*
+* Request a trace dump from a signal handler
+* The dump is done later by the main loop
+*********************************************************************/
+extern void
+    ncx_trace_request_dump (void);
+
+
+/********************************************************************
+* FUNCTION ncx_trace_dump_requested
+*
+* Check and clear the trace dump request flag
+*
+* RETURNS:
+*   TRUE if ncx_trace_request_dump was called since the last check
+*********************************************************************/
+extern boolean
+    ncx_trace_dump_requested (void);
+
+
+/********************************************************************
+* FUNCTION ncx_trace_make_filespec
+*
+* Get the filespec to use for a trace dump file
+*
+* INPUTS:
+*   filename == file name without the .json extension;
+*               NULL to use the default name
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == status
+*
+* RETURNS:
+*   malloced filespec; must be freed by the caller with m__free
+*   NULL if some error
+*********************************************************************/
+extern xmlChar *
+    ncx_trace_make_filespec (const xmlChar *filename,
+                             status_t *res);
+
+
+/********************************************************************
+* FUNCTION ncx_trace_dump
+*
+* Write the events in all the trace rings to a file
+* in Chrome trace event JSON format
+*
+* INPUTS:
+*   filespec == file to write; an existing file is replaced
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    ncx_trace_dump (const xmlChar *filespec);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif	    /* _H_ncx_trace */
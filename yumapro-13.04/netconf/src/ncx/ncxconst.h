@@ -439,6 +439,7 @@ extern "C" {
 #define NCX_EL_APPINFO         (const xmlChar *)"appinfo"
 #define NCX_EL_APPLICATION     (const xmlChar *)"application"
 #define NCX_EL_APPLY           (const xmlChar *)"apply"
+#define NCX_EL_ASYNC_CACHE_REFRESH (const xmlChar *)"async-cache-refresh"
 #define NCX_EL_BACKUP          (const xmlChar *)"backup"
 #define NCX_EL_BAD_ATTRIBUTE   (const xmlChar *)"bad-attribute"
 #define NCX_EL_BAD_ELEMENT     (const xmlChar *)"bad-element"
@@ -450,6 +451,7 @@ extern "C" {
 #define NCX_EL_BRIEF           (const xmlChar *)"brief"
 #define NCX_EL_BYTE            (const xmlChar *)"byte"
 #define NCX_EL_C               (const xmlChar *)"c"
+#define NCX_EL_CACHE_TIMEOUT   (const xmlChar *)"cache-timeout"
 #define NCX_EL_CPP_TEST        (const xmlChar *)"cpp_test"
 #define NCX_EL_CANCEL          (const xmlChar *)"cancel"
 #define NCX_EL_CANCEL_COMMIT   (const xmlChar *)"cancel-commit"
@@ -465,6 +467,7 @@ extern "C" {
 #define NCX_EL_CLI_TEXT_BLOCK  (const xmlChar *)"cli-text-block"
 #define NCX_EL_CLOSE_SESSION   (const xmlChar *)"close-session"
 #define NCX_EL_COMMIT          (const xmlChar *)"commit"
+#define NCX_EL_COMPARE_DATASTORES (const xmlChar *)"compare-datastores"
 #define NCX_EL_COMPLETE        (const xmlChar *)"complete"
 #define NCX_EL_CONDITION       (const xmlChar *)"condition"
 #define NCX_EL_CONFIG          (const xmlChar *)"config"
@@ -504,10 +507,12 @@ extern "C" {
 #define NCX_EL_DEPTH           (const xmlChar *)"depth"
 #define NCX_EL_DESCRIPTION     (const xmlChar *)"description"
 #define NCX_EL_DEVIATION       (const xmlChar *)"deviation"
+#define NCX_EL_DIFFERENCE      (const xmlChar *)"difference"
 #define NCX_EL_DISABLED        (const xmlChar *)"disabled"
 #define NCX_EL_DISCARD_CHANGES (const xmlChar *)"discard-changes"
 #define NCX_EL_DO              (const xmlChar *)"do"
 #define NCX_EL_DOUBLE          (const xmlChar *)"double"
+#define NCX_EL_DUMP_TRACE      (const xmlChar *)"dump-trace"
 #define NCX_EL_DYNAMIC         (const xmlChar *)"dynamic"
 #define NCX_EL_EDIT_CONFIG     (const xmlChar *)"edit-config"
 #define NCX_EL_EDIT_MODEL      (const xmlChar *)"edit-model"
@@ -546,6 +551,7 @@ extern "C" {
 #define NCX_EL_FEATURE_ENABLE (const xmlChar *)"feature-enable"
 #define NCX_EL_FEATURE_DISABLE (const xmlChar *)"feature-disable"
 #define NCX_EL_FILENAME        (const xmlChar *)"filename"
+#define NCX_EL_FILESPEC        (const xmlChar *)"filespec"
 #define NCX_EL_FILTER          (const xmlChar *)"filter"
 #define NCX_EL_FIRST           (const xmlChar *)"first"
 #define NCX_EL_FIRST_NOCASE    (const xmlChar *)"first-nocase"
@@ -556,6 +562,7 @@ extern "C" {
 #define NCX_EL_FULL            (const xmlChar *)"full"
 #define NCX_EL_GET             (const xmlChar *)"get"
 #define NCX_EL_GET_CONFIG      (const xmlChar *)"get-config"
+#define NCX_EL_GET_REFERENCES  (const xmlChar *)"get-references"
 #define NCX_EL_GET_SCHEMA      (const xmlChar *)"get-schema"
 #define NCX_EL_GROUP           (const xmlChar *)"group"
 #define NCX_EL_GROUP_ID        (const xmlChar *)"group-id"
@@ -567,6 +574,7 @@ extern "C" {
 #define NCX_EL_HIDDEN          (const xmlChar *)"hidden"
 #define NCX_EL_HOME            (const xmlChar *)"home"
 #define NCX_EL_HTML            (const xmlChar *)"html"
+#define NCX_EL_IDENTICAL       (const xmlChar *)"identical"
 #define NCX_EL_IDENTIFIER      (const xmlChar *)"identifier"
 #define NCX_EL_IDENTITYREF     (const xmlChar *)"identityref"
 #define NCX_EL_IDLE_TIMEOUT    (const xmlChar *)"idle-timeout"
@@ -601,6 +609,8 @@ extern "C" {
 #define NCX_EL_LOCK_SOURCE     (const xmlChar *)"lock-source"
 #define NCX_EL_LOG             (const xmlChar *)"log"
 #define NCX_EL_LOGAPPEND       (const xmlChar *)"log-append"
+#define NCX_EL_LOGASYNC        (const xmlChar *)"log-async"
+#define NCX_EL_LOGASYNCOVERFLOW (const xmlChar *)"log-async-overflow"
 #define NCX_EL_LOGBACKTRACE    (const xmlChar *)"log-backtrace"
 #define NCX_EL_LOGBT_DETAIL    (const xmlChar *)"log-backtrace-detail"
 #define NCX_EL_LOGBT_LEVEL     (const xmlChar *)"log-backtrace-level"
@@ -608,6 +618,7 @@ extern "C" {
 #define NCX_EL_LOGHEADER       (const xmlChar *)"log-header"
 #define NCX_EL_LOGLEVEL        (const xmlChar *)"log-level"
 #define NCX_EL_LOGMIRRORING    (const xmlChar *)"log-mirroring"
+#define NCX_EL_LOGROTATESIZE   (const xmlChar *)"log-rotate-size"
 #define NCX_EL_LOGSTDERR       (const xmlChar *)"log-stderr"
 #define NCX_EL_LOGSUPPRESSCTRL (const xmlChar *)"log-suppress-ctrl"
 #define NCX_EL_LOGSYSLOG       (const xmlChar *)"log-syslog"
@@ -659,6 +670,7 @@ extern "C" {
 #define NCX_EL_OK_ELEMENT      (const xmlChar *)"ok-element"
 #define NCX_EL_ONE             (const xmlChar *)"one"
 #define NCX_EL_ONE_NOCASE      (const xmlChar *)"one-nocase"
+#define NCX_EL_OPERATION       (const xmlChar *)"operation"
 #define NCX_EL_OPERATIONS      (const xmlChar *)"operations"
 #define NCX_EL_ORDER           (const xmlChar *)"order"
 #define NCX_EL_ORDER_L         (const xmlChar *)"loose"
@@ -689,10 +701,12 @@ extern "C" {
 #define NCX_EL_PROTOCOLS       (const xmlChar *)"protocols"
 #define NCX_EL_QNAME           (const xmlChar *)"qname"
 #define NCX_EL_READ            (const xmlChar *)"read"
+#define NCX_EL_REFERENCE       (const xmlChar *)"reference"
 #define NCX_EL_REMOVE          (const xmlChar *)"remove"
 #define NCX_EL_REPLACE         (const xmlChar *)"replace"
 #define NCX_EL_REPORT_ALL      (const xmlChar *)"report-all"
 #define NCX_EL_REPORT_ALL_TAGGED (const xmlChar *)"report-all-tagged"
+#define NCX_EL_RESET_RPC_STATISTICS (const xmlChar *)"reset-rpc-statistics"
 #define NCX_EL_RESTART         (const xmlChar *)"restart"
 #define NCX_EL_RESTORE         (const xmlChar *)"restore"
 #define NCX_EL_REVISION        (const xmlChar *)"revision"
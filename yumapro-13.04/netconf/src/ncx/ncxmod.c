@@ -6128,6 +6128,8 @@ ncxmod_search_result_t *
     newsr->nslen = sr->nslen;
     newsr->cap = sr->cap;
     newsr->capmatch = sr->capmatch;
+    newsr->fromserver = sr->fromserver;
+    newsr->fromcache = sr->fromcache;
     newsr->ismod = sr->ismod;
 
     return newsr;
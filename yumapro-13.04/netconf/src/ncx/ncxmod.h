@@ -255,6 +255,8 @@ typedef struct ncxmod_search_result_t_ {
     uint32         nslen;         /* length of base part of namespacestr */
     cap_rec_t     *cap;           /* back-ptr to source capability URI */
     boolean        capmatch;      /* set by yangcli; internal use only */
+    boolean        fromserver;    /* set by yangcli; got by <get-schema> */
+    boolean        fromcache;     /* set by yangcli; found in schema cache */
     boolean        ismod;         /* TRUE=module; FALSE=submodule */
 } ncxmod_search_result_t;
 
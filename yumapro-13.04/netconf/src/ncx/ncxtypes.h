@@ -687,6 +687,11 @@ typedef struct ncx_module_t_ {
 
     ncx_list_t        devmodlist;     /* for deviations list */
 
+    /* top-level objects sorted by name; built on demand */
+    struct obj_template_t_ **objindex;
+    uint32            objindex_count;
+    uint32            objindex_gen;
+
 } ncx_module_t;
 
 
@@ -43,6 +43,7 @@ date         init     comment
 #include "ncx_appinfo.h"
 #include "ncx_feature.h"
 #include "ncx_list.h"
+#include "ncx_num.h"
 #include "obj.h"
 #include "tk.h"
 #include "typ.h"
@@ -70,6 +71,10 @@ date         init     comment
 *                         V A R I A B L E S                         *
 *                                                                   *
 *********************************************************************/
+/* Q of obj_vcache_t for all the objects with a vcache struct */
+static dlq_hdr_t vcacheQ;
+static boolean vcacheQ_init = FALSE;
+
 static obj_case_t * new_case (boolean isreal); 
 static void free_case (obj_case_t *cas);
 static obj_template_t* find_template( dlq_hdr_t*que, const xmlChar *modname, 
@@ -4060,6 +4065,12 @@ void obj_free_template( obj_template_t *obj )
         ncx_free_backptr(ptr);
     }
 
+    if (obj->vcache) {
+        dlq_remove(obj->vcache);
+        m__free(obj->vcache);
+        obj->vcache = NULL;
+    }
+
     switch (obj->objtype) {
     case OBJ_TYP_CONTAINER:
         free_container(obj->def.container, obj->flags);
@@ -11883,6 +11894,46 @@ void
         obj->flags |= OBJ_FL_SIL_DELETE_CHILDREN_FIRST;
     }
 
+    /* the cache policy is only kept for the expanded data node;
+     * not the copy of the object in a grouping or augment-stmt */
+    boolean in_template = FALSE;
+    const obj_template_t *testobj;
+    for (testobj = obj; testobj && !in_template; testobj = testobj->parent) {
+        if (testobj->grp || testobj->objtype == OBJ_TYP_AUGMENT) {
+            in_template = TRUE;
+        }
+    }
+
+    if (!in_template && !obj_is_config(obj)) {
+        const ncx_appinfo_t *appinfo = 
+            ncx_find_const_appinfo(appinfoQ, NCX_PREFIX, 
+                                   NCX_EL_CACHE_TIMEOUT);
+        boolean async_refresh = 
+            (ncx_find_const_appinfo(appinfoQ, NCX_PREFIX, 
+                                    NCX_EL_ASYNC_CACHE_REFRESH)) 
+            ? TRUE : FALSE;
+        if (appinfo || async_refresh) {
+            uint32 timeout = NCX_DEF_VTIMEOUT;
+            const xmlChar *str = 
+                (appinfo) ? ncx_get_appinfo_value(appinfo) : NULL;
+            if (str) {
+                ncx_num_t num;
+                ncx_init_num(&num);
+                status_t res = ncx_convert_num(str, NCX_NF_DEC, 
+                                               NCX_BT_UINT32, &num);
+                if (res != NO_ERR) {
+                    log_error("\nError: invalid ncx:cache-timeout "
+                              "value '%s' (%s)",
+                              str, get_error_string(res));
+                } else {
+                    timeout = num.u;
+                }
+                ncx_clean_num(NCX_BT_UINT32, &num);
+            }
+            (void)obj_set_cache_timeout(obj, timeout, async_refresh);
+        }
+    }
+
     /* yuma-nacm.yang extensions */
     if (ncx_find_const_appinfo(appinfoQ, NACM_PREFIX, NCX_EL_SECURE)) {
         obj->flags |= OBJ_FL_SECURE;
@@ -12271,6 +12322,101 @@ boolean obj_is_sil_delete_children_first (const obj_template_t *obj)
     return (obj->flags & OBJ_FL_SIL_DELETE_CHILDREN_FIRST) ? TRUE : FALSE;
 }   /* obj_is_sil_delete_children_first */
 
+
+/********************************************************************
+ * Get the virtual value cache struct for an object
+ *
+ * \param obj the obj_template to check
+ * \param create TRUE to create the struct if it does not exist
+ * \return pointer to the vcache struct; NULL if none or malloc failed
+ *********************************************************************/
+obj_vcache_t * obj_get_vcache (obj_template_t *obj,
+                               boolean create)
+{
+    assert( obj && "obj is NULL!" );
+
+    if (obj->vcache || !create) {
+        return obj->vcache;
+    }
+
+    obj_vcache_t *vcache = m__getObj(obj_vcache_t);
+    if (vcache == NULL) {
+        return NULL;
+    }
+    memset(vcache, 0x0, sizeof(obj_vcache_t));
+    vcache->obj = obj;
+
+    if (!vcacheQ_init) {
+        dlq_createSQue(&vcacheQ);
+        vcacheQ_init = TRUE;
+    }
+    dlq_enque(vcache, &vcacheQ);
+
+    obj->vcache = vcache;
+    return vcache;
+
+}   /* obj_get_vcache */
+
+
+/********************************************************************
+ * Set the virtual value cache policy for an object
+ * Overrides the ncx:cache-timeout and ncx:async-cache-refresh
+ * extensions and the --virtual-timeout default
+ *
+ * \param obj the obj_template to set
+ * \param timeout number of seconds a cached value is fresh;
+ *              0 to call the get callback for every retrieval
+ * \param async_refresh TRUE to serve the stale value and refresh
+ *                    it after the reply is sent
+ * \return status
+ *********************************************************************/
+status_t obj_set_cache_timeout (obj_template_t *obj,
+                                uint32 timeout,
+                                boolean async_refresh)
+{
+    assert( obj && "obj is NULL!" );
+
+    obj_vcache_t *vcache = obj_get_vcache(obj, TRUE);
+    if (vcache == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    vcache->timeout_set = TRUE;
+    vcache->timeout = timeout;
+    vcache->async_refresh = async_refresh;
+    return NO_ERR;
+
+}   /* obj_set_cache_timeout */
+
+
+/********************************************************************
+ * Get the first vcache struct in use
+ *
+ * \return pointer to the first vcache struct; NULL if none
+ *********************************************************************/
+obj_vcache_t * obj_get_first_vcache (void)
+{
+    if (!vcacheQ_init) {
+        return NULL;
+    }
+    return (obj_vcache_t *)dlq_firstEntry(&vcacheQ);
+
+}   /* obj_get_first_vcache */
+
+
+/********************************************************************
+ * Get the next vcache struct in use
+ *
+ * \param vcache the current vcache struct
+ * \return pointer to the next vcache struct; NULL if none
+ *********************************************************************/
+obj_vcache_t * obj_get_next_vcache (obj_vcache_t *vcache)
+{
+    assert( vcache && "vcache is NULL!" );
+    return (obj_vcache_t *)dlq_nextEntry(vcache);
+
+}   /* obj_get_next_vcache */
+
 /********************************************************************
  * Add a child object to the specified complex node
  *
@@ -445,6 +445,27 @@ typedef struct obj_iffeature_ptr_t_ {
 } obj_iffeature_ptr_t;
 
 
+/* virtual value cache policy and statistics for 1 object
+ * The policy is set by the ncx:cache-timeout and
+ * ncx:async-cache-refresh extensions or obj_set_cache_timeout.
+ * The statistics are kept for any object used as a virtual node
+ */
+typedef struct obj_vcache_t_ {
+    dlq_hdr_t               qhdr;
+    struct obj_template_t_ *obj;            /* back-ptr */
+    boolean                 timeout_set;    /* use this timeout */
+    uint32                  timeout;        /* seconds; 0 == no cache */
+    boolean                 async_refresh;  /* serve stale value */
+    uint32                  hits;
+    uint32                  misses;
+    uint32                  stale_hits;     /* async refresh started */
+    uint32                  errors;
+    uint32                  lastcost;       /* usec for last getcb */
+    uint32                  maxcost;        /* usec for slowest getcb */
+    uint64                  totalcost;      /* usec for all getcbs */
+} obj_vcache_t;
+
+
 /* One YANG data-def-stmt */
 typedef struct obj_template_t_ {
     dlq_hdr_t      qhdr;
@@ -472,6 +493,12 @@ typedef struct obj_template_t_ {
     /* cbset is agt_rpc_cbset_t for RPC or agt_cb_fnset_t for OBJ */
     void                   *cbset;   
 
+    /* itercb is getcb_iter_fn_t for a virtual state data list */
+    void                   *itercb;
+
+    /* vcache is the virtual value cache policy and stats */
+    obj_vcache_t           *vcache;
+
     /* object module and namespace ID 
      * assigned at runtime
      * this can be changed over and over as a
@@ -4012,6 +4039,73 @@ extern boolean
     obj_is_sil_delete_children_first (const obj_template_t *obj);
 
 
+/********************************************************************
+* FUNCTION obj_get_vcache
+*
+* Get the virtual value cache struct for an object
+*
+* INPUTS:
+*   obj == obj_template to check
+*   create == TRUE to create the struct if it does not exist
+*
+* RETURNS:
+*   pointer to the vcache struct; NULL if none or malloc failed
+*********************************************************************/
+extern obj_vcache_t *
+    obj_get_vcache (obj_template_t *obj,
+                    boolean create);
+
+
+/********************************************************************
+* FUNCTION obj_set_cache_timeout
+*
+* Set the virtual value cache policy for an object
+* Overrides the ncx:cache-timeout and ncx:async-cache-refresh
+* extensions and the --virtual-timeout default
+*
+* INPUTS:
+*   obj == obj_template to set
+*   timeout == number of seconds a cached value is fresh;
+*              0 to call the get callback for every retrieval
+*   async_refresh == TRUE to serve the stale value and refresh
+*                    it after the reply is sent
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    obj_set_cache_timeout (obj_template_t *obj,
+                           uint32 timeout,
+                           boolean async_refresh);
+
+
+/********************************************************************
+* FUNCTION obj_get_first_vcache
+*
+* Get the first vcache struct in use
+*
+* RETURNS:
+*   pointer to the first vcache struct; NULL if none
+*********************************************************************/
+extern obj_vcache_t *
+    obj_get_first_vcache (void);
+
+
+/********************************************************************
+* FUNCTION obj_get_next_vcache
+*
+* Get the next vcache struct in use
+*
+* INPUTS:
+*   vcache == current vcache struct
+*
+* RETURNS:
+*   pointer to the next vcache struct; NULL if none
+*********************************************************************/
+extern obj_vcache_t *
+    obj_get_next_vcache (obj_vcache_t *vcache);
+
+
 /********************************************************************
  * Add a child object to the specified complex node
  *
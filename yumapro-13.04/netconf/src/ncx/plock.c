@@ -40,6 +40,10 @@ date         init     comment
 #include  "procdefs.h"
 #endif
 
+#ifndef _H_bobhash
+#include  "bobhash.h"
+#endif
+
 #ifndef _H_cfg
 #include  "cfg.h"
 #endif
@@ -48,6 +52,10 @@ date         init     comment
 #include  "log.h"
 #endif
 
+#ifndef _H_ncx
+#include  "ncx.h"
+#endif
+
 #ifndef _H_plock
 #include  "plock.h"
 #endif
@@ -72,6 +80,10 @@ date         init     comment
 #include  "val.h"
 #endif
 
+#ifndef _H_val_util
+#include  "val_util.h"
+#endif
+
 #ifndef _H_xmlns
 #include  "xmlns.h"
 #endif
@@ -98,12 +110,48 @@ date         init     comment
 #define PLOCK_DEBUG 1
 #endif
 
+#define PLOCK_HASH_INIT      0x2f6b1c35
+
+/* must be a power of 2 */
+#define PLOCK_MIN_BUCKETS    64
+
 /********************************************************************
 *                                                                   *
 *                           T Y P E S                               *
 *                                                                   *
 *********************************************************************/
 
+/* one node in the lock trie; represents one step in the
+ * instance identifier of a locked node or one of its ancestors
+ * A node only exists while some lock entry is at or below it
+ */
+typedef struct plock_node_t_ {
+    struct plock_node_t_ *hnext;         /* hash chain */
+    uint32               hash;
+    struct plock_node_t_ *parent;
+    xmlChar             *seg;            /* path step, not Z-term */
+    uint32               seglen;
+    uint32               subcnt;         /* entries at or below */
+    dlq_hdr_t            lockQ;          /* Q of plock_entry_t */
+    dlq_hdr_t            sidQ;           /* Q of plock_sidcnt_t */
+} plock_node_t;
+
+/* one locked node for one partial lock */
+typedef struct plock_entry_t_ {
+    dlq_hdr_t            qhdr;
+    plock_cb_t          *plcb;
+    plock_node_t        *node;
+    val_value_t         *val;            /* locked node in running */
+    ncx_backptr_t       *backptr;        /* in plcb->plock_nodeQ */
+} plock_entry_t;
+
+/* number of entries held by one session at or below a node */
+typedef struct plock_sidcnt_t_ {
+    dlq_hdr_t            qhdr;
+    uint32               sid;
+    uint32               count;
+} plock_sidcnt_t;
+
 
 /********************************************************************
 *                                                                   *
@@ -111,6 +159,553 @@ date         init     comment
 *                                                                   *
 *********************************************************************/
 
+/* trie node for the config root; never freed */
+static plock_node_t    trie_root;
+static boolean         trie_init_done;
+
+/* hash table of all trie nodes except the root,
+ * keyed by (parent node, path step)
+ */
+static plock_node_t  **trie_buckets;
+static uint32          trie_size;
+static uint32          trie_count;
+
+
+/********************************************************************
+* FUNCTION trie_init
+*
+* Initialize the trie root node if needed
+*
+*********************************************************************/
+static void
+    trie_init (void)
+{
+    if (!trie_init_done) {
+        memset(&trie_root, 0x0, sizeof(plock_node_t));
+        dlq_createSQue(&trie_root.lockQ);
+        dlq_createSQue(&trie_root.sidQ);
+        trie_init_done = TRUE;
+    }
+
+}  /* trie_init */
+
+
+/********************************************************************
+* FUNCTION hash_seg
+*
+* Get the hash value for a (parent node, path step) pair
+*
+* INPUTS:
+*   parent == parent trie node
+*   seg == path step string (not Z-terminated)
+*   seglen == length of seg
+*
+* RETURNS:
+*   hash value
+*********************************************************************/
+static uint32
+    hash_seg (const plock_node_t *parent,
+              const xmlChar *seg,
+              uint32 seglen)
+{
+    uint32 hash = bobhash((const uint8 *)&parent, sizeof(parent),
+                          PLOCK_HASH_INIT);
+    return bobhash((const uint8 *)seg, seglen, hash);
+
+}  /* hash_seg */
+
+
+/********************************************************************
+* FUNCTION find_child
+*
+* Find the child trie node for a path step
+*
+* INPUTS:
+*   parent == parent trie node
+*   seg == path step string (not Z-terminated)
+*   seglen == length of seg
+*   hash == hash_seg(parent, seg, seglen)
+*
+* RETURNS:
+*   pointer to found node or NULL if not found
+*********************************************************************/
+static plock_node_t *
+    find_child (const plock_node_t *parent,
+                const xmlChar *seg,
+                uint32 seglen,
+                uint32 hash)
+{
+    if (trie_size == 0) {
+        return NULL;
+    }
+
+    plock_node_t *node = trie_buckets[hash & (trie_size - 1)];
+    for (; node != NULL; node = node->hnext) {
+        if (node->hash == hash && node->parent == parent &&
+            node->seglen == seglen &&
+            !memcmp(node->seg, seg, seglen)) {
+            return node;
+        }
+    }
+    return NULL;
+
+}  /* find_child */
+
+
+/********************************************************************
+* FUNCTION new_child
+*
+* Create a child trie node for a path step and add it
+* to the hash table; grow the table if needed
+*
+* INPUTS:
+*   parent == parent trie node
+*   seg == path step string (not Z-terminated)
+*   seglen == length of seg
+*   hash == hash_seg(parent, seg, seglen)
+*
+* RETURNS:
+*   pointer to new node or NULL if malloc failed
+*********************************************************************/
+static plock_node_t *
+    new_child (plock_node_t *parent,
+               const xmlChar *seg,
+               uint32 seglen,
+               uint32 hash)
+{
+    if (trie_count >= trie_size) {
+        uint32 newsize = (trie_size) ? trie_size * 2 : PLOCK_MIN_BUCKETS;
+        plock_node_t **newbuckets = (plock_node_t **)
+            m__getMem(newsize * sizeof(plock_node_t *));
+        if (newbuckets == NULL) {
+            return NULL;
+        }
+        memset(newbuckets, 0x0, newsize * sizeof(plock_node_t *));
+
+        uint32 i = 0;
+        for (; i < trie_size; i++) {
+            plock_node_t *n = trie_buckets[i];
+            while (n) {
+                plock_node_t *nextn = n->hnext;
+                uint32 b = n->hash & (newsize - 1);
+                n->hnext = newbuckets[b];
+                newbuckets[b] = n;
+                n = nextn;
+            }
+        }
+        if (trie_buckets) {
+            m__free(trie_buckets);
+        }
+        trie_buckets = newbuckets;
+        trie_size = newsize;
+    }
+
+    plock_node_t *node = m__getObj(plock_node_t);
+    if (node == NULL) {
+        return NULL;
+    }
+    memset(node, 0x0, sizeof(plock_node_t));
+
+    node->seg = (xmlChar *)m__getMem(seglen + 1);
+    if (node->seg == NULL) {
+        m__free(node);
+        return NULL;
+    }
+    memcpy(node->seg, seg, seglen);
+    node->seg[seglen] = 0;
+    node->seglen = seglen;
+    node->hash = hash;
+    node->parent = parent;
+    dlq_createSQue(&node->lockQ);
+    dlq_createSQue(&node->sidQ);
+
+    uint32 b = hash & (trie_size - 1);
+    node->hnext = trie_buckets[b];
+    trie_buckets[b] = node;
+    trie_count++;
+    return node;
+
+}  /* new_child */
+
+
+/********************************************************************
+* FUNCTION prune_node
+*
+* Free a trie node and each of its ancestors that no longer
+* have any lock entries at or below them
+* The trie root is never freed
+*
+* INPUTS:
+*   node == trie node to check
+*********************************************************************/
+static void
+    prune_node (plock_node_t *node)
+{
+    while (node != &trie_root && node->subcnt == 0) {
+        plock_node_t *parent = node->parent;
+
+        plock_node_t **prev = &trie_buckets[node->hash & (trie_size - 1)];
+        for (; *prev != NULL; prev = &(*prev)->hnext) {
+            if (*prev == node) {
+                *prev = node->hnext;
+                trie_count--;
+                break;
+            }
+        }
+
+        m__free(node->seg);
+        m__free(node);
+        node = parent;
+    }
+
+    if (trie_count == 0 && trie_buckets != NULL) {
+        m__free(trie_buckets);
+        trie_buckets = NULL;
+        trie_size = 0;
+    }
+
+}  /* prune_node */
+
+
+/********************************************************************
+* FUNCTION find_sidcnt
+*
+* Find the session counter for a trie node
+*
+* INPUTS:
+*   node == trie node to check
+*   sid == session ID to find
+*
+* RETURNS:
+*   pointer to counter or NULL if not found
+*********************************************************************/
+static plock_sidcnt_t *
+    find_sidcnt (plock_node_t *node,
+                 uint32 sid)
+{
+    plock_sidcnt_t *sidcnt = (plock_sidcnt_t *)dlq_firstEntry(&node->sidQ);
+    for (; sidcnt != NULL;
+         sidcnt = (plock_sidcnt_t *)dlq_nextEntry(sidcnt)) {
+        if (sidcnt->sid == sid) {
+            return sidcnt;
+        }
+    }
+    return NULL;
+
+}  /* find_sidcnt */
+
+
+/********************************************************************
+* FUNCTION count_down
+*
+* Remove one entry for a session from a trie node and
+* its ancestors, stopping before the specified node
+*
+* INPUTS:
+*   node == trie node holding the entry
+*   stopnode == node to stop at (not changed) or NULL for all
+*   sid == session ID owning the entry
+*********************************************************************/
+static void
+    count_down (plock_node_t *node,
+                plock_node_t *stopnode,
+                uint32 sid)
+{
+    for (; node != NULL && node != stopnode; node = node->parent) {
+        plock_sidcnt_t *sidcnt = find_sidcnt(node, sid);
+        if (sidcnt != NULL && --sidcnt->count == 0) {
+            dlq_remove(sidcnt);
+            m__free(sidcnt);
+        }
+        node->subcnt--;
+    }
+
+}  /* count_down */
+
+
+/********************************************************************
+* FUNCTION count_up
+*
+* Add one entry for a session to a trie node and its ancestors
+*
+* INPUTS:
+*   node == trie node holding the entry
+*   sid == session ID owning the entry
+*
+* RETURNS:
+*   status; no counters are changed if an error is returned
+*********************************************************************/
+static status_t
+    count_up (plock_node_t *node,
+              uint32 sid)
+{
+    plock_node_t *n = node;
+    for (; n != NULL; n = n->parent) {
+        plock_sidcnt_t *sidcnt = find_sidcnt(n, sid);
+        if (sidcnt == NULL) {
+            sidcnt = m__getObj(plock_sidcnt_t);
+            if (sidcnt == NULL) {
+                count_down(node, n, sid);
+                return ERR_INTERNAL_MEM;
+            }
+            memset(sidcnt, 0x0, sizeof(plock_sidcnt_t));
+            sidcnt->sid = sid;
+            dlq_enque(sidcnt, &n->sidQ);
+        }
+        sidcnt->count++;
+        n->subcnt++;
+    }
+    return NO_ERR;
+
+}  /* count_up */
+
+
+/********************************************************************
+* FUNCTION other_sid_below
+*
+* Check if a session other than the specified session
+* holds a lock entry at or below a trie node
+*
+* INPUTS:
+*   node == trie node to check
+*   sid == session ID to skip
+*
+* RETURNS:
+*   TRUE if another session holds a lock entry at or below node
+*********************************************************************/
+static boolean
+    other_sid_below (plock_node_t *node,
+                     uint32 sid)
+{
+    plock_sidcnt_t *sidcnt = (plock_sidcnt_t *)dlq_firstEntry(&node->sidQ);
+    for (; sidcnt != NULL;
+         sidcnt = (plock_sidcnt_t *)dlq_nextEntry(sidcnt)) {
+        if (sidcnt->sid != sid) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+
+}  /* other_sid_below */
+
+
+/********************************************************************
+* FUNCTION is_at_or_below
+*
+* Check if a trie node is the same as or a descendant of
+* another trie node
+*
+* INPUTS:
+*   node == trie node to check
+*   topnode == subtree root trie node
+*
+* RETURNS:
+*   TRUE if node is in the subtree
+*********************************************************************/
+static boolean
+    is_at_or_below (const plock_node_t *node,
+                    const plock_node_t *topnode)
+{
+    for (; node != NULL; node = node->parent) {
+        if (node == topnode) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+
+}  /* is_at_or_below */
+
+
+/********************************************************************
+* FUNCTION walk_path
+*
+* Find or create the trie node for a value node
+* The trie is keyed by the steps in the instance identifier
+* for the node, so the same data node in a different tree
+* (e.g., edit PDU or candidate) maps to the same trie node
+*
+* INPUTS:
+*   val == value node to find
+*   create == TRUE to create missing trie nodes
+*   found == address of return found flag
+*   res == address of return status
+*
+* OUTPUTS:
+*   *found == TRUE if the trie node for val was found or created
+*             FALSE if only an ancestor node exists
+*   *res == return status
+*
+* RETURNS:
+*   pointer to trie node for val if *found; the deepest ancestor
+*   trie node that exists if not *found; NULL if some error
+*********************************************************************/
+static plock_node_t *
+    walk_path (const val_value_t *val,
+               boolean create,
+               boolean *found,
+               status_t *res)
+{
+    *found = FALSE;
+    *res = NO_ERR;
+    trie_init();
+
+    if (val->obj && obj_is_root(val->obj)) {
+        *found = TRUE;
+        return &trie_root;
+    }
+
+    xmlChar *buff = NULL;
+    *res = val_gen_instance_id(NULL, val, NCX_IFMT_XPATH1, &buff);
+    if (*res != NO_ERR) {
+        if (buff) {
+            m__free(buff);
+        }
+        return NULL;
+    }
+
+    plock_node_t *node = &trie_root;
+    const xmlChar *p = buff;
+    while (*p) {
+        if (*p == '/') {
+            p++;
+            continue;
+        }
+
+        /* find the end of the step; skip '/' in quoted key values */
+        const xmlChar *seg = p;
+        xmlChar quote = 0;
+        while (*p && (quote || *p != '/')) {
+            if (quote) {
+                if (*p == quote) {
+                    quote = 0;
+                }
+            } else if (*p == '\'' || *p == '"') {
+                quote = *p;
+            }
+            p++;
+        }
+
+        uint32 seglen = (uint32)(p - seg);
+        uint32 hash = hash_seg(node, seg, seglen);
+        plock_node_t *child = find_child(node, seg, seglen, hash);
+        if (child == NULL) {
+            if (!create) {
+                m__free(buff);
+                return node;
+            }
+            child = new_child(node, seg, seglen, hash);
+            if (child == NULL) {
+                /* only the parent chain with entries is kept */
+                prune_node(node);
+                *res = ERR_INTERNAL_MEM;
+                m__free(buff);
+                return NULL;
+            }
+        }
+        node = child;
+    }
+
+    m__free(buff);
+    *found = TRUE;
+    return node;
+
+}  /* walk_path */
+
+
+/********************************************************************
+* FUNCTION find_entry_lock
+*
+* Find a lock entry in a trie node for a session other
+* than the specified session
+*
+* INPUTS:
+*   node == trie node to check
+*   sid == session ID to skip
+*
+* RETURNS:
+*   partial lock of the first entry found or NULL if none
+*********************************************************************/
+static plock_cb_t *
+    find_entry_lock (plock_node_t *node,
+                     uint32 sid)
+{
+    plock_entry_t *entry = (plock_entry_t *)dlq_firstEntry(&node->lockQ);
+    for (; entry != NULL; entry = (plock_entry_t *)dlq_nextEntry(entry)) {
+        if (entry->plcb->plock_sesid != sid) {
+            return entry->plcb;
+        }
+    }
+    return NULL;
+
+}  /* find_entry_lock */
+
+
+/********************************************************************
+* FUNCTION find_lock_below
+*
+* Find a partial lock on the running config held by a session
+* other than the specified session, with an entry at or below
+* a trie node
+*
+* INPUTS:
+*   node == trie node to check
+*   sid == session ID to skip
+*
+* RETURNS:
+*   partial lock found or NULL if none
+*********************************************************************/
+static plock_cb_t *
+    find_lock_below (plock_node_t *node,
+                     uint32 sid)
+{
+    cfg_template_t *running = cfg_get_config_id(NCX_CFGID_RUNNING);
+    if (running == NULL) {
+        return NULL;
+    }
+
+    plock_cb_t *plcb = cfg_first_partial_lock(running);
+    for (; plcb != NULL; plcb = cfg_next_partial_lock(plcb)) {
+        if (plcb->plock_sesid == sid) {
+            continue;
+        }
+
+        ncx_backptr_t *backptr = ncx_first_backptr(&plcb->plock_nodeQ);
+        for (; backptr != NULL; backptr = ncx_next_backptr(backptr)) {
+            plock_entry_t *entry = (plock_entry_t *)
+                ncx_get_backptr_node(backptr);
+            if (is_at_or_below(entry->node, node)) {
+                return plcb;
+            }
+        }
+    }
+    return NULL;
+
+}  /* find_lock_below */
+
+
+/********************************************************************
+* FUNCTION remove_entry
+*
+* Remove a lock entry from the trie and free it
+* The trie node is freed if it is no longer needed
+*
+* INPUTS:
+*   entry == lock entry to remove
+*********************************************************************/
+static void
+    remove_entry (plock_entry_t *entry)
+{
+    plock_node_t *node = entry->node;
+
+    dlq_remove(entry);
+    dlq_remove(entry->backptr);
+    ncx_free_backptr(entry->backptr);
+    count_down(node, NULL, entry->plcb->plock_sesid);
+    prune_node(node);
+    m__free(entry);
+
+}  /* remove_entry */
+
 
 /********************************************************************
 * FUNCTION plock_get_id
@@ -347,4 +942,329 @@ status_t
 }  /* plock_make_final_result */
 
 
+/********************************************************************
+* FUNCTION plock_add_node
+*
+* Add a node in the running config to the lock trie
+* for a partial lock
+*
+* INPUTS:
+*   plcb == partial lock control block to use
+*   val == locked node to add
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    plock_add_node (plock_cb_t *plcb,
+                    val_value_t *val)
+{
+    boolean   found;
+    status_t  res;
+
+#ifdef DEBUG
+    if (plcb == NULL || val == NULL) {
+        return SET_ERROR(ERR_INTERNAL_PTR);
+    }
+#endif
+
+    plock_node_t *node = walk_path(val, TRUE, &found, &res);
+    if (node == NULL) {
+        return res;
+    }
+
+    plock_entry_t *entry = m__getObj(plock_entry_t);
+    if (entry == NULL) {
+        prune_node(node);
+        return ERR_INTERNAL_MEM;
+    }
+    memset(entry, 0x0, sizeof(plock_entry_t));
+    entry->plcb = plcb;
+    entry->node = node;
+    entry->val = val;
+
+    entry->backptr = ncx_new_backptr(entry);
+    if (entry->backptr == NULL) {
+        m__free(entry);
+        prune_node(node);
+        return ERR_INTERNAL_MEM;
+    }
+
+    res = count_up(node, plcb->plock_sesid);
+    if (res != NO_ERR) {
+        ncx_free_backptr(entry->backptr);
+        m__free(entry);
+        prune_node(node);
+        return res;
+    }
+
+    dlq_enque(entry, &node->lockQ);
+    dlq_enque(entry->backptr, &plcb->plock_nodeQ);
+    return NO_ERR;
+
+}  /* plock_add_node */
+
+
+/********************************************************************
+* FUNCTION plock_remove_node
+*
+* Remove the lock trie entries for a partial lock
+* at or below the specified node
+*
+* INPUTS:
+*   plcb == partial lock control block to use
+*   val == top node to remove; if this is the config root
+*          then all the entries for the partial lock are removed
+*********************************************************************/
+void
+    plock_remove_node (plock_cb_t *plcb,
+                       val_value_t *val)
+{
+    boolean   found;
+    status_t  res;
+
+#ifdef DEBUG
+    if (plcb == NULL || val == NULL) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    if (dlq_empty(&plcb->plock_nodeQ)) {
+        return;
+    }
+
+    plock_node_t *node = walk_path(val, FALSE, &found, &res);
+    if (node == NULL || !found) {
+        return;
+    }
+
+    ncx_backptr_t *backptr = ncx_first_backptr(&plcb->plock_nodeQ);
+    while (backptr != NULL) {
+        ncx_backptr_t *nextptr = ncx_next_backptr(backptr);
+        plock_entry_t *entry = (plock_entry_t *)
+            ncx_get_backptr_node(backptr);
+        if (is_at_or_below(entry->node, node)) {
+            remove_entry(entry);
+        }
+        backptr = nextptr;
+    }
+
+}  /* plock_remove_node */
+
+
+/********************************************************************
+* FUNCTION plock_remove_all_nodes
+*
+* Remove all the lock trie entries for a partial lock
+*
+* INPUTS:
+*   plcb == partial lock control block to use
+*********************************************************************/
+void
+    plock_remove_all_nodes (plock_cb_t *plcb)
+{
+#ifdef DEBUG
+    if (plcb == NULL) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    while (!dlq_empty(&plcb->plock_nodeQ)) {
+        ncx_backptr_t *backptr = ncx_first_backptr(&plcb->plock_nodeQ);
+        remove_entry((plock_entry_t *)ncx_get_backptr_node(backptr));
+    }
+
+}  /* plock_remove_all_nodes */
+
+
+/********************************************************************
+* FUNCTION plock_find_conflict
+*
+* Find a partial lock held by another session that
+* covers the specified node
+*
+* INPUTS:
+*   val == node to check
+*   sid == session ID requesting access
+*   checkup == TRUE to check locks on the ancestors of val
+*   checkdown == TRUE to check locks on the descendants of val
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == return status
+*
+* RETURNS:
+*   the first conflicting partial lock found, or NULL if none
+*********************************************************************/
+plock_cb_t *
+    plock_find_conflict (const val_value_t *val,
+                         uint32 sid,
+                         boolean checkup,
+                         boolean checkdown,
+                         status_t *res)
+{
+    boolean   found;
+
+#ifdef DEBUG
+    if (val == NULL || res == NULL) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return NULL;
+    }
+#endif
+
+    *res = NO_ERR;
+
+    /* quick exit check; no locks at all */
+    if (trie_root.subcnt == 0) {
+        return NULL;
+    }
+
+    plock_node_t *node = walk_path(val, FALSE, &found, res);
+    if (node == NULL) {
+        return NULL;
+    }
+
+    plock_cb_t *plcb = NULL;
+    plock_node_t *upnode = node;
+    if (found) {
+        plcb = find_entry_lock(node, sid);
+        if (plcb == NULL && checkdown && other_sid_below(node, sid)) {
+            plcb = find_lock_below(node, sid);
+        }
+        upnode = node->parent;
+    }
+
+    if (checkup) {
+        for (; plcb == NULL && upnode != NULL; upnode = upnode->parent) {
+            plcb = find_entry_lock(upnode, sid);
+        }
+    }
+
+    return plcb;
+
+}  /* plock_find_conflict */
+
+
+/********************************************************************
+* FUNCTION plock_swap_node
+*
+* Transfer the partial locks on a node in the running config
+* to the new node taking its place
+*
+* INPUTS:
+*   curval == current node being replaced
+*   newval == new value taking its place
+*********************************************************************/
+void
+    plock_swap_node (val_value_t *curval,
+                     val_value_t *newval)
+{
+    boolean   found;
+    status_t  res;
+
+#ifdef DEBUG
+    if (curval == NULL || newval == NULL) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    if (trie_root.subcnt == 0) {
+        return;
+    }
+
+    /* the trie entries are keyed by path, so only the
+     * lock result node-sets need to be changed
+     */
+    plock_node_t *node = walk_path(curval, FALSE, &found, &res);
+    if (node == NULL || !found) {
+        return;
+    }
+
+    plock_entry_t *entry = (plock_entry_t *)dlq_firstEntry(&node->lockQ);
+    for (; entry != NULL; entry = (plock_entry_t *)dlq_nextEntry(entry)) {
+        xpath_nodeset_swap_valptr(entry->plcb->plock_final_result,
+                                  curval, newval);
+        entry->val = newval;
+    }
+
+}  /* plock_swap_node */
+
+
+/********************************************************************
+* FUNCTION plock_delete_node
+*
+* Remove a node in the running config that is being deleted
+* from all the partial locks that cover it or any of
+* its descendants
+*
+* INPUTS:
+*   curval == current node being deleted
+*********************************************************************/
+void
+    plock_delete_node (val_value_t *curval)
+{
+    boolean   found;
+    status_t  res;
+
+#ifdef DEBUG
+    if (curval == NULL) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    if (trie_root.subcnt == 0) {
+        return;
+    }
+
+    plock_node_t *node = walk_path(curval, FALSE, &found, &res);
+    if (node == NULL || !found) {
+        return;
+    }
+
+    uint32 lockcnt = dlq_count(&node->lockQ);
+    if (node->subcnt == lockcnt) {
+        /* no entries below this node; the node is freed
+         * when the last entry is removed
+         */
+        while (lockcnt-- > 0) {
+            plock_entry_t *entry = (plock_entry_t *)
+                dlq_firstEntry(&node->lockQ);
+            xpath_nodeset_delete_valptr(entry->plcb->plock_final_result,
+                                        entry->val);
+            remove_entry(entry);
+        }
+        return;
+    }
+
+    cfg_template_t *running = cfg_get_config_id(NCX_CFGID_RUNNING);
+    if (running == NULL) {
+        return;
+    }
+
+    /* remove the result node for each entry that is dropped,
+     * not just curval; the descendant nodes are freed with it
+     */
+    plock_cb_t *plcb = cfg_first_partial_lock(running);
+    for (; plcb != NULL; plcb = cfg_next_partial_lock(plcb)) {
+        ncx_backptr_t *backptr = ncx_first_backptr(&plcb->plock_nodeQ);
+        while (backptr != NULL) {
+            ncx_backptr_t *nextptr = ncx_next_backptr(backptr);
+            plock_entry_t *entry = (plock_entry_t *)
+                ncx_get_backptr_node(backptr);
+            if (is_at_or_below(entry->node, node)) {
+                xpath_nodeset_delete_valptr(plcb->plock_final_result,
+                                            entry->val);
+                remove_entry(entry);
+            }
+            backptr = nextptr;
+        }
+    }
+
+}  /* plock_delete_node */
+
+
 /* END file plock.c */
@@ -20,6 +20,11 @@
 
     RFC 57517 partial lock support
 
+    The nodes covered by all the partial locks on the running
+    config are kept in a trie keyed by the instance identifier
+    steps of each locked node.  The lock and write-access tests
+    walk one path in the trie instead of the locked subtrees.
+
 
 *********************************************************************
 *                                                                   *
@@ -195,6 +200,108 @@ extern void
 extern status_t
     plock_make_final_result (plock_cb_t *plcb);
 
+
+/********************************************************************
+* FUNCTION plock_add_node
+*
+* Add a node in the running config to the lock trie
+* for a partial lock
+*
+* INPUTS:
+*   plcb == partial lock control block to use
+*   val == locked node to add
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    plock_add_node (plock_cb_t *plcb,
+                    val_value_t *val);
+
+
+/********************************************************************
+* FUNCTION plock_remove_node
+*
+* Remove the lock trie entries for a partial lock
+* at or below the specified node
+*
+* INPUTS:
+*   plcb == partial lock control block to use
+*   val == top node to remove; if this is the config root
+*          then all the entries for the partial lock are removed
+*********************************************************************/
+extern void
+    plock_remove_node (plock_cb_t *plcb,
+                       val_value_t *val);
+
+
+/********************************************************************
+* FUNCTION plock_remove_all_nodes
+*
+* Remove all the lock trie entries for a partial lock
+*
+* INPUTS:
+*   plcb == partial lock control block to use
+*********************************************************************/
+extern void
+    plock_remove_all_nodes (plock_cb_t *plcb);
+
+
+/********************************************************************
+* FUNCTION plock_find_conflict
+*
+* Find a partial lock held by another session that
+* covers the specified node
+*
+* INPUTS:
+*   val == node to check
+*   sid == session ID requesting access
+*   checkup == TRUE to check locks on the ancestors of val
+*   checkdown == TRUE to check locks on the descendants of val
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == return status
+*
+* RETURNS:
+*   the first conflicting partial lock found, or NULL if none
+*********************************************************************/
+extern plock_cb_t *
+    plock_find_conflict (const val_value_t *val,
+                         uint32 sid,
+                         boolean checkup,
+                         boolean checkdown,
+                         status_t *res);
+
+
+/********************************************************************
+* FUNCTION plock_swap_node
+*
+* Transfer the partial locks on a node in the running config
+* to the new node taking its place
+*
+* INPUTS:
+*   curval == current node being replaced
+*   newval == new value taking its place
+*********************************************************************/
+extern void
+    plock_swap_node (val_value_t *curval,
+                     val_value_t *newval);
+
+
+/********************************************************************
+* FUNCTION plock_delete_node
+*
+* Remove a node in the running config that is being deleted
+* from all the partial locks that cover it or any of
+* its descendants
+*
+* INPUTS:
+*   curval == current node being deleted
+*********************************************************************/
+extern void
+    plock_delete_node (val_value_t *curval);
+
 #ifdef __cplusplus
 }  /* end extern 'C' */
 #endif
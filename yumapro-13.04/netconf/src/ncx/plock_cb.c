@@ -49,6 +49,10 @@ date         init     comment
 #include  "log.h"
 #endif
 
+#ifndef _H_plock
+#include  "plock.h"
+#endif
+
 #ifndef _H_plock_cb
 #include  "plock_cb.h"
 #endif
@@ -166,6 +170,7 @@ plock_cb_t *
     plcb->plock_id = ++last_id;
     dlq_createSQue(&plcb->plock_xpathpcbQ);
     dlq_createSQue(&plcb->plock_resultQ);
+    dlq_createSQue(&plcb->plock_nodeQ);
     tstamp_datetime(plcb->plock_time);
     plcb->plock_sesid = sid;
     return plcb;
@@ -188,6 +193,8 @@ void plock_cb_free (plock_cb_t *plcb)
         return;
     }
 
+    plock_remove_all_nodes(plcb);
+
     while (!dlq_empty(&plcb->plock_xpathpcbQ)) {
         xpath_free_pcb( (xpath_pcb_t *) dlq_deque(&plcb->plock_xpathpcbQ) );
     }
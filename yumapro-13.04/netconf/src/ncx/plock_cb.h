@@ -74,6 +74,7 @@ typedef struct plock_cb_t_ {
     dlq_hdr_t       plock_xpathpcbQ;     /* Q of xpath_pcb_t */
     dlq_hdr_t       plock_resultQ;    /* Q of xpath_result_t */
     struct xpath_result_t_ *plock_final_result;
+    dlq_hdr_t       plock_nodeQ;      /* Q of ncx_backptr_t */
     xmlChar         plock_time[TSTAMP_MIN_SIZE];
 } plock_cb_t;
 
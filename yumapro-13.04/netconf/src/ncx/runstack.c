@@ -210,6 +210,12 @@ static void
     if (le->line) {
         m__free(le->line);
     }
+    if (le->exprstr) {
+        m__free(le->exprstr);
+    }
+    if (le->xpathpcb) {
+        xpath_free_pcb(le->xpathpcb);
+    }
     m__free(le);
 
 }  /* free_line_entry */
@@ -523,6 +529,43 @@ static runstack_line_t* select_end_entry( runstack_context_t* rcxt,
     }
 }
 
+
+/********************************************************************
+* FUNCTION get_cur_loop_line
+* 
+* Get the loop line entry that is being processed now
+*
+* INPUTS:
+*   rcxt == runstack context to use
+*
+* RETURNS:
+*   pointer to the current line entry or NULL if not looping
+*********************************************************************/
+static runstack_line_t *
+    get_cur_loop_line (runstack_context_t *rcxt)
+{
+    if (rcxt->cur_src != RUNSTACK_SRC_LOOP) {
+        return NULL;
+    }
+
+    runstack_condcb_t *condcb = get_loopcb(rcxt);
+    if (condcb == NULL) {
+        return NULL;
+    }
+
+    runstack_loopcb_t *loopcb = &condcb->u.loopcb;
+    if (loopcb->loop_state == RUNSTACK_LOOP_COLLECTING) {
+        /* the outside loop is looping */
+        if (loopcb->collector == NULL) {
+            return NULL;
+        }
+        return loopcb->collector->cur_line;
+    }
+    return loopcb->cur_line;
+
+}  /* get_cur_loop_line */
+
+
 /**************    E X T E R N A L   F U N C T I O N S **********/
 
 
@@ -1941,4 +1984,91 @@ boolean
 } /* runstack_get_if_used */
 
 
+/********************************************************************
+* FUNCTION runstack_get_loop_xpath
+* 
+* Get the XPath control block saved for the loop line
+* that is being processed now
+*
+* INPUTS:
+*   rcxt == runstack context to use
+*   exprstr == XPath expression string from the current line
+*
+* RETURNS:
+*   back-pointer to the saved XPath control block, 
+*   NULL if not looping or nothing saved for this expression
+*********************************************************************/
+xpath_pcb_t *
+    runstack_get_loop_xpath (runstack_context_t *rcxt,
+                             const xmlChar *exprstr)
+{
+    if (rcxt == NULL) {
+        rcxt = &defcxt;
+    }
+
+    runstack_line_t *le = get_cur_loop_line(rcxt);
+    if (le == NULL || le->xpathpcb == NULL || le->exprstr == NULL) {
+        return NULL;
+    }
+
+    /* the line may use variables so the expr can change */
+    if (xml_strcmp(le->exprstr, exprstr)) {
+        return NULL;
+    }
+    return le->xpathpcb;
+
+} /* runstack_get_loop_xpath */
+
+
+/********************************************************************
+* FUNCTION runstack_save_loop_xpath
+* 
+* Save the XPath control block for the loop line that is
+* being processed now, so the next pass through the loop
+* does not need to parse the expression again
+*
+* INPUTS:
+*   rcxt == runstack context to use
+*   exprstr == XPath expression string from the current line
+*   xpathpcb == XPath control block to save
+*
+* RETURNS:
+*   TRUE if the xpathpcb is now owned by the loop line
+*   FALSE if not looping; the caller must free xpathpcb
+*********************************************************************/
+boolean
+    runstack_save_loop_xpath (runstack_context_t *rcxt,
+                              const xmlChar *exprstr,
+                              xpath_pcb_t *xpathpcb)
+{
+    if (rcxt == NULL) {
+        rcxt = &defcxt;
+    }
+
+    runstack_line_t *le = get_cur_loop_line(rcxt);
+    if (le == NULL) {
+        return FALSE;
+    }
+    if (le->xpathpcb == xpathpcb) {
+        return TRUE;
+    }
+
+    xmlChar *newstr = xml_strdup(exprstr);
+    if (newstr == NULL) {
+        return FALSE;
+    }
+
+    if (le->exprstr) {
+        m__free(le->exprstr);
+    }
+    if (le->xpathpcb) {
+        xpath_free_pcb(le->xpathpcb);
+    }
+    le->exprstr = newstr;
+    le->xpathpcb = xpathpcb;
+    return TRUE;
+
+} /* runstack_save_loop_xpath */
+
+
 /* END runstack.c */
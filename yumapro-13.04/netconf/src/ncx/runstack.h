@@ -129,6 +129,10 @@ typedef struct runstack_ifcb_t_ {
 typedef struct runstack_line_t_ {
     dlq_hdr_t             qhdr;
     xmlChar              *line;
+
+    /* parsed if/elif expression saved for the next loop pass */
+    xmlChar              *exprstr;
+    struct xpath_pcb_t_  *xpathpcb;
 } runstack_line_t;
 
 
@@ -617,6 +621,47 @@ extern status_t
 extern boolean
     runstack_get_if_used (runstack_context_t *rcxt);
 
+
+/********************************************************************
+* FUNCTION runstack_get_loop_xpath
+* 
+* Get the XPath control block saved for the loop line
+* that is being processed now
+*
+* INPUTS:
+*   rcxt == runstack context to use
+*   exprstr == XPath expression string from the current line
+*
+* RETURNS:
+*   back-pointer to the saved XPath control block, 
+*   NULL if not looping or nothing saved for this expression
+*********************************************************************/
+extern struct xpath_pcb_t_ *
+    runstack_get_loop_xpath (runstack_context_t *rcxt,
+                             const xmlChar *exprstr);
+
+
+/********************************************************************
+* FUNCTION runstack_save_loop_xpath
+* 
+* Save the XPath control block for the loop line that is
+* being processed now, so the next pass through the loop
+* does not need to parse the expression again
+*
+* INPUTS:
+*   rcxt == runstack context to use
+*   exprstr == XPath expression string from the current line
+*   xpathpcb == XPath control block to save
+*
+* RETURNS:
+*   TRUE if the xpathpcb is now owned by the loop line
+*   FALSE if not looping; the caller must free xpathpcb
+*********************************************************************/
+extern boolean
+    runstack_save_loop_xpath (runstack_context_t *rcxt,
+                              const xmlChar *exprstr,
+                              struct xpath_pcb_t_ *xpathpcb);
+
 #ifdef __cplusplus
 }  /* end extern 'C' */
 #endif
@@ -41,6 +41,7 @@ date         init     comment
 #include "log.h"
 #include "ncx.h"
 #include "ncx_num.h"
+#include "ncx_trace.h"
 
 #ifdef WITH_YANGAPI
 #include "yangapi.h"
@@ -738,12 +739,8 @@ static void
 {
     xmlChar     numbuff[NCX_MAX_NUMLEN];
 
-    snprintf((char *)numbuff, NCX_MAX_NUMLEN, "%u", (uint32)ch);
-
-    ses_putchar(scb, '&');
-    ses_putchar(scb, '#');
+    snprintf((char *)numbuff, NCX_MAX_NUMLEN, "&#%u;", (uint32)ch);
     ses_putstr(scb, numbuff);
-    ses_putchar(scb, ';');
 
 }  /* put_char_entity */
 
@@ -1139,6 +1136,290 @@ void
 }  /* ses_putchar */
 
 
+/********************************************************************
+* FUNCTION ses_putbuff
+*
+* Write a span of chars to the session, without any translation
+*
+* THIS FUNCTION DOES NOT CHECK ANY PARAMETERS TO SAVE TIME
+*
+* The span is copied into the session output buffers with memcpy,
+* one chunk per buffer, instead of one ses_putchar call per char
+*
+* INPUTS:
+*   scb == session control block to start msg 
+*   buff == buffer to write; does not need to be zero-terminated
+*   bufflen == number of bytes to write
+*
+*********************************************************************/
+void
+    ses_putbuff (ses_cb_t *scb,
+                 const xmlChar *buff,
+                 uint32 bufflen)
+{
+    ses_msg_buff_t *outbuff;
+    const xmlChar  *str;
+    size_t          maxlen, chunk;
+    uint32          pos;
+    status_t        res;
+
+    if (bufflen == 0) {
+        return;
+    }
+
+    if (scb->fd) {
+        /* Normal NETCONF session mode: */
+        maxlen = (scb->framing11) ? 
+            (SES_MSG_BUFFSIZE - SES_ENDCHUNK_PAD) : SES_MSG_BUFFSIZE;
+        res = NO_ERR;
+        pos = 0;
+        while (pos < bufflen && res == NO_ERR) {
+            if (scb->outbuff == NULL) {
+                res = ses_msg_new_buff(scb, TRUE, &scb->outbuff);
+                if (scb->outbuff == NULL) {
+                    break;
+                }
+                continue;
+            }
+
+            outbuff = scb->outbuff;
+            if (outbuff->bufflen >= maxlen) {
+                res = ses_msg_new_output_buff(scb);
+                continue;
+            }
+
+            chunk = min(maxlen - outbuff->bufflen, (size_t)(bufflen - pos));
+            memcpy(&outbuff->buff[outbuff->bufflen], &buff[pos], chunk);
+            outbuff->bufflen += chunk;
+            pos += (uint32)chunk;
+            scb->stats.out_bytes += (uint32)chunk;
+            totals.stats.out_bytes += (uint32)chunk;
+        }
+    } else if (scb->fp) {
+        /* debug session, sending output to a file */
+        fwrite(buff, 1, bufflen, scb->fp);
+    } else {
+        /* debug session, sending output to the screen */
+        fwrite(buff, 1, bufflen, stdout);
+    }
+
+    /* line length is the number of chars after the last newline */
+    str = &buff[bufflen];
+    while (str > buff && str[-1] != '\n') {
+        str--;
+    }
+    if (str == buff) {
+        scb->stats.out_line += bufflen;
+    } else {
+        scb->stats.out_line = (uint32)(&buff[bufflen] - str);
+    }
+
+}  /* ses_putbuff */
+
+
+/********************************************************************
+* FUNCTION put_escaped_str
+*
+* Write a zero-terminated string to the session, one span at a time
+* The span up to the next char in the 'special' set is block-copied
+* and the callback is invoked to write the special char
+*
+* strcspn is used to find the next special char;
+* the C library version uses the vector instructions
+* of the CPU, so long runs of plain text are scanned
+* and copied without a per-char loop
+*
+* INPUTS:
+*   scb == session control block to start msg 
+*   str == string to write
+*   special == zero-terminated set of chars to escape
+*   putfn == callback to write one special char
+*   indent == indent amount to pass to the callback
+*
+*********************************************************************/
+static void
+    put_escaped_str (ses_cb_t *scb,
+                     const xmlChar *str,
+                     const char *special,
+                     void (*putfn)(ses_cb_t *, xmlChar, int32),
+                     int32 indent)
+{
+    size_t   len;
+
+    while (*str) {
+        len = strcspn((const char *)str, special);
+        if (len) {
+            ses_putbuff(scb, str, (uint32)len);
+            str += len;
+        }
+        if (*str) {
+            (*putfn)(scb, *str++, indent);
+        }
+    }
+
+}  /* put_escaped_str */
+
+
+/********************************************************************
+* FUNCTION put_indent_newline
+*
+* put_escaped_str callback for a newline in indented content
+*
+* INPUTS:
+*   scb == session control block to start msg 
+*   ch == newline char to write
+*   indent == current indent amount
+*
+*********************************************************************/
+static void
+    put_indent_newline (ses_cb_t *scb,
+                        xmlChar ch,
+                        int32 indent)
+{
+    if (indent < 0) {
+        ses_putchar(scb, ch);
+    } else {
+        ses_indent(scb, indent);
+    }
+
+}  /* put_indent_newline */
+
+
+/********************************************************************
+* FUNCTION put_content_char
+*
+* put_escaped_str callback for XML element content special chars
+*
+* INPUTS:
+*   scb == session control block to start msg 
+*   ch == special char to write
+*   indent == current indent amount
+*
+*********************************************************************/
+static void
+    put_content_char (ses_cb_t *scb,
+                      xmlChar ch,
+                      int32 indent)
+{
+    switch (ch) {
+    case '<':
+        ses_putstr(scb, LTSTR);
+        break;
+    case '>':
+        ses_putstr(scb, GTSTR);
+        break;
+    case '&':
+        ses_putstr(scb, AMPSTR);
+        break;
+    case '\n':
+        put_indent_newline(scb, ch, indent);
+        break;
+    default:
+        ses_putchar(scb, ch);
+    }
+
+}  /* put_content_char */
+
+
+/********************************************************************
+* FUNCTION put_attr_char
+*
+* put_escaped_str callback for XML attribute content special chars
+*
+* INPUTS:
+*   scb == session control block to start msg 
+*   ch == special char to write
+*   indent == current indent amount
+*
+*********************************************************************/
+static void
+    put_attr_char (ses_cb_t *scb,
+                   xmlChar ch,
+                   int32 indent)
+{
+    switch (ch) {
+    case '<':
+        ses_putstr(scb, LTSTR);
+        break;
+    case '>':
+        ses_putstr(scb, GTSTR);
+        break;
+    case '&':
+        ses_putstr(scb, AMPSTR);
+        break;
+    case '"':
+        ses_putstr(scb, QSTR);
+        break;
+    case '\n':
+        if (scb->mode == SES_MODE_XMLDOC || 
+            scb->mode == SES_MODE_TEXT) {
+            put_indent_newline(scb, ch, indent);
+        } else {
+            put_char_entity(scb, ch);
+        }
+        break;
+    default:
+        /* any other whitespace char */
+        put_char_entity(scb, ch);
+    }
+
+}  /* put_attr_char */
+
+
+/********************************************************************
+* FUNCTION put_json_char
+*
+* put_escaped_str callback for JSON string special chars
+*
+* INPUTS:
+*   scb == session control block to start msg 
+*   ch == special char to write
+*   indent == not used
+*
+*********************************************************************/
+static void
+    put_json_char (ses_cb_t *scb,
+                   xmlChar ch,
+                   int32 indent)
+{
+    (void)indent;
+
+    switch (ch) {
+    case '"':
+        ses_putstr(scb, (const xmlChar *)"\\\"");
+        break;
+    case '\\':
+        ses_putstr(scb, (const xmlChar *)"\\\\");
+        break;
+   /* note: JSON translators and validators do not encode
+    * the forward slash as an escaped char, so this case arm
+    * has been removed!!!
+    case '/':
+        ses_putstr(scb, (const xmlChar *)"\\/");
+        break;
+   */
+    case '\b':
+        ses_putstr(scb, (const xmlChar *)"\\b");
+        break;
+    case '\f':
+        ses_putstr(scb, (const xmlChar *)"\\f");
+        break;
+    case '\n':
+        ses_putstr(scb, (const xmlChar *)"\\n");
+        break;
+    case '\r':
+        ses_putstr(scb, (const xmlChar *)"\\r");
+        break;
+    case '\t':
+        ses_putstr(scb, (const xmlChar *)"\\t");
+        break;
+    default:
+        ses_putchar(scb, ch);
+    }
+
+}  /* put_json_char */
+
+
 /********************************************************************
 * FUNCTION ses_putstr
 *
@@ -1155,9 +1436,7 @@ void
     ses_putstr (ses_cb_t *scb,
                 const xmlChar *str)
 {
-    while (*str) {
-        ses_putchar(scb, *str++);
-    }
+    ses_putbuff(scb, str, (uint32)strlen((const char *)str));
 
 }  /* ses_putstr */
 
@@ -1183,17 +1462,10 @@ void
                        int32 indent)
 {
     ses_indent(scb, indent);
-    while (*str) {
-        if (*str == '\n') {
-            if (indent < 0) {
-                ses_putchar(scb, *str++);
-            } else {
-                ses_indent(scb, indent);
-                str++;
-            }
-        } else {
-            ses_putchar(scb, *str++);
-        }
+    if (indent < 0) {
+        ses_putstr(scb, str);
+    } else {
+        put_escaped_str(scb, str, "\n", put_indent_newline, indent);
     }
 }  /* ses_putstr_indent */
 
@@ -1218,27 +1490,10 @@ void
                  const xmlChar *str,
                  int32 indent)
 {
-    while (*str) {
-        if (*str == '<') {
-            ses_putstr(scb, LTSTR);
-            str++;
-        } else if (*str == '>') {
-            ses_putstr(scb, GTSTR);
-            str++;
-        } else if (*str == '&') {
-            ses_putstr(scb, AMPSTR);
-            str++;
-        } else if ((scb->mode == SES_MODE_XMLDOC
-                    || scb->mode == SES_MODE_TEXT) && *str == '\n') {
-            if (indent < 0) {
-                ses_putchar(scb, *str++);
-            } else {
-                ses_indent(scb, indent);
-                str++;
-            }
-        } else {
-            ses_putchar(scb, *str++);
-        }
+    if (scb->mode == SES_MODE_XMLDOC || scb->mode == SES_MODE_TEXT) {
+        put_escaped_str(scb, str, "<>&\n", put_content_char, indent);
+    } else {
+        put_escaped_str(scb, str, "<>&", put_content_char, indent);
     }
 }  /* ses_putcstr */
 
@@ -1261,20 +1516,7 @@ void
     ses_puthstr (ses_cb_t *scb,
                  const xmlChar *str)
 {
-    while (*str) {
-        if (*str == '<') {
-            ses_putstr(scb, LTSTR);
-            str++;
-        } else if (*str == '>') {
-            ses_putstr(scb, GTSTR);
-            str++;
-        } else if (*str == '&') {
-            ses_putstr(scb, AMPSTR);
-            str++;
-        } else {
-            ses_putchar(scb, *str++);
-        }
-    }
+    put_escaped_str(scb, str, "<>&", put_content_char, -1);
 }  /* ses_puthstr */
 
 
@@ -1342,37 +1584,8 @@ void
                  const xmlChar *str,
                  int32 indent)
 {
-    while (*str) {
-        if (*str == '<') {
-            ses_putstr(scb, LTSTR);
-            str++;
-        } else if (*str == '>') {
-            ses_putstr(scb, GTSTR);
-            str++;
-        } else if (*str == '&') {
-            ses_putstr(scb, AMPSTR);
-            str++;
-        } else if (*str == '"') {
-            ses_putstr(scb, QSTR);
-            str++;
-        } else if (*str == '\n') {
-            if (scb->mode == SES_MODE_XMLDOC || 
-                scb->mode == SES_MODE_TEXT) {
-                if (indent < 0) {
-                    ses_putchar(scb, *str++);
-                } else {
-                    ses_indent(scb, indent);
-                    str++;
-                }
-            } else {
-                put_char_entity(scb, *str++);
-            }
-        } else if (isspace(*str)) {
-            put_char_entity(scb, *str++);
-        } else {
-            ses_putchar(scb, *str++);
-        }
-    }
+    /* same whitespace chars as isspace() in the C locale */
+    put_escaped_str(scb, str, "<>&\" \t\n\v\f\r", put_attr_char, indent);
 }  /* ses_putastr */
 
 
@@ -1397,49 +1610,7 @@ void
                  int32 indent)
 {
     ses_indent(scb, indent);
-    while (*str) {
-        switch (*str) {
-        case '"':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, '"');
-            break;
-        case '\\':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, '\\');
-            break;
-       /* note: JSON translators and validators do not encode
-        * the forward slash as an escaped char, so this case arm
-        * has been removed!!!
-        case '/':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, '/');
-            break;
-       */
-        case '\b':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, 'b');
-            break;
-        case '\f':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, 'f');
-            break;
-        case '\n':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, 'n');
-            break;
-        case '\r':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, 'r');
-            break;
-        case '\t':
-            ses_putchar(scb, '\\');
-            ses_putchar(scb, 't');
-            break;
-        default:
-            ses_putchar(scb, *str);
-        }
-        ++str;
-    }
+    put_escaped_str(scb, str, "\"\\\b\f\n\r\t", put_json_char, indent);
 }  /* ses_putjstr */
 
 
@@ -1463,7 +1634,7 @@ void
     ses_indent (ses_cb_t *scb,
                 int32 indent)
 {
-    int32 i;
+    xmlChar  buff[256];
 
     if (indent < 0) {
         return;
@@ -1471,10 +1642,9 @@ void
 
     /* set limit on indentation in case of bug */
     indent = min(indent, 255);
-    ses_putchar(scb, '\n');
-    for (i=0; i<indent; i++) {
-        ses_putchar(scb, ' ');
-    }
+    buff[0] = '\n';
+    memset(&buff[1], ' ', (size_t)indent);
+    ses_putbuff(scb, buff, (uint32)(indent + 1));
 
 }  /* ses_indent */
 
@@ -1853,8 +2023,11 @@ status_t
     ssize_t ret = 0;
     boolean done = FALSE;
 
+    NCX_TRACE_BEGIN(NCX_TRACE_SES_INPUT, scb->sid, NULL);
+
     while (!done) {
         if (scb->state >= SES_ST_SHUTDOWN_REQ) {
+            NCX_TRACE_END(NCX_TRACE_SES_INPUT, NULL);
             return ERR_NCX_SESSION_CLOSED;
         }
 
@@ -1909,6 +2082,7 @@ status_t
             if (res == ERR_NCX_SKIPPED) {
                 res = NO_ERR;
             }
+            NCX_TRACE_END(NCX_TRACE_SES_INPUT, NULL);
             return res;
         }
 
@@ -1919,6 +2093,7 @@ status_t
                 log_info("\nses: session %d shut by remote peer", 
                          scb->sid);
             }
+            NCX_TRACE_END(NCX_TRACE_SES_INPUT, NULL);
             return ERR_NCX_SESSION_CLOSED;
         } else {
             if (LOGDEBUG2) {
@@ -1987,6 +2162,8 @@ status_t
             } /* else the SSH2 channel probably has more bytes to read */
         }
     }
+
+    NCX_TRACE_END(NCX_TRACE_SES_INPUT, NULL);
     return res;
 
 }  /* ses_accept_input */
@@ -2159,6 +2336,8 @@ const xmlChar *
         return (const xmlChar *)NCX_SERVER_TRANSPORT_CLI;
     case SES_TRANSPORT_WEBUI:
         return (const xmlChar *)NCX_SERVER_TRANSPORT_WEBUI;
+    case SES_TRANSPORT_LOCAL:
+        return (const xmlChar *)NCX_SERVER_TRANSPORT_LOCAL;
     default:
         SET_ERROR(ERR_INTERNAL_VAL);
         return (const xmlChar *)"none";
@@ -2235,7 +2414,8 @@ status_t
         scb->protocol = proto;
 
         if ((scb->transport == SES_TRANSPORT_SSH ||
-             scb->transport == SES_TRANSPORT_CLI) &&
+             scb->transport == SES_TRANSPORT_CLI ||
+             scb->transport == SES_TRANSPORT_LOCAL) &&
             proto == NCX_PROTO_NETCONF11) {
             scb->framing11 = TRUE;
         }
@@ -152,7 +152,8 @@ typedef enum ses_transport_t_ {
     SES_TRANSPORT_TCP,   /* tail-f NETCONF over TCP */
     SES_TRANSPORT_HTTP,   /* YumaPro REST API ncxconnect, no framing */
     SES_TRANSPORT_CLI,    /* YumaPro CLI hook (ncxconnect, NETCONF framing) */
-    SES_TRANSPORT_WEBUI     /* YumaPro WEBui (ncxconnect, no framing) */
+    SES_TRANSPORT_WEBUI,    /* YumaPro WEBui (ncxconnect, no framing) */
+    SES_TRANSPORT_LOCAL     /* NETCONF over ncxserver socket (ncxconnect) */
 } ses_transport_t;
 
 
@@ -441,6 +442,25 @@ extern void
 		 uint32    ch);
 
 
+/********************************************************************
+* FUNCTION ses_putbuff
+*
+* Write a span of chars to the session, without any translation
+*
+* THIS FUNCTION DOES NOT CHECK ANY PARAMETERS TO SAVE TIME
+*
+* INPUTS:
+*   scb == session control block to start msg 
+*   buff == buffer to write; does not need to be zero-terminated
+*   bufflen == number of bytes to write
+*
+*********************************************************************/
+extern void
+    ses_putbuff (ses_cb_t *scb,
+		 const xmlChar *buff,
+		 uint32 bufflen);
+
+
 /********************************************************************
 * FUNCTION ses_putstr
 *
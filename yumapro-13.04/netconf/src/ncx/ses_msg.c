@@ -41,6 +41,7 @@ date         init     comment
 
 #include  "procdefs.h"
 #include  "log.h"
+#include  "ncx_trace.h"
 #include  "send_buff.h"
 #include  "ses.h"
 #include  "ses_msg.h"
@@ -174,6 +175,98 @@ static status_t
 }  /* do_send_buff */
 
 
+/********************************************************************
+* FUNCTION stream_send_buff
+*
+* Send or queue a buffer for a session in stream output mode
+* Add framing chars if needed for base:1.1 over SSH
+*
+* The buffer is written right away if no output is pending
+* for the session.  The socket is not waited on; whatever
+* it does not accept is left on the scb->outQ and sent by
+* the main loop when the socket is ready for output
+*
+* INPUTS:
+*   scb == session control block to use
+*   buff == buffer to send
+*   queued == address of return queued flag
+*
+* OUTPUTS:
+*   *queued == TRUE if the buffer was put on the scb->outQ
+*              and a new buffer is needed
+*              FALSE if the buffer can be reused
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    stream_send_buff (ses_cb_t *scb,
+                      ses_msg_buff_t *buff,
+                      boolean *queued)
+{
+    ssize_t    retcnt;
+
+    *queued = FALSE;
+
+    if (scb->framing11) {
+        ses_msg_add_framing(scb, buff);
+
+        /* reset the positions so the framed bytes are
+         * buff[buffpos] to buff[bufflen-1]; the same as
+         * base:1.0 buffers in the outQ
+         */
+        buff->bufflen += buff->buffstart;
+        buff->buffpos = buff->buffstart;
+    } else if (buff->bufflen > buff->buffstart) {
+        buff->buffpos = 0;
+    } else {
+        if (LOGDEBUG2) {
+            log_debug2("\nses_msg: skip sending empty 1.0 buffer on s:%d",
+                       scb->sid);
+        }
+        return NO_ERR;
+    }
+
+    if (LOGDEBUG2) {
+        log_debug2("\nses_msg: send %s buff:%zd for s:%u\n",
+                   (scb->framing11) ? "1.1" : "1.0",
+                   buff->bufflen - buff->buffpos, scb->sid);
+        if (LOGDEBUG3) {
+            trace_buff(buff);
+        }
+    }
+
+    /* keep the output in order if buffers are already waiting */
+    while (dlq_empty(&scb->outQ) && buff->buffpos < buff->bufflen) {
+        retcnt = write(scb->fd, &buff->buff[buff->buffpos],
+                       buff->bufflen - buff->buffpos);
+        if (retcnt < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return errno_to_status();
+        }
+        buff->buffpos += (size_t)retcnt;
+    }
+
+    if (buff->buffpos < buff->bufflen) {
+        if (LOGDEBUG2) {
+            log_debug2("\nses_msg: queued %zd bytes for s:%u",
+                       buff->bufflen - buff->buffpos, scb->sid);
+        }
+        dlq_enque(buff, &scb->outQ);
+        ses_msg_make_outready(scb);
+        *queued = TRUE;
+    }
+
+    return NO_ERR;
+
+}  /* stream_send_buff */
+
+
 /********************************************************************
 * FUNCTION ses_msg_init
 *
@@ -508,6 +601,8 @@ status_t
 
     assert( scb && "scb == NULL" );
 
+    NCX_TRACE_BEGIN(NCX_TRACE_SEND_BUFFS, scb->sid, NULL);
+
     if (LOGDEBUG) {
         log_debug("\nses got send request on session %d", 
                   scb->sid);
@@ -534,7 +629,9 @@ status_t
 
     /* check if an external write function is used */
     if (scb->wrfn) {
-        return (*scb->wrfn)(scb);
+        res = (*scb->wrfn)(scb);
+        NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
+        return res;
     }
 
     memset(iovs, 0x0, sizeof(iovs));
@@ -566,11 +663,15 @@ status_t
 
     /* make sure there is at least one buffer set */
     if (iovs[0].iov_base == NULL) {
+        NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
         return SET_ERROR(ERR_NCX_OPERATION_FAILED);
     }
 
-    if (scb->framing11) {
-        /* send the 'cnt' number of buffs identified above
+    if (scb->framing11 && !scb->stream_output) {
+        /* stream output buffers were framed before they were queued
+         * so they are sent like base:1.0 buffers below
+         *
+         * send the 'cnt' number of buffs identified above
          * do not use the iovs array because this function
          * may not write the entire amount requested
          * and that would not match the huge chunksize;
@@ -579,14 +680,17 @@ status_t
         for (i=0; i < cnt; i++) {
             buff = (ses_msg_buff_t *)dlq_deque(&scb->outQ);
             if (buff == NULL) {
+                NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
                 return SET_ERROR(ERR_INTERNAL_VAL);
             }
             res = do_send_buff(scb, buff);
             ses_msg_free_buff(scb, buff);            
             if (res != NO_ERR) {
+                NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
                 return res;
             }
         }
+        NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
         return NO_ERR;
     }
 
@@ -594,11 +698,15 @@ status_t
      * write a packet to the session socket 
      */
     retcnt = writev(scb->fd, iovs, cnt);
-    if (retcnt < 0) {
-        /* should not need retries because the select loop
-         * indicated this session was ready for output
+    if (retcnt < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                       errno == EINTR)) {
+        /* the select loop indicated this session was ready for
+         * output but nothing was written; try again next loop
          */
+        retcnt = 0;
+    } else if (retcnt < 0) {
         log_info("\nses msg write failed for session %d", scb->sid);
+        NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
         return errno_to_status();
     } else {
         if (LOGDEBUG2) {
@@ -630,6 +738,7 @@ status_t
         }
     }
 
+    NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
     return NO_ERR;
 
 } /* ses_msg_send_buffs */
@@ -671,13 +780,22 @@ status_t ses_msg_new_output_buff (ses_cb_t *scb)
          * is not being streamed right now
          */
         if (buff->bufflen) {
-            res = do_send_buff(scb, buff);
-            ses_msg_init_buff(scb, TRUE, buff);
+            boolean queued = FALSE;
+
+            NCX_TRACE_BEGIN(NCX_TRACE_SEND_BUFFS, scb->sid, NULL);
+            res = stream_send_buff(scb, buff, &queued);
+            NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
+            if (queued) {
+                /* the socket is not ready; get a new buffer */
+                scb->outbuff = NULL;
+                res = ses_msg_new_buff(scb, TRUE, &scb->outbuff);
+            } else {
+                /* reuse the same outbuff again */
+                ses_msg_init_buff(scb, TRUE, buff);
+            }
         } else {
             res = SET_ERROR(ERR_INTERNAL_VAL);
         }
-
-        /* reuse the same outbuff again */
     } else {
         /* save the buffer in the message loop do be sent when
          * the main loop checks if any output pending
@@ -758,8 +876,18 @@ void ses_msg_finish_outmsg (ses_cb_t *scb)
     assert( scb->outbuff && "scb->outbuff is NULL" );
 
     if (scb->stream_output) {
-        res = do_send_buff(scb, scb->outbuff);
-        ses_msg_init_buff(scb, TRUE, scb->outbuff);
+        boolean queued = FALSE;
+
+        NCX_TRACE_BEGIN(NCX_TRACE_SEND_BUFFS, scb->sid, NULL);
+        res = stream_send_buff(scb, scb->outbuff, &queued);
+        NCX_TRACE_END(NCX_TRACE_SEND_BUFFS, NULL);
+        if (queued) {
+            /* rest of the message is sent by the main loop */
+            scb->outbuff = NULL;
+            (void)ses_msg_new_buff(scb, TRUE, &scb->outbuff);
+        } else {
+            ses_msg_init_buff(scb, TRUE, scb->outbuff);
+        }
         if (res != NO_ERR) {
             log_error("\nError: IO failed on session '%d' (%s)", 
                       scb->sid, get_error_string(res));
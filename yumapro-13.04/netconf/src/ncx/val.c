@@ -41,10 +41,12 @@ date         init     comment
 #include <memory.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/time.h>
 #include <xmlstring.h>
 
 #include "procdefs.h"
 #include "b64.h"
+#include "bobhash.h"
 #include "cfg.h"
 #include "dlq.h"
 #include "getcb.h"
@@ -85,6 +87,9 @@ date         init     comment
 
 #define PREFIX_BUFF_SIZE  64
 
+/* second seed for the 64-bit content digest */
+#define VAL_DIGEST_SEED   0x7f4a7c15
+
 
 /********************************************************************
 *                                                                   *
@@ -110,6 +115,12 @@ static uint32 editvars_malloc = 0;
 static uint32 editvars_free = 0;
 #endif
 
+/* Q of ncx_backptr_t; node == virtual val_value_t waiting
+ * for an async refresh of val->virtualval
+ */
+static dlq_hdr_t refreshQ;
+static boolean refreshQ_init = FALSE;
+
 
 /********************************************************************
 * FUNCTION stdout_num
@@ -461,6 +472,16 @@ static void
         val->virtualval = NULL;
     }
 
+    if (full && (val->flags & VAL_FL_REFRESH_PENDING)) {
+        /* do not leave a dangling pointer in the refresh Q */
+        ncx_backptr_t *backptr = ncx_find_backptr(&refreshQ, val);
+        if (backptr) {
+            dlq_remove(backptr);
+            ncx_free_backptr(backptr);
+        }
+        val->flags &= ~VAL_FL_REFRESH_PENDING;
+    }
+
     ncx_btype_t btyp = val->btyp;
     val_value_t *cur = NULL;
 
@@ -1041,6 +1062,25 @@ static boolean
 }  /* process_one_valwalker */
 
 
+/********************************************************************
+* FUNCTION clean_valQ
+* 
+* Free all the val_value_t structs in a Q
+*
+* INPUTS:
+*    valQ == Q of val_value_t to clean
+*********************************************************************/
+static void
+    clean_valQ (dlq_hdr_t *valQ)
+{
+    while (!dlq_empty(valQ)) {
+        val_value_t *val = (val_value_t *)dlq_deque(valQ);
+        val_free_value(val);
+    }
+
+}  /* clean_valQ */
+
+
 /********************************************************************
 * FUNCTION setup_virtual_retval
 * 
@@ -1061,7 +1101,7 @@ static void
     realval->nsid = virval->nsid;
     realval->obj = virval->obj;
     realval->typdef = virval->typdef;
-    realval->flags = virval->flags;
+    realval->flags = virval->flags & ~VAL_FL_REFRESH_PENDING;
     realval->btyp = virval->btyp;
     realval->dataclass = virval->dataclass;
     realval->parent = virval->parent;
@@ -1141,6 +1181,136 @@ static status_t
 }  /* copy_editvars */
 
 
+/********************************************************************
+* FUNCTION get_cache_timeout
+* 
+* Get the number of seconds a cached virtual value is fresh
+*
+* INPUTS:
+*   scb == session control block getting the virtual value
+*          the scb->cache_timeout value will be used
+*          if scb is not NULL and the object has no timeout set
+*   vcache == object vcache struct (may be NULL)
+*   disable_cache == address of return disable flag
+*
+* OUTPUTS:
+*   *disable_cache == TRUE if the cached value must not be used
+*
+* RETURNS:
+*   timeout in seconds
+*********************************************************************/
+static uint32
+    get_cache_timeout (const ses_cb_t *scb,
+                       const obj_vcache_t *vcache,
+                       boolean *disable_cache)
+{
+    uint32 timeout = 0;
+
+    *disable_cache = FALSE;
+
+    if (scb != NULL && scb->cache_timeout == 0) {
+        /* caching disabled for this session */
+        *disable_cache = TRUE;
+    } else if (vcache != NULL && vcache->timeout_set) {
+        timeout = vcache->timeout;
+        if (timeout == 0) {
+            *disable_cache = TRUE;
+        }
+    } else if (scb != NULL) {
+        timeout = scb->cache_timeout;
+    } else {
+        timeout = ncx_get_vtimeout_value();
+    }
+    return timeout;
+
+}  /* get_cache_timeout */
+
+
+/********************************************************************
+* FUNCTION invoke_virtual_getcb
+* 
+* Invoke the get callback for a virtual value and
+* record the time it took in the object vcache struct
+*
+* INPUTS:
+*   val == virtual value to get value for
+*   retval == initialized return value to fill in
+*   vcache == object vcache struct (may be NULL)
+*
+* RETURNS:
+*   status returned by the get callback
+*********************************************************************/
+static status_t
+    invoke_virtual_getcb (val_value_t *val,
+                          val_value_t *retval,
+                          obj_vcache_t *vcache)
+{
+    getcb_fn_t getcb = (getcb_fn_t)val->getcb;
+    struct timeval starttime, endtime;
+
+    if (vcache) {
+        (void)gettimeofday(&starttime, NULL);
+    }
+
+    status_t res = (*getcb)(NULL, GETCB_GET_VALUE, val, retval);
+
+    if (vcache) {
+        (void)gettimeofday(&endtime, NULL);
+        int64 usecs =
+            ((int64)(endtime.tv_sec - starttime.tv_sec) * 1000000) +
+            (int64)(endtime.tv_usec - starttime.tv_usec);
+        uint32 cost = 0;
+        if (usecs > (int64)NCX_MAX_UINT) {
+            cost = NCX_MAX_UINT;
+        } else if (usecs > 0) {
+            cost = (uint32)usecs;
+        }
+        vcache->lastcost = cost;
+        if (cost > vcache->maxcost) {
+            vcache->maxcost = cost;
+        }
+        vcache->totalcost += cost;
+        if (res != NO_ERR && res != ERR_NCX_SKIPPED) {
+            vcache->errors++;
+        }
+    }
+
+    return res;
+
+}  /* invoke_virtual_getcb */
+
+
+/********************************************************************
+* FUNCTION queue_virtual_refresh
+* 
+* Add a virtual value to the Q of values to refresh
+* after the current reply has been sent
+*
+* INPUTS:
+*   val == virtual value with a stale val->virtualval
+*********************************************************************/
+static void
+    queue_virtual_refresh (val_value_t *val)
+{
+    if (val->flags & VAL_FL_REFRESH_PENDING) {
+        return;
+    }
+
+    if (!refreshQ_init) {
+        dlq_createSQue(&refreshQ);
+        refreshQ_init = TRUE;
+    }
+
+    ncx_backptr_t *backptr = ncx_new_backptr(val);
+    if (backptr == NULL) {
+        return;   /* next retrieval will refresh it instead */
+    }
+    dlq_enque(backptr, &refreshQ);
+    val->flags |= VAL_FL_REFRESH_PENDING;
+
+}  /* queue_virtual_refresh */
+
+
 /********************************************************************
 * FUNCTION cache_virtual_value
 * 
@@ -1154,6 +1324,10 @@ static status_t
 * This will be returned if virtual value has no
 * instance at this time.
 *
+* The object ncx:cache-timeout value is used if set;
+* If the object is marked ncx:async-cache-refresh then a
+* stale value is returned and queued for val_refresh_virtual_values
+*
 * INPUTS:
 *   scb == session control block getting the virtual value
 *          the scb->cache_timeout value will be used
@@ -1189,7 +1363,7 @@ static val_value_t *
     }
 #endif
 
-    getcb_fn_t getcb = (getcb_fn_t)val->getcb;
+    obj_vcache_t *vcache = (val->obj) ? obj_get_vcache(val->obj, TRUE) : NULL;
 
     if (val->virtualval != NULL) {
         /* already have a value; check if it is fresh enough */
@@ -1197,18 +1371,9 @@ static val_value_t *
         (void)time(&timenow);
 
         double timediff = difftime(timenow, val->cachetime);
-        double timerval = 0;
         boolean disable_cache = FALSE;
-
-        if (scb != NULL) {
-            timerval = (double)scb->cache_timeout;
-            if (scb->cache_timeout == 0) {
-                disable_cache = TRUE;
-            }
-        } else {
-            uint32 deftimeout = ncx_get_vtimeout_value();
-            timerval = (double)deftimeout;
-        }
+        uint32 timeout = get_cache_timeout(scb, vcache, &disable_cache);
+        double timerval = (double)timeout;
 
 #ifdef VAL_CACHE_DEBUG
         if (LOGDEBUG4) {
@@ -1216,7 +1381,14 @@ static val_value_t *
         }
 #endif
 
-        if (disable_cache || timediff > timerval) {
+        if (!disable_cache && timediff > timerval &&
+            vcache && vcache->async_refresh) {
+            /* stale-while-revalidate: use the old value now */
+            queue_virtual_refresh(val);
+            vcache->stale_hits++;
+            *res = NO_ERR;
+            return val->virtualval;
+        } else if (disable_cache || timediff > timerval) {
 #ifdef VAL_CACHE_DEBUG
             if (LOGDEBUG4) {
                 log_debug4("\nval: refresh virtual val %s", val->name);
@@ -1230,7 +1402,10 @@ static val_value_t *
             log_debug4("\nval: reusing cached virtual val");
         }
 #endif
-
+            if (vcache) {
+                vcache->hits++;
+            }
+            *res = NO_ERR;
             return val->virtualval;
         }
     }
@@ -1250,7 +1425,11 @@ static val_value_t *
     setup_virtual_retval(val, retval);
     (void)time(&val->cachetime);
 
-    *res = (*getcb)(NULL, GETCB_GET_VALUE, val, retval);
+    if (vcache) {
+        vcache->misses++;
+    }
+
+    *res = invoke_virtual_getcb(val, retval, vcache);
     if (*res != NO_ERR) {
         val_free_value(retval);
         retval = NULL;
@@ -1263,6 +1442,158 @@ static val_value_t *
 }  /* cache_virtual_value */
 
 
+/********************************************************************
+* FUNCTION cache_virtual_list
+* 
+* get + cache as val->virtualval; DO NOT FREE the return val
+* Get all the entries of a virtual list place-holder and
+* store them as the children of a list node in the
+* virtualval cache
+*
+* Used by the XPath walker functions, which need all the
+* entries at once; the streaming output code uses the
+* list iterator batches directly
+*
+* INPUTS:
+*   val == virtual list place-holder to get the entries for
+*   res == pointer to output function return status value
+*
+* OUTPUTS:
+*    val->virtualval set to the malloced list node
+*    val->cachetime set to the current time if the iterator is used
+*    *res == the function return status
+*
+* RETURNS:
+*   A pointer to the malloced list node holding the entries
+*   This pointer can not be stored; it is free as part of virtualval
+*********************************************************************/
+static val_value_t *
+    cache_virtual_list (val_value_t *val,
+                        status_t *res)
+{
+    *res = NO_ERR;
+
+    if (val->virtualval != NULL) {
+        time_t timenow;
+        (void)time(&timenow);
+
+        boolean disable_cache = FALSE;
+        uint32 timeout = 
+            get_cache_timeout(NULL, val->obj->vcache, &disable_cache);
+        double timediff = difftime(timenow, val->cachetime);
+        if (!disable_cache && timediff <= (double)timeout) {
+            return val->virtualval;
+        }
+        val_free_value(val->virtualval);
+        val->virtualval = NULL;
+    }
+
+    val_value_t *retval = val_new_value();
+    if (!retval) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    setup_virtual_retval(val, retval);
+    retval->flags &= ~VAL_FL_VIRTUAL_LIST;
+    (void)time(&val->cachetime);
+
+    getcb_iter_t iter;
+    val_init_list_iter(&iter, val, 0);
+    while (*res == NO_ERR && !iter.done) {
+        *res = val_get_list_batch(NULL, &iter);
+        dlq_block_enque(&iter.entryQ, &retval->v.childQ);
+    }
+    val_clean_list_iter(&iter);
+
+    if (*res != NO_ERR) {
+        val_free_value(retval);
+        return NULL;
+    }
+
+    val->virtualval = retval;
+    return retval;
+
+}  /* cache_virtual_list */
+
+
+/********************************************************************
+* FUNCTION walk_virtual_list
+* 
+* Process the entries of a virtual list place-holder
+* for the val_find_all_* functions
+*
+* INPUTS:
+*    walkerfn == callback function to use
+*    cookie1 == cookie1 value to pass to walker fn
+*    cookie2 == cookie2 value to pass to walker fn
+*    listval == virtual list place-holder
+*    modname == module name to filter; NULL for any
+*    name == name of node to filter; NULL for any
+*    configonly = TRUE for config=true only
+*    textmode == TRUE if just testing for text() nodes
+*    descend == TRUE to search the descendants of each entry
+*    forceall == TRUE to descend even if the entry matched
+*
+* RETURNS:
+*   TRUE if normal termination occurred
+*   FALSE if walker fn requested early termination
+*********************************************************************/
+static boolean
+    walk_virtual_list (val_walker_fn_t walkerfn,
+                       void *cookie1,
+                       void *cookie2,
+                       val_value_t *listval,
+                       const xmlChar *modname,
+                       const xmlChar *name,
+                       boolean configonly,
+                       boolean textmode,
+                       boolean descend,
+                       boolean forceall)
+{
+    status_t res = NO_ERR;
+    val_value_t *useval = cache_virtual_list(listval, &res);
+    if (useval == NULL) {
+        log_error("\nError: get virtual list '%s' failed (%s)",
+                  listval->name, get_error_string(res));
+        return TRUE;
+    }
+
+    val_value_t *entry = (val_value_t *)dlq_firstEntry(&useval->v.childQ);
+    for (; entry != NULL; entry = (val_value_t *)dlq_nextEntry(entry)) {
+        boolean fncalled = FALSE;
+        boolean fnresult = process_one_valwalker(walkerfn,
+                                                 cookie1,
+                                                 cookie2,
+                                                 entry,
+                                                 modname,
+                                                 name,
+                                                 configonly,
+                                                 textmode,
+                                                 &fncalled);
+        if (!fnresult) {
+            return FALSE;
+        }
+        if (descend && (!fncalled || forceall)) {
+            fnresult = val_find_all_descendants(walkerfn,
+                                                cookie1,
+                                                cookie2,
+                                                entry,
+                                                modname,
+                                                name,
+                                                configonly,
+                                                textmode,
+                                                FALSE,
+                                                forceall);
+            if (!fnresult) {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+
+}  /* walk_virtual_list */
+
+
 /********************************************************************
 * FUNCTION clone_test
 * 
@@ -1340,21 +1671,12 @@ static val_value_t *
     copy->parent = val->parent;
     copy->nsid = val->nsid;
     copy->btyp = val->btyp;
-    copy->flags = val->flags;
+    copy->flags = val->flags & ~VAL_FL_REFRESH_PENDING;
     copy->dataclass = val->dataclass;
 
     copy->last_modified = val->last_modified;
     copy->etag = val->etag;
 
-    /* copy any active partial locks;
-     * this should be empty for candidate or PDU source
-     * vals, but in case a copy of running is made, this
-     * array of partial locks needs to be transferred
-     */
-    for (i=0; i<VAL_MAX_PLOCKS; i++) {
-        copy->plock[i] = val->plock[i];
-    }
-
     /* copy any active NACM data rules;
      * this should be empty for candidate or PDU source
      * vals, but in case a copy of running is made, this
@@ -1592,6 +1914,136 @@ static const val_value_t *
 }  /* get_next_node */
 
 
+/********************************************************************
+* FUNCTION hash64
+* 
+* Get a 64-bit hash value for a byte string
+*
+* INPUTS:
+*     buff == bytes to hash
+*     len == number of bytes
+*     init == previous hash value to chain from
+* RETURNS:
+*     hash value
+*********************************************************************/
+static uint64
+    hash64 (const void *buff,
+            uint32 len,
+            uint64 init)
+{
+    uint32 hi = bobhash((const uint8 *)buff, len, (uint32)(init >> 32));
+    uint32 lo = bobhash((const uint8 *)buff, len,
+                        (uint32)init ^ VAL_DIGEST_SEED);
+    return ((uint64)hi << 32) | lo;
+
+} /* hash64 */
+
+
+/********************************************************************
+* FUNCTION mix_digest
+* 
+* Scramble a child digest before it is summed into its parent
+* so identical sibling values do not cancel each other
+*
+* INPUTS:
+*     digest == child digest
+*     pos == position of the child in an ordered-by-user list
+*            or leaf-list; 0 otherwise
+* RETURNS:
+*     mixed value
+*********************************************************************/
+static uint64
+    mix_digest (uint64 digest,
+                uint32 pos)
+{
+    digest ^= (uint64)pos * 0x9e3779b97f4a7c15ULL;
+    digest ^= digest >> 33;
+    digest *= 0xff51afd7ed558ccdULL;
+    digest ^= digest >> 33;
+    digest *= 0xc4ceb9fe1a85ec53ULL;
+    digest ^= digest >> 33;
+    return digest;
+
+} /* mix_digest */
+
+
+/********************************************************************
+* FUNCTION digest_child_ok
+* 
+* Check if a child node is covered by the digest of its parent
+*
+* INPUTS:
+*     val == child node to check
+* RETURNS:
+*     TRUE if the node is included
+*********************************************************************/
+static boolean
+    digest_child_ok (const val_value_t *val)
+{
+    if (VAL_IS_DELETED(val) || val_is_virtual(val)) {
+        return FALSE;
+    }
+    return (val->obj == NULL || obj_is_config(val->obj)) ? TRUE : FALSE;
+
+} /* digest_child_ok */
+
+
+/********************************************************************
+* FUNCTION make_digest
+* 
+* Compute the digest for a value node
+* Complex child nodes with a cached digest are not hashed again
+*
+* INPUTS:
+*     val == value node to use
+* RETURNS:
+*     digest (never zero)
+*********************************************************************/
+static uint64
+    make_digest (val_value_t *val)
+{
+    uint64 digest = hash64(&val->nsid, sizeof(val->nsid), 0);
+    if (val->name) {
+        digest = hash64(val->name, xml_strlen(val->name), digest);
+    }
+
+    if (typ_has_children(val->btyp)) {
+        uint64 sum = 0;
+        uint32 pos = 0;
+        const obj_template_t *lastobj = NULL;
+
+        val_value_t *child = val_get_first_child(val);
+        for (; child != NULL; child = val_get_next_child(child)) {
+            if (!digest_child_ok(child)) {
+                continue;
+            }
+
+            /* the entry order only matters for user-ordered lists */
+            if (child->obj && obj_is_system_ordered(child->obj)) {
+                pos = 0;
+            } else if (child->obj == lastobj) {
+                pos++;
+            } else {
+                pos = 1;
+            }
+            lastobj = child->obj;
+
+            sum += mix_digest(val_get_digest(child), pos);
+        }
+        digest = hash64(&sum, sizeof(sum), digest);
+    } else {
+        xmlChar *str = val_make_sprintf_string(val);
+        if (str) {
+            digest = hash64(str, xml_strlen(str), digest);
+            m__free(str);
+        }
+    }
+
+    return (digest) ? digest : 1;
+
+} /* make_digest */
+
+
 /********************************************************************
 * FUNCTION set_stamps
 * 
@@ -1609,6 +2061,7 @@ static void
 {
     val->last_modified = *timestamp;
     val->etag = txid;
+    val->digest = 0;
 
     val_value_t *child = val_get_first_child(val);
     for (; child; child = val_get_next_child(child)) {
@@ -1727,6 +2180,52 @@ void
 }  /* val_init_virtual */
 
 
+/********************************************************************
+* FUNCTION val_init_virtual_list
+* 
+* Special function to initialize a virtual list place-holder node
+* The list entries are retrieved with the getcb_iter_fn_t
+* registered for the list object with agt_cb_register_iter_callback
+*
+* MUST CALL val_new_value FIRST
+*
+* The list must have keys, since each batch resumes after
+* the keys of the last entry of the previous batch.  A list
+* without keys is initialized as an empty (non-virtual) list
+*
+* INPUTS:
+*   val == pointer to the malloced struct to initialize
+*   obj == list object template to use
+*********************************************************************/
+void
+    val_init_virtual_list (val_value_t *val,
+                           obj_template_t *obj)
+{
+#ifdef DEBUG
+    if (!val || !obj) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    if (obj->objtype != OBJ_TYP_LIST) {
+        SET_ERROR(ERR_INTERNAL_VAL);
+        return;
+    }
+
+    val_init_from_template(val, obj);
+
+    if (obj_first_key(obj) == NULL) {
+        /* no resume point for the next batch */
+        SET_ERROR(ERR_NCX_MISSING_KEY);
+        return;
+    }
+
+    val->flags |= VAL_FL_VIRTUAL_LIST;
+
+}  /* val_init_virtual_list */
+
+
 /********************************************************************
 * FUNCTION val_init_from_template
 * 
@@ -5064,6 +5563,8 @@ status_t
         dest->flags &= ~VAL_FL_WITHDEF;
     }
 
+    val_invalidate_digest(dest);
+
     return res;
 
 }  /* val_merge */
@@ -5355,6 +5856,7 @@ void
 
     child->parent = parent;
     dlq_enque(child, &parent->v.childQ);
+    val_invalidate_digest(parent);
 
 }   /* val_add_child */
 
@@ -5379,6 +5881,7 @@ void
 
     child->parent = parent;
     dlq_hdr_t *childQ = &parent->v.childQ;
+    val_invalidate_digest(parent);
 
     /* check new first entry */
     if (dlq_empty(childQ)) {
@@ -5578,6 +6081,7 @@ void
     child->parent = parent;
     if (current) {
         dlq_insertAfter(child, current);
+        val_invalidate_digest(parent);
     } else {
         val_add_child_sorted(child, parent);
     }
@@ -5604,6 +6108,7 @@ void
     }
 #endif
 
+    val_invalidate_digest(child->parent);
     dlq_remove(child);
     child->parent = NULL;
 
@@ -5635,6 +6140,7 @@ void
     newchild->getcb = curchild->getcb;
 
     dlq_swap(newchild, curchild);
+    val_invalidate_digest(newchild->parent);
 
     curchild->parent = NULL;
 
@@ -6705,6 +7211,19 @@ boolean
             continue;
         }
 
+        if (val_is_virtual_list(val)) {
+            if (configonly) {
+                continue;
+            }
+            fnresult = walk_virtual_list(walkerfn, cookie1, cookie2, val,
+                                         modname, name, configonly, 
+                                         textmode, FALSE, FALSE);
+            if (!fnresult) {
+                return FALSE;
+            }
+            continue;
+        }
+
         fnresult = process_one_valwalker(walkerfn,
                                          cookie1,
                                          cookie2,
@@ -6903,6 +7422,19 @@ boolean
             continue;
         }
 
+        if (val_is_virtual_list(val)) {
+            if (configonly) {
+                continue;
+            }
+            fnresult = walk_virtual_list(walkerfn, cookie1, cookie2, val,
+                                         modname, name, configonly, 
+                                         textmode, TRUE, forceall);
+            if (!fnresult) {
+                return FALSE;
+            }
+            continue;
+        }
+
         fncalled = FALSE;
         fnresult = process_one_valwalker(walkerfn,
                                          cookie1,
@@ -9408,28 +9940,391 @@ boolean
 *   and will be freed when the cache is replaced or when
 *   val is freed
 *********************************************************************/
-val_value_t *
-    val_get_virtual_value (ses_cb_t *scb,
-                           val_value_t *val,
-                           status_t *res)
+val_value_t *
+    val_get_virtual_value (ses_cb_t *scb,
+                           val_value_t *val,
+                           status_t *res)
+{
+    val_value_t *retval;
+
+#ifdef DEBUG
+    if (!val || !res) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return NULL;
+    }
+    if (!val->getcb) {
+        *res = SET_ERROR(ERR_INTERNAL_VAL);
+        return NULL;
+    }
+#endif
+
+    retval = cache_virtual_value(scb, val, res);
+    return retval;
+
+}  /* val_get_virtual_value */
+
+
+/********************************************************************
+* FUNCTION val_make_virtual_value
+* 
+* Get a private copy of the value of a virtual value node
+* The val->virtualval cache is not used or changed, unless
+* the object has its own timeout (ncx:cache-timeout or
+* obj_set_cache_timeout); then a copy of the cached value is returned
+* 
+* Used by the streaming retrieval code so large virtual
+* subtrees do not stay cached after they have been written
+*
+* Caller should check for *res == ERR_NCX_SKIPPED
+* This will be returned if virtual value has no
+* instance at this time.
+*
+* INPUTS:
+*   scb == session control block getting the virtual value
+*   val == virtual value to get value for
+*   res == pointer to output function return status value
+*
+* OUTPUTS:
+*    *res == the function return status
+*
+* RETURNS:
+*   A malloced and filled in val_value_t struct
+*   Caller must free this value with val_free_value
+*********************************************************************/
+val_value_t *
+    val_make_virtual_value (ses_cb_t *scb,
+                            val_value_t *val,
+                            status_t *res)
+{
+#ifdef DEBUG
+    if (!val || !res) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return NULL;
+    }
+#endif
+
+    if (!val->getcb) {
+        *res = SET_ERROR(ERR_INTERNAL_VAL);
+        return NULL;
+    }
+
+    obj_vcache_t *vcache = (val->obj) ? obj_get_vcache(val->obj, TRUE) : NULL;
+
+    if (vcache && vcache->timeout_set && vcache->timeout) {
+        /* the object has its own cache policy; use a copy */
+        val_value_t *cacheval = cache_virtual_value(scb, val, res);
+        if (cacheval == NULL) {
+            return NULL;
+        }
+        val_value_t *copyval = val_clone(cacheval);
+        if (copyval == NULL) {
+            *res = ERR_INTERNAL_MEM;
+        }
+        return copyval;
+    }
+
+    val_value_t *retval = val_new_value();
+    if (!retval) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    setup_virtual_retval(val, retval);
+
+    if (vcache) {
+        vcache->misses++;
+    }
+
+    *res = invoke_virtual_getcb(val, retval, vcache);
+    if (*res != NO_ERR) {
+        val_free_value(retval);
+        retval = NULL;
+    }
+    return retval;
+
+}  /* val_make_virtual_value */
+
+
+/********************************************************************
+* FUNCTION val_refresh_virtual_values
+* 
+* Refresh the stale cached virtual values that were
+* returned to a client because the object is marked
+* ncx:async-cache-refresh
+*
+* Called by the server when no request is being processed
+* so the get callbacks are invoked off the <rpc> path
+*
+* INPUTS:
+*   maxcount == max number of values to refresh; 0 == no limit
+*
+* RETURNS:
+*   number of values refreshed
+*********************************************************************/
+uint32
+    val_refresh_virtual_values (uint32 maxcount)
+{
+    uint32 count = 0;
+
+    if (!refreshQ_init) {
+        return 0;
+    }
+
+    while (!dlq_empty(&refreshQ) && (maxcount == 0 || count < maxcount)) {
+        ncx_backptr_t *backptr = (ncx_backptr_t *)dlq_deque(&refreshQ);
+        val_value_t *val = (val_value_t *)ncx_get_backptr_node(backptr);
+        ncx_free_backptr(backptr);
+
+        val->flags &= ~VAL_FL_REFRESH_PENDING;
+        if (!val->getcb) {
+            continue;
+        }
+
+        val_value_t *retval = val_new_value();
+        if (!retval) {
+            return count;
+        }
+        setup_virtual_retval(val, retval);
+
+        obj_vcache_t *vcache = (val->obj) ? val->obj->vcache : NULL;
+        status_t res = invoke_virtual_getcb(val, retval, vcache);
+
+        /* the stale value is dropped even if the refresh failed,
+         * so the next retrieval will invoke the callback again
+         */
+        if (val->virtualval) {
+            val_free_value(val->virtualval);
+            val->virtualval = NULL;
+        }
+
+        if (res == NO_ERR) {
+            val->virtualval = retval;
+            val->virtualval->parent = val->parent;
+            (void)time(&val->cachetime);
+        } else {
+            val_free_value(retval);
+        }
+
+        if (LOGDEBUG3) {
+            log_debug3("\nval: async refresh of virtual val %s (%s)",
+                       val->name, get_error_string(res));
+        }
+        count++;
+    }
+
+    return count;
+
+}  /* val_refresh_virtual_values */
+
+
+/********************************************************************
+* FUNCTION val_virtual_refresh_pending
+* 
+* Check if any stale virtual values are waiting for
+* val_refresh_virtual_values
+*
+* RETURNS:
+*   TRUE if any refresh is pending
+*   FALSE otherwise
+*********************************************************************/
+boolean
+    val_virtual_refresh_pending (void)
+{
+    return (refreshQ_init && !dlq_empty(&refreshQ)) ? TRUE : FALSE;
+
+}  /* val_virtual_refresh_pending */
+
+
+/********************************************************************
+* FUNCTION val_is_virtual_list
+* 
+* Check if the specified value is a virtual list place-holder
+* 
+* INPUTS:
+*   val == value to check
+*   
+* RETURNS:
+*   TRUE if the val is a virtual list place-holder
+*   FALSE otherwise
+*********************************************************************/
+boolean
+    val_is_virtual_list (const val_value_t *val)
+{
+#ifdef DEBUG
+    if (!val) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return FALSE;
+    }
+#endif
+
+    return (val->flags & VAL_FL_VIRTUAL_LIST) ? TRUE : FALSE;
+
+}  /* val_is_virtual_list */
+
+
+/********************************************************************
+* FUNCTION val_init_list_iter
+* 
+* Initialize a virtual list iterator control block
+* 
+* INPUTS:
+*   iter == iterator control block to initialize
+*   listval == virtual list place-holder node to walk
+*   maxentries == max entries per batch (0 == no limit)
+*********************************************************************/
+void
+    val_init_list_iter (getcb_iter_t *iter,
+                        val_value_t *listval,
+                        uint32 maxentries)
+{
+#ifdef DEBUG
+    if (!iter || !listval) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    memset(iter, 0x0, sizeof(getcb_iter_t));
+    iter->listobj = listval->obj;
+    iter->listval = listval;
+    dlq_createSQue(&iter->startkeyQ);
+    dlq_createSQue(&iter->matchQ);
+    dlq_createSQue(&iter->selectQ);
+    dlq_createSQue(&iter->entryQ);
+    iter->maxentries = maxentries;
+
+}  /* val_init_list_iter */
+
+
+/********************************************************************
+* FUNCTION val_clean_list_iter
+* 
+* Clean a virtual list iterator control block
+* All queued values and back pointers are freed
+* 
+* INPUTS:
+*   iter == iterator control block to clean
+*********************************************************************/
+void
+    val_clean_list_iter (getcb_iter_t *iter)
+{
+#ifdef DEBUG
+    if (!iter) {
+        SET_ERROR(ERR_INTERNAL_PTR);
+        return;
+    }
+#endif
+
+    clean_valQ(&iter->startkeyQ);
+    clean_valQ(&iter->matchQ);
+    ncx_clean_backptrQ(&iter->selectQ);
+    clean_valQ(&iter->entryQ);
+
+}  /* val_clean_list_iter */
+
+
+/********************************************************************
+* FUNCTION val_get_list_batch
+* 
+* Get the next batch of entries for a virtual list
+*
+* Entries left in iter->entryQ from the previous batch are freed.
+* The walk resumes after the last entry of the previous batch,
+* so the caller can dequeue entries and keep them
+* 
+* INPUTS:
+*   scb == session control block getting the list (may be NULL)
+*   iter == iterator control block in progress
+*
+* OUTPUTS:
+*   iter->entryQ contains the new batch of entries
+*   iter->done is set to TRUE if this is the last batch
+*   
+* RETURNS:
+*   status; iter->done is set to TRUE if any error
+*********************************************************************/
+status_t
+    val_get_list_batch (ses_cb_t *scb,
+                        getcb_iter_t *iter)
 {
-    val_value_t *retval;
-
 #ifdef DEBUG
-    if (!val || !res) {
-        SET_ERROR(ERR_INTERNAL_PTR);
-        return NULL;
-    }
-    if (!val->getcb) {
-        *res = SET_ERROR(ERR_INTERNAL_VAL);
-        return NULL;
+    if (!iter || !iter->listval) {
+        return SET_ERROR(ERR_INTERNAL_PTR);
     }
 #endif
 
-    retval = cache_virtual_value(scb, val, res);
-    return retval;
+    status_t res = NO_ERR;
 
-}  /* val_get_virtual_value */
+    clean_valQ(&iter->entryQ);
+
+    if (iter->done) {
+        return NO_ERR;
+    }
+
+    getcb_iter_fn_t iterfn = (getcb_iter_fn_t)iter->listobj->itercb;
+    if (iterfn == NULL) {
+        iter->done = TRUE;
+        return SET_ERROR(ERR_INTERNAL_VAL);
+    }
+
+    iter->batchcount++;
+    res = (*iterfn)(scb, iter);
+
+    /* an empty batch always ends the walk, even if the
+     * callback forgot to set the done flag
+     */
+    if (res == NO_ERR && dlq_empty(&iter->entryQ)) {
+        iter->done = TRUE;
+    }
+
+    val_value_t *entry = (val_value_t *)dlq_firstEntry(&iter->entryQ);
+    for (; entry != NULL && res == NO_ERR;
+         entry = (val_value_t *)dlq_nextEntry(entry)) {
+        entry->parent = iter->listval->parent;
+        if (dlq_empty(&entry->indexQ)) {
+            res = val_gen_index_chain(iter->listobj, entry);
+        }
+    }
+
+    /* save the keys of the last entry as the resume point
+     * so the caller can take the entries out of the entryQ
+     */
+    if (res == NO_ERR && !iter->done) {
+        clean_valQ(&iter->startkeyQ);
+
+        entry = (val_value_t *)dlq_lastEntry(&iter->entryQ);
+        const val_index_t *valindex = val_get_first_index(entry);
+        for (; valindex != NULL && res == NO_ERR;
+             valindex = val_get_next_index(valindex)) {
+            val_value_t *keyval = val_clone(valindex->val);
+            if (keyval == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else {
+                dlq_enque(keyval, &iter->startkeyQ);
+            }
+        }
+
+        if (res == NO_ERR && dlq_empty(&iter->startkeyQ)) {
+            /* the walk would start over at the first entry */
+            res = SET_ERROR(ERR_NCX_MISSING_KEY);
+        }
+    }
+
+    if (res != NO_ERR) {
+        iter->done = TRUE;
+        clean_valQ(&iter->entryQ);
+    }
+
+    if (LOGDEBUG3) {
+        log_debug3("\nval_get_list_batch: got batch %u for '%s' (%s)%s",
+                   iter->batchcount,
+                   iter->listval->name,
+                   get_error_string(res),
+                   (iter->done) ? " done" : "");
+    }
+
+    return res;
+
+}  /* val_get_list_batch */
 
 
 /********************************************************************
@@ -10046,6 +10941,7 @@ void
         parent->flags &= ~VAL_FL_SUBTREE_DIRTY;
         parent->last_modified = *timestamp;
         parent->etag = txid;
+        parent->digest = 0;
         clear_default(parent);
         if (obj_is_root(parent->obj)) {
             parent = NULL;
@@ -10057,6 +10953,7 @@ void
     if (is_delete) {
         val->last_modified = *timestamp;
         val->etag = txid;
+        val->digest = 0;
     } else {
         set_stamps(val, timestamp, txid);
     }
@@ -10605,6 +11502,8 @@ void
 
     /* move all the entries at once */
     dlq_block_enque(&srcval->v.childQ, &destval->v.childQ);
+    val_invalidate_digest(srcval);
+    val_invalidate_digest(destval);
 
 }  /* val_move_children */
 
@@ -11212,8 +12111,14 @@ status_t
     assert(buffsize && "buffsize is zero!");
 
     xmlChar numbuff[NCX_MAX_NUMLEN+1];
-    int32 ilen = sprintf((char *)numbuff, "%llu",
-                         (unsigned long long)val->etag);
+    int32 ilen = 0;
+    if (val->obj && obj_is_config(val->obj)) {
+        ilen = sprintf((char *)numbuff, "%016llx",
+                       (unsigned long long)val_get_digest(val));
+    } else {
+        ilen = sprintf((char *)numbuff, "%llu",
+                       (unsigned long long)val->etag);
+    }
     if (ilen < buffsize) {
         xml_strcpy(buff, numbuff);
         return NO_ERR;
@@ -11243,4 +12148,471 @@ time_t *
     return &val->last_modified;
 }
 
+
+/********************************************************************
+* FUNCTION val_get_digest
+* 
+* Get the content digest for the config descendant-or-self
+* nodes of a value node
+* The digest is cached in complex nodes; only the subtrees
+* changed since the last call are hashed again
+*
+* INPUTS:
+*    val == val_value_t data structure to use
+* RETURNS:
+*   64-bit digest (never zero)
+*********************************************************************/
+uint64
+    val_get_digest (val_value_t *val)
+{
+    assert(val && "val is NULL!");
+
+    if (val->digest) {
+        return val->digest;
+    }
+
+    uint64 digest = make_digest(val);
+    if (typ_has_children(val->btyp)) {
+        val->digest = digest;
+    }
+    return digest;
+
+} /* val_get_digest */
+
+
+/********************************************************************
+* FUNCTION val_invalidate_digest
+* 
+* Mark the cached digest of a value node and all its
+* ancestors as stale
+* Must be called if a value in a data tree is changed in place
+* without using the val_add_child, val_remove_child,
+* val_swap_child or val_merge functions
+*
+* INPUTS:
+*    val == value node that was changed
+*********************************************************************/
+void
+    val_invalidate_digest (val_value_t *val)
+{
+    /* a cached parent digest implies cached child digests,
+     * so the walk can stop at the first stale node
+     */
+    if (val && !typ_has_children(val->btyp)) {
+        val = val->parent;
+    }
+    while (val && val->digest) {
+        val->digest = 0;
+        val = val->parent;
+    }
+
+} /* val_invalidate_digest */
+
+
+/********************************************************************
+* FUNCTION make_digest_set
+* 
+* Make a hash set of the digests of the child nodes
+*
+* INPUTS:
+*    val == parent node to use
+*    setsize == address of return set size
+* OUTPUTS:
+*    *setsize == number of slots in the set (power of 2)
+* RETURNS:
+*   malloced set or NULL if malloc failed
+*********************************************************************/
+static uint64 *
+    make_digest_set (val_value_t *val,
+                     uint32 *setsize)
+{
+    uint32 count = 0;
+    val_value_t *child = val_get_first_child(val);
+    for (; child != NULL; child = val_get_next_child(child)) {
+        if (digest_child_ok(child)) {
+            count++;
+        }
+    }
+
+    uint32 size = 16;
+    while (size < count * 2) {
+        size <<= 1;
+    }
+
+    uint64 *set = (uint64 *)m__getMem(size * sizeof(uint64));
+    if (set == NULL) {
+        return NULL;
+    }
+    memset(set, 0x0, size * sizeof(uint64));
+
+    for (child = val_get_first_child(val);
+         child != NULL;
+         child = val_get_next_child(child)) {
+        if (!digest_child_ok(child)) {
+            continue;
+        }
+        uint64 digest = val_get_digest(child);
+        uint32 b = (uint32)digest & (size - 1);
+        while (set[b] != 0 && set[b] != digest) {
+            b = (b + 1) & (size - 1);
+        }
+        set[b] = digest;
+    }
+
+    *setsize = size;
+    return set;
+
+} /* make_digest_set */
+
+
+/********************************************************************
+* FUNCTION in_digest_set
+* 
+* Check if a digest is in a hash set from make_digest_set
+*
+* INPUTS:
+*    set == hash set to check
+*    setsize == number of slots in the set
+*    digest == digest to find
+* RETURNS:
+*   TRUE if found
+*********************************************************************/
+static boolean
+    in_digest_set (const uint64 *set,
+                   uint32 setsize,
+                   uint64 digest)
+{
+    uint32 b = (uint32)digest & (setsize - 1);
+    while (set[b] != 0) {
+        if (set[b] == digest) {
+            return TRUE;
+        }
+        b = (b + 1) & (setsize - 1);
+    }
+    return FALSE;
+
+} /* in_digest_set */
+
+
+/* forward declaration for recursion */
+static status_t
+    diff_node (val_value_t *val1,
+               val_value_t *val2,
+               val_diff_fn_t diffcb,
+               void *cookie,
+               uint32 *count);
+
+
+/********************************************************************
+* FUNCTION next_digest_entry
+* 
+* Get the next child node for a list or leaf-list object
+* that is covered by the digest of its parent
+*
+* INPUTS:
+*    parent == parent node to use
+*    curval == current entry; NULL to get the first entry
+*    obj == list or leaf-list object to find
+* RETURNS:
+*   pointer to the next entry or NULL if none
+*********************************************************************/
+static val_value_t *
+    next_digest_entry (val_value_t *parent,
+                       val_value_t *curval,
+                       const obj_template_t *obj)
+{
+    val_value_t *child = (curval) ? val_get_next_child(curval) :
+        val_get_first_child(parent);
+    for (; child != NULL; child = val_get_next_child(child)) {
+        if (child->obj == obj && digest_child_ok(child)) {
+            return child;
+        }
+    }
+    return NULL;
+
+} /* next_digest_entry */
+
+
+/********************************************************************
+* FUNCTION same_digest_entries
+* 
+* Check if two parent nodes have the same entries for a list
+* or leaf-list object, maybe in a different order
+*
+* INPUTS:
+*    val1 == first parent node
+*    val2 == second parent node
+*    obj == list or leaf-list object to check
+*    set1 == digest set for val1 from make_digest_set
+*    size1 == number of slots in set1
+*    set2 == digest set for val2 from make_digest_set
+*    size2 == number of slots in set2
+* RETURNS:
+*   TRUE if each entry is found in the other parent
+*********************************************************************/
+static boolean
+    same_digest_entries (val_value_t *val1,
+                         val_value_t *val2,
+                         const obj_template_t *obj,
+                         const uint64 *set1,
+                         uint32 size1,
+                         const uint64 *set2,
+                         uint32 size2)
+{
+    uint32 count1 = 0, count2 = 0;
+
+    val_value_t *entry = next_digest_entry(val1, NULL, obj);
+    for (; entry != NULL; entry = next_digest_entry(val1, entry, obj)) {
+        if (!in_digest_set(set2, size2, val_get_digest(entry))) {
+            return FALSE;
+        }
+        count1++;
+    }
+
+    entry = next_digest_entry(val2, NULL, obj);
+    for (; entry != NULL; entry = next_digest_entry(val2, entry, obj)) {
+        if (!in_digest_set(set1, size1, val_get_digest(entry))) {
+            return FALSE;
+        }
+        count2++;
+    }
+
+    return (count1 == count2) ? TRUE : FALSE;
+
+} /* same_digest_entries */
+
+
+/********************************************************************
+* FUNCTION diff_order
+* 
+* Find the entries of ordered-by-user lists and leaf-lists
+* that are in a different position in the two parent nodes
+* The position is part of the parent digest but the entries
+* themselves have the same digest, so diff_children does not
+* find them.  Only lists with the same entries in both nodes
+* are checked; other changes were already reported
+*
+* INPUTS:
+*    val1 == first parent node
+*    val2 == second parent node
+*    set1 == digest set for val1 from make_digest_set
+*    size1 == number of slots in set1
+*    set2 == digest set for val2 from make_digest_set
+*    size2 == number of slots in set2
+*    diffcb == callback function invoked for each difference
+*    cookie == cookie value to pass to diffcb
+*    count == address of difference counter
+* OUTPUTS:
+*    *count incremented for each difference reported
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    diff_order (val_value_t *val1,
+                val_value_t *val2,
+                const uint64 *set1,
+                uint32 size1,
+                const uint64 *set2,
+                uint32 size2,
+                val_diff_fn_t diffcb,
+                void *cookie,
+                uint32 *count)
+{
+    status_t res = NO_ERR;
+
+    val_value_t *child2 = val_get_first_child(val2);
+    for (; child2 != NULL && res == NO_ERR;
+         child2 = val_get_next_child(child2)) {
+        const obj_template_t *obj = child2->obj;
+        if (obj == NULL || obj_is_system_ordered(obj) ||
+            !(obj_is_list(obj) || obj_is_leaf_list(obj)) ||
+            next_digest_entry(val2, NULL, obj) != child2) {
+            /* not the first entry of a user-ordered list */
+            continue;
+        }
+
+        if (!same_digest_entries(val1, val2, obj, set1, size1, 
+                                 set2, size2)) {
+            continue;
+        }
+
+        val_value_t *entry1 = next_digest_entry(val1, NULL, obj);
+        val_value_t *entry2 = child2;
+        while (entry1 && entry2 && res == NO_ERR) {
+            if (val_get_digest(entry1) != val_get_digest(entry2)) {
+                /* entry2 moved; report it with its match in val1 */
+                val_value_t *match = val_first_child_match(val1, entry2);
+                (*count)++;
+                res = (*diffcb)((match) ? match : entry1, entry2,
+                                OP_EDITOP_REPLACE, cookie);
+            }
+            entry1 = next_digest_entry(val1, entry1, obj);
+            entry2 = next_digest_entry(val2, entry2, obj);
+        }
+    }
+
+    return res;
+
+} /* diff_order */
+
+
+/********************************************************************
+* FUNCTION diff_children
+* 
+* Find the differences between the child nodes of two nodes
+* Child nodes with a digest that is also found in the
+* other node are the same and are skipped, unless they
+* moved in an ordered-by-user list or leaf-list
+*
+* INPUTS:
+*    val1 == first parent node
+*    val2 == second parent node
+*    diffcb == callback function invoked for each difference
+*    cookie == cookie value to pass to diffcb
+*    count == address of difference counter
+* OUTPUTS:
+*    *count incremented for each difference reported
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    diff_children (val_value_t *val1,
+                   val_value_t *val2,
+                   val_diff_fn_t diffcb,
+                   void *cookie,
+                   uint32 *count)
+{
+    uint32 size1 = 0, size2 = 0;
+    uint64 *set1 = make_digest_set(val1, &size1);
+    uint64 *set2 = make_digest_set(val2, &size2);
+    if (set1 == NULL || set2 == NULL) {
+        if (set1) {
+            m__free(set1);
+        }
+        if (set2) {
+            m__free(set2);
+        }
+        return ERR_INTERNAL_MEM;
+    }
+
+    status_t res = NO_ERR;
+    val_value_t *child1 = val_get_first_child(val1);
+    for (; child1 != NULL && res == NO_ERR;
+         child1 = val_get_next_child(child1)) {
+        if (!digest_child_ok(child1) ||
+            in_digest_set(set2, size2, val_get_digest(child1))) {
+            continue;
+        }
+
+        val_value_t *child2 = val_first_child_match(val2, child1);
+        if (child2 && digest_child_ok(child2)) {
+            res = diff_node(child1, child2, diffcb, cookie, count);
+        } else {
+            (*count)++;
+            res = (*diffcb)(child1, NULL, OP_EDITOP_DELETE, cookie);
+        }
+    }
+
+    val_value_t *child2 = val_get_first_child(val2);
+    for (; child2 != NULL && res == NO_ERR;
+         child2 = val_get_next_child(child2)) {
+        if (!digest_child_ok(child2) ||
+            in_digest_set(set1, size1, val_get_digest(child2))) {
+            continue;
+        }
+
+        /* nodes in both trees were done in the first loop */
+        child1 = val_first_child_match(val1, child2);
+        if (child1 == NULL || !digest_child_ok(child1)) {
+            (*count)++;
+            res = (*diffcb)(NULL, child2, OP_EDITOP_CREATE, cookie);
+        }
+    }
+
+    if (res == NO_ERR) {
+        res = diff_order(val1, val2, set1, size1, set2, size2,
+                         diffcb, cookie, count);
+    }
+
+    m__free(set1);
+    m__free(set2);
+    return res;
+
+} /* diff_children */
+
+
+/********************************************************************
+* FUNCTION diff_node
+* 
+* Find the differences between two nodes for the same data node
+*
+* INPUTS:
+*    val1 == first node
+*    val2 == second node
+*    diffcb == callback function invoked for each difference
+*    cookie == cookie value to pass to diffcb
+*    count == address of difference counter
+* OUTPUTS:
+*    *count incremented for each difference reported
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    diff_node (val_value_t *val1,
+               val_value_t *val2,
+               val_diff_fn_t diffcb,
+               void *cookie,
+               uint32 *count)
+{
+    if (val_get_digest(val1) == val_get_digest(val2)) {
+        return NO_ERR;
+    }
+
+    if (typ_has_children(val1->btyp) && typ_has_children(val2->btyp)) {
+        uint32 startcount = *count;
+        status_t res = diff_children(val1, val2, diffcb, cookie, count);
+        if (res != NO_ERR || *count != startcount) {
+            return res;
+        }
+        /* same child nodes in a different order */
+    }
+
+    (*count)++;
+    return (*diffcb)(val1, val2, OP_EDITOP_REPLACE, cookie);
+
+} /* diff_node */
+
+
+/********************************************************************
+* FUNCTION val_diff_digest
+* 
+* Find the differences between the config descendant nodes
+* of two value trees with the same schema node
+* Subtrees with the same digest are skipped without
+* visiting their descendant nodes
+*
+* INPUTS:
+*    val1 == first value tree to compare
+*    val2 == second value tree to compare
+*    diffcb == callback function invoked for each difference
+*    cookie == cookie value to pass to diffcb
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    val_diff_digest (val_value_t *val1,
+                     val_value_t *val2,
+                     val_diff_fn_t diffcb,
+                     void *cookie)
+{
+    assert(val1 && "val1 is NULL!");
+    assert(val2 && "val2 is NULL!");
+    assert(diffcb && "diffcb is NULL!");
+
+    uint32 count = 0;
+    return diff_node(val1, val2, diffcb, cookie, &count);
+
+} /* val_diff_digest */
+
 /* END file val.c */
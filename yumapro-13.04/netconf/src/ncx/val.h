@@ -116,9 +116,6 @@ extern "C" {
 *								    *
 *********************************************************************/
 
-/* max number of concurrent partial locks by the same session */
-#define VAL_MAX_PLOCKS  4
-
 /* max number of NACM data rules that can refer to the same value node */
 #define VAL_MAX_DATARULES  4
 
@@ -194,10 +191,24 @@ extern "C" {
  */
 #define VAL_FL_CHILD_DELETED bit11
 
+/* if set, value is a place-holder for a list whose entries
+ * are not stored in the database; the getcb_iter_fn_t in
+ * val->obj->itercb is used to get the entries in batches
+ */
+#define VAL_FL_VIRTUAL_LIST bit12
+
+/* if set, value is a virtual node with a stale val->virtualval
+ * waiting for val_refresh_virtual_values
+ */
+#define VAL_FL_REFRESH_PENDING bit13
+
 
 /* set the virtualval lifetime to 3 seconds */
 #define VAL_VIRTUAL_CACHE_TIME   3
 
+/* max number of entries requested in 1 virtual list batch */
+#define VAL_VIRTUAL_LIST_BATCH   64
+
 
 /* macros to access simple value types */
 #define VAL_BOOL(V)    (V)->v.boo
@@ -284,6 +295,8 @@ extern "C" {
 
 #define VAL_ETAG(V) (V)->etag
 
+#define VAL_DIGEST(V) (V)->digest
+
 #define VAL_BTYPE(V) (V)->btyp
 
 /********************************************************************
@@ -292,6 +305,9 @@ extern "C" {
 *								    *
 *********************************************************************/
 
+/* virtual list iterator control block, defined in getcb.h */
+struct getcb_iter_t_;
+
 /* one QName for the NCX_BT_IDREF value */
 typedef struct val_idref_t_ {
     xmlns_id_t  nsid;
@@ -349,6 +365,12 @@ typedef struct val_value_t_ {
     time_t         last_modified;
     ncx_etag_t     etag;
 
+    /* cached content digest of the config descendant-or-self
+     * nodes of a complex node; 0 if not computed or stale
+     * use val_get_digest to read it
+     */
+    uint64         digest;
+
     /* YANG does not support user-defined meta-data but NCX does.
      * The <edit-config>, <get> and <get-config> operations 
      * use attributes in the RPC parameters, the metaQ is still used
@@ -402,11 +424,6 @@ typedef struct val_value_t_ {
      */
     struct xpath_pcb_t_            *xpathpcb;
 
-    /* back-ptr to the partial locks that are held
-     * against this node
-     */
-    plock_cb_t  *plock[VAL_MAX_PLOCKS];
-
     /* back-ptr to the data access control rules that
      * reference this node
      */
@@ -509,6 +526,28 @@ typedef boolean
 			void *cookie2);
 
 
+/* digest diff callback function
+ *
+ * INPUTS:
+ *   val1 == node from the first tree; NULL if editop is create
+ *   val2 == node from the second tree; NULL if editop is delete
+ *   editop == type of difference found
+ *      OP_EDITOP_CREATE: node is only in the second tree
+ *      OP_EDITOP_DELETE: node is only in the first tree
+ *      OP_EDITOP_REPLACE: node is in both trees but the value
+ *                         or the order of its entries differs
+ *   cookie == cookie value passed to val_diff_digest
+ *
+ * RETURNS:
+ *   status; the diff is stopped if not NO_ERR
+ */
+typedef status_t
+    (*val_diff_fn_t) (val_value_t *val1,
+                      val_value_t *val2,
+                      op_editop_t editop,
+                      void *cookie);
+
+
 typedef enum val_dumpvalue_mode_t_ {
     DUMP_VAL_NONE,
     DUMP_VAL_STDOUT,
@@ -571,6 +610,28 @@ extern void
 		      struct obj_template_t_ *obj);
 
 
+/********************************************************************
+* FUNCTION val_init_virtual_list
+* 
+* Special function to initialize a virtual list place-holder node
+* The list entries are retrieved with the getcb_iter_fn_t
+* registered for the list object with agt_cb_register_iter_callback
+*
+* MUST CALL val_new_value FIRST
+*
+* The list must have keys, since each batch resumes after
+* the keys of the last entry of the previous batch.  A list
+* without keys is initialized as an empty (non-virtual) list
+*
+* INPUTS:
+*   val == pointer to the malloced struct to initialize
+*   obj == list object template to use
+*********************************************************************/
+extern void
+    val_init_virtual_list (val_value_t *val,
+			   struct obj_template_t_ *obj);
+
+
 /********************************************************************
 * FUNCTION val_init_from_template
 * 
@@ -3239,6 +3300,152 @@ extern val_value_t *
 			   status_t *res);
 
 
+/********************************************************************
+* FUNCTION val_make_virtual_value
+* 
+* Get a private copy of the value of a virtual value node
+* The val->virtualval cache is not used or changed, unless
+* the object has its own timeout (ncx:cache-timeout or
+* obj_set_cache_timeout); then a copy of the cached value is returned
+* 
+* Used by the streaming retrieval code so large virtual
+* subtrees do not stay cached after they have been written
+*
+* Caller should check for *res == ERR_NCX_SKIPPED
+* This will be returned if virtual value has no
+* instance at this time.
+*
+* INPUTS:
+*   scb == session control block getting the virtual value
+*   val == virtual value to get value for
+*   res == pointer to output function return status value
+*
+* OUTPUTS:
+*    *res == the function return status
+*
+* RETURNS:
+*   A malloced and filled in val_value_t struct
+*   Caller must free this value with val_free_value
+*********************************************************************/
+extern val_value_t *
+    val_make_virtual_value (ses_cb_t *scb,
+                            val_value_t *val,
+                            status_t *res);
+
+
+/********************************************************************
+* FUNCTION val_refresh_virtual_values
+* 
+* Refresh the stale cached virtual values that were
+* returned to a client because the object is marked
+* ncx:async-cache-refresh
+*
+* Called by the server when no request is being processed
+* so the get callbacks are invoked off the <rpc> path
+*
+* INPUTS:
+*   maxcount == max number of values to refresh; 0 == no limit
+*
+* RETURNS:
+*   number of values refreshed
+*********************************************************************/
+extern uint32
+    val_refresh_virtual_values (uint32 maxcount);
+
+
+/********************************************************************
+* FUNCTION val_virtual_refresh_pending
+* 
+* Check if any stale virtual values are waiting for
+* val_refresh_virtual_values
+*
+* RETURNS:
+*   TRUE if any refresh is pending
+*   FALSE otherwise
+*********************************************************************/
+extern boolean
+    val_virtual_refresh_pending (void);
+
+
+/********************************************************************
+* FUNCTION val_is_virtual_list
+* 
+* Check if the specified value is a virtual list place-holder
+* 
+* INPUTS:
+*   val == value to check
+*   
+* RETURNS:
+*   TRUE if the val is a virtual list place-holder
+*   FALSE otherwise
+*********************************************************************/
+extern boolean
+    val_is_virtual_list (const val_value_t *val);
+
+
+/********************************************************************
+* FUNCTION val_init_list_iter
+* 
+* Initialize a virtual list iterator control block
+* 
+* INPUTS:
+*   iter == iterator control block to initialize
+*   listval == virtual list place-holder node to walk
+*   maxentries == max entries per batch (0 == no limit)
+*********************************************************************/
+extern void
+    val_init_list_iter (struct getcb_iter_t_ *iter,
+                        val_value_t *listval,
+                        uint32 maxentries);
+
+
+/********************************************************************
+* FUNCTION val_clean_list_iter
+* 
+* Clean a virtual list iterator control block
+* All queued values and back pointers are freed
+* 
+* INPUTS:
+*   iter == iterator control block to clean
+*********************************************************************/
+extern void
+    val_clean_list_iter (struct getcb_iter_t_ *iter);
+
+
+/********************************************************************
+* FUNCTION val_get_list_batch
+* 
+* Get the next batch of entries for a virtual list
+*
+* Entries left in iter->entryQ from the previous batch are freed.
+* The walk resumes after the last entry of the previous batch,
+* so the caller can dequeue entries and keep them
+* 
+* Usage:
+*    getcb_iter_t iter;
+*    val_init_list_iter(&iter, listval, VAL_VIRTUAL_LIST_BATCH);
+*    while (res == NO_ERR && !iter.done) {
+*        res = val_get_list_batch(scb, &iter);
+*        ... use entries in iter.entryQ ...
+*    }
+*    val_clean_list_iter(&iter);
+*
+* INPUTS:
+*   scb == session control block getting the list (may be NULL)
+*   iter == iterator control block in progress
+*
+* OUTPUTS:
+*   iter->entryQ contains the new batch of entries
+*   iter->done is set to TRUE if this is the last batch
+*   
+* RETURNS:
+*   status; iter->done is set to TRUE if any error
+*********************************************************************/
+extern status_t
+    val_get_list_batch (ses_cb_t *scb,
+                        struct getcb_iter_t_ *iter);
+
+
 /********************************************************************
 * FUNCTION val_is_default
 * 
@@ -4032,6 +4239,8 @@ extern boolean
 * FUNCTION val_sprintf_etag
 * 
 * Write the Entity Tag for the value to the specified buffer
+* The content digest is used for config nodes; the
+* transaction ID of the last change is used otherwise
 *
 * INPUTS:
 *    val == val_value_t data structure to use
@@ -4062,6 +4271,63 @@ extern time_t *
     val_get_last_modified (val_value_t *val);
 
 
+/********************************************************************
+* FUNCTION val_get_digest
+* 
+* Get the content digest for the config descendant-or-self
+* nodes of a value node
+* The digest is cached in complex nodes; only the subtrees
+* changed since the last call are hashed again
+*
+* INPUTS:
+*    val == val_value_t data structure to use
+* RETURNS:
+*   64-bit digest (never zero)
+*********************************************************************/
+extern uint64
+    val_get_digest (val_value_t *val);
+
+
+/********************************************************************
+* FUNCTION val_invalidate_digest
+* 
+* Mark the cached digest of a value node and all its
+* ancestors as stale
+* Must be called if a value in a data tree is changed in place
+* without using the val_add_child, val_remove_child,
+* val_swap_child or val_merge functions
+*
+* INPUTS:
+*    val == value node that was changed
+*********************************************************************/
+extern void
+    val_invalidate_digest (val_value_t *val);
+
+
+/********************************************************************
+* FUNCTION val_diff_digest
+* 
+* Find the differences between the config descendant nodes
+* of two value trees with the same schema node
+* Subtrees with the same digest are skipped without
+* visiting their descendant nodes
+*
+* INPUTS:
+*    val1 == first value tree to compare
+*    val2 == second value tree to compare
+*    diffcb == callback function invoked for each difference
+*    cookie == cookie value to pass to diffcb
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    val_diff_digest (val_value_t *val1,
+                     val_value_t *val2,
+                     val_diff_fn_t diffcb,
+                     void *cookie);
+
+
 #ifdef __cplusplus
 }  /* end extern 'C' */
 #endif
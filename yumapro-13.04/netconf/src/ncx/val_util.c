@@ -2763,6 +2763,33 @@ status_t
         }
     }
 
+    /* Process --log-async; started after the logfile is open */
+    val = val_find_child(parentval, val_get_mod_name(parentval),
+                         NCX_EL_LOGASYNC);
+    if (val && val->res == NO_ERR && !log_get_async()) {
+        boolean block = TRUE;
+        uint32 rotsize = 0;
+        val_value_t *chval;
+
+        chval = val_find_child(parentval, val_get_mod_name(parentval),
+                               NCX_EL_LOGASYNCOVERFLOW);
+        if (chval && chval->res == NO_ERR &&
+            !xml_strcmp(VAL_ENUM_NAME(chval), (const xmlChar *)"drop")) {
+            block = FALSE;
+        }
+        chval = val_find_child(parentval, val_get_mod_name(parentval),
+                               NCX_EL_LOGROTATESIZE);
+        if (chval && chval->res == NO_ERR) {
+            rotsize = VAL_UINT(chval) * 1024;
+        }
+        res = log_set_async(block, rotsize);
+        if (res != NO_ERR) {
+            log_error("\nError: start log-async writer failed (%s)",
+                      get_error_string(res));
+            return res;
+        }
+    }
+
     /* Process --log-stderr */
     val = val_find_child(parentval, val_get_mod_name(parentval),
                          NCX_EL_LOGSTDERR);
@@ -3331,19 +3358,15 @@ void
 * RETURNS:
 *   status:  if any error, then val_clear_partial_lock
 *   MUST be called with the start root, to back out any
-*   partial operations.  This can happen if the max number
-*   of 
+*   partial operations.
 *********************************************************************/
 status_t
     val_ok_to_partial_lock (val_value_t *val,
                             ses_id_t sesid,
                             ses_id_t *lockowner)
 {
-    val_value_t   *childval;
+    plock_cb_t    *plcb;
     status_t       res;
-    uint32         i;
-    boolean        anyavail;
-    ses_id_t       owner;
 
 #ifdef DEBUG
     if (val == NULL || lockowner == NULL) {
@@ -3361,41 +3384,16 @@ status_t
     res = NO_ERR;
     *lockowner = 0;
 
-    /* check for an empty slot and locked-by-another session */
-    anyavail = FALSE;
-    for (i = 0; i < VAL_MAX_PLOCKS; i++) {
-        if (val->plock[i] == NULL) {
-            anyavail = TRUE;
-        } else {
-            owner = plock_get_sid(val->plock[i]);
-            if (owner != sesid) {
-                *lockowner = owner;
-                return ERR_NCX_LOCK_DENIED;
-            }
-        }
-    }
-
-    if (!anyavail) {
-        return ERR_NCX_RESOURCE_DENIED;
-    }
-
-    for (childval = val_get_first_child(val);
-         childval != NULL;
-         childval = val_get_next_child(childval)) {
-
-        if (!val_is_config_data(childval)) {
-            continue;
-        }
-
-        res = val_ok_to_partial_lock(childval, 
-                                     sesid, 
-                                     lockowner);
-        if (res != NO_ERR) {
-            return res;
-        }
+    /* any lock by another session on this node, an ancestor,
+     * or a descendant overlaps the requested subtree
+     */
+    plcb = plock_find_conflict(val, sesid, TRUE, TRUE, &res);
+    if (plcb != NULL) {
+        *lockowner = plock_get_sid(plcb);
+        return ERR_NCX_LOCK_DENIED;
     }
 
-    return NO_ERR;
+    return res;
 
     } /* val_ok_to_partial_lock */
 
@@ -3412,16 +3410,14 @@ status_t
 * RETURNS:
 *   status:  if any error, then val_clear_partial_lock
 *   MUST be called with the start root, to back out any
-*   partial operations.  This can happen if the max number
-*   of locks reached or lock already help by another session
+*   partial operations.  This can happen if the
+*   lock is already held by another session
 *********************************************************************/
 status_t
     val_set_partial_lock (val_value_t *val,
                           plock_cb_t *plcb)
 {
-    uint32           i;
-    boolean          anyavail, done;
-    ses_id_t         newsid;
+    status_t         res;
 
 #ifdef DEBUG
     if (val == NULL || plcb == NULL) {
@@ -3433,31 +3429,16 @@ status_t
         return ERR_NCX_NOT_CONFIG;
     }
 
-    newsid = plock_get_sid(plcb);
-
-    /* check for an empty slot and locked-by-another session */
-    anyavail = FALSE;
-    for (i = 0; i < VAL_MAX_PLOCKS; i++) {
-        if (val->plock[i] == NULL) {
-            anyavail = TRUE;
-        } else if (plock_get_sid(val->plock[i]) != newsid) {
-            return ERR_NCX_LOCK_DENIED;
-        }
-    }
-
-    if (!anyavail) {
-        return ERR_NCX_RESOURCE_DENIED;
+    res = NO_ERR;
+    if (plock_find_conflict(val, plock_get_sid(plcb), 
+                            TRUE, TRUE, &res) != NULL) {
+        return ERR_NCX_LOCK_DENIED;
     }
-
-    done = FALSE;
-    for (i = 0; i < VAL_MAX_PLOCKS && !done; i++) {
-        if (val->plock[i] == NULL) {
-            val->plock[i] = plcb;
-            done = TRUE;
-        }
+    if (res != NO_ERR) {
+        return res;
     }
 
-    return NO_ERR;
+    return plock_add_node(plcb, val);
 
 }  /* val_set_partial_lock */
 
@@ -3476,9 +3457,6 @@ void
     val_clear_partial_lock (val_value_t *val,
                             plock_cb_t *plcb)
 {
-    val_value_t   *childval;
-    uint32         i;
-
 #ifdef DEBUG
     if (val == NULL || plcb == NULL) {
         SET_ERROR(ERR_INTERNAL_PTR);
@@ -3486,25 +3464,10 @@ void
     }
 #endif
 
-    if (!val_is_config_data(val)) {
-        return;
-    }
-
-    /* check for the specified plcb */
-    for (i = 0; i < VAL_MAX_PLOCKS; i++) {
-        if (val->plock[i] == plcb) {
-            val->plock[i] = NULL;
-            return;
-        }
-    }
-
-    for (childval = val_get_first_child(val);
-         childval != NULL;
-         childval = val_get_next_child(childval)) {
-
-        if (val_is_config_data(childval)) {
-            val_clear_partial_lock(childval, plcb);
-        }
+    if (obj_is_root(val->obj)) {
+        plock_remove_all_nodes(plcb);
+    } else if (val_is_config_data(val)) {
+        plock_remove_node(plcb, val);
     }
 
 }  /* val_clear_partial_lock */
@@ -3542,10 +3505,10 @@ status_t
                   uint32 *lockid)
 
 {
-    val_value_t   *childval, *upval;
     cfg_template_t *running;
-    uint32         i;
-    status_t       res;
+    plock_cb_t     *plcb;
+    boolean         checkdown;
+    status_t        res;
 
 #ifdef DEBUG
     if (val == NULL || lockid == NULL) {
@@ -3567,45 +3530,11 @@ status_t
         return NO_ERR;
     }
 
-    /* check for the specified session ID
-     * this function should not be called for
-     * the create operation, since there must not be
-     * an existing instance that could be locked
-     * in order for the createoperation to be valid
-     */
-    for (i = 0; i < VAL_MAX_PLOCKS; i++) {
-        if (val->plock[i] == NULL) {
-            continue;
-        }
-        if (plock_get_sid(val->plock[i]) != sesid) {
-            /* this node locked by another session */
-            *lockid = plock_get_id(val->plock[i]);
-            return ERR_NCX_IN_USE_LOCKED;
-        }
-    }
-
-    /* see if the path to root needs to be checked
+    /* the path to root is checked if checkup is set
      * because the agt_val_check_commit_edits waited until
      * applyhere to check the partial lock
-     */
-    if (checkup) {
-        upval = val->parent;
-        while (upval != NULL && !obj_is_root(upval->obj)) {
-            for (i = 0; i < VAL_MAX_PLOCKS; i++) {
-                if (upval->plock[i] == NULL) {
-                    continue;
-                }
-                if (plock_get_sid(upval->plock[i]) != sesid) {
-                    /* this node locked by another session */
-                    *lockid = plock_get_id(upval->plock[i]);
-                    return ERR_NCX_IN_USE_LOCKED;
-                }
-            }
-            upval = upval->parent;
-        }
-    }
-
-    /* only replace and delete need to dive into the subtree
+     *
+     * only replace and delete need to dive into the subtree
      * because the config in the PDU does not need to
      * align with the target data tree; and the request
      * is all-or-nothing.  The merge operation will
@@ -3614,24 +3543,19 @@ status_t
      * may be affected by the merge, so any partial locks
      * in those subtrees need to be ignored now
      */
-    if (editop == OP_EDITOP_REPLACE ||
-        editop == OP_EDITOP_DELETE ||
-        editop == OP_EDITOP_REMOVE) {
+    checkdown = (editop == OP_EDITOP_REPLACE ||
+                 editop == OP_EDITOP_DELETE ||
+                 editop == OP_EDITOP_REMOVE) ? TRUE : FALSE;
 
-        for (childval = val_get_first_child(val);
-             childval != NULL;
-             childval = val_get_next_child(childval)) {
-
-            if (val_is_config_data(childval)) {
-                res = val_write_ok(childval, editop, sesid, FALSE, lockid);
-                if (res != NO_ERR) {
-                    return res;
-                }
-            }
-        }
+    res = NO_ERR;
+    plcb = plock_find_conflict(val, sesid, checkup, checkdown, &res);
+    if (plcb != NULL) {
+        /* this node locked by another session */
+        *lockid = plock_get_id(plcb);
+        return ERR_NCX_IN_USE_LOCKED;
     }
 
-    return NO_ERR;
+    return res;
 
 }  /* val_write_ok */
 
@@ -3656,14 +3580,7 @@ void
         return;
     }
 
-    uint32 i = 0;
-    for (; i < VAL_MAX_PLOCKS; i++) {
-        newval->plock[i] = curval->plock[i];
-        if (curval->plock[i] != NULL) {
-            xpath_result_t *result = plock_get_final_result(curval->plock[i]);
-            xpath_nodeset_swap_valptr(result, curval, newval);
-        }
-    }
+    plock_swap_node(curval, newval);
 
 }  /* val_check_swap_resnode */
 
@@ -3685,13 +3602,7 @@ void
         return;
     }
 
-    uint32 i = 0;
-    for (; i < VAL_MAX_PLOCKS; i++) {
-        if (curval->plock[i] != NULL) {
-            xpath_result_t *result = plock_get_final_result((curval->plock[i]));
-            xpath_nodeset_delete_valptr(result, curval);
-        }
-    }
+    plock_delete_node(curval);
 
 }  /* val_check_delete_resnode */
 
@@ -56,6 +56,9 @@ date         init     comment
 #define VAR_DEBUG   1
 #endif
 
+/* number of buckets in the variable name hash table */
+#define VAR_HASH_SIZE  1024
+
 /********************************************************************
 *                                                                   *
 *                            T Y P E S                              *
@@ -69,6 +72,100 @@ date         init     comment
 *                                                                   *
 *********************************************************************/
 
+/* each var in a Q is also in this hash table, keyed by the
+ * Q header address and the var name, so a lookup in any
+ * variable scope does not need to scan the Q
+ */
+static ncx_var_t  *var_hashtab[VAR_HASH_SIZE];
+
+
+/********************************************************************
+* FUNCTION var_hash
+* 
+* Get the hash value for a var name in a Q
+*
+* INPUTS:
+*    que == Q header of the variable scope
+*    name == name of var (not Z-terminated)
+*    namelen == length of name
+*
+* RETURNS:
+*    hash value
+*********************************************************************/
+static uint32
+    var_hash (const dlq_hdr_t *que,
+              const xmlChar *name,
+              uint32 namelen)
+{
+    /* FNV-1a over the name and the Q address */
+    unsigned long  queaddr = (unsigned long)que;
+    uint32         hashval = 2166136261U;
+    uint32         i;
+
+    for (i = 0; i < namelen; i++) {
+        hashval ^= (uint32)name[i];
+        hashval *= 16777619U;
+    }
+    hashval ^= (uint32)(queaddr >> 4);
+    hashval *= 16777619U;
+
+    return hashval;
+
+} /* var_hash */
+
+
+/********************************************************************
+* FUNCTION hash_add_var
+* 
+* Add a var to the name hash table after it is added to a Q
+*
+* INPUTS:
+*    var == var that was added to the Q
+*    que == Q header containing the var
+*********************************************************************/
+static void
+    hash_add_var (ncx_var_t *var,
+                  const dlq_hdr_t *que)
+{
+    var->hashQ = que;
+    var->hashval = var_hash(que, var->name, xml_strlen(var->name));
+
+    uint32 bucket = var->hashval % VAR_HASH_SIZE;
+    var->hashnext = var_hashtab[bucket];
+    var_hashtab[bucket] = var;
+
+} /* hash_add_var */
+
+
+/********************************************************************
+* FUNCTION hash_remove_var
+* 
+* Remove a var from the name hash table, if it is there
+*
+* INPUTS:
+*    var == var being removed from its Q
+*********************************************************************/
+static void
+    hash_remove_var (ncx_var_t *var)
+{
+    if (var->hashQ == NULL) {
+        return;
+    }
+
+    ncx_var_t **link = &var_hashtab[var->hashval % VAR_HASH_SIZE];
+    for (; *link != NULL; link = &(*link)->hashnext) {
+        if (*link == var) {
+            *link = var->hashnext;
+            break;
+        }
+    }
+
+    var->hashnext = NULL;
+    var->hashQ = NULL;
+
+} /* hash_remove_var */
+
+
 
 /********************************************************************
 * FUNCTION new_var
@@ -135,6 +232,7 @@ static void
     if (var == NULL) {
         return;
     }
+    hash_remove_var(var);
     if (var->name) {
         m__free(var->name);
     }
@@ -208,6 +306,7 @@ static status_t
         int ret = xml_strcmp(var->name, cur->name);
         if (ret < 0) {
             dlq_insertAhead(var, cur);
+            hash_add_var(var, que);
             return NO_ERR;
         } else if (ret == 0) {
             return SET_ERROR(ERR_NCX_DUP_ENTRY);
@@ -216,21 +315,22 @@ static status_t
 
     /* if we get here, then new first entry */
     dlq_enque(var, que);
+    hash_add_var(var, que);
     return NO_ERR;
 
 }  /* insert_var */
 
 
 /********************************************************************
-* FUNCTION remove_var
+* FUNCTION find_var
 * 
-* Remove a user var 
+* Find a user var 
 * 
 * INPUTS:
 *   rcxt == runstack context to use
-*   varQ == que to use (NULL if not known yet)
-*   name == var name to remove
-*   namelen == length of name
+*   varQ == que to use or NULL if not known
+*   name == var name to find
+*   namelen == name length
 *   nsid == namespace ID to check if non-zero
 *   vartype == variable type
 *
@@ -238,25 +338,28 @@ static status_t
 *   found var struct or NULL if not found
 *********************************************************************/
 static ncx_var_t *
-    remove_var (runstack_context_t *rcxt,
-                dlq_hdr_t *varQ,
-                const xmlChar *name,
-                uint32 namelen,
-                xmlns_id_t nsid,
-                var_type_t vartype)
+    find_var (runstack_context_t *rcxt,
+              dlq_hdr_t *varQ,
+              const xmlChar *name,
+              uint32  namelen,
+              xmlns_id_t  nsid,
+              var_type_t vartype)
 {
     if (!varQ) {
         varQ = get_que(rcxt, vartype, name);
         if (!varQ) {
-            SET_ERROR(ERR_INTERNAL_VAL);
             return NULL;
         }
     }
 
-    ncx_var_t  *cur;
-    for (cur = (ncx_var_t *)dlq_firstEntry(varQ);
-         cur != NULL;
-         cur = (ncx_var_t *)dlq_nextEntry(cur)) {
+    /* check the hash chain instead of the Q */
+    uint32 hashval = var_hash(varQ, name, namelen);
+    ncx_var_t  *cur = var_hashtab[hashval % VAR_HASH_SIZE];
+    for (; cur != NULL; cur = cur->hashnext) {
+
+        if (cur->hashQ != varQ || cur->hashval != hashval) {
+            continue;
+        }
 
         if (nsid && cur->nsid && nsid != cur->nsid) {
             continue;
@@ -264,26 +367,25 @@ static ncx_var_t *
 
         int ret = xml_strncmp(name, cur->name, namelen);
         if (ret == 0 && xml_strlen(cur->name)==namelen) {
-            dlq_remove(cur);
             return cur;
         } /* else keep going */
     }
 
     return NULL;
 
-}  /* remove_var */
+}  /* find_var */
 
 
 /********************************************************************
-* FUNCTION find_var
+* FUNCTION remove_var
 * 
-* Find a user var 
+* Remove a user var 
 * 
 * INPUTS:
 *   rcxt == runstack context to use
-*   varQ == que to use or NULL if not known
-*   name == var name to find
-*   namelen == name length
+*   varQ == que to use (NULL if not known yet)
+*   name == var name to remove
+*   namelen == length of name
 *   nsid == namespace ID to check if non-zero
 *   vartype == variable type
 *
@@ -291,38 +393,30 @@ static ncx_var_t *
 *   found var struct or NULL if not found
 *********************************************************************/
 static ncx_var_t *
-    find_var (runstack_context_t *rcxt,
-              dlq_hdr_t *varQ,
-              const xmlChar *name,
-              uint32  namelen,
-              xmlns_id_t  nsid,
-              var_type_t vartype)
+    remove_var (runstack_context_t *rcxt,
+                dlq_hdr_t *varQ,
+                const xmlChar *name,
+                uint32 namelen,
+                xmlns_id_t nsid,
+                var_type_t vartype)
 {
     if (!varQ) {
         varQ = get_que(rcxt, vartype, name);
         if (!varQ) {
+            SET_ERROR(ERR_INTERNAL_VAL);
             return NULL;
         }
     }
 
-    ncx_var_t  *cur;
-    for (cur = (ncx_var_t *)dlq_firstEntry(varQ);
-         cur != NULL;
-         cur = (ncx_var_t *)dlq_nextEntry(cur)) {
-
-        if (nsid && cur->nsid && nsid != cur->nsid) {
-            continue;
-        }
-
-        int ret = xml_strncmp(name, cur->name, namelen);
-        if (ret == 0 && xml_strlen(cur->name)==namelen) {
-            return cur;
-        } /* else keep going */
+    ncx_var_t  *cur = find_var(rcxt, varQ, name, namelen, nsid, vartype);
+    if (cur) {
+        dlq_remove(cur);
+        hash_remove_var(cur);
     }
 
-    return NULL;
+    return cur;
 
-}  /* find_var */
+}  /* remove_var */
 
 
 /********************************************************************
@@ -765,6 +859,7 @@ void
     if (var == NULL) {
         return;
     }
+    hash_remove_var(var);
     val_free_value(var->val);
     m__free(var->name);
     m__free(var);
@@ -96,6 +96,11 @@ typedef struct ncx_var_t_ {
     xmlns_id_t    nsid;     /* set to zero if not used */
     xmlChar      *name;
     val_value_t  *val;
+
+    /* name hash chain; set while the var is in a Q */
+    struct ncx_var_t_ *hashnext;
+    const dlq_hdr_t   *hashQ;
+    uint32        hashval;
 } ncx_var_t;
 
 
@@ -36,6 +36,8 @@ date         init     comment
 
 #include "procdefs.h"
 #include "dlq.h"
+#include "getcb.h"
+#include "log.h"
 #include "ncx.h"
 #include "ncx_num.h"
 #include "ncxconst.h"
@@ -73,6 +75,13 @@ static void write_check_val ( ses_cb_t *scb,
                               val_nodetest_fn_t testfn,
                               boolean acmcheck );
 
+static status_t write_virtual_list (ses_cb_t *scb,
+                                    xml_msg_hdr_t *msg,
+                                    val_value_t *val,
+                                    int32  indent,
+                                    val_nodetest_fn_t testfn,
+                                    boolean force_xmlns);
+
 
 /********************************************************************
 * FUNCTION inc_cur_depth
@@ -285,8 +294,7 @@ static void
         ses_putchar(scb, ':');
         ses_putstr(scb, pfix);
     }
-    ses_putchar(scb, '=');
-    ses_putchar(scb, '\"');
+    ses_putstr(scb, (const xmlChar *)"=\"");
     ses_putstr(scb, val);      /* write the namespace URI value */
     ses_putchar(scb, '\"');
 
@@ -519,8 +527,7 @@ static void
         }
 
         ses_putstr(scb, attr_name);
-        ses_putchar(scb, '=');
-        ses_putchar(scb, '\"');
+        ses_putstr(scb, (const xmlChar *)"=\"");
         if (isattrq) {
             ses_putastr(scb, attr->attr_val, -1);
         } else if (typ_is_string(val->btyp)) {
@@ -697,9 +704,10 @@ static void
     /* finish up the element */
     boolean empty = !val_has_content(val);
     if (empty) {
-        ses_putchar(scb, '/');
+        ses_putstr(scb, (const xmlChar *)"/>");
+    } else {
+        ses_putchar(scb, '>');
     }
-    ses_putchar(scb, '>');
 
     /* hack in XMLDOC mode to get more readable XSD output */
     if (empty && scb->mode==SES_MODE_XMLDOC && indent < 
@@ -980,9 +988,9 @@ static void write_slist_bits_val( ses_cb_t *scb,
 *   testcb == callback function to use, NULL if not used
 *   
 * RETURNS:
-*   none
+*   status; only errors getting virtual list entries are returned
 *********************************************************************/
-static void
+static status_t
     write_full_check_val (ses_cb_t *scb,
                           xml_msg_hdr_t *msg,
                           val_value_t *val,
@@ -993,12 +1001,17 @@ static void
     boolean malloced = FALSE;
     status_t res = NO_ERR;
 
+    if (val_is_virtual_list(val)) {
+        return write_virtual_list(scb, msg, val, indent, testfn, 
+                                  force_xmlns);
+    }
+
     xmlns_id_t out_nsid = val_get_nsid(val);
     ncx_btype_t out_btype = val->btyp;
     val_value_t *out = 
         val_get_value(scb, msg, val, testfn, TRUE, &malloced, &res);
     if (!out) {
-        return;
+        return NO_ERR;
     }
 
     if (res != NO_ERR) {
@@ -1009,7 +1022,7 @@ static void
             val_free_value(out);
         }
         /* FIXME: error exit ignored */
-        return;
+        return NO_ERR;
     }
 
     /* not tagging default NP containers, just leafs */
@@ -1066,9 +1079,66 @@ static void
         val_free_value(out);
     }
 
+    return NO_ERR;
+
 }  /* write_full_check_val */
 
 
+/********************************************************************
+* FUNCTION write_virtual_list
+* 
+* Write all the entries of a virtual list place-holder
+* The entries are requested from the list iterator callback
+* in batches, and each batch is freed after it is written
+*
+* The reply has already been started, so an error getting
+* the entries ends the list early; it is logged and returned
+*
+* INPUTS:
+*   scb == session control block
+*   msg == xml_msg_hdr_t in progress
+*   val == virtual list place-holder to write
+*   indent == start indent amount if indent enabled
+*   testcb == callback function to use, NULL if not used
+*   force_xmlns == TRUE if the xmlns attribute should be forced
+*   
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    write_virtual_list (ses_cb_t *scb,
+                        xml_msg_hdr_t *msg,
+                        val_value_t *val,
+                        int32  indent,
+                        val_nodetest_fn_t testfn,
+                        boolean force_xmlns)
+{
+    getcb_iter_t iter;
+    status_t res = NO_ERR;
+
+    val_init_list_iter(&iter, val, VAL_VIRTUAL_LIST_BATCH);
+
+    while (res == NO_ERR && !iter.done) {
+        res = val_get_list_batch(scb, &iter);
+        if (res != NO_ERR) {
+            log_error("\nError: get virtual list '%s' failed (%s)",
+                      val->name, get_error_string(res));
+        }
+
+        val_value_t *entry = (val_value_t *)dlq_firstEntry(&iter.entryQ);
+        for (; entry != NULL && res == NO_ERR;
+             entry = (val_value_t *)dlq_nextEntry(entry)) {
+            res = write_full_check_val(scb, msg, entry, indent, testfn, 
+                                       force_xmlns);
+        }
+    }
+
+    val_clean_list_iter(&iter);
+    return res;
+
+}  /* write_virtual_list */
+
+
 /***********************************************************************/
 /**
  * Write out an NCX String from a list or InstanceID value.
@@ -1386,9 +1456,10 @@ static void
 
     /* finish up the element */
     if (empty) {
-        ses_putchar(scb, '/');
+        ses_putstr(scb, (const xmlChar *)"/>");
+    } else {
+        ses_putchar(scb, '>');
     }
-    ses_putchar(scb, '>');
 
     /* hack in XMLDOC mode to get more readable XSD output */
     if (empty && scb->mode==SES_MODE_XMLDOC && indent < 
@@ -1420,15 +1491,10 @@ void
                  const xmlChar *buff,
                  uint32 bufflen)
 {
-
-    uint32  i;
-
     assert( scb && "scb is NULL!" );
     assert( buff && "buff is NULL!" );
 
-    for (i=0; i<bufflen; i++) {
-        ses_putchar(scb, *buff++);
-    }
+    ses_putbuff(scb, buff, bufflen);
 
 }  /* xml_wr_buff */
 
@@ -1587,8 +1653,7 @@ void
     ses_indent(scb, indent);
 
     /* start the element and write the prefix, if any */
-    ses_putchar(scb, '<');
-    ses_putchar(scb, '/');
+    ses_putstr(scb, (const xmlChar *)"</");
     pfix = NULL;
     if (nsid && XML_MSG_USE_PREFIX(msg)) {
         pfix = xml_msg_get_prefix(msg, 0, nsid, NULL, &xneeded);
@@ -3904,6 +3904,9 @@ status_t
 
     res = parse_yang_module( tkc, mod, pcb, ptyp, &wasadd );
 
+    /* objects may have been added to or removed from modules */
+    ncx_clear_object_indexes();
+
     if (pcb->top == mod) {
         pcb->topadded = wasadd;
         pcb->retmod = NULL;
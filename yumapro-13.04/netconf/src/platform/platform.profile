@@ -176,6 +176,11 @@ ifdef WITH_YANGAPI
   CFLAGS += -DWITH_YANGAPI=1
 endif
 
+# hot-path trace buffer tracepoints; NOTRACE=1 compiles them out
+ifndef NOTRACE
+  CFLAGS += -DWITH_TRACE=1
+endif
+
 ifndef GRP
 ifdef MAC
    GRP=
@@ -218,6 +218,38 @@ status_t
 } /* send_cli_ncxconnect */
 
 
+/********************************************************************
+* FUNCTION send_nc_ncxconnect
+*
+* Send the <ncx-connect> message to the ncxserver for SSH or LOCAL
+* transport for NETCONF protocol
+* 
+* INPUTS:
+*  cb == control vlock to use
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    send_nc_ncxconnect (subsys_cb_t *cb)
+{
+    const char connectmsg[] = 
+        "%s\n<ncx-connect xmlns=\"%s\" version=\"%d\" user=\"%s\" "
+        "address=\"%s\" magic=\"%s\" protocol=\"netconf\" "
+        "transport=\"ssh\" port=\"%s\" />\n%s";
+
+    snprintf(cb->msgbuff, SUBSYS_BUFFLEN, connectmsg,
+             (const char *)XML_START_MSG, 
+             NCX_URN, NCX_SERVER_VERSION, cb->user, cb->client_addr, 
+             NCX_SERVER_MAGIC, cb->port, NC_SSH_END);
+
+    status_t res = send_buff(cb->ncxsock, cb->msgbuff, 
+                             strlen(cb->msgbuff));
+    return res;
+
+} /* send_nc_ncxconnect */
+
+
 /********************************************************************
 * FUNCTION init_subsys_cb
 *
@@ -307,5 +339,59 @@ status_t
 } /* start_subsys_ypshell */
 
 
+/********************************************************************
+* FUNCTION start_subsys_netconf
+*
+* Connect to the ncxserver socket and send the NETCONF <ncx-connect>
+* message, so the socket can be used as a NETCONF session without
+* going through sshd and netconf-subsystem-pro.
+* Used by the client tools for local load and performance testing
+* 
+* INPUTS:
+*  user == user name for the session
+*  port == SSH port number to report; must be allowed by the server
+*  retfd == address of return file desciptor number assigned to
+*           the socket that was created
+* OUTPUTS:
+*  *retfd == the file descriptor number used for the socket
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    start_subsys_netconf (const char *user,
+                          uint16 port,
+                          int *retfd)
+{
+    subsys_cb_t nc_cb;
+    char addrbuff[] = "127.0.0.1";
+    char portbuff[8];
+
+    init_subsys_cb(&nc_cb);
+
+    *retfd = -1;
+
+    snprintf(portbuff, sizeof(portbuff), "%u", (uint32)port);
+    nc_cb.user = user;
+    nc_cb.client_addr = addrbuff;
+    nc_cb.port = portbuff;
+
+    status_t res = start_connection(&nc_cb);
+
+    if (res == NO_ERR) {
+        res = send_nc_ncxconnect(&nc_cb);
+    }
+
+    if (res == NO_ERR) {
+        *retfd = nc_cb.ncxsock;
+    } else if (nc_cb.ncxconnect) {
+        close(nc_cb.ncxsock);
+    }
+
+    return res;
+
+} /* start_subsys_netconf */
+
+
 /* END subsys_util.c */
 
@@ -147,6 +147,22 @@ extern status_t
     send_cli_ncxconnect (subsys_cb_t *cb);
 
 
+/********************************************************************
+* FUNCTION send_nc_ncxconnect
+*
+* Send the <ncx-connect> message to the ncxserver for SSH or LOCAL
+* transport for NETCONF protocol
+* 
+* INPUTS:
+*  cb == control vlock to use
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    send_nc_ncxconnect (subsys_cb_t *cb);
+
+
 /********************************************************************
 * FUNCTION init_subsys_cb
 *
@@ -176,6 +192,30 @@ extern void
 extern status_t
     start_subsys_ypshell (int *retfd);
 
+
+/********************************************************************
+* FUNCTION start_subsys_netconf
+*
+* Connect to the ncxserver socket and send the NETCONF <ncx-connect>
+* message, so the socket can be used as a NETCONF session without
+* going through sshd and netconf-subsystem-pro.
+* 
+* INPUTS:
+*  user == user name for the session
+*  port == SSH port number to report; must be allowed by the server
+*  retfd == address of return file desciptor number assigned to
+*           the socket that was created
+* OUTPUTS:
+*  *retfd == the file descriptor number used for the socket
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    start_subsys_netconf (const char *user,
+                          uint16 port,
+                          int *retfd);
+
 #ifdef __cplusplus
 }  /* end extern 'C' */
 #endif
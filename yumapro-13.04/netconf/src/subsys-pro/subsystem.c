@@ -365,35 +365,6 @@ static void
 } /* cleanup_subsys */
 
 
-/********************************************************************
-* FUNCTION send_nc_ncxconnect
-*
-* Send the <ncx-connect> message to the ncxserver for SSH or LOCAL
-* transport for NETCONF protocol
-* 
-* RETURNS:
-*   status
-*********************************************************************/
-static status_t send_nc_ncxconnect (void)
-{
-    subsys_cb_t *cb = &subsys_cb;
-    const char connectmsg[] = 
-        "%s\n<ncx-connect xmlns=\"%s\" version=\"%d\" user=\"%s\" "
-        "address=\"%s\" magic=\"%s\" protocol=\"netconf\" "
-        "transport=\"ssh\" port=\"%s\" />\n%s";
-
-    snprintf(cb->msgbuff, SUBSYS_BUFFLEN, connectmsg,
-             (const char *)XML_START_MSG, 
-             NCX_URN, NCX_SERVER_VERSION, cb->user, cb->client_addr, 
-             NCX_SERVER_MAGIC, cb->port, NC_SSH_END);
-
-    status_t res = send_buff(cb->ncxsock, cb->msgbuff, 
-                             strlen(cb->msgbuff));
-    return res;
-
-} /* send_nc_ncxconnect */
-
-
 /********************************************************************
 * FUNCTION send_yangapi_ncxconnect
 *
@@ -855,7 +826,7 @@ int run_subsystem_ex (proto_id_t protocol_id,
     if (res == NO_ERR) {
         switch (cb->proto_id) {
         case PROTO_ID_NETCONF:
-            res = send_nc_ncxconnect();
+            res = send_nc_ncxconnect(cb);
             if (res != NO_ERR) {
                 msg = "send NETCONF ncx-connect failed";
             }
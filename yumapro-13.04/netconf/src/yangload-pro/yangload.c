@@ -0,0 +1,1746 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: yangload.c
+
+   NETCONF load generator
+
+   Opens N client sessions with the manager library (mgr_ses,
+   mgr_rpc, mgr_io) and sends a weighted mix of <get>,
+   <edit-config> and <commit> requests at a fixed total rate.
+
+   The requests are sent on an open-loop schedule: request k
+   is due at start + k/rate, whether or not the earlier
+   requests have been answered, and its latency is measured
+   from that due time.  A server stall shows up as latency
+   for every request scheduled during the stall, instead of
+   slowing down the sender (coordinated omission).
+
+   The schedule is driven from the mgr_io STDIN handler,
+   which is called on every pass through the mgr_io loop.
+   The handler sets the mgr_io wakeup to the next send time
+   or phase timeout, so the loop sleeps between sends.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+/* #define MEMORY_DEBUG 1 */
+
+#ifdef MEMORY_DEBUG
+#include <mcheck.h>
+#endif
+
+#define _C_main 1
+
+#include "procdefs.h"
+#include "cli.h"
+#include "conf.h"
+#include "dlq.h"
+#include "help.h"
+#include "log.h"
+#include "mgr.h"
+#include "mgr_io.h"
+#include "mgr_load.h"
+#include "mgr_not.h"
+#include "mgr_rpc.h"
+#include "mgr_ses.h"
+#include "ncx.h"
+#include "ncxconst.h"
+#include "ncxmod.h"
+#include "obj.h"
+#include "ses.h"
+#include "status.h"
+#include "tstamp.h"
+#include "val.h"
+#include "val_util.h"
+#include "xml_util.h"
+#include "xml_val.h"
+#include "xmlns.h"
+#include "yang.h"
+#include "yangload.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static val_value_t       *cli_val;
+static yangload_parms_t   loadparms;
+
+/* session ID to yangload session; mgr_ses uses small slot numbers */
+static yangload_ses_t    *sesmap[1024];
+
+
+/********************************************************************
+* FUNCTION pr_err
+*
+* Print an error message
+*
+* INPUTS:
+*    res == error result
+*
+*********************************************************************/
+static void
+    pr_err (status_t  res)
+{
+    log_error("\n%s: Error exit (%s)\n", YANGLOAD_PROGNAME,
+              get_error_string(res));
+
+} /* pr_err */
+
+
+/********************************************************************
+* FUNCTION get_nsecs
+*
+* Get the current monotonic time
+*
+* RETURNS:
+*   nano-seconds since some fixed point
+*********************************************************************/
+static uint64
+    get_nsecs (void)
+{
+    struct timeval   tv;
+#ifdef CLOCK_MONOTONIC
+    struct timespec  ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return ((uint64)ts.tv_sec * YANGLOAD_NSEC_PER_SEC) +
+            (uint64)ts.tv_nsec;
+    }
+#endif
+
+    (void)gettimeofday(&tv, NULL);
+    return ((uint64)tv.tv_sec * YANGLOAD_NSEC_PER_SEC) +
+        ((uint64)tv.tv_usec * 1000);
+
+}  /* get_nsecs */
+
+
+/********************************************************************
+* FUNCTION find_session
+*
+* Find the yangload session for a manager session ID
+*
+* INPUTS:
+*    sid == manager session ID
+*
+* RETURNS:
+*    pointer to the session or NULL if not found
+*********************************************************************/
+static yangload_ses_t *
+    find_session (ses_id_t sid)
+{
+    if (sid >= sizeof(sesmap) / sizeof(sesmap[0])) {
+        return NULL;
+    }
+    return sesmap[sid];
+
+}  /* find_session */
+
+
+/********************************************************************
+* FUNCTION add_sample
+*
+* Save the latency of one reply
+*
+* INPUTS:
+*    op == operation statistics to update
+*    nsecs == latency in nano-seconds
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    add_sample (yangload_opstats_t *op,
+                uint64 nsecs)
+{
+    if (op->replies == op->maxsamples) {
+        uint64 newmax = op->maxsamples + YANGLOAD_SAMPLE_CHUNK;
+        uint64 *newsamples = m__getMem(newmax * sizeof(uint64));
+        if (newsamples == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        if (op->samples) {
+            memcpy(newsamples, op->samples, op->replies * sizeof(uint64));
+            m__free(op->samples);
+        }
+        op->samples = newsamples;
+        op->maxsamples = newmax;
+    }
+    op->samples[op->replies++] = nsecs;
+    return NO_ERR;
+
+}  /* add_sample */
+
+
+/********************************************************************
+* FUNCTION free_pending
+*
+* Remove and free all the pending request records for a session
+* The requests themselves belong to the manager session
+*
+* INPUTS:
+*    ls == session to clean
+*    failed == TRUE to count the requests as failed
+*********************************************************************/
+static void
+    free_pending (yangload_ses_t *ls,
+                  boolean failed)
+{
+    while (!dlq_empty(&ls->pendingQ)) {
+        yangload_pending_t *pending = (yangload_pending_t *)
+            dlq_deque(&ls->pendingQ);
+        if (failed) {
+            loadparms.ops[pending->op].failed++;
+        }
+        loadparms.outstanding--;
+        m__free(pending);
+    }
+
+}  /* free_pending */
+
+
+/********************************************************************
+* FUNCTION reply_handler
+*
+* Handle the reply for one request
+* Matches mgr_rpc_cbfn_t template
+*
+* INPUTS:
+*   scb == session control block for session that got the reply
+*   req == RPC request to free
+*   rpy == RPY reply header to free
+*********************************************************************/
+static void
+    reply_handler (ses_cb_t *scb,
+                   mgr_rpc_req_t *req,
+                   mgr_rpc_rpy_t *rpy)
+{
+    uint64 now = get_nsecs();
+    yangload_ses_t *ls = find_session(scb->sid);
+
+    /* the replies come back in order, so this is the first entry */
+    yangload_pending_t *pending = NULL;
+    if (ls) {
+        for (pending = (yangload_pending_t *)dlq_firstEntry(&ls->pendingQ);
+             pending != NULL;
+             pending = (yangload_pending_t *)dlq_nextEntry(pending)) {
+            if (pending->req == req) {
+                break;
+            }
+        }
+    }
+
+    if (pending) {
+        yangload_opstats_t *op = &loadparms.ops[pending->op];
+
+        if (rpy == NULL || rpy->res != NO_ERR || rpy->reply == NULL ||
+            val_find_child(rpy->reply, NC_MODULE, NCX_EL_RPC_ERROR)) {
+            op->rpcerrors++;
+        }
+        if (rpy != NULL) {
+            status_t res = add_sample(op, now - pending->intended);
+            if (res != NO_ERR) {
+                loadparms.runres = res;
+            }
+        }
+
+        dlq_remove(pending);
+        m__free(pending);
+        loadparms.outstanding--;
+    }
+
+    mgr_rpc_free_request(req);
+    if (rpy) {
+        mgr_rpc_free_reply(rpy);
+    }
+
+}  /* reply_handler */
+
+
+/********************************************************************
+* FUNCTION notification_handler
+*
+* Count the notifications from the subscriptions
+* Matches mgr_not_cbfn_t template
+*
+* INPUTS:
+*   scb == session control block for session that got the notification
+*   msg == incoming notification msg
+*   consumed == address of return message consumed flag
+*
+* OUTPUTS:
+*   *consumed == FALSE so the manager frees the message
+*********************************************************************/
+static void
+    notification_handler (ses_cb_t *scb,
+                          mgr_not_msg_t *msg,
+                          boolean *consumed)
+{
+    (void)scb;
+    (void)msg;
+
+    loadparms.notifications++;
+    *consumed = FALSE;
+
+}  /* notification_handler */
+
+
+/********************************************************************
+* FUNCTION session_closed_handler
+*
+* The server closed a session; count its pending requests as failed
+* Matches mgr_ses_closed_fn_t template
+*
+* INPUTS:
+*   sid == manager session ID that was closed
+*********************************************************************/
+static void
+    session_closed_handler (uint32 sid)
+{
+    yangload_ses_t *ls = find_session(sid);
+    if (ls == NULL) {
+        return;
+    }
+
+    log_warn("\nWarning: session %u closed by the server", sid);
+    ls->closed = TRUE;
+    ls->ready = FALSE;
+    sesmap[sid] = NULL;
+    free_pending(ls, TRUE);
+
+}  /* session_closed_handler */
+
+
+/********************************************************************
+* FUNCTION send_request
+*
+* Send one request on a session
+*
+* INPUTS:
+*    ls == session to use
+*    opid == operation to send
+*    intended == scheduled send time in nano-seconds
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    send_request (yangload_ses_t *ls,
+                  yangload_op_t opid,
+                  uint64 intended)
+{
+    yangload_opstats_t *op = &loadparms.ops[opid];
+    status_t res = NO_ERR;
+
+    ses_cb_t *scb = mgr_ses_get_scb(ls->sid);
+    if (scb == NULL) {
+        return ERR_NCX_SESSION_CLOSED;
+    }
+
+    yangload_pending_t *pending = m__getObj(yangload_pending_t);
+    if (pending == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    memset(pending, 0x0, sizeof(yangload_pending_t));
+
+    val_value_t *reqdata = val_clone(op->reqdata);
+    if (reqdata == NULL) {
+        m__free(pending);
+        return ERR_INTERNAL_MEM;
+    }
+
+    mgr_rpc_req_t *req = mgr_rpc_new_request(scb);
+    if (req == NULL) {
+        val_free_value(reqdata);
+        m__free(pending);
+        return ERR_INTERNAL_MEM;
+    }
+    req->data = reqdata;
+    req->rpc = op->rpc;
+
+    /* timeouts are checked at the end of the run, not by mgr_rpc */
+    req->timeout = 0;
+
+    res = mgr_rpc_send_request(scb, req, reply_handler);
+    if (res != NO_ERR) {
+        mgr_rpc_free_request(req);
+        m__free(pending);
+        return res;
+    }
+
+    pending->req = req;
+    pending->op = opid;
+    pending->intended = intended;
+    dlq_enque(pending, &ls->pendingQ);
+    loadparms.outstanding++;
+    op->sent++;
+
+    return NO_ERR;
+
+}  /* send_request */
+
+
+/********************************************************************
+* FUNCTION next_session
+*
+* Get the next session in round-robin order
+*
+* RETURNS:
+*    pointer to the session or NULL if none are left
+*********************************************************************/
+static yangload_ses_t *
+    next_session (void)
+{
+    uint32 i;
+
+    for (i = 0; i < loadparms.sessions; i++) {
+        yangload_ses_t *ls = &loadparms.ses[loadparms.nextses];
+        if (++loadparms.nextses == loadparms.sessions) {
+            loadparms.nextses = 0;
+        }
+        if (ls->ready && !ls->closed) {
+            return ls;
+        }
+    }
+    return NULL;
+
+}  /* next_session */
+
+
+/********************************************************************
+* FUNCTION next_op
+*
+* Pick the next operation in the mix, using smooth weighted
+* round-robin so the operations are spread evenly in time
+*
+* RETURNS:
+*    operation ID
+*********************************************************************/
+static yangload_op_t
+    next_op (void)
+{
+    yangload_op_t best = YANGLOAD_OP_GET;
+    int64 bestweight = 0;
+    boolean found = FALSE;
+    uint32 i;
+
+    for (i = 0; i < YANGLOAD_OP_CREATE_SUBSCRIPTION; i++) {
+        yangload_opstats_t *op = &loadparms.ops[i];
+        if (op->weight == 0) {
+            continue;
+        }
+        op->curweight += op->weight;
+        if (!found || op->curweight > bestweight) {
+            found = TRUE;
+            best = (yangload_op_t)i;
+            bestweight = op->curweight;
+        }
+    }
+    loadparms.ops[best].curweight -= loadparms.totalweight;
+    return best;
+
+}  /* next_op */
+
+
+/********************************************************************
+* FUNCTION send_scheduled
+*
+* Send all the requests that are due by now
+*
+* INPUTS:
+*    now == current time in nano-seconds
+*
+* RETURNS:
+*    FALSE if there are no sessions left to send on
+*********************************************************************/
+static boolean
+    send_scheduled (uint64 now)
+{
+    while (loadparms.nextsend <= now &&
+           loadparms.nextsend < loadparms.runend) {
+
+        yangload_op_t opid = next_op();
+        yangload_ses_t *ls = next_session();
+        if (ls == NULL) {
+            return FALSE;
+        }
+
+        status_t res = send_request(ls, opid, loadparms.nextsend);
+        if (res != NO_ERR) {
+            log_debug("\n%s: send %s failed (%s)", YANGLOAD_PROGNAME,
+                      loadparms.ops[opid].name, get_error_string(res));
+            loadparms.ops[opid].failed++;
+        }
+
+        /* the schedule is fixed; it does not move with the sends */
+        loadparms.schedcount++;
+        loadparms.nextsend = loadparms.runstart +
+            (loadparms.schedcount * YANGLOAD_NSEC_PER_SEC) / loadparms.rate;
+    }
+    return TRUE;
+
+}  /* send_scheduled */
+
+
+/********************************************************************
+* FUNCTION check_sessions_ready
+*
+* Check if all the sessions have finished the <hello> exchange
+*
+* RETURNS:
+*    status: NO_ERR if all are ready, ERR_NCX_SKIPPED if still
+*    waiting, or an error if a session failed
+*********************************************************************/
+static status_t
+    check_sessions_ready (void)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    for (i = 0; i < loadparms.sessions; i++) {
+        yangload_ses_t *ls = &loadparms.ses[i];
+        if (ls->ready) {
+            continue;
+        }
+
+        ses_cb_t *scb = (ls->closed) ? NULL : mgr_ses_get_scb(ls->sid);
+        if (scb == NULL || scb->state >= SES_ST_SHUTDOWN_REQ) {
+            log_error("\nError: session %u failed to start", i + 1);
+            return ERR_NCX_SESSION_CLOSED;
+        }
+        if (scb->state == SES_ST_IDLE || scb->state == SES_ST_IN_MSG) {
+            ls->ready = TRUE;
+        } else {
+            res = ERR_NCX_SKIPPED;
+        }
+    }
+    return res;
+
+}  /* check_sessions_ready */
+
+
+/********************************************************************
+* FUNCTION start_run
+*
+* Start sending the request mix
+*
+* INPUTS:
+*    now == current time in nano-seconds
+*********************************************************************/
+static void
+    start_run (uint64 now)
+{
+    log_info("\n%s: sending %u requests/sec for %u seconds "
+             "on %u sessions", YANGLOAD_PROGNAME, loadparms.rate,
+             loadparms.duration, loadparms.sessions);
+
+    loadparms.phase = YANGLOAD_PH_RUN;
+    loadparms.phasestart = now;
+    loadparms.runstart = now;
+    loadparms.runend = now +
+        (uint64)loadparms.duration * YANGLOAD_NSEC_PER_SEC;
+    loadparms.nextsend = now;
+    loadparms.schedcount = 0;
+
+}  /* start_run */
+
+
+/********************************************************************
+* FUNCTION start_drain
+*
+* Stop sending and wait for the outstanding replies
+*
+* INPUTS:
+*    now == current time in nano-seconds
+*********************************************************************/
+static void
+    start_drain (uint64 now)
+{
+    if (now < loadparms.runend) {
+        loadparms.runend = now;
+    }
+    loadparms.phase = YANGLOAD_PH_DRAIN;
+    loadparms.phasestart = now;
+
+}  /* start_drain */
+
+
+/********************************************************************
+* FUNCTION set_wakeup
+*
+* Tell mgr_io when the STDIN handler needs to run again if
+* no server sends anything before then: the next scheduled
+* send during the run, or the timeout for the current phase
+*
+* INPUTS:
+*    now == current time in nano-seconds
+*********************************************************************/
+static void
+    set_wakeup (uint64 now)
+{
+    uint64 deadline = 0;
+
+    if (loadparms.timeout) {
+        deadline = loadparms.phasestart +
+            (uint64)loadparms.timeout * YANGLOAD_NSEC_PER_SEC;
+    }
+
+    if (loadparms.phase == YANGLOAD_PH_DRAIN &&
+        loadparms.outstanding == 0) {
+        deadline = now;
+    } else if (loadparms.phase == YANGLOAD_PH_RUN) {
+        uint64 nextrun = (loadparms.nextsend < loadparms.runend) ?
+            loadparms.nextsend : loadparms.runend;
+        if (deadline == 0 || nextrun < deadline) {
+            deadline = nextrun;
+        }
+    }
+
+    if (deadline == 0) {
+        return;   // wait for the servers
+    }
+
+    if (deadline <= now) {
+        mgr_io_set_wakeup(0);
+    } else {
+        uint64 msec = (deadline - now + YANGLOAD_NSEC_PER_MSEC - 1) /
+            YANGLOAD_NSEC_PER_MSEC;
+        mgr_io_set_wakeup((msec > NCX_MAX_UINT) ? NCX_MAX_UINT : 
+                          (uint32)msec);
+    }
+
+}  /* set_wakeup */
+
+
+/********************************************************************
+* FUNCTION stdin_handler
+*
+* Run one step of the load schedule
+* Called by mgr_io_run on each pass through the IO loop
+* Matches mgr_io_stdin_fn_t template
+*
+* RETURNS:
+*   new program state; MGR_IO_ST_SHUT when the run is done
+*********************************************************************/
+static mgr_io_state_t
+    stdin_handler (void)
+{
+    uint64 now = get_nsecs();
+    uint64 timeout = (uint64)loadparms.timeout * YANGLOAD_NSEC_PER_SEC;
+    boolean timedout = (loadparms.timeout &&
+                        now - loadparms.phasestart >= timeout);
+    uint32 i;
+    status_t res;
+
+    if (loadparms.runres != NO_ERR) {
+        loadparms.phase = YANGLOAD_PH_DONE;
+        return MGR_IO_ST_SHUT;
+    }
+
+    switch (loadparms.phase) {
+    case YANGLOAD_PH_CONNECT:
+        res = check_sessions_ready();
+        if (res == ERR_NCX_SKIPPED) {
+            if (timedout) {
+                log_error("\nError: timeout waiting for the sessions "
+                          "to start");
+                loadparms.runres = ERR_NCX_TIMEOUT;
+                return MGR_IO_ST_SHUT;
+            }
+            break;
+        } else if (res != NO_ERR) {
+            loadparms.runres = res;
+            return MGR_IO_ST_SHUT;
+        }
+
+        /* all sessions are up; start any subscriptions first
+         * so the notification load is there for the whole run */
+        loadparms.phasestart = now;
+        for (i = 0; i < loadparms.subscriptions &&
+                 i < loadparms.sessions; i++) {
+            res = send_request(&loadparms.ses[i],
+                               YANGLOAD_OP_CREATE_SUBSCRIPTION, now);
+            if (res != NO_ERR) {
+                loadparms.runres = res;
+                return MGR_IO_ST_SHUT;
+            }
+        }
+        if (loadparms.outstanding) {
+            loadparms.phase = YANGLOAD_PH_SUBSCRIBE;
+        } else {
+            start_run(now);
+        }
+        break;
+    case YANGLOAD_PH_SUBSCRIBE:
+        if (loadparms.outstanding == 0) {
+            start_run(now);
+        } else if (timedout) {
+            log_error("\nError: timeout waiting for "
+                      "<create-subscription> replies");
+            loadparms.runres = ERR_NCX_TIMEOUT;
+            return MGR_IO_ST_SHUT;
+        }
+        break;
+    case YANGLOAD_PH_RUN:
+        if (!send_scheduled(now)) {
+            log_error("\nError: no sessions left");
+            loadparms.runres = ERR_NCX_SESSION_CLOSED;
+            start_drain(now);
+        } else if (now >= loadparms.runend) {
+            start_drain(now);
+        }
+        break;
+    case YANGLOAD_PH_DRAIN:
+        if (loadparms.outstanding == 0 || timedout) {
+            /* anything still pending is a timeout */
+            loadparms.drainend = now;
+            for (i = 0; i < loadparms.sessions; i++) {
+                free_pending(&loadparms.ses[i], TRUE);
+            }
+            loadparms.phase = YANGLOAD_PH_DONE;
+            return MGR_IO_ST_SHUT;
+        }
+        break;
+    case YANGLOAD_PH_DONE:
+        return MGR_IO_ST_SHUT;
+    default:
+        SET_ERROR(ERR_INTERNAL_VAL);
+        return MGR_IO_ST_SHUT;
+    }
+
+    set_wakeup(now);
+    return MGR_IO_ST_CONN_IDLE;
+
+}  /* stdin_handler */
+
+
+/********************************************************************
+* FUNCTION compare_samples
+*
+* qsort compare function for latency samples
+*********************************************************************/
+static int
+    compare_samples (const void *a,
+                     const void *b)
+{
+    uint64 x = *(const uint64 *)a;
+    uint64 y = *(const uint64 *)b;
+
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+
+}  /* compare_samples */
+
+
+/********************************************************************
+* FUNCTION get_percentile
+*
+* Get a percentile from sorted samples
+*
+* INPUTS:
+*    op == operation with sorted samples
+*    permille == percentile in tenths of a percent (999 == p99.9)
+*
+* RETURNS:
+*    latency in nano-seconds
+*********************************************************************/
+static uint64
+    get_percentile (const yangload_opstats_t *op,
+                    uint32 permille)
+{
+    if (op->replies == 0) {
+        return 0;
+    }
+
+    uint64 idx = (op->replies * permille + 999) / 1000;
+    if (idx) {
+        idx--;
+    }
+    return op->samples[idx];
+
+}  /* get_percentile */
+
+
+/********************************************************************
+* FUNCTION get_mean
+*
+* Get the mean latency of an operation
+*
+* INPUTS:
+*    op == operation to check
+*
+* RETURNS:
+*    mean latency in nano-seconds
+*********************************************************************/
+static double
+    get_mean (const yangload_opstats_t *op)
+{
+    double total = 0;
+    uint64 i;
+
+    if (op->replies == 0) {
+        return 0;
+    }
+    for (i = 0; i < op->replies; i++) {
+        total += (double)op->samples[i];
+    }
+    return total / (double)op->replies;
+
+}  /* get_mean */
+
+
+/********************************************************************
+* FUNCTION get_elapsed_secs
+*
+* Get the time from the first request to the last reply
+*
+* RETURNS:
+*    elapsed time in seconds
+*********************************************************************/
+static double
+    get_elapsed_secs (void)
+{
+    uint64 endtime = (loadparms.drainend) ?
+        loadparms.drainend : loadparms.runend;
+
+    if (endtime <= loadparms.runstart) {
+        return 0;
+    }
+    return (double)(endtime - loadparms.runstart) /
+        (double)YANGLOAD_NSEC_PER_SEC;
+
+}  /* get_elapsed_secs */
+
+
+/********************************************************************
+* FUNCTION print_results
+*
+* Print the results table to STDOUT
+* The samples must be sorted first
+*********************************************************************/
+static void
+    print_results (void)
+{
+    double elapsed = get_elapsed_secs();
+    uint32 i;
+
+    log_stdout("\n%s: %u sessions, %u requests/sec, %.2f seconds\n",
+               YANGLOAD_PROGNAME, loadparms.sessions, loadparms.rate,
+               elapsed);
+    log_stdout("\n%-20s %8s %8s %6s %6s %10s %10s %10s %10s %10s",
+               "operation", "sent", "replies", "errors", "failed",
+               "replies/s", "p50(us)", "p99(us)", "p999(us)", "max(us)");
+
+    for (i = 0; i < YANGLOAD_NUM_OPS; i++) {
+        const yangload_opstats_t *op = &loadparms.ops[i];
+        if (op->sent == 0 && op->failed == 0) {
+            continue;
+        }
+
+        uint64 p50 = get_percentile(op, 500);
+        uint64 p99 = get_percentile(op, 990);
+        uint64 p999 = get_percentile(op, 999);
+        uint64 pmax = get_percentile(op, 1000);
+
+        log_stdout("\n%-20s %8llu %8llu %6llu %6llu %10.1f "
+                   "%10.1f %10.1f %10.1f %10.1f",
+                   op->name,
+                   (unsigned long long)op->sent,
+                   (unsigned long long)op->replies,
+                   (unsigned long long)op->rpcerrors,
+                   (unsigned long long)op->failed,
+                   (elapsed > 0) ? (double)op->replies / elapsed : 0,
+                   (double)p50 / 1000,
+                   (double)p99 / 1000,
+                   (double)p999 / 1000,
+                   (double)pmax / 1000);
+    }
+
+    if (loadparms.subscriptions) {
+        log_stdout("\nnotifications: %llu",
+                   (unsigned long long)loadparms.notifications);
+    }
+    log_stdout("\n");
+
+}  /* print_results */
+
+
+/********************************************************************
+* FUNCTION write_results
+*
+* Write the results as JSON
+* The samples must be sorted first
+*
+* INPUTS:
+*   output == output filespec
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    write_results (const xmlChar *output)
+{
+    xmlChar version[NCX_VERSION_BUFFSIZE];
+    xmlChar tstamp[TSTAMP_MIN_SIZE];
+    double elapsed = get_elapsed_secs();
+    boolean first = TRUE;
+    uint32 i;
+
+    FILE *fp = fopen((const char *)output, "w");
+    if (fp == NULL) {
+        log_error("\nError: open '%s' failed", output);
+        return ERR_FIL_OPEN;
+    }
+
+    if (ncx_get_version(version, sizeof(version)) != NO_ERR) {
+        version[0] = 0;
+    }
+    tstamp_datetime(tstamp);
+
+    fprintf(fp,
+            "{\n"
+            "  \"program\": \"%s\",\n"
+            "  \"format-version\": %u,\n"
+            "  \"version\": \"%s\",\n"
+            "  \"timestamp\": \"%s\",\n"
+            "  \"parameters\": {\n"
+            "    \"transport\": \"%s\",\n"
+            "    \"sessions\": %u,\n"
+            "    \"rate\": %u,\n"
+            "    \"duration\": %u,\n"
+            "    \"subscriptions\": %u\n"
+            "  },\n"
+            "  \"elapsed-sec\": %.3f,\n"
+            "  \"notifications\": %llu,\n"
+            "  \"results\": [",
+            YANGLOAD_PROGNAME, YANGLOAD_FORMAT_VERSION, version, tstamp,
+            ses_get_transport_name(loadparms.transport),
+            loadparms.sessions, loadparms.rate, loadparms.duration,
+            loadparms.subscriptions, elapsed,
+            (unsigned long long)loadparms.notifications);
+
+    for (i = 0; i < YANGLOAD_NUM_OPS; i++) {
+        const yangload_opstats_t *op = &loadparms.ops[i];
+        if (op->sent == 0 && op->failed == 0) {
+            continue;
+        }
+
+        fprintf(fp,
+                "%s\n    {\n"
+                "      \"name\": \"%s\",\n"
+                "      \"sent\": %llu,\n"
+                "      \"replies\": %llu,\n"
+                "      \"rpc-errors\": %llu,\n"
+                "      \"failed\": %llu,\n"
+                "      \"replies-per-sec\": %.1f,\n"
+                "      \"mean-ns\": %.0f,\n"
+                "      \"p50-ns\": %llu,\n"
+                "      \"p99-ns\": %llu,\n"
+                "      \"p999-ns\": %llu,\n"
+                "      \"max-ns\": %llu\n"
+                "    }",
+                (first) ? "" : ",",
+                op->name,
+                (unsigned long long)op->sent,
+                (unsigned long long)op->replies,
+                (unsigned long long)op->rpcerrors,
+                (unsigned long long)op->failed,
+                (elapsed > 0) ? (double)op->replies / elapsed : 0,
+                get_mean(op),
+                (unsigned long long)get_percentile(op, 500),
+                (unsigned long long)get_percentile(op, 990),
+                (unsigned long long)get_percentile(op, 999),
+                (unsigned long long)get_percentile(op, 1000));
+        first = FALSE;
+    }
+    fprintf(fp, "\n  ]\n}\n");
+
+    status_t res = NO_ERR;
+    if (fclose(fp) != 0) {
+        res = ERR_FIL_WRITE;
+    }
+    return res;
+
+}  /* write_results */
+
+
+/********************************************************************
+* FUNCTION make_rpc_template
+*
+* Find an RPC and create the empty method node for its requests
+*
+* INPUTS:
+*    modname == module containing the RPC
+*    rpcname == RPC name
+*    op == operation to fill in
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    make_rpc_template (const xmlChar *modname,
+                       const xmlChar *rpcname,
+                       yangload_opstats_t *op)
+{
+    ncx_module_t *mod = ncx_find_module(modname, NULL);
+    if (mod) {
+        op->rpc = ncx_find_object(mod, rpcname);
+    }
+    if (op->rpc == NULL) {
+        return SET_ERROR(ERR_NCX_DEF_NOT_FOUND);
+    }
+
+    op->reqdata = xml_val_new_struct(obj_get_name(op->rpc),
+                                     obj_get_nsid(op->rpc));
+    if (op->reqdata == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    return NO_ERR;
+
+}  /* make_rpc_template */
+
+
+/********************************************************************
+* FUNCTION make_get_template
+*
+* Create the <get> request, with an XPath filter if --get-select is set
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    make_get_template (void)
+{
+    yangload_opstats_t *op = &loadparms.ops[YANGLOAD_OP_GET];
+
+    status_t res = make_rpc_template(NC_MODULE, NCX_EL_GET, op);
+    if (res != NO_ERR || loadparms.get_select == NULL) {
+        return res;
+    }
+
+    val_value_t *filter = xml_val_new_flag(NCX_EL_FILTER, xmlns_nc_id());
+    if (filter == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    val_add_child(filter, op->reqdata);
+
+    val_value_t *metaval = val_make_string(0, NCX_EL_TYPE, NCX_EL_XPATH);
+    if (metaval == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    dlq_enque(metaval, &filter->metaQ);
+
+    metaval = val_make_string(0, NCX_EL_SELECT, loadparms.get_select);
+    if (metaval == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    dlq_enque(metaval, &filter->metaQ);
+
+    return NO_ERR;
+
+}  /* make_get_template */
+
+
+/********************************************************************
+* FUNCTION make_edit_template
+*
+* Create the <edit-config> request from the --edit-content file
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    make_edit_template (void)
+{
+    yangload_opstats_t *op = &loadparms.ops[YANGLOAD_OP_EDIT_CONFIG];
+    status_t res = NO_ERR;
+
+    if (loadparms.edit_content == NULL) {
+        log_error("\nError: --%s is required for <edit-config>",
+                  YANGLOAD_PARM_EDIT_CONTENT);
+        return ERR_NCX_MISSING_PARM;
+    }
+
+    xmlChar *filespec = ncx_get_source(loadparms.edit_content, &res);
+    if (filespec == NULL) {
+        return res;
+    }
+
+    val_value_t *content = mgr_load_extern_file(filespec, NULL, &res);
+    m__free(filespec);
+    if (content == NULL) {
+        log_error("\nError: load of '%s' failed (%s)",
+                  loadparms.edit_content, get_error_string(res));
+        return (res == NO_ERR) ? ERR_NCX_OPERATION_FAILED : res;
+    }
+
+    if (res == NO_ERR) {
+        res = make_rpc_template(NC_MODULE, NCX_EL_EDIT_CONFIG, op);
+    }
+
+    val_value_t *target = NULL;
+    val_value_t *config = NULL;
+    if (res == NO_ERR) {
+        target = xml_val_new_struct(NCX_EL_TARGET, xmlns_nc_id());
+        config = xml_val_new_struct(NCX_EL_CONFIG, xmlns_nc_id());
+        if (target == NULL || config == NULL) {
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
+    if (res == NO_ERR) {
+        val_value_t *db = xml_val_new_flag(loadparms.edit_target,
+                                           xmlns_nc_id());
+        if (db == NULL) {
+            res = ERR_INTERNAL_MEM;
+        } else {
+            val_add_child(db, target);
+        }
+    }
+
+    if (res == NO_ERR) {
+        /* the top element of the file is only a wrapper */
+        val_value_t *child = val_get_first_child(content);
+        while (child) {
+            val_value_t *nextchild = val_get_next_child(child);
+            val_remove_child(child);
+            val_add_child(child, config);
+            child = nextchild;
+        }
+        val_add_child(target, op->reqdata);
+        val_add_child(config, op->reqdata);
+        target = config = NULL;
+    }
+
+    if (target) {
+        val_free_value(target);
+    }
+    if (config) {
+        val_free_value(config);
+    }
+    val_free_value(content);
+    return res;
+
+}  /* make_edit_template */
+
+
+/********************************************************************
+* FUNCTION load_modules
+*
+* Load the modules requested with the --module parameter
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    load_modules (void)
+{
+    status_t res = NO_ERR;
+
+    val_value_t *modval = val_find_child(cli_val, YANGLOAD_MOD,
+                                         NCX_EL_MODULE);
+    while (modval != NULL && res == NO_ERR) {
+        xmlChar *revision = NULL;
+        uint32   modlen = 0;
+
+        if (yang_split_filename(VAL_STR(modval), &modlen)) {
+            xmlChar *savestr = &(VAL_STR(modval)[modlen]);
+            *savestr = '\0';
+            revision = savestr + 1;
+        }
+
+        res = ncxmod_load_module(VAL_STR(modval), revision, NULL, NULL);
+        if (res != NO_ERR) {
+            log_error("\nError: load module '%s' failed (%s)",
+                      VAL_STR(modval), get_error_string(res));
+        }
+
+        modval = val_find_next_child(cli_val, YANGLOAD_MOD,
+                                     NCX_EL_MODULE, modval);
+    }
+    return res;
+
+}  /* load_modules */
+
+
+/********************************************************************
+* FUNCTION make_templates
+*
+* Create the request templates for the operations in the mix
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    make_templates (void)
+{
+    status_t res = NO_ERR;
+
+    loadparms.ops[YANGLOAD_OP_GET].name = NCX_EL_GET;
+    loadparms.ops[YANGLOAD_OP_EDIT_CONFIG].name = NCX_EL_EDIT_CONFIG;
+    loadparms.ops[YANGLOAD_OP_COMMIT].name = NCX_EL_COMMIT;
+    loadparms.ops[YANGLOAD_OP_CREATE_SUBSCRIPTION].name =
+        NCX_EL_CREATE_SUBSCRIPTION;
+
+    if (loadparms.totalweight == 0) {
+        log_error("\nError: all operation weights are zero");
+        return ERR_NCX_INVALID_VALUE;
+    }
+
+    if (loadparms.ops[YANGLOAD_OP_GET].weight) {
+        res = make_get_template();
+    }
+    if (res == NO_ERR && loadparms.ops[YANGLOAD_OP_EDIT_CONFIG].weight) {
+        res = make_edit_template();
+    }
+    if (res == NO_ERR && loadparms.ops[YANGLOAD_OP_COMMIT].weight) {
+        res = make_rpc_template(NC_MODULE, NCX_EL_COMMIT,
+                                &loadparms.ops[YANGLOAD_OP_COMMIT]);
+    }
+    if (res == NO_ERR && loadparms.subscriptions) {
+        res = make_rpc_template(NCN_MODULE, NCX_EL_CREATE_SUBSCRIPTION,
+                    &loadparms.ops[YANGLOAD_OP_CREATE_SUBSCRIPTION]);
+    }
+    return res;
+
+}  /* make_templates */
+
+
+/********************************************************************
+* FUNCTION get_uint_parm
+*
+* Get a uint32 CLI parameter
+*
+* INPUTS:
+*    valset == CLI parameters
+*    name == parameter name
+*    defval == value to use if not set
+*
+* RETURNS:
+*    parameter value
+*********************************************************************/
+static uint32
+    get_uint_parm (val_value_t *valset,
+                   const xmlChar *name,
+                   uint32 defval)
+{
+    val_value_t *val = val_find_child(valset, YANGLOAD_MOD, name);
+    if (val && val->res == NO_ERR) {
+        return VAL_UINT(val);
+    }
+    return defval;
+
+}  /* get_uint_parm */
+
+
+/********************************************************************
+* FUNCTION get_str_parm
+*
+* Get a string CLI parameter
+*
+* INPUTS:
+*    valset == CLI parameters
+*    name == parameter name
+*
+* RETURNS:
+*    parameter value or NULL if not set
+*********************************************************************/
+static const xmlChar *
+    get_str_parm (val_value_t *valset,
+                  const xmlChar *name)
+{
+    val_value_t *val = val_find_child(valset, YANGLOAD_MOD, name);
+    if (val && val->res == NO_ERR) {
+        return VAL_STR(val);
+    }
+    return NULL;
+
+}  /* get_str_parm */
+
+
+/********************************************************************
+* FUNCTION process_cli_input
+*
+* Process the param line parameters against the hardwired
+* parmset for the yangload program
+*
+* INPUTS:
+*    argc == argument count
+*    argv == array of command line argument strings
+*    lp == address of returned values
+*
+* OUTPUTS:
+*    parmset values will be stored in *lp if NO_ERR
+*
+* RETURNS:
+*    NO_ERR if all goes well
+*********************************************************************/
+static status_t
+    process_cli_input (int argc,
+                       char *argv[],
+                       yangload_parms_t *lp)
+{
+    obj_template_t        *obj = NULL;
+    val_value_t           *valset, *val;
+    ncx_module_t          *mod;
+    status_t               res = NO_ERR;
+
+    /* find the parmset definition in the registry */
+    mod = ncx_find_module(YANGLOAD_MOD, NULL);
+    if (mod) {
+        obj = ncx_find_object(mod, YANGLOAD_CONTAINER);
+    }
+    if (!obj) {
+        return ERR_NCX_NOT_FOUND;
+    }
+
+    /* parse the command line against the PSD */
+    valset = cli_parse(NULL, argc, argv, obj, FULLTEST, PLAINMODE,
+                       TRUE, CLI_MODE_PROGRAM, &res);
+    if (res != NO_ERR) {
+        if (valset) {
+            val_free_value(valset);
+        }
+        return res;
+    } else if (!valset) {
+        return ERR_INTERNAL_VAL;
+    }
+    cli_val = valset;
+
+    /* next get any params from the conf file */
+    val = val_find_child(valset, YANGLOAD_MOD, YANGLOAD_PARM_CONFIG);
+    if (val) {
+        /* try the specified config location */
+        lp->config = VAL_STR(val);
+        res = conf_parse_val_from_filespec(lp->config, valset,
+                                           TRUE, TRUE);
+        if (res != NO_ERR) {
+            return res;
+        }
+    } else if (val_find_child(valset, YANGLOAD_MOD, NCX_EL_NO_CONFIG)) {
+        log_info("\nSkipping default config file because "
+                 "--no-config specified");
+    } else {
+        /* try default config location */
+        res = conf_parse_val_from_filespec(YANGLOAD_DEF_CONFIG,
+                                           valset, TRUE, FALSE);
+        if (res != NO_ERR) {
+            return res;
+        }
+    }
+
+    /* set the --home and --yumapro-home parameters */
+    val_set_home_parms(valset);
+
+    /* set the logging control parameters */
+    val_set_logging_parms(valset);
+
+    /* set the file search path parameters */
+    val_set_path_parms(valset);
+
+    /* set the protocols parm */
+    res = val_set_protocols_parm(valset);
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    /*** ORDER DOES NOT MATTER FOR REST OF PARAMETERS ***/
+
+    /* help parameter */
+    val = val_find_child(valset, YANGLOAD_MOD, NCX_EL_HELP);
+    if (val && val->res == NO_ERR) {
+        lp->helpmode = TRUE;
+    }
+
+    /* help submode parameter (brief/normal/full) */
+    val = val_find_child(valset, YANGLOAD_MOD, NCX_EL_BRIEF);
+    if (val && val->res == NO_ERR) {
+        lp->helpsubmode = HELP_MODE_BRIEF;
+    } else if (val_find_child(valset, YANGLOAD_MOD, NCX_EL_FULL)) {
+        lp->helpsubmode = HELP_MODE_FULL;
+    } else {
+        lp->helpsubmode = HELP_MODE_NORMAL;
+    }
+
+    /* version parameter */
+    val = val_find_child(valset, YANGLOAD_MOD, NCX_EL_VERSION);
+    if (val && val->res == NO_ERR) {
+        lp->versionmode = TRUE;
+    }
+
+    /* session parameters */
+    lp->server = get_str_parm(valset, YANGLOAD_PARM_SERVER);
+    lp->user = get_str_parm(valset, YANGLOAD_PARM_USER);
+    if (lp->user == NULL) {
+        lp->user = (const xmlChar *)getenv("USER");
+    }
+    lp->password = get_str_parm(valset, YANGLOAD_PARM_PASSWORD);
+    lp->pubkey = (const char *)
+        get_str_parm(valset, YANGLOAD_PARM_PUBLIC_KEY);
+    lp->privkey = (const char *)
+        get_str_parm(valset, YANGLOAD_PARM_PRIVATE_KEY);
+    lp->ncport = (uint16)get_uint_parm(valset, YANGLOAD_PARM_NCPORT, 0);
+
+    lp->transport = SES_TRANSPORT_SSH;
+    val = val_find_child(valset, YANGLOAD_MOD, YANGLOAD_PARM_TRANSPORT);
+    if (val && val->res == NO_ERR) {
+        if (!xml_strcmp(VAL_ENUM_NAME(val), YANGLOAD_TRANSPORT_TCP)) {
+            lp->transport = SES_TRANSPORT_TCP;
+        } else if (!xml_strcmp(VAL_ENUM_NAME(val),
+                               YANGLOAD_TRANSPORT_LOCAL)) {
+            lp->transport = SES_TRANSPORT_LOCAL;
+        }
+    }
+
+    /* load parameters */
+    lp->sessions = get_uint_parm(valset, YANGLOAD_PARM_SESSIONS, 1);
+    lp->rate = get_uint_parm(valset, YANGLOAD_PARM_RATE, 100);
+    lp->duration = get_uint_parm(valset, YANGLOAD_PARM_DURATION, 10);
+    lp->timeout = get_uint_parm(valset, YANGLOAD_PARM_TIMEOUT,
+                                YANGLOAD_DEF_TIMEOUT);
+    lp->subscriptions =
+        get_uint_parm(valset, YANGLOAD_PARM_SUBSCRIPTIONS, 0);
+
+    lp->ops[YANGLOAD_OP_GET].weight =
+        get_uint_parm(valset, YANGLOAD_PARM_GET_WEIGHT, 1);
+    lp->ops[YANGLOAD_OP_EDIT_CONFIG].weight =
+        get_uint_parm(valset, YANGLOAD_PARM_EDIT_WEIGHT, 0);
+    lp->ops[YANGLOAD_OP_COMMIT].weight =
+        get_uint_parm(valset, YANGLOAD_PARM_COMMIT_WEIGHT, 0);
+    lp->totalweight = lp->ops[YANGLOAD_OP_GET].weight +
+        lp->ops[YANGLOAD_OP_EDIT_CONFIG].weight +
+        lp->ops[YANGLOAD_OP_COMMIT].weight;
+
+    lp->get_select = get_str_parm(valset, YANGLOAD_PARM_GET_SELECT);
+    lp->edit_content = get_str_parm(valset, YANGLOAD_PARM_EDIT_CONTENT);
+    lp->edit_target = NCX_EL_CANDIDATE;
+    val = val_find_child(valset, YANGLOAD_MOD, YANGLOAD_PARM_EDIT_TARGET);
+    if (val && val->res == NO_ERR) {
+        lp->edit_target = VAL_ENUM_NAME(val);
+    }
+
+    lp->output = get_str_parm(valset, YANGLOAD_PARM_OUTPUT);
+
+    return NO_ERR;
+
+} /* process_cli_input */
+
+
+/********************************************************************
+* FUNCTION open_sessions
+*
+* Start all the sessions; the <hello> exchange finishes
+* in the mgr_io loop
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    open_sessions (void)
+{
+    boolean default_keys = FALSE;
+    uint32 i;
+
+    if (loadparms.user == NULL) {
+        log_error("\nError: --%s is required", YANGLOAD_PARM_USER);
+        return ERR_NCX_MISSING_PARM;
+    }
+
+    if (loadparms.pubkey &&
+        !strcmp(loadparms.pubkey, YANGLOAD_DEF_PUBLIC_KEY)) {
+        default_keys = TRUE;
+    }
+    if (!default_keys && loadparms.privkey &&
+        !strcmp(loadparms.privkey, YANGLOAD_DEF_PRIVATE_KEY)) {
+        default_keys = TRUE;
+    }
+
+    loadparms.ses = m__getMem(loadparms.sessions * sizeof(yangload_ses_t));
+    if (loadparms.ses == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    memset(loadparms.ses, 0x0, loadparms.sessions * sizeof(yangload_ses_t));
+    for (i = 0; i < loadparms.sessions; i++) {
+        dlq_createSQue(&loadparms.ses[i].pendingQ);
+    }
+
+    for (i = 0; i < loadparms.sessions; i++) {
+        yangload_ses_t *ls = &loadparms.ses[i];
+        status_t res =
+            mgr_ses_new_session(loadparms.user,
+                                loadparms.password,
+                                loadparms.pubkey,
+                                loadparms.privkey,
+                                (loadparms.server) ?
+                                loadparms.server :
+                                (const xmlChar *)"localhost",
+                                loadparms.ncport,
+                                loadparms.transport,
+                                NULL,  /* progcb */
+                                &ls->sid,
+                                NULL,  /* getvar_fn */
+                                cli_val,
+                                0,     /* protocols_bits */
+                                NULL,  /* session_cb */
+                                FALSE, /* direct_mode */
+                                default_keys);
+        if (res != NO_ERR) {
+            log_error("\nError: session %u to '%s' failed (%s)",
+                      i + 1,
+                      (loadparms.transport == SES_TRANSPORT_LOCAL) ?
+                      (const xmlChar *)NCXSERVER_SOCKNAME :
+                      loadparms.server,
+                      get_error_string(res));
+            ls->closed = TRUE;
+            return res;
+        }
+        if (ls->sid >= sizeof(sesmap) / sizeof(sesmap[0])) {
+            ls->closed = TRUE;
+            return SET_ERROR(ERR_INTERNAL_VAL);
+        }
+        sesmap[ls->sid] = ls;
+    }
+
+    return NO_ERR;
+
+}  /* open_sessions */
+
+
+/********************************************************************
+* FUNCTION main_run
+*
+* Run the load test and report the results
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    main_run (void)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    if (loadparms.versionmode || loadparms.helpmode) {
+        xmlChar versionbuffer[NCX_VERSION_BUFFSIZE];
+        res = ncx_get_version(versionbuffer, NCX_VERSION_BUFFSIZE);
+        if (res == NO_ERR) {
+            log_stdout("\n%s version %s\n", YANGLOAD_PROGNAME,
+                       versionbuffer);
+        } else {
+            SET_ERROR(res);
+        }
+    }
+
+    if (loadparms.helpmode) {
+        help_program_module(YANGLOAD_MOD, YANGLOAD_CONTAINER,
+                            loadparms.helpsubmode);
+    }
+
+    if (loadparms.helpmode || loadparms.versionmode) {
+        return res;
+    }
+
+    res = load_modules();
+    if (res == NO_ERR) {
+        res = make_templates();
+    }
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    mgr_io_set_stdin_handler(stdin_handler);
+    mgr_set_ses_closed_handler(session_closed_handler);
+    mgr_not_set_callback_fn(notification_handler);
+
+    loadparms.phase = YANGLOAD_PH_CONNECT;
+    loadparms.phasestart = get_nsecs();
+    loadparms.runres = NO_ERR;
+
+    res = open_sessions();
+    if (res == NO_ERR) {
+        res = mgr_io_run();
+    }
+    if (res == NO_ERR) {
+        res = loadparms.runres;
+    }
+
+    /* report what was measured, even if the run was cut short */
+    if (loadparms.runstart) {
+        for (i = 0; i < YANGLOAD_NUM_OPS; i++) {
+            yangload_opstats_t *op = &loadparms.ops[i];
+            if (op->replies) {
+                qsort(op->samples, op->replies, sizeof(uint64),
+                      compare_samples);
+            }
+        }
+        print_results();
+        if (loadparms.output) {
+            status_t res2 = write_results(loadparms.output);
+            if (res == NO_ERR) {
+                res = res2;
+            }
+        }
+    }
+
+    return res;
+
+}  /* main_run */
+
+
+/********************************************************************
+ * FUNCTION main_init
+ *
+ *
+ *
+ *********************************************************************/
+static status_t
+    main_init (int argc,
+               char *argv[])
+{
+    status_t       res;
+
+    /* init module static variables */
+    memset(&loadparms, 0x0, sizeof(yangload_parms_t));
+    memset(sesmap, 0x0, sizeof(sesmap));
+    cli_val = NULL;
+
+    /* set the default debug output level/mode */
+    log_init_logfn_va();
+
+    /* initialize the NCX Library first to allow NCX modules
+     * to be processed.  No module can get its internal config
+     * until the NCX module parser and definition registry is up
+     */
+    res = ncx_init(FALSE, LOG_DEBUG_INFO, TRUE, TRUE, FALSE, NULL,
+                   argc, argv);
+
+    if (res == NO_ERR) {
+        /* load in the load generator CLI definition file */
+        res = ncxmod_load_module(YANGLOAD_MOD, NULL, NULL, NULL);
+    }
+
+    if (res == NO_ERR) {
+        /* load in the NETCONF data types and RPC methods */
+        res = ncxmod_load_module(NCXMOD_NETCONF, NULL, NULL, NULL);
+    }
+
+    if (res == NO_ERR) {
+        /* load in <create-subscription> */
+        res = ncxmod_load_module(NCN_MODULE, NULL, NULL, NULL);
+    }
+
+    if (res == NO_ERR) {
+        res = mgr_init();
+    }
+
+    if (res == NO_ERR) {
+        res = process_cli_input(argc, argv, &loadparms);
+    }
+
+    return res;
+
+}  /* main_init */
+
+
+/********************************************************************
+ * FUNCTION main_cleanup
+ *
+ *
+ *
+ *********************************************************************/
+static void
+    main_cleanup (void)
+{
+    uint32 i;
+
+    if (loadparms.ses) {
+        for (i = 0; i < loadparms.sessions; i++) {
+            yangload_ses_t *ls = &loadparms.ses[i];
+            free_pending(ls, FALSE);
+            if (!ls->closed && ls->sid) {
+                mgr_ses_free_session(ls->sid);
+            }
+        }
+        m__free(loadparms.ses);
+    }
+
+    for (i = 0; i < YANGLOAD_NUM_OPS; i++) {
+        yangload_opstats_t *op = &loadparms.ops[i];
+        if (op->reqdata) {
+            val_free_value(op->reqdata);
+        }
+        if (op->samples) {
+            m__free(op->samples);
+        }
+    }
+
+    if (cli_val) {
+        val_free_value(cli_val);
+    }
+
+    mgr_cleanup();
+
+    /* cleanup the NCX engine and registries */
+    ncx_cleanup();
+
+}  /* main_cleanup */
+
+
+/********************************************************************
+*                                                                   *
+*                       FUNCTION main                               *
+*                                                                   *
+*********************************************************************/
+int
+    main (int argc,
+          char *argv[])
+{
+    status_t    res;
+
+#ifdef MEMORY_DEBUG
+    mtrace();
+#endif
+
+    res = main_init(argc, argv);
+
+    if (res == NO_ERR) {
+        res = main_run();
+    }
+
+    if (res != NO_ERR && res != ERR_NCX_SKIPPED) {
+        pr_err(res);
+    }
+
+    print_errors();
+
+    main_cleanup();
+
+    print_error_count();
+
+#ifdef MEMORY_DEBUG
+    muntrace();
+#endif
+
+    return (res == NO_ERR) ? 0 : 1;
+
+} /* main */
+
+/* END yangload.c */
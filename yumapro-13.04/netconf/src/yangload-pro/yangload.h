@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_yangload
+#define _H_yangload
+
+/*  FILE: yangload.h
+*********************************************************************
+*								    *
+*			 P U R P O S E				    *
+*								    *
+*********************************************************************
+
+  NETCONF load generator: CLI parameters and run state
+
+*/
+
+#include <xmlstring.h>
+
+#ifndef _H_dlq
+#include "dlq.h"
+#endif
+
+#ifndef _H_help
+#include "help.h"
+#endif
+
+#ifndef _H_mgr_rpc
+#include "mgr_rpc.h"
+#endif
+
+#ifndef _H_ncxtypes
+#include "ncxtypes.h"
+#endif
+
+#ifndef _H_obj
+#include "obj.h"
+#endif
+
+#ifndef _H_ses
+#include "ses.h"
+#endif
+
+#ifndef _H_val
+#include "val.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+*								    *
+*			 C O N S T A N T S			    *
+*								    *
+*********************************************************************/
+#define YANGLOAD_PROGNAME   (const xmlChar *)"yangload-pro"
+
+#define YANGLOAD_MOD               (const xmlChar *)"yangload-pro"
+#define YANGLOAD_CONTAINER         (const xmlChar *)"yangload-pro"
+
+#define YANGLOAD_DEF_CONFIG        (const xmlChar *)\
+    "/etc/yumapro/yangload-pro.conf"
+
+#define YANGLOAD_PARM_CONFIG        (const xmlChar *)"config"
+#define YANGLOAD_PARM_SERVER        (const xmlChar *)"server"
+#define YANGLOAD_PARM_USER          (const xmlChar *)"user"
+#define YANGLOAD_PARM_PASSWORD      (const xmlChar *)"password"
+#define YANGLOAD_PARM_NCPORT        (const xmlChar *)"ncport"
+#define YANGLOAD_PARM_PUBLIC_KEY    (const xmlChar *)"public-key"
+#define YANGLOAD_PARM_PRIVATE_KEY   (const xmlChar *)"private-key"
+#define YANGLOAD_PARM_TRANSPORT     (const xmlChar *)"transport"
+#define YANGLOAD_PARM_SESSIONS      (const xmlChar *)"sessions"
+#define YANGLOAD_PARM_RATE          (const xmlChar *)"rate"
+#define YANGLOAD_PARM_DURATION      (const xmlChar *)"duration"
+#define YANGLOAD_PARM_TIMEOUT       (const xmlChar *)"timeout"
+#define YANGLOAD_PARM_GET_WEIGHT    (const xmlChar *)"get-weight"
+#define YANGLOAD_PARM_GET_SELECT    (const xmlChar *)"get-select"
+#define YANGLOAD_PARM_EDIT_WEIGHT   (const xmlChar *)"edit-config-weight"
+#define YANGLOAD_PARM_EDIT_CONTENT  (const xmlChar *)"edit-content"
+#define YANGLOAD_PARM_EDIT_TARGET   (const xmlChar *)"edit-target"
+#define YANGLOAD_PARM_COMMIT_WEIGHT (const xmlChar *)"commit-weight"
+#define YANGLOAD_PARM_SUBSCRIPTIONS (const xmlChar *)"subscriptions"
+#define YANGLOAD_PARM_OUTPUT        (const xmlChar *)"output"
+
+#define YANGLOAD_TRANSPORT_TCP      (const xmlChar *)"tcp"
+#define YANGLOAD_TRANSPORT_LOCAL    (const xmlChar *)"local"
+
+#define YANGLOAD_DEF_PUBLIC_KEY     "$HOME/.ssh/id_rsa.pub"
+#define YANGLOAD_DEF_PRIVATE_KEY    "$HOME/.ssh/id_rsa"
+#define YANGLOAD_DEF_TIMEOUT        30
+
+/* number of latency samples added each time an array is full */
+#define YANGLOAD_SAMPLE_CHUNK       4096
+
+/* version of the JSON results file format */
+#define YANGLOAD_FORMAT_VERSION     1
+
+#define YANGLOAD_NSEC_PER_SEC       1000000000ULL
+#define YANGLOAD_NSEC_PER_MSEC      1000000ULL
+
+
+/********************************************************************
+*								    *
+*			     T Y P E S				    *
+*								    *
+*********************************************************************/
+
+/* operations in the request mix */
+typedef enum yangload_op_t_ {
+    YANGLOAD_OP_GET,
+    YANGLOAD_OP_EDIT_CONFIG,
+    YANGLOAD_OP_COMMIT,
+    YANGLOAD_OP_CREATE_SUBSCRIPTION,
+    YANGLOAD_NUM_OPS
+} yangload_op_t;
+
+/* run phases, driven from the mgr_io loop */
+typedef enum yangload_phase_t_ {
+    YANGLOAD_PH_CONNECT,         /* waiting for all the <hello>s */
+    YANGLOAD_PH_SUBSCRIBE,       /* waiting for <create-subscription> */
+    YANGLOAD_PH_RUN,             /* sending on the fixed schedule */
+    YANGLOAD_PH_DRAIN,           /* waiting for the last replies */
+    YANGLOAD_PH_DONE
+} yangload_phase_t;
+
+/* request template and statistics for one operation */
+typedef struct yangload_opstats_t_ {
+    const xmlChar    *name;
+    uint32            weight;
+    int64             curweight;        /* smooth weighted round-robin */
+    obj_template_t   *rpc;
+    val_value_t      *reqdata;         /* cloned for each request */
+    uint64            sent;
+    uint64            replies;
+    uint64            rpcerrors;      /* <rpc-error> or bad reply */
+    uint64            failed;     /* not sent, session lost, timeout */
+    uint64           *samples;     /* latency of each reply in nsecs */
+    uint64            maxsamples;
+} yangload_opstats_t;
+
+/* one request waiting for a reply */
+typedef struct yangload_pending_t_ {
+    dlq_hdr_t         qhdr;
+    mgr_rpc_req_t    *req;             /* back-ptr, not owned */
+    yangload_op_t     op;
+    uint64            intended;     /* scheduled send time in nsecs */
+} yangload_pending_t;
+
+/* one client session */
+typedef struct yangload_ses_t_ {
+    ses_id_t          sid;
+    boolean           ready;
+    boolean           closed;
+    dlq_hdr_t         pendingQ;           /* Q of yangload_pending_t */
+} yangload_ses_t;
+
+/* struct of yangload parameters and run state */
+typedef struct yangload_parms_t_ {
+    /* external parameters */
+    const xmlChar    *config;
+    const xmlChar    *server;
+    const xmlChar    *user;
+    const xmlChar    *password;
+    const char       *pubkey;
+    const char       *privkey;
+    const xmlChar    *get_select;
+    const xmlChar    *edit_content;
+    const xmlChar    *edit_target;
+    const xmlChar    *output;
+    ses_transport_t   transport;
+    uint16            ncport;
+    uint32            sessions;
+    uint32            rate;
+    uint32            duration;
+    uint32            timeout;
+    uint32            subscriptions;
+    boolean           helpmode;
+    help_mode_t       helpsubmode;
+    boolean           versionmode;
+
+    /* internal vars */
+    yangload_ses_t   *ses;                 /* array of 'sessions' */
+    uint32            nextses;
+    yangload_opstats_t ops[YANGLOAD_NUM_OPS];
+    uint32            totalweight;
+    yangload_phase_t  phase;
+    uint64            phasestart;
+    uint64            runstart;
+    uint64            runend;
+    uint64            drainend;
+    uint64            schedcount;
+    uint64            nextsend;
+    uint64            outstanding;
+    uint64            notifications;
+    status_t          runres;
+} yangload_parms_t;
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif	    /* _H_yangload */
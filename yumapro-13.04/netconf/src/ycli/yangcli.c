@@ -71,6 +71,7 @@ date         init     comment
 #include "mgr_not.h"
 #include "mgr_rpc.h"
 #include "mgr_ses.h"
+#include "mgr_val_parse.h"
 #include "ncx.h"
 #include "ncx_list.h"
 #include "ncx_num.h"
@@ -97,6 +98,8 @@ date         init     comment
 #include "yangcli_autotest.h"
 #include "yangcli_cmd.h"
 #include "yangcli_config.h"
+#include "yangcli_fanout.h"
+#include "yangcli_replay.h"
 #include "yangcli_notif.h"
 #include "yangcli_save.h"
 #include "yangcli_server.h"
@@ -360,6 +363,12 @@ static const xmlChar *force_target;
 /* default use-xmlheader */
 static boolean use_xmlheader;
 
+/* default stream-replies */
+static boolean stream_replies;
+
+/* default stream-validate */
+static boolean stream_validate;
+
 /* default config-edit-mode */
 static config_edit_mode_t config_edit_mode;
 
@@ -786,6 +795,9 @@ static void
 
     record_test_cleanup(server_cb);
 
+    yangcli_fanout_cleanup(server_cb);
+    yangcli_replay_cleanup(server_cb);
+
     m__free(server_cb);
 
 }  /* free_server_cb */
@@ -820,6 +832,7 @@ static server_cb_t *
     /* sessions for this server */
     dlq_createSQue(&server_cb->session_cfgQ);
     dlq_createSQue(&server_cb->session_cbQ);
+    dlq_createSQue(&server_cb->session_groupQ);
 
     yangcli_ut_init(server_cb);
     record_test_init(server_cb);
@@ -1013,6 +1026,8 @@ static session_cb_t *
     session_cb->autonotif = autonotif;
 
     session_cb->use_xmlheader = use_xmlheader;
+    session_cb->stream_replies = stream_replies;
+    session_cb->stream_validate = stream_validate;
     session_cb->config_edit_mode = config_edit_mode;
 
     return session_cb;
@@ -1342,6 +1357,28 @@ static status_t
             log_error("\nError: value must be 'true' or 'false'\n");
             res = ERR_NCX_INVALID_VALUE;
         }
+    } else if (!xml_strcmp(configval->name, YANGCLI_STREAM_REPLIES)) {
+        if (ncx_is_true(usestr)) {
+            stream_replies = TRUE;
+            session_cb->stream_replies = TRUE;
+        } else if (ncx_is_false(usestr)) {
+            stream_replies = FALSE;
+            session_cb->stream_replies = FALSE;
+        } else {
+            log_error("\nError: value must be 'true' or 'false'\n");
+            res = ERR_NCX_INVALID_VALUE;
+        }
+    } else if (!xml_strcmp(configval->name, YANGCLI_STREAM_VALIDATE)) {
+        if (ncx_is_true(usestr)) {
+            stream_validate = TRUE;
+            session_cb->stream_validate = TRUE;
+        } else if (ncx_is_false(usestr)) {
+            stream_validate = FALSE;
+            session_cb->stream_validate = FALSE;
+        } else {
+            log_error("\nError: value must be 'true' or 'false'\n");
+            res = ERR_NCX_INVALID_VALUE;
+        }
     } else if (!xml_strcmp(configval->name, YANGCLI_CONFIG_EDIT_MODE)) {
         config_edit_mode_t editmode = cvt_config_edit_mode_str(usestr);
         if (editmode != CFG_EDITMODE_NONE) {
@@ -2426,6 +2463,20 @@ static status_t
         return res;
     }
 
+    /* $$ stream-replies = boolean */
+    res = create_config_var(server_cb, YANGCLI_STREAM_REPLIES, 
+                            (stream_replies) ? NCX_EL_TRUE : NCX_EL_FALSE);
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    /* $$ stream-validate = boolean */
+    res = create_config_var(server_cb, YANGCLI_STREAM_VALIDATE, 
+                            (stream_validate) ? NCX_EL_TRUE : NCX_EL_FALSE);
+    if (res != NO_ERR) {
+        return res;
+    }
+
     /* $$ config-edit-mode = enum */
     res = create_config_var(server_cb, YANGCLI_CONFIG_EDIT_MODE, 
                             cvt_config_edit_mode_enum(config_edit_mode));
@@ -2972,6 +3023,19 @@ static status_t
         use_xmlheader = VAL_BOOL(parm);
     }
 
+    /* get the stream-replies parameter */
+    parm = val_find_child(mgr_cli_valset, YANGCLI_MOD, YANGCLI_STREAM_REPLIES);
+    if (parm && parm->res == NO_ERR) {
+        stream_replies = VAL_BOOL(parm);
+    }
+
+    /* get the stream-validate parameter */
+    parm = val_find_child(mgr_cli_valset, YANGCLI_MOD,
+                          YANGCLI_STREAM_VALIDATE);
+    if (parm && parm->res == NO_ERR) {
+        stream_validate = VAL_BOOL(parm);
+    }
+
     /* get the config-edit-mode parameter */
     parm = val_find_child(mgr_cli_valset, YANGCLI_MOD,
                           YANGCLI_CONFIG_EDIT_MODE);
@@ -3269,20 +3333,29 @@ static void
         }  // while (cap)
     }
 
+    /* use the modules compiled for an earlier session to a
+     * server with the same capabilities, if they are still held;
+     * the temp files and <get-schema> steps are not needed then
+     */
+    boolean shared = autoload_attach_modules(session_cb, scb);
+
     /* get all the advertised YANG data model modules into the
      * session temp work directory that are local to the system
      */
-    res = autoload_setup_tempdir(server_cb, session_cb, scb);
-    if (res != NO_ERR) {
-        log_error("\nError: autoload setup temp files failed (%s)\n",
-                  get_error_string(res));
+    if (!shared) {
+        res = autoload_setup_tempdir(server_cb, session_cb, scb);
+        if (res != NO_ERR) {
+            log_error("\nError: autoload setup temp files failed (%s)\n",
+                      get_error_string(res));
+        }
     }
 
     /* go through all the search results (if any)
      * and see if <get-schema> is needed to pre-load
      * the session work directory YANG files
      */
-    if (res == NO_ERR && retrieval_supported && session_cb->autoload) {
+    if (res == NO_ERR && !shared && retrieval_supported &&
+        session_cb->autoload) {
         /* compile phase will be delayed until autoload
          * get-schema operations are done
          */
@@ -3333,7 +3406,7 @@ static boolean
     mscb = (mgr_scb_t *)scb->mgrcb;
 
     if (mscb) {
-        deletecount = mgr_rpc_timeout_requestQ(&mscb->reqQ);
+        deletecount = mgr_rpc_timeout_requests(scb);
         if (deletecount) {
             log_error("\nError: request to server timed out\n");
         }
@@ -3539,7 +3612,7 @@ static void
 
 
 /********************************************************************
-* yangcli_stdin_handler
+* handle_stdin
 *
 * Temp: Calling readline which will block other IO while the user
 *       is editing the line.  This is okay for this CLI application
@@ -3551,7 +3624,7 @@ static void
 *   new program state
 *********************************************************************/
 static mgr_io_state_t
-    yangcli_stdin_handler (void)
+    handle_stdin (void)
 {
     /* TBD: support more than 1 application server */
     server_cb_t *server_cb = cur_server_cb;
@@ -3589,6 +3662,21 @@ static mgr_io_state_t
         session_cb->state = MGR_IO_ST_SHUT;
     }
 
+    /* a fanout command holds the CLI until all its requests are done */
+    if (yangcli_fanout_check(server_cb)) {
+        return MGR_IO_ST_CONN_RPYWAIT;
+    }
+
+    /* a replay command holds the CLI until all its steps are done */
+    if (yangcli_replay_check(server_cb)) {
+        return MGR_IO_ST_CONN_RPYWAIT;
+    }
+
+    /* a parallel test-suite run holds the CLI until its tests are done */
+    if (yangcli_ut_parallel_check(server_cb)) {
+        return MGR_IO_ST_CONN_RPYWAIT;
+    }
+
     status_t res = NO_ERR;
     ses_cb_t *scb = NULL;
     mgr_scb_t *mscb = NULL;
@@ -3612,7 +3700,7 @@ static mgr_io_state_t
         } else  {
             res = NO_ERR;
             mscb = (mgr_scb_t *)scb->mgrcb;
-            ncx_set_temp_modQ(&mscb->temp_modQ);
+            ncx_set_temp_modQ(mgr_get_modQ(mscb));
 
             /* check locks timeout */
             if (session_cb->command_mode == CMD_MODE_AUTOLOCK ||
@@ -3681,7 +3769,7 @@ static mgr_io_state_t
                                 HELP_MODE_NONE);
             check_module_capabilities(server_cb, session_cb, scb);
             mscb = (mgr_scb_t *)scb->mgrcb;
-            ncx_set_temp_modQ(&mscb->temp_modQ);
+            ncx_set_temp_modQ(mgr_get_modQ(mscb));
 
             /* Check if connect_all sessions in progress */
             check_connect_all_sessions (server_cb);
@@ -3714,7 +3802,7 @@ static mgr_io_state_t
             /* session is active; init state check command mode */
             res = NO_ERR;
             mscb = (mgr_scb_t *)scb->mgrcb;
-            ncx_set_temp_modQ(&mscb->temp_modQ);
+            ncx_set_temp_modQ(mgr_get_modQ(mscb));
 
             /* check timeout */
             if (message_timed_out(scb)) {
@@ -3907,6 +3995,11 @@ static mgr_io_state_t
         session_cb->autoconfig_saveline = NULL;
     } else {
         line = get_input_line(server_cb, isautotest, &res);
+        if (isautotest && line == NULL && res == NO_ERR &&
+            yangcli_ut_parallel_active(server_cb)) {
+            /* the test steps are sent by yangcli_ut_parallel_check */
+            return session_cb->state;
+        }
     }
 
     /* need to get the current session over here because get_prompt
@@ -4171,6 +4264,38 @@ static mgr_io_state_t
     }
     return session_cb->state;
 
+} /* handle_stdin */
+
+
+/********************************************************************
+* yangcli_stdin_handler
+*
+* STDIN handler called by mgr_io_run on each pass
+* Matches mgr_io_stdin_fn_t template
+*
+* In the idle states the CLI waits for keyboard input in
+* the readline call, or runs the next script command, so
+* mgr_io is told not to wait for server input as well
+*
+* RETURNS:
+*   new program state
+*********************************************************************/
+static mgr_io_state_t
+    yangcli_stdin_handler (void)
+{
+    mgr_io_state_t state = handle_stdin();
+
+    switch (state) {
+    case MGR_IO_ST_INIT:
+    case MGR_IO_ST_IDLE:
+    case MGR_IO_ST_CONN_IDLE:
+        mgr_io_set_wakeup(0);
+        break;
+    default:
+        ;
+    }
+    return state;
+
 } /* yangcli_stdin_handler */
 
 
@@ -5093,7 +5218,7 @@ void
     if (mgrcb) {
         usesid = mgrcb->agtsid;
         session_cb = mgrcb->session_cb;
-        ncx_set_temp_modQ(&mgrcb->temp_modQ);
+        ncx_set_temp_modQ(mgr_get_modQ(mgrcb));
     }
 
     if (session_cb == NULL) {
@@ -5208,7 +5333,25 @@ void
          * TBD: use a CLI switch to control whether
          * to save if <rpc-errors> received
          */
-        if (server_cb->result_name || server_cb->result_filename) {
+        if (req->stream && req->stream->started) {
+            /* the <data> element was already written to the 
+             * result file while the reply was parsed
+             */
+            mgr_val_stream_t *stream = req->stream;
+            if (stream->res != NO_ERR) {
+                log_error("\nError: output to file '%s' failed (%s)\n",
+                          stream->filespec, get_error_string(stream->res));
+                res = stream->res;
+            } else if (LOGINFO && session_cb->command_mode == CMD_MODE_NORMAL) {
+                log_info("\nWrote %u nodes to '%s'",
+                         stream->nodes, stream->filespec);
+                if (stream->errors) {
+                    log_info_append(" (%u schema errors)", stream->errors);
+                }
+                log_info_append("\n");
+            }
+            clear_result(server_cb);
+        } else if (server_cb->result_name || server_cb->result_filename) {
             /* save the data element if it exists */
             val_value_t *val = 
                 val_first_child_name(rpy->reply, NCX_EL_DATA);
@@ -5275,7 +5418,8 @@ void
             break;
         case CMD_MODE_AUTOLOAD:
             (void)autoload_handle_rpc_reply(server_cb, session_cb,
-                                            scb, rpy->reply, anyerrors);
+                                            scb, req, rpy->reply,
+                                            anyerrors);
             break;
         case CMD_MODE_AUTOLOCK:
             done = FALSE;
@@ -6019,8 +6163,8 @@ void
     if (scb) {
         mgr_scb_t *mscb = (mgr_scb_t *)scb->mgrcb;
         if (mscb) {
-            ncx_set_session_modQ(&mscb->temp_modQ);
-            ncx_set_temp_modQ(&mscb->temp_modQ);
+            ncx_set_session_modQ(mgr_get_modQ(mscb));
+            ncx_set_temp_modQ(mgr_get_modQ(mscb));
         }
     }
 
@@ -6196,6 +6340,8 @@ status_t
     alt_names = TRUE;
     force_target = NULL;
     use_xmlheader = TRUE;
+    stream_replies = FALSE;
+    stream_validate = FALSE;
     config_edit_mode = CFG_EDITMODE_LEVEL;
     yangcli_def_aliases_file_mtime = 0;
     yangcli_def_uservars_file_mtime = 0;
@@ -6777,6 +6923,8 @@ void
     session_cb->match_names = match_names;
     session_cb->alt_names = alt_names;
     session_cb->use_xmlheader = use_xmlheader;
+    session_cb->stream_replies = stream_replies;
+    session_cb->stream_validate = stream_validate;
     session_cb->config_edit_mode = config_edit_mode;
     session_cb->autoconfig = autoconfig;
     session_cb->autonotif = autonotif;
@@ -244,10 +244,13 @@ extern "C" {
 #define YANGCLI_FORCE_TARGET (const xmlChar *)"force-target"
 #define YANGCLI_FULL        (const xmlChar *)"full"
 #define YANGCLI_GLOBAL      (const xmlChar *)"global"
+#define YANGCLI_GROUP       (const xmlChar *)"group"
 #define YANGCLI_GLOBALS     (const xmlChar *)"globals"
 #define YANGCLI_ID          (const xmlChar *)"id"
 #define YANGCLI_INDEX       (const xmlChar *)"index"
 #define YANGCLI_ITERATIONS  (const xmlChar *)"iterations"
+#define YANGCLI_JSON_REPORT (const xmlChar *)"json-report"
+#define YANGCLI_JUNIT_REPORT (const xmlChar *)"junit-report"
 #define YANGCLI_LEVEL       (const xmlChar *)"level"
 #define YANGCLI_LINE        (const xmlChar *)"line"
 #define YANGCLI_LOAD        (const xmlChar *)"load"
@@ -255,6 +258,7 @@ extern "C" {
 #define YANGCLI_LOCAL       (const xmlChar *)"local"
 #define YANGCLI_LOCALS      (const xmlChar *)"locals"
 #define YANGCLI_MANUAL      (const xmlChar *)"manual"
+#define YANGCLI_MAX_IN_FLIGHT (const xmlChar *)"max-in-flight"
 #define YANGCLI_MODE        (const xmlChar *)"mode"
 #define YANGCLI_MODULE      (const xmlChar *)"module"
 #define YANGCLI_MODULES     (const xmlChar *)"modules"
@@ -266,11 +270,14 @@ extern "C" {
 #define YANGCLI_OPERATION   (const xmlChar *)"operation"
 #define YANGCLI_OPTIONAL    (const xmlChar *)"optional"
 #define YANGCLI_ORDER       (const xmlChar *)"order"
+#define YANGCLI_PARALLEL    (const xmlChar *)"parallel"
 #define YANGCLI_PASSWORD    (const xmlChar *)"password"
+#define YANGCLI_PIPELINE    (const xmlChar *)"pipeline"
 #define YANGCLI_PROMPT_TYPE (const xmlChar *)"prompt-type"
 #define YANGCLI_PROTOCOLS   (const xmlChar *)"protocols"
 #define YANGCLI_PRIVATE_KEY (const xmlChar *)"private-key"
 #define YANGCLI_PUBLIC_KEY  (const xmlChar *)"public-key"
+#define YANGCLI_RATE        (const xmlChar *)"rate"
 #define YANGCLI_RECORD_TEST  (const xmlChar *)"record-test"
 #define YANGCLI_RECORD_CANCEL (const xmlChar *)"cancel"
 #define YANGCLI_RECORD_FINISH (const xmlChar *)"finish"
@@ -282,14 +289,20 @@ extern "C" {
 #define YANGCLI_RESTART_OK  (const xmlChar *)"restart-ok"
 #define YANGCLI_RETRY_INTERVAL (const xmlChar *)"retry-interval"
 #define YANGCLI_RUN_ALL  (const xmlChar *)"run-all"
+#define YANGCLI_RPC_STATS   (const xmlChar *)"rpc-stats"
+#define YANGCLI_RPC_STATS_PATH \
+    (const xmlChar *)"/netconf-state/rpc-statistics"
 #define YANGCLI_RUN_COMMAND (const xmlChar *)"run-command"
 #define YANGCLI_RUN_SCRIPT  (const xmlChar *)"run-script"
 #define YANGCLI_START       (const xmlChar *)"start"
 #define YANGCLI_SCRIPT_INPUT (const xmlChar *)"script-input"
+#define YANGCLI_SCRIPT      (const xmlChar *)"script"
 #define YANGCLI_SCRIPTS     (const xmlChar *)"scripts"
 #define YANGCLI_SERVER      (const xmlChar *)"server"
 #define YANGCLI_SESSION    (const xmlChar *)"session"
 #define YANGCLI_SESSION_CFG (const xmlChar *)"session-cfg"
+#define YANGCLI_SESSION_GROUP (const xmlChar *)"session-group"
+#define YANGCLI_SESSIONS    (const xmlChar *)"sessions"
 #define YANGCLI_SESSIONS_CFG (const xmlChar *)"sessions-cfg"
 #define YANGCLI_SESSION_NAME  (const xmlChar *)"session-name"
 #define YANGCLI_START_SESSION (const xmlChar *)"start-session"
@@ -297,6 +310,8 @@ extern "C" {
 #define YANGCLI_STDOUT (const xmlChar *)"stdout"
 #define YANGCLI_STOP_SESSION (const xmlChar *)"stop-session"
 #define YANGCLI_STOP_RPC_TIMING (const xmlChar *)"stop-rpc-timing"
+#define YANGCLI_STREAM_REPLIES (const xmlChar *)"stream-replies"
+#define YANGCLI_STREAM_VALIDATE (const xmlChar *)"stream-validate"
 #define YANGCLI_SYSTEM      (const xmlChar *)"system"
 #define YANGCLI_TERM        (const xmlChar *)"term"
 #define YANGCLI_TEST_OPTION (const xmlChar *)"test-option"
@@ -330,6 +345,7 @@ extern "C" {
 #define YANGCLI_END     (const xmlChar *)"end"
 #define YANGCLI_EVAL    (const xmlChar *)"eval"
 #define YANGCLI_EVENTLOG (const xmlChar *)"eventlog"
+#define YANGCLI_FANOUT  (const xmlChar *)"fanout"
 #define YANGCLI_FILL    (const xmlChar *)"fill"
 #define YANGCLI_GET_LOCKS (const xmlChar *)"get-locks"
 #define YANGCLI_HELP    (const xmlChar *)"help"
@@ -349,6 +365,7 @@ extern "C" {
 #define YANGCLI_RELEASE_LOCKS (const xmlChar *)"release-locks"
 #define YANGCLI_REMOVE  (const xmlChar *)"remove"
 #define YANGCLI_REPLACE (const xmlChar *)"replace"
+#define YANGCLI_REPLAY  (const xmlChar *)"replay"
 #define YANGCLI_RUN     (const xmlChar *)"run"
 #define YANGCLI_SAVE    (const xmlChar *)"save"
 #define YANGCLI_SET     (const xmlChar *)"set"
@@ -648,6 +665,8 @@ typedef struct yangcli_ut_suite_t_ {
     /* state data saved for each test run */
     boolean     suite_started;
     boolean     suite_errors;
+    struct timeval start_time;
+    uint64      wall_usec;
 } yangcli_ut_suite_t;
 
 
@@ -662,6 +681,8 @@ typedef struct yangcli_ut_test_t_ {
     /* state data saved for each test run */
     boolean        test_started;
     boolean        test_errors;
+    struct timeval start_time;
+    uint64         wall_usec;
 
     /* step number used to record a test */
     int32          step_num_to_record;
@@ -684,6 +705,7 @@ typedef struct yangcli_ut_step_t_ {
     dlq_hdr_t       result_error_infoQ;
 
     xmlChar         *command;
+    uint32           delay_msec;      /* time since the previous step */
 
     // TBD: will not be saved in string format
     //xmlChar         *anyxml_rpc_reply_data;
@@ -701,6 +723,8 @@ typedef struct yangcli_ut_step_t_ {
     boolean          step_error_tag_wrong;
     boolean          step_error_apptag_wrong;
     boolean          step_error_info_wrong;
+    struct timeval   start_time;
+    uint64           latency_usec;
 } yangcli_ut_step_t;
 
 
@@ -719,12 +743,20 @@ typedef struct yangcli_ut_context_t_ {
     uint32           linebuff_size;
     boolean          single_suite;         /* one suite or all suites */
 
+    /* parallel run and report options for each test-run */
+    xmlChar         *session_group;        /* malloced group name */
+    uint32           parallel;             /* 0 == size of group */
+    xmlChar         *junit_report;         /* malloced filespec */
+    xmlChar         *json_report;          /* malloced filespec */
+    struct ut_parallel_cb_t_ *parallel_cb; /* NULL unless running */
+
     /* following are back-ptrs into suite_listQ structures */
     yangcli_ut_suite_t *cur_suite;
     run_test_t         *cur_run_test;
     yangcli_ut_step_t  *cur_step;
     rawline_t          *cur_rawline;
     boolean            cur_step_record_done;
+    struct timeval     record_time;        /* last step recorded */
 } yangcli_ut_context_t;
 
 
@@ -768,6 +800,14 @@ typedef struct session_cfg_t_ {
 } session_cfg_t;
 
 
+/* named group of sessions for the fanout command */
+typedef struct session_group_t_ {
+    dlq_hdr_t  qhdr;
+    xmlChar   *name;
+    xmlChar   *sessions;     // session names, whitespace separated
+} session_group_t;
+
+
 /* YANGCLI context control block */
 typedef struct server_cb_t_ {
     dlq_hdr_t            qhdr;
@@ -795,6 +835,13 @@ typedef struct server_cb_t_ {
     boolean              autosessions;
     dlq_hdr_t            session_cfgQ;      /* Q of session_cfg_t */
     dlq_hdr_t            session_cbQ;      /* Q of session_cb_t */
+    dlq_hdr_t            session_groupQ;   /* Q of session_group_t */
+
+    /* fanout command in progress; NULL if none */
+    struct fanout_cb_t_ *fanout_cb;
+
+    /* replay command in progress; NULL if none */
+    struct replay_cb_t_ *replay_cb;
 
     /* support for temp directory for downloaded modules */
     ncxmod_temp_progcb_t *temp_progcb;
@@ -863,6 +910,8 @@ typedef struct session_cb_t_ {
     ncx_name_match_t     match_names;
     boolean              alt_names;
     boolean              use_xmlheader;
+    boolean              stream_replies;
+    boolean              stream_validate;
     boolean              def_session;
     boolean              autoconfig;
     boolean              autoconfig_done;
@@ -915,6 +964,7 @@ typedef struct session_cb_t_ {
      */
     dlq_hdr_t            searchresultQ; /* Q of ncxmod_search_result_t */
     ncxmod_search_result_t  *cursearchresult;
+    uint32               autoload_pending;  /* <get-schema> outstanding */
 
     /* support for temp directory for downloaded modules */
     ncxmod_temp_sescb_t  *temp_sescb;
@@ -38,6 +38,7 @@ date         init     comment
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <stdio.h>
@@ -49,6 +50,7 @@ date         init     comment
 #include "procdefs.h"
 #include "log.h"
 #include "mgr.h"
+#include "mgr_rpc.h"
 #include "mgr_ses.h"
 #include "ncx.h"
 #include "ncx_feature.h"
@@ -75,6 +77,12 @@ date         init     comment
 #define YANGCLI_AUTOLOAD_DEBUG 1
 #endif
 
+/* max number of <get-schema> requests outstanding at once */
+#define YANGCLI_AUTOLOAD_PIPELINE  8
+
+/* subdirectory of the yuma home dir that holds retrieved modules */
+#define YANGCLI_SCHEMA_CACHE_DIR   (const xmlChar *)"schema-cache"
+
 
 /********************************************************************
 * FUNCTION send_get_schema_to_server
@@ -185,22 +193,24 @@ static status_t
 * specified YANG file in the session work directory
 *
 * INPUTS:
-*    session_cb == session control block to use
-*    module == module name
-*    revision == revision date
+*    searchresult == search result for the module
 *    targetfile == filespec of the output file
 *    resultval == result to output to file
 *
+* OUTPUTS:
+*    searchresult->source set to a copy of targetfile
+*
 * RETURNS:
 *   status
 *********************************************************************/
 static status_t
-    save_schema_file (session_cb_t *session_cb,
-                      const xmlChar *module,
-                      const xmlChar *revision,
+    save_schema_file (ncxmod_search_result_t *searchresult,
                       const xmlChar *targetfile,
                       val_value_t *resultval)
 {
+    const xmlChar *module = searchresult->module;
+    const xmlChar *revision = searchresult->revision;
+
     if (LOGDEBUG) {
         log_debug("\nGot autoload reply for '%s' r'%s'",
                   module,
@@ -240,8 +250,8 @@ static status_t
         log_alt_close();
 
         /* copy the target filename into the search result */
-        session_cb->cursearchresult->source = xml_strdup(targetfile);
-        if (session_cb->cursearchresult->source == NULL) {
+        searchresult->source = xml_strdup(targetfile);
+        if (searchresult->source == NULL) {
             log_error("\nError: malloc failed for temporary file '%s'",
                       targetfile);
             return ERR_INTERNAL_MEM;
@@ -364,53 +374,31 @@ static ncxmod_temp_filcb_t *
 
 
 /********************************************************************
- * FUNCTION copy_module_to_tempdir
+ * FUNCTION copy_file
  * 
- * Copy the YANG source file to the session work directory
+ * Copy a text file line by line
  *
  * INPUTS:
- *   mscb == manager session control block to use
- *   module == module name to copy
- *   revision == revision date to copy
- *   source == complete pathspec of source YANG file
+ *   source == complete pathspec of the file to read
+ *   dest == complete pathspec of the file to write
  *
  * RETURNS:
  *   status
  *********************************************************************/
 static status_t
-    copy_module_to_tempdir (mgr_scb_t *mscb,
-                            const xmlChar *module,
-                            const xmlChar *revision,
-                            const xmlChar *source)
+    copy_file (const xmlChar *source,
+               const xmlChar *dest)
 {
     xmlChar             *linebuffer;
     FILE                *srcfile, *destfile;
-    ncxmod_temp_filcb_t *temp_filcb;
-    boolean              done, isyang;
+    boolean              done;
     status_t             res;
 
     res = NO_ERR;
-    linebuffer = NULL;
-    srcfile = NULL;
-    destfile = NULL;
-
-    if (yang_fileext_is_yang(source)) {
-        isyang = TRUE;
-    } else if (yang_fileext_is_yin(source)) {
-        isyang = FALSE;
-    } else {
-        return SET_ERROR(ERR_INTERNAL_VAL);
-    }
-
-    temp_filcb = get_new_temp_filcb(mscb, module, revision, isyang, &res);
-    if (temp_filcb == NULL) {
-        return res;
-    }
 
     /* get a buffer for transferring lines */
     linebuffer = m__getMem(NCX_MAX_LINELEN+1);;
     if (linebuffer == NULL) {
-        ncxmod_free_session_tempfile(temp_filcb);
         return ERR_INTERNAL_MEM;
     }
 
@@ -418,15 +406,14 @@ static status_t
     if (LOGDEBUG2) {
         log_debug2("\nyangcli_autoload: Copying '%s' to '%s'",
                    source,
-                   temp_filcb->source);
+                   dest);
     }
 #endif
 
     /* open the destination file for writing */
-    destfile = fopen((const char *)temp_filcb->source, "w");
+    destfile = fopen((const char *)dest, "w");
     if (destfile == NULL) {
         res = errno_to_status();
-        ncxmod_free_session_tempfile(temp_filcb);
         m__free(linebuffer);
         return res;
     }
@@ -436,7 +423,6 @@ static status_t
     if (srcfile == NULL) {
         res = errno_to_status();
         fclose(destfile);
-        ncxmod_free_session_tempfile(temp_filcb);
         m__free(linebuffer);
         return res;
     }
@@ -458,14 +444,319 @@ static status_t
     }
 
     fclose(srcfile);
-    fclose(destfile);
+    if (fclose(destfile) != 0 && res == NO_ERR) {
+        res = ERR_FIL_WRITE;
+    }
     m__free(linebuffer);
 
     return res;
 
+}   /* copy_file */
+
+
+/********************************************************************
+ * FUNCTION copy_module_to_tempdir
+ * 
+ * Copy the YANG source file to the session work directory
+ *
+ * INPUTS:
+ *   mscb == manager session control block to use
+ *   module == module name to copy
+ *   revision == revision date to copy
+ *   source == complete pathspec of source YANG file
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    copy_module_to_tempdir (mgr_scb_t *mscb,
+                            const xmlChar *module,
+                            const xmlChar *revision,
+                            const xmlChar *source)
+{
+    ncxmod_temp_filcb_t *temp_filcb;
+    boolean              isyang;
+    status_t             res;
+
+    res = NO_ERR;
+
+    if (yang_fileext_is_yang(source)) {
+        isyang = TRUE;
+    } else if (yang_fileext_is_yin(source)) {
+        isyang = FALSE;
+    } else {
+        return SET_ERROR(ERR_INTERNAL_VAL);
+    }
+
+    temp_filcb = get_new_temp_filcb(mscb, module, revision, isyang, &res);
+    if (temp_filcb == NULL) {
+        return res;
+    }
+
+    res = copy_file(source, temp_filcb->source);
+    if (res != NO_ERR && res != ERR_FIL_WRITE) {
+        ncxmod_free_session_tempfile(temp_filcb);
+    }
+
+    return res;
+
 }   /* copy_module_to_tempdir */
 
 
+/********************************************************************
+ * FUNCTION make_cache_filespec
+ * 
+ * Get the schema cache filespec for a module revision
+ *   $HOME/.yuma/schema-cache/<module>@<revision>.yang
+ *
+ * Modules are only cached if the revision is known,
+ * since the same name and revision always identify
+ * the same module source
+ *
+ * INPUTS:
+ *   module == module name
+ *   revision == revision date (may be NULL)
+ *   makedir == TRUE to create the cache directory if needed
+ *
+ * RETURNS:
+ *   malloced filespec; NULL if the module cannot be cached
+ *********************************************************************/
+static xmlChar *
+    make_cache_filespec (const xmlChar *module,
+                         const xmlChar *revision,
+                         boolean makedir)
+{
+    const xmlChar *yumadir = ncxmod_get_yumadir();
+    const xmlChar *p;
+    xmlChar       *buff, *q;
+    uint32         len;
+
+    if (yumadir == NULL || module == NULL || revision == NULL ||
+        !ncx_valid_name2(module)) {
+        return NULL;
+    }
+
+    /* the revision is used in the filename so only
+     * allow a YANG date string
+     */
+    if (*revision == 0) {
+        return NULL;
+    }
+    for (p = revision; *p; p++) {
+        if (!(isdigit((int)*p) || *p == '-')) {
+            return NULL;
+        }
+    }
+
+    len = xml_strlen(yumadir) + xml_strlen(YANGCLI_SCHEMA_CACHE_DIR) +
+        xml_strlen(module) + xml_strlen(revision) + 8;
+
+    buff = m__getMem(len);
+    if (buff == NULL) {
+        return NULL;
+    }
+
+    q = buff;
+    q += xml_strcpy(q, yumadir);
+    *q++ = NCXMOD_PSCHAR;
+    q += xml_strcpy(q, YANGCLI_SCHEMA_CACHE_DIR);
+
+    if (makedir) {
+        if (mkdir((const char *)buff, S_IRWXU) != 0 && errno != EEXIST) {
+            log_debug("\nautoload: cannot create schema cache '%s'",
+                      buff);
+            m__free(buff);
+            return NULL;
+        }
+    }
+
+    *q++ = NCXMOD_PSCHAR;
+    q += xml_strcpy(q, module);
+    *q++ = '@';
+    q += xml_strcpy(q, revision);
+    q += xml_strcpy(q, (const xmlChar *)".yang");
+
+    return buff;
+
+}   /* make_cache_filespec */
+
+
+/********************************************************************
+ * FUNCTION load_cached_schema
+ * 
+ * Check the schema cache for a module that would
+ * otherwise be retrieved with <get-schema>, and copy
+ * it to the session work directory if found
+ *
+ * INPUTS:
+ *   mscb == manager session control block to use
+ *   searchresult == search result for the module
+ *
+ * OUTPUTS:
+ *   searchresult->source set to the cache file if found
+ *
+ * RETURNS:
+ *   TRUE if the module was found in the cache
+ *********************************************************************/
+static boolean
+    load_cached_schema (mgr_scb_t *mscb,
+                        ncxmod_search_result_t *searchresult)
+{
+    xmlChar *cachefile = make_cache_filespec(searchresult->module,
+                                             searchresult->revision,
+                                             FALSE);
+    if (cachefile == NULL) {
+        return FALSE;
+    }
+
+    struct stat  statbuf;
+    if (stat((const char *)cachefile, &statbuf) != 0 ||
+        !S_ISREG(statbuf.st_mode)) {
+        m__free(cachefile);
+        return FALSE;
+    }
+
+    status_t res = copy_module_to_tempdir(mscb,
+                                          searchresult->module,
+                                          searchresult->revision,
+                                          cachefile);
+    if (res != NO_ERR) {
+        log_debug("\nautoload: schema cache file '%s' not used (%s)",
+                  cachefile, get_error_string(res));
+        m__free(cachefile);
+        return FALSE;
+    }
+
+    if (LOGDEBUG) {
+        log_debug("\nautoload: using cached module '%s' r'%s'",
+                  searchresult->module,
+                  searchresult->revision);
+    }
+
+    /* the search result takes over the malloced filespec */
+    searchresult->source = cachefile;
+    searchresult->fromcache = TRUE;
+    return TRUE;
+
+}   /* load_cached_schema */
+
+
+/********************************************************************
+ * FUNCTION save_cached_schema
+ * 
+ * Save a module retrieved with <get-schema> in the schema cache
+ * The file is written under a temp name and renamed so other
+ * yangcli-pro instances never see a partial file
+ *
+ * Only called after the module has been loaded, so a bad
+ * <get-schema> reply is never saved
+ *
+ * INPUTS:
+ *   searchresult == search result for the module
+ *   source == session work directory file to save
+ *********************************************************************/
+static void
+    save_cached_schema (const ncxmod_search_result_t *searchresult,
+                        const xmlChar *source)
+{
+    xmlChar *cachefile = make_cache_filespec(searchresult->module,
+                                             searchresult->revision,
+                                             TRUE);
+    if (cachefile == NULL) {
+        return;
+    }
+
+    uint32 len = xml_strlen(cachefile) + 16;
+    xmlChar *tempfile = m__getMem(len);
+    if (tempfile == NULL) {
+        m__free(cachefile);
+        return;
+    }
+    snprintf((char *)tempfile, len, "%s.%u", (const char *)cachefile,
+             (uint32)getpid());
+
+    status_t res = copy_file(source, tempfile);
+    if (res == NO_ERR &&
+        rename((const char *)tempfile, (const char *)cachefile) != 0) {
+        res = errno_to_status();
+    }
+    if (res != NO_ERR) {
+        log_debug("\nautoload: save to schema cache '%s' failed (%s)",
+                  cachefile, get_error_string(res));
+        (void)unlink((const char *)tempfile);
+    }
+
+    m__free(tempfile);
+    m__free(cachefile);
+
+}   /* save_cached_schema */
+
+
+/********************************************************************
+ * FUNCTION remove_cached_schema
+ * 
+ * Remove a schema cache file that could not be loaded,
+ * so the module is retrieved with <get-schema> next time
+ *
+ * INPUTS:
+ *   searchresult == search result for the module
+ *********************************************************************/
+static void
+    remove_cached_schema (ncxmod_search_result_t *searchresult)
+{
+    if (!searchresult->fromcache || searchresult->source == NULL) {
+        return;
+    }
+
+    if (unlink((const char *)searchresult->source) != 0) {
+        log_debug("\nautoload: remove schema cache file '%s' failed",
+                  searchresult->source);
+    } else if (LOGINFO) {
+        log_info("\nautoload: removed schema cache file '%s'",
+                 searchresult->source);
+    }
+    searchresult->fromcache = FALSE;
+
+}   /* remove_cached_schema */
+
+
+/********************************************************************
+ * FUNCTION update_schema_cache
+ * 
+ * Update the schema cache after a module has been loaded
+ * A module retrieved with <get-schema> is saved if it was
+ * loaded with the expected name and revision.  A cache file
+ * that did not load that module is removed.
+ *
+ * INPUTS:
+ *   searchresult == search result for the module
+ *   mod == module that was loaded; NULL if the load failed
+ *********************************************************************/
+static void
+    update_schema_cache (ncxmod_search_result_t *searchresult,
+                         const ncx_module_t *mod)
+{
+    boolean ok = FALSE;
+
+    if (mod != NULL && searchresult->revision != NULL &&
+        !xml_strcmp(mod->name, searchresult->module)) {
+        const xmlChar *version = ncx_get_modversion(mod);
+        ok = (version != NULL &&
+              !xml_strcmp(version, searchresult->revision));
+    }
+
+    if (ok) {
+        if (searchresult->fromserver) {
+            save_cached_schema(searchresult, searchresult->source);
+        }
+    } else {
+        remove_cached_schema(searchresult);
+    }
+
+}   /* update_schema_cache */
+
+
+
 /********************************************************************
 * FUNCTION set_temp_ync_features
 * 
@@ -750,6 +1041,257 @@ static void
 }  /* add_modptr */
 
 
+/********************************************************************
+* FUNCTION need_get_schema
+* 
+* Check if a search result is for a module that still
+* needs to be retrieved with <get-schema>
+*
+* INPUTS:
+*   searchresult == search result to check
+*
+* RETURNS:
+*   TRUE if module not found or wrong version found
+*********************************************************************/
+static boolean
+    need_get_schema (const ncxmod_search_result_t *searchresult)
+{
+    /* skip found entries */
+    if (searchresult->source != NULL) {
+        return FALSE;
+    }
+
+    /* skip found modules with errors */          
+    return (searchresult->res == ERR_NCX_WRONG_VERSION ||
+            searchresult->res == ERR_NCX_MOD_NOT_FOUND) ? TRUE : FALSE;
+
+}  /* need_get_schema */
+
+
+/********************************************************************
+* FUNCTION send_get_schema_requests
+* 
+* Fill the <get-schema> request window
+*
+* Continue after the last search result that was started
+* and send a request for each module that needs to be retrieved,
+* until YANGCLI_AUTOLOAD_PIPELINE requests are outstanding.
+* Modules found in the schema cache are copied to the session
+* work directory instead of being retrieved
+*
+* INPUTS:
+*   session_cb == session control block to use
+*   mscb == manager session control block to use
+*
+* OUTPUTS:
+*   session_cb->autoload_pending and session_cb->cursearchresult
+*   updated; command_mode set to CMD_MODE_AUTOLOAD if any
+*   request was sent
+*
+* RETURNS:
+*    status
+*********************************************************************/
+static status_t
+    send_get_schema_requests (session_cb_t *session_cb,
+                              mgr_scb_t *mscb)
+{
+    ncxmod_search_result_t  *searchresult;
+    status_t                 res = NO_ERR;
+
+    if (session_cb->cursearchresult) {
+        searchresult = (ncxmod_search_result_t *)
+            dlq_nextEntry(session_cb->cursearchresult);
+    } else {
+        searchresult = (ncxmod_search_result_t *)
+            dlq_firstEntry(&session_cb->searchresultQ);
+    }
+
+    for (; searchresult != NULL && res == NO_ERR &&
+             session_cb->autoload_pending < YANGCLI_AUTOLOAD_PIPELINE;
+         searchresult = (ncxmod_search_result_t *)
+             dlq_nextEntry(searchresult)) {
+
+        if (!need_get_schema(searchresult)) {
+            continue;
+        }
+
+        /* found an entry that needs to be retrieved
+         * either module not found or wrong version found
+         */
+        session_cb->cursearchresult = searchresult;
+
+        if (load_cached_schema(mscb, searchresult)) {
+            continue;
+        }
+
+        res = send_get_schema_to_server(session_cb, searchresult->module,
+                                        searchresult->revision);
+        if (res == NO_ERR) {
+            session_cb->autoload_pending++;
+            session_cb->command_mode = CMD_MODE_AUTOLOAD;
+        }
+    }
+
+    return res;
+
+}  /* send_get_schema_requests */
+
+
+/********************************************************************
+* FUNCTION find_get_schema_result
+* 
+* Find the search result for a <get-schema> request
+* The replies can arrive in any order so the module
+* and revision parameters in the request are used
+*
+* INPUTS:
+*   session_cb == session control block to use
+*   req == <get-schema> request that was answered
+*
+* RETURNS:
+*   pointer to search result; NULL if not found
+*********************************************************************/
+static ncxmod_search_result_t *
+    find_get_schema_result (session_cb_t *session_cb,
+                            mgr_rpc_req_t *req)
+{
+    if (req == NULL || req->data == NULL) {
+        return NULL;
+    }
+
+    val_value_t *identifier = val_find_child(req->data, NULL,
+                                             NCX_EL_IDENTIFIER);
+    val_value_t *version = val_find_child(req->data, NULL,
+                                          NCX_EL_VERSION);
+    if (identifier == NULL || !typ_is_string(identifier->btyp)) {
+        return NULL;
+    }
+
+    const xmlChar *revision = NULL;
+    if (version != NULL && typ_is_string(version->btyp) &&
+        VAL_STR(version) != NULL && *VAL_STR(version)) {
+        revision = VAL_STR(version);
+    }
+
+    ncxmod_search_result_t  *searchresult;
+    for (searchresult = (ncxmod_search_result_t *)
+             dlq_firstEntry(&session_cb->searchresultQ);
+         searchresult != NULL;
+         searchresult = (ncxmod_search_result_t *)
+             dlq_nextEntry(searchresult)) {
+
+        if (!need_get_schema(searchresult)) {
+            continue;
+        }
+        if (xml_strcmp(searchresult->module, VAL_STR(identifier))) {
+            continue;
+        }
+        if (revision == NULL || searchresult->revision == NULL) {
+            if (revision == searchresult->revision) {
+                return searchresult;
+            }
+        } else if (!xml_strcmp(searchresult->revision, revision)) {
+            return searchresult;
+        }
+
+        if (searchresult == session_cb->cursearchresult) {
+            /* no request sent for any entry past this one */
+            break;
+        }
+    }
+
+    return NULL;
+
+}  /* find_get_schema_result */
+
+
+/********************************************************************
+* FUNCTION compare_capstrings
+* 
+* qsort compare function for capability URI strings
+*
+* INPUTS:
+*   a, b == pointers to the xmlChar * entries to compare
+*
+* RETURNS:
+*   compare result
+*********************************************************************/
+static int
+    compare_capstrings (const void *a,
+                        const void *b)
+{
+    return xml_strcmp(*(const xmlChar * const *)a,
+                      *(const xmlChar * const *)b);
+
+}  /* compare_capstrings */
+
+
+/********************************************************************
+* FUNCTION make_capkey
+* 
+* Make the key used to share the compiled modules with other
+* sessions.  Two sessions get the same key if the servers
+* sent the same capabilities (in any order), which includes
+* the module revisions, features and deviations
+*
+* INPUTS:
+*   session_cb == session control block to use
+*   mscb == manager session control block to use
+*
+* RETURNS:
+*   malloced key string; NULL if malloc failed
+*********************************************************************/
+static xmlChar *
+    make_capkey (session_cb_t *session_cb,
+                 mgr_scb_t *mscb)
+{
+    const cap_rec_t  *cap;
+    const xmlChar   **caparray;
+    xmlChar          *key, *p;
+    uint32            capcount, len, i;
+    char              numbuff[NCX_MAX_NUMLEN+16];
+
+    capcount = dlq_count(&mscb->caplist.capQ);
+    snprintf(numbuff, sizeof(numbuff), "%u:%u\n",
+             (uint32)session_cb->autoload,
+             mscb->caplist.cap_std);
+    len = xml_strlen((const xmlChar *)numbuff) + 1;
+
+    caparray = m__getMem((capcount + 1) * sizeof(const xmlChar *));
+    if (caparray == NULL) {
+        return NULL;
+    }
+
+    i = 0;
+    for (cap = (const cap_rec_t *)dlq_firstEntry(&mscb->caplist.capQ);
+         cap != NULL && i < capcount;
+         cap = (const cap_rec_t *)dlq_nextEntry(cap)) {
+        if (cap->cap_uri) {
+            caparray[i++] = cap->cap_uri;
+            len += xml_strlen(cap->cap_uri) + 1;
+        }
+    }
+    capcount = i;
+
+    qsort(caparray, capcount, sizeof(const xmlChar *), compare_capstrings);
+
+    key = m__getMem(len);
+    if (key != NULL) {
+        p = key;
+        p += xml_strcpy(p, (const xmlChar *)numbuff);
+        for (i = 0; i < capcount; i++) {
+            p += xml_strcpy(p, caparray[i]);
+            *p++ = '\n';
+        }
+        *p = 0;
+    }
+
+    m__free(caparray);
+    return key;
+
+}  /* make_capkey */
+
+
 /**************    E X T E R N A L   F U N C T I O N S **********/
 
 
@@ -936,43 +1478,17 @@ status_t
 {
     assert(session_cb && "session_cb is NULL!");
 
-    status_t res = NO_ERR;
-    boolean done = FALSE;
-
-    /* find first file that needs to be retrieved with get-schema */
-    ncxmod_search_result_t  *searchresult;
-    for (searchresult = (ncxmod_search_result_t *)
-             dlq_firstEntry(&session_cb->searchresultQ);
-         searchresult != NULL && !done;
-         searchresult = (ncxmod_search_result_t *)
-             dlq_nextEntry(searchresult)) {
-
-        /* skip found entries */
-        if (searchresult->source != NULL) {
-            continue;
-        }
-
-        /* skip found modules with errors */          
-        if (!(searchresult->res == ERR_NCX_WRONG_VERSION ||
-              searchresult->res == ERR_NCX_MOD_NOT_FOUND)) {
-            continue;
-        }
-
-        /* found an entry that needs to be retrieved
-         * either module not found or wrong version found
-         */
-        done = TRUE;
-
-        res = send_get_schema_to_server(session_cb, searchresult->module,
-                                        searchresult->revision);
-        if (res == NO_ERR) {
-            session_cb->command_mode = CMD_MODE_AUTOLOAD;
-            session_cb->cursearchresult = searchresult;
-        }
-        /* exit loop if we get here */
+    ses_cb_t *scb = mgr_ses_get_scb(session_cb->mysid);
+    if (scb == NULL) {
+        return SET_ERROR(ERR_INTERNAL_VAL);
     }
+    mgr_scb_t *mscb = mgr_ses_get_mscb(scb);
 
-    return res;
+    /* start the first window of <get-schema> requests */
+    session_cb->autoload_pending = 0;
+    session_cb->cursearchresult = NULL;
+
+    return send_get_schema_requests(session_cb, mscb);
 
 }  /* autoload_start_get_modules */
 
@@ -986,6 +1502,7 @@ status_t
 *   server_cb == server session control block to use
 *   session_cb == session control block to use
 *   scb == session control block to use
+*   req == <get-schema> request for this reply
 *   reply == data node from the <rpc-reply> PDU
 *   anyerrors == TRUE if <rpc-error> detected instead
 *                of <data>
@@ -996,8 +1513,10 @@ status_t
 *   the the specified YANG files that was retrieved from
 *   the device with <get-schema>
 *
-*   Next request is started, or autoload process is completed
-*   and the command_mode is changed back to CMD_MODE_NORMAL
+*   More requests are started if any are left, or the
+*   autoload process is completed when no replies are
+*   outstanding and the command_mode is changed back
+*   to CMD_MODE_NORMAL
 *
 * RETURNS:
 *    status
@@ -1006,6 +1525,7 @@ status_t
     autoload_handle_rpc_reply (server_cb_t *server_cb,
                                session_cb_t *session_cb,
                                ses_cb_t *scb,
+                               mgr_rpc_req_t *req,
                                val_value_t *reply,
                                boolean anyerrors)
 {
@@ -1013,14 +1533,22 @@ status_t
     assert(scb && "scb is NULL!");
     assert(reply && "reply is NULL!");
 
-    boolean done = FALSE;
     status_t res = NO_ERR;
     mgr_scb_t *mscb = (mgr_scb_t *)scb->mgrcb;
-    ncxmod_search_result_t *searchresult = session_cb->cursearchresult;
-    const xmlChar *module = searchresult->module;
-    const xmlChar *revision = searchresult->revision;
 
-    if (anyerrors) {
+    if (session_cb->autoload_pending > 0) {
+        session_cb->autoload_pending--;
+    }
+
+    ncxmod_search_result_t *searchresult =
+        find_get_schema_result(session_cb, req);
+
+    if (searchresult == NULL) {
+        log_error("\nError: <get-schema> reply for unknown module");
+    } else if (anyerrors) {
+        const xmlChar *module = searchresult->module;
+        const xmlChar *revision = searchresult->revision;
+
         /* going to skip this module any try to
          * compile without it
          */
@@ -1037,6 +1565,9 @@ status_t
             }
         }
     } else {
+        const xmlChar *module = searchresult->module;
+        const xmlChar *revision = searchresult->revision;
+
         /* get the data node out of the reply;
          * it contains the requested YANG module
          * in raw text form
@@ -1056,8 +1587,12 @@ status_t
                 /* copy the value node to the work directory
                  * as a YANG file
                  */
-                res = save_schema_file(session_cb, module, revision,
-                                       temp_filcb->source, dataval);
+                res = save_schema_file(searchresult, temp_filcb->source,
+                                       dataval);
+                if (res == NO_ERR) {
+                    /* saved in the schema cache after it is loaded */
+                    searchresult->fromserver = TRUE;
+                }
             }
         }
 
@@ -1067,45 +1602,73 @@ status_t
                       module,
                       (revision) ? revision : EMPTY_STRING,
                       get_error_string(res));
-            session_cb->cursearchresult->res = res;
+            searchresult->res = res;
         }
     }
 
-    /* find next file that needs to be retrieved with get-schema */
-    for (searchresult = (ncxmod_search_result_t *)
-             dlq_nextEntry(session_cb->cursearchresult);
-         searchresult != NULL && !done;
-         searchresult = (ncxmod_search_result_t *)
-             dlq_nextEntry(searchresult)) {
+    /* keep the request window full */
+    res = send_get_schema_requests(session_cb, mscb);
+    if (res != NO_ERR) {
+        log_error("\nError: autoload get modules failed (%s)\n",
+                  get_error_string(res));
+    }
 
-        /* skip found entries */
-        if (searchresult->source != NULL) {
-            continue;
-        }
+    if (session_cb->autoload_pending > 0) {
+        /* more replies to wait for */
+        session_cb->state = MGR_IO_ST_CONN_RPYWAIT;
+        return res;
+    }
 
-        /* skip found modules with errors */          
-        if (!(searchresult->res == ERR_NCX_WRONG_VERSION ||
-              searchresult->res == ERR_NCX_MOD_NOT_FOUND)) {
-            continue;
-        }
+    /* no search results left to get */
+    return autoload_compile_modules(server_cb, session_cb, scb);
 
-        /* found an entry that needs to be retrieved */
-        session_cb->command_mode = CMD_MODE_AUTOLOAD;
-        session_cb->cursearchresult = searchresult;
-        done = TRUE;
+}  /* autoload_handle_rpc_reply */
 
-        res = send_get_schema_to_server(session_cb, searchresult->module,
-                                       searchresult->revision);
+
+/********************************************************************
+* FUNCTION autoload_attach_modules
+* 
+* Check if the modules for this session were already compiled
+* for another session to a server with the same capabilities
+* and use that module set if so
+*
+* INPUTS:
+*   session_cb == session control block to use
+*   scb == session control block to use
+*
+* OUTPUTS:
+*   mscb->modset set if a module set was found
+*
+* RETURNS:
+*    TRUE if the session is using a shared module set;
+*    autoload_compile_modules still needs to be called
+*    FALSE if the modules need to be loaded for this session
+*********************************************************************/
+boolean
+    autoload_attach_modules (session_cb_t *session_cb,
+                             ses_cb_t *scb)
+{
+    assert(session_cb && "session_cb is NULL!");
+    assert(scb && "scb is NULL!");
+
+    mgr_scb_t *mscb = (mgr_scb_t *)scb->mgrcb;
+
+    xmlChar *capkey = make_capkey(session_cb, mscb);
+    if (capkey == NULL) {
+        return FALSE;
     }
 
-    if (!done) {
-        /* no search results left to get */
-        return autoload_compile_modules(server_cb, session_cb, scb);
+    boolean retval = mgr_attach_modset(mscb, capkey);
+    m__free(capkey);
+
+    if (retval && LOGDEBUG) {
+        log_debug("\nautoload: using modules compiled for a previous "
+                  "session with the same capabilities");
     }
 
-    return res;
+    return retval;
 
-}  /* autoload_handle_rpc_reply */
+}  /* autoload_attach_modules */
 
 
 /********************************************************************
@@ -1159,6 +1722,18 @@ status_t
     ncx_module_t *ncmod = NULL;
     status_t res = NO_ERR;
     mgr_scb_t *mscb = (mgr_scb_t *)scb->mgrcb;
+    dlq_hdr_t *modQ = mgr_get_modQ(mscb);
+    boolean shared = (mscb->modset != NULL) ? TRUE : FALSE;
+    boolean incomplete = FALSE;
+
+    /* a timeout can leave <get-schema> requests outstanding */
+    while (session_cb->autoload_pending > 0 && !dlq_empty(&mscb->reqQ)) {
+        mgr_rpc_req_t *req = (mgr_rpc_req_t *)dlq_firstEntry(&mscb->reqQ);
+        mgr_rpc_remove_request(scb, req);
+        mgr_rpc_free_request(req);
+        session_cb->autoload_pending--;
+    }
+    session_cb->autoload_pending = 0;
 
     /* set the alternate path to point at the
      * session work directory; this will cause
@@ -1175,19 +1750,26 @@ status_t
      * modules from getting picked from outside the
      * temp dir for this session
      */
-    ncx_set_temp_modQ(&mscb->temp_modQ);
-    ncx_set_session_modQ(&mscb->temp_modQ);
-    ncx_set_cur_modQ(&mscb->temp_modQ);
-
-    /* !!! temp until the ietf-netconf.yang module
-     * is fully supported.  The yuma-netconf.yang
-     * module is pre-loaded as the first module
-     * Force this to be first so any import of ietf-netconf
-     * found will get converted to this module instead
-     */
-    res = autoload_module(&mscb->temp_modQ, 
-                          &session_cb->deviationQ,
-                          NCXMOD_YUMA_NETCONF, NULL, &ncmod);
+    ncx_set_temp_modQ(modQ);
+    ncx_set_session_modQ(modQ);
+    ncx_set_cur_modQ(modQ);
+
+    if (shared) {
+        /* the modules were compiled by another session to a
+         * server with the same capabilities; just find them
+         */
+        ncmod = ncx_find_module_que(modQ, NCXMOD_YUMA_NETCONF, NULL);
+    } else {
+        /* !!! temp until the ietf-netconf.yang module
+         * is fully supported.  The yuma-netconf.yang
+         * module is pre-loaded as the first module
+         * Force this to be first so any import of ietf-netconf
+         * found will get converted to this module instead
+         */
+        res = autoload_module(modQ, 
+                              &session_cb->deviationQ,
+                              NCXMOD_YUMA_NETCONF, NULL, &ncmod);
+    }
     if (res == NO_ERR && ncmod != NULL) {
         /* Set the features in yuma-netconf.yang according
          * to the standard capabilities that were announced
@@ -1209,7 +1791,7 @@ status_t
      * case an import module has deviations;
      * done to make sure modules are only parsed once
      */
-    if (res == NO_ERR) {
+    if (res == NO_ERR && !shared) {
         searchresult = (ncxmod_search_result_t *)
             dlq_firstEntry(&session_cb->searchresultQ);
         for (; searchresult != NULL;
@@ -1217,7 +1799,7 @@ status_t
                  dlq_nextEntry(searchresult)) {
 
             if (searchresult->res == NO_ERR) {
-                autoload_deviation(&mscb->temp_modQ,
+                autoload_deviation(modQ,
                                    &session_cb->deviationQ,
                                    &searchresult->cap->cap_deviation_list);
             }
@@ -1239,12 +1821,16 @@ status_t
 
         if (searchresult->res != NO_ERR ||
             searchresult->source == NULL) {
+            if (searchresult->source == NULL) {
+                /* module could not be found or retrieved */
+                incomplete = TRUE;
+            }
             ncxmod_free_search_result(searchresult);
             continue;
         }
 
         ncx_module_t *testmod =  
-            ncx_find_module_que(&mscb->temp_modQ,
+            ncx_find_module_que(modQ,
                                 searchresult->module,
                                 searchresult->revision);
 
@@ -1256,9 +1842,10 @@ status_t
                       searchresult->revision : NCX_EL_NONE);
 
             add_modptr(session_cb, searchresult, testmod);
+            update_schema_cache(searchresult, testmod);
         } else {
             mod = NULL;
-            res = autoload_module(&mscb->temp_modQ,
+            res = autoload_module(modQ,
                                   &session_cb->deviationQ,
                                   searchresult->module,
                                   searchresult->revision,
@@ -1266,11 +1853,30 @@ status_t
             if (res == NO_ERR && mod) {
                 add_modptr(session_cb, searchresult, mod);
             }
+            update_schema_cache(searchresult, (res == NO_ERR) ? mod : NULL);
         }
 
         ncxmod_free_search_result(searchresult);
     }
 
+    /* the load may have failed in a cached import module;
+     * remove the cache files for the modules that were not
+     * loaded, so a bad file does not break the next session
+     */
+    if (res != NO_ERR) {
+        searchresult = (ncxmod_search_result_t *)
+            dlq_firstEntry(&session_cb->searchresultQ);
+        for (; searchresult != NULL;
+             searchresult = (ncxmod_search_result_t *)
+                 dlq_nextEntry(searchresult)) {
+            if (searchresult->fromcache &&
+                ncx_find_module_que(modQ, searchresult->module,
+                                    searchresult->revision) == NULL) {
+                remove_cached_schema(searchresult);
+            }
+        }
+    }
+
     /* undo the temporary MODPATH setting */
     ncxmod_clear_altpath();
 
@@ -1309,9 +1915,24 @@ status_t
     session_cb->command_mode = CMD_MODE_NORMAL;
     session_cb->cursearchresult = NULL;
 
+    /* let other sessions to servers with the same capabilities
+     * use these modules, if they were all loaded
+     */
+    if (res == NO_ERR && !shared && !incomplete) {
+        xmlChar *capkey = make_capkey(session_cb, mscb);
+        if (capkey != NULL) {
+            status_t res2 = mgr_share_modQ(mscb, capkey);
+            if (res2 != NO_ERR) {
+                log_debug("\nautoload: module set not shared (%s)",
+                          get_error_string(res2));
+            }
+            m__free(capkey);
+        }
+    }
+
     if (LOGDEBUG3) {
         log_debug3("\nautoload module list:\n");
-        dump_modQ(&mscb->temp_modQ);
+        dump_modQ(mgr_get_modQ(mscb));
     }
 
     return res;
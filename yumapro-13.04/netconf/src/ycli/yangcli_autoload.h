@@ -35,6 +35,10 @@ date	     init     comment
 
 #include <xmlstring.h>
 
+#ifndef _H_mgr_rpc
+#include "mgr_rpc.h"
+#endif
+
 #ifndef _H_ses
 #include "ses.h"
 #endif
@@ -123,6 +127,7 @@ extern status_t
 *   server_cb == server control block to use
 *   session_cb == session control block to use
 *   scb == session control block to use
+*   req == <get-schema> request for this reply
 *   reply == data node from the <rpc-reply> PDU
 *   anyerrors == TRUE if <rpc-error> detected instead
 *                of <data>
@@ -133,8 +138,10 @@ extern status_t
 *   the the specified YANG files that was retrieved from
 *   the device with <get-schema>
 *
-*   Next request is started, or autoload process is completed
-*   and the command_mode is changed back to CMD_MODE_NORMAL
+*   More requests are started if any are left, or the
+*   autoload process is completed when no replies are
+*   outstanding and the command_mode is changed back
+*   to CMD_MODE_NORMAL
 *
 * RETURNS:
 *    status
@@ -143,10 +150,35 @@ extern status_t
     autoload_handle_rpc_reply (server_cb_t *server_cb,
                                session_cb_t *session_cb,
                                ses_cb_t *scb,
+                               mgr_rpc_req_t *req,
                                val_value_t *reply,
                                boolean anyerrors);
 
 
+/********************************************************************
+* FUNCTION autoload_attach_modules
+* 
+* Check if the modules for this session were already compiled
+* for another session to a server with the same capabilities
+* and use that module set if so
+*
+* INPUTS:
+*   session_cb == session control block to use
+*   scb == session control block to use
+*
+* OUTPUTS:
+*   mscb->modset set if a module set was found
+*
+* RETURNS:
+*    TRUE if the session is using a shared module set;
+*    autoload_compile_modules still needs to be called
+*    FALSE if the modules need to be loaded for this session
+*********************************************************************/
+extern boolean
+    autoload_attach_modules (session_cb_t *session_cb,
+                             ses_cb_t *scb);
+
+
 /********************************************************************
 * FUNCTION autoload_compile_modules
 * 
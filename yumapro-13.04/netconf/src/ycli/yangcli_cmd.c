@@ -87,6 +87,8 @@ date         init     comment
 #include "yangcli_config.h"
 #include "yangcli_cmd.h"
 #include "yangcli_eval.h"
+#include "yangcli_fanout.h"
+#include "yangcli_replay.h"
 #include "yangcli_list.h"
 #include "yangcli_save.h"
 #include "yangcli_sessions.h"
@@ -3920,6 +3922,7 @@ static status_t
             req->data = reqdata;
             req->rpc = rpc;
             req->timeout = timeoutval;
+            setup_stream_reply(server_cb, session_cb, req);
         }
     }
         
@@ -6542,6 +6545,10 @@ static status_t
         if (cond) {
             res = do_eventlog(server_cb, rpc, line, len);
         }
+    } else if (!xml_strcmp(rpcname, YANGCLI_FANOUT)) {
+        if (cond) {
+            res = do_fanout(server_cb, rpc, line, len);
+        }
     } else if (!xml_strcmp(rpcname, YANGCLI_FILL)) {
         if (cond) {
             res = do_fill(server_cb, rpc, line, len, TRUE);
@@ -6594,6 +6601,10 @@ static status_t
         if (cond) {
             res = do_recall(server_cb, rpc, line, len);
         }
+    } else if (!xml_strcmp(rpcname, YANGCLI_REPLAY)) {
+        if (cond) {
+            res = do_replay(server_cb, rpc, line, len);
+        }
     } else if (!xml_strcmp(rpcname, YANGCLI_RUN)) {
         if (cond) {
             res = do_run(server_cb, rpc, line, len);
@@ -6610,6 +6621,10 @@ static status_t
         if (cond) {
             res = do_session_cfg(server_cb, rpc, line, len);
         }
+    } else if (!xml_strcmp(rpcname, YANGCLI_SESSION_GROUP)) {
+        if (cond) {
+            res = do_session_group(server_cb, rpc, line, len);
+        }
      } else if (!xml_strcmp(rpcname, YANGCLI_RECORD_TEST)) {
         if (cond) {
             res = do_record_test(server_cb, rpc, line, len);
@@ -7031,6 +7046,7 @@ status_t
                 req->data = reqdata;
                 req->rpc = rpc;
                 req->timeout = session_cb->timeout;
+                setup_stream_reply(server_cb, session_cb, req);
             }
         }
         
@@ -7957,6 +7973,47 @@ status_t
 } /* send_keepalive_get */
 
 
+/********************************************************************
+* FUNCTION send_xpath_get_to_server
+* 
+* Send a <get> operation with an XPath filter to the
+* current session; the reply is handled like an xget command
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    selectstr == XPath select string for the filter
+*
+* OUTPUTS:
+*    state may be changed or other action taken
+*
+* RETURNS:
+*    status
+*********************************************************************/
+status_t
+    send_xpath_get_to_server (server_cb_t *server_cb,
+                              const xmlChar *selectstr)
+{
+    session_cb_t *session_cb = server_cb->cur_session_cb;
+    val_value_t  *selectval;
+
+    if (session_cb->state != MGR_IO_ST_CONN_IDLE) {
+        log_error("\nError: no active session");
+        return ERR_NCX_OPERATION_FAILED;
+    }
+
+    selectval = val_make_string(0, NCX_EL_SELECT, selectstr);
+    if (!selectval) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    /* !! selectval is consumed by send_get_to_server !! */
+    return send_get_to_server(server_cb, NULL, NULL, selectval, NULL,
+                              session_cb->timeout, FALSE,
+                              session_cb->withdefaults);
+
+} /* send_xpath_get_to_server */
+
+
 /********************************************************************
  * FUNCTION get_valset
  * 
@@ -284,6 +284,27 @@ extern status_t
     send_keepalive_get (server_cb_t *server_cb);
 
 
+/********************************************************************
+* FUNCTION send_xpath_get_to_server
+* 
+* Send a <get> operation with an XPath filter to the
+* current session; the reply is handled like an xget command
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    selectstr == XPath select string for the filter
+*
+* OUTPUTS:
+*    state may be changed or other action taken
+*
+* RETURNS:
+*    status
+*********************************************************************/
+extern status_t
+    send_xpath_get_to_server (server_cb_t *server_cb,
+                              const xmlChar *selectstr);
+
+
 /********************************************************************
  * FUNCTION get_valset
  * 
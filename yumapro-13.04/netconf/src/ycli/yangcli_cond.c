@@ -161,13 +161,14 @@ static status_t
     xpath_pcb_t        *pcb;
     xpath_result_t     *result;
     status_t            res;
-    boolean             cond;
+    boolean             cond, savedpcb;
 
     docroot = NULL;
     expr = NULL;
     pcb = NULL;
     dummydoc = NULL;
     cond = FALSE;
+    savedpcb = FALSE;
     res = NO_ERR;
 
     valset = get_valset(server_cb, rpc, &line[len], &res);
@@ -214,10 +215,23 @@ static status_t
     }
 
     if (res == NO_ERR) {
-        /* got all the parameters, and setup the XPath control block */
-        pcb = xpath_new_pcb_ex(VAL_STR(expr), 
-                               xpath_getvar_fn,
-                               server_cb->runstack_context);
+        /* got all the parameters, and setup the XPath control block
+         * inside a loop the block saved on the last pass is reused
+         */
+        pcb = runstack_get_loop_xpath(server_cb->runstack_context,
+                                      VAL_STR(expr));
+        if (pcb == NULL) {
+            pcb = xpath_new_pcb_ex(VAL_STR(expr), 
+                                   xpath_getvar_fn,
+                                   server_cb->runstack_context);
+            if (pcb != NULL &&
+                runstack_save_loop_xpath(server_cb->runstack_context,
+                                         VAL_STR(expr), pcb)) {
+                savedpcb = TRUE;
+            }
+        } else {
+            savedpcb = TRUE;
+        }
         if (pcb == NULL) {
             res = ERR_INTERNAL_MEM;
         } else if ((isif && 
@@ -252,7 +266,7 @@ static status_t
     if (valset) {
         val_free_value(valset);
     }
-    if (pcb) {
+    if (pcb && !savedpcb) {
         xpath_free_pcb(pcb);
     }
     if (dummydoc) {
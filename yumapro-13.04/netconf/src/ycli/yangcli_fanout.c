@@ -0,0 +1,1244 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: yangcli_fanout.c
+
+   NETCONF YANG-based CLI Tool
+
+   fanout command
+
+   session-group command
+
+   A fanout job sends each command line to every session in
+   a session group.  The line is parsed with conn_command while
+   the member session is made the current session, so the
+   request is built with the schema of that server.  The new
+   request is then taken over by the fanout reply handler and
+   tagged with the member index in the group_id field.
+
+   The number of requests outstanding is capped for the whole
+   group (max-in-flight) and for each session (pipeline).
+   The members are served round-robin, so one slow session
+   cannot hold back the rest of the group.
+
+   While the job is active the STDIN handler returns a wait
+   state, so mgr_io blocks until replies arrive, and calls
+   yangcli_fanout_check to expire and send requests.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "procdefs.h"
+#include "dlq.h"
+#include "log.h"
+#include "mgr.h"
+#include "mgr_rpc.h"
+#include "mgr_ses.h"
+#include "ncx.h"
+#include "ncxconst.h"
+#include "ncxmod.h"
+#include "obj.h"
+#include "status.h"
+#include "val.h"
+#include "xml_util.h"
+#include "yangcli.h"
+#include "yangcli_cmd.h"
+#include "yangcli_fanout.h"
+#include "yangcli_util.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+/* width of the session name column in the report */
+#define FANOUT_NAME_WIDTH   20
+
+
+/********************************************************************
+*                                                                   *
+*                           T Y P E S                               *
+*                                                                   *
+*********************************************************************/
+
+/* one session in a fanout job */
+typedef struct fanout_member_t_ {
+    const xmlChar   *name;          /* backptr into job sessions */
+    session_cb_t    *session_cb;    /* backptr; NULL if not found */
+    ses_id_t         sid;
+    rawline_t       *nextline;      /* backptr into lineQ */
+    status_t         res;           /* set if the session stopped */
+    uint32           sent;
+    uint32           outstanding;
+    uint32           ok;
+    uint32           errors;
+    uint32           failed;
+    uint64           total_usec;
+    uint64           max_usec;
+    xmlChar         *errtag;        /* malloced first error-tag */
+} fanout_member_t;
+
+
+/* fanout job control block */
+typedef struct fanout_cb_t_ {
+    xmlChar         *group;         /* malloced group name */
+    xmlChar         *source;        /* malloced command or script */
+    xmlChar         *sessions;      /* malloced session names */
+    dlq_hdr_t        lineQ;         /* Q of rawline_t */
+    fanout_member_t *members;       /* malloced array */
+    uint32           member_count;
+    uint32           next_member;
+    uint32           max_in_flight;
+    uint32           pipeline;
+    uint32           in_flight;
+    struct timeval   start_time;
+    time_t           last_check;
+} fanout_cb_t;
+
+
+/********************************************************************
+ * FUNCTION free_session_group
+ *
+ * Free a session group
+ *
+ * INPUTS:
+ *    group == session group to free; must be removed from any Q
+ *********************************************************************/
+static void
+    free_session_group (session_group_t *group)
+{
+    m__free(group->name);
+    m__free(group->sessions);
+    m__free(group);
+
+}  /* free_session_group */
+
+
+/********************************************************************
+ * FUNCTION free_fanout_cb
+ *
+ * Free a fanout job
+ *
+ * INPUTS:
+ *    job == fanout job to free
+ *********************************************************************/
+static void
+    free_fanout_cb (fanout_cb_t *job)
+{
+    uint32 i;
+
+    if (job->members) {
+        for (i = 0; i < job->member_count; i++) {
+            m__free(job->members[i].errtag);
+        }
+        m__free(job->members);
+    }
+
+    while (!dlq_empty(&job->lineQ)) {
+        rawline_t *rawline = (rawline_t *)dlq_deque(&job->lineQ);
+        free_rawline(rawline);
+    }
+
+    m__free(job->group);
+    m__free(job->source);
+    m__free(job->sessions);
+    m__free(job);
+
+}  /* free_fanout_cb */
+
+
+/********************************************************************
+ * FUNCTION elapsed_usec
+ *
+ * Get the microseconds since a start time
+ *
+ * INPUTS:
+ *    start == start time
+ *
+ * RETURNS:
+ *   elapsed microseconds; 0 if the clock went backwards
+ *********************************************************************/
+static uint64
+    elapsed_usec (const struct timeval *start)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    int64 usec = (int64)(now.tv_sec - start->tv_sec) * 1000000 +
+        (int64)(now.tv_usec - start->tv_usec);
+    return (usec > 0) ? (uint64)usec : 0;
+
+}  /* elapsed_usec */
+
+
+/********************************************************************
+ * FUNCTION get_line_command
+ *
+ * Get the command name at the start of a command line
+ *
+ * INPUTS:
+ *    line == command line to check
+ *    cmdname == buffer of NCX_MAX_NLEN+1 bytes to use
+ *
+ * OUTPUTS:
+ *    cmdname is filled in with the first word of the line
+ *
+ * RETURNS:
+ *   back-pointer into cmdname to the name without a module prefix
+ *********************************************************************/
+static const xmlChar *
+    get_line_command (const xmlChar *line,
+                      xmlChar *cmdname)
+{
+    const xmlChar *str = line;
+    uint32 len = 0;
+
+    while (*str && !xml_isspace(*str) && len < NCX_MAX_NLEN) {
+        cmdname[len++] = *str++;
+    }
+    cmdname[len] = 0;
+
+    /* skip any module prefix */
+    const xmlChar *colon = (const xmlChar *)
+        strchr((const char *)cmdname, ':');
+    return (colon) ? colon + 1 : cmdname;
+
+}  /* get_line_command */
+
+
+/********************************************************************
+ * FUNCTION check_fanout_line
+ *
+ * Check that a command line can be used in a fanout job
+ *
+ * INPUTS:
+ *    line == command line to check
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    check_fanout_line (const xmlChar *line)
+{
+    if (yangcli_fanout_line_allowed(line)) {
+        return NO_ERR;
+    }
+
+    xmlChar cmdname[NCX_MAX_NLEN+1];
+    const xmlChar *name = get_line_command(line, cmdname);
+
+    if (!xml_strcmp(name, NCX_EL_CLOSE_SESSION)) {
+        log_error("\nError: '%s' not allowed in fanout; "
+                  "use stop-session instead\n", name);
+    } else {
+        log_error("\nError: local command '%s' not allowed in fanout\n",
+                  name);
+    }
+    return ERR_NCX_OPERATION_FAILED;
+
+}  /* check_fanout_line */
+
+
+/********************************************************************
+ * FUNCTION add_fanout_line
+ *
+ * Check a command line and add it to the job
+ *
+ * INPUTS:
+ *    job == fanout job to use
+ *    line == command line to add
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    add_fanout_line (fanout_cb_t *job,
+                     const xmlChar *line)
+{
+    status_t res = check_fanout_line(line);
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    rawline_t *rawline = new_rawline(line);
+    if (rawline == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    dlq_enque(rawline, &job->lineQ);
+    return NO_ERR;
+
+}  /* add_fanout_line */
+
+
+/********************************************************************
+ * FUNCTION load_fanout_script
+ *
+ * Read the command lines for a job from a script file
+ *
+ * INPUTS:
+ *    job == fanout job to use
+ *    source == script file source
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    load_fanout_script (fanout_cb_t *job,
+                        const xmlChar *source)
+{
+    status_t res = NO_ERR;
+
+    xmlChar *fspec = ncxmod_find_script_file(source, &res);
+    if (fspec == NULL) {
+        log_error("\nError: script '%s' not found\n", source);
+        return (res == NO_ERR) ? ERR_NCX_MISSING_FILE : res;
+    }
+
+    FILE *fp = fopen((const char *)fspec, "r");
+    if (fp == NULL) {
+        log_error("\nError: cannot open script '%s'\n", fspec);
+        m__free(fspec);
+        return ERR_NCX_MISSING_FILE;
+    }
+
+    xmlChar *buffer = m__getMem(NCX_MAX_LINELEN+1);
+    if (buffer == NULL) {
+        fclose(fp);
+        m__free(fspec);
+        return ERR_INTERNAL_MEM;
+    }
+
+    while (res == NO_ERR &&
+           fgets((char *)buffer, NCX_MAX_LINELEN+1, fp)) {
+        uint32 len = xml_strlen(buffer);
+        while (len && xml_isspace(buffer[len-1])) {
+            buffer[--len] = 0;
+        }
+
+        xmlChar *str = buffer;
+        while (*str && xml_isspace(*str)) {
+            str++;
+        }
+
+        if (*str == 0 || *str == '#') {
+            continue;
+        }
+        res = add_fanout_line(job, str);
+    }
+
+    m__free(buffer);
+    fclose(fp);
+    m__free(fspec);
+
+    if (res == NO_ERR && dlq_empty(&job->lineQ)) {
+        log_error("\nError: script '%s' has no commands\n", source);
+        res = ERR_NCX_EMPTY_VAL;
+    }
+    return res;
+
+}  /* load_fanout_script */
+
+
+/********************************************************************
+ * FUNCTION add_fanout_members
+ *
+ * Setup the member array from the session names in the group
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    job == fanout job to use
+ *    group == session group to use
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    add_fanout_members (server_cb_t *server_cb,
+                        fanout_cb_t *job,
+                        const session_group_t *group)
+{
+    job->sessions = xml_strdup(group->sessions);
+    if (job->sessions == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    /* count the names and split them in place */
+    uint32 count = 0;
+    xmlChar *str = job->sessions;
+    while (*str) {
+        while (*str && xml_isspace(*str)) {
+            *str++ = 0;
+        }
+        if (*str) {
+            count++;
+        }
+        while (*str && !xml_isspace(*str)) {
+            str++;
+        }
+    }
+
+    if (count == 0) {
+        log_error("\nError: session group '%s' is empty\n", group->name);
+        return ERR_NCX_EMPTY_VAL;
+    }
+
+    job->members = m__getMem(count * sizeof(fanout_member_t));
+    if (job->members == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    memset(job->members, 0x0, count * sizeof(fanout_member_t));
+    job->member_count = count;
+
+    uint32 i = 0;
+    str = job->sessions;
+    while (i < count) {
+        while (*str == 0) {
+            str++;
+        }
+
+        fanout_member_t *member = &job->members[i++];
+        member->name = str;
+        member->session_cb = find_session_cb(server_cb, str);
+        if (member->session_cb == NULL) {
+            member->res = ERR_NCX_NOT_FOUND;
+        } else if (!session_connected(member->session_cb)) {
+            member->res = ERR_NCX_SESSION_CLOSED;
+        } else if (member->session_cb->state != MGR_IO_ST_CONN_IDLE ||
+                   member->session_cb->command_mode != CMD_MODE_NORMAL) {
+            member->res = ERR_NCX_IN_USE;
+        } else {
+            member->sid = member->session_cb->mysid;
+            member->nextline = (rawline_t *)dlq_firstEntry(&job->lineQ);
+        }
+
+        str += xml_strlen(str);
+    }
+
+    return NO_ERR;
+
+}  /* add_fanout_members */
+
+
+/********************************************************************
+ * FUNCTION stop_member
+ *
+ * Stop sending to a member session; any outstanding
+ * requests are counted as failed
+ *
+ * INPUTS:
+ *    job == fanout job to use
+ *    member == member to stop
+ *    res == reason the member stopped
+ *********************************************************************/
+static void
+    stop_member (fanout_cb_t *job,
+                 fanout_member_t *member,
+                 status_t res)
+{
+    member->res = res;
+    member->nextline = NULL;
+    member->failed += member->outstanding;
+    job->in_flight -= member->outstanding;
+    member->outstanding = 0;
+
+}  /* stop_member */
+
+
+/********************************************************************
+ * FUNCTION fanout_reply_handler
+ *
+ * Handle an <rpc-reply> for a fanout request
+ * Matches the mgr_rpc_cbfn_t template
+ *
+ * INPUTS:
+ *   scb == session receiving RPC reply
+ *   req == original request returned for freeing or reusing
+ *   rpy == reply received from the server (for checking then freeing)
+ *********************************************************************/
+static void
+    fanout_reply_handler (ses_cb_t *scb,
+                          mgr_rpc_req_t *req,
+                          mgr_rpc_rpy_t *rpy)
+{
+    server_cb_t *server_cb = get_cur_server_cb();
+    fanout_cb_t *job = (server_cb) ? server_cb->fanout_cb : NULL;
+    fanout_member_t *member = NULL;
+
+    if (job && req->group_id && req->group_id <= job->member_count) {
+        member = &job->members[req->group_id - 1];
+        if (member->sid != scb->sid || member->outstanding == 0) {
+            /* request was already counted as failed */
+            member = NULL;
+        }
+    }
+
+    if (member) {
+        uint64 usec = elapsed_usec(&req->perfstarttime);
+
+        member->outstanding--;
+        job->in_flight--;
+        member->total_usec += usec;
+        if (usec > member->max_usec) {
+            member->max_usec = usec;
+        }
+
+        val_value_t *errval = NULL;
+        if (rpy && rpy->reply) {
+            errval = val_find_child(rpy->reply, NC_MODULE,
+                                    NCX_EL_RPC_ERROR);
+        }
+
+        if (rpy == NULL || rpy->reply == NULL || rpy->res != NO_ERR ||
+            errval) {
+            member->errors++;
+            if (member->errtag == NULL && errval) {
+                val_value_t *tagval =
+                    val_find_child(errval, NC_MODULE, NCX_EL_ERROR_TAG);
+                if (tagval) {
+                    member->errtag = xml_strdup(VAL_ENUM_NAME(tagval));
+                }
+            }
+        } else {
+            member->ok++;
+        }
+
+        if (LOGDEBUG) {
+            log_debug("\nfanout: reply %s from session '%s' (%s)",
+                      (rpy) ? rpy->msg_id : (const xmlChar *)"--",
+                      member->name, (errval) ? "error" : "ok");
+        }
+    }
+
+    mgr_rpc_free_request(req);
+    if (rpy) {
+        mgr_rpc_free_reply(rpy);
+    }
+
+}  /* fanout_reply_handler */
+
+
+/********************************************************************
+ * FUNCTION send_member_line
+ *
+ * Send the next command line to a member session
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    job == fanout job to use
+ *    member == member to send to
+ *********************************************************************/
+static void
+    send_member_line (server_cb_t *server_cb,
+                      fanout_cb_t *job,
+                      fanout_member_t *member)
+{
+    rawline_t *rawline = member->nextline;
+    member->nextline = (rawline_t *)dlq_nextEntry(rawline);
+
+    uint32 reqcount = 0;
+    status_t res =
+        yangcli_fanout_send_line(server_cb, member->session_cb,
+                                 member->sid, rawline->line,
+                                 fanout_reply_handler,
+                                 (uint32)(member - job->members) + 1,
+                                 &reqcount);
+    member->sent++;
+    member->outstanding += reqcount;
+    job->in_flight += reqcount;
+
+    if (res != NO_ERR) {
+        /* requests sent for the line are failed by stop_member */
+        if (reqcount == 0) {
+            member->failed++;
+        }
+        stop_member(job, member, res);
+        return;
+    }
+
+    if (reqcount == 0) {
+        /* local command that did not send a request */
+        member->ok++;
+    }
+
+}  /* send_member_line */
+
+
+/********************************************************************
+ * FUNCTION send_requests
+ *
+ * Send requests round-robin until there is nothing left
+ * to send or the limits are reached
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    job == fanout job to use
+ *********************************************************************/
+static void
+    send_requests (server_cb_t *server_cb,
+                   fanout_cb_t *job)
+{
+    uint32 count = 0;
+
+    while (count < job->member_count && job->in_flight < job->max_in_flight) {
+        fanout_member_t *member = &job->members[job->next_member];
+
+        while (member->nextline != NULL &&
+               member->outstanding < job->pipeline &&
+               job->in_flight < job->max_in_flight) {
+            send_member_line(server_cb, job, member);
+        }
+
+        if (job->in_flight < job->max_in_flight) {
+            /* this member is done for now; start with the next
+             * member next time only if this one used up the limit
+             */
+            job->next_member = (job->next_member + 1) % job->member_count;
+        }
+        count++;
+    }
+
+}  /* send_requests */
+
+
+/********************************************************************
+ * FUNCTION check_timeouts
+ *
+ * Expire the fanout requests that have timed out and
+ * stop the member sessions that have been dropped
+ *
+ * INPUTS:
+ *    job == fanout job to use
+ *********************************************************************/
+static void
+    check_timeouts (fanout_cb_t *job)
+{
+    time_t now;
+    uint32 i;
+
+    (void)time(&now);
+    if (now == job->last_check) {
+        /* timeouts are in seconds */
+        return;
+    }
+    job->last_check = now;
+
+    for (i = 0; i < job->member_count && job->in_flight; i++) {
+        fanout_member_t *member = &job->members[i];
+        if (member->outstanding == 0) {
+            continue;
+        }
+
+        ses_cb_t *scb = mgr_ses_get_scb(member->sid);
+        if (scb == NULL || scb->state == SES_ST_SHUTDOWN_REQ) {
+            stop_member(job, member, ERR_NCX_SESSION_CLOSED);
+            continue;
+        }
+
+        /* the CLI is held while the job runs, so all the requests
+         * pending on a member session belong to the job
+         */
+        uint32 count = mgr_rpc_timeout_requests(scb);
+        if (count > member->outstanding) {
+            count = member->outstanding;
+        }
+        if (count) {
+            log_debug("\nfanout: %u requests to session '%s' timed out",
+                      count, member->name);
+        }
+        member->failed += count;
+        member->outstanding -= count;
+        job->in_flight -= count;
+    }
+
+}  /* check_timeouts */
+
+
+/********************************************************************
+ * FUNCTION member_result
+ *
+ * Get the result string for a member in the report
+ *
+ * INPUTS:
+ *    member == member to check
+ *
+ * RETURNS:
+ *   result string
+ *********************************************************************/
+static const char *
+    member_result (const fanout_member_t *member)
+{
+    switch (member->res) {
+    case NO_ERR:
+        break;
+    case ERR_NCX_NOT_FOUND:
+        return "no such session";
+    case ERR_NCX_SESSION_CLOSED:
+        return "not connected";
+    case ERR_NCX_IN_USE:
+        return "session busy";
+    default:
+        return get_error_string(member->res);
+    }
+
+    if (member->errtag) {
+        return (const char *)member->errtag;
+    } else if (member->failed) {
+        return "timeout";
+    } else if (member->errors) {
+        return "error";
+    }
+    return "ok";
+
+}  /* member_result */
+
+
+/********************************************************************
+ * FUNCTION print_report
+ *
+ * Print the summary report for a finished job
+ *
+ * INPUTS:
+ *    job == fanout job to use
+ *********************************************************************/
+static void
+    print_report (const fanout_cb_t *job)
+{
+    uint64 elapsed = elapsed_usec(&job->start_time);
+    uint32 sent = 0, ok = 0, errors = 0, failed = 0, skipped = 0;
+    uint64 total_usec = 0, max_usec = 0;
+    uint32 i;
+
+    log_info("\nfanout '%s' to group '%s'", job->source, job->group);
+    log_info("\n%-*s %8s %8s %8s %8s %10s %10s  %s",
+             FANOUT_NAME_WIDTH, "session", "sent", "ok", "errors",
+             "failed", "avg(ms)", "max(ms)", "result");
+
+    for (i = 0; i < job->member_count; i++) {
+        const fanout_member_t *member = &job->members[i];
+        uint32 replies = member->ok + member->errors;
+        double avg = (replies) ?
+            (double)member->total_usec / replies / 1000.0 : 0.0;
+
+        log_info("\n%-*s %8u %8u %8u %8u %10.3f %10.3f  %s",
+                 FANOUT_NAME_WIDTH, member->name,
+                 member->sent, member->ok, member->errors, member->failed,
+                 avg, (double)member->max_usec / 1000.0,
+                 member_result(member));
+
+        sent += member->sent;
+        ok += member->ok;
+        errors += member->errors;
+        failed += member->failed;
+        total_usec += member->total_usec;
+        if (member->max_usec > max_usec) {
+            max_usec = member->max_usec;
+        }
+        if (member->sent == 0) {
+            skipped++;
+        }
+    }
+
+    double avg = (ok + errors) ?
+        (double)total_usec / (ok + errors) / 1000.0 : 0.0;
+    log_info("\n%-*s %8u %8u %8u %8u %10.3f %10.3f",
+             FANOUT_NAME_WIDTH, "total", sent, ok, errors, failed,
+             avg, (double)max_usec / 1000.0);
+
+    log_info("\n%u sessions (%u skipped), %u requests in %.3f sec",
+             job->member_count, skipped, sent, (double)elapsed / 1000000.0);
+    if (elapsed) {
+        log_info(", %.1f replies/sec",
+                 (double)(ok + errors) * 1000000.0 / (double)elapsed);
+    }
+    log_info("\n");
+
+}  /* print_report */
+
+
+/**************    E X T E R N A L   F U N C T I O N S **********/
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_line_allowed
+ *
+ * Check if a command line can be sent to many sessions at once
+ * Local commands are only allowed if they just send one
+ * request without a multi-step command mode
+ *
+ * INPUTS:
+ *    line == command line to check
+ *
+ * RETURNS:
+ *   TRUE if the line can be used
+ *********************************************************************/
+boolean
+    yangcli_fanout_line_allowed (const xmlChar *line)
+{
+    static const xmlChar *allowed[] = {
+        YANGCLI_CREATE, YANGCLI_DELETE, YANGCLI_INSERT,
+        YANGCLI_MERGE, YANGCLI_REMOVE, YANGCLI_REPLACE,
+        YANGCLI_SGET, YANGCLI_SGET_CONFIG,
+        YANGCLI_XGET, YANGCLI_XGET_CONFIG, NULL
+    };
+    xmlChar cmdname[NCX_MAX_NLEN+1];
+    uint32 i;
+
+    const xmlChar *name = get_line_command(line, cmdname);
+    if (!xml_strcmp(name, NCX_EL_CLOSE_SESSION)) {
+        return FALSE;
+    }
+
+    if (ncx_find_object(get_yangcli_mod(), name) == NULL) {
+        /* not a local command */
+        return TRUE;
+    }
+
+    for (i = 0; allowed[i] != NULL; i++) {
+        if (!xml_strcmp(name, allowed[i])) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+
+}  /* yangcli_fanout_line_allowed */
+
+
+/********************************************************************
+ * FUNCTION yangcli_find_session_group
+ *
+ * Find a session group by name
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    name == group name to find
+ *
+ * RETURNS:
+ *   pointer to group or NULL if not found
+ *********************************************************************/
+session_group_t *
+    yangcli_find_session_group (server_cb_t *server_cb,
+                                const xmlChar *name)
+{
+    session_group_t *group = (session_group_t *)
+        dlq_firstEntry(&server_cb->session_groupQ);
+    for (; group != NULL;
+         group = (session_group_t *)dlq_nextEntry(group)) {
+        if (!xml_strcmp(group->name, name)) {
+            return group;
+        }
+    }
+    return NULL;
+
+}  /* yangcli_find_session_group */
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_send_line
+ *
+ * Send a command line in a session without waiting for the reply
+ * The line is parsed as if it was entered in the session.
+ * Every request sent for the line is tagged with the reply
+ * callback and group ID, even if the line failed part way
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    session_cb == session to send the line in
+ *    sid == session ID the caller is using for session_cb
+ *    line == command line to send
+ *    replycb == reply callback to set in each request sent
+ *    group_id == group ID to set in each request sent
+ *    reqcount == address of return request count
+ *
+ * OUTPUTS:
+ *   *reqcount == number of requests sent for the line;
+ *                0 for a local command that did not send a request
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+status_t
+    yangcli_fanout_send_line (server_cb_t *server_cb,
+                              session_cb_t *session_cb,
+                              ses_id_t sid,
+                              xmlChar *line,
+                              mgr_rpc_cbfn_t replycb,
+                              uint32 group_id,
+                              uint32 *reqcount)
+{
+    *reqcount = 0;
+
+    ses_cb_t *scb = mgr_ses_get_scb(sid);
+    if (scb == NULL || scb->state == SES_ST_SHUTDOWN_REQ) {
+        return ERR_NCX_SESSION_CLOSED;
+    }
+
+    mgr_scb_t *mscb = mgr_ses_get_mscb(scb);
+    mgr_rpc_req_t *lastreq = (mgr_rpc_req_t *)dlq_lastEntry(&mscb->reqQ);
+
+    /* parse and send the line as if it were entered
+     * in the session
+     */
+    session_cb_t *save_session_cb = server_cb->cur_session_cb;
+    mgr_io_state_t save_state = session_cb->state;
+
+    set_cur_session_cb(server_cb, session_cb);
+    status_t res = conn_command(server_cb, line, FALSE, FALSE);
+    set_cur_session_cb(server_cb, save_session_cb);
+
+    /* the caller waits for the replies, not the session */
+    session_cb->state = save_state;
+
+    /* a local command can send more than 1 request */
+    mgr_rpc_req_t *req = (lastreq) ?
+        (mgr_rpc_req_t *)dlq_nextEntry(lastreq) :
+        (mgr_rpc_req_t *)dlq_firstEntry(&mscb->reqQ);
+    for (; req != NULL; req = (mgr_rpc_req_t *)dlq_nextEntry(req)) {
+        req->replycb = replycb;
+        req->group_id = group_id;
+        (*reqcount)++;
+    }
+
+    return res;
+
+}  /* yangcli_fanout_send_line */
+
+
+/********************************************************************
+ * FUNCTION do_session_group (local RPC)
+ *
+ * session-group show
+ * session-group create=name sessions="ses1 ses2 ..."
+ * session-group delete=name
+ *
+ * Handle the session-group command
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    rpc == RPC method for the session-group command
+ *    line == CLI input in progress
+ *    len == offset into line buffer to start parsing
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+status_t
+    do_session_group (server_cb_t *server_cb,
+                      obj_template_t *rpc,
+                      const xmlChar *line,
+                      uint32  len)
+{
+    status_t res = NO_ERR;
+    session_group_t *group = NULL;
+
+    val_value_t *valset = get_valset(server_cb, rpc, &line[len], &res);
+    if (res != NO_ERR || valset == NULL) {
+        if (valset) {
+            val_free_value(valset);
+        }
+        return res;
+    }
+
+    /* get the 1 of N 'group-action' choice */
+    val_value_t *parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_CREATE);
+    if (parm && parm->res == NO_ERR) {
+        val_value_t *sesparm =
+            val_find_child(valset, YANGCLI_MOD, YANGCLI_SESSIONS);
+        if (sesparm == NULL || sesparm->res != NO_ERR) {
+            log_error("\nError: missing 'sessions' parameter\n");
+            res = ERR_NCX_MISSING_PARM;
+        } else if (server_cb->fanout_cb) {
+            log_error("\nError: fanout in progress\n");
+            res = ERR_NCX_IN_USE;
+        } else {
+            xmlChar *sessions = xml_strdup(VAL_STR(sesparm));
+            group = yangcli_find_session_group(server_cb, VAL_STR(parm));
+            if (sessions == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else if (group) {
+                m__free(group->sessions);
+                group->sessions = sessions;
+            } else {
+                group = m__getObj(session_group_t);
+                if (group == NULL) {
+                    m__free(sessions);
+                    res = ERR_INTERNAL_MEM;
+                } else {
+                    memset(group, 0x0, sizeof(session_group_t));
+                    group->sessions = sessions;
+                    group->name = xml_strdup(VAL_STR(parm));
+                    if (group->name == NULL) {
+                        free_session_group(group);
+                        res = ERR_INTERNAL_MEM;
+                    } else {
+                        dlq_enque(group, &server_cb->session_groupQ);
+                    }
+                }
+            }
+            if (res == NO_ERR) {
+                log_info("\nSaved session group '%s'\n", VAL_STR(parm));
+            }
+        }
+    } else if ((parm = val_find_child(valset, YANGCLI_MOD,
+                                      YANGCLI_DELETE)) != NULL &&
+               parm->res == NO_ERR) {
+        group = yangcli_find_session_group(server_cb, VAL_STR(parm));
+        if (group == NULL) {
+            log_error("\nError: session group '%s' not found\n",
+                      VAL_STR(parm));
+            res = ERR_NCX_NOT_FOUND;
+        } else if (server_cb->fanout_cb) {
+            log_error("\nError: fanout in progress\n");
+            res = ERR_NCX_IN_USE;
+        } else {
+            dlq_remove(group);
+            free_session_group(group);
+            log_info("\nDeleted session group '%s'\n", VAL_STR(parm));
+        }
+    } else {
+        /* show is the default */
+        group = (session_group_t *)
+            dlq_firstEntry(&server_cb->session_groupQ);
+        if (group == NULL) {
+            log_info("\nNo session groups found\n");
+        } else {
+            log_info("\nSession groups:");
+            for (; group != NULL;
+                 group = (session_group_t *)dlq_nextEntry(group)) {
+                log_info("\n  %s: %s", group->name, group->sessions);
+            }
+            log_info("\n");
+        }
+    }
+
+    val_free_value(valset);
+    return res;
+
+}   /* do_session_group */
+
+
+/********************************************************************
+ * FUNCTION do_fanout (local RPC)
+ *
+ * fanout group=name command="cmd" | script=file
+ *        [max-in-flight=N] [pipeline=N]
+ *
+ * Handle the fanout command
+ * The requests are sent and the command stays active until
+ * yangcli_fanout_check reports that all of them are done
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    rpc == RPC method for the fanout command
+ *    line == CLI input in progress
+ *    len == offset into line buffer to start parsing
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+status_t
+    do_fanout (server_cb_t *server_cb,
+               obj_template_t *rpc,
+               const xmlChar *line,
+               uint32  len)
+{
+    status_t res = NO_ERR;
+    fanout_cb_t *job = NULL;
+
+    if (server_cb->fanout_cb) {
+        log_error("\nError: fanout already in progress\n");
+        return ERR_NCX_IN_USE;
+    }
+
+    if (server_cb->result_name || server_cb->result_filename) {
+        log_error("\nError: fanout result cannot be assigned\n");
+        return ERR_NCX_OPERATION_FAILED;
+    }
+
+    val_value_t *valset = get_valset(server_cb, rpc, &line[len], &res);
+    if (res != NO_ERR || valset == NULL) {
+        if (valset) {
+            val_free_value(valset);
+        }
+        return (res == NO_ERR) ? ERR_NCX_MISSING_PARM : res;
+    }
+
+    const session_group_t *group = NULL;
+    val_value_t *parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_GROUP);
+    if (parm == NULL || parm->res != NO_ERR) {
+        log_error("\nError: missing 'group' parameter\n");
+        res = ERR_NCX_MISSING_PARM;
+    } else {
+        group = yangcli_find_session_group(server_cb, VAL_STR(parm));
+        if (group == NULL) {
+            log_error("\nError: session group '%s' not found\n",
+                      VAL_STR(parm));
+            res = ERR_NCX_NOT_FOUND;
+        }
+    }
+
+    if (res == NO_ERR) {
+        job = m__getObj(fanout_cb_t);
+        if (job == NULL) {
+            res = ERR_INTERNAL_MEM;
+        } else {
+            memset(job, 0x0, sizeof(fanout_cb_t));
+            dlq_createSQue(&job->lineQ);
+            job->max_in_flight = 64;
+            job->pipeline = 1;
+            job->group = xml_strdup(group->name);
+            if (job->group == NULL) {
+                res = ERR_INTERNAL_MEM;
+            }
+        }
+    }
+
+    /* get the 1 of 2 'fanout-input' choice */
+    if (res == NO_ERR) {
+        parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_COMMAND);
+        if (parm && parm->res == NO_ERR) {
+            res = add_fanout_line(job, VAL_STR(parm));
+        } else {
+            parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_SCRIPT);
+            if (parm && parm->res == NO_ERR) {
+                res = load_fanout_script(job, VAL_STR(parm));
+            } else {
+                log_error("\nError: 'command' or 'script' "
+                          "parameter is required\n");
+                res = ERR_NCX_MISSING_PARM;
+            }
+        }
+        if (res == NO_ERR) {
+            job->source = xml_strdup(VAL_STR(parm));
+            if (job->source == NULL) {
+                res = ERR_INTERNAL_MEM;
+            }
+        }
+    }
+
+    if (res == NO_ERR) {
+        parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_MAX_IN_FLIGHT);
+        if (parm && parm->res == NO_ERR) {
+            job->max_in_flight = VAL_UINT(parm);
+        }
+        parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_PIPELINE);
+        if (parm && parm->res == NO_ERR) {
+            job->pipeline = VAL_UINT(parm);
+        }
+        res = add_fanout_members(server_cb, job, group);
+    }
+
+    val_free_value(valset);
+
+    if (res != NO_ERR) {
+        if (job) {
+            free_fanout_cb(job);
+        }
+        return res;
+    }
+
+    gettimeofday(&job->start_time, NULL);
+    server_cb->fanout_cb = job;
+
+    /* send the first requests now; the rest are sent
+     * from the STDIN handler as the replies arrive
+     */
+    (void)yangcli_fanout_check(server_cb);
+    return NO_ERR;
+
+}  /* do_fanout */
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_check
+ *
+ * Run one step of the fanout command in progress
+ * Called by the STDIN handler on each pass through the IO loop
+ * Expires timed out requests, sends more requests if the
+ * limits allow it, and prints the report when all the
+ * requests are done
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *
+ * RETURNS:
+ *   TRUE if a fanout command is still in progress
+ *   FALSE if no fanout command is active
+ *********************************************************************/
+boolean
+    yangcli_fanout_check (server_cb_t *server_cb)
+{
+    fanout_cb_t *job = server_cb->fanout_cb;
+    if (job == NULL) {
+        return FALSE;
+    }
+
+    if (mgr_shutdown_requested()) {
+        server_cb->fanout_cb = NULL;
+        free_fanout_cb(job);
+        return FALSE;
+    }
+
+    if (job->in_flight) {
+        check_timeouts(job);
+    }
+
+    send_requests(server_cb, job);
+
+    if (job->in_flight) {
+        return TRUE;
+    }
+
+    /* nothing outstanding and nothing left to send */
+    server_cb->fanout_cb = NULL;
+    print_report(job);
+    free_fanout_cb(job);
+    return FALSE;
+
+}  /* yangcli_fanout_check */
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_cleanup
+ *
+ * Cleanup the fanout command and the session groups
+ * for a server context
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *********************************************************************/
+void
+    yangcli_fanout_cleanup (server_cb_t *server_cb)
+{
+    if (server_cb->fanout_cb) {
+        free_fanout_cb(server_cb->fanout_cb);
+        server_cb->fanout_cb = NULL;
+    }
+
+    while (!dlq_empty(&server_cb->session_groupQ)) {
+        session_group_t *group = (session_group_t *)
+            dlq_deque(&server_cb->session_groupQ);
+        free_session_group(group);
+    }
+
+}  /* yangcli_fanout_cleanup */
+
+
+/* END yangcli_fanout.c */
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_yangcli_fanout
+#define _H_yangcli_fanout
+/*  FILE: yangcli_fanout.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+   implement yangcli fanout and session-group commands
+
+   The fanout command sends the same command or script lines
+   to every session in a named session group, with many
+   requests outstanding at once, and prints a summary report
+   of the results and timings for each session.
+
+*/
+
+#include <xmlstring.h>
+
+#include "mgr_rpc.h"
+#include "obj.h"
+#include "ses.h"
+#include "status.h"
+#include "yangcli.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+*                                                                   *
+*                      F U N C T I O N S                            *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+ * FUNCTION yangcli_find_session_group
+ *
+ * Find a session group by name
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    name == group name to find
+ *
+ * RETURNS:
+ *   pointer to group or NULL if not found
+ *********************************************************************/
+extern session_group_t *
+    yangcli_find_session_group (server_cb_t *server_cb,
+                                const xmlChar *name);
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_line_allowed
+ *
+ * Check if a command line can be sent to many sessions at once
+ * Local commands are only allowed if they just send one
+ * request without a multi-step command mode
+ *
+ * INPUTS:
+ *    line == command line to check
+ *
+ * RETURNS:
+ *   TRUE if the line can be used
+ *********************************************************************/
+extern boolean
+    yangcli_fanout_line_allowed (const xmlChar *line);
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_send_line
+ *
+ * Send a command line in a session without waiting for the reply
+ * The line is parsed as if it was entered in the session.
+ * Every request sent for the line is tagged with the reply
+ * callback and group ID, even if the line failed part way
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    session_cb == session to send the line in
+ *    sid == session ID the caller is using for session_cb
+ *    line == command line to send
+ *    replycb == reply callback to set in each request sent
+ *    group_id == group ID to set in each request sent
+ *    reqcount == address of return request count
+ *
+ * OUTPUTS:
+ *   *reqcount == number of requests sent for the line;
+ *                0 for a local command that did not send a request
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+extern status_t
+    yangcli_fanout_send_line (server_cb_t *server_cb,
+                              session_cb_t *session_cb,
+                              ses_id_t sid,
+                              xmlChar *line,
+                              mgr_rpc_cbfn_t replycb,
+                              uint32 group_id,
+                              uint32 *reqcount);
+
+
+/********************************************************************
+ * FUNCTION do_session_group (local RPC)
+ *
+ * session-group show
+ * session-group create=name sessions="ses1 ses2 ..."
+ * session-group delete=name
+ *
+ * Handle the session-group command
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    rpc == RPC method for the session-group command
+ *    line == CLI input in progress
+ *    len == offset into line buffer to start parsing
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+extern status_t
+    do_session_group (server_cb_t *server_cb,
+                      obj_template_t *rpc,
+                      const xmlChar *line,
+                      uint32  len);
+
+
+/********************************************************************
+ * FUNCTION do_fanout (local RPC)
+ *
+ * fanout group=name command="cmd" | script=file
+ *        [max-in-flight=N] [pipeline=N]
+ *
+ * Handle the fanout command
+ * The requests are sent and the command stays active until
+ * yangcli_fanout_check reports that all of them are done
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    rpc == RPC method for the fanout command
+ *    line == CLI input in progress
+ *    len == offset into line buffer to start parsing
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+extern status_t
+    do_fanout (server_cb_t *server_cb,
+               obj_template_t *rpc,
+               const xmlChar *line,
+               uint32  len);
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_check
+ *
+ * Run one step of the fanout command in progress
+ * Called by the STDIN handler on each pass through the IO loop
+ * Expires timed out requests, sends more requests if the
+ * limits allow it, and prints the report when all the
+ * requests are done
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *
+ * RETURNS:
+ *   TRUE if a fanout command is still in progress
+ *   FALSE if no fanout command is active
+ *********************************************************************/
+extern boolean
+    yangcli_fanout_check (server_cb_t *server_cb);
+
+
+/********************************************************************
+ * FUNCTION yangcli_fanout_cleanup
+ *
+ * Cleanup the fanout command and the session groups
+ * for a server context
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *********************************************************************/
+extern void
+    yangcli_fanout_cleanup (server_cb_t *server_cb);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif            /* _H_yangcli_fanout */
@@ -37,6 +37,7 @@ date         init     comment
 #include <libssh2.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <fcntl.h>
 #include <errno.h>
@@ -491,6 +492,9 @@ static status_t
         log_info("\nResume recording: suite=%s test=%s\n",
                              suite_name, test_name);
         context->ut_state = UT_STATE_RECORD_IN_PROGRESS;
+
+        /* the pause is not part of the delay before the next step */
+        gettimeofday(&context->record_time, NULL);
         break;
 
     default:
@@ -676,6 +680,7 @@ static status_t
                                   suite_name, test_name);
             context->cur_suite = suite;
             context->ut_state = UT_STATE_RECORD_IN_PROGRESS;
+            memset(&context->record_time, 0x0, sizeof(struct timeval));
        }
        break;
 
@@ -1111,6 +1116,17 @@ extern status_t
         return ERR_INTERNAL_MEM;
     }   
 
+    /* save the time since the previous step for replay */
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    if (context->record_time.tv_sec) {
+        int64 msec = 
+            (int64)(now.tv_sec - context->record_time.tv_sec) * 1000 +
+            (int64)(now.tv_usec - context->record_time.tv_usec) / 1000;
+        step->delay_msec = (msec > 0) ? (uint32)msec : 0;
+    }
+    context->record_time = now;
+
     context->cur_step = step;
     /* step->result_error_apptag = TODO;
     if (!step->result_error_apptag) {
@@ -0,0 +1,1102 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: yangcli_replay.c
+
+   NETCONF YANG-based CLI Tool
+
+   replay command
+
+   A replay job sends the steps of recorded tests to every
+   session in a session group as a load test.  Each session
+   replays the whole capture on its own, in step order, with up
+   to 'pipeline' requests outstanding.  The step session-name
+   and expected results are ignored; only the command lines
+   and the recorded delays are used.
+
+   If a rate is given, each step is held until its recorded
+   offset from the first step, scaled by the rate, has passed.
+   Otherwise the steps are sent as fast as the pipeline allows.
+
+   The latency of every reply is kept, so the report can show
+   the achieved ops/sec and the latency percentiles.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "procdefs.h"
+#include "dlq.h"
+#include "log.h"
+#include "mgr.h"
+#include "mgr_io.h"
+#include "mgr_rpc.h"
+#include "mgr_ses.h"
+#include "ncx.h"
+#include "ncxconst.h"
+#include "status.h"
+#include "val.h"
+#include "xml_util.h"
+#include "yangcli.h"
+#include "yangcli_cmd.h"
+#include "yangcli_fanout.h"
+#include "yangcli_replay.h"
+#include "yangcli_unit_test.h"
+#include "yangcli_util.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+/* width of the session name column in the report */
+#define REPLAY_NAME_WIDTH   20
+
+/* initial size of the latency sample array */
+#define REPLAY_MIN_SAMPLES  1024
+
+
+/********************************************************************
+*                                                                   *
+*                           T Y P E S                               *
+*                                                                   *
+*********************************************************************/
+
+/* one command line to replay */
+typedef struct replay_step_t_ {
+    xmlChar         *command;       /* malloced command line */
+    uint64           offset_usec;   /* recorded time from first step */
+} replay_step_t;
+
+
+/* one session in a replay job */
+typedef struct replay_stream_t_ {
+    const xmlChar   *name;          /* backptr into job sessions */
+    session_cb_t    *session_cb;    /* backptr; NULL if not found */
+    ses_id_t         sid;
+    uint32           next_step;     /* index into job steps */
+    uint32           iteration;     /* iterations sent so far */
+    struct timeval   iter_start;    /* when step 0 was sent */
+    status_t         res;           /* set if the session stopped */
+    uint32           sent;
+    uint32           outstanding;
+    uint32           ok;
+    uint32           errors;
+    uint32           failed;
+    uint64           total_usec;
+} replay_stream_t;
+
+
+/* replay job control block */
+typedef struct replay_cb_t_ {
+    xmlChar         *source;        /* malloced suite[/test] name */
+    xmlChar         *group;         /* malloced group name */
+    xmlChar         *sessions;      /* malloced session names */
+    replay_step_t   *steps;         /* malloced array */
+    uint32           step_count;
+    replay_stream_t *streams;       /* malloced array */
+    uint32           stream_count;
+    uint32           pipeline;
+    uint32           iterations;
+    uint32           rate;          /* percent; 0 == no pacing */
+    uint32           in_flight;
+    uint32          *samples;       /* malloced latency array */
+    uint32           sample_count;
+    uint32           sample_max;
+    struct timeval   start_time;
+    time_t           last_check;
+} replay_cb_t;
+
+
+/********************************************************************
+ * FUNCTION free_replay_cb
+ *
+ * Free a replay job
+ *
+ * INPUTS:
+ *    job == replay job to free
+ *********************************************************************/
+static void
+    free_replay_cb (replay_cb_t *job)
+{
+    uint32 i;
+
+    if (job->steps) {
+        for (i = 0; i < job->step_count; i++) {
+            m__free(job->steps[i].command);
+        }
+        m__free(job->steps);
+    }
+
+    m__free(job->streams);
+    m__free(job->samples);
+    m__free(job->source);
+    m__free(job->group);
+    m__free(job->sessions);
+    m__free(job);
+
+}  /* free_replay_cb */
+
+
+/********************************************************************
+ * FUNCTION elapsed_usec
+ *
+ * Get the microseconds since a start time
+ *
+ * INPUTS:
+ *    start == start time
+ *
+ * RETURNS:
+ *   elapsed microseconds; 0 if the clock went backwards
+ *********************************************************************/
+static uint64
+    elapsed_usec (const struct timeval *start)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    int64 usec = (int64)(now.tv_sec - start->tv_sec) * 1000000 +
+        (int64)(now.tv_usec - start->tv_usec);
+    return (usec > 0) ? (uint64)usec : 0;
+
+}  /* elapsed_usec */
+
+
+/********************************************************************
+ * FUNCTION count_test_steps
+ *
+ * Count the steps in the tests to replay
+ *
+ * INPUTS:
+ *    suite == test-suite to use
+ *    test == single test to use; NULL for all run-test entries
+ *
+ * RETURNS:
+ *   number of steps
+ *********************************************************************/
+static uint32
+    count_test_steps (yangcli_ut_suite_t *suite,
+                      yangcli_ut_test_t *test)
+{
+    if (test) {
+        return dlq_count(&test->step_listQ);
+    }
+
+    uint32 count = 0;
+    run_test_t *run_test = (run_test_t *)
+        dlq_firstEntry(&suite->run_test_leaflistQ);
+    for (; run_test != NULL;
+         run_test = (run_test_t *)dlq_nextEntry(run_test)) {
+        test = find_test(suite, run_test->run_test_name);
+        if (test) {
+            count += dlq_count(&test->step_listQ);
+        }
+    }
+    return count;
+
+}  /* count_test_steps */
+
+
+/********************************************************************
+ * FUNCTION add_replay_test
+ *
+ * Add the steps of one test to the job
+ * Steps that cannot be sent to many sessions are skipped
+ *
+ * INPUTS:
+ *    job == replay job to use
+ *    test == test to add
+ *    offset == address of recorded offset so far
+ *
+ * OUTPUTS:
+ *    *offset == recorded offset of the last step added
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    add_replay_test (replay_cb_t *job,
+                     yangcli_ut_test_t *test,
+                     uint64 *offset)
+{
+    yangcli_ut_step_t *step = (yangcli_ut_step_t *)
+        dlq_firstEntry(&test->step_listQ);
+    for (; step != NULL; step = (yangcli_ut_step_t *)dlq_nextEntry(step)) {
+        /* the delay of a skipped step still counts */
+        if (job->step_count) {
+            *offset += (uint64)step->delay_msec * 1000;
+        }
+
+        if (!yangcli_fanout_line_allowed(step->command)) {
+            log_warn("\nWarning: step '%s' in test '%s' skipped; "
+                     "command cannot be replayed\n",
+                     step->name, test->test_name);
+            continue;
+        }
+
+        replay_step_t *rstep = &job->steps[job->step_count];
+        rstep->command = xml_strdup(step->command);
+        if (rstep->command == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        rstep->offset_usec = *offset;
+        job->step_count++;
+    }
+    return NO_ERR;
+
+}  /* add_replay_test */
+
+
+/********************************************************************
+ * FUNCTION load_replay_steps
+ *
+ * Copy the command lines of the tests to replay
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    job == replay job to use
+ *    suite_name == test-suite name
+ *    test_name == test name; NULL for all run-test entries
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    load_replay_steps (server_cb_t *server_cb,
+                       replay_cb_t *job,
+                       const xmlChar *suite_name,
+                       const xmlChar *test_name)
+{
+    yangcli_ut_suite_t *suite =
+        find_suite(&server_cb->ut_context, NULL, suite_name);
+    if (suite == NULL) {
+        log_error("\nError: test-suite '%s' not found\n", suite_name);
+        return ERR_NCX_NOT_FOUND;
+    }
+
+    yangcli_ut_test_t *test = NULL;
+    if (test_name) {
+        test = find_test(suite, test_name);
+        if (test == NULL) {
+            log_error("\nError: test '%s' not found in test-suite '%s'\n",
+                      test_name, suite_name);
+            return ERR_NCX_NOT_FOUND;
+        }
+    }
+
+    uint32 count = count_test_steps(suite, test);
+    if (count) {
+        job->steps = m__getMem(count * sizeof(replay_step_t));
+        if (job->steps == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        memset(job->steps, 0x0, count * sizeof(replay_step_t));
+    }
+
+    status_t res = NO_ERR;
+    uint64 offset = 0;
+    if (test) {
+        res = add_replay_test(job, test, &offset);
+    } else {
+        run_test_t *run_test = (run_test_t *)
+            dlq_firstEntry(&suite->run_test_leaflistQ);
+        for (; run_test != NULL && res == NO_ERR;
+             run_test = (run_test_t *)dlq_nextEntry(run_test)) {
+            test = find_test(suite, run_test->run_test_name);
+            if (test) {
+                res = add_replay_test(job, test, &offset);
+            }
+        }
+    }
+
+    if (res == NO_ERR && job->step_count == 0) {
+        log_error("\nError: no steps to replay in '%s'\n", job->source);
+        res = ERR_NCX_EMPTY_VAL;
+    }
+    return res;
+
+}  /* load_replay_steps */
+
+
+/********************************************************************
+ * FUNCTION add_replay_streams
+ *
+ * Setup the stream array from the session names in the group
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    job == replay job to use
+ *    group == session group to use
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    add_replay_streams (server_cb_t *server_cb,
+                        replay_cb_t *job,
+                        const session_group_t *group)
+{
+    job->sessions = xml_strdup(group->sessions);
+    if (job->sessions == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    /* count the names and split them in place */
+    uint32 count = 0;
+    xmlChar *str = job->sessions;
+    while (*str) {
+        while (*str && xml_isspace(*str)) {
+            *str++ = 0;
+        }
+        if (*str) {
+            count++;
+        }
+        while (*str && !xml_isspace(*str)) {
+            str++;
+        }
+    }
+
+    if (count == 0) {
+        log_error("\nError: session group '%s' is empty\n", group->name);
+        return ERR_NCX_EMPTY_VAL;
+    }
+
+    job->streams = m__getMem(count * sizeof(replay_stream_t));
+    if (job->streams == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    memset(job->streams, 0x0, count * sizeof(replay_stream_t));
+    job->stream_count = count;
+
+    uint32 i = 0;
+    str = job->sessions;
+    while (i < count) {
+        while (*str == 0) {
+            str++;
+        }
+
+        replay_stream_t *stream = &job->streams[i++];
+        stream->name = str;
+        stream->session_cb = find_session_cb(server_cb, str);
+        if (stream->session_cb == NULL) {
+            stream->res = ERR_NCX_NOT_FOUND;
+        } else if (!session_connected(stream->session_cb)) {
+            stream->res = ERR_NCX_SESSION_CLOSED;
+        } else if (stream->session_cb->state != MGR_IO_ST_CONN_IDLE ||
+                   stream->session_cb->command_mode != CMD_MODE_NORMAL) {
+            stream->res = ERR_NCX_IN_USE;
+        } else {
+            stream->sid = stream->session_cb->mysid;
+        }
+
+        str += xml_strlen(str);
+    }
+
+    return NO_ERR;
+
+}  /* add_replay_streams */
+
+
+/********************************************************************
+ * FUNCTION stream_done
+ *
+ * Check if a stream has nothing left to send
+ *
+ * INPUTS:
+ *    job == replay job to use
+ *    stream == stream to check
+ *
+ * RETURNS:
+ *   TRUE if the stream is done sending
+ *********************************************************************/
+static boolean
+    stream_done (const replay_cb_t *job,
+                 const replay_stream_t *stream)
+{
+    return (stream->res != NO_ERR ||
+            stream->iteration >= job->iterations) ? TRUE : FALSE;
+
+}  /* stream_done */
+
+
+/********************************************************************
+ * FUNCTION stop_stream
+ *
+ * Stop sending to a stream session; any outstanding
+ * requests are counted as failed
+ *
+ * INPUTS:
+ *    job == replay job to use
+ *    stream == stream to stop
+ *    res == reason the stream stopped
+ *********************************************************************/
+static void
+    stop_stream (replay_cb_t *job,
+                 replay_stream_t *stream,
+                 status_t res)
+{
+    stream->res = res;
+    stream->failed += stream->outstanding;
+    job->in_flight -= stream->outstanding;
+    stream->outstanding = 0;
+
+}  /* stop_stream */
+
+
+/********************************************************************
+ * FUNCTION add_sample
+ *
+ * Save the latency of one reply
+ * If the array cannot be grown the sample is dropped
+ *
+ * INPUTS:
+ *    job == replay job to use
+ *    usec == reply latency
+ *********************************************************************/
+static void
+    add_sample (replay_cb_t *job,
+                uint64 usec)
+{
+    if (job->sample_count == job->sample_max) {
+        uint32 newmax = (job->sample_max) ?
+            job->sample_max * 2 : REPLAY_MIN_SAMPLES;
+        uint32 *newsamples = m__getMem(newmax * sizeof(uint32));
+        if (newsamples == NULL) {
+            return;
+        }
+        if (job->samples) {
+            memcpy(newsamples, job->samples,
+                   job->sample_count * sizeof(uint32));
+            m__free(job->samples);
+        }
+        job->samples = newsamples;
+        job->sample_max = newmax;
+    }
+
+    job->samples[job->sample_count++] =
+        (usec > NCX_MAX_UINT) ? NCX_MAX_UINT : (uint32)usec;
+
+}  /* add_sample */
+
+
+/********************************************************************
+ * FUNCTION replay_reply_handler
+ *
+ * Handle an <rpc-reply> for a replay request
+ * Matches the mgr_rpc_cbfn_t template
+ *
+ * INPUTS:
+ *   scb == session receiving RPC reply
+ *   req == original request returned for freeing or reusing
+ *   rpy == reply received from the server (for checking then freeing)
+ *********************************************************************/
+static void
+    replay_reply_handler (ses_cb_t *scb,
+                          mgr_rpc_req_t *req,
+                          mgr_rpc_rpy_t *rpy)
+{
+    server_cb_t *server_cb = get_cur_server_cb();
+    replay_cb_t *job = (server_cb) ? server_cb->replay_cb : NULL;
+    replay_stream_t *stream = NULL;
+
+    if (job && req->group_id && req->group_id <= job->stream_count) {
+        stream = &job->streams[req->group_id - 1];
+        if (stream->sid != scb->sid || stream->outstanding == 0) {
+            /* request was already counted as failed */
+            stream = NULL;
+        }
+    }
+
+    if (stream) {
+        uint64 usec = elapsed_usec(&req->perfstarttime);
+
+        stream->outstanding--;
+        job->in_flight--;
+        stream->total_usec += usec;
+        add_sample(job, usec);
+
+        if (rpy == NULL || rpy->reply == NULL || rpy->res != NO_ERR ||
+            val_find_child(rpy->reply, NC_MODULE, NCX_EL_RPC_ERROR)) {
+            stream->errors++;
+        } else {
+            stream->ok++;
+        }
+    }
+
+    mgr_rpc_free_request(req);
+    if (rpy) {
+        mgr_rpc_free_reply(rpy);
+    }
+
+}  /* replay_reply_handler */
+
+
+/********************************************************************
+ * FUNCTION send_stream_step
+ *
+ * Send the next step to a stream session
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    job == replay job to use
+ *    stream == stream to send to
+ *********************************************************************/
+static void
+    send_stream_step (server_cb_t *server_cb,
+                      replay_cb_t *job,
+                      replay_stream_t *stream)
+{
+    replay_step_t *step = &job->steps[stream->next_step];
+
+    if (stream->next_step == 0) {
+        gettimeofday(&stream->iter_start, NULL);
+    }
+    if (++stream->next_step == job->step_count) {
+        stream->next_step = 0;
+        stream->iteration++;
+    }
+
+    uint32 reqcount = 0;
+    status_t res =
+        yangcli_fanout_send_line(server_cb, stream->session_cb,
+                                 stream->sid, step->command,
+                                 replay_reply_handler,
+                                 (uint32)(stream - job->streams) + 1,
+                                 &reqcount);
+    stream->sent++;
+    stream->outstanding += reqcount;
+    job->in_flight += reqcount;
+
+    if (res != NO_ERR) {
+        /* requests sent for the step are failed by stop_stream */
+        if (reqcount == 0) {
+            stream->failed++;
+        }
+        stop_stream(job, stream, res);
+        return;
+    }
+
+    if (reqcount == 0) {
+        /* local command that did not send a request */
+        stream->ok++;
+    }
+
+}  /* send_stream_step */
+
+
+/********************************************************************
+ * FUNCTION step_wait_usec
+ *
+ * Get the time until the next step of a stream is due
+ *
+ * INPUTS:
+ *    job == replay job to use
+ *    stream == stream to check
+ *
+ * RETURNS:
+ *   microseconds to wait; 0 if the step can be sent now
+ *********************************************************************/
+static uint64
+    step_wait_usec (const replay_cb_t *job,
+                    const replay_stream_t *stream)
+{
+    if (job->rate == 0 || stream->next_step == 0) {
+        return 0;
+    }
+
+    uint64 due = job->steps[stream->next_step].offset_usec * 100 /
+        job->rate;
+    uint64 elapsed = elapsed_usec(&stream->iter_start);
+    return (elapsed >= due) ? 0 : due - elapsed;
+
+}  /* step_wait_usec */
+
+
+/********************************************************************
+ * FUNCTION send_requests
+ *
+ * Send the steps that are due on each stream, up to the
+ * pipeline limit, and set the IO wakeup for the next step
+ * that is held back by the rate
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    job == replay job to use
+ *********************************************************************/
+static void
+    send_requests (server_cb_t *server_cb,
+                   replay_cb_t *job)
+{
+    uint64 min_wait = 0;
+    uint32 i;
+
+    for (i = 0; i < job->stream_count; i++) {
+        replay_stream_t *stream = &job->streams[i];
+
+        while (!stream_done(job, stream) &&
+               stream->outstanding < job->pipeline) {
+            uint64 wait = step_wait_usec(job, stream);
+            if (wait) {
+                if (min_wait == 0 || wait < min_wait) {
+                    min_wait = wait;
+                }
+                break;
+            }
+            send_stream_step(server_cb, job, stream);
+        }
+    }
+
+    if (min_wait) {
+        /* round up so the step is due when the wait ends */
+        mgr_io_set_wakeup((uint32)((min_wait + 999) / 1000));
+    }
+
+}  /* send_requests */
+
+
+/********************************************************************
+ * FUNCTION check_timeouts
+ *
+ * Expire the replay requests that have timed out and
+ * stop the stream sessions that have been dropped
+ *
+ * INPUTS:
+ *    job == replay job to use
+ *********************************************************************/
+static void
+    check_timeouts (replay_cb_t *job)
+{
+    time_t now;
+    uint32 i;
+
+    (void)time(&now);
+    if (now == job->last_check) {
+        /* timeouts are in seconds */
+        return;
+    }
+    job->last_check = now;
+
+    for (i = 0; i < job->stream_count && job->in_flight; i++) {
+        replay_stream_t *stream = &job->streams[i];
+        if (stream->outstanding == 0) {
+            continue;
+        }
+
+        ses_cb_t *scb = mgr_ses_get_scb(stream->sid);
+        if (scb == NULL || scb->state == SES_ST_SHUTDOWN_REQ) {
+            stop_stream(job, stream, ERR_NCX_SESSION_CLOSED);
+            continue;
+        }
+
+        /* the CLI is held while the job runs, so all the requests
+         * pending on a stream session belong to the job
+         */
+        uint32 count = mgr_rpc_timeout_requests(scb);
+        if (count > stream->outstanding) {
+            count = stream->outstanding;
+        }
+        stream->failed += count;
+        stream->outstanding -= count;
+        job->in_flight -= count;
+    }
+
+}  /* check_timeouts */
+
+
+/********************************************************************
+ * FUNCTION compare_samples
+ *
+ * qsort compare function for the latency samples
+ *
+ * INPUTS:
+ *    a, b == pointers to the samples to compare
+ *
+ * RETURNS:
+ *   -1, 0 or 1
+ *********************************************************************/
+static int
+    compare_samples (const void *a,
+                     const void *b)
+{
+    uint32 x = *(const uint32 *)a;
+    uint32 y = *(const uint32 *)b;
+
+    return (x < y) ? -1 : ((x > y) ? 1 : 0);
+
+}  /* compare_samples */
+
+
+/********************************************************************
+ * FUNCTION sample_ms
+ *
+ * Get a latency percentile from the sorted samples
+ *
+ * INPUTS:
+ *    job == replay job with sorted samples
+ *    pct == percentile to get
+ *
+ * RETURNS:
+ *   latency in milliseconds
+ *********************************************************************/
+static double
+    sample_ms (const replay_cb_t *job,
+               uint32 pct)
+{
+    if (job->sample_count == 0) {
+        return 0.0;
+    }
+
+    /* nearest rank */
+    uint64 rank = ((uint64)job->sample_count * pct + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    return (double)job->samples[rank - 1] / 1000.0;
+
+}  /* sample_ms */
+
+
+/********************************************************************
+ * FUNCTION stream_result
+ *
+ * Get the result string for a stream in the report
+ *
+ * INPUTS:
+ *    stream == stream to check
+ *
+ * RETURNS:
+ *   result string
+ *********************************************************************/
+static const char *
+    stream_result (const replay_stream_t *stream)
+{
+    switch (stream->res) {
+    case NO_ERR:
+        break;
+    case ERR_NCX_NOT_FOUND:
+        return "no such session";
+    case ERR_NCX_SESSION_CLOSED:
+        return "not connected";
+    case ERR_NCX_IN_USE:
+        return "session busy";
+    default:
+        return get_error_string(stream->res);
+    }
+
+    if (stream->failed) {
+        return "timeout";
+    } else if (stream->errors) {
+        return "error";
+    }
+    return "ok";
+
+}  /* stream_result */
+
+
+/********************************************************************
+ * FUNCTION print_report
+ *
+ * Print the summary report for a finished job
+ *
+ * INPUTS:
+ *    job == replay job to use; the samples are sorted
+ *********************************************************************/
+static void
+    print_report (replay_cb_t *job)
+{
+    uint64 elapsed = elapsed_usec(&job->start_time);
+    uint32 sent = 0, ok = 0, errors = 0, failed = 0, skipped = 0;
+    uint32 i;
+
+    log_info("\nreplay '%s' on group '%s'", job->source, job->group);
+    if (job->rate) {
+        log_info_append(" at %u%% of recorded rate", job->rate);
+    }
+    log_info("\n%-*s %8s %8s %8s %8s %10s  %s",
+             REPLAY_NAME_WIDTH, "session", "sent", "ok", "errors",
+             "failed", "avg(ms)", "result");
+
+    for (i = 0; i < job->stream_count; i++) {
+        const replay_stream_t *stream = &job->streams[i];
+        uint32 replies = stream->ok + stream->errors;
+        double avg = (replies) ?
+            (double)stream->total_usec / replies / 1000.0 : 0.0;
+
+        log_info("\n%-*s %8u %8u %8u %8u %10.3f  %s",
+                 REPLAY_NAME_WIDTH, stream->name,
+                 stream->sent, stream->ok, stream->errors, stream->failed,
+                 avg, stream_result(stream));
+
+        sent += stream->sent;
+        ok += stream->ok;
+        errors += stream->errors;
+        failed += stream->failed;
+        if (stream->sent == 0) {
+            skipped++;
+        }
+    }
+
+    log_info("\n%u sessions (%u skipped), %u requests in %.3f sec",
+             job->stream_count, skipped, sent,
+             (double)elapsed / 1000000.0);
+    if (elapsed) {
+        log_info_append(", %.1f ops/sec",
+                        (double)(ok + errors) * 1000000.0 /
+                        (double)elapsed);
+    }
+
+    if (job->sample_count) {
+        qsort(job->samples, job->sample_count, sizeof(uint32),
+              compare_samples);
+        log_info("\nlatency (ms): min %.3f  p50 %.3f  p90 %.3f  "
+                 "p99 %.3f  max %.3f",
+                 (double)job->samples[0] / 1000.0,
+                 sample_ms(job, 50), sample_ms(job, 90),
+                 sample_ms(job, 99),
+                 (double)job->samples[job->sample_count - 1] / 1000.0);
+    }
+    log_info("\n");
+
+}  /* print_report */
+
+
+/**************    E X T E R N A L   F U N C T I O N S **********/
+
+
+/********************************************************************
+ * FUNCTION do_replay (local RPC)
+ *
+ * replay suite-name=name [test-name=name] group=name
+ *        [pipeline=N] [rate=percent] [iterations=N]
+ *
+ * Handle the replay command
+ * The requests are sent and the command stays active until
+ * yangcli_replay_check reports that all of them are done
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    rpc == RPC method for the replay command
+ *    line == CLI input in progress
+ *    len == offset into line buffer to start parsing
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+status_t
+    do_replay (server_cb_t *server_cb,
+               obj_template_t *rpc,
+               const xmlChar *line,
+               uint32  len)
+{
+    status_t res = NO_ERR;
+    replay_cb_t *job = NULL;
+
+    if (server_cb->replay_cb || server_cb->fanout_cb) {
+        log_error("\nError: replay or fanout already in progress\n");
+        return ERR_NCX_IN_USE;
+    }
+
+    if (server_cb->result_name || server_cb->result_filename) {
+        log_error("\nError: replay result cannot be assigned\n");
+        return ERR_NCX_OPERATION_FAILED;
+    }
+
+    val_value_t *valset = get_valset(server_cb, rpc, &line[len], &res);
+    if (res != NO_ERR || valset == NULL) {
+        if (valset) {
+            val_free_value(valset);
+        }
+        return (res == NO_ERR) ? ERR_NCX_MISSING_PARM : res;
+    }
+
+    const session_group_t *group = NULL;
+    val_value_t *parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_GROUP);
+    if (parm == NULL || parm->res != NO_ERR) {
+        log_error("\nError: missing 'group' parameter\n");
+        res = ERR_NCX_MISSING_PARM;
+    } else {
+        group = yangcli_find_session_group(server_cb, VAL_STR(parm));
+        if (group == NULL) {
+            log_error("\nError: session group '%s' not found\n",
+                      VAL_STR(parm));
+            res = ERR_NCX_NOT_FOUND;
+        }
+    }
+
+    const xmlChar *suite_name = NULL;
+    const xmlChar *test_name = NULL;
+    if (res == NO_ERR) {
+        parm = val_find_child(valset, YANGCLI_MOD,
+                              YANGCLI_RECORD_SUITENAME);
+        if (parm == NULL || parm->res != NO_ERR) {
+            log_error("\nError: missing 'suite-name' parameter\n");
+            res = ERR_NCX_MISSING_PARM;
+        } else {
+            suite_name = VAL_STR(parm);
+        }
+        parm = val_find_child(valset, YANGCLI_MOD,
+                              YANGCLI_RECORD_TESTNAME);
+        if (parm && parm->res == NO_ERR) {
+            test_name = VAL_STR(parm);
+        }
+    }
+
+    if (res == NO_ERR) {
+        job = m__getObj(replay_cb_t);
+        if (job == NULL) {
+            res = ERR_INTERNAL_MEM;
+        } else {
+            memset(job, 0x0, sizeof(replay_cb_t));
+            job->pipeline = 1;
+            job->iterations = 1;
+            job->group = xml_strdup(group->name);
+            uint32 srclen = xml_strlen(suite_name) +
+                ((test_name) ? xml_strlen(test_name) + 1 : 0);
+            job->source = m__getMem(srclen + 1);
+            if (job->group == NULL || job->source == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else {
+                snprintf((char *)job->source, srclen + 1, "%s%s%s",
+                         suite_name, (test_name) ? "/" : "",
+                         (test_name) ? (const char *)test_name : "");
+            }
+        }
+    }
+
+    if (res == NO_ERR) {
+        parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_PIPELINE);
+        if (parm && parm->res == NO_ERR) {
+            job->pipeline = VAL_UINT(parm);
+        }
+        parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_ITERATIONS);
+        if (parm && parm->res == NO_ERR) {
+            job->iterations = VAL_UINT(parm);
+        }
+        parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_RATE);
+        if (parm && parm->res == NO_ERR) {
+            job->rate = VAL_UINT(parm);
+        }
+        res = load_replay_steps(server_cb, job, suite_name, test_name);
+    }
+
+    if (res == NO_ERR) {
+        res = add_replay_streams(server_cb, job, group);
+    }
+
+    val_free_value(valset);
+
+    if (res != NO_ERR) {
+        if (job) {
+            free_replay_cb(job);
+        }
+        return res;
+    }
+
+    log_info("\nReplaying %u steps x %u on group '%s'\n",
+             job->step_count, job->iterations, job->group);
+
+    gettimeofday(&job->start_time, NULL);
+    server_cb->replay_cb = job;
+
+    /* send the first requests now; the rest are sent
+     * from the STDIN handler as the replies arrive
+     */
+    (void)yangcli_replay_check(server_cb);
+    return NO_ERR;
+
+}  /* do_replay */
+
+
+/********************************************************************
+ * FUNCTION yangcli_replay_check
+ *
+ * Run one step of the replay command in progress
+ * Called by the STDIN handler on each pass through the IO loop
+ * Expires timed out requests, sends the steps that are due,
+ * and prints the report when all the requests are done
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *
+ * RETURNS:
+ *   TRUE if a replay command is still in progress
+ *   FALSE if no replay command is active
+ *********************************************************************/
+boolean
+    yangcli_replay_check (server_cb_t *server_cb)
+{
+    replay_cb_t *job = server_cb->replay_cb;
+    if (job == NULL) {
+        return FALSE;
+    }
+
+    if (mgr_shutdown_requested()) {
+        server_cb->replay_cb = NULL;
+        free_replay_cb(job);
+        return FALSE;
+    }
+
+    if (job->in_flight) {
+        check_timeouts(job);
+    }
+
+    send_requests(server_cb, job);
+
+    if (job->in_flight) {
+        return TRUE;
+    }
+
+    uint32 i;
+    for (i = 0; i < job->stream_count; i++) {
+        if (!stream_done(job, &job->streams[i])) {
+            /* waiting for the next step to be due */
+            return TRUE;
+        }
+    }
+
+    /* nothing outstanding and nothing left to send */
+    server_cb->replay_cb = NULL;
+    print_report(job);
+    free_replay_cb(job);
+    return FALSE;
+
+}  /* yangcli_replay_check */
+
+
+/********************************************************************
+ * FUNCTION yangcli_replay_cleanup
+ *
+ * Cleanup the replay command for a server context
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *********************************************************************/
+void
+    yangcli_replay_cleanup (server_cb_t *server_cb)
+{
+    if (server_cb->replay_cb) {
+        free_replay_cb(server_cb->replay_cb);
+        server_cb->replay_cb = NULL;
+    }
+
+}  /* yangcli_replay_cleanup */
+
+
+/* END yangcli_replay.c */
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_yangcli_replay
+#define _H_yangcli_replay
+/*  FILE: yangcli_replay.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+   implement yangcli replay command
+
+   The replay command sends the steps of recorded tests to
+   every session in a session group, as fast as possible or
+   at a scaled recorded rate, and prints the ops/sec and
+   latency percentiles for the run.
+
+*/
+
+#include <xmlstring.h>
+
+#include "obj.h"
+#include "status.h"
+#include "yangcli.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+*                                                                   *
+*                      F U N C T I O N S                            *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+ * FUNCTION do_replay (local RPC)
+ *
+ * replay suite-name=name [test-name=name] group=name
+ *        [pipeline=N] [rate=percent] [iterations=N]
+ *
+ * Handle the replay command
+ * The requests are sent and the command stays active until
+ * yangcli_replay_check reports that all of them are done
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *    rpc == RPC method for the replay command
+ *    line == CLI input in progress
+ *    len == offset into line buffer to start parsing
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+extern status_t
+    do_replay (server_cb_t *server_cb,
+               obj_template_t *rpc,
+               const xmlChar *line,
+               uint32  len);
+
+
+/********************************************************************
+ * FUNCTION yangcli_replay_check
+ *
+ * Run one step of the replay command in progress
+ * Called by the STDIN handler on each pass through the IO loop
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *
+ * RETURNS:
+ *   TRUE if a replay command is still in progress
+ *   FALSE if no replay command is active
+ *********************************************************************/
+extern boolean
+    yangcli_replay_check (server_cb_t *server_cb);
+
+
+/********************************************************************
+ * FUNCTION yangcli_replay_cleanup
+ *
+ * Cleanup the replay command for a server context
+ *
+ * INPUTS:
+ *    server_cb == server control block to use
+ *********************************************************************/
+extern void
+    yangcli_replay_cleanup (server_cb_t *server_cb);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif            /* _H_yangcli_replay */
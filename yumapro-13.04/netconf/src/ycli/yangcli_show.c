@@ -856,6 +856,16 @@ status_t
             done = TRUE;
         }
 
+        /* show rpc-stats */
+        if (!done) {
+            parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_RPC_STATS);
+            if (parm) {
+                res = send_xpath_get_to_server(server_cb, 
+                                               YANGCLI_RPC_STATS_PATH);
+                done = TRUE;
+            }
+        }
+
         /* show system */
         parm = val_find_child(valset, YANGCLI_MOD, YANGCLI_SYSTEM);
         if (parm) {
@@ -681,9 +681,24 @@ static status_t
         int word_end,
         int cmdlen)
 {
-    obj_template_t * modObj = ncx_get_first_object(mod);
-    for (; modObj != NULL; 
-         modObj = ncx_get_next_object(mod, modObj)) {
+    /* get the objects that start with the partial name */
+    status_t res = NO_ERR;
+    uint32 objcount = 0;
+    obj_template_t **objindex =
+        ncx_find_object_prefix(mod, (const xmlChar *)&line[word_start],
+                               (cmdlen > 0) ? (uint32)cmdlen : 0,
+                               &objcount, &res);
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    uint32 i;
+    for (i = 0; i < objcount; i++) {
+        obj_template_t *modObj = objindex[i];
+
+        if (!obj_is_enabled(modObj)) {
+            continue;
+        }
 
         if (!obj_is_data_db(modObj)) {
             /* object is either rpc or notification*/
@@ -691,11 +706,6 @@ static status_t
         }
 
         const xmlChar *pathname = obj_get_name(modObj);
-        /* check if there is a partial command name */
-        if (cmdlen > 0 && strncmp((const char *)pathname, 
-                                  &line[word_start], cmdlen)) {
-            continue;
-        }
 
 #ifdef DEBUG_TRACE
         log_debug("\nFilling from module %s, object %s", 
@@ -981,16 +991,6 @@ static status_t
         toponly = TRUE;
     }
 
-    if (session_cb->config_mode && !comstate->do_command) {
-        if (!ncx_mod_has_data_nodes(mod, TRUE, FALSE)) {
-            return NO_ERR;
-        }
-    } else {
-        if (!ncx_mod_has_rpcs(mod)) {
-            return NO_ERR;
-        }
-    }
-
 #ifdef DEBUG_TRACE
     log_debug("\nFill one module '%s' toponly=%d mod-yangcli=%d",
               mod->name, (int)toponly,
@@ -1003,12 +1003,27 @@ static status_t
     boolean complete_word = ((word_start + cmdlen) < word_end);
     boolean servermode = (get_program_mode() == PROG_MODE_SERVER);
 
+    /* get the objects in the module that start with the
+     * partial command name from the module name index   */
+    status_t res = NO_ERR;
+    uint32 objcount = 0;
+    obj_template_t **objindex =
+        ncx_find_object_prefix(mod, (const xmlChar *)&line[word_start],
+                               (cmdlen > 0) ? (uint32)cmdlen : 0,
+                               &objcount, &res);
+    if (res != NO_ERR) {
+        return res;
+    }
+
     /* check all the OBJ_TYP_RPC objects in the module
      * or check data nodes if this is config mode    */
-    obj_template_t *obj;
-    for (obj = ncx_get_first_object(mod);
-         obj != NULL;
-         obj = ncx_get_next_object(mod, obj)) {
+    uint32 i;
+    for (i = 0; i < objcount; i++) {
+        obj_template_t *obj = objindex[i];
+
+        if (!obj_is_enabled(obj)) {
+            continue;
+        }
 
         if (session_cb->config_mode && !comstate->do_command) {
             if (!obj_is_data_db(obj) || !obj_is_config(obj)) {
@@ -1020,7 +1035,6 @@ static status_t
             }
         }
 
-        status_t res = NO_ERR;
         const xmlChar *cmdname = obj_get_name(obj);
 
         /* check for top commands -- commands that can be entered even
@@ -1042,13 +1056,6 @@ static status_t
             continue;
         }
 
-        /* check if there is a partial command name */
-        if (cmdlen > 0 &&
-            strncmp((const char *)cmdname, &line[word_start], cmdlen)) {
-            /* command start is not the same so skip it */
-            continue;
-        }
-
         /* found a matching object */
         if (session_cb->config_mode && !comstate->do_command &&
             complete_word) {
@@ -56,6 +56,7 @@ date         init     comment
 #include  <stdio.h>
 #include  <stdlib.h>
 #include  <string.h>
+#include  <sys/time.h>
 
 #include "procdefs.h"
 #include "conf.h"
@@ -76,7 +77,13 @@ date         init     comment
 #include "yangcli_util.h"
 #include "xml_util.h"
 #include "xml_wr.h"
+#include "mgr.h"
 #include "mgr_load.h"
+#include "mgr_rpc.h"
+#include "mgr_ses.h"
+#include "tstamp.h"
+#include "yangcli_fanout.h"
+#include "yangcli_ut_report.h"
 
 
 /********************************************************************
@@ -103,6 +110,40 @@ date         init     comment
 *                                                                    *
 *********************************************************************/
 
+/* state of one run-test entry in a parallel test-suite run */
+typedef enum ut_run_state_t_ {
+    UT_RUN_PENDING,
+    UT_RUN_ACTIVE,
+    UT_RUN_DONE
+} ut_run_state_t;
+
+
+/* one session in the pool for a parallel test-suite run
+ * the steps of the test in progress are sent to this session
+ * unless the step has a session-name
+ */
+typedef struct ut_slot_t_ {
+    const xmlChar      *name;          /* backptr into job sessions */
+    session_cb_t       *session_cb;    /* backptr to pool session */
+    run_test_t         *run_test;      /* backptr; NULL if idle */
+    uint32              run_index;     /* index into job states */
+    yangcli_ut_step_t  *step;          /* backptr to step in progress */
+    ses_id_t            sid;           /* session the step was sent to */
+    uint32              waiting;       /* replies outstanding */
+} ut_slot_t;
+
+
+/* parallel test-suite run control block */
+typedef struct ut_parallel_cb_t_ {
+    xmlChar            *sessions;      /* malloced session names */
+    ut_slot_t          *slots;         /* malloced array */
+    uint32              slot_count;
+    ut_run_state_t     *states;        /* malloced; 1 per run-test */
+    uint32              run_count;
+    uint32              active;
+    time_t              last_check;
+} ut_parallel_cb_t;
+
 
 /********************************************************************
 *                                                                   *
@@ -127,6 +168,10 @@ static void
 static boolean
     any_test_step_errors (yangcli_ut_test_t *test);
 
+static status_t
+    start_parallel_tests (server_cb_t *server_cb,
+                          yangcli_ut_context_t *context);
+
 
 /********************************************************************
 * FUNCTION  update_mustpass_list
@@ -290,6 +335,69 @@ static response_type_t
 }  /* get_response_type */
 
 
+/********************************************************************
+* FUNCTION elapsed_usec
+*
+* Get the microseconds since a start time
+*
+* INPUTS:
+*    start == start time
+*
+* RETURNS:
+*   elapsed microseconds; 0 if the clock went backwards
+*********************************************************************/
+static uint64
+    elapsed_usec (const struct timeval *start)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    int64 usec = (int64)(now.tv_sec - start->tv_sec) * 1000000 +
+        (int64)(now.tv_usec - start->tv_usec);
+    return (usec > 0) ? (uint64)usec : 0;
+
+}  /* elapsed_usec */
+
+
+/********************************************************************
+* FUNCTION start_step_timer
+*
+* Save the start time for a test step
+*
+* INPUTS:
+*    step == test step that is being sent
+*********************************************************************/
+static void
+    start_step_timer (yangcli_ut_step_t *step)
+{
+    gettimeofday(&step->start_time, NULL);
+    tstamp_datetime(step->start_tstamp);
+    step->stop_tstamp[0] = 0;
+    step->latency_usec = 0;
+
+}  /* start_step_timer */
+
+
+/********************************************************************
+* FUNCTION stop_step_timer
+*
+* Save the latency for a test step, if not already done
+*
+* INPUTS:
+*    step == test step that is done
+*********************************************************************/
+static void
+    stop_step_timer (yangcli_ut_step_t *step)
+{
+    if (step->start_tstamp[0] == 0 || step->stop_tstamp[0] != 0) {
+        return;
+    }
+    step->latency_usec = elapsed_usec(&step->start_time);
+    tstamp_datetime(step->stop_tstamp);
+
+}  /* stop_step_timer */
+
+
 /********************************************************************
 * FUNCTION start_setup_banner
 *
@@ -369,6 +477,7 @@ static void
     }
 
    context->cur_run_test->test->test_errors = FALSE;
+   gettimeofday(&context->cur_run_test->test->start_time, NULL);
 
 }  /* start_test_banner */
 
@@ -397,6 +506,8 @@ static void
         log_info_append("%s\n", line);
     }
 
+    start_step_timer(context->cur_step);
+
 }  /* start_step_banner */
 
 
@@ -411,10 +522,15 @@ static void
 static void
     report_test_results (yangcli_ut_context_t *context)
 {
-    // TBD add timstamp, more details
-    log_info("\nTest  %s/%s done\n", 
+    yangcli_ut_test_t *test = context->cur_run_test->test;
+    if (test->test_started) {
+        test->wall_usec = elapsed_usec(&test->start_time);
+    }
+
+    log_info("\nTest  %s/%s done (%.3f sec)\n", 
              context->cur_suite->name,
-             context->cur_run_test->run_test_name);
+             context->cur_run_test->run_test_name,
+             (double)test->wall_usec / 1000000.0);
 
     /*
      *  Update must_pass lists,
@@ -454,13 +570,16 @@ static void
 * FUNCTION next_suite_to_run
 *
 * INPUTS:
+*    server_cb == server control block to use
 *    context == unit test context control block to use
 * OUTPUTS:
 *   pointer to line to use or NULL if no next suite to run 
+*   or the tests are run in parallel
 *********************************************************************/
 static xmlChar*
-    next_suite_to_run (yangcli_ut_context_t *context,
-                      status_t *res)
+    next_suite_to_run (server_cb_t *server_cb,
+                       yangcli_ut_context_t *context,
+                       status_t *res)
 {
     xmlChar *line = NULL;
 
@@ -514,6 +633,7 @@ static xmlChar*
     context->ut_status = NO_ERR;
     suite->suite_started = TRUE;
     suite->suite_errors = FALSE;
+    gettimeofday(&suite->start_time, NULL);
 
     start_suite_banner(context);
 
@@ -523,6 +643,10 @@ static xmlChar*
             dlq_firstEntry(&suite->setup_rawlineQ);
         start_setup_banner(context);
         line = get_full_rawline(context, res);
+    } else if (context->session_group) {
+        /* the tests are sent by yangcli_ut_parallel_check */
+        context->ut_state = UT_STATE_RUNTEST;
+        *res = start_parallel_tests(server_cb, context);
     } else {
         context->ut_state = UT_STATE_RUNTEST;
         start_test_banner(context);
@@ -566,6 +690,46 @@ static void
 }  /* report_wrong_response_type */
 
 
+/********************************************************************
+* FUNCTION write_test_reports
+*
+* Write the JUnit and JSON reports requested for the test-suite run
+
+* INPUTS: 
+*    context == unit test context control block to use
+*********************************************************************/
+static void
+    write_test_reports (yangcli_ut_context_t *context)
+{
+    status_t res;
+
+    if (context->junit_report) {
+        res = yangcli_ut_write_junit_report(context, context->junit_report);
+        if (res == NO_ERR) {
+            log_info("\nWrote JUnit test report to '%s'\n",
+                     context->junit_report);
+        } else {
+            log_error("\nError: write JUnit test report to '%s' "
+                      "failed (%s)\n", context->junit_report,
+                      get_error_string(res));
+        }
+    }
+
+    if (context->json_report) {
+        res = yangcli_ut_write_json_report(context, context->json_report);
+        if (res == NO_ERR) {
+            log_info("\nWrote JSON test report to '%s'\n",
+                     context->json_report);
+        } else {
+            log_error("\nError: write JSON test report to '%s' "
+                      "failed (%s)\n", context->json_report,
+                      get_error_string(res));
+        }
+    }
+
+}  /* write_test_reports */
+
+
 /********************************************************************
 * FUNCTION finish_test_suite
 *
@@ -598,10 +762,16 @@ static boolean
        }
     }
 
+    context->cur_suite->wall_usec =
+        elapsed_usec(&context->cur_suite->start_time);
     context->ut_state = UT_STATE_DONE;
     context->ut_input_mode = FALSE;
     report_suite_results(context);
 
+    if (final_finish) {
+        write_test_reports(context);
+    }
+
     return final_finish;
 
 }  /* finish_test_suite */
@@ -842,6 +1012,52 @@ static void
 
 }  /* validate_reply_data */
 
+
+/********************************************************************
+* FUNCTION check_step_reply
+*
+* Check the <rpc-reply> received for the current test step
+*
+* INPUTS: 
+*    server_cb == server control block to use
+*    context == unit test context control block to use
+*    resp_type == response type that was received
+*    rpydata == response message
+*********************************************************************/
+static void
+    check_step_reply (server_cb_t *server_cb,
+                      yangcli_ut_context_t *context,
+                      response_type_t resp_type,
+                      val_value_t *rpydata)
+{
+    stop_step_timer(context->cur_step);
+    context->cur_step->step_done = TRUE;
+    context->cur_step->step_result = resp_type;
+    if (context->cur_step->result_type != resp_type) {
+        /* did not get the correct response type */
+        context->cur_step->step_result_wrong = TRUE;
+        report_wrong_response_type(context, resp_type);
+    } else {
+        switch (context->cur_step->result_type) {
+        case UT_RPC_NO:
+        case UT_RPC_OK:
+        case UT_RPC_ANY:
+            break;
+        case UT_RPC_ERROR:
+            // check the fields in the error response
+            validate_step_rpc_error(context, rpydata);
+            break;
+        case UT_RPC_DATA:
+            // check the data 
+            validate_reply_data(server_cb, context, rpydata);
+            break;
+        default:
+            SET_ERROR(ERR_INTERNAL_VAL);
+        }
+    }
+
+}  /* check_step_reply */
+
 /********************************************************************
 * FUNCTION ut_state_busy
 *
@@ -1106,6 +1322,10 @@ static void
             log_info_append(" [%s]", status);
         }
   //      log_info_append(" [%s]", status);
+        if (step->stop_tstamp[0]) {
+            log_info_append(" (%.3f ms)",
+                            (double)step->latency_usec / 1000.0);
+        }
     }
 
     if (mode != HELP_MODE_BRIEF) {
@@ -1225,6 +1445,10 @@ static void
             status = (const xmlChar *)"NOT RUN";
         }
         log_info_append(" [%s]", status);
+        if (test->wall_usec) {
+            log_info_append(" (%.3f sec)",
+                            (double)test->wall_usec / 1000000.0);
+        }
     }
 
     if (mode != HELP_MODE_BRIEF) {
@@ -1741,6 +1965,13 @@ static yangcli_ut_step_t *
         }
     }
 
+    /* optional recorded delay */
+    step_parm = val_find_child(val, YANGCLI_TEST_MOD,
+                               ut_suite_test_step_delay);
+    if (step_parm) {
+        step->delay_msec = VAL_UINT(step_parm);
+    }
+
     /* rpc-reply-data */
 
     /* ignore optional data parms unless the result_type_is_data */
@@ -2302,6 +2533,19 @@ static val_value_t *
     }
     val_add_child(chval, step_val);
 
+    /* The optional step/delay leaf */
+    if (step->delay_msec) {
+        xmlChar numbuff[NCX_MAX_NUMLEN];
+        snprintf((char *)numbuff, sizeof(numbuff), "%u", step->delay_msec);
+        chval = make_child_leaf_ut(step_obj, ut_suite_test_step_delay,
+                                   numbuff, res);
+        if (chval == NULL) {
+            val_free_value(step_val);
+            return NULL;
+        }
+        val_add_child(chval, step_val);
+    }
+
      /* The result type of this step. */
      if (step->result_type) {
         const xmlChar *resp_typ_str =
@@ -2623,6 +2867,745 @@ static val_value_t *
 } /* save_suite_val */
 
 
+/********************************************************************
+* FUNCTION free_parallel_cb
+*
+* Free a parallel test-suite run control block
+* Any replies still outstanding are dropped by the reply handler
+*
+* INPUTS:
+*    job == parallel run control block to free
+*********************************************************************/
+static void
+    free_parallel_cb (ut_parallel_cb_t *job)
+{
+    m__free(job->sessions);
+    m__free(job->slots);
+    m__free(job->states);
+    m__free(job);
+
+}  /* free_parallel_cb */
+
+
+/********************************************************************
+* FUNCTION add_parallel_slots
+*
+* Setup the session pool from the session names in the group
+* Sessions that are not connected and idle are skipped
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    context == unit test context control block to use
+*    job == parallel run control block to use
+*    group == session group to use
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_parallel_slots (server_cb_t *server_cb,
+                        yangcli_ut_context_t *context,
+                        ut_parallel_cb_t *job,
+                        const session_group_t *group)
+{
+    job->sessions = xml_strdup(group->sessions);
+    if (job->sessions == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    /* count the names and split them in place */
+    uint32 count = 0;
+    xmlChar *str = job->sessions;
+    while (*str) {
+        while (*str && xml_isspace(*str)) {
+            *str++ = 0;
+        }
+        if (*str) {
+            count++;
+        }
+        while (*str && !xml_isspace(*str)) {
+            str++;
+        }
+    }
+
+    if (context->parallel && context->parallel < count) {
+        count = context->parallel;
+    }
+    if (count == 0) {
+        log_error("\nError: session group '%s' is empty\n", group->name);
+        return ERR_NCX_EMPTY_VAL;
+    }
+
+    job->slots = m__getMem(count * sizeof(ut_slot_t));
+    if (job->slots == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    memset(job->slots, 0x0, count * sizeof(ut_slot_t));
+
+    const xmlChar *end = job->sessions + xml_strlen(group->sessions);
+    str = job->sessions;
+    while (str < end && job->slot_count < count) {
+        while (str < end && *str == 0) {
+            str++;
+        }
+        if (str >= end) {
+            break;
+        }
+
+        session_cb_t *session_cb = find_session_cb(server_cb, str);
+        if (session_cb == NULL) {
+            log_warn("\nWarning: session '%s' not found; skipped\n", str);
+        } else if (!session_connected(session_cb)) {
+            log_warn("\nWarning: session '%s' not connected; skipped\n",
+                     str);
+        } else if (session_cb->state != MGR_IO_ST_CONN_IDLE ||
+                   session_cb->command_mode != CMD_MODE_NORMAL) {
+            log_warn("\nWarning: session '%s' busy; skipped\n", str);
+        } else {
+            ut_slot_t *slot = &job->slots[job->slot_count++];
+            slot->name = str;
+            slot->session_cb = session_cb;
+        }
+        str += xml_strlen(str);
+    }
+
+    if (job->slot_count == 0) {
+        log_error("\nError: no session in group '%s' can be used\n",
+                  group->name);
+        return ERR_NCX_SESSION_CLOSED;
+    }
+    return NO_ERR;
+
+}  /* add_parallel_slots */
+
+
+/********************************************************************
+* FUNCTION step_session
+*
+* Get the session that a test step will be sent to
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    slot == pool session running the test
+*    step == test step to check
+*
+* RETURNS:
+*   back-pointer to the session or NULL if not found
+*********************************************************************/
+static session_cb_t *
+    step_session (server_cb_t *server_cb,
+                  const ut_slot_t *slot,
+                  const yangcli_ut_step_t *step)
+{
+    if (step->session_name) {
+        return find_session_cb(server_cb, step->session_name);
+    }
+    return slot->session_cb;
+
+}  /* step_session */
+
+
+/********************************************************************
+* FUNCTION test_uses_session
+*
+* Check if any step in a test would be sent to a session
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    slot == pool session running the test
+*    test == test to check
+*    session_cb == session to look for
+*
+* RETURNS:
+*   TRUE if the session is used by the test
+*********************************************************************/
+static boolean
+    test_uses_session (server_cb_t *server_cb,
+                       const ut_slot_t *slot,
+                       const yangcli_ut_test_t *test,
+                       const session_cb_t *session_cb)
+{
+    const yangcli_ut_step_t *step = (const yangcli_ut_step_t *)
+        dlq_firstEntry(&test->step_listQ);
+    for (; step != NULL;
+         step = (const yangcli_ut_step_t *)dlq_nextEntry(step)) {
+        if (step_session(server_cb, slot, step) == session_cb) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+
+}  /* test_uses_session */
+
+
+/********************************************************************
+* FUNCTION parallel_test_blocked
+*
+* Check if a test cannot start in a slot because a session it
+* uses is in use by a test running in another slot
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    job == parallel run control block to use
+*    slot == idle slot to check
+*    test == test to check
+*
+* RETURNS:
+*   TRUE if the test must wait
+*********************************************************************/
+static boolean
+    parallel_test_blocked (server_cb_t *server_cb,
+                           ut_parallel_cb_t *job,
+                           const ut_slot_t *slot,
+                           const yangcli_ut_test_t *test)
+{
+    uint32 i;
+
+    for (i = 0; i < job->slot_count; i++) {
+        const ut_slot_t *other = &job->slots[i];
+        if (other == slot || other->run_test == NULL) {
+            continue;
+        }
+
+        const yangcli_ut_test_t *othertest = other->run_test->test;
+        if (othertest == test) {
+            /* same test listed twice in the run-test list */
+            return TRUE;
+        }
+
+        const yangcli_ut_step_t *step = (const yangcli_ut_step_t *)
+            dlq_firstEntry(&test->step_listQ);
+        for (; step != NULL;
+             step = (const yangcli_ut_step_t *)dlq_nextEntry(step)) {
+            const session_cb_t *session_cb =
+                step_session(server_cb, slot, step);
+            if (session_cb &&
+                test_uses_session(server_cb, other, othertest,
+                                  session_cb)) {
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+
+}  /* parallel_test_blocked */
+
+
+/********************************************************************
+* FUNCTION mustpass_pending
+*
+* Check if a must-pass test listed before a run-test entry
+* has not finished yet
+*
+* INPUTS:
+*    job == parallel run control block to use
+*    suite == test-suite in progress
+*    run_test == run-test entry to check
+*    run_index == index of run_test in the job states
+*
+* RETURNS:
+*   TRUE if the run-test entry must wait for a must-pass test
+*********************************************************************/
+static boolean
+    mustpass_pending (ut_parallel_cb_t *job,
+                      yangcli_ut_suite_t *suite,
+                      run_test_t *run_test,
+                      uint32 run_index)
+{
+    mustpass_t *must = (mustpass_t *)
+        dlq_firstEntry(&run_test->test->mustpass_leaflistQ);
+    for (; must != NULL; must = (mustpass_t *)dlq_nextEntry(must)) {
+        run_test_t *prev = (run_test_t *)
+            dlq_firstEntry(&suite->run_test_leaflistQ);
+        uint32 i = 0;
+        for (; prev != NULL && i < run_index;
+             prev = (run_test_t *)dlq_nextEntry(prev), i++) {
+            if (job->states[i] != UT_RUN_DONE &&
+                !xml_strcmp(prev->run_test_name, must->mustpass_name)) {
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+
+}  /* mustpass_pending */
+
+
+/********************************************************************
+* FUNCTION start_slot_test
+*
+* Start the next test that is ready to run in an idle slot
+* A test is ready when all the must-pass tests listed before it
+* are done, and no session it uses is busy with another test.
+* Tests with a failed must-pass test are skipped.
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    context == unit test context control block to use
+*    job == parallel run control block to use
+*    slot == idle slot to use
+*
+* RETURNS:
+*   TRUE if a test was started
+*********************************************************************/
+static boolean
+    start_slot_test (server_cb_t *server_cb,
+                     yangcli_ut_context_t *context,
+                     ut_parallel_cb_t *job,
+                     ut_slot_t *slot)
+{
+    yangcli_ut_suite_t *suite = context->cur_suite;
+    run_test_t *run_test = (run_test_t *)
+        dlq_firstEntry(&suite->run_test_leaflistQ);
+    uint32 i = 0;
+
+    for (; run_test != NULL;
+         run_test = (run_test_t *)dlq_nextEntry(run_test), i++) {
+        if (job->states[i] != UT_RUN_PENDING ||
+            mustpass_pending(job, suite, run_test, i)) {
+            continue;
+        }
+
+        mustpass_t *must = mustpass_failed_name(run_test->test);
+        if (must) {
+            log_error("\n(%s) will be skipped, its must_pass (%s) failed.",
+                      run_test->run_test_name, must->mustpass_name);
+            job->states[i] = UT_RUN_DONE;
+            continue;
+        }
+
+        if (parallel_test_blocked(server_cb, job, slot, run_test->test)) {
+            continue;
+        }
+
+        job->states[i] = UT_RUN_ACTIVE;
+        job->active++;
+        slot->run_test = run_test;
+        slot->run_index = i;
+        slot->step = NULL;
+
+        context->cur_run_test = run_test;
+        start_test_banner(context);
+        log_info_append("Session: %s\n", slot->name);
+        run_test->test->test_started = TRUE;
+        return TRUE;
+    }
+    return FALSE;
+
+}  /* start_slot_test */
+
+
+/********************************************************************
+* FUNCTION finish_slot_test
+*
+* Finish the test running in a slot
+*
+* INPUTS:
+*    context == unit test context control block to use
+*    job == parallel run control block to use
+*    slot == slot to use
+*********************************************************************/
+static void
+    finish_slot_test (yangcli_ut_context_t *context,
+                      ut_parallel_cb_t *job,
+                      ut_slot_t *slot)
+{
+    context->cur_run_test = slot->run_test;
+    report_test_results(context);
+
+    job->states[slot->run_index] = UT_RUN_DONE;
+    job->active--;
+    slot->run_test = NULL;
+    slot->step = NULL;
+
+}  /* finish_slot_test */
+
+
+/********************************************************************
+* FUNCTION parallel_reply_handler
+*
+* Handle an <rpc-reply> for a step in a parallel test-suite run
+* Matches the mgr_rpc_cbfn_t template
+*
+* INPUTS:
+*   scb == session receiving RPC reply
+*   req == original request returned for freeing or reusing
+*   rpy == reply received from the server (for checking then freeing)
+*********************************************************************/
+static void
+    parallel_reply_handler (ses_cb_t *scb,
+                            mgr_rpc_req_t *req,
+                            mgr_rpc_rpy_t *rpy)
+{
+    server_cb_t *server_cb = get_cur_server_cb();
+    yangcli_ut_context_t *context = 
+        (server_cb) ? get_ut_context(server_cb) : NULL;
+    ut_parallel_cb_t *job = (context) ? context->parallel_cb : NULL;
+    ut_slot_t *slot = NULL;
+
+    if (job && req->group_id && req->group_id <= job->slot_count) {
+        slot = &job->slots[req->group_id - 1];
+        if (!slot->waiting || slot->sid != scb->sid) {
+            /* step was already counted as timed out */
+            slot = NULL;
+        }
+    }
+
+    if (slot) {
+        yangcli_ut_step_t *step = slot->step;
+        mgr_scb_t *mscb = mgr_ses_get_mscb(scb);
+
+        slot->waiting--;
+        if (rpy == NULL || rpy->reply == NULL || mscb == NULL ||
+            mscb->session_cb == NULL) {
+            stop_step_timer(step);
+            step->step_local_error = TRUE;
+        } else {
+            response_type_t resp_type = UT_RPC_DATA;
+            if (val_find_child(rpy->reply, NC_MODULE, NCX_EL_RPC_ERROR)) {
+                resp_type = UT_RPC_ERROR;
+            } else if (val_find_child(rpy->reply, NC_MODULE, NCX_EL_OK)) {
+                resp_type = UT_RPC_OK;
+            }
+
+            /* check the reply as if it was for the current step */
+            session_cb_t *save_session_cb = server_cb->cur_session_cb;
+            set_cur_session_cb(server_cb, mscb->session_cb);
+            ncx_set_temp_modQ(mgr_get_modQ(mscb));
+            context->cur_run_test = slot->run_test;
+            context->cur_step = step;
+
+            check_step_reply(server_cb, context, resp_type, rpy->reply);
+
+            context->cur_run_test = NULL;
+            context->cur_step = NULL;
+            set_cur_session_cb(server_cb, save_session_cb);
+        }
+    }
+
+    mgr_rpc_free_request(req);
+    if (rpy) {
+        mgr_rpc_free_reply(rpy);
+    }
+
+}  /* parallel_reply_handler */
+
+
+/********************************************************************
+* FUNCTION send_slot_step
+*
+* Send the current step of the test running in a slot
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    context == unit test context control block to use
+*    job == parallel run control block to use
+*    slot == slot to use; slot->step is the step to send
+*
+* RETURNS:
+*   status; the test is ended if not NO_ERR
+*********************************************************************/
+static status_t
+    send_slot_step (server_cb_t *server_cb,
+                    yangcli_ut_context_t *context,
+                    ut_parallel_cb_t *job,
+                    ut_slot_t *slot)
+{
+    yangcli_ut_step_t *step = slot->step;
+    session_cb_t *session_cb = step_session(server_cb, slot, step);
+    uint32 reqcount = 0;
+    status_t res = NO_ERR;
+
+    context->cur_run_test = slot->run_test;
+    context->cur_step = step;
+    start_step_banner(context, step->command);
+
+    if (session_cb == NULL || !session_connected(session_cb)) {
+        res = ERR_NCX_SESSION_CLOSED;
+    } else {
+        res = yangcli_fanout_send_line(server_cb, session_cb,
+                                       session_cb->mysid, step->command,
+                                       parallel_reply_handler,
+                                       (uint32)(slot - job->slots) + 1,
+                                       &reqcount);
+        slot->sid = session_cb->mysid;
+        slot->waiting = reqcount;
+    }
+
+    if (res != NO_ERR) {
+        log_error("\nError: step %s in test '%s/%s' failed (%s)\n",
+                  step->name, context->cur_suite->name,
+                  slot->run_test->run_test_name, get_error_string(res));
+        stop_step_timer(step);
+        step->step_local_error = TRUE;
+        slot->run_test->test->test_errors = TRUE;
+        context->cur_suite->suite_errors = TRUE;
+        slot->waiting = 0;
+        return res;
+    }
+
+    if (reqcount == 0) {
+        /* local command that did not send a request */
+        step->step_result = UT_RPC_NO;
+        stop_step_timer(step);
+    }
+    return NO_ERR;
+
+}  /* send_slot_step */
+
+
+/********************************************************************
+* FUNCTION check_parallel_timeouts
+*
+* Expire the steps that have timed out and the steps
+* sent to sessions that have been dropped
+*
+* INPUTS:
+*    job == parallel run control block to use
+*********************************************************************/
+static void
+    check_parallel_timeouts (ut_parallel_cb_t *job)
+{
+    time_t now;
+    uint32 i;
+
+    (void)time(&now);
+    if (now == job->last_check) {
+        /* timeouts are in seconds */
+        return;
+    }
+    job->last_check = now;
+
+    for (i = 0; i < job->slot_count; i++) {
+        ut_slot_t *slot = &job->slots[i];
+        if (!slot->waiting) {
+            continue;
+        }
+
+        /* a session is only used by 1 test at a time, so
+         * a request pending on the session belongs to the step
+         */
+        ses_cb_t *scb = mgr_ses_get_scb(slot->sid);
+        if (scb == NULL || scb->state == SES_ST_SHUTDOWN_REQ) {
+            slot->step->step_local_error = TRUE;
+        } else if (mgr_rpc_timeout_requests(scb)) {
+            slot->step->step_timed_out = TRUE;
+        } else {
+            continue;
+        }
+
+        stop_step_timer(slot->step);
+        slot->waiting = 0;
+    }
+
+}  /* check_parallel_timeouts */
+
+
+/********************************************************************
+* FUNCTION run_parallel_tests
+*
+* Send the next step for every slot that is not waiting for
+* a reply, and start new tests in the idle slots
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    context == unit test context control block to use
+*    job == parallel run control block to use
+*********************************************************************/
+static void
+    run_parallel_tests (server_cb_t *server_cb,
+                        yangcli_ut_context_t *context,
+                        ut_parallel_cb_t *job)
+{
+    uint32 i;
+
+    check_parallel_timeouts(job);
+
+    for (i = 0; i < job->slot_count; i++) {
+        ut_slot_t *slot = &job->slots[i];
+
+        while (!slot->waiting) {
+            if (slot->run_test == NULL &&
+                !start_slot_test(server_cb, context, job, slot)) {
+                break;
+            }
+
+            if (slot->step == NULL) {
+                slot->step = (yangcli_ut_step_t *)
+                    dlq_firstEntry(&slot->run_test->test->step_listQ);
+            } else {
+                slot->step = (yangcli_ut_step_t *)
+                    dlq_nextEntry(slot->step);
+            }
+
+            if (slot->step == NULL ||
+                send_slot_step(server_cb, context, job, slot) != NO_ERR) {
+                finish_slot_test(context, job, slot);
+            }
+        }
+    }
+
+    context->cur_run_test = NULL;
+    context->cur_step = NULL;
+
+}  /* run_parallel_tests */
+
+
+/********************************************************************
+* FUNCTION start_parallel_tests
+*
+* Start running the tests of the current test-suite in parallel
+* on the sessions in the session group.
+* The steps are sent by yangcli_ut_parallel_check
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    context == unit test context control block to use
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    start_parallel_tests (server_cb_t *server_cb,
+                          yangcli_ut_context_t *context)
+{
+    const session_group_t *group = 
+        yangcli_find_session_group(server_cb, context->session_group);
+    if (group == NULL) {
+        log_error("\nError: session group '%s' not found\n",
+                  context->session_group);
+        context->ut_state = UT_STATE_ERROR;
+        return ERR_NCX_NOT_FOUND;
+    }
+
+    ut_parallel_cb_t *job = m__getObj(ut_parallel_cb_t);
+    if (job == NULL) {
+        context->ut_state = UT_STATE_ERROR;
+        return ERR_INTERNAL_MEM;
+    }
+    memset(job, 0x0, sizeof(ut_parallel_cb_t));
+
+    status_t res = add_parallel_slots(server_cb, context, job, group);
+    if (res == NO_ERR) {
+        job->run_count = 
+            dlq_count(&context->cur_suite->run_test_leaflistQ);
+        if (job->run_count) {
+            job->states = m__getMem(job->run_count * 
+                                    sizeof(ut_run_state_t));
+            if (job->states == NULL) {
+                res = ERR_INTERNAL_MEM;
+            } else {
+                memset(job->states, 0x0, 
+                       job->run_count * sizeof(ut_run_state_t));
+            }
+        }
+    }
+
+    if (res != NO_ERR) {
+        free_parallel_cb(job);
+        context->ut_state = UT_STATE_ERROR;
+        return res;
+    }
+
+    log_info("\nRunning %u tests in test-suite '%s' on %u sessions "
+             "in group '%s'\n", job->run_count, context->cur_suite->name,
+             job->slot_count, group->name);
+
+    context->cur_run_test = NULL;
+    context->cur_step = NULL;
+    context->parallel_cb = job;
+    return NO_ERR;
+
+}  /* start_parallel_tests */
+
+
+/********************************************************************
+* FUNCTION replace_run_option
+*
+* Replace a string run option with the value of a parameter
+*
+* INPUTS:
+*    valset == test-suite command parameters
+*    name == name of the parameter
+*    option == address of the run option to replace
+*
+* OUTPUTS:
+*    *option == malloced parameter value or NULL if not set
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    replace_run_option (val_value_t *valset,
+                        const xmlChar *name,
+                        xmlChar **option)
+{
+    m__free(*option);
+    *option = NULL;
+
+    val_value_t *parm = val_find_child(valset, YANGCLI_MOD, name);
+    if (parm && parm->res == NO_ERR) {
+        *option = xml_strdup(VAL_STR(parm));
+        if (*option == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+    }
+    return NO_ERR;
+
+}  /* replace_run_option */
+
+
+/********************************************************************
+* FUNCTION set_run_options
+*
+* Set the run options for a test-suite start or run-all command
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    context == unit test context control block to use
+*    valset == test-suite command parameters
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    set_run_options (server_cb_t *server_cb,
+                     yangcli_ut_context_t *context,
+                     val_value_t *valset)
+{
+    status_t res = replace_run_option(valset, YANGCLI_SESSION_GROUP,
+                                      &context->session_group);
+    if (res == NO_ERR) {
+        res = replace_run_option(valset, YANGCLI_JUNIT_REPORT,
+                                 &context->junit_report);
+    }
+    if (res == NO_ERR) {
+        res = replace_run_option(valset, YANGCLI_JSON_REPORT,
+                                 &context->json_report);
+    }
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    context->parallel = 0;
+    val_value_t *parm = 
+        val_find_child(valset, YANGCLI_MOD, YANGCLI_PARALLEL);
+    if (parm && parm->res == NO_ERR) {
+        context->parallel = VAL_UINT(parm);
+    }
+
+    if (context->session_group &&
+        yangcli_find_session_group(server_cb,
+                                   context->session_group) == NULL) {
+        log_error("\nError: session group '%s' not found\n",
+                  context->session_group);
+        return ERR_NCX_NOT_FOUND;
+    }
+    return NO_ERR;
+
+}  /* set_run_options */
+
+
 /**************    E X T E R N A L   F U N C T I O N S **********/
 
 /********************************************************************
@@ -2859,6 +3842,10 @@ extern void
     context->cur_run_test = NULL;
     context->cur_step = NULL;
     context->cur_rawline = NULL;
+    if (context->parallel_cb) {
+        free_parallel_cb(context->parallel_cb);
+        context->parallel_cb = NULL;
+    }
 
 }  /* clean_context */
 
@@ -2884,6 +3871,12 @@ extern void
     m__free(context->logfile);
     m__free(context->test_sesname);
     m__free(context->linebuff);
+    m__free(context->session_group);
+    m__free(context->junit_report);
+    m__free(context->json_report);
+    if (context->parallel_cb) {
+        free_parallel_cb(context->parallel_cb);
+    }
     memset(context, 0x0, sizeof(yangcli_ut_context_t));
 
 }  /* free_context_cache */
@@ -3392,8 +4385,11 @@ status_t
                     if (logparm) {
                         logparmval = VAL_STR(logparm);
                     }
-                    res = yangcli_ut_start(server_cb, parmval,
-                                                  logparmval);
+                    res = set_run_options(server_cb, context, valset);
+                    if (res == NO_ERR) {
+                        res = yangcli_ut_start(server_cb, parmval,
+                                               logparmval);
+                    }
                 }
                 done = TRUE;
             }
@@ -3877,6 +4873,7 @@ status_t
     /* setup state to start test */
     suite->suite_errors = FALSE;
     suite->suite_started = TRUE;
+    gettimeofday(&suite->start_time, NULL);
     if (!dlq_empty(&suite->setup_rawlineQ)) {
         context->ut_state = UT_STATE_SETUP;
     } else {
@@ -3968,6 +4965,11 @@ xmlChar *
         }
         // fall through it done with setup phase
     case UT_STATE_RUNTEST:
+        if (context->session_group && context->parallel_cb == NULL) {
+            /* the steps are sent by yangcli_ut_parallel_check */
+            *res = start_parallel_tests(server_cb, context);
+            return NULL;
+        }
         if (test == NULL) {
             done = TRUE;
         }
@@ -3978,6 +4980,8 @@ xmlChar *
                 start_test_banner(context);
                 test->test_started = TRUE;
             } else {
+                /* local command steps are done now */
+                stop_step_timer(context->cur_step);
                 context->cur_step = (yangcli_ut_step_t *)
                     dlq_nextEntry(context->cur_step);
             }
@@ -4020,7 +5024,7 @@ xmlChar *
         if (context->ut_state != UT_STATE_CLEANUP) {
             if (line == NULL) {
                 if (context->single_suite == FALSE) {
-                    line = next_suite_to_run (context, res);
+                    line = next_suite_to_run(server_cb, context, res);
                 }
             }
             break;
@@ -4031,7 +5035,9 @@ xmlChar *
         if (context->cur_rawline == NULL) {
             context->cur_rawline = (rawline_t *)
                 dlq_firstEntry(&suite->cleanup_rawlineQ);
-            start_cleanup_banner(context);
+            if (context->cur_rawline != NULL) {
+                start_cleanup_banner(context);
+            }
         } else {
             context->cur_rawline = (rawline_t *)
                 dlq_nextEntry(context->cur_rawline);
@@ -4048,7 +5054,7 @@ xmlChar *
              *res = ERR_NCX_SKIPPED;
              return NULL;
          } else {
-             line = next_suite_to_run (context, res);
+             line = next_suite_to_run(server_cb, context, res);
          } 
 
         break;
@@ -4134,6 +5140,13 @@ void
                  suite->name, get_error_string(res));
     } else if (killtest) {
         /* skip to the next test */
+        if (step) {
+            step->step_local_error = TRUE;
+            stop_step_timer(step);
+        }
+        if (test && test->test_started) {
+            test->wall_usec = elapsed_usec(&test->start_time);
+        }
         context->cur_step = NULL;
         if (context->cur_run_test) {
            run_test_t *run_test = (run_test_t *)
@@ -4184,31 +5197,8 @@ void
         break;
     case UT_STATE_RUNTEST:
         if (context->cur_step != NULL) {
-            context->cur_step->step_done = TRUE;
-            context->cur_step->step_result = resp_type;
-            if (context->cur_step->result_type != resp_type) {
-                /* did not get the correct response type */
-                context->cur_step->step_result_wrong = TRUE;
-                report_wrong_response_type(context, resp_type);
-            } else {
-                switch (context->cur_step->result_type) {
-                case UT_RPC_NO:
-                case UT_RPC_OK:
-                case UT_RPC_ANY:
-                    break;
-                case UT_RPC_ERROR:
-                    // check the fields in the error response
-                    validate_step_rpc_error(context, rpydata);
-                    break;
-                case UT_RPC_DATA:
-                    // check the data 
-                    validate_reply_data(server_cb, context, rpydata);
-                    break;
-                default:
-                    SET_ERROR(ERR_INTERNAL_VAL);
-                }
-            }
-        }  // else internal error?
+            check_step_reply(server_cb, context, resp_type, rpydata);
+        }  // else internal error or parallel run
         break;
     default:
         SET_ERROR(ERR_INTERNAL_VAL);
@@ -4294,6 +5284,14 @@ void
                  context->cur_suite->name,
                  (errstring) ? errstring : 
                  (const xmlChar *)get_error_string(context->ut_status));
+
+        if (context->parallel_cb) {
+            free_parallel_cb(context->parallel_cb);
+            context->parallel_cb = NULL;
+        }
+        context->cur_suite->wall_usec =
+            elapsed_usec(&context->cur_suite->start_time);
+        write_test_reports(context);
     } else {
         log_error("\nError: no test-suite is active");
     }
@@ -4301,5 +5299,76 @@ void
 }  /* yangcli_ut_stop */
 
 
+/********************************************************************
+* FUNCTION yangcli_ut_parallel_active
+*
+* Check if a parallel test-suite run is in progress
+*
+* INPUTS:
+*   server_cb == server context to use
+*
+* RETURNS:
+*   TRUE if tests are running on the session group
+*********************************************************************/
+boolean
+    yangcli_ut_parallel_active (server_cb_t *server_cb)
+{
+    yangcli_ut_context_t *context = get_ut_context(server_cb);
+    return (context->parallel_cb) ? TRUE : FALSE;
+
+}  /* yangcli_ut_parallel_active */
+
+
+/********************************************************************
+* FUNCTION yangcli_ut_parallel_check
+*
+* Run the parallel test-suite run in progress, if any
+* Expires timed out steps, sends the next steps and starts
+* new tests on the idle sessions.
+* When all tests are done the test-suite moves to the
+* cleanup phase, which is run from the start session.
+*
+* INPUTS:
+*   server_cb == server context to use
+*
+* RETURNS:
+*   TRUE if tests are still running and the CLI must wait
+*   FALSE if no parallel run is in progress
+*********************************************************************/
+boolean
+    yangcli_ut_parallel_check (server_cb_t *server_cb)
+{
+    yangcli_ut_context_t *context = get_ut_context(server_cb);
+    ut_parallel_cb_t *job = context->parallel_cb;
+    if (job == NULL) {
+        return FALSE;
+    }
+
+    if (mgr_shutdown_requested()) {
+        free_parallel_cb(job);
+        context->parallel_cb = NULL;
+        return FALSE;
+    }
+
+    run_parallel_tests(server_cb, context, job);
+    if (job->active) {
+        return TRUE;
+    }
+
+    uint64 usec = elapsed_usec(&context->cur_suite->start_time);
+    log_info("\nAll tests in test-suite '%s' done (%.3f sec)\n",
+             context->cur_suite->name, (double)usec / 1000000.0);
+
+    free_parallel_cb(job);
+    context->parallel_cb = NULL;
+    context->cur_run_test = NULL;
+    context->cur_step = NULL;
+    context->cur_rawline = NULL;
+    context->ut_state = UT_STATE_CLEANUP;
+    return FALSE;
+
+}  /* yangcli_ut_parallel_check */
+
+
 
 /* END file yangcli_unit_test.c */
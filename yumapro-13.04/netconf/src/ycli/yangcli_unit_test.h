@@ -60,7 +60,7 @@ extern "C" {
 *********************************************************************/
 /* these 3 constants not used */
 #define ut_M_test (const xmlChar *)"yumaworks-test"
-#define ut_R_test (const xmlChar *)"2013-03-31"
+#define ut_R_test (const xmlChar *)"2026-10-19"
 #define ut_test_suites (const xmlChar *) "test-suites"
 
 #define ut_suite      (const xmlChar *) "test-suite"
@@ -87,6 +87,7 @@ extern "C" {
 #define ut_suite_test_step_result_error_info \
     (const xmlChar *) "result-error-info"
 #define ut_suite_test_step_command (const xmlChar *) "command"
+#define ut_suite_test_step_delay (const xmlChar *) "delay"
 
 #define ut_suite_test_step_result_data_type \
     (const xmlChar *) "result-data-type"
@@ -421,6 +422,36 @@ extern void
                      status_t res,
                      const xmlChar *errstring);
 
+/********************************************************************
+ * FUNCTION yangcli_ut_parallel_active
+ *
+ * Check if a parallel test-suite run is in progress
+ *
+ * INPUTS:
+ *   server_cb == server context to use
+ *
+ * RETURNS:
+ *   TRUE if tests are running on the session group
+ *********************************************************************/
+extern boolean
+    yangcli_ut_parallel_active (server_cb_t *server_cb);
+
+/********************************************************************
+ * FUNCTION yangcli_ut_parallel_check
+ *
+ * Run the parallel test-suite run in progress, if any
+ * Called from the STDIN handler until it returns FALSE
+ *
+ * INPUTS:
+ *   server_cb == server context to use
+ *
+ * RETURNS:
+ *   TRUE if tests are still running and the CLI must wait
+ *   FALSE if no parallel run is in progress
+ *********************************************************************/
+extern boolean
+    yangcli_ut_parallel_check (server_cb_t *server_cb);
+
 /********************************************************************
  * FUNCTION get_top_obj_ut
  *
@@ -0,0 +1,695 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: yangcli_ut_report.c
+
+   NETCONF YANG-based CLI Tool
+
+   test-suite result reports
+
+   The reports cover the suite that was started, or every suite
+   up to the current suite for run-all.  A test that was never
+   started (e.g., a must-pass test failed) is reported as skipped.
+   Times are taken from the wall_usec and latency_usec fields
+   that the test-suite runner saves for each test and step.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "procdefs.h"
+#include "dlq.h"
+#include "log.h"
+#include "ncx.h"
+#include "status.h"
+#include "xml_util.h"
+#include "yangcli.h"
+#include "yangcli_unit_test.h"
+#include "yangcli_ut_report.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+#define UT_RESULT_PASS     "pass"
+#define UT_RESULT_FAIL     "fail"
+#define UT_RESULT_TIMEOUT  "timeout"
+#define UT_RESULT_SKIPPED  "skipped"
+#define UT_RESULT_NOT_RUN  "not-run"
+
+
+/********************************************************************
+*                                                                   *
+*                           T Y P E S                               *
+*                                                                   *
+*********************************************************************/
+
+/* result counters for a JUnit <testsuites> or <testsuite> element */
+typedef struct report_counts_t_ {
+    uint32   tests;
+    uint32   failures;
+    uint32   skipped;
+    uint64   usec;
+} report_counts_t;
+
+
+/********************************************************************
+ * FUNCTION usec_to_ms
+ *
+ * Convert microseconds to milliseconds for a report
+ *
+ * INPUTS:
+ *    usec == time in microseconds
+ *
+ * RETURNS:
+ *   time in milliseconds
+ *********************************************************************/
+static double
+    usec_to_ms (uint64 usec)
+{
+    return (double)usec / 1000.0;
+
+}  /* usec_to_ms */
+
+
+/********************************************************************
+ * FUNCTION step_failed
+ *
+ * Check if a test step has any errors
+ *
+ * INPUTS:
+ *    step == test step to check
+ *
+ * RETURNS:
+ *   TRUE if the step failed
+ *********************************************************************/
+static boolean
+    step_failed (const yangcli_ut_step_t *step)
+{
+    return (step->step_result_wrong ||
+            step->step_timed_out ||
+            step->step_local_error ||
+            step->step_error_tag_wrong ||
+            step->step_error_apptag_wrong ||
+            step->step_error_info_wrong);
+
+}  /* step_failed */
+
+
+/********************************************************************
+ * FUNCTION step_result
+ *
+ * Get the result string for a test step
+ *
+ * INPUTS:
+ *    step == test step to check
+ *
+ * RETURNS:
+ *   result string
+ *********************************************************************/
+static const char *
+    step_result (const yangcli_ut_step_t *step)
+{
+    if (step->start_tstamp[0] == 0) {
+        return UT_RESULT_NOT_RUN;
+    } else if (step->step_timed_out) {
+        return UT_RESULT_TIMEOUT;
+    } else if (step_failed(step)) {
+        return UT_RESULT_FAIL;
+    }
+    return UT_RESULT_PASS;
+
+}  /* step_result */
+
+
+/********************************************************************
+ * FUNCTION step_fail_reason
+ *
+ * Get the reason string for a failed test step
+ *
+ * INPUTS:
+ *    step == test step to check
+ *
+ * RETURNS:
+ *   reason string
+ *********************************************************************/
+static const char *
+    step_fail_reason (const yangcli_ut_step_t *step)
+{
+    if (step->step_timed_out) {
+        return "timed out";
+    } else if (step->step_local_error) {
+        return "command failed";
+    } else if (step->step_result_wrong) {
+        return "wrong response type";
+    } else if (step->step_error_tag_wrong) {
+        return "wrong error-tag";
+    } else if (step->step_error_apptag_wrong) {
+        return "wrong error-app-tag";
+    } else if (step->step_error_info_wrong) {
+        return "missing error-info";
+    }
+    return "failed";
+
+}  /* step_fail_reason */
+
+
+/********************************************************************
+ * FUNCTION first_failed_step
+ *
+ * Get the first test step that failed
+ *
+ * INPUTS:
+ *    test == test to check
+ *
+ * RETURNS:
+ *   back-pointer to the step or NULL if no step failed
+ *********************************************************************/
+static const yangcli_ut_step_t *
+    first_failed_step (const yangcli_ut_test_t *test)
+{
+    const yangcli_ut_step_t *step = (const yangcli_ut_step_t *)
+        dlq_firstEntry(&test->step_listQ);
+    for (; step != NULL;
+         step = (const yangcli_ut_step_t *)dlq_nextEntry(step)) {
+        if (step_failed(step)) {
+            return step;
+        }
+    }
+    return NULL;
+
+}  /* first_failed_step */
+
+
+/********************************************************************
+ * FUNCTION test_result
+ *
+ * Get the result string for a test
+ *
+ * INPUTS:
+ *    test == test to check
+ *
+ * RETURNS:
+ *   result string
+ *********************************************************************/
+static const char *
+    test_result (const yangcli_ut_test_t *test)
+{
+    if (!test->test_started) {
+        return UT_RESULT_SKIPPED;
+    } else if (test->test_errors || first_failed_step(test)) {
+        return UT_RESULT_FAIL;
+    }
+    return UT_RESULT_PASS;
+
+}  /* test_result */
+
+
+/********************************************************************
+ * FUNCTION first_report_suite
+ *
+ * Get the first test-suite to report
+ *
+ * INPUTS:
+ *    context == unit-test context to use
+ *
+ * RETURNS:
+ *   back-pointer to the suite or NULL if none
+ *********************************************************************/
+static const yangcli_ut_suite_t *
+    first_report_suite (const yangcli_ut_context_t *context)
+{
+    if (context->cur_suite == NULL) {
+        return NULL;
+    }
+    if (context->single_suite) {
+        return context->cur_suite;
+    }
+    return (const yangcli_ut_suite_t *)
+        dlq_firstEntry(&context->suite_listQ);
+
+}  /* first_report_suite */
+
+
+/********************************************************************
+ * FUNCTION next_report_suite
+ *
+ * Get the next test-suite to report
+ * For run-all, the suites after the current suite were not run
+ *
+ * INPUTS:
+ *    context == unit-test context to use
+ *    suite == suite that was just reported
+ *
+ * RETURNS:
+ *   back-pointer to the suite or NULL if none
+ *********************************************************************/
+static const yangcli_ut_suite_t *
+    next_report_suite (const yangcli_ut_context_t *context,
+                       const yangcli_ut_suite_t *suite)
+{
+    if (context->single_suite || suite == context->cur_suite) {
+        return NULL;
+    }
+    return (const yangcli_ut_suite_t *)dlq_nextEntry(suite);
+
+}  /* next_report_suite */
+
+
+/********************************************************************
+ * FUNCTION count_suite
+ *
+ * Add the test results for a suite to a counter block
+ *
+ * INPUTS:
+ *    suite == test-suite to count
+ *    counts == counter block to update
+ *********************************************************************/
+static void
+    count_suite (const yangcli_ut_suite_t *suite,
+                 report_counts_t *counts)
+{
+    const run_test_t *run_test = (const run_test_t *)
+        dlq_firstEntry(&suite->run_test_leaflistQ);
+    for (; run_test != NULL;
+         run_test = (const run_test_t *)dlq_nextEntry(run_test)) {
+        if (run_test->test == NULL) {
+            continue;
+        }
+
+        const char *result = test_result(run_test->test);
+        counts->tests++;
+        if (!strcmp(result, UT_RESULT_FAIL)) {
+            counts->failures++;
+        } else if (!strcmp(result, UT_RESULT_SKIPPED)) {
+            counts->skipped++;
+        }
+    }
+    counts->usec += suite->wall_usec;
+
+}  /* count_suite */
+
+
+/********************************************************************
+ * FUNCTION write_xml_attr
+ *
+ * Write a string as an XML attribute value, without the quotes
+ *
+ * INPUTS:
+ *    fp == open file to use
+ *    str == string to write
+ *********************************************************************/
+static void
+    write_xml_attr (FILE *fp,
+                    const xmlChar *str)
+{
+    for (; str && *str; str++) {
+        switch (*str) {
+        case '&':
+            fputs("&amp;", fp);
+            break;
+        case '<':
+            fputs("&lt;", fp);
+            break;
+        case '>':
+            fputs("&gt;", fp);
+            break;
+        case '"':
+            fputs("&quot;", fp);
+            break;
+        case '\n':
+            fputs("&#10;", fp);
+            break;
+        default:
+            fputc(*str, fp);
+        }
+    }
+
+}  /* write_xml_attr */
+
+
+/********************************************************************
+ * FUNCTION write_json_string
+ *
+ * Write a string as a quoted JSON string
+ *
+ * INPUTS:
+ *    fp == open file to use
+ *    str == string to write; NULL is written as an empty string
+ *********************************************************************/
+static void
+    write_json_string (FILE *fp,
+                       const xmlChar *str)
+{
+    fputc('"', fp);
+    for (; str && *str; str++) {
+        switch (*str) {
+        case '"':
+            fputs("\\\"", fp);
+            break;
+        case '\\':
+            fputs("\\\\", fp);
+            break;
+        case '\n':
+            fputs("\\n", fp);
+            break;
+        case '\r':
+            fputs("\\r", fp);
+            break;
+        case '\t':
+            fputs("\\t", fp);
+            break;
+        default:
+            if (*str < 0x20) {
+                fprintf(fp, "\\u%04x", (unsigned int)*str);
+            } else {
+                fputc(*str, fp);
+            }
+        }
+    }
+    fputc('"', fp);
+
+}  /* write_json_string */
+
+
+/********************************************************************
+ * FUNCTION open_report
+ *
+ * Expand the report filespec and open the file for writing
+ *
+ * INPUTS:
+ *    filespec == report file to open
+ *    res == address of return status
+ *
+ * OUTPUTS:
+ *   *res == return status
+ *
+ * RETURNS:
+ *   open file or NULL if some error
+ *********************************************************************/
+static FILE *
+    open_report (const xmlChar *filespec,
+                 status_t *res)
+{
+    xmlChar *fullspec = ncx_get_source(filespec, res);
+    if (fullspec == NULL) {
+        if (*res == NO_ERR) {
+            *res = ERR_INTERNAL_MEM;
+        }
+        return NULL;
+    }
+
+    FILE *fp = fopen((const char *)fullspec, "w");
+    if (fp == NULL) {
+        log_error("\nError: cannot open report file '%s'\n", fullspec);
+        *res = ERR_FIL_OPEN;
+    }
+    m__free(fullspec);
+    return fp;
+
+}  /* open_report */
+
+
+/********************************************************************
+ * FUNCTION write_junit_test
+ *
+ * Write one <testcase> element
+ *
+ * INPUTS:
+ *    fp == open file to use
+ *    suite == test-suite containing the test
+ *    test == test to write
+ *********************************************************************/
+static void
+    write_junit_test (FILE *fp,
+                      const yangcli_ut_suite_t *suite,
+                      const yangcli_ut_test_t *test)
+{
+    const char *result = test_result(test);
+
+    fputs("    <testcase classname=\"", fp);
+    write_xml_attr(fp, suite->name);
+    fputs("\" name=\"", fp);
+    write_xml_attr(fp, test->test_name);
+    fprintf(fp, "\" time=\"%.6f\">\n", (double)test->wall_usec / 1000000.0);
+
+    if (!strcmp(result, UT_RESULT_SKIPPED)) {
+        fputs("      <skipped/>\n", fp);
+        fputs("    </testcase>\n", fp);
+        return;
+    }
+
+    const yangcli_ut_step_t *step = (const yangcli_ut_step_t *)
+        dlq_firstEntry(&test->step_listQ);
+    if (step) {
+        fputs("      <properties>\n", fp);
+    }
+    for (; step != NULL;
+         step = (const yangcli_ut_step_t *)dlq_nextEntry(step)) {
+        fputs("        <property name=\"", fp);
+        write_xml_attr(fp, step->name);
+        fprintf(fp, ".latency-ms\" value=\"%.3f\"/>\n",
+                usec_to_ms(step->latency_usec));
+    }
+    if (dlq_firstEntry(&test->step_listQ)) {
+        fputs("      </properties>\n", fp);
+    }
+
+    if (!strcmp(result, UT_RESULT_FAIL)) {
+        step = first_failed_step(test);
+        fputs("      <failure message=\"", fp);
+        if (step) {
+            fputs("step ", fp);
+            write_xml_attr(fp, step->name);
+            fprintf(fp, ": %s", step_fail_reason(step));
+        } else {
+            fputs("test ended with errors", fp);
+        }
+        fputs("\"/>\n", fp);
+    }
+
+    fputs("    </testcase>\n", fp);
+
+}  /* write_junit_test */
+
+
+/********************************************************************
+ * FUNCTION write_json_test
+ *
+ * Write one test object
+ *
+ * INPUTS:
+ *    fp == open file to use
+ *    test == test to write
+ *********************************************************************/
+static void
+    write_json_test (FILE *fp,
+                     const yangcli_ut_test_t *test)
+{
+    fputs("          {\n            \"name\": ", fp);
+    write_json_string(fp, test->test_name);
+    fprintf(fp, ",\n            \"result\": \"%s\",\n"
+            "            \"time-ms\": %.3f,\n"
+            "            \"steps\": [",
+            test_result(test), usec_to_ms(test->wall_usec));
+
+    boolean first = TRUE;
+    const yangcli_ut_step_t *step = (const yangcli_ut_step_t *)
+        dlq_firstEntry(&test->step_listQ);
+    for (; step != NULL;
+         step = (const yangcli_ut_step_t *)dlq_nextEntry(step)) {
+        fputs((first) ? "\n" : ",\n", fp);
+        first = FALSE;
+
+        fputs("              {\n                \"name\": ", fp);
+        write_json_string(fp, step->name);
+        fprintf(fp, ",\n                \"result\": \"%s\"",
+                step_result(step));
+        if (step->start_tstamp[0]) {
+            fputs(",\n                \"start-time\": ", fp);
+            write_json_string(fp, step->start_tstamp);
+        }
+        if (step_failed(step)) {
+            fprintf(fp, ",\n                \"reason\": \"%s\"",
+                    step_fail_reason(step));
+        }
+        fprintf(fp, ",\n                \"latency-ms\": %.3f\n"
+                "              }", usec_to_ms(step->latency_usec));
+    }
+    fputs((first) ? "]\n" : "\n            ]\n", fp);
+    fputs("          }", fp);
+
+}  /* write_json_test */
+
+
+/**************    E X T E R N A L   F U N C T I O N S **********/
+
+
+/********************************************************************
+ * FUNCTION yangcli_ut_write_junit_report
+ *
+ * Write the results of the last test-suite run in JUnit XML format
+ * Each test is reported as a <testcase> and each step latency
+ * is reported as a <property> of that test
+ *
+ * INPUTS:
+ *    context == unit-test context with the results to use
+ *    filespec == file to write; will be expanded and overwritten
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+status_t
+    yangcli_ut_write_junit_report (const yangcli_ut_context_t *context,
+                                   const xmlChar *filespec)
+{
+    status_t res = NO_ERR;
+    FILE *fp = open_report(filespec, &res);
+    if (fp == NULL) {
+        return res;
+    }
+
+    report_counts_t total;
+    memset(&total, 0x0, sizeof(report_counts_t));
+
+    const yangcli_ut_suite_t *suite = first_report_suite(context);
+    for (; suite != NULL; suite = next_report_suite(context, suite)) {
+        count_suite(suite, &total);
+    }
+
+    fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", fp);
+    fprintf(fp, "<testsuites tests=\"%u\" failures=\"%u\" "
+            "skipped=\"%u\" time=\"%.6f\">\n",
+            total.tests, total.failures, total.skipped,
+            (double)total.usec / 1000000.0);
+
+    suite = first_report_suite(context);
+    for (; suite != NULL; suite = next_report_suite(context, suite)) {
+        report_counts_t counts;
+        memset(&counts, 0x0, sizeof(report_counts_t));
+        count_suite(suite, &counts);
+
+        fputs("  <testsuite name=\"", fp);
+        write_xml_attr(fp, suite->name);
+        fprintf(fp, "\" tests=\"%u\" failures=\"%u\" skipped=\"%u\" "
+                "time=\"%.6f\">\n", counts.tests, counts.failures,
+                counts.skipped, (double)counts.usec / 1000000.0);
+
+        const run_test_t *run_test = (const run_test_t *)
+            dlq_firstEntry(&suite->run_test_leaflistQ);
+        for (; run_test != NULL;
+             run_test = (const run_test_t *)dlq_nextEntry(run_test)) {
+            if (run_test->test) {
+                write_junit_test(fp, suite, run_test->test);
+            }
+        }
+
+        fputs("  </testsuite>\n", fp);
+    }
+
+    fputs("</testsuites>\n", fp);
+
+    if (fclose(fp) != 0) {
+        res = ERR_FIL_WRITE;
+    }
+    return res;
+
+}  /* yangcli_ut_write_junit_report */
+
+
+/********************************************************************
+ * FUNCTION yangcli_ut_write_json_report
+ *
+ * Write the results of the last test-suite run in JSON format
+ *
+ * INPUTS:
+ *    context == unit-test context with the results to use
+ *    filespec == file to write; will be expanded and overwritten
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+status_t
+    yangcli_ut_write_json_report (const yangcli_ut_context_t *context,
+                                  const xmlChar *filespec)
+{
+    status_t res = NO_ERR;
+    FILE *fp = open_report(filespec, &res);
+    if (fp == NULL) {
+        return res;
+    }
+
+    report_counts_t total;
+    memset(&total, 0x0, sizeof(report_counts_t));
+
+    const yangcli_ut_suite_t *suite = first_report_suite(context);
+    for (; suite != NULL; suite = next_report_suite(context, suite)) {
+        count_suite(suite, &total);
+    }
+
+    fputs("{\n  \"test-report\": {\n", fp);
+    if (context->session_group) {
+        fputs("    \"session-group\": ", fp);
+        write_json_string(fp, context->session_group);
+        fputs(",\n", fp);
+    }
+    fprintf(fp, "    \"tests\": %u,\n    \"failures\": %u,\n"
+            "    \"skipped\": %u,\n    \"time-ms\": %.3f,\n"
+            "    \"test-suites\": [",
+            total.tests, total.failures, total.skipped,
+            usec_to_ms(total.usec));
+
+    boolean firstsuite = TRUE;
+    suite = first_report_suite(context);
+    for (; suite != NULL; suite = next_report_suite(context, suite)) {
+        fputs((firstsuite) ? "\n" : ",\n", fp);
+        firstsuite = FALSE;
+
+        fputs("      {\n        \"name\": ", fp);
+        write_json_string(fp, suite->name);
+        fprintf(fp, ",\n        \"time-ms\": %.3f,\n"
+                "        \"tests\": [", usec_to_ms(suite->wall_usec));
+
+        boolean firsttest = TRUE;
+        const run_test_t *run_test = (const run_test_t *)
+            dlq_firstEntry(&suite->run_test_leaflistQ);
+        for (; run_test != NULL;
+             run_test = (const run_test_t *)dlq_nextEntry(run_test)) {
+            if (run_test->test == NULL) {
+                continue;
+            }
+            fputs((firsttest) ? "\n" : ",\n", fp);
+            firsttest = FALSE;
+            write_json_test(fp, run_test->test);
+        }
+        fputs((firsttest) ? "]\n" : "\n        ]\n", fp);
+        fputs("      }", fp);
+    }
+    fputs((firstsuite) ? "]\n" : "\n    ]\n", fp);
+    fputs("  }\n}\n", fp);
+
+    if (fclose(fp) != 0) {
+        res = ERR_FIL_WRITE;
+    }
+    return res;
+
+}  /* yangcli_ut_write_json_report */
+
+
+/* END yangcli_ut_report.c */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2008 - 2012, Andy Bierman, All Rights Reserved.
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_yangcli_ut_report
+#define _H_yangcli_ut_report
+/*  FILE: yangcli_ut_report.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+   write test-suite result reports
+
+   The results of the last test-suite run are written in
+   JUnit XML or JSON format, with the wall time of each test
+   and the latency of each step, so the reports can be
+   compared by a CI system from one run to the next.
+
+*/
+
+#include <xmlstring.h>
+
+#include "status.h"
+#include "yangcli.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/********************************************************************
+*                                                                   *
+*                      F U N C T I O N S                            *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+ * FUNCTION yangcli_ut_write_junit_report
+ *
+ * Write the results of the last test-suite run in JUnit XML format
+ * Each test is reported as a <testcase> and each step latency
+ * is reported as a <property> of that test
+ *
+ * INPUTS:
+ *    context == unit-test context with the results to use
+ *    filespec == file to write; will be expanded and overwritten
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+extern status_t
+    yangcli_ut_write_junit_report (const yangcli_ut_context_t *context,
+                                   const xmlChar *filespec);
+
+
+/********************************************************************
+ * FUNCTION yangcli_ut_write_json_report
+ *
+ * Write the results of the last test-suite run in JSON format
+ *
+ * INPUTS:
+ *    context == unit-test context with the results to use
+ *    filespec == file to write; will be expanded and overwritten
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+extern status_t
+    yangcli_ut_write_json_report (const yangcli_ut_context_t *context,
+                                  const xmlChar *filespec);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif            /* _H_yangcli_ut_report */
@@ -42,6 +42,7 @@ date         init     comment
 #include <stdio.h>
 #include <ctype.h>
 #include <assert.h>
+#include <sys/stat.h>
 
 #include "libtecla.h"
 
@@ -49,7 +50,9 @@ date         init     comment
 #include "cap.h"
 #include "log.h"
 #include "mgr.h"
+#include "mgr_rpc.h"
 #include "mgr_ses.h"
+#include "mgr_val_parse.h"
 #include "ncx.h"
 #include "ncxconst.h"
 #include "ncxmod.h"
@@ -67,6 +70,8 @@ date         init     comment
 #include "yangconst.h"
 #include "yangcli.h"
 #include "yangcli_config.h"
+#include "yangcli_record_test.h"
+#include "yangcli_unit_test.h"
 #include "yangcli_util.h"
 
 
@@ -1282,6 +1287,87 @@ result_format_t
 }  /* get_file_result_format */
 
 
+/********************************************************************
+* FUNCTION setup_stream_reply
+* 
+* Setup the request to write the <data> element in the reply
+* straight to the result file, if the stream-replies variable
+* is set and the reply would be saved with @file = command
+* Otherwise the request is not changed and the reply is
+* parsed into a value tree as usual
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    session_cb == session control block to use
+*    req == request to setup
+*
+* OUTPUTS:
+*    req->stream is set if the reply data will be streamed
+*********************************************************************/
+void
+    setup_stream_reply (server_cb_t *server_cb,
+                        session_cb_t *session_cb,
+                        mgr_rpc_req_t *req)
+{
+    assert(server_cb && "server_cb is NULL!");
+    assert(session_cb && "session_cb is NULL!");
+    assert(req && "req is NULL!");
+
+    if (!session_cb->stream_replies || 
+        server_cb->result_filename == NULL ||
+        server_cb->result_name != NULL ||
+        req->rpc == NULL || req->stream != NULL) {
+        return;
+    }
+
+    /* the unit-test and record-test modes need the reply value */
+    if (yangcli_ut_active(server_cb) || is_test_recording_on(server_cb)) {
+        return;
+    }
+
+    /* only RPC operations that return <data> are streamed */
+    obj_template_t *output = obj_find_child(req->rpc, NULL, NCX_EL_OUTPUT);
+    if (output == NULL || 
+        obj_find_child(output, NC_MODULE, NCX_EL_DATA) == NULL) {
+        return;
+    }
+
+    ncx_display_mode_t mode;
+    switch (get_file_result_format(server_cb->result_filename)) {
+    case RF_XML:
+        if (session_cb->display_mode == NCX_DISPLAY_MODE_XML_NONS) {
+            /* namespaces are copied as received */
+            return;
+        }
+        mode = NCX_DISPLAY_MODE_XML;
+        break;
+    case RF_JSON:
+        mode = NCX_DISPLAY_MODE_JSON;
+        break;
+    default:
+        return;
+    }
+
+    /* let the normal path report an existing file */
+    if (server_cb->overwrite_filevars) {
+        struct stat statbuf;
+        if (stat((const char *)server_cb->result_filename, &statbuf) == 0) {
+            return;
+        }
+    }
+
+    req->stream = mgr_val_new_stream(server_cb->result_filename, mode);
+    if (req->stream == NULL) {
+        /* not fatal; parse the reply the normal way */
+        return;
+    }
+    req->stream->xmlhdr = session_cb->use_xmlheader;
+    req->stream->validate = session_cb->stream_validate;
+    req->stream->indent = session_cb->defindent;
+
+}  /* setup_stream_reply */
+
+
 /********************************************************************
 * FUNCTION interactive_mode
 * 
@@ -1868,6 +1954,7 @@ status_t
             req->data = reqdata;
             req->rpc = rpc;
             req->timeout = session_cb->timeout;
+            setup_stream_reply(get_cur_server_cb(), session_cb, req);
         }
     }
         
@@ -441,6 +441,29 @@ extern result_format_t
     get_file_result_format (const xmlChar *filespec);
 
 
+/********************************************************************
+* FUNCTION setup_stream_reply
+* 
+* Setup the request to write the <data> element in the reply
+* straight to the result file, if the stream-replies variable
+* is set and the reply would be saved with @file = command
+* Otherwise the request is not changed and the reply is
+* parsed into a value tree as usual
+*
+* INPUTS:
+*    server_cb == server control block to use
+*    session_cb == session control block to use
+*    req == request to setup
+*
+* OUTPUTS:
+*    req->stream is set if the reply data will be streamed
+*********************************************************************/
+extern void
+    setup_stream_reply (server_cb_t *server_cb,
+                        session_cb_t *session_cb,
+                        mgr_rpc_req_t *req);
+
+
 /********************************************************************
 * FUNCTION interactive_mode
 * 
@@ -80,6 +80,9 @@ extern "C" {
 
 #define YANGDUMP_DEF_OUTPUT   "stdout"
 
+/* import nest level where the --incremental check gives up */
+#define YANGDUMP_MAX_IMPORT_DEPTH  64
+
 #define YANGDUMP_DEF_CONFIG   (const xmlChar *)"/etc/yumapro/yangdump-pro.conf"
 
 #define YANGDUMP_DEF_TOC      (const xmlChar *)"menu"
@@ -98,7 +101,9 @@ extern "C" {
 #define YANGDUMP_PARM_HTML_DIV      (const xmlChar *)"html-div"
 #define YANGDUMP_PARM_HTML_TOC      (const xmlChar *)"html-toc"
 #define YANGDUMP_PARM_IDENTIFIERS   (const xmlChar *)"identifiers"
+#define YANGDUMP_PARM_INCREMENTAL   (const xmlChar *)"incremental"
 #define YANGDUMP_PARM_INDENT        (const xmlChar *)"indent"
+#define YANGDUMP_PARM_JOBS          (const xmlChar *)"jobs"
 #define YANGDUMP_PARM_MODULE        (const xmlChar *)"module"
 #define YANGDUMP_PARM_MODVERSION    (const xmlChar *)"modversion"
 #define YANGDUMP_PARM_VERSIONNAMES  (const xmlChar *)"versionnames"
@@ -219,6 +224,7 @@ typedef struct yangdump_cvtparms_t_ {
     const xmlChar  *html_toc;
     const xmlChar  *css_file;
     int32           indent;
+    uint32          jobs;
     uint32          modcount;
     uint32          subtreecount;
     ncx_cvttyp_t    format;
@@ -232,6 +238,7 @@ typedef struct yangdump_cvtparms_t_ {
     yangdump_totals_t stat_totals;
     boolean         showerrorsmode;
     boolean         identifiers;
+    boolean         incremental;
     boolean         tree_identifiers;
     boolean         html_div;
     boolean         modversion;
@@ -254,6 +261,8 @@ typedef struct yangdump_cvtparms_t_ {
     yangdump_stats_t *final_stats;
     uint32          stat_reports;
     uint32          bufflen;
+    uint32          jobnum;      /* worker number if jobs > 1 */
+    uint32          filecount;   /* files seen, to split the jobs */
     boolean         firstdone;
     boolean         isuser;
     dlq_hdr_t       savedevQ;
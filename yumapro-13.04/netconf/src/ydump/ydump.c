@@ -28,10 +28,14 @@ date         init     comment
 *                     I N C L U D E    F I L E S                    *
 *                                                                   *
 *********************************************************************/
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 #include "procdefs.h"
 #include "c.h"
@@ -380,6 +384,15 @@ static status_t
         cp->identifiers = TRUE;
     }
 
+    /* incremental parameter */
+    val = val_find_child(valset, YANGDUMP_MOD, 
+                         YANGDUMP_PARM_INCREMENTAL);
+    if (val && val->res == NO_ERR) {
+        cp->incremental = VAL_BOOL(val);
+    } else {
+        cp->incremental = FALSE;
+    }
+
     /* indent parameter */
     val = val_find_child(valset, YANGDUMP_MOD, YANGDUMP_PARM_INDENT);
     if (val && val->res == NO_ERR) {
@@ -388,6 +401,14 @@ static status_t
         cp->indent = NCX_DEF_INDENT;
     }
 
+    /* jobs parameter */
+    val = val_find_child(valset, YANGDUMP_MOD, YANGDUMP_PARM_JOBS);
+    if (val && val->res == NO_ERR) {
+        cp->jobs = VAL_UINT(val);
+    } else {
+        cp->jobs = 1;
+    }
+
     /* help parameter */
     val = val_find_child(valset, YANGDUMP_MOD, NCX_EL_HELP);
     if (val && val->res == NO_ERR) {
@@ -1306,6 +1327,180 @@ static boolean
 }   /* format_allowed */
 
 
+/********************************************************************
+ * FUNCTION per_module_output
+ * 
+ *  Check if each module is written to its own output file
+ *
+ * INPUTS:
+ *    cp == parameter block to use
+ *
+ * RETURNS:
+ *   TRUE if a default output filename is used for each module
+ *   FALSE if all output goes to STDOUT or to one output file
+ *********************************************************************/
+static boolean
+    per_module_output (const yangdump_cvtparms_t *cp)
+{
+    return ((cp->defnames && cp->format != NCX_CVTTYP_NONE) ||
+            (cp->output && cp->output_isdir)) ? TRUE : FALSE;
+
+}   /* per_module_output */
+
+
+/********************************************************************
+ * FUNCTION source_changed
+ * 
+ *  Check if the source file for a [sub]module, or any
+ *  submodule it includes or module it imports, has been
+ *  modified since the output file was written
+ *
+ * INPUTS:
+ *    mod == [sub]module to check
+ *    outtime == modification time of the output file
+ *    depth == import nest level; the check gives up and
+ *             reports a change if it gets too deep
+ *
+ * RETURNS:
+ *   TRUE if any source file changed or could not be checked
+ *   FALSE if all the source files are older than the output
+ *********************************************************************/
+static boolean
+    source_changed (const ncx_module_t *mod,
+                    time_t outtime,
+                    uint32 depth)
+{
+    const ncx_import_t  *imp;
+    const ncx_include_t *inc;
+    const ncx_module_t  *testmod;
+    struct stat          statbuf;
+
+    if (depth > YANGDUMP_MAX_IMPORT_DEPTH || mod->source == NULL) {
+        return TRUE;
+    }
+
+    memset(&statbuf, 0x0, sizeof(statbuf));
+    if (stat((const char *)mod->source, &statbuf) != 0 ||
+        statbuf.st_mtime >= outtime) {
+        return TRUE;
+    }
+
+    for (inc = (const ncx_include_t *)dlq_firstEntry(&mod->includeQ);
+         inc != NULL;
+         inc = (const ncx_include_t *)dlq_nextEntry(inc)) {
+
+        if (inc->submod == NULL ||
+            source_changed(inc->submod, outtime, depth+1)) {
+            return TRUE;
+        }
+    }
+
+    for (imp = (const ncx_import_t *)dlq_firstEntry(&mod->importQ);
+         imp != NULL;
+         imp = (const ncx_import_t *)dlq_nextEntry(imp)) {
+
+        if (imp->force_yuma_nc) {
+            /* internal yuma-netconf is used instead */
+            continue;
+        }
+
+        testmod = imp->mod;
+        if (testmod == NULL) {
+            testmod = ncx_find_module(imp->module, imp->revision);
+        }
+        if (testmod == NULL ||
+            source_changed(testmod, outtime, depth+1)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+
+}   /* source_changed */
+
+
+/********************************************************************
+ * FUNCTION output_is_current
+ * 
+ *  Check if the output file for the module just parsed
+ *  is newer than the module and all of its imports,
+ *  for the --incremental parameter
+ *
+ * INPUTS:
+ *    pcb == parser control block with the module to check
+ *    cp == parameter block to use
+ *
+ * RETURNS:
+ *   TRUE if the conversion can be skipped
+ *   FALSE if the conversion needs to be done
+ *********************************************************************/
+static boolean
+    output_is_current (yang_pcb_t *pcb,
+                       yangdump_cvtparms_t *cp)
+{
+    xmlChar      *namebuff;
+    struct stat   statbuf;
+    boolean       retval;
+
+    /* the totals need the stats for every module */
+    if (!cp->incremental || cp->collect_stats || !per_module_output(cp)) {
+        return FALSE;
+    }
+
+    namebuff = xsd_make_output_filename(pcb->top, cp);
+    if (namebuff == NULL) {
+        return FALSE;
+    }
+
+    memset(&statbuf, 0x0, sizeof(statbuf));
+    if (stat((const char *)namebuff, &statbuf) != 0) {
+        retval = FALSE;
+    } else {
+        retval = !source_changed(pcb->top, statbuf.st_mtime, 0);
+    }
+
+    if (retval && LOGINFO) {
+        log_info("\nSkipping '%s': output file '%s' is up to date",
+                 pcb->top->sourcefn,
+                 namebuff);
+    }
+
+    m__free(namebuff);
+    return retval;
+
+}   /* output_is_current */
+
+
+/********************************************************************
+ * FUNCTION job_selected
+ * 
+ *  Check if the next input file belongs to this job
+ *  The input files are dealt out to the --jobs workers
+ *  in the order they are found
+ *
+ * INPUTS:
+ *    cp == parameter block to use
+ *
+ * RETURNS:
+ *   TRUE if this job should convert the next file
+ *   FALSE if another job will convert it
+ *********************************************************************/
+static boolean
+    job_selected (yangdump_cvtparms_t *cp)
+{
+    boolean  retval;
+
+    if (cp->jobs <= 1) {
+        return TRUE;
+    }
+
+    retval = ((cp->filecount % cp->jobs) == cp->jobnum) ? TRUE : FALSE;
+    cp->filecount++;
+    return retval;
+
+}   /* job_selected */
+
+
 /********************************************************************
  * FUNCTION convert_one
  * 
@@ -1369,6 +1564,11 @@ static status_t
         *savestr = savechar;
     }
 
+    if (res == NO_ERR && pcb && pcb->top && output_is_current(pcb, cp)) {
+        yang_free_pcb(pcb);
+        return NO_ERR;
+    }
+
     if (res == ERR_NCX_SKIPPED) {
         if (pcb) {
             yang_free_pcb(pcb);
@@ -1780,6 +1980,10 @@ static status_t
     }
     cp->curmodule = cp->module;
 
+    if (!job_selected(cp)) {
+        return NO_ERR;
+    }
+
     log_debug2("\nStart subtree file:\n%s\n", cp->module);
     res = convert_one(cp);
     if (res != NO_ERR) {
@@ -1793,6 +1997,232 @@ static status_t
 }  /* subtree_callback */
 
 
+/********************************************************************
+ * FUNCTION convert_all
+ * 
+ * Convert all the modules and subtrees in the CLI parameters
+ * If --jobs is set, then only the files for this job are converted
+ *
+ * INPUTS:
+ *   cp == conversion parameters to use
+ *   done == address of return done flag
+ *
+ * OUTPUTS:
+ *   *done == TRUE if any module or subtree parameter was found
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    convert_all (yangdump_cvtparms_t *cp,
+                 boolean *done)
+{
+    val_value_t  *val;
+    status_t      res;
+
+    res = NO_ERR;
+    val = val_find_child(cp->cli_val, YANGDUMP_MOD, 
+                         YANGDUMP_PARM_MODULE);
+    while (val) {
+        *done = TRUE;
+        cp->curmodule = (char *)VAL_STR(val);
+        cp->onemodule = TRUE;
+        if (job_selected(cp)) {
+            res = convert_one(cp);
+        }
+        if (NEED_EXIT(res)) {
+            val = NULL;
+        } else {
+            val = val_find_next_child(cp->cli_val,
+                                      YANGDUMP_MOD,
+                                      YANGDUMP_PARM_MODULE,
+                                      val);
+        }
+    }
+
+    cp->onemodule = FALSE;
+    if (res == NO_ERR &&
+        cp->subtreecount >= 1) {
+        if (cp->format == NCX_CVTTYP_XSD ||
+            cp->format == NCX_CVTTYP_HTML ||
+            cp->format == NCX_CVTTYP_YANG ||
+            cp->format == NCX_CVTTYP_COPY) {
+            /* force separate file names in subtree mode */
+            cp->defnames = TRUE;
+        }
+                   
+        val = val_find_child(cp->cli_val, 
+                             YANGDUMP_MOD, 
+                             YANGDUMP_PARM_SUBTREE);
+        while (val) {
+            *done = TRUE;
+
+            /* this var cp->subtree will be non-NULL
+             * if there are any subtrees to process;
+             * this will cause subtree mode to be true, so
+             * a banner is printed after every file
+             */
+            cp->subtree = (const char *)VAL_STR(val);
+
+            if (ncxmod_test_subdir((const xmlChar *)cp->subtree)) {
+                res = ncxmod_process_subtree(cp->subtree,
+                                             subtree_callback,
+                                             cp);
+            } else {
+                res = ERR_NCX_NOT_FOUND;
+                log_error("\nError: directory '%s' not found\n",
+                          cp->subtree);
+            }
+            if (NEED_EXIT(res)) {
+                val = NULL;
+            } else {
+                val = val_find_next_child(cp->cli_val,
+                                          YANGDUMP_MOD,
+                                          YANGDUMP_PARM_SUBTREE,
+                                          val);
+            }
+        }
+    }
+
+    return res;
+
+}  /* convert_all */
+
+
+/********************************************************************
+ * FUNCTION jobs_allowed
+ * 
+ * Check if the output of the --jobs workers can be kept apart
+ * Each module has to have its own output file, or else
+ * only validation with no reports can be done
+ *
+ * INPUTS:
+ *   cp == conversion parameters to use
+ *
+ * RETURNS:
+ *   TRUE if the workers can run at the same time
+ *   FALSE if the conversion must be done by one job
+ *********************************************************************/
+static boolean
+    jobs_allowed (const yangdump_cvtparms_t *cp)
+{
+    if (cp->collect_stats) {
+        return FALSE;
+    }
+
+    if (per_module_output(cp)) {
+        return TRUE;
+    }
+
+    if (cp->subtreecount >= 1 && cp->modcount == 0 &&
+        (cp->format == NCX_CVTTYP_XSD ||
+         cp->format == NCX_CVTTYP_HTML ||
+         cp->format == NCX_CVTTYP_YANG ||
+         cp->format == NCX_CVTTYP_COPY)) {
+        /* defnames will be forced in subtree mode */
+        return TRUE;
+    }
+
+    return (cp->format == NCX_CVTTYP_NONE &&
+            cp->output == NULL &&
+            !(cp->modversion ||
+              cp->exports ||
+              cp->dependencies ||
+              cp->identifiers ||
+              cp->tree_identifiers)) ? TRUE : FALSE;
+
+}  /* jobs_allowed */
+
+
+/********************************************************************
+ * FUNCTION run_jobs
+ * 
+ * Fork the --jobs worker processes and wait for them to finish
+ * Each worker has its own copy of the module registry, so
+ * an import is parsed at most once per worker, and the input
+ * files are dealt out to the workers in turn
+ *
+ * INPUTS:
+ *   cp == conversion parameters to use
+ *   done == address of return done flag
+ *
+ * OUTPUTS:
+ *   *done == TRUE if any module or subtree parameter was found
+ *
+ * RETURNS:
+ *   status
+ *********************************************************************/
+static status_t
+    run_jobs (yangdump_cvtparms_t *cp,
+              boolean *done)
+{
+    pid_t        *pids;
+    pid_t         pid;
+    status_t      res;
+    uint32        i, started;
+    int           retstatus;
+
+    if (!jobs_allowed(cp)) {
+        log_warn("\nWarning: --jobs ignored; output is not written "
+                 "to a separate file for each module");
+        cp->jobs = 1;
+        return convert_all(cp, done);
+    }
+
+    *done = (cp->modcount || cp->subtreecount) ? TRUE : FALSE;
+
+    pids = m__getMem(cp->jobs * sizeof(pid_t));
+    if (pids == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    /* only the calling thread is copied into a worker, so the
+     * --log-async writer thread is stopped first and the rest
+     * of the run uses synchronous logging
+     */
+    log_clear_async();
+
+    /* do not let the workers repeat any buffered output */
+    fflush(NULL);
+
+    res = NO_ERR;
+    started = 0;
+    for (i = 0; i < cp->jobs; i++) {
+        pid = fork();
+        if (pid < 0) {
+            log_error("\nError: could not start job %u (%s)",
+                      i, strerror(errno));
+            res = ERR_NCX_OPERATION_FAILED;
+            break;
+        } else if (pid == 0) {
+            /* worker process */
+            cp->jobnum = i;
+            res = convert_all(cp, done);
+            print_errors();
+            print_error_count();
+            fflush(NULL);
+            _exit((res == NO_ERR) ? 0 : 1);
+        }
+        pids[started++] = pid;
+    }
+
+    for (i = 0; i < started; i++) {
+        retstatus = 0;
+        if (waitpid(pids[i], &retstatus, 0) < 0 ||
+            !WIFEXITED(retstatus) ||
+            WEXITSTATUS(retstatus) != 0) {
+            if (res == NO_ERR) {
+                res = ERR_NCX_OPERATION_FAILED;
+            }
+        }
+    }
+
+    m__free(pids);
+    return res;
+
+}  /* run_jobs */
+
+
 /************    E X T E R N A L    F U N C T I O N S   ************/
 
 
@@ -2002,66 +2432,10 @@ status_t
     }
 
     /* convert one file or N files or 1 subtree */
-    res = NO_ERR;
-    val = val_find_child(cvtparms->cli_val, YANGDUMP_MOD, 
-                         YANGDUMP_PARM_MODULE);
-    while (val) {
-        done = TRUE;
-        cvtparms->curmodule = (char *)VAL_STR(val);
-        cvtparms->onemodule = TRUE;
-        res = convert_one(cvtparms);
-        if (NEED_EXIT(res)) {
-            val = NULL;
-        } else {
-            val = val_find_next_child(cvtparms->cli_val,
-                                      YANGDUMP_MOD,
-                                      YANGDUMP_PARM_MODULE,
-                                      val);
-        }
-    }
-
-    cvtparms->onemodule = FALSE;
-    if (res == NO_ERR &&
-        cvtparms->subtreecount >= 1) {
-        if (cvtparms->format == NCX_CVTTYP_XSD ||
-            cvtparms->format == NCX_CVTTYP_HTML ||
-            cvtparms->format == NCX_CVTTYP_YANG ||
-            cvtparms->format == NCX_CVTTYP_COPY) {
-            /* force separate file names in subtree mode */
-            cvtparms->defnames = TRUE;
-        }
-                   
-        val = val_find_child(cvtparms->cli_val, 
-                             YANGDUMP_MOD, 
-                             YANGDUMP_PARM_SUBTREE);
-        while (val) {
-            done = TRUE;
-
-            /* this var cvtparms->subtree will be non-NULL
-             * if there are any subtrees to process;
-             * this will cause subtree mode to be true, so
-             * a banner is printed after every file
-             */
-            cvtparms->subtree = (const char *)VAL_STR(val);
-
-            if (ncxmod_test_subdir((const xmlChar *)cvtparms->subtree)) {
-                res = ncxmod_process_subtree(cvtparms->subtree,
-                                             subtree_callback,
-                                             cvtparms);
-            } else {
-                res = ERR_NCX_NOT_FOUND;
-                log_error("\nError: directory '%s' not found\n",
-                          cvtparms->subtree);
-            }
-            if (NEED_EXIT(res)) {
-                val = NULL;
-            } else {
-                val = val_find_next_child(cvtparms->cli_val,
-                                          YANGDUMP_MOD,
-                                          YANGDUMP_PARM_SUBTREE,
-                                          val);
-            }
-        }
+    if (cvtparms->jobs > 1) {
+        res = run_jobs(cvtparms, &done);
+    } else {
+        res = convert_all(cvtparms, &done);
     }
 
     if (res == NO_ERR && !done) {
@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+import sys
+import json
+from optparse import OptionParser
+
+# ----------------------------------------------------------------------------|
+# Compare 2 ybench result files and report the benchmarks that got slower.
+#
+#   bench-compare.py [--threshold=PCT] old.json new.json
+#
+# The median time of each benchmark is compared.  The exit code is 1
+# if any benchmark is more than PCT percent slower (default 10),
+# or failed in the new run, so it can be used in a build script.
+
+# ----------------------------------------------------------------------------|
+def LoadResults( filename ):
+    """Load a ybench results file into a dict keyed by benchmark name"""
+    f = open( filename )
+    try:
+        data = json.load( f )
+    finally:
+        f.close()
+    results = {}
+    for r in data[ "results" ]:
+        results[ r[ "name" ] ] = r
+    return data, results
+
+# ----------------------------------------------------------------------------|
+def CheckParameters( olddata, newdata ):
+    """Warn if the 2 runs did not use the same dataset"""
+    if olddata[ "parameters" ] != newdata[ "parameters" ]:
+        print ( "Warning: benchmark parameters differ: %s != %s"
+                % ( olddata[ "parameters" ], newdata[ "parameters" ] ) )
+
+# ----------------------------------------------------------------------------|
+def Compare( oldresults, newresults, threshold ):
+    """Print the change in median time for each benchmark
+    Returns the number of regressions"""
+    regressions = 0
+    print ( "%-26s %14s %14s %9s" % ( "benchmark", "old median(us)",
+                                      "new median(us)", "change" ) )
+    for name in sorted( newresults.keys() ):
+        new = newresults[ name ]
+        old = oldresults.get( name )
+        if new[ "status" ] != "ok":
+            print ( "%-26s %s  REGRESSION" % ( name, new[ "status" ] ) )
+            regressions += 1
+            continue
+        if old is None or old[ "status" ] != "ok" or not old[ "median-ns" ]:
+            print ( "%-26s %14s %14.1f" % ( name, "-",
+                                            new[ "median-ns" ] / 1e3 ) )
+            continue
+
+        change = ( ( float( new[ "median-ns" ] ) - old[ "median-ns" ] )
+                   * 100.0 / old[ "median-ns" ] )
+        flag = ""
+        if change > threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print ( "%-26s %14.1f %14.1f %+8.1f%%%s"
+                % ( name, old[ "median-ns" ] / 1e3,
+                    new[ "median-ns" ] / 1e3, change, flag ) )
+    return regressions
+
+# ----------------------------------------------------------------------------|
+if __name__ == '__main__':
+    parser = OptionParser( usage = "%prog [options] old.json new.json" )
+    parser.add_option( "-t", "--threshold", type = "float", default = 10.0,
+                       help = "percent slowdown reported as a regression" )
+    ( options, args ) = parser.parse_args()
+    if len( args ) != 2:
+        parser.error( "need the old and new result files" )
+
+    olddata, oldresults = LoadResults( args[0] )
+    newdata, newresults = LoadResults( args[1] )
+    CheckParameters( olddata, newdata )
+    if Compare( oldresults, newresults, options.threshold ):
+        sys.exit( 1 )
+    sys.exit( 0 )
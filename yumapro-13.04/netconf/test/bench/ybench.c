@@ -0,0 +1,643 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: ybench.c
+
+    Micro-benchmark suite for the ncx core primitives
+
+    Usage:
+
+      ybench [--size=N] [--model-size=N] [--iterations=N]
+             [--seed=N] [--filter=name[,name...]]
+             [--output=filespec|-] [--list]
+             [--log-level=level] [--modpath=path]
+
+    A summary table is printed to STDOUT and the results are
+    written as JSON to the --output file, for comparison with
+    another run by bench-compare.py.  --filter selects the
+    benchmarks whose name starts with one of the given strings.
+    The other parameters are handled by the NCX bootstrap CLI.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "procdefs.h"
+#include "log.h"
+#include "ncx.h"
+#include "ncxconst.h"
+#include "status.h"
+#include "tstamp.h"
+#include "ybench.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+#define YBENCH_PROGNAME  "ybench"
+
+/* LCG constants from Numerical Recipes */
+#define YBENCH_LCG_MULT  1664525
+#define YBENCH_LCG_INC   1013904223
+
+
+/********************************************************************
+*                                                                   *
+*                            T Y P E S                              *
+*                                                                   *
+*********************************************************************/
+
+/* summary of the samples for one benchmark */
+typedef struct ybench_stats_t_ {
+    const char      *name;
+    status_t         res;
+    uint32           samples;
+    uint64           items;
+    uint64           min_ns;
+    uint64           median_ns;
+    uint64           max_ns;
+    double           mean_ns;
+    double           stddev_ns;
+} ybench_stats_t;
+
+
+/* CLI parameters handled by this program */
+typedef struct ybench_parms_t_ {
+    const char      *filter;
+    const char      *output;
+    boolean          list;
+} ybench_parms_t;
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static uint32  lcg_state;
+
+
+/********************************************************************
+* FUNCTION parse_uint_parm
+*
+* Parse a --name=number parameter
+*
+* INPUTS:
+*   arg == argv string
+*   name == parameter name, including the leading dashes and '='
+*   num == address of return number
+*
+* OUTPUTS:
+*   *num == number if the parameter matched
+*
+* RETURNS:
+*   TRUE if the parameter matched; FALSE if not
+*********************************************************************/
+static boolean
+    parse_uint_parm (const char *arg,
+                     const char *name,
+                     uint32 *num)
+{
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len)) {
+        return FALSE;
+    }
+    *num = (uint32)strtoul(arg + len, NULL, 10);
+    return TRUE;
+
+}  /* parse_uint_parm */
+
+
+/********************************************************************
+* FUNCTION parse_cli
+*
+* Get the ybench parameters; all others are left
+* for the bootstrap CLI in ncx_init
+*
+* INPUTS:
+*   argc, argv == program parameters
+*   ctx == benchmark context to fill in
+*   parms == parameters to fill in
+*********************************************************************/
+static void
+    parse_cli (int argc,
+               char *argv[],
+               ybench_ctx_t *ctx,
+               ybench_parms_t *parms)
+{
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (parse_uint_parm(arg, "--size=", &ctx->size) ||
+            parse_uint_parm(arg, "--model-size=", &ctx->model_size) ||
+            parse_uint_parm(arg, "--iterations=", &ctx->iterations) ||
+            parse_uint_parm(arg, "--seed=", &ctx->seed)) {
+            continue;
+        }
+        if (!strncmp(arg, "--filter=", 9)) {
+            parms->filter = arg + 9;
+        } else if (!strncmp(arg, "--output=", 9)) {
+            parms->output = arg + 9;
+        } else if (!strcmp(arg, "--list")) {
+            parms->list = TRUE;
+        }
+    }
+
+}  /* parse_cli */
+
+
+/********************************************************************
+* FUNCTION filter_match
+*
+* Check if a benchmark is selected by the --filter parameter
+*
+* INPUTS:
+*   filter == comma separated list of name prefixes; NULL for all
+*   name == benchmark name
+*
+* RETURNS:
+*   TRUE if the benchmark should be run
+*********************************************************************/
+static boolean
+    filter_match (const char *filter,
+                  const char *name)
+{
+    if (filter == NULL || *filter == 0) {
+        return TRUE;
+    }
+
+    const char *str = filter;
+    while (*str) {
+        const char *end = strchr(str, ',');
+        size_t len = (end) ? (size_t)(end - str) : strlen(str);
+
+        if (len && !strncmp(name, str, len)) {
+            return TRUE;
+        }
+        if (end == NULL) {
+            break;
+        }
+        str = end + 1;
+    }
+    return FALSE;
+
+}  /* filter_match */
+
+
+/********************************************************************
+* FUNCTION compare_samples
+*
+* qsort compare function for uint64 samples
+*********************************************************************/
+static int
+    compare_samples (const void *a,
+                     const void *b)
+{
+    uint64 x = *(const uint64 *)a;
+    uint64 y = *(const uint64 *)b;
+
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+
+}  /* compare_samples */
+
+
+/********************************************************************
+* FUNCTION make_stats
+*
+* Summarize the samples of a finished benchmark run
+*
+* INPUTS:
+*   run == benchmark run; the samples are sorted
+*   stats == stats struct to fill in
+*********************************************************************/
+static void
+    make_stats (ybench_run_t *run,
+                ybench_stats_t *stats)
+{
+    uint32 i;
+
+    stats->samples = run->count;
+    stats->items = run->items;
+    if (run->count == 0) {
+        return;
+    }
+
+    qsort(run->samples, run->count, sizeof(uint64), compare_samples);
+
+    double sum = 0;
+    for (i = 0; i < run->count; i++) {
+        sum += (double)run->samples[i];
+    }
+    stats->mean_ns = sum / run->count;
+
+    double var = 0;
+    for (i = 0; i < run->count; i++) {
+        double diff = (double)run->samples[i] - stats->mean_ns;
+        var += diff * diff;
+    }
+    stats->stddev_ns = sqrt(var / run->count);
+
+    stats->min_ns = run->samples[0];
+    stats->max_ns = run->samples[run->count - 1];
+    if (run->count & 1) {
+        stats->median_ns = run->samples[run->count / 2];
+    } else {
+        stats->median_ns = (run->samples[run->count / 2 - 1] +
+                            run->samples[run->count / 2]) / 2;
+    }
+
+}  /* make_stats */
+
+
+/********************************************************************
+* FUNCTION items_per_sec
+*
+* Get the throughput of a benchmark, based on the median
+*
+* INPUTS:
+*   stats == benchmark stats
+*
+* RETURNS:
+*   items per second; 0 if not known
+*********************************************************************/
+static double
+    items_per_sec (const ybench_stats_t *stats)
+{
+    if (stats->median_ns == 0) {
+        return 0;
+    }
+    return (double)stats->items * 1e9 / (double)stats->median_ns;
+
+}  /* items_per_sec */
+
+
+/********************************************************************
+* FUNCTION run_benchmark
+*
+* Run one benchmark and summarize its samples
+*
+* INPUTS:
+*   ctx == benchmark context
+*   bench == benchmark to run
+*   stats == stats struct to fill in
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    run_benchmark (ybench_ctx_t *ctx,
+                   const ybench_t *bench,
+                   ybench_stats_t *stats)
+{
+    ybench_run_t run;
+
+    memset(&run, 0x0, sizeof(run));
+    memset(stats, 0x0, sizeof(ybench_stats_t));
+    stats->name = bench->name;
+
+    run.maxcount = ctx->iterations;
+    run.samples = m__getMem(run.maxcount * sizeof(uint64));
+    if (run.samples == NULL) {
+        stats->res = ERR_INTERNAL_MEM;
+        return stats->res;
+    }
+
+    /* same dataset generator state for every benchmark so
+     * the result does not depend on which ones are run
+     */
+    lcg_state = ctx->seed;
+
+    stats->res = (*bench->fn)(ctx, &run);
+    make_stats(&run, stats);
+    m__free(run.samples);
+
+    if (stats->res != NO_ERR) {
+        log_error("\nError: benchmark '%s' failed (%s)",
+                  bench->name, get_error_string(stats->res));
+    }
+    return stats->res;
+
+}  /* run_benchmark */
+
+
+/********************************************************************
+* FUNCTION print_table
+*
+* Print the summary table to STDOUT
+*
+* INPUTS:
+*   stats == array of benchmark stats
+*   count == number of entries in stats
+*********************************************************************/
+static void
+    print_table (const ybench_stats_t *stats,
+                 uint32 count)
+{
+    uint32 i;
+
+    printf("\n%-26s %12s %12s %12s %12s %14s",
+           "benchmark", "min(us)", "median(us)", "mean(us)", "max(us)",
+           "items/sec");
+    for (i = 0; i < count; i++) {
+        if (stats[i].res != NO_ERR) {
+            printf("\n%-26s %s", stats[i].name,
+                   get_error_string(stats[i].res));
+            continue;
+        }
+        printf("\n%-26s %12.1f %12.1f %12.1f %12.1f %14.0f",
+               stats[i].name,
+               stats[i].min_ns / 1e3,
+               stats[i].median_ns / 1e3,
+               stats[i].mean_ns / 1e3,
+               stats[i].max_ns / 1e3,
+               items_per_sec(&stats[i]));
+    }
+    printf("\n");
+
+}  /* print_table */
+
+
+/********************************************************************
+* FUNCTION write_results
+*
+* Write the results as JSON
+*
+* INPUTS:
+*   ctx == benchmark context
+*   stats == array of benchmark stats
+*   count == number of entries in stats
+*   output == output filespec; "-" for STDOUT
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    write_results (const ybench_ctx_t *ctx,
+                   const ybench_stats_t *stats,
+                   uint32 count,
+                   const char *output)
+{
+    xmlChar version[NCX_VERSION_BUFFSIZE];
+    xmlChar tstamp[TSTAMP_MIN_SIZE];
+    uint32 i;
+
+    FILE *fp = stdout;
+    if (strcmp(output, "-")) {
+        fp = fopen(output, "w");
+        if (fp == NULL) {
+            log_error("\nError: open '%s' failed", output);
+            return ERR_FIL_OPEN;
+        }
+    }
+
+    if (ncx_get_version(version, sizeof(version)) != NO_ERR) {
+        version[0] = 0;
+    }
+    tstamp_datetime(tstamp);
+
+    fprintf(fp,
+            "{\n"
+            "  \"program\": \"%s\",\n"
+            "  \"format-version\": %u,\n"
+            "  \"version\": \"%s\",\n"
+            "  \"timestamp\": \"%s\",\n"
+            "  \"parameters\": {\n"
+            "    \"size\": %u,\n"
+            "    \"model-size\": %u,\n"
+            "    \"iterations\": %u,\n"
+            "    \"seed\": %u\n"
+            "  },\n"
+            "  \"results\": [",
+            YBENCH_PROGNAME, YBENCH_FORMAT_VERSION, version, tstamp,
+            ctx->size, ctx->model_size, ctx->iterations, ctx->seed);
+
+    for (i = 0; i < count; i++) {
+        fprintf(fp,
+                "%s\n    {\n"
+                "      \"name\": \"%s\",\n"
+                "      \"status\": \"%s\",\n"
+                "      \"samples\": %u,\n"
+                "      \"items\": %llu,\n"
+                "      \"min-ns\": %llu,\n"
+                "      \"median-ns\": %llu,\n"
+                "      \"mean-ns\": %.0f,\n"
+                "      \"max-ns\": %llu,\n"
+                "      \"stddev-ns\": %.0f,\n"
+                "      \"items-per-sec\": %.1f\n"
+                "    }",
+                (i) ? "," : "",
+                stats[i].name,
+                (stats[i].res == NO_ERR) ? "ok" :
+                get_error_string(stats[i].res),
+                stats[i].samples,
+                (unsigned long long)stats[i].items,
+                (unsigned long long)stats[i].min_ns,
+                (unsigned long long)stats[i].median_ns,
+                stats[i].mean_ns,
+                (unsigned long long)stats[i].max_ns,
+                stats[i].stddev_ns,
+                items_per_sec(&stats[i]));
+    }
+    fprintf(fp, "\n  ]\n}\n");
+
+    status_t res = NO_ERR;
+    if (fp != stdout && fclose(fp) != 0) {
+        res = ERR_FIL_WRITE;
+    }
+    return res;
+
+}  /* write_results */
+
+
+/*************    E X T E R N A L   F U N C T I O N S   ************/
+
+
+/********************************************************************
+* FUNCTION ybench_now
+*
+* Get the monotonic clock
+*
+* RETURNS:
+*   current time in nanoseconds
+*********************************************************************/
+uint64
+    ybench_now (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64)ts.tv_sec * 1000000000ULL + (uint64)ts.tv_nsec;
+
+}  /* ybench_now */
+
+
+/********************************************************************
+* FUNCTION ybench_start
+*
+* Start timing one iteration
+*
+* INPUTS:
+*   run == benchmark run in progress
+*********************************************************************/
+void
+    ybench_start (ybench_run_t *run)
+{
+    run->startns = ybench_now();
+
+}  /* ybench_start */
+
+
+/********************************************************************
+* FUNCTION ybench_stop
+*
+* Stop timing one iteration and save the sample
+*
+* INPUTS:
+*   run == benchmark run in progress
+*********************************************************************/
+void
+    ybench_stop (ybench_run_t *run)
+{
+    uint64 now = ybench_now();
+
+    if (run->count < run->maxcount) {
+        run->samples[run->count++] = now - run->startns;
+    }
+
+}  /* ybench_stop */
+
+
+/********************************************************************
+* FUNCTION ybench_random
+*
+* Get the next number from the dataset generator
+* The sequence only depends on the --seed parameter
+*
+* RETURNS:
+*   pseudo-random number
+*********************************************************************/
+uint32
+    ybench_random (void)
+{
+    lcg_state = lcg_state * YBENCH_LCG_MULT + YBENCH_LCG_INC;
+    return lcg_state >> 8;
+
+}  /* ybench_random */
+
+
+/********************************************************************
+* FUNCTION main
+*
+* ybench program
+*
+* RETURNS:
+*   0 if all the benchmarks ran; 1 if not
+*********************************************************************/
+int
+    main (int argc,
+          char *argv[])
+{
+    ybench_ctx_t ctx;
+    ybench_parms_t parms;
+    ybench_stats_t *stats = NULL;
+    const ybench_t *tables[2];
+    uint32 tablesize[2];
+    uint32 i, j, numstats = 0;
+
+    memset(&ctx, 0x0, sizeof(ctx));
+    memset(&parms, 0x0, sizeof(parms));
+    ctx.size = YBENCH_DEF_SIZE;
+    ctx.model_size = YBENCH_DEF_MODEL_SIZE;
+    ctx.iterations = YBENCH_DEF_ITERATIONS;
+    ctx.seed = YBENCH_DEF_SEED;
+    parms.output = YBENCH_DEF_OUTPUT;
+
+    parse_cli(argc, argv, &ctx, &parms);
+    if (ctx.iterations == 0) {
+        ctx.iterations = 1;
+    }
+
+    tables[0] = ybench_val_benchmarks(&tablesize[0]);
+    tables[1] = ybench_yang_benchmarks(&tablesize[1]);
+
+    if (parms.list) {
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j < tablesize[i]; j++) {
+                printf("%s\n", tables[i][j].name);
+            }
+        }
+        return 0;
+    }
+
+    status_t res = ncx_init(FALSE, LOG_DEBUG_WARN, FALSE, FALSE, FALSE,
+                            NULL, argc, argv);
+    if (res != NO_ERR) {
+        fprintf(stderr, "\n%s: ncx_init failed (%s)\n", YBENCH_PROGNAME,
+                get_error_string(res));
+        return 1;
+    }
+
+    lcg_state = ctx.seed;
+    res = ybench_gen_init(&ctx);
+
+    if (res == NO_ERR) {
+        stats = m__getMem((tablesize[0] + tablesize[1]) *
+                          sizeof(ybench_stats_t));
+        if (stats == NULL) {
+            res = ERR_INTERNAL_MEM;
+        }
+    }
+
+    status_t retres = res;
+    if (res == NO_ERR) {
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j < tablesize[i]; j++) {
+                if (!filter_match(parms.filter, tables[i][j].name)) {
+                    continue;
+                }
+                res = run_benchmark(&ctx, &tables[i][j], &stats[numstats++]);
+                if (res != NO_ERR) {
+                    retres = res;
+                }
+            }
+        }
+
+        print_table(stats, numstats);
+        res = write_results(&ctx, stats, numstats, parms.output);
+        if (res != NO_ERR) {
+            retres = res;
+        }
+    }
+
+    if (stats) {
+        m__free(stats);
+    }
+    ybench_gen_cleanup(&ctx);
+    ncx_cleanup();
+
+    return (retres == NO_ERR) ? 0 : 1;
+
+}  /* main */
+
+
+/* END ybench.c */
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _H_ybench
+#define _H_ybench
+/*  FILE: ybench.h
+*********************************************************************
+*                                                                   *
+*                         P U R P O S E                             *
+*                                                                   *
+*********************************************************************
+
+    Micro-benchmark harness for the ncx core primitives
+
+    Each benchmark runs its own setup code and brackets only
+    the code being measured with ybench_start and ybench_stop,
+    once per iteration.  The harness keeps every sample and
+    reports min/median/mean/max for each benchmark.
+
+*/
+
+#include <stdio.h>
+#include <xmlstring.h>
+
+#ifndef _H_procdefs
+#include "procdefs.h"
+#endif
+
+#ifndef _H_ncxtypes
+#include "ncxtypes.h"
+#endif
+
+#ifndef _H_obj
+#include "obj.h"
+#endif
+
+#ifndef _H_status
+#include "status.h"
+#endif
+
+#ifndef _H_val
+#include "val.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************************************************************
+*                                                                   *
+*                         C O N S T A N T S                         *
+*                                                                   *
+*********************************************************************/
+
+/* format version of the JSON results file;
+ * bump if a field is renamed or its meaning changes
+ */
+#define YBENCH_FORMAT_VERSION   1
+
+#define YBENCH_DEF_SIZE         1000
+#define YBENCH_DEF_MODEL_SIZE   100
+#define YBENCH_DEF_ITERATIONS   20
+#define YBENCH_DEF_SEED         1
+#define YBENCH_DEF_OUTPUT       "ybench-results.json"
+
+/* generated module names */
+#define YBENCH_MOD              (const xmlChar *)"ybench"
+#define YBENCH_LOAD_MOD         "ybench-load"
+#define YBENCH_TOP              (const xmlChar *)"top"
+#define YBENCH_ENTRY            (const xmlChar *)"entry"
+
+
+/********************************************************************
+*                                                                   *
+*                            T Y P E S                              *
+*                                                                   *
+*********************************************************************/
+
+/* shared state for all the benchmarks */
+typedef struct ybench_ctx_t_ {
+    uint32           size;          /* list entries in the dataset */
+    uint32           model_size;    /* extra groupings in the model */
+    uint32           iterations;
+    uint32           seed;
+    char             workdir[64];   /* generated files */
+    xmlChar         *yangspec;      /* ybench.yang */
+    xmlChar         *xmlspec;       /* dataset in XML */
+    ncx_module_t    *mod;           /* ybench module */
+    obj_template_t  *topobj;        /* /top container */
+    val_value_t     *root;          /* config root holding /top */
+    val_value_t     *top;           /* dataset; child of root */
+    uint32           loadcount;     /* ybench-load-N modules made */
+} ybench_ctx_t;
+
+
+/* timing samples for one benchmark */
+typedef struct ybench_run_t_ {
+    uint64          *samples;       /* nanoseconds per iteration */
+    uint32           count;
+    uint32           maxcount;
+    uint64           items;         /* items processed per iteration */
+    uint64           startns;
+} ybench_run_t;
+
+
+/* one benchmark
+ * the function must call ybench_start and ybench_stop
+ * around the measured code once for each iteration
+ */
+typedef status_t (*ybench_fn_t) (ybench_ctx_t *ctx,
+                                  ybench_run_t *run);
+
+typedef struct ybench_t_ {
+    const char      *name;
+    ybench_fn_t      fn;
+} ybench_t;
+
+
+/********************************************************************
+*                                                                   *
+*                        F U N C T I O N S                          *
+*                                                                   *
+*********************************************************************/
+
+
+/********************************************************************
+* FUNCTION ybench_now
+*
+* Get the monotonic clock
+*
+* RETURNS:
+*   current time in nanoseconds
+*********************************************************************/
+extern uint64
+    ybench_now (void);
+
+
+/********************************************************************
+* FUNCTION ybench_start
+*
+* Start timing one iteration
+*
+* INPUTS:
+*   run == benchmark run in progress
+*********************************************************************/
+extern void
+    ybench_start (ybench_run_t *run);
+
+
+/********************************************************************
+* FUNCTION ybench_stop
+*
+* Stop timing one iteration and save the sample
+*
+* INPUTS:
+*   run == benchmark run in progress
+*********************************************************************/
+extern void
+    ybench_stop (ybench_run_t *run);
+
+
+/********************************************************************
+* FUNCTION ybench_random
+*
+* Get the next number from the dataset generator
+* The sequence only depends on the --seed parameter
+*
+* RETURNS:
+*   pseudo-random number
+*********************************************************************/
+extern uint32
+    ybench_random (void);
+
+
+/********************************************************************
+* FUNCTION ybench_gen_init
+*
+* Generate the ybench module and dataset files,
+* load the module and build the dataset value tree
+*
+* INPUTS:
+*   ctx == benchmark context with the size parameters set
+*
+* OUTPUTS:
+*   ctx->workdir, yangspec, xmlspec, mod, topobj, root, top set
+*
+* RETURNS:
+*   status
+*********************************************************************/
+extern status_t
+    ybench_gen_init (ybench_ctx_t *ctx);
+
+
+/********************************************************************
+* FUNCTION ybench_gen_cleanup
+*
+* Free the dataset and remove the generated files
+*
+* INPUTS:
+*   ctx == benchmark context
+*********************************************************************/
+extern void
+    ybench_gen_cleanup (ybench_ctx_t *ctx);
+
+
+/********************************************************************
+* FUNCTION ybench_gen_module
+*
+* Write a generated YANG module to the work directory
+*
+* INPUTS:
+*   ctx == benchmark context
+*   modname == module name; also used for the namespace and prefix
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == status
+*
+* RETURNS:
+*   malloced filespec of the module; NULL if some error
+*********************************************************************/
+extern xmlChar *
+    ybench_gen_module (ybench_ctx_t *ctx,
+                       const char *modname,
+                       status_t *res);
+
+
+/********************************************************************
+* FUNCTION ybench_gen_entry
+*
+* Make one list entry for the dataset
+*
+* INPUTS:
+*   ctx == benchmark context
+*   num == entry number; used to make the key
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == status
+*
+* RETURNS:
+*   malloced list entry with its index chain set; NULL if some error
+*********************************************************************/
+extern val_value_t *
+    ybench_gen_entry (ybench_ctx_t *ctx,
+                      uint32 num,
+                      status_t *res);
+
+
+/********************************************************************
+* FUNCTION ybench_val_benchmarks
+*
+* Get the value tree benchmarks (ybench_val.c)
+*
+* OUTPUTS:
+*   *count == number of entries in the returned array
+*
+* RETURNS:
+*   array of benchmarks
+*********************************************************************/
+extern const ybench_t *
+    ybench_val_benchmarks (uint32 *count);
+
+
+/********************************************************************
+* FUNCTION ybench_yang_benchmarks
+*
+* Get the YANG parser benchmarks (ybench_yang.c)
+*
+* OUTPUTS:
+*   *count == number of entries in the returned array
+*
+* RETURNS:
+*   array of benchmarks
+*********************************************************************/
+extern const ybench_t *
+    ybench_yang_benchmarks (uint32 *count);
+
+#ifdef __cplusplus
+}  /* end extern 'C' */
+#endif
+
+#endif	    /* _H_ybench */
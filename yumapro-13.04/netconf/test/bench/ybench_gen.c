@@ -0,0 +1,547 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: ybench_gen.c
+
+    Generated YANG module and dataset for the micro-benchmarks
+
+    The ybench module has a /top/entry list used for the value
+    tree benchmarks, plus --model-size generated groupings that
+    are expanded under /top/extra to give the YANG parser
+    benchmarks something to chew on.  The same module text is
+    used for the ybench-load-N modules, with a different name.
+
+    All values in the dataset come from ybench_random, so the
+    files are the same for the same --size, --model-size
+    and --seed parameters.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "procdefs.h"
+#include "log.h"
+#include "ncx.h"
+#include "ncxconst.h"
+#include "ncxmod.h"
+#include "obj.h"
+#include "status.h"
+#include "val.h"
+#include "val_util.h"
+#include "xml_util.h"
+#include "xml_wr.h"
+#include "ybench.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+#define YBENCH_WORKDIR_TEMPLATE  "/tmp/ybench-XXXXXX"
+
+#define YBENCH_NS_BASE  "urn:yumaworks:params:xml:ns:yang:"
+
+
+/********************************************************************
+* FUNCTION make_filespec
+*
+* Make a filespec in the work directory
+*
+* INPUTS:
+*   ctx == benchmark context
+*   fname == file name
+*   ext == file extension including the dot
+*
+* RETURNS:
+*   malloced filespec; NULL if malloc failed
+*********************************************************************/
+static xmlChar *
+    make_filespec (const ybench_ctx_t *ctx,
+                   const char *fname,
+                   const char *ext)
+{
+    uint32 len = strlen(ctx->workdir) + strlen(fname) + strlen(ext) + 2;
+    xmlChar *buff = m__getMem(len);
+    if (buff) {
+        snprintf((char *)buff, len, "%s/%s%s", ctx->workdir, fname, ext);
+    }
+    return buff;
+
+}  /* make_filespec */
+
+
+/********************************************************************
+* FUNCTION write_module
+*
+* Write the generated module text
+*
+* INPUTS:
+*   ctx == benchmark context
+*   fp == open file to write
+*   modname == module name
+*********************************************************************/
+static void
+    write_module (const ybench_ctx_t *ctx,
+                  FILE *fp,
+                  const char *modname)
+{
+    uint32 i;
+
+    fprintf(fp,
+            "module %s {\n"
+            "  yang-version 1;\n"
+            "  namespace \"" YBENCH_NS_BASE "%s\";\n"
+            "  prefix %s;\n\n"
+            "  organization \"YumaWorks, Inc.\";\n"
+            "  description \"Generated by ybench; do not edit.\";\n\n"
+            "  revision 2026-10-19 {\n"
+            "    description \"Generated module.\";\n"
+            "  }\n\n",
+            modname, modname, modname);
+
+    fprintf(fp,
+            "  typedef counter-type {\n"
+            "    type uint64;\n"
+            "    description \"Generic counter.\";\n"
+            "  }\n\n"
+            "  typedef name-type {\n"
+            "    type string {\n"
+            "      length \"1..64\";\n"
+            "      pattern '[a-z][a-z0-9\\-]*';\n"
+            "    }\n"
+            "  }\n\n"
+            "  grouping counters {\n"
+            "    leaf in-octets { type counter-type; }\n"
+            "    leaf out-octets { type counter-type; }\n"
+            "    leaf errors { type uint32; }\n"
+            "  }\n\n");
+
+    for (i = 0; i < ctx->model_size; i++) {
+        fprintf(fp,
+                "  grouping group-%u {\n"
+                "    description \"Generated grouping %u.\";\n"
+                "    leaf name-%u { type name-type; }\n"
+                "    leaf value-%u {\n"
+                "      type int32 { range \"-1000..1000\"; }\n"
+                "      default %d;\n"
+                "    }\n"
+                "    leaf-list tag-%u {\n"
+                "      type string;\n"
+                "      max-elements 16;\n"
+                "    }\n"
+                "    container sub-%u {\n"
+                "      presence \"Generated presence container.\";\n"
+                "      leaf enabled { type boolean; }\n"
+                "      leaf ref { type leafref { path \"../../name-%u\"; } }\n"
+                "    }\n"
+                "  }\n\n",
+                i, i, i, i, (int)(i % 2001) - 1000, i, i, i);
+    }
+
+    fprintf(fp,
+            "  container top {\n"
+            "    list entry {\n"
+            "      key name;\n"
+            "      leaf name { type name-type; }\n"
+            "      leaf index { type uint32; }\n"
+            "      leaf descr { type string; }\n"
+            "      leaf enabled {\n"
+            "        type boolean;\n"
+            "        default true;\n"
+            "      }\n"
+            "      container counters { uses counters; }\n"
+            "    }\n\n"
+            "    container extra {\n");
+
+    for (i = 0; i < ctx->model_size; i++) {
+        fprintf(fp,
+                "      container item-%u { uses group-%u; }\n",
+                i, i);
+    }
+
+    fprintf(fp,
+            "    }\n"
+            "  }\n"
+            "}\n");
+
+}  /* write_module */
+
+
+/********************************************************************
+* FUNCTION add_leaf
+*
+* Make a leaf from a string and add it to a parent
+*
+* INPUTS:
+*   parent == parent value
+*   name == name of the leaf
+*   valstr == value string
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_leaf (val_value_t *parent,
+              const xmlChar *name,
+              const xmlChar *valstr)
+{
+    obj_template_t *obj =
+        obj_find_child(parent->obj, YBENCH_MOD, name);
+    if (obj == NULL) {
+        return SET_ERROR(ERR_INTERNAL_VAL);
+    }
+
+    status_t res = NO_ERR;
+    val_value_t *leaf = val_make_simval_obj(obj, valstr, &res);
+    if (leaf) {
+        val_add_child(leaf, parent);
+    }
+    return res;
+
+}  /* add_leaf */
+
+
+/********************************************************************
+* FUNCTION add_uint_leaf
+*
+* Make a number leaf and add it to a parent
+*
+* INPUTS:
+*   parent == parent value
+*   name == name of the leaf
+*   num == value
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    add_uint_leaf (val_value_t *parent,
+                   const xmlChar *name,
+                   uint64 num)
+{
+    char buff[NCX_MAX_NUMLEN];
+
+    snprintf(buff, sizeof(buff), "%llu", (unsigned long long)num);
+    return add_leaf(parent, name, (const xmlChar *)buff);
+
+}  /* add_uint_leaf */
+
+
+/********************************************************************
+* FUNCTION remove_workdir
+*
+* Remove the generated files and the work directory
+*
+* INPUTS:
+*   ctx == benchmark context
+*********************************************************************/
+static void
+    remove_workdir (const ybench_ctx_t *ctx)
+{
+    DIR *dp = opendir(ctx->workdir);
+    if (dp == NULL) {
+        return;
+    }
+
+    char buff[sizeof(ctx->workdir) + 256];
+    struct dirent *ep;
+    while ((ep = readdir(dp)) != NULL) {
+        if (ep->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(buff, sizeof(buff), "%s/%s", ctx->workdir, ep->d_name);
+        unlink(buff);
+    }
+    closedir(dp);
+    rmdir(ctx->workdir);
+
+}  /* remove_workdir */
+
+
+/*************    E X T E R N A L   F U N C T I O N S   ************/
+
+
+/********************************************************************
+* FUNCTION ybench_gen_module
+*
+* Write a generated YANG module to the work directory
+*
+* INPUTS:
+*   ctx == benchmark context
+*   modname == module name; also used for the namespace and prefix
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == status
+*
+* RETURNS:
+*   malloced filespec of the module; NULL if some error
+*********************************************************************/
+xmlChar *
+    ybench_gen_module (ybench_ctx_t *ctx,
+                       const char *modname,
+                       status_t *res)
+{
+    xmlChar *filespec = make_filespec(ctx, modname, ".yang");
+    if (filespec == NULL) {
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+
+    FILE *fp = fopen((const char *)filespec, "w");
+    if (fp == NULL) {
+        log_error("\nError: open '%s' failed", filespec);
+        m__free(filespec);
+        *res = ERR_FIL_OPEN;
+        return NULL;
+    }
+
+    write_module(ctx, fp, modname);
+    if (fclose(fp) != 0) {
+        m__free(filespec);
+        *res = ERR_FIL_WRITE;
+        return NULL;
+    }
+
+    *res = NO_ERR;
+    return filespec;
+
+}  /* ybench_gen_module */
+
+
+/********************************************************************
+* FUNCTION ybench_gen_entry
+*
+* Make one list entry for the dataset
+*
+* INPUTS:
+*   ctx == benchmark context
+*   num == entry number; used to make the key
+*   res == address of return status
+*
+* OUTPUTS:
+*   *res == status
+*
+* RETURNS:
+*   malloced list entry with its index chain set; NULL if some error
+*********************************************************************/
+val_value_t *
+    ybench_gen_entry (ybench_ctx_t *ctx,
+                      uint32 num,
+                      status_t *res)
+{
+    obj_template_t *listobj =
+        obj_find_child(ctx->topobj, YBENCH_MOD, YBENCH_ENTRY);
+    obj_template_t *cntobj = (listobj) ?
+        obj_find_child(listobj, YBENCH_MOD, (const xmlChar *)"counters") :
+        NULL;
+    if (cntobj == NULL) {
+        *res = SET_ERROR(ERR_INTERNAL_VAL);
+        return NULL;
+    }
+
+    val_value_t *entry = val_new_value();
+    val_value_t *counters = val_new_value();
+    if (entry == NULL || counters == NULL) {
+        if (entry) {
+            val_free_value(entry);
+        }
+        if (counters) {
+            val_free_value(counters);
+        }
+        *res = ERR_INTERNAL_MEM;
+        return NULL;
+    }
+    val_init_from_template(entry, listobj);
+    val_init_from_template(counters, cntobj);
+
+    char buff[64];
+    snprintf(buff, sizeof(buff), "entry-%08u", num);
+    *res = add_leaf(entry, (const xmlChar *)"name", (const xmlChar *)buff);
+
+    if (*res == NO_ERR) {
+        *res = add_uint_leaf(entry, (const xmlChar *)"index",
+                             ybench_random());
+    }
+    if (*res == NO_ERR) {
+        snprintf(buff, sizeof(buff), "Generated entry %u tag %08x",
+                 num, ybench_random());
+        *res = add_leaf(entry, (const xmlChar *)"descr",
+                        (const xmlChar *)buff);
+    }
+    if (*res == NO_ERR) {
+        *res = add_leaf(entry, (const xmlChar *)"enabled",
+                        (ybench_random() & 1) ? NCX_EL_TRUE : NCX_EL_FALSE);
+    }
+
+    /* the counters container is freed with the entry from here on */
+    val_add_child(counters, entry);
+
+    if (*res == NO_ERR) {
+        *res = add_uint_leaf(counters, (const xmlChar *)"in-octets",
+                             ((uint64)ybench_random() << 16) |
+                             ybench_random());
+    }
+    if (*res == NO_ERR) {
+        *res = add_uint_leaf(counters, (const xmlChar *)"out-octets",
+                             ((uint64)ybench_random() << 16) |
+                             ybench_random());
+    }
+    if (*res == NO_ERR) {
+        *res = add_uint_leaf(counters, (const xmlChar *)"errors",
+                             ybench_random() % 100);
+    }
+    if (*res == NO_ERR) {
+        *res = val_gen_index_chain(listobj, entry);
+    }
+
+    if (*res != NO_ERR) {
+        val_free_value(entry);
+        return NULL;
+    }
+    return entry;
+
+}  /* ybench_gen_entry */
+
+
+/********************************************************************
+* FUNCTION ybench_gen_init
+*
+* Generate the ybench module and dataset files,
+* load the module and build the dataset value tree
+*
+* INPUTS:
+*   ctx == benchmark context with the size parameters set
+*
+* OUTPUTS:
+*   ctx->workdir, yangspec, xmlspec, mod, topobj, root, top set
+*
+* RETURNS:
+*   status
+*********************************************************************/
+status_t
+    ybench_gen_init (ybench_ctx_t *ctx)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    strncpy(ctx->workdir, YBENCH_WORKDIR_TEMPLATE, sizeof(ctx->workdir));
+    if (mkdtemp(ctx->workdir) == NULL) {
+        log_error("\nError: could not create work directory");
+        ctx->workdir[0] = 0;
+        return ERR_FIL_OPEN;
+    }
+
+    /* the generated modules are found in the work directory */
+    ncxmod_set_modpath((const xmlChar *)ctx->workdir);
+
+    ctx->yangspec = ybench_gen_module(ctx, (const char *)YBENCH_MOD, &res);
+    if (ctx->yangspec == NULL) {
+        return res;
+    }
+
+    res = ncxmod_load_module(YBENCH_MOD, NULL, NULL, &ctx->mod);
+    if (res != NO_ERR) {
+        log_error("\nError: load of generated module failed (%s)",
+                  get_error_string(res));
+        return res;
+    }
+
+    ctx->topobj = obj_find_template_top(ctx->mod, YBENCH_MOD, YBENCH_TOP);
+    if (ctx->topobj == NULL) {
+        return SET_ERROR(ERR_INTERNAL_VAL);
+    }
+
+    /* the dataset is under a config root so absolute
+     * XPath expressions can be evaluated
+     */
+    ctx->root = val_new_value();
+    ctx->top = val_new_value();
+    if (ctx->root == NULL || ctx->top == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+    val_init_from_template(ctx->root, ncx_get_gen_root());
+    val_init_from_template(ctx->top, ctx->topobj);
+    val_add_child(ctx->top, ctx->root);
+
+    for (i = 0; i < ctx->size && res == NO_ERR; i++) {
+        val_value_t *entry = ybench_gen_entry(ctx, i, &res);
+        if (entry) {
+            val_add_child(entry, ctx->top);
+        }
+    }
+    if (res != NO_ERR) {
+        return res;
+    }
+
+    ctx->xmlspec = make_filespec(ctx, (const char *)YBENCH_MOD, ".xml");
+    if (ctx->xmlspec == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    xml_attrs_t attrs;
+    xml_init_attrs(&attrs);
+    res = xml_wr_file(ctx->xmlspec, ctx->top, &attrs, TRUE, TRUE, TRUE,
+                      0, NCX_DEF_INDENT);
+    xml_clean_attrs(&attrs);
+    if (res != NO_ERR) {
+        log_error("\nError: write of generated dataset failed (%s)",
+                  get_error_string(res));
+    }
+    return res;
+
+}  /* ybench_gen_init */
+
+
+/********************************************************************
+* FUNCTION ybench_gen_cleanup
+*
+* Free the dataset and remove the generated files
+*
+* INPUTS:
+*   ctx == benchmark context
+*********************************************************************/
+void
+    ybench_gen_cleanup (ybench_ctx_t *ctx)
+{
+    if (ctx->root) {
+        val_free_value(ctx->root);
+        ctx->root = NULL;
+        ctx->top = NULL;
+    } else if (ctx->top) {
+        val_free_value(ctx->top);
+        ctx->top = NULL;
+    }
+    if (ctx->yangspec) {
+        m__free(ctx->yangspec);
+        ctx->yangspec = NULL;
+    }
+    if (ctx->xmlspec) {
+        m__free(ctx->xmlspec);
+        ctx->xmlspec = NULL;
+    }
+    if (ctx->workdir[0]) {
+        remove_workdir(ctx);
+        ctx->workdir[0] = 0;
+    }
+
+}  /* ybench_gen_cleanup */
+
+
+/* END ybench_gen.c */
@@ -0,0 +1,546 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: ybench_val.c
+
+    Value tree benchmarks: clone, compare, sorted insert,
+    XML and JSON output, XML input and XPath evaluation
+
+    Every benchmark works on the /top dataset made by
+    ybench_gen_init, so the items count is the number
+    of list entries (--size).
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "procdefs.h"
+#include "json_wr.h"
+#include "log.h"
+#include "ncx.h"
+#include "ncxconst.h"
+#include "obj.h"
+#include "rpc.h"
+#include "ses.h"
+#include "status.h"
+#include "val.h"
+#include "xml_msg.h"
+#include "xml_util.h"
+#include "xml_wr.h"
+#include "xpath.h"
+#include "xpath1.h"
+#include "agt_val_parse.h"
+#include "agt_xml.h"
+#include "ybench.h"
+
+
+/********************************************************************
+*                                                                   *
+*                       C O N S T A N T S                           *
+*                                                                   *
+*********************************************************************/
+
+#define YBENCH_NULL_DEVICE  "/dev/null"
+
+
+/********************************************************************
+*                                                                   *
+*                            T Y P E S                              *
+*                                                                   *
+*********************************************************************/
+
+/* output format for write_tree */
+typedef enum ybench_wrfmt_t_ {
+    YBENCH_WR_XML,
+    YBENCH_WR_JSON
+} ybench_wrfmt_t;
+
+
+/********************************************************************
+* FUNCTION bench_val_clone
+*
+* val_clone of the whole dataset
+*********************************************************************/
+static status_t
+    bench_val_clone (ybench_ctx_t *ctx,
+                     ybench_run_t *run)
+{
+    uint32 i;
+
+    run->items = ctx->size;
+    for (i = 0; i < ctx->iterations; i++) {
+        ybench_start(run);
+        val_value_t *copy = val_clone(ctx->top);
+        ybench_stop(run);
+
+        if (copy == NULL) {
+            return ERR_INTERNAL_MEM;
+        }
+        val_free_value(copy);
+    }
+    return NO_ERR;
+
+}  /* bench_val_clone */
+
+
+/********************************************************************
+* FUNCTION bench_val_compare
+*
+* val_compare of the dataset and an equal copy,
+* so every node is visited
+*********************************************************************/
+static status_t
+    bench_val_compare (ybench_ctx_t *ctx,
+                       ybench_run_t *run)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    val_value_t *copy = val_clone(ctx->top);
+    if (copy == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    run->items = ctx->size;
+    for (i = 0; i < ctx->iterations && res == NO_ERR; i++) {
+        ybench_start(run);
+        int32 ret = val_compare(ctx->top, copy);
+        ybench_stop(run);
+
+        if (ret != 0) {
+            log_error("\nError: dataset copy not equal");
+            res = ERR_NCX_OPERATION_FAILED;
+        }
+    }
+
+    val_free_value(copy);
+    return res;
+
+}  /* bench_val_compare */
+
+
+/********************************************************************
+* FUNCTION bench_val_add_child_sorted
+*
+* val_add_child_sorted of all the list entries,
+* added in a random order, to an empty /top
+*********************************************************************/
+static status_t
+    bench_val_add_child_sorted (ybench_ctx_t *ctx,
+                                ybench_run_t *run)
+{
+    status_t res = NO_ERR;
+    uint32 i, j;
+
+    /* the entries are only sorted if system-ordered
+     * list sorting is enabled
+     */
+    boolean syssorted = ncx_get_system_sorted();
+    ncx_set_system_sorted(TRUE);
+
+    /* make a shuffled copy of the entries; the clones
+     * are made outside the timed section
+     */
+    val_value_t **entries = m__getMem(ctx->size * sizeof(val_value_t *));
+    if (entries == NULL) {
+        ncx_set_system_sorted(syssorted);
+        return ERR_INTERNAL_MEM;
+    }
+
+    run->items = ctx->size;
+    for (i = 0; i < ctx->iterations && res == NO_ERR; i++) {
+        val_value_t *top = val_new_value();
+        if (top == NULL) {
+            res = ERR_INTERNAL_MEM;
+            continue;
+        }
+        val_init_from_template(top, ctx->topobj);
+
+        j = 0;
+        val_value_t *entry;
+        for (entry = val_get_first_child(ctx->top);
+             entry != NULL && j < ctx->size;
+             entry = val_get_next_child(entry)) {
+            entries[j] = val_clone(entry);
+            if (entries[j] == NULL) {
+                res = ERR_INTERNAL_MEM;
+                break;
+            }
+            j++;
+        }
+        if (res != NO_ERR) {
+            while (j > 0) {
+                val_free_value(entries[--j]);
+            }
+            val_free_value(top);
+            continue;
+        }
+
+        /* Fisher-Yates shuffle */
+        uint32 k;
+        for (k = j; k > 1; k--) {
+            uint32 r = ybench_random() % k;
+            entry = entries[k - 1];
+            entries[k - 1] = entries[r];
+            entries[r] = entry;
+        }
+
+        ybench_start(run);
+        for (k = 0; k < j; k++) {
+            val_add_child_sorted(entries[k], top);
+        }
+        ybench_stop(run);
+
+        val_free_value(top);
+    }
+
+    m__free(entries);
+    ncx_set_system_sorted(syssorted);
+    return res;
+
+}  /* bench_val_add_child_sorted */
+
+
+/********************************************************************
+* FUNCTION write_tree
+*
+* Write the dataset to /dev/null through a dummy session
+*
+* INPUTS:
+*   ctx == benchmark context
+*   run == benchmark run
+*   fmt == output format
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    write_tree (ybench_ctx_t *ctx,
+                ybench_run_t *run,
+                ybench_wrfmt_t fmt)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    FILE *fp = fopen(YBENCH_NULL_DEVICE, "w");
+    if (fp == NULL) {
+        return ERR_FIL_OPEN;
+    }
+
+    ses_cb_t *scb = ses_new_dummy_scb();
+    if (scb == NULL) {
+        fclose(fp);
+        return ERR_INTERNAL_MEM;
+    }
+    scb->fp = fp;
+    scb->indent = NCX_DEF_INDENT;
+
+    xml_attrs_t attrs;
+    xml_init_attrs(&attrs);
+
+    run->items = ctx->size;
+    for (i = 0; i < ctx->iterations && res == NO_ERR; i++) {
+        /* new message each time so every iteration
+         * writes the namespace declarations
+         */
+        rpc_msg_t *msg = rpc_new_out_msg();
+        if (msg == NULL) {
+            res = ERR_INTERNAL_MEM;
+            continue;
+        }
+        msg->rpc_in_attrs = &attrs;
+
+        if (fmt == YBENCH_WR_XML) {
+            res = xml_msg_build_prefix_map(&msg->mhdr, &attrs,
+                                           FALSE, FALSE);
+            if (res == NO_ERR) {
+                ybench_start(run);
+                xml_wr_full_val(scb, &msg->mhdr, ctx->top, 0);
+                ses_finish_msg(scb);
+                ybench_stop(run);
+            }
+        } else {
+            ybench_start(run);
+            res = json_wr_full_check_val(scb, &msg->mhdr, 0, ctx->top,
+                                         0, NULL);
+            ses_finish_msg(scb);
+            ybench_stop(run);
+        }
+
+        rpc_free_msg(msg);
+    }
+
+    scb->fp = NULL;
+    ses_free_scb(scb);
+    xml_clean_attrs(&attrs);
+    fclose(fp);
+    return res;
+
+}  /* write_tree */
+
+
+/********************************************************************
+* FUNCTION bench_xml_wr_full_val
+*
+* xml_wr_full_val of the dataset
+*********************************************************************/
+static status_t
+    bench_xml_wr_full_val (ybench_ctx_t *ctx,
+                           ybench_run_t *run)
+{
+    return write_tree(ctx, run, YBENCH_WR_XML);
+
+}  /* bench_xml_wr_full_val */
+
+
+/********************************************************************
+* FUNCTION bench_json_wr_full_check_val
+*
+* json_wr_full_check_val of the dataset
+*********************************************************************/
+static status_t
+    bench_json_wr_full_check_val (ybench_ctx_t *ctx,
+                                  ybench_run_t *run)
+{
+    return write_tree(ctx, run, YBENCH_WR_JSON);
+
+}  /* bench_json_wr_full_check_val */
+
+
+/********************************************************************
+* FUNCTION parse_tree
+*
+* Parse the dataset file once with agt_val_parse_nc
+*
+* INPUTS:
+*   ctx == benchmark context
+*   run == benchmark run
+*   check == TRUE to compare the result to the dataset
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    parse_tree (ybench_ctx_t *ctx,
+                ybench_run_t *run,
+                boolean check)
+{
+    ses_cb_t *scb = ses_new_dummy_scb();
+    if (scb == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    rpc_msg_t *msg = rpc_new_msg();
+    val_value_t *val = val_new_value();
+    if (msg == NULL || val == NULL) {
+        if (msg) {
+            rpc_free_msg(msg);
+        }
+        if (val) {
+            val_free_value(val);
+        }
+        ses_free_scb(scb);
+        return ERR_INTERNAL_MEM;
+    }
+
+    xml_node_t top;
+    xml_init_node(&top);
+
+    status_t res = xml_get_reader_from_filespec((const char *)ctx->xmlspec,
+                                                &scb->reader);
+    if (res == NO_ERR) {
+        res = agt_xml_consume_node(scb, &top, NCX_LAYER_CONTENT,
+                                   &msg->mhdr);
+    }
+
+    if (res == NO_ERR) {
+        ybench_start(run);
+        res = agt_val_parse_nc(scb, &msg->mhdr, ctx->topobj, &top,
+                               NCX_DC_CONFIG, val);
+        ybench_stop(run);
+    }
+
+    if (res == NO_ERR && check && val_compare(val, ctx->top) != 0) {
+        log_error("\nError: parsed dataset not equal");
+        res = ERR_NCX_OPERATION_FAILED;
+    }
+
+    xml_clean_node(&top);
+    val_free_value(val);
+    rpc_free_msg(msg);
+    ses_free_scb(scb);     /* frees the reader */
+    return res;
+
+}  /* parse_tree */
+
+
+/********************************************************************
+* FUNCTION bench_agt_val_parse
+*
+* agt_val_parse_nc of the dataset in XML
+*********************************************************************/
+static status_t
+    bench_agt_val_parse (ybench_ctx_t *ctx,
+                         ybench_run_t *run)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    run->items = ctx->size;
+    for (i = 0; i < ctx->iterations && res == NO_ERR; i++) {
+        res = parse_tree(ctx, run, (i == 0));
+    }
+    return res;
+
+}  /* bench_agt_val_parse */
+
+
+/********************************************************************
+* FUNCTION eval_xpath
+*
+* Evaluate one XPath expression against the dataset
+*
+* INPUTS:
+*   ctx == benchmark context
+*   run == benchmark run
+*   expr == XPath expression
+*
+* RETURNS:
+*   status
+*********************************************************************/
+static status_t
+    eval_xpath (ybench_ctx_t *ctx,
+                ybench_run_t *run,
+                const xmlChar *expr)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    xpath_pcb_t *pcb = xpath_new_pcb(expr, NULL);
+    if (pcb == NULL) {
+        return ERR_INTERNAL_MEM;
+    }
+
+    run->items = ctx->size;
+    for (i = 0; i < ctx->iterations && res == NO_ERR; i++) {
+        ybench_start(run);
+        xpath_result_t *result =
+            xpath1_eval_expr(pcb, ctx->top, ctx->root, TRUE, TRUE, &res);
+        ybench_stop(run);
+
+        if (result) {
+            xpath_free_result(result);
+        } else if (res == NO_ERR) {
+            res = ERR_NCX_OPERATION_FAILED;
+        }
+    }
+
+    xpath_free_pcb(pcb);
+    return res;
+
+}  /* eval_xpath */
+
+
+/********************************************************************
+* FUNCTION bench_xpath_count
+*
+* xpath1_eval_expr with a predicate on a non-key leaf
+*********************************************************************/
+static status_t
+    bench_xpath_count (ybench_ctx_t *ctx,
+                       ybench_run_t *run)
+{
+    return eval_xpath(ctx, run, (const xmlChar *)
+                      "count(/top/entry[enabled='true'])");
+
+}  /* bench_xpath_count */
+
+
+/********************************************************************
+* FUNCTION bench_xpath_key
+*
+* xpath1_eval_expr of a single list entry by key
+*********************************************************************/
+static status_t
+    bench_xpath_key (ybench_ctx_t *ctx,
+                     ybench_run_t *run)
+{
+    char buff[64];
+
+    snprintf(buff, sizeof(buff), "/top/entry[name='entry-%08u']/index",
+             ctx->size / 2);
+    return eval_xpath(ctx, run, (const xmlChar *)buff);
+
+}  /* bench_xpath_key */
+
+
+/********************************************************************
+* FUNCTION bench_xpath_sum
+*
+* xpath1_eval_expr of a number function over a deep node-set
+*********************************************************************/
+static status_t
+    bench_xpath_sum (ybench_ctx_t *ctx,
+                     ybench_run_t *run)
+{
+    return eval_xpath(ctx, run, (const xmlChar *)
+                      "sum(/top/entry/counters/errors)");
+
+}  /* bench_xpath_sum */
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static const ybench_t val_benchmarks[] = {
+    { "val_clone", bench_val_clone },
+    { "val_compare", bench_val_compare },
+    { "val_add_child_sorted", bench_val_add_child_sorted },
+    { "xml_wr_full_val", bench_xml_wr_full_val },
+    { "json_wr_full_check_val", bench_json_wr_full_check_val },
+    { "agt_val_parse", bench_agt_val_parse },
+    { "xpath1_eval_expr.count", bench_xpath_count },
+    { "xpath1_eval_expr.key", bench_xpath_key },
+    { "xpath1_eval_expr.sum", bench_xpath_sum }
+};
+
+
+/*************    E X T E R N A L   F U N C T I O N S   ************/
+
+
+/********************************************************************
+* FUNCTION ybench_val_benchmarks
+*
+* Get the value tree benchmarks
+*
+* OUTPUTS:
+*   *count == number of entries in the returned array
+*
+* RETURNS:
+*   array of benchmarks
+*********************************************************************/
+const ybench_t *
+    ybench_val_benchmarks (uint32 *count)
+{
+    *count = sizeof(val_benchmarks) / sizeof(val_benchmarks[0]);
+    return val_benchmarks;
+
+}  /* ybench_val_benchmarks */
+
+
+/* END ybench_val.c */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2012, YumaWorks, Inc., All Rights Reserved.
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*  FILE: ybench_yang.c
+
+    YANG parser benchmarks: tokenizer and full module load
+
+    Both use the generated ybench module text, so the
+    amount of work depends on --model-size.
+
+*********************************************************************
+*                                                                   *
+*                     I N C L U D E    F I L E S                    *
+*                                                                   *
+*********************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "procdefs.h"
+#include "dlq.h"
+#include "log.h"
+#include "ncx.h"
+#include "ncxmod.h"
+#include "status.h"
+#include "tk.h"
+#include "ybench.h"
+
+
+/********************************************************************
+* FUNCTION bench_tk_tokenize_input
+*
+* tk_tokenize_input of the ybench module file
+* The items count is the number of tokens
+*********************************************************************/
+static status_t
+    bench_tk_tokenize_input (ybench_ctx_t *ctx,
+                             ybench_run_t *run)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+
+    FILE *fp = fopen((const char *)ctx->yangspec, "r");
+    if (fp == NULL) {
+        return ERR_FIL_OPEN;
+    }
+
+    for (i = 0; i < ctx->iterations && res == NO_ERR; i++) {
+        tk_chain_t *tkc = tk_new_chain();
+        if (tkc == NULL) {
+            res = ERR_INTERNAL_MEM;
+            continue;
+        }
+        rewind(fp);
+        tk_setup_chain_yang(tkc, fp, ctx->yangspec);
+
+        ybench_start(run);
+        res = tk_tokenize_input(tkc, NULL);
+        ybench_stop(run);
+
+        if (i == 0) {
+            const dlq_hdr_t *tk;
+            for (tk = dlq_firstEntry(&tkc->tkQ);
+                 tk != NULL;
+                 tk = dlq_nextEntry(tk)) {
+                run->items++;
+            }
+        }
+        tk_free_chain(tkc);
+    }
+
+    fclose(fp);
+    return res;
+
+}  /* bench_tk_tokenize_input */
+
+
+/********************************************************************
+* FUNCTION bench_ncxmod_load_module
+*
+* ncxmod_load_module of a new copy of the ybench module
+* Each iteration loads a module with a new name, since
+* a module is only parsed the first time it is loaded
+*********************************************************************/
+static status_t
+    bench_ncxmod_load_module (ybench_ctx_t *ctx,
+                              ybench_run_t *run)
+{
+    status_t res = NO_ERR;
+    uint32 i;
+    char modname[64];
+
+    run->items = 1;
+    for (i = 0; i < ctx->iterations && res == NO_ERR; i++) {
+        snprintf(modname, sizeof(modname), "%s-%u",
+                 YBENCH_LOAD_MOD, ++ctx->loadcount);
+
+        xmlChar *filespec = ybench_gen_module(ctx, modname, &res);
+        if (filespec == NULL) {
+            continue;
+        }
+
+        ncx_module_t *mod = NULL;
+        ybench_start(run);
+        res = ncxmod_load_module((const xmlChar *)modname, NULL, NULL, &mod);
+        ybench_stop(run);
+
+        m__free(filespec);
+    }
+    return res;
+
+}  /* bench_ncxmod_load_module */
+
+
+/********************************************************************
+*                                                                   *
+*                       V A R I A B L E S                           *
+*                                                                   *
+*********************************************************************/
+
+static const ybench_t yang_benchmarks[] = {
+    { "tk_tokenize_input", bench_tk_tokenize_input },
+    { "ncxmod_load_module", bench_ncxmod_load_module }
+};
+
+
+/*************    E X T E R N A L   F U N C T I O N S   ************/
+
+
+/********************************************************************
+* FUNCTION ybench_yang_benchmarks
+*
+* Get the YANG parser benchmarks
+*
+* OUTPUTS:
+*   *count == number of entries in the returned array
+*
+* RETURNS:
+*   array of benchmarks
+*********************************************************************/
+const ybench_t *
+    ybench_yang_benchmarks (uint32 *count)
+{
+    *count = sizeof(yang_benchmarks) / sizeof(yang_benchmarks[0]);
+    return yang_benchmarks;
+
+}  /* ybench_yang_benchmarks */
+
+
+/* END ybench_yang.c */